@@ -1984,6 +1984,9 @@ struct light_data
     sl_bool directional_light_valid;
     sl_float skylight_intensity;
     sl_bool skylight_valid;
+    sl_ivec3 light_cluster_grid;
+    sl_float light_cluster_z_scale;
+    sl_float light_cluster_z_bias;
 };
 
 struct material_data
@@ -2041,7 +2044,7 @@ struct shadow_data
     sl_int32 shadow_filter_mode;
     sl_float shadow_width;
     sl_float shadow_light_size;
-    sl_int32 shadow_cascade;
+    sl_int32 shadow_cascade_mask;
 };
 
 struct ibl_generation_data
@@ -10,6 +10,7 @@
 
 #include <array>
 #include <mango/types.hpp>
+#include <vector>
 
 namespace mango
 {
@@ -25,6 +26,7 @@ namespace mango
     };
 
     struct bounding_frustum;
+    struct bounding_box_batch;
     struct axis_aligned_bounding_box;
 
     //! \brief Bounding sphere.
@@ -86,6 +88,15 @@ namespace mango
         //! \brief Checks the intersection of this \a bounding_frustum with a \a axis_aligned_bounding_box.
         //! \return True, if the \a bounding_frustum and the \a axis_aligned_bounding_box intersect, else false.
         bool intersects(const axis_aligned_bounding_box& other) const;
+        //! \brief Checks if this \a bounding_frustum contains a \a axis_aligned_bounding_box.
+        //! \return The \a containment_result, contain if the \a axis_aligned_bounding_box is completely inside all planes.
+        containment_result contains(const axis_aligned_bounding_box& other) const;
+        //! \brief Checks the intersection of this \a bounding_frustum with a batch of \a axis_aligned_bounding_boxes.
+        //! \details Tests the center against each plane, offset by the extents projected on the plane normal.
+        //! Uses SSE or AVX to test 8 boxes per iteration when available.
+        //! \param[in] boxes The \a bounding_box_batch to test.
+        //! \param[out] visibility Bitmask with one bit per box, set if the box intersects. Resized to (size + 31) / 32 elements.
+        void intersects(const bounding_box_batch& boxes, std::vector<uint32>& visibility) const;
 
         //! \brief Planes of the frustum.
         //! \details Planes are: x,y,z = normal pointing inwards / w = offset to (0,0,0).
@@ -135,6 +146,76 @@ namespace mango
         //! \brief The extents of the \a axis_aligned_bounding_box.
         vec3 extents;
     };
+
+    //! \brief A batch of \a axis_aligned_bounding_boxes stored as structure of arrays.
+    //! \details Used for culling many boxes at once.
+    struct bounding_box_batch
+    {
+      public:
+        //! \brief Adds an \a axis_aligned_bounding_box to the \a bounding_box_batch.
+        //! \param[in] box The \a axis_aligned_bounding_box to add.
+        void push_back(const axis_aligned_bounding_box& box)
+        {
+            center_x.push_back(box.center.x());
+            center_y.push_back(box.center.y());
+            center_z.push_back(box.center.z());
+            extent_x.push_back(box.extents.x());
+            extent_y.push_back(box.extents.y());
+            extent_z.push_back(box.extents.z());
+        }
+
+        //! \brief Reserves memory for some number of boxes.
+        //! \param[in] count The number of boxes.
+        void reserve(size_t count)
+        {
+            center_x.reserve(count);
+            center_y.reserve(count);
+            center_z.reserve(count);
+            extent_x.reserve(count);
+            extent_y.reserve(count);
+            extent_z.reserve(count);
+        }
+
+        //! \brief Removes all boxes from the \a bounding_box_batch.
+        void clear()
+        {
+            center_x.clear();
+            center_y.clear();
+            center_z.clear();
+            extent_x.clear();
+            extent_y.clear();
+            extent_z.clear();
+        }
+
+        //! \brief Retrieves the number of boxes in the \a bounding_box_batch.
+        //! \return The number of boxes.
+        uint32 size() const
+        {
+            return static_cast<uint32>(center_x.size());
+        }
+
+        //! \brief Checks a bit of a visibility bitmask written by \a bounding_frustum::intersects().
+        //! \param[in] visibility The visibility bitmask.
+        //! \param[in] index The index of the box.
+        //! \return True if the bit of the box is set, else false.
+        static inline bool visible(const std::vector<uint32>& visibility, uint32 index)
+        {
+            return (visibility[index >> 5] & (1u << (index & 31))) != 0;
+        }
+
+        //! \brief The x coordinates of the centers.
+        std::vector<float> center_x;
+        //! \brief The y coordinates of the centers.
+        std::vector<float> center_y;
+        //! \brief The z coordinates of the centers.
+        std::vector<float> center_z;
+        //! \brief The x extents.
+        std::vector<float> extent_x;
+        //! \brief The y extents.
+        std::vector<float> extent_y;
+        //! \brief The z extents.
+        std::vector<float> extent_z;
+    };
 } // namespace mango
 
 #endif // MANGO_HELPERS_HPP
@@ -597,9 +597,14 @@ namespace mango
 
         struct
         {
-            int32 draw_calls; //!< The number of draw calls.
-            int32 vertices;   //!< The number of vertices.
-        } last_frame;         //!< Measured stats from the last rendered frame.
+            int32 draw_calls;        //!< The number of draw calls.
+            int32 vertices;          //!< The number of vertices.
+            int32 api_calls_issued;  //!< The number of state changing graphics API calls issued.
+            int32 api_calls_skipped; //!< The number of redundant state changing graphics API calls skipped.
+            int32 live_samplers;     //!< The number of sampler objects alive on the gpu.
+            int32 frustum_culled;    //!< The number of primitives culled by the camera frustum.
+            int32 occlusion_culled;  //!< The number of primitives culled by the depth of the previous frame.
+        } last_frame;                //!< Measured stats from the last rendered frame.
     };
 
     //! \brief A class for rendering stuff.
@@ -14,6 +14,8 @@
 
 namespace mango
 {
+    class mapped_file;
+
     //! \brief Base resource description.
     struct resource_description
     {
@@ -46,6 +48,15 @@ namespace mango
         std::vector<shader_define> defines;
     };
 
+    //! \brief Statistics of the resource cache.
+    struct resource_cache_statistics
+    {
+        uint64 hits               = 0; //!< Number of acquisitions served from the cache.
+        uint64 misses             = 0; //!< Number of acquisitions that had to load the resource.
+        int64 bytes_resident      = 0; //!< Number of data bytes held by all cached resources.
+        int32 resources_resident  = 0; //!< Number of cached resources.
+    };
+
     //! \brief Reference counted base for all resources.
     struct resource_base
     {
@@ -68,9 +79,13 @@ namespace mango
         int32 number_components;
         //! \brief The number of bits.
         int32 bits;
+        //! \brief The number of mip levels stored tightly packed one after another in \a data.
+        int32 mip_levels = 1;
 
         //! \brief The \a image_resource_description of this \a image.
         image_resource_description description;
+        //! \brief The mapping of the cooked image \a data points into. Null if \a data is not cooked.
+        std::shared_ptr<mapped_file> cooked_mapping;
     };
 
     //! \brief A model resource.
@@ -78,6 +93,12 @@ namespace mango
     {
         //! \brief The loaded gltf model.
         tinygltf::Model gltf_model;
+        //! \brief The data of each buffer view in \a gltf_model. Points into the cooked mapping or into the buffers of \a gltf_model.
+        std::vector<const uint8*> buffer_view_data;
+        //! \brief The images of \a gltf_model. The data points into the cooked mapping or into the images of \a gltf_model.
+        std::vector<image_resource> images;
+        //! \brief The mapping of the cooked model. Null if the model could not be cooked.
+        std::shared_ptr<mapped_file> cooked_mapping;
         //! \brief The \a model_resource_description of this \a model.
         model_resource_description description;
     };
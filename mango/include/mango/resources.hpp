@@ -41,6 +41,10 @@ namespace mango
         //! \brief Releases an aquired \a shader_resource.
         //! \param[in] resource The \a shader_resource to release.
         virtual void release(const shader_resource* resource) = 0;
+
+        //! \brief Returns the current statistics of the resource cache.
+        //! \return The \a resource_cache_statistics.
+        virtual resource_cache_statistics get_cache_statistics() = 0;
     };
 
 
@@ -56,6 +56,18 @@ namespace mango
         //! \return The node \a handle referencing the added \a atmospheric_light or NULL_HND if an error occured.
         virtual handle<atmospheric_light> add_atmospheric_light(atmospheric_light& new_atmospheric_light, handle<node> node_hnd) = 0;
 
+        //! \brief Adds a \a point_light to the \a scene.
+        //! \param[in] new_point_light The \a point_light to add to the \a scene.
+        //! \param[in] node_hnd The \a handle of the \a node that should contain the \a point_light.
+        //! \return The node \a handle referencing the added \a point_light or NULL_HND if an error occured.
+        virtual handle<point_light> add_point_light(point_light& new_point_light, handle<node> node_hnd) = 0;
+
+        //! \brief Adds a \a spot_light to the \a scene.
+        //! \param[in] new_spot_light The \a spot_light to add to the \a scene.
+        //! \param[in] node_hnd The \a handle of the \a node that should contain the \a spot_light.
+        //! \return The node \a handle referencing the added \a spot_light or NULL_HND if an error occured.
+        virtual handle<spot_light> add_spot_light(spot_light& new_spot_light, handle<node> node_hnd) = 0;
+
         //! \brief Builds a \a material.
         //! \param[in] new_material The \a material to build.
         //! \return The \a handle of the created \a material or NULL_HND if an error occured.
@@ -74,6 +86,22 @@ namespace mango
         //! \return The \a handle of the created \a model.
         virtual handle<model> load_model_from_gltf(const string& path) = 0;
 
+        //! \brief Loads an image asynchronously and creates a \a texture.
+        //! \details Returns immediately. The image is decoded on a worker thread and uploaded in a later update of the \a scene.
+        //! Until then the \a texture is pending and uses a white placeholder.
+        //! \param[in] path The full path to the image to load.
+        //! \param[in] standard_color_space True if the image should be loaded in standard color space, else false.
+        //! \param[in] high_dynamic_range True if the image should be loaded as high dynamic range, else false.
+        //! \return The node \a handle of the created \a texture.
+        virtual handle<texture> load_texture_from_image_async(const string& path, bool standard_color_space, bool high_dynamic_range) = 0;
+
+        //! \brief Loads a \a model from a gltf file asynchronously.
+        //! \details Returns immediately. The file is parsed on a worker thread and the \a model is built in a later update of the \a scene.
+        //! Until then the \a model is pending and has no \a scenarios.
+        //! \param[in] path The path to the gltf model to load.
+        //! \return The \a handle of the created \a model.
+        virtual handle<model> load_model_from_gltf_async(const string& path) = 0;
+
         //! \brief Adds a \a model to the \a scene.
         //! \param[in] model_to_add The \a handle of the \a model to add.
         //! \param[in] scenario_hnd The \a handle of the \a scenario from the \a model to add.
@@ -113,6 +141,14 @@ namespace mango
         //! \param[in] node_hnd The \a handle of the containing \a node of the \a atmospheric_light to remove from the \a scene.
         virtual void remove_atmospheric_light(handle<node> node_hnd) = 0;
 
+        //! \brief Removes a \a point_light from the \a scene.
+        //! \param[in] node_hnd The \a handle of the containing \a node of the \a point_light to remove from the \a scene.
+        virtual void remove_point_light(handle<node> node_hnd) = 0;
+
+        //! \brief Removes a \a spot_light from the \a scene.
+        //! \param[in] node_hnd The \a handle of the containing \a node of the \a spot_light to remove from the \a scene.
+        virtual void remove_spot_light(handle<node> node_hnd) = 0;
+
         //! \brief Unloads a \a model loaded from a gltf file.
         //! \details This should only be called, when every instance is removed from the scene, since it corrupts children at the moment.
         //! \param[in] model_hnd The \a handle of the loaded model to remove.
@@ -155,6 +191,16 @@ namespace mango
         //! \return An optional \a atmospheric_light reference.
         virtual optional<atmospheric_light&> get_atmospheric_light(handle<node> node_hnd) = 0;
 
+        //! \brief Retrieves a \a point_light from the \a scene.
+        //! \param[in] node_hnd The \a handle of the containing \a node of the \a point_light to retrieve from the \a scene.
+        //! \return An optional \a point_light reference.
+        virtual optional<point_light&> get_point_light(handle<node> node_hnd) = 0;
+
+        //! \brief Retrieves a \a spot_light from the \a scene.
+        //! \param[in] node_hnd The \a handle of the containing \a node of the \a spot_light to retrieve from the \a scene.
+        //! \return An optional \a spot_light reference.
+        virtual optional<spot_light&> get_spot_light(handle<node> node_hnd) = 0;
+
         //! \brief Retrieves a \a model from the \a scene.
         //! \param[in] instance_hnd The \a handle of the \a model instance to retrieve.
         //! \return An optional \a model reference.
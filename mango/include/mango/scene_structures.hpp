@@ -170,6 +170,57 @@ namespace mango
         DECLARE_SCENE_STRUCTURE(directional_light);
     };
 
+    //! \brief Structure holding informations for a point light.
+    //! \details The position is the position of the containing \a node.
+    struct point_light
+    {
+        //! \brief The color of the \a point_light. Values between 0.0 and 1.0.
+        color_rgb color;
+        //! \brief The intensity of the \a point_light in lumen.
+        float intensity;
+        //! \brief The distance in meters from the \a point_light at which its influence ends.
+        float range;
+
+        point_light()
+            : color(1.0f)
+            , intensity(default_punctual_intensity)
+            , range(default_punctual_range)
+        {
+        }
+        //! \brief \a Point_light is a scene structure.
+        DECLARE_SCENE_STRUCTURE(point_light);
+    };
+
+    //! \brief Structure holding informations for a spot light.
+    //! \details The position is the position of the containing \a node, the direction is rotated with it.
+    struct spot_light
+    {
+        //! \brief The direction the \a spot_light is pointing in.
+        vec3 direction;
+        //! \brief The color of the \a spot_light. Values between 0.0 and 1.0.
+        color_rgb color;
+        //! \brief The intensity of the \a spot_light in lumen.
+        float intensity;
+        //! \brief The distance in meters from the \a spot_light at which its influence ends.
+        float range;
+        //! \brief The angle in radians from the direction at which the light starts to fall off.
+        float inner_cone_angle;
+        //! \brief The angle in radians from the direction at which the light has fallen off completely.
+        float outer_cone_angle;
+
+        spot_light()
+            : direction(0.0f, -1.0f, 0.0f)
+            , color(1.0f)
+            , intensity(default_punctual_intensity)
+            , range(default_punctual_range)
+            , inner_cone_angle(0.0f)
+            , outer_cone_angle(0.785398f)
+        {
+        }
+        //! \brief \a Spot_light is a scene structure.
+        DECLARE_SCENE_STRUCTURE(spot_light);
+    };
+
     //! \brief Public structure holding informations for a skylight.
     struct skylight
     {
@@ -247,9 +298,13 @@ namespace mango
         //! \brief The \a key of the GPU data of the \a texture.
         key gpu_data;
 
+        //! \brief True while the image of the \a texture is loaded asynchronously, else false.
+        bool pending;
+
         texture()
             : standard_color_space(false)
             , high_dynamic_range(false)
+            , pending(false)
             , changed(false)
         {
         }
@@ -407,7 +462,9 @@ namespace mango
         orthographic_camera = 1 << 2,
         directional_light   = 1 << 3,
         skylight            = 1 << 4,
-        atmospheric_light   = 1 << 5
+        atmospheric_light   = 1 << 5,
+        point_light         = 1 << 6,
+        spot_light          = 1 << 7
     };
     MANGO_ENABLE_BITMASK_OPERATIONS(node_type)
 
@@ -416,7 +473,9 @@ namespace mango
     {
         directional = 0,
         skylight,
-        atmospheric
+        atmospheric,
+        point,
+        spot
     };
 
     //! \brief Public structure holding informations for a node.
@@ -445,6 +504,10 @@ namespace mango
         handle<skylight> skylight_hnd;
         //! \brief The \a handle of the nodes \a atmospheric_light if \a node is one.
         handle<atmospheric_light> atmospheric_light_hnd;
+        //! \brief The \a handle of the nodes \a point_light if \a node is one.
+        handle<point_light> point_light_hnd;
+        //! \brief The \a handle of the nodes \a spot_light if \a node is one.
+        handle<spot_light> spot_light_hnd;
 
         //! \brief The \a handle of the \a nodes cached global transformation matrix.
         handle<mat4> global_matrix_hnd;
@@ -485,8 +548,12 @@ namespace mango
         //! \brief Index in the list of scenarios providing the default \a scenario of the \a model.
         int32 default_scenario;
 
+        //! \brief True while the \a model is loaded asynchronously, else false.
+        bool pending;
+
         model()
             : default_scenario(0)
+            , pending(false)
         {
         }
         //! \brief \a Model is a scene structure.
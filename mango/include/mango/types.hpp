@@ -467,6 +467,10 @@ namespace mango
     const float default_directional_intensity = 110000.0f;
     //! \brief The default intensity of a skylight. Is approx. the intensity of a sunny sky.
     const float default_skylight_intensity = 30000.0f;
+    //! \brief The default intensity of a point or spot light. Is approx. the intensity of a 100 watt light bulb.
+    const float default_punctual_intensity = 1700.0f;
+    //! \brief The default range of a point or spot light in meters.
+    const float default_punctual_range = 10.0f;
     //! \brief The default intensity of a emissive object. // TODO Paul: Make something more meaningful.
     const float default_emissive_intensity = 300.0f;
 
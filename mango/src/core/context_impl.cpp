@@ -7,10 +7,12 @@
 #include <core/context_impl.hpp>
 #include <core/display_event_handler_impl.hpp>
 #include <core/input_impl.hpp>
+#include <core/job_system.hpp>
 #include <graphics/graphics.hpp>
 #include <mango/application.hpp>
 #include <mango/assert.hpp>
 #include <mango/profile.hpp>
+#include <memory/frame_arena.hpp>
 #include <rendering/pipelines/deferred_pbr_renderer.hpp>
 #include <rendering/renderer_impl.hpp>
 #include <resources/resources_impl.hpp>
@@ -145,6 +147,16 @@ const unique_ptr<graphics_device>& context_impl::get_graphics_device()
     return m_graphics_device;
 }
 
+const unique_ptr<job_system>& context_impl::get_job_system()
+{
+    return m_job_system;
+}
+
+const unique_ptr<frame_arena>& context_impl::get_frame_arena()
+{
+    return m_frame_arena;
+}
+
 ui_handle context_impl::create_ui(const ui_configuration& config)
 {
     m_ui = mango::make_unique<ui_impl>(config, shared_from_this()); // TODO Paul: Only one ui at the moment!
@@ -219,6 +231,9 @@ bool context_impl::should_shutdown()
 
 void context_impl::update(float dt)
 {
+    // the update starts the frame, scratch memory of the frame before the last one is not used anymore.
+    m_frame_arena->begin_frame();
+
     m_resources->update(dt);
     if (m_ui)
     {
@@ -276,6 +291,14 @@ bool context_impl::startup()
     if (!m_resources)
         return false;
 
+    m_job_system = mango::make_unique<job_system>();
+    if (!m_job_system)
+        return false;
+
+    m_frame_arena = mango::make_unique<frame_arena>(4194304); // 4 MiB per frame, grows on demand.
+    if (!m_frame_arena)
+        return false;
+
     return true;
 }
 
@@ -298,4 +321,7 @@ void context_impl::shutdown()
 
     if (m_display) // Only one display at the moment.
         destroy_display(m_display.get());
+
+    m_job_system  = nullptr;
+    m_frame_arena = nullptr;
 }
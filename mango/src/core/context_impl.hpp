@@ -20,6 +20,8 @@ namespace mango
     class scene_impl;
     class renderer_impl;
     class graphics_device;
+    class job_system;
+    class frame_arena;
 
     //! \brief The implementation of the public context.
     class context_impl : public context, public std::enable_shared_from_this<context_impl>
@@ -76,6 +78,15 @@ namespace mango
         //! \return A unique pointer reference to mangos \a graphics_device.
         const unique_ptr<graphics_device>& get_graphics_device();
 
+        //! \brief Queries and returns a unique pointer reference to mangos \a job_system.
+        //! \return A unique pointer reference to mangos \a job_system.
+        const unique_ptr<job_system>& get_job_system();
+
+        //! \brief Queries and returns a unique pointer reference to mangos \a frame_arena.
+        //! \details The arena is reset at the start of each frame, memory from it has to be used in the current or the next frame only.
+        //! \return A unique pointer reference to mangos \a frame_arena.
+        const unique_ptr<frame_arena>& get_frame_arena();
+
         //! \brief Queries and returns a shared pointer to the current \a application.
         //! \return A shared pointer to the current \a application.
         virtual shared_ptr<application> get_application();
@@ -89,6 +100,7 @@ namespace mango
         bool should_shutdown();
 
         //! \brief Calls the update routine for all mango internals.
+        //! \details Starts a new frame.
         //! \param[in] dt Past time since last call. Can be used for frametime independent motion.
         void update(float dt);
 
@@ -128,6 +140,10 @@ namespace mango
         unique_ptr<renderer_impl> m_renderer;
         //! \brief A unique pointer to the \a graphics_device of mango.
         unique_ptr<graphics_device> m_graphics_device;
+        //! \brief A unique pointer to the \a job_system of mango.
+        unique_ptr<job_system> m_job_system;
+        //! \brief A unique pointer to the \a frame_arena of mango.
+        unique_ptr<frame_arena> m_frame_arena;
     };
 } // namespace mango
 
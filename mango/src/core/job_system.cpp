@@ -0,0 +1,244 @@
+//! \file      job_system.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <core/job_system.hpp>
+#include <mango/log.hpp>
+
+using namespace mango;
+
+//! \brief Queue index used for threads not owned by the \a job_system.
+static const uint32 external_queue = 0xffffffffu;
+
+//! \brief The queue index of the current thread.
+static thread_local uint32 current_queue = external_queue;
+
+//! \brief The number of jobs each \a job_queue has room for initially.
+static const uint32 initial_queue_capacity = 64;
+
+//! \brief Retrieves the default number of worker threads.
+//! \return One less than the hardware concurrency, since the main thread participates as well.
+static uint32 default_worker_count();
+
+job_system::job_system()
+    : job_system(default_worker_count())
+{
+}
+
+job_system::job_system(uint32 worker_count)
+    : m_pending(0)
+    , m_running(true)
+    , m_next_queue(0)
+{
+    for (uint32 i = 0; i < worker_count; ++i)
+    {
+        m_queues.push_back(mango::make_unique<job_queue>());
+        m_queues.back()->jobs.resize(initial_queue_capacity);
+    }
+
+    for (uint32 i = 0; i < worker_count; ++i)
+        m_workers.emplace_back(&job_system::worker_loop, this, i);
+
+    MANGO_LOG_DEBUG("Job system started with {0} worker threads.", worker_count);
+}
+
+job_system::~job_system()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_running = false;
+    }
+    m_wake_condition.notify_all();
+
+    for (auto& w : m_workers)
+        w.join();
+
+    // background jobs still queued are finished here, so their results are not silently lost
+    while (try_execute_background())
+    {
+    }
+}
+
+void job_system::parallel_for(uint32 count, uint32 chunk_size, const void* function, range_function invoke)
+{
+    if (count == 0)
+        return;
+
+    chunk_size         = std::max(chunk_size, 1u);
+    uint32 chunks      = chunk_count(count, chunk_size);
+    uint32 queue_count = static_cast<uint32>(m_queues.size());
+
+    if (chunks == 1 || queue_count == 0)
+    {
+        invoke(function, 0, count);
+        return;
+    }
+
+    range_job range;
+    range.function  = function;
+    range.invoke    = invoke;
+    range.remaining = chunks;
+
+    // counted before publishing, a worker taking a chunk immediately would underflow the counter otherwise
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_pending += chunks;
+    }
+
+    uint32 first_queue = m_next_queue.fetch_add(1) % queue_count;
+    for (uint32 c = 0; c < chunks; ++c)
+    {
+        uint32 begin = c * chunk_size;
+        uint32 end   = std::min(begin + chunk_size, count);
+
+        job_queue& queue = *m_queues[(first_queue + c) % queue_count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.push_back({ &range, begin, end });
+    }
+    m_wake_condition.notify_all();
+
+    // help until all chunks are done
+    while (range.remaining.load() > 0)
+    {
+        if (!try_execute(current_queue))
+            std::this_thread::yield();
+    }
+}
+
+void job_system::execute(std::function<void()> task)
+{
+    if (m_workers.empty())
+    {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_pending++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_background_queue.mutex);
+        m_background_queue.tasks.push_back(std::move(task));
+    }
+    m_wake_condition.notify_one();
+}
+
+void job_system::worker_loop(uint32 index)
+{
+    current_queue = index;
+
+    while (m_running)
+    {
+        // jobs other threads wait for come first
+        if (try_execute(index) || try_execute_background())
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_wake_condition.wait(lock, [this]() { return !m_running || m_pending.load() > 0; });
+    }
+}
+
+bool job_system::try_execute(uint32 own_queue)
+{
+    uint32 queue_count = static_cast<uint32>(m_queues.size());
+    job to_execute;
+    bool found = false;
+
+    // own queue first, newest job
+    if (own_queue != external_queue)
+    {
+        job_queue& queue = *m_queues[own_queue];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        found = queue.pop_back(to_execute);
+    }
+
+    // steal the oldest job from someone else
+    uint32 start = own_queue != external_queue ? own_queue + 1 : 0;
+    for (uint32 i = 0; i < queue_count && !found; ++i)
+    {
+        uint32 victim = (start + i) % queue_count;
+        if (victim == own_queue)
+            continue;
+
+        job_queue& queue = *m_queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        found = queue.pop_front(to_execute);
+    }
+
+    if (!found)
+        return false;
+
+    m_pending--;
+    range_job* range = to_execute.range;
+    range->invoke(range->function, to_execute.begin, to_execute.end);
+    range->remaining.fetch_sub(1);
+
+    return true;
+}
+
+bool job_system::try_execute_background()
+{
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(m_background_queue.mutex);
+        if (m_background_queue.tasks.empty())
+            return false;
+
+        task = std::move(m_background_queue.tasks.front());
+        m_background_queue.tasks.pop_front();
+    }
+
+    m_pending--;
+    task();
+
+    return true;
+}
+
+void job_system::job_queue::push_back(const job& to_queue)
+{
+    uint32 capacity = static_cast<uint32>(jobs.size());
+    if (count == capacity)
+    {
+        // unroll into a larger buffer, only happens until the queue has seen its peak
+        std::vector<job> grown(std::max(capacity * 2, initial_queue_capacity));
+        for (uint32 i = 0; i < count; ++i)
+            grown[i] = jobs[(first + i) % capacity];
+        jobs.swap(grown);
+        first    = 0;
+        capacity = static_cast<uint32>(jobs.size());
+    }
+
+    jobs[(first + count) % capacity] = to_queue;
+    ++count;
+}
+
+bool job_system::job_queue::pop_back(job& taken)
+{
+    if (count == 0)
+        return false;
+
+    --count;
+    taken = jobs[(first + count) % jobs.size()];
+    return true;
+}
+
+bool job_system::job_queue::pop_front(job& taken)
+{
+    if (count == 0)
+        return false;
+
+    taken = jobs[first];
+    first = (first + 1) % static_cast<uint32>(jobs.size());
+    --count;
+    return true;
+}
+
+static uint32 default_worker_count()
+{
+    uint32 hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 1 ? hardware_threads - 1 : 0;
+}
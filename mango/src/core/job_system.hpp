@@ -0,0 +1,160 @@
+//! \file      job_system.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_JOB_SYSTEM_HPP
+#define MANGO_JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <util/helpers.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief A fixed pool of worker threads executing jobs.
+    //! \details Every worker owns a queue. Workers take jobs from the back of their own queue and steal from the front of the other queues when they run out of work.
+    //! Threads waiting for jobs to finish help executing them, so nested calls do not deadlock.
+    class job_system
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(job_system)
+      public:
+        //! \brief Function executing a callable for a range of indices [begin, end).
+        //! \details The callable is passed as pointer, so jobs refer to it without copying or wrapping it in a std::function.
+        using range_function = void (*)(const void* function, uint32 begin, uint32 end);
+
+        //! \brief Constructs a new \a job_system and starts one worker thread less than the hardware concurrency.
+        job_system();
+        //! \brief Constructs a new \a job_system and starts the worker threads.
+        //! \param[in] worker_count The number of worker threads to start. All work is done by the calling threads when it is 0.
+        explicit job_system(uint32 worker_count);
+        //! \brief Stops all worker threads, background jobs still queued are executed by the destroying thread.
+        ~job_system();
+
+        //! \brief Executes a function for all indices in [0, count) split into chunks.
+        //! \details The chunks are distributed over all workers and the calling thread participates. Returns when all chunks are executed.
+        //! \param[in] count The number of indices.
+        //! \param[in] chunk_size The maximum number of indices processed by one job.
+        //! \param[in] func The function to execute per chunk, called with the range of indices [begin, end).
+        template <typename F>
+        inline void parallel_for(uint32 count, uint32 chunk_size, const F& func)
+        {
+            parallel_for(count, chunk_size, static_cast<const void*>(&func), [](const void* function, uint32 begin, uint32 end) { (*static_cast<const F*>(function))(begin, end); });
+        }
+
+        //! \brief Executes a function asynchronously in the background.
+        //! \details Background jobs are only executed by worker threads, threads waiting in \a parallel_for() do not pick them up.
+        //! So long running tasks do not stall the calling thread. When there are no worker threads the function is executed immediately.
+        //! \param[in] task The function to execute.
+        void execute(std::function<void()> task);
+
+        //! \brief Retrieves the number of chunks \a parallel_for() splits some range into.
+        //! \param[in] count The number of indices.
+        //! \param[in] chunk_size The maximum number of indices processed by one job.
+        //! \return The number of chunks.
+        static inline uint32 chunk_count(uint32 count, uint32 chunk_size)
+        {
+            chunk_size = std::max(chunk_size, 1u);
+            return (count + chunk_size - 1) / chunk_size;
+        }
+
+        //! \brief Retrieves the number of worker threads.
+        //! \return The number of worker threads.
+        inline uint32 get_worker_count() const
+        {
+            return static_cast<uint32>(m_workers.size());
+        }
+
+      private:
+        //! \brief A range split into jobs by one call of \a parallel_for(), living on the stack of the calling thread.
+        struct range_job
+        {
+            const void* function;          //!< The callable to execute.
+            range_function invoke;         //!< The function calling the callable.
+            std::atomic<uint32> remaining; //!< The number of chunks not yet executed.
+        };
+
+        //! \brief A single chunk of a \a range_job.
+        struct job
+        {
+            range_job* range; //!< The range the chunk belongs to.
+            uint32 begin;     //!< The first index of the chunk.
+            uint32 end;       //!< The index after the last one of the chunk.
+        };
+
+        //! \brief A job queue owned by one worker.
+        //! \details The jobs are stored in a ring buffer, which grows when it is full and never shrinks, so queueing does not allocate once warm.
+        struct job_queue
+        {
+            std::mutex mutex;      //!< Mutex guarding the jobs.
+            std::vector<job> jobs; //!< The ring buffer of queued jobs.
+            uint32 first = 0;      //!< The index of the oldest job in the ring buffer.
+            uint32 count = 0;      //!< The number of queued jobs.
+
+            //! \brief Queues a job as the newest one.
+            //! \param[in] to_queue The job to queue.
+            void push_back(const job& to_queue);
+            //! \brief Takes the newest job.
+            //! \param[out] taken The job taken, if there was one.
+            //! \return True if a job was taken, else false.
+            bool pop_back(job& taken);
+            //! \brief Takes the oldest job.
+            //! \param[out] taken The job taken, if there was one.
+            //! \return True if a job was taken, else false.
+            bool pop_front(job& taken);
+        };
+
+        //! \brief The queue of background jobs.
+        struct background_queue
+        {
+            std::mutex mutex;                        //!< Mutex guarding the tasks.
+            std::deque<std::function<void()>> tasks; //!< The queued tasks.
+        };
+
+        //! \brief Executes a function for all indices in [0, count) split into chunks.
+        //! \param[in] count The number of indices.
+        //! \param[in] chunk_size The maximum number of indices processed by one job.
+        //! \param[in] function The callable to execute per chunk.
+        //! \param[in] invoke The \a range_function calling the callable.
+        void parallel_for(uint32 count, uint32 chunk_size, const void* function, range_function invoke);
+
+        //! \brief The main loop of each worker thread.
+        //! \param[in] index The index of the worker.
+        void worker_loop(uint32 index);
+
+        //! \brief Tries to take a job from the own queue or to steal one from another queue and executes it.
+        //! \param[in] own_queue The index of the queue of the calling thread or an invalid index for external threads.
+        //! \return True if a job was executed, else false.
+        bool try_execute(uint32 own_queue);
+
+        //! \brief Tries to take a job from the background queue and executes it.
+        //! \return True if a job was executed, else false.
+        bool try_execute_background();
+
+        //! \brief The worker threads.
+        std::vector<std::thread> m_workers;
+        //! \brief One \a job_queue per worker.
+        std::vector<unique_ptr<job_queue>> m_queues;
+        //! \brief The \a background_queue, only taken by workers.
+        background_queue m_background_queue;
+
+        //! \brief Mutex for waking up sleeping workers.
+        std::mutex m_wake_mutex;
+        //! \brief Condition variable for waking up sleeping workers.
+        std::condition_variable m_wake_condition;
+        //! \brief Number of queued jobs not yet taken by any thread.
+        std::atomic<uint32> m_pending;
+        //! \brief False when the workers should shut down.
+        std::atomic<bool> m_running;
+        //! \brief Round robin counter for distributing jobs.
+        std::atomic<uint32> m_next_queue;
+    };
+} // namespace mango
+
+#endif // MANGO_JOB_SYSTEM_HPP
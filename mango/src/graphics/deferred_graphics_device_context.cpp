@@ -0,0 +1,828 @@
+//! \file      deferred_graphics_device_context.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <cstring>
+#include <graphics/deferred_graphics_device_context.hpp>
+#include <mango/assert.hpp>
+#include <mango/log.hpp>
+#include <mango/profile.hpp>
+#include <new>
+
+using namespace mango;
+
+const uint32 deferred_graphics_device_context::null_object;
+const uint32 deferred_graphics_device_context::command_alignment;
+
+namespace
+{
+    // The recorded command data. Handles are stored as indices into the list of referenced objects.
+
+    struct set_buffer_data_cmd
+    {
+        uint32 buffer;
+        int32 offset;
+        int32 size; // followed by size bytes of data
+    };
+
+    struct set_rectangles_cmd
+    {
+        int32 first;
+        int32 count; // followed by count viewports or scissors
+    };
+
+    struct set_line_width_cmd
+    {
+        float width;
+    };
+
+    struct set_depth_bias_cmd
+    {
+        float constant_factor;
+        float clamp;
+        float slope_factor;
+    };
+
+    struct set_blend_constants_cmd
+    {
+        float constants[4];
+    };
+
+    struct set_stencil_compare_mask_and_reference_cmd
+    {
+        gfx_stencil_face_flag_bits face_mask;
+        uint32 compare_mask;
+        uint32 reference;
+    };
+
+    struct set_stencil_write_mask_cmd
+    {
+        gfx_stencil_face_flag_bits face_mask;
+        uint32 write_mask;
+    };
+
+    struct set_render_targets_cmd
+    {
+        int32 count;
+        uint32 depth_stencil_target; // followed by count render target indices
+    };
+
+    struct object_cmd
+    {
+        uint32 object;
+    };
+
+    struct copy_texture_cmd
+    {
+        uint32 source;
+        int32 source_layer;
+        uint32 destination;
+        int32 destination_layer;
+        int32 layer_count;
+    };
+
+    struct clear_render_target_cmd
+    {
+        gfx_clear_attachment_flag_bits color_attachment;
+        float clear_color[4];
+    };
+
+    struct clear_depth_stencil_cmd
+    {
+        gfx_clear_attachment_flag_bits depth_stencil;
+        float clear_depth;
+        int32 clear_stencil;
+    };
+
+    struct vertex_buffer_binding
+    {
+        uint32 buffer;
+        int32 binding;
+        int32 offset;
+    };
+
+    struct set_vertex_buffers_cmd
+    {
+        int32 count; // followed by count vertex_buffer_bindings
+    };
+
+    struct set_index_buffer_cmd
+    {
+        uint32 buffer;
+        gfx_format index_type;
+    };
+
+    struct set_shader_resource_cmd
+    {
+        int32 binding;
+        gfx_shader_resource_type type;
+        uint32 resource;
+    };
+
+    struct set_shader_resource_buffer_range_cmd
+    {
+        int32 binding;
+        gfx_shader_resource_type type;
+        uint32 buffer;
+        int32 offset;
+        int32 size;
+    };
+
+    struct draw_cmd
+    {
+        int32 vertex_count;
+        int32 index_count;
+        int32 instance_count;
+        int32 base_vertex;
+        int32 base_instance;
+        int32 index_offset;
+    };
+
+    struct draw_indexed_indirect_cmd
+    {
+        uint32 buffer;
+        int32 offset;
+        int32 draw_count;
+        int32 stride;
+    };
+
+    struct dispatch_cmd
+    {
+        int32 x;
+        int32 y;
+        int32 z;
+    };
+
+    struct barrier_cmd
+    {
+        barrier_description desc;
+    };
+
+    struct empty_cmd
+    {
+    };
+
+    //! \brief The maximum number of render targets or vertex buffers set by a single command.
+    const int32 max_replay_handles = 16;
+} // namespace
+
+deferred_graphics_device_context::deferred_graphics_device_context(graphics_device_context_handle executor)
+    : m_executor(std::move(executor))
+    , m_command_count(0)
+    , recording(false)
+{
+    MANGO_ASSERT(m_executor, "Deferred context requires an immediate context to replay commands!");
+}
+
+deferred_graphics_device_context::~deferred_graphics_device_context() {}
+
+template <typename T>
+T* deferred_graphics_device_context::allocate_command(command_type type, uint32 trailing_size)
+{
+    uint32 size = static_cast<uint32>(sizeof(command_header) + sizeof(T)) + trailing_size;
+    size        = (size + command_alignment - 1) & ~(command_alignment - 1);
+
+    size_t offset = m_commands.size();
+    m_commands.resize(offset + size);
+    m_command_count++;
+
+    uint8* command                              = m_commands.data() + offset;
+    *reinterpret_cast<command_header*>(command) = { type, size };
+    return new (command + sizeof(command_header)) T();
+}
+
+template <typename T>
+uint32 deferred_graphics_device_context::reference_object(gfx_handle<const T> object, std::vector<gfx_handle<const T>>& objects)
+{
+    if (!object)
+        return null_object;
+
+    objects.push_back(std::move(object));
+    return static_cast<uint32>(objects.size() - 1);
+}
+
+template <typename T>
+gfx_handle<const T> deferred_graphics_device_context::take_object(uint32 index, std::vector<gfx_handle<const T>>& objects)
+{
+    if (index == null_object)
+        return nullptr;
+
+    return std::move(objects[index]);
+}
+
+void deferred_graphics_device_context::begin()
+{
+    clear_commands();
+    recording = true;
+}
+
+void deferred_graphics_device_context::clear_commands()
+{
+    // Clearing keeps the capacity, so recording again does not allocate.
+    m_commands.clear();
+    m_buffers.clear();
+    m_textures.clear();
+    m_pipelines.clear();
+    m_semaphores.clear();
+    m_objects.clear();
+    m_command_count = 0;
+}
+
+void deferred_graphics_device_context::make_current()
+{
+    MANGO_LOG_ERROR("Deferred contexts can not be made current!");
+}
+
+void deferred_graphics_device_context::set_swap_interval(int32)
+{
+    MANGO_LOG_ERROR("Deferred contexts can not set the swap interval!");
+}
+
+void deferred_graphics_device_context::set_buffer_data(gfx_handle<const gfx_buffer> buffer_handle, int32 offset, int32 size, void* data)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    MANGO_ASSERT(size >= 0, "Can not set negative data size!");
+
+    set_buffer_data_cmd* cmd = allocate_command<set_buffer_data_cmd>(command_type::set_buffer_data, static_cast<uint32>(size));
+    cmd->buffer              = reference_object(buffer_handle, m_buffers);
+    cmd->offset              = offset;
+    cmd->size                = size;
+    std::memcpy(cmd + 1, data, static_cast<size_t>(size));
+}
+
+void* deferred_graphics_device_context::map_buffer_data(gfx_handle<const gfx_buffer>, int32, int32)
+{
+    MANGO_LOG_ERROR("Deferred contexts can not map buffer data!");
+    return nullptr;
+}
+
+void deferred_graphics_device_context::set_texture_data(gfx_handle<const gfx_texture>, const texture_set_description&, void*)
+{
+    MANGO_LOG_ERROR("Deferred contexts can not set texture data!");
+}
+
+void deferred_graphics_device_context::set_viewport(int32 first, int32 count, const gfx_viewport* viewports)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    set_rectangles_cmd* cmd = allocate_command<set_rectangles_cmd>(command_type::set_viewport, count * sizeof(gfx_viewport));
+    cmd->first              = first;
+    cmd->count              = count;
+    std::memcpy(cmd + 1, viewports, count * sizeof(gfx_viewport));
+}
+
+void deferred_graphics_device_context::set_scissor(int32 first, int32 count, const gfx_scissor_rectangle* scissors)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    set_rectangles_cmd* cmd = allocate_command<set_rectangles_cmd>(command_type::set_scissor, count * sizeof(gfx_scissor_rectangle));
+    cmd->first              = first;
+    cmd->count              = count;
+    std::memcpy(cmd + 1, scissors, count * sizeof(gfx_scissor_rectangle));
+}
+
+void deferred_graphics_device_context::set_line_width(float width)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    allocate_command<set_line_width_cmd>(command_type::set_line_width)->width = width;
+}
+
+void deferred_graphics_device_context::set_depth_bias(float constant_factor, float clamp, float slope_factor)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    set_depth_bias_cmd* cmd = allocate_command<set_depth_bias_cmd>(command_type::set_depth_bias);
+    cmd->constant_factor    = constant_factor;
+    cmd->clamp              = clamp;
+    cmd->slope_factor       = slope_factor;
+}
+
+void deferred_graphics_device_context::set_blend_constants(const float constants[4])
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    set_blend_constants_cmd* cmd = allocate_command<set_blend_constants_cmd>(command_type::set_blend_constants);
+    std::memcpy(cmd->constants, constants, sizeof(cmd->constants));
+}
+
+void deferred_graphics_device_context::set_stencil_compare_mask_and_reference(gfx_stencil_face_flag_bits face_mask, uint32 compare_mask, uint32 reference)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    set_stencil_compare_mask_and_reference_cmd* cmd = allocate_command<set_stencil_compare_mask_and_reference_cmd>(command_type::set_stencil_compare_mask_and_reference);
+    cmd->face_mask                                  = face_mask;
+    cmd->compare_mask                               = compare_mask;
+    cmd->reference                                  = reference;
+}
+
+void deferred_graphics_device_context::set_stencil_write_mask(gfx_stencil_face_flag_bits face_mask, uint32 write_mask)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    set_stencil_write_mask_cmd* cmd = allocate_command<set_stencil_write_mask_cmd>(command_type::set_stencil_write_mask);
+    cmd->face_mask                  = face_mask;
+    cmd->write_mask                 = write_mask;
+}
+
+void deferred_graphics_device_context::set_render_targets(int32 count, gfx_handle<const gfx_texture>* render_targets, gfx_handle<const gfx_texture> depth_stencil_target)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    MANGO_ASSERT(count <= max_replay_handles, "Too many render targets!");
+
+    uint32 targets[max_replay_handles];
+    for (int32 i = 0; i < count; ++i)
+        targets[i] = reference_object(render_targets[i], m_textures);
+    uint32 depth_stencil = reference_object(depth_stencil_target, m_textures);
+
+    set_render_targets_cmd* cmd = allocate_command<set_render_targets_cmd>(command_type::set_render_targets, count * sizeof(uint32));
+    cmd->count                  = count;
+    cmd->depth_stencil_target   = depth_stencil;
+    std::memcpy(cmd + 1, targets, count * sizeof(uint32));
+}
+
+void deferred_graphics_device_context::calculate_mipmaps(gfx_handle<const gfx_texture> texture_handle)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    uint32 texture = reference_object(texture_handle, m_textures);
+    allocate_command<object_cmd>(command_type::calculate_mipmaps)->object = texture;
+}
+
+void deferred_graphics_device_context::copy_texture(gfx_handle<const gfx_texture> source, int32 source_layer, gfx_handle<const gfx_texture> destination, int32 destination_layer, int32 layer_count)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    uint32 src = reference_object(source, m_textures);
+    uint32 dst = reference_object(destination, m_textures);
+
+    copy_texture_cmd* cmd  = allocate_command<copy_texture_cmd>(command_type::copy_texture);
+    cmd->source            = src;
+    cmd->source_layer      = source_layer;
+    cmd->destination       = dst;
+    cmd->destination_layer = destination_layer;
+    cmd->layer_count       = layer_count;
+}
+
+void deferred_graphics_device_context::clear_render_target(gfx_clear_attachment_flag_bits color_attachment, float clear_color[4])
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    clear_render_target_cmd* cmd = allocate_command<clear_render_target_cmd>(command_type::clear_render_target);
+    cmd->color_attachment        = color_attachment;
+    std::memcpy(cmd->clear_color, clear_color, sizeof(cmd->clear_color));
+}
+
+void deferred_graphics_device_context::clear_depth_stencil(gfx_clear_attachment_flag_bits depth_stencil, float clear_depth, int32 clear_stencil)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    clear_depth_stencil_cmd* cmd = allocate_command<clear_depth_stencil_cmd>(command_type::clear_depth_stencil);
+    cmd->depth_stencil           = depth_stencil;
+    cmd->clear_depth             = clear_depth;
+    cmd->clear_stencil           = clear_stencil;
+}
+
+void deferred_graphics_device_context::set_vertex_buffers(int32 count, gfx_handle<const gfx_buffer>* buffers, int32* bindings, int32* offsets)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    MANGO_ASSERT(count <= max_replay_handles, "Too many vertex buffers!");
+
+    vertex_buffer_binding vertex_buffers[max_replay_handles];
+    for (int32 i = 0; i < count; ++i)
+        vertex_buffers[i] = { reference_object(buffers[i], m_buffers), bindings[i], offsets[i] };
+
+    set_vertex_buffers_cmd* cmd = allocate_command<set_vertex_buffers_cmd>(command_type::set_vertex_buffers, count * sizeof(vertex_buffer_binding));
+    cmd->count                  = count;
+    std::memcpy(cmd + 1, vertex_buffers, count * sizeof(vertex_buffer_binding));
+}
+
+void deferred_graphics_device_context::set_index_buffer(gfx_handle<const gfx_buffer> buffer_handle, gfx_format index_type)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    uint32 buffer             = reference_object(buffer_handle, m_buffers);
+    set_index_buffer_cmd* cmd = allocate_command<set_index_buffer_cmd>(command_type::set_index_buffer);
+    cmd->buffer               = buffer;
+    cmd->index_type           = index_type;
+}
+
+void deferred_graphics_device_context::bind_pipeline(gfx_handle<const gfx_pipeline> pipeline_handle)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    uint32 pipeline = reference_object(pipeline_handle, m_pipelines);
+    allocate_command<object_cmd>(command_type::bind_pipeline)->object = pipeline;
+}
+
+void deferred_graphics_device_context::set_shader_resource(const shader_resource_mapping::resource_slot& slot, gfx_handle<const gfx_device_object> resource)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    uint32 object                = reference_object(resource, m_objects);
+    set_shader_resource_cmd* cmd = allocate_command<set_shader_resource_cmd>(command_type::set_shader_resource);
+    cmd->binding                 = slot.first;
+    cmd->type                    = slot.second;
+    cmd->resource                = object;
+}
+
+void deferred_graphics_device_context::set_shader_resource_buffer_range(const shader_resource_mapping::resource_slot& slot, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    uint32 object                             = reference_object(buffer, m_buffers);
+    set_shader_resource_buffer_range_cmd* cmd = allocate_command<set_shader_resource_buffer_range_cmd>(command_type::set_shader_resource_buffer_range);
+    cmd->binding                              = slot.first;
+    cmd->type                                 = slot.second;
+    cmd->buffer                               = object;
+    cmd->offset                               = offset;
+    cmd->size                                 = size;
+}
+
+void deferred_graphics_device_context::submit_pipeline_state_resources()
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    allocate_command<empty_cmd>(command_type::submit_pipeline_state_resources);
+}
+
+void deferred_graphics_device_context::draw(int32 vertex_count, int32 index_count, int32 instance_count, int32 base_vertex, int32 base_instance, int32 index_offset)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    draw_cmd* cmd       = allocate_command<draw_cmd>(command_type::draw);
+    cmd->vertex_count   = vertex_count;
+    cmd->index_count    = index_count;
+    cmd->instance_count = instance_count;
+    cmd->base_vertex    = base_vertex;
+    cmd->base_instance  = base_instance;
+    cmd->index_offset   = index_offset;
+}
+
+void deferred_graphics_device_context::draw_indexed_indirect(gfx_handle<const gfx_buffer> indirect_buffer, int32 offset, int32 draw_count, int32 stride)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    uint32 object                  = reference_object(indirect_buffer, m_buffers);
+    draw_indexed_indirect_cmd* cmd = allocate_command<draw_indexed_indirect_cmd>(command_type::draw_indexed_indirect);
+    cmd->buffer                    = object;
+    cmd->offset                    = offset;
+    cmd->draw_count                = draw_count;
+    cmd->stride                    = stride;
+}
+
+void deferred_graphics_device_context::dispatch(int32 x, int32 y, int32 z)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    dispatch_cmd* cmd = allocate_command<dispatch_cmd>(command_type::dispatch);
+    cmd->x            = x;
+    cmd->y            = y;
+    cmd->z            = z;
+}
+
+void deferred_graphics_device_context::barrier(const barrier_description& desc)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    allocate_command<barrier_cmd>(command_type::barrier)->desc = desc;
+}
+
+gfx_handle<const gfx_semaphore> deferred_graphics_device_context::fence(const semaphore_create_info&)
+{
+    MANGO_LOG_ERROR("Deferred contexts can not create fences!");
+    return nullptr;
+}
+
+void deferred_graphics_device_context::client_wait(gfx_handle<const gfx_semaphore> semaphore)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    uint32 object = reference_object(semaphore, m_semaphores);
+    allocate_command<object_cmd>(command_type::client_wait)->object = object;
+}
+
+bool deferred_graphics_device_context::is_signaled(gfx_handle<const gfx_semaphore>)
+{
+    MANGO_LOG_ERROR("Deferred contexts can not check fences!");
+    return false;
+}
+
+void deferred_graphics_device_context::wait(gfx_handle<const gfx_semaphore> semaphore)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    uint32 object = reference_object(semaphore, m_semaphores);
+    allocate_command<object_cmd>(command_type::wait)->object = object;
+}
+
+void deferred_graphics_device_context::present()
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    allocate_command<empty_cmd>(command_type::present);
+}
+
+void deferred_graphics_device_context::end()
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    recording = false;
+}
+
+void deferred_graphics_device_context::submit()
+{
+    NAMED_PROFILE_ZONE("Submit Deferred Context");
+    if (recording)
+    {
+        MANGO_LOG_WARN("Device context is recording! Call end() before submitting the context!");
+        return;
+    }
+
+    m_executor->begin();
+    replay();
+    m_executor->end();
+    m_executor->submit();
+
+    // the referenced objects were handed over to the executor, so the commands can not be replayed again.
+    clear_commands();
+}
+
+void deferred_graphics_device_context::replay()
+{
+    graphics_device_context* executor = m_executor.get();
+
+    const uint8* current = m_commands.data();
+    const uint8* end     = current + m_commands.size();
+    while (current < end)
+    {
+        const command_header* header = reinterpret_cast<const command_header*>(current);
+        const uint8* data            = current + sizeof(command_header);
+        current += header->size;
+
+        switch (header->type)
+        {
+        case command_type::set_buffer_data:
+        {
+            const set_buffer_data_cmd* cmd = reinterpret_cast<const set_buffer_data_cmd*>(data);
+            executor->set_buffer_data(take_object(cmd->buffer, m_buffers), cmd->offset, cmd->size, const_cast<set_buffer_data_cmd*>(cmd) + 1);
+            break;
+        }
+        case command_type::set_viewport:
+        {
+            const set_rectangles_cmd* cmd = reinterpret_cast<const set_rectangles_cmd*>(data);
+            executor->set_viewport(cmd->first, cmd->count, reinterpret_cast<const gfx_viewport*>(cmd + 1));
+            break;
+        }
+        case command_type::set_scissor:
+        {
+            const set_rectangles_cmd* cmd = reinterpret_cast<const set_rectangles_cmd*>(data);
+            executor->set_scissor(cmd->first, cmd->count, reinterpret_cast<const gfx_scissor_rectangle*>(cmd + 1));
+            break;
+        }
+        case command_type::set_line_width:
+            executor->set_line_width(reinterpret_cast<const set_line_width_cmd*>(data)->width);
+            break;
+        case command_type::set_depth_bias:
+        {
+            const set_depth_bias_cmd* cmd = reinterpret_cast<const set_depth_bias_cmd*>(data);
+            executor->set_depth_bias(cmd->constant_factor, cmd->clamp, cmd->slope_factor);
+            break;
+        }
+        case command_type::set_blend_constants:
+            executor->set_blend_constants(reinterpret_cast<const set_blend_constants_cmd*>(data)->constants);
+            break;
+        case command_type::set_stencil_compare_mask_and_reference:
+        {
+            const set_stencil_compare_mask_and_reference_cmd* cmd = reinterpret_cast<const set_stencil_compare_mask_and_reference_cmd*>(data);
+            executor->set_stencil_compare_mask_and_reference(cmd->face_mask, cmd->compare_mask, cmd->reference);
+            break;
+        }
+        case command_type::set_stencil_write_mask:
+        {
+            const set_stencil_write_mask_cmd* cmd = reinterpret_cast<const set_stencil_write_mask_cmd*>(data);
+            executor->set_stencil_write_mask(cmd->face_mask, cmd->write_mask);
+            break;
+        }
+        case command_type::set_render_targets:
+        {
+            const set_render_targets_cmd* cmd = reinterpret_cast<const set_render_targets_cmd*>(data);
+            const uint32* indices             = reinterpret_cast<const uint32*>(cmd + 1);
+            gfx_handle<const gfx_texture> targets[max_replay_handles];
+            for (int32 i = 0; i < cmd->count; ++i)
+                targets[i] = take_object(indices[i], m_textures);
+            executor->set_render_targets(cmd->count, targets, take_object(cmd->depth_stencil_target, m_textures));
+            break;
+        }
+        case command_type::calculate_mipmaps:
+            executor->calculate_mipmaps(take_object(reinterpret_cast<const object_cmd*>(data)->object, m_textures));
+            break;
+        case command_type::copy_texture:
+        {
+            const copy_texture_cmd* cmd = reinterpret_cast<const copy_texture_cmd*>(data);
+            executor->copy_texture(take_object(cmd->source, m_textures), cmd->source_layer, take_object(cmd->destination, m_textures), cmd->destination_layer, cmd->layer_count);
+            break;
+        }
+        case command_type::clear_render_target:
+        {
+            const clear_render_target_cmd* cmd = reinterpret_cast<const clear_render_target_cmd*>(data);
+            float clear_color[4];
+            std::memcpy(clear_color, cmd->clear_color, sizeof(clear_color));
+            executor->clear_render_target(cmd->color_attachment, clear_color);
+            break;
+        }
+        case command_type::clear_depth_stencil:
+        {
+            const clear_depth_stencil_cmd* cmd = reinterpret_cast<const clear_depth_stencil_cmd*>(data);
+            executor->clear_depth_stencil(cmd->depth_stencil, cmd->clear_depth, cmd->clear_stencil);
+            break;
+        }
+        case command_type::set_vertex_buffers:
+        {
+            const set_vertex_buffers_cmd* cmd            = reinterpret_cast<const set_vertex_buffers_cmd*>(data);
+            const vertex_buffer_binding* vertex_buffers = reinterpret_cast<const vertex_buffer_binding*>(cmd + 1);
+            gfx_handle<const gfx_buffer> buffers[max_replay_handles];
+            int32 bindings[max_replay_handles];
+            int32 offsets[max_replay_handles];
+            for (int32 i = 0; i < cmd->count; ++i)
+            {
+                buffers[i]  = take_object(vertex_buffers[i].buffer, m_buffers);
+                bindings[i] = vertex_buffers[i].binding;
+                offsets[i]  = vertex_buffers[i].offset;
+            }
+            executor->set_vertex_buffers(cmd->count, buffers, bindings, offsets);
+            break;
+        }
+        case command_type::set_index_buffer:
+        {
+            const set_index_buffer_cmd* cmd = reinterpret_cast<const set_index_buffer_cmd*>(data);
+            executor->set_index_buffer(take_object(cmd->buffer, m_buffers), cmd->index_type);
+            break;
+        }
+        case command_type::bind_pipeline:
+            executor->bind_pipeline(take_object(reinterpret_cast<const object_cmd*>(data)->object, m_pipelines));
+            break;
+        case command_type::set_shader_resource:
+        {
+            const set_shader_resource_cmd* cmd = reinterpret_cast<const set_shader_resource_cmd*>(data);
+            executor->set_shader_resource({ cmd->binding, cmd->type }, take_object(cmd->resource, m_objects));
+            break;
+        }
+        case command_type::set_shader_resource_buffer_range:
+        {
+            const set_shader_resource_buffer_range_cmd* cmd = reinterpret_cast<const set_shader_resource_buffer_range_cmd*>(data);
+            executor->set_shader_resource_buffer_range({ cmd->binding, cmd->type }, take_object(cmd->buffer, m_buffers), cmd->offset, cmd->size);
+            break;
+        }
+        case command_type::submit_pipeline_state_resources:
+            executor->submit_pipeline_state_resources();
+            break;
+        case command_type::draw:
+        {
+            const draw_cmd* cmd = reinterpret_cast<const draw_cmd*>(data);
+            executor->draw(cmd->vertex_count, cmd->index_count, cmd->instance_count, cmd->base_vertex, cmd->base_instance, cmd->index_offset);
+            break;
+        }
+        case command_type::draw_indexed_indirect:
+        {
+            const draw_indexed_indirect_cmd* cmd = reinterpret_cast<const draw_indexed_indirect_cmd*>(data);
+            executor->draw_indexed_indirect(take_object(cmd->buffer, m_buffers), cmd->offset, cmd->draw_count, cmd->stride);
+            break;
+        }
+        case command_type::dispatch:
+        {
+            const dispatch_cmd* cmd = reinterpret_cast<const dispatch_cmd*>(data);
+            executor->dispatch(cmd->x, cmd->y, cmd->z);
+            break;
+        }
+        case command_type::barrier:
+            executor->barrier(reinterpret_cast<const barrier_cmd*>(data)->desc);
+            break;
+        case command_type::client_wait:
+            executor->client_wait(take_object(reinterpret_cast<const object_cmd*>(data)->object, m_semaphores));
+            break;
+        case command_type::wait:
+            executor->wait(take_object(reinterpret_cast<const object_cmd*>(data)->object, m_semaphores));
+            break;
+        case command_type::present:
+            executor->present();
+            break;
+        default:
+            MANGO_ASSERT(false, "Unknown command type!");
+            return;
+        }
+    }
+}
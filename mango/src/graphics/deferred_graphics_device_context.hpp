@@ -0,0 +1,184 @@
+//! \file      deferred_graphics_device_context.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_DEFERRED_GRAPHICS_DEVICE_CONTEXT_HPP
+#define MANGO_DEFERRED_GRAPHICS_DEVICE_CONTEXT_HPP
+
+#include <graphics/graphics_device_context.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief A \a graphics_device_context recording commands to execute them later.
+    //! \details All commands are recorded into a linear command buffer of plain data commands,
+    //! the \a gfx_handles they reference are kept alive in separate lists, one per handle type.
+    //! Recording does not call the graphics api or touch any shared state, so deferred contexts can be recorded on any thread.
+    //! Data passed to set_buffer_data() is copied into the command buffer while recording.
+    //! Calling submit() replays the recorded commands with an immediate \a graphics_device_context and has to be done on the thread owning the graphics api.
+    //! Replaying moves every referenced \a gfx_handle into the executor, so no reference count is touched per command.
+    //! The recorded commands are consumed by submit() and have to be recorded again for the next submission.
+    //! Commands that have to return something immediately (make_current(), set_swap_interval(), map_buffer_data(), set_texture_data() and fence()) can not be recorded.
+    //! The renderer does not use deferred contexts yet, all passes record into the immediate context on the main thread.
+    //! Passes recording into a deferred context have to set their resources with set_shader_resource() instead of changing the \a shader_resource_mapping directly.
+    class deferred_graphics_device_context : public graphics_device_context
+    {
+      public:
+        //! \brief Constructs a new \a deferred_graphics_device_context.
+        //! \param[in] executor The immediate \a graphics_device_context used to replay the recorded commands.
+        deferred_graphics_device_context(graphics_device_context_handle executor);
+        ~deferred_graphics_device_context();
+
+        void begin() override;
+        void make_current() override;
+        void set_swap_interval(int32 swap) override;
+        void set_buffer_data(gfx_handle<const gfx_buffer> buffer_handle, int32 offset, int32 size, void* data) override;
+        void* map_buffer_data(gfx_handle<const gfx_buffer> buffer_handle, int32 offset, int32 size) override;
+        void set_texture_data(gfx_handle<const gfx_texture> texture_handle, const texture_set_description& desc, void* data) override;
+        void set_viewport(int32 first, int32 count, const gfx_viewport* viewports) override;
+        void set_scissor(int32 first, int32 count, const gfx_scissor_rectangle* scissors) override;
+        void set_line_width(float width) override;
+        void set_depth_bias(float constant_factor, float clamp, float slope_factor) override;
+        void set_blend_constants(const float constants[4]) override;
+        void set_stencil_compare_mask_and_reference(gfx_stencil_face_flag_bits face_mask, uint32 compare_mask, uint32 reference) override;
+        void set_stencil_write_mask(gfx_stencil_face_flag_bits face_mask, uint32 write_mask) override;
+        void set_render_targets(int32 count, gfx_handle<const gfx_texture>* render_targets, gfx_handle<const gfx_texture> depth_stencil_target) override;
+        void calculate_mipmaps(gfx_handle<const gfx_texture> texture_handle) override;
+        void copy_texture(gfx_handle<const gfx_texture> source, int32 source_layer, gfx_handle<const gfx_texture> destination, int32 destination_layer, int32 layer_count) override;
+        void clear_render_target(gfx_clear_attachment_flag_bits color_attachment, float clear_color[4]) override;
+        void clear_depth_stencil(gfx_clear_attachment_flag_bits depth_stencil, float clear_depth, int32 clear_stencil) override;
+        void set_vertex_buffers(int32 count, gfx_handle<const gfx_buffer>* buffers, int32* bindings, int32* offsets) override;
+        void set_index_buffer(gfx_handle<const gfx_buffer> buffer_handle, gfx_format index_type) override;
+        void bind_pipeline(gfx_handle<const gfx_pipeline> pipeline_handle) override;
+        void set_shader_resource(const shader_resource_mapping::resource_slot& slot, gfx_handle<const gfx_device_object> resource) override;
+        void set_shader_resource_buffer_range(const shader_resource_mapping::resource_slot& slot, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size) override;
+        void submit_pipeline_state_resources() override;
+        void draw(int32 vertex_count, int32 index_count, int32 instance_count, int32 base_vertex, int32 base_instance, int32 index_offset) override;
+        void draw_indexed_indirect(gfx_handle<const gfx_buffer> indirect_buffer, int32 offset, int32 draw_count, int32 stride) override;
+        void dispatch(int32 x, int32 y, int32 z) override;
+        void barrier(const barrier_description& desc) override;
+        gfx_handle<const gfx_semaphore> fence(const semaphore_create_info& info) override;
+        void client_wait(gfx_handle<const gfx_semaphore> semaphore) override;
+        bool is_signaled(gfx_handle<const gfx_semaphore> semaphore) override;
+        void wait(gfx_handle<const gfx_semaphore> semaphore) override;
+        void present() override;
+        void end() override;
+        void submit() override;
+
+        //! \brief Retrieves the number of recorded commands.
+        //! \return The number of commands recorded since the last call to begin(), that are not submitted yet.
+        inline int32 command_count() const
+        {
+            return m_command_count;
+        }
+
+        //! \brief Retrieves the size of the recorded command buffer.
+        //! \return The size of the commands recorded since the last call to begin() in bytes.
+        inline int32 command_buffer_size() const
+        {
+            return static_cast<int32>(m_commands.size());
+        }
+
+      private:
+        //! \brief The types of recorded commands.
+        enum class command_type : uint8
+        {
+            set_buffer_data,
+            set_viewport,
+            set_scissor,
+            set_line_width,
+            set_depth_bias,
+            set_blend_constants,
+            set_stencil_compare_mask_and_reference,
+            set_stencil_write_mask,
+            set_render_targets,
+            calculate_mipmaps,
+            copy_texture,
+            clear_render_target,
+            clear_depth_stencil,
+            set_vertex_buffers,
+            set_index_buffer,
+            bind_pipeline,
+            set_shader_resource,
+            set_shader_resource_buffer_range,
+            submit_pipeline_state_resources,
+            draw,
+            draw_indexed_indirect,
+            dispatch,
+            barrier,
+            client_wait,
+            wait,
+            present
+        };
+
+        //! \brief The header every recorded command starts with.
+        struct command_header
+        {
+            //! \brief The \a command_type of the command.
+            command_type type;
+            //! \brief The size of the command including the header and any trailing data in bytes.
+            uint32 size;
+        };
+
+        //! \brief The alignment of all commands in the command buffer.
+        static const uint32 command_alignment = 8;
+
+        //! \brief Index marking an empty \a gfx_handle in the list of referenced objects.
+        static const uint32 null_object = 0xffffffffu;
+
+        //! \brief Allocates a command in the command buffer.
+        //! \details The command data of type \a T is stored directly behind the \a command_header.
+        //! The returned pointer is only valid until the next command is allocated.
+        //! \param[in] type The \a command_type of the command.
+        //! \param[in] trailing_size The size of additional data stored directly behind the command data in bytes.
+        //! \return A pointer to the command data, the header is already filled.
+        template <typename T>
+        T* allocate_command(command_type type, uint32 trailing_size = 0);
+
+        //! \brief Adds a \a gfx_handle to a list of referenced objects.
+        //! \param[in] object The \a gfx_handle to reference.
+        //! \param[in,out] objects The list of referenced objects of type \a T.
+        //! \return The index to retrieve the object when replaying, \a null_object for empty handles.
+        template <typename T>
+        static uint32 reference_object(gfx_handle<const T> object, std::vector<gfx_handle<const T>>& objects);
+
+        //! \brief Takes a referenced object out of its list.
+        //! \details The \a gfx_handle is moved out, so it can only be taken once.
+        //! \param[in] index The index returned by \a reference_object().
+        //! \param[in,out] objects The list of referenced objects of type \a T.
+        //! \return The \a gfx_handle of the object.
+        template <typename T>
+        static gfx_handle<const T> take_object(uint32 index, std::vector<gfx_handle<const T>>& objects);
+
+        //! \brief Removes all recorded commands and referenced objects, keeping the allocated memory.
+        void clear_commands();
+
+        //! \brief Replays all recorded commands with the executor.
+        void replay();
+
+        //! \brief The immediate \a graphics_device_context used to replay the recorded commands.
+        graphics_device_context_handle m_executor;
+
+        //! \brief The linear command buffer. Only grows, so recording again after begin() does not allocate.
+        std::vector<uint8> m_commands;
+        //! \brief The \a gfx_buffers referenced by the recorded commands.
+        std::vector<gfx_handle<const gfx_buffer>> m_buffers;
+        //! \brief The \a gfx_textures referenced by the recorded commands.
+        std::vector<gfx_handle<const gfx_texture>> m_textures;
+        //! \brief The \a gfx_pipelines referenced by the recorded commands.
+        std::vector<gfx_handle<const gfx_pipeline>> m_pipelines;
+        //! \brief The \a gfx_semaphores referenced by the recorded commands.
+        std::vector<gfx_handle<const gfx_semaphore>> m_semaphores;
+        //! \brief The other \a gfx_handles referenced by the recorded commands.
+        std::vector<gfx_handle<const gfx_device_object>> m_objects;
+        //! \brief The number of recorded commands.
+        int32 m_command_count;
+
+        //! \brief True if the \a deferred_graphics_device_context is currently in a recording state, else false.
+        bool recording;
+    };
+} // namespace mango
+
+#endif // MANGO_DEFERRED_GRAPHICS_DEVICE_CONTEXT_HPP
@@ -0,0 +1,178 @@
+//! \file      geometry_heap.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <cstring>
+#include <graphics/geometry_heap.hpp>
+#include <mango/log.hpp>
+#include <mango/profile.hpp>
+
+using namespace mango;
+
+const int32 geometry_heap::page_vertex_count;
+const int32 geometry_heap::page_index_count;
+const gfx_format geometry_heap::index_type;
+const int32 geometry_heap::max_streams;
+
+geometry_heap::geometry_heap()
+    : m_device(nullptr)
+{
+}
+
+geometry_heap::~geometry_heap() {}
+
+void geometry_heap::create(const graphics_device_handle& device)
+{
+    m_device = &device;
+    m_pages.clear();
+}
+
+bool geometry_heap::allocate(const vertex_input_descriptor& layout, const geometry_stream* streams, int32 vertex_count, const void* indices, gfx_format source_index_type, int32 index_count,
+                             geometry_allocation& allocation)
+{
+    PROFILE_ZONE;
+    MANGO_ASSERT(m_device, "Geometry heap is not created!");
+    MANGO_ASSERT(layout.binding_description_count == layout.attribute_description_count, "Geometry heap requires one binding per attribute!");
+    MANGO_ASSERT(layout.binding_description_count <= max_streams, "Too many vertex streams!");
+
+    layout_key key;
+    key.attribute_count = layout.attribute_description_count;
+    for (int32 i = 0; i < key.attribute_count; ++i)
+    {
+        MANGO_ASSERT(layout.attribute_descriptions[i].binding == i && layout.binding_descriptions[i].binding == i, "Geometry heap requires binding i for attribute i!");
+        MANGO_ASSERT(streams[i].element_size <= layout.binding_descriptions[i].stride, "Vertex stream elements do not fit the binding stride!");
+        key.locations[i] = layout.attribute_descriptions[i].location;
+        key.formats[i]   = layout.attribute_descriptions[i].attribute_format;
+        key.strides[i]   = layout.binding_descriptions[i].stride;
+    }
+
+    // first page with enough space left, or a new one.
+    std::vector<page>& pages = m_pages[key];
+    page* target             = nullptr;
+    for (page& p : pages)
+    {
+        if (p.vertex_capacity - p.vertex_count >= vertex_count && p.index_capacity - p.index_count >= index_count)
+        {
+            target = &p;
+            break;
+        }
+    }
+    if (!target)
+    {
+        page created;
+        if (!create_page(key, std::max(page_vertex_count, vertex_count), std::max(page_index_count, index_count), created))
+            return false;
+        pages.push_back(std::move(created));
+        target = &pages.back();
+    }
+
+    allocation.vertex_buffer_count = target->stream_count;
+    for (int32 i = 0; i < target->stream_count; ++i)
+    {
+        allocation.vertex_buffers[i] = target->vertex_buffers[i];
+
+        // repack the stream tightly with the binding stride.
+        std::vector<uint8>& pending = target->pending_vertices[i];
+        size_t start                = pending.size();
+        pending.resize(start + static_cast<size_t>(vertex_count) * target->strides[i], 0);
+        for (int32 v = 0; v < vertex_count; ++v)
+            memcpy(pending.data() + start + v * target->strides[i], streams[i].data + static_cast<int64>(v) * streams[i].stride, streams[i].element_size);
+    }
+    allocation.index_buffer = target->index_buffer;
+    allocation.base_vertex  = target->vertex_count;
+    allocation.index_offset = target->index_count * static_cast<int32>(sizeof(uint32));
+
+    if (indices && index_count > 0)
+    {
+        std::vector<uint32>& pending = target->pending_indices;
+        size_t start                 = pending.size();
+        pending.resize(start + index_count);
+        switch (source_index_type)
+        {
+        case gfx_format::t_unsigned_byte:
+            for (int32 i = 0; i < index_count; ++i)
+                pending[start + i] = static_cast<const uint8*>(indices)[i];
+            break;
+        case gfx_format::t_unsigned_short:
+            for (int32 i = 0; i < index_count; ++i)
+                pending[start + i] = static_cast<const uint16*>(indices)[i];
+            break;
+        case gfx_format::t_unsigned_int:
+            memcpy(pending.data() + start, indices, index_count * sizeof(uint32));
+            break;
+        default:
+            MANGO_ASSERT(false, "Invalid index type!");
+            break;
+        }
+    }
+
+    target->vertex_count += vertex_count;
+    target->index_count += index_count;
+
+    return true;
+}
+
+void geometry_heap::flush(const graphics_device_context_handle& device_context)
+{
+    PROFILE_ZONE;
+    for (auto& layout_pages : m_pages)
+    {
+        for (page& p : layout_pages.second)
+        {
+            for (int32 i = 0; i < p.stream_count; ++i)
+            {
+                std::vector<uint8>& pending = p.pending_vertices[i];
+                if (!pending.empty())
+                    device_context->set_buffer_data(p.vertex_buffers[i], p.pending_vertex_start * p.strides[i], static_cast<int32>(pending.size()), pending.data());
+                // the staged data is not needed anymore.
+                std::vector<uint8>().swap(pending);
+            }
+            if (!p.pending_indices.empty())
+                device_context->set_buffer_data(p.index_buffer, p.pending_index_start * static_cast<int32>(sizeof(uint32)), static_cast<int32>(p.pending_indices.size() * sizeof(uint32)),
+                                                p.pending_indices.data());
+            std::vector<uint32>().swap(p.pending_indices);
+
+            p.pending_vertex_start = p.vertex_count;
+            p.pending_index_start  = p.index_count;
+        }
+    }
+}
+
+int32 geometry_heap::get_page_count() const
+{
+    int32 count = 0;
+    for (const auto& layout_pages : m_pages)
+        count += static_cast<int32>(layout_pages.second.size());
+    return count;
+}
+
+bool geometry_heap::create_page(const layout_key& key, int32 vertex_capacity, int32 index_capacity, page& result)
+{
+    PROFILE_ZONE;
+    result.stream_count    = key.attribute_count;
+    result.vertex_capacity = vertex_capacity;
+    result.index_capacity  = index_capacity;
+
+    buffer_create_info buffer_info;
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_dynamic_storage;
+    buffer_info.buffer_target = gfx_buffer_target::buffer_target_vertex;
+    for (int32 i = 0; i < key.attribute_count; ++i)
+    {
+        result.strides[i]        = key.strides[i];
+        buffer_info.size         = static_cast<int64>(vertex_capacity) * key.strides[i];
+        result.vertex_buffers[i] = (*m_device)->create_buffer(buffer_info);
+        if (!check_creation(result.vertex_buffers[i].get(), "geometry heap vertex buffer"))
+            return false;
+    }
+
+    buffer_info.buffer_target = gfx_buffer_target::buffer_target_index;
+    buffer_info.size          = static_cast<int64>(index_capacity) * sizeof(uint32);
+    result.index_buffer       = (*m_device)->create_buffer(buffer_info);
+    if (!check_creation(result.index_buffer.get(), "geometry heap index buffer"))
+        return false;
+
+    MANGO_LOG_DEBUG("Created geometry heap page for {0} vertices and {1} indices.", vertex_capacity, index_capacity);
+    return true;
+}
@@ -0,0 +1,190 @@
+//! \file      geometry_heap.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_GEOMETRY_HEAP_HPP
+#define MANGO_GEOMETRY_HEAP_HPP
+
+#include <graphics/graphics_device.hpp>
+#include <graphics/graphics_device_context.hpp>
+#include <graphics/graphics_resources.hpp>
+#include <unordered_map>
+#include <util/helpers.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief One vertex attribute stream of geometry added to a \a geometry_heap.
+    struct geometry_stream
+    {
+        //! \brief Pointer to the first element of the stream.
+        const uint8* data;
+        //! \brief The distance in bytes between two consecutive elements in data.
+        int32 stride;
+        //! \brief The size of one element in bytes.
+        int32 element_size;
+    };
+
+    //! \brief The location of geometry in a \a geometry_heap.
+    struct geometry_allocation
+    {
+        //! \brief The number of vertex buffers.
+        int32 vertex_buffer_count;
+        //! \brief The \a gfx_buffers holding the vertex streams, one per binding of the vertex layout.
+        std::array<gfx_handle<const gfx_buffer>, 16> vertex_buffers; // TODO Paul: Query max vertex buffers. GL_MAX_VERTEX_ATTRIB_BINDINGS
+        //! \brief The \a gfx_buffer holding the indices. The indices are of type \a geometry_heap::index_type.
+        gfx_handle<const gfx_buffer> index_buffer;
+        //! \brief The index of the first vertex in the vertex buffers. Has to be used as base vertex when drawing.
+        int32 base_vertex;
+        //! \brief The offset of the first index in the index buffer in bytes.
+        int32 index_offset;
+    };
+
+    //! \brief Shared vertex and index buffers for all geometry with the same vertex layout.
+    //! \details Geometry is packed into pages of large buffers, one page per vertex layout holds many primitives.
+    //! Primitives in the same page are drawn with the same vertex buffer bindings and the same vertex array and only differ in base vertex and index offset.
+    //! Each vertex attribute gets its own tightly packed buffer, indices are stored as 32 bit unsigned integers relative to the base vertex.
+    //! Data is staged on the cpu and uploaded with \a flush(). Geometry is not released individually, pages live as long as the heap.
+    class geometry_heap
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(geometry_heap)
+      public:
+        //! \brief The number of vertices in one page.
+        static const int32 page_vertex_count = 262144;
+        //! \brief The number of indices in one page.
+        static const int32 page_index_count = 1048576;
+        //! \brief The \a gfx_format of all indices in the heap.
+        static const gfx_format index_type = gfx_format::t_unsigned_int;
+
+        geometry_heap();
+        ~geometry_heap();
+
+        //! \brief Creates the \a geometry_heap.
+        //! \param[in] device The \a graphics_device to create the buffers with.
+        void create(const graphics_device_handle& device);
+
+        //! \brief Adds geometry to the heap.
+        //! \details Vertex bindings of the layout have to match the attributes one to one, with the stride of each binding as element distance in the heap.
+        //! \param[in] layout The \a vertex_input_descriptor describing the geometry as it is stored in the heap.
+        //! \param[in] streams One \a geometry_stream per binding of the layout.
+        //! \param[in] vertex_count The number of vertices.
+        //! \param[in] indices Pointer to the indices, nullptr for geometry without indices.
+        //! \param[in] source_index_type The \a gfx_format of the indices. One of t_unsigned_byte, t_unsigned_short or t_unsigned_int.
+        //! \param[in] index_count The number of indices.
+        //! \param[out] allocation The \a geometry_allocation describing where the geometry is stored.
+        //! \return True on success, else false.
+        bool allocate(const vertex_input_descriptor& layout, const geometry_stream* streams, int32 vertex_count, const void* indices, gfx_format source_index_type, int32 index_count,
+                      geometry_allocation& allocation);
+
+        //! \brief Uploads all geometry added since the last call.
+        //! \param[in] device_context The recording \a graphics_device_context to use.
+        void flush(const graphics_device_context_handle& device_context);
+
+        //! \brief Retrieves the number of pages in the heap.
+        //! \return The number of pages over all vertex layouts.
+        int32 get_page_count() const;
+
+      private:
+        //! \brief The maximum number of vertex streams.
+        static const int32 max_streams = 16;
+
+        //! \brief One set of shared buffers.
+        struct page
+        {
+            //! \brief The number of vertex streams.
+            int32 stream_count = 0;
+            //! \brief The element distance of each vertex stream in bytes.
+            int32 strides[max_streams];
+            //! \brief The vertex buffer of each stream.
+            gfx_handle<const gfx_buffer> vertex_buffers[max_streams];
+            //! \brief The index buffer.
+            gfx_handle<const gfx_buffer> index_buffer;
+
+            //! \brief The number of vertices fitting into the page.
+            int32 vertex_capacity = 0;
+            //! \brief The number of vertices allocated.
+            int32 vertex_count = 0;
+            //! \brief The number of indices fitting into the page.
+            int32 index_capacity = 0;
+            //! \brief The number of indices allocated.
+            int32 index_count = 0;
+
+            //! \brief The first vertex not uploaded yet.
+            int32 pending_vertex_start = 0;
+            //! \brief The first index not uploaded yet.
+            int32 pending_index_start = 0;
+            //! \brief Vertex data of each stream not uploaded yet.
+            std::vector<uint8> pending_vertices[max_streams];
+            //! \brief Indices not uploaded yet.
+            std::vector<uint32> pending_indices;
+        };
+
+        //! \brief Key to find the pages of a vertex layout.
+        struct layout_key
+        {
+            //! \brief The number of attributes.
+            int32 attribute_count = 0;
+            //! \brief The location of each attribute.
+            int32 locations[max_streams];
+            //! \brief The \a gfx_format of each attribute.
+            gfx_format formats[max_streams];
+            //! \brief The stride of the binding of each attribute.
+            int32 strides[max_streams];
+
+            //! \brief Comparison operator equal.
+            //! \param[in] other The other \a layout_key.
+            //! \return True if other \a layout_key is equal to the current one, else false.
+            bool operator==(const layout_key& other) const
+            {
+                if (attribute_count != other.attribute_count)
+                    return false;
+                for (int32 i = 0; i < attribute_count; ++i)
+                {
+                    if (locations[i] != other.locations[i] || formats[i] != other.formats[i] || strides[i] != other.strides[i])
+                        return false;
+                }
+                return true;
+            }
+        };
+
+        //! \brief Hash for \a layout_keys.
+        struct layout_key_hash
+        {
+            //! \brief Function call operator.
+            //! \details Hashes the \a layout_key.
+            //! \param[in] k The \a layout_key to hash.
+            //! \return The hash for the given \a layout_key.
+            std::size_t operator()(const layout_key& k) const
+            {
+                // https://stackoverflow.com/questions/1646807/quick-and-simple-hash-code-combinations/
+
+                size_t res = 17;
+                res        = res * 31 + std::hash<int32>()(k.attribute_count);
+                for (int32 i = 0; i < k.attribute_count; ++i)
+                {
+                    res = res * 31 + std::hash<int32>()(k.locations[i]);
+                    res = res * 31 + std::hash<int32>()(static_cast<int32>(k.formats[i]));
+                    res = res * 31 + std::hash<int32>()(k.strides[i]);
+                }
+                return res;
+            };
+        };
+
+        //! \brief Creates a new page.
+        //! \param[in] key The \a layout_key of the vertex layout the page is for.
+        //! \param[in] vertex_capacity The number of vertices fitting into the page.
+        //! \param[in] index_capacity The number of indices fitting into the page.
+        //! \param[out] result The created page.
+        //! \return True on success, else false.
+        bool create_page(const layout_key& key, int32 vertex_capacity, int32 index_capacity, page& result);
+
+        //! \brief The \a graphics_device used for creation.
+        const graphics_device_handle* m_device;
+        //! \brief The pages of each vertex layout.
+        std::unordered_map<layout_key, std::vector<page>, layout_key_hash> m_pages;
+    };
+} // namespace mango
+
+#endif // MANGO_GEOMETRY_HEAP_HPP
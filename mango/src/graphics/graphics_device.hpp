@@ -21,6 +21,8 @@ namespace mango
         virtual ~graphics_device() = default;
 
         //! \brief Creates a \a graphics_device_context to use for submitting commands to the gpu.
+        //! \details Deferred contexts only record commands and can be used on any thread, they are executed on submit().
+        //! No render pass records into a deferred context yet: recording the passes can still create pipelines and buffers, which requires the thread owning the graphics api.
         //! \param[in] immediate True when context should be an immediate one, else false.
         //! \return A unique handle to the created context.
         virtual graphics_device_context_handle create_graphics_device_context(bool immediate = true) const = 0;
@@ -59,6 +61,11 @@ namespace mango
         //! \return A \a gfx_handle of the created compute \a gfx_pipeline.
         virtual gfx_handle<const gfx_pipeline> create_compute_pipeline(const compute_pipeline_create_info& info) const = 0;
 
+        //! \brief Waits until all created \a gfx_pipelines are ready to be used.
+        //! \details Shaders of \a gfx_pipelines start compiling on creation, in parallel if supported by the driver.
+        //! Binding a \a gfx_pipeline for the first time waits for its shaders, calling this after creating pipelines moves that wait out of the frame.
+        virtual void wait_for_pipelines() const = 0;
+
         //! \brief Creates a \a gfx_buffer.
         //! \param[in] info The \a buffer_create_info providing info for creation.
         //! \return A \a gfx_handle of the \a gfx_buffer.
@@ -76,8 +83,9 @@ namespace mango
         virtual gfx_handle<const gfx_image_texture_view> create_image_texture_view(gfx_handle<const gfx_texture> texture, int32 level = 0) const = 0;
 
         //! \brief Creates a \a gfx_sampler.
+        //! \details Samplers are shared, creating one with the same \a sampler_create_info as a living one returns that.
         //! \param[in] info The \a sampler_create_info providing info for creation.
-        //! \return A \a gfx_handle of the created \a gfx_sampler.
+        //! \return A \a gfx_handle of the created or shared \a gfx_sampler.
         virtual gfx_handle<const gfx_sampler> create_sampler(const sampler_create_info& info) const = 0;
 
         //
@@ -92,6 +100,29 @@ namespace mango
         //! \return A \a gfx_handle of the \a gfx_texture representing the depth stancil target of the swap chain.
         virtual gfx_handle<const gfx_texture> get_swap_chain_depth_stencil_target() = 0;
 
+        //
+        // Capabilities.
+        //
+
+        //! \brief Checks if shaders can identify the single draws of \a graphics_device_context::draw_indexed_indirect().
+        //! \details Shaders read the base instance of each draw, in opengl this requires GL_ARB_shader_draw_parameters.
+        //! \return True if per draw data can be used with multi draw indirect submission, else false.
+        virtual bool supports_multi_draw_indirect() const = 0;
+
+        //
+        // Statistics.
+        //
+
+        //! \brief Retrieves the number of state changing API calls issued and skipped as redundant.
+        //! \details Counts all calls since the last retrieval and resets the counters.
+        //! \param[out] issued_calls The number of state changing API calls issued.
+        //! \param[out] skipped_calls The number of state changing API calls skipped, because the state was already set.
+        virtual void collect_api_call_counters(int32& issued_calls, int32& skipped_calls) = 0;
+
+        //! \brief Retrieves the number of sampler objects currently alive on the gpu.
+        //! \return The number of living \a gfx_samplers.
+        virtual int32 get_live_sampler_count() const = 0;
+
         //
         // Callback.
         //
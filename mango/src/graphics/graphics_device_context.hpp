@@ -115,6 +115,15 @@ namespace mango
         //! \param[in] texture_handle The \a gfx_handle of the \a gfx_texture to calculate the mipchain for.
         virtual void calculate_mipmaps(gfx_handle<const gfx_texture> texture_handle) = 0;
 
+        //! \brief Copies array layers of the first mip level from one \a gfx_texture to another.
+        //! \details Both textures need the same format and size. Layers of textures without layers are addressed with 0.
+        //! \param[in] source The \a gfx_handle of the \a gfx_texture to copy from.
+        //! \param[in] source_layer The first layer to copy from.
+        //! \param[in] destination The \a gfx_handle of the \a gfx_texture to copy to.
+        //! \param[in] destination_layer The first layer to copy to.
+        //! \param[in] layer_count The number of layers to copy.
+        virtual void copy_texture(gfx_handle<const gfx_texture> source, int32 source_layer, gfx_handle<const gfx_texture> destination, int32 destination_layer, int32 layer_count) = 0;
+
         //! \brief Clears one or more color attachments that are currently set.
         //! \details Targets to clear have to be set before calling this function.
         //! \param[in] color_attachment The \a gfx_clear_attachment_flag_bits specifying the attachments to clear.
@@ -144,6 +153,22 @@ namespace mango
         //! \param[in] pipeline_handle The \a gfx_handle of the \a gfx_pipeline to bind.
         virtual void bind_pipeline(gfx_handle<const gfx_pipeline> pipeline_handle) = 0;
 
+        //! \brief Sets a shader resource of the currently bound \a gfx_pipeline.
+        //! \details Requires a bound \a gfx_pipeline. Equivalent to setting the resource with the \a shader_resource_mapping of the \a gfx_pipeline,
+        //! but is ordered with the other commands of the \a graphics_device_context.
+        //! \param[in] slot The \a shader_resource_mapping::resource_slot of the shader resource.
+        //! \param[in] resource A \a gfx_handle of the resource to set.
+        virtual void set_shader_resource(const shader_resource_mapping::resource_slot& slot, gfx_handle<const gfx_device_object> resource) = 0;
+
+        //! \brief Sets a range of a \a gfx_buffer as shader resource of the currently bound \a gfx_pipeline.
+        //! \details Requires a bound \a gfx_pipeline. Equivalent to setting the buffer range with the \a shader_resource_mapping of the \a gfx_pipeline,
+        //! but is ordered with the other commands of the \a graphics_device_context.
+        //! \param[in] slot The \a shader_resource_mapping::resource_slot of the shader resource.
+        //! \param[in] buffer A \a gfx_handle of the \a gfx_buffer to set.
+        //! \param[in] offset The offset of the range in bytes. Has to fulfill the offset alignment of the target.
+        //! \param[in] size The size of the range in bytes.
+        virtual void set_shader_resource_buffer_range(const shader_resource_mapping::resource_slot& slot, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size) = 0;
+
         //! \brief Submits the resources of a \a gfx_pipeline on the gpu.
         //! \details Requires a bound \a gfx_pipeline. Resources are set beforehand with the \a shader_resource_mapping attached to the \a gfx_pipeline.
         virtual void submit_pipeline_state_resources() = 0;
@@ -162,6 +187,14 @@ namespace mango
         //! \param[in] index_offset The offset in the index array.
         virtual void draw(int32 vertex_count, int32 index_count, int32 instance_count, int32 base_vertex, int32 base_instance, int32 index_offset) = 0;
 
+        //! \brief Schedules multiple indexed draw calls on the gpu with one call, the parameters of each draw are read from a \a gfx_buffer.
+        //! \details Requires a bound \a gfx_pipeline, vertex buffers and an index buffer shared by all draws.
+        //! \param[in] indirect_buffer The \a gfx_buffer holding the \a draw_indexed_indirect_commands. Has to be created with buffer_target_indirect.
+        //! \param[in] offset The offset of the first \a draw_indexed_indirect_command in the buffer in bytes.
+        //! \param[in] draw_count The number of draws.
+        //! \param[in] stride The distance between two commands in bytes or 0 for tightly packed commands.
+        virtual void draw_indexed_indirect(gfx_handle<const gfx_buffer> indirect_buffer, int32 offset, int32 draw_count, int32 stride) = 0;
+
         //! \brief Schedules a compute dispatch on the gpu.
         //! \details Requires a bound \a gfx_pipeline.
         //! \param[in] x The number of work groups to start in x dimension.
@@ -186,6 +219,11 @@ namespace mango
         //! \param[in] semaphore The \a gfx_semaphore to check for the synchronization status.
         virtual void client_wait(gfx_handle<const gfx_semaphore> semaphore) = 0;
 
+        //! \brief Checks if a synchronization point is reached without making the client (cpu) wait.
+        //! \param[in] semaphore The \a gfx_semaphore to check for the synchronization status.
+        //! \return True if the \a gfx_semaphore is signaled, else false.
+        virtual bool is_signaled(gfx_handle<const gfx_semaphore> semaphore) = 0;
+
         //! \brief Makes the gpu wait for a certain synchronization point.
         //! \param[in] semaphore The \a gfx_semaphore to check for the synchronization status.
         virtual void wait(gfx_handle<const gfx_semaphore> semaphore) = 0;
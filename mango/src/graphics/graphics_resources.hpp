@@ -307,6 +307,22 @@ namespace mango
         gfx_barrier_bit barrier_bit;
     };
 
+    //! \brief Parameters of one indexed draw call read from a \a gfx_buffer by the gpu.
+    //! \details The layout matches the command structure of indirect draws, so arrays of it can be uploaded as they are.
+    struct draw_indexed_indirect_command
+    {
+        //! \brief The number of indices to draw.
+        uint32 index_count;
+        //! \brief The number of instances to draw.
+        uint32 instance_count;
+        //! \brief The index of the first index in the bound index buffer.
+        uint32 first_index;
+        //! \brief Constant value that should be added to each element of indices.
+        int32 base_vertex;
+        //! \brief Constant value that should be added when fetching instanced vertex attributes. Also readable in shaders to identify the draw.
+        uint32 base_instance;
+    };
+
     //! \brief Description to provide information for setting the data of a \a gfx_texture.
     struct texture_set_description
     {
@@ -416,6 +432,8 @@ namespace mango
         int32 index_offset;
     };
 
+    class gfx_buffer;
+
     //! \brief Mapping to get, set and submit shader resources.
     class shader_resource_mapping
     {
@@ -427,11 +445,53 @@ namespace mango
         //! \return True on success, else false.
         virtual bool set(const string variable_name, gfx_handle<const gfx_device_object> resource) = 0;
 
+        //! \brief Checks whether a buffer resource exists and sets a range of a buffer for it.
+        //! \details The range stays active until the resource is set again.
+        //! \param[in] variable_name The variable name.
+        //! \param[in] buffer A \a gfx_handle of the \a gfx_buffer to set.
+        //! \param[in] offset The offset of the range in bytes. Has to fulfill the offset alignment of the target.
+        //! \param[in] size The size of the range in bytes.
+        //! \return True on success, else false.
+        virtual bool set_buffer_range(const string variable_name, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size) = 0;
+
         //! \brief The pair of an integer binding and a \a shader_resource_type.
         using binding_pair = std::pair<int32, gfx_shader_resource_type>;
         //! \brief Mapping of resource names to \a binding_pairs.
         std::unordered_map<string, binding_pair> m_name_to_binding_pair;
 
+        //! \brief A pre-resolved shader resource, used to set resources without looking up the variable name.
+        //! \details A slot only depends on the \a pipeline_resource_layout and the shader stages,
+        //! so it is valid for all \a gfx_pipelines created with the same ones.
+        using resource_slot = binding_pair;
+
+        //! \brief Resolves the \a resource_slot of a shader resource.
+        //! \details Should be called once, e.g. after pipeline creation, and not per draw.
+        //! \param[in] variable_name The variable name.
+        //! \return The \a resource_slot of the shader resource. The binding is -1, if the resource does not exist.
+        inline resource_slot get_slot(const string& variable_name) const
+        {
+            auto query = m_name_to_binding_pair.find(variable_name);
+            if (query == m_name_to_binding_pair.end())
+                return { -1, gfx_shader_resource_type::shader_resource_unknown };
+            return query->second;
+        }
+
+        //! \brief Checks whether resource with correct access exists, returns a pointer to fill.
+        //! \details Can also be an array of resources.
+        //! \param[in] slot The \a resource_slot of the shader resource.
+        //! \param[in] resource A \a gfx_handle of the resource to set.
+        //! \return True on success, else false.
+        virtual bool set(const resource_slot& slot, gfx_handle<const gfx_device_object> resource) = 0;
+
+        //! \brief Checks whether a buffer resource exists and sets a range of a buffer for it.
+        //! \details The range stays active until the resource is set again.
+        //! \param[in] slot The \a resource_slot of the shader resource.
+        //! \param[in] buffer A \a gfx_handle of the \a gfx_buffer to set.
+        //! \param[in] offset The offset of the range in bytes. Has to fulfill the offset alignment of the target.
+        //! \param[in] size The size of the range in bytes.
+        //! \return True on success, else false.
+        virtual bool set_buffer_range(const resource_slot& slot, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size) = 0;
+
         //! \brief Status bit to describe static and dynamic resources.
         //! \details 0 = invalid, 1 = dynamic, 2 = static unset, 3 = static set.
         using status_bit = uint8; // TODO Should be done better.
@@ -26,6 +26,16 @@ namespace mango
         //! \param[in] native_handle The native handle of the buffer to record.
         virtual void record_buffer_binding(gfx_buffer_target target, int32 idx, void* native_handle) = 0;
 
+        //! \brief Checks if a certain sampler is already bound.
+        //! \param[in] idx The texture unit to check.
+        //! \param[in] native_handle The native handle of the sampler to check.
+        virtual bool is_sampler_bound(int32 idx, void* native_handle) = 0;
+
+        //! \brief Records a certain binding of a sampler.
+        //! \param[in] idx The texture unit to record.
+        //! \param[in] native_handle The native handle of the sampler to record.
+        virtual void record_sampler_binding(int32 idx, void* native_handle) = 0;
+
         // TODO Paul: More improvements!
         /*
         virtual bool is_texture_bound()       = 0;
@@ -33,9 +43,6 @@ namespace mango
 
         virtual bool is_image_texture_bound()       = 0;
         virtual void record_image_texture_binding() = 0;
-
-        virtual bool is_sampler_bound()       = 0;
-        virtual void record_sampler_binding() = 0;
         */
     };
 } // namespace mango
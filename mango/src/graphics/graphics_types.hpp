@@ -501,22 +501,23 @@ namespace mango
     //! \brief Specification of barrier bits.
     enum class gfx_barrier_bit : uint16
     {
-        unknown_barrier_bit             = 0,
-        vertex_attrib_array_barrier_bit = 1 << 0,
-        element_array_barrier_bit       = 1 << 1,
-        uniform_barrier_bit             = 1 << 2,
-        texture_fetch_barrier_bit       = 1 << 3,
-        shader_image_access_barrier_bit = 1 << 4,
-        command_barrier_bit             = 1 << 5,
-        pixel_buffer_barrier_bit        = 1 << 6,
-        texture_update_barrier_bit      = 1 << 7,
-        buffer_update_barrier_bit       = 1 << 8,
-        framebuffer_barrier_bit         = 1 << 9,
-        transform_feedback_barrier_bit  = 1 << 10,
-        atomic_counter_barrier_bit      = 1 << 11,
-        shader_storage_barrier_bit      = 1 << 12,
-        query_buffer_barrier_bit        = 1 << 13,
-        last_barrier_bit                = query_buffer_barrier_bit
+        unknown_barrier_bit              = 0,
+        vertex_attrib_array_barrier_bit  = 1 << 0,
+        element_array_barrier_bit        = 1 << 1,
+        uniform_barrier_bit              = 1 << 2,
+        texture_fetch_barrier_bit        = 1 << 3,
+        shader_image_access_barrier_bit  = 1 << 4,
+        command_barrier_bit              = 1 << 5,
+        pixel_buffer_barrier_bit         = 1 << 6,
+        texture_update_barrier_bit       = 1 << 7,
+        buffer_update_barrier_bit        = 1 << 8,
+        framebuffer_barrier_bit          = 1 << 9,
+        transform_feedback_barrier_bit   = 1 << 10,
+        atomic_counter_barrier_bit       = 1 << 11,
+        shader_storage_barrier_bit       = 1 << 12,
+        query_buffer_barrier_bit         = 1 << 13,
+        client_mapped_buffer_barrier_bit = 1 << 14,
+        last_barrier_bit                 = client_mapped_buffer_barrier_bit
     };
     MANGO_ENABLE_BITMASK_OPERATIONS(gfx_barrier_bit)
 
@@ -547,7 +548,8 @@ namespace mango
         buffer_target_uniform,
         buffer_target_shader_storage,
         buffer_target_texture,
-        buffer_target_last = buffer_target_texture
+        buffer_target_indirect,
+        buffer_target_last = buffer_target_indirect
     };
 
     //! \brief Bit specification providing access information for buffers.
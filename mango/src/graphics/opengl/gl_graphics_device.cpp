@@ -4,6 +4,8 @@
 //! \date      2022
 //! \copyright Apache License 2.0
 
+#include <cstring>
+#include <graphics/deferred_graphics_device_context.hpp>
 #include <graphics/opengl/gl_graphics_device.hpp>
 #include <graphics/opengl/gl_graphics_device_context.hpp>
 #include <graphics/opengl/gl_graphics_resources.hpp>
@@ -18,8 +20,18 @@ using namespace mango;
 static void GLAPIENTRY debugCallback(gl_enum source, gl_enum type, uint32 id, gl_enum severity, int32 length, const char* message, const void* userParam);
 #endif // MANGO DEBUG
 
+//! \brief Enables GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile if available.
+//! \return True if the driver compiles shaders in parallel, else false.
+static bool enable_parallel_shader_compile();
+
+//! \brief Checks if an opengl extension is available.
+//! \param[in] name The name of the extension.
+//! \return True if the extension is available, else false.
+static bool has_extension(const char* name);
+
 gl_graphics_device::gl_graphics_device(display_impl::native_window_handle display_window_handle)
     : m_display_window_handle(display_window_handle)
+    , m_shader_draw_parameters(false)
 {
     MANGO_ASSERT(m_display_window_handle, "Native window handle is invalid! Can not create gl_graphics_device!");
     glfwMakeContextCurrent(static_cast<GLFWwindow*>(m_display_window_handle));
@@ -48,14 +60,23 @@ gl_graphics_device::gl_graphics_device(display_impl::native_window_handle displa
     glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, NULL, GL_FALSE);
     MANGO_LOG_INFO("--  GL Debug Output Enabled               ");
 #endif // MANGO DEBUG
+
+    // let the driver compile shaders on its own threads, results are only queried when programs are used.
+    if (enable_parallel_shader_compile())
+        MANGO_LOG_INFO("--  Parallel Shader Compile Enabled         ");
+    m_shader_draw_parameters = has_extension("GL_ARB_shader_draw_parameters");
+    if (m_shader_draw_parameters)
+        MANGO_LOG_INFO("--  Shader Draw Parameters Available        ");
     MANGO_LOG_INFO("-------------------------------------------");
 
     glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS); // TODO Paul: This should at least be a specified feature!
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // Image data and mip levels are tightly packed.
 
     m_shared_graphics_state = make_gfx_handle<gl_graphics_state>();
-    m_shader_program_cache  = make_gfx_handle<gl_shader_program_cache>();
+    m_shader_program_cache  = make_gfx_handle<gl_shader_program_cache>("res/shader/cache/");
     m_framebuffer_cache     = make_gfx_handle<gl_framebuffer_cache>();
     m_vertex_array_cache    = make_gfx_handle<gl_vertex_array_cache>();
+    m_sampler_cache         = make_gfx_handle<gl_sampler_cache>();
 
     // In OpenGL we can not get render target textures for the default framebuffer, so lets fake them.
     texture_create_info info;
@@ -99,8 +120,13 @@ gl_graphics_device::~gl_graphics_device() {}
 
 graphics_device_context_handle gl_graphics_device::create_graphics_device_context(bool immediate) const
 {
-    MANGO_ASSERT(immediate, "Currently only immediate contexts are supported!");
-    return mango::make_unique<gl_graphics_device_context>(m_display_window_handle, m_shared_graphics_state, m_shader_program_cache, m_framebuffer_cache, m_vertex_array_cache);
+    graphics_device_context_handle immediate_context =
+        mango::make_unique<gl_graphics_device_context>(m_display_window_handle, m_shared_graphics_state, m_shader_program_cache, m_framebuffer_cache, m_vertex_array_cache);
+    if (immediate)
+        return immediate_context;
+
+    // Deferred contexts record on any thread and replay with their own immediate context on submit().
+    return mango::make_unique<deferred_graphics_device_context>(std::move(immediate_context));
 }
 
 gfx_handle<const gfx_shader_stage> gl_graphics_device::create_shader_stage(const shader_stage_create_info& info) const
@@ -153,14 +179,22 @@ compute_pipeline_create_info gl_graphics_device::provide_compute_pipeline_create
 
 gfx_handle<const gfx_pipeline> gl_graphics_device::create_graphics_pipeline(const graphics_pipeline_create_info& info) const
 {
+    // start compiling now, the program is checked when the pipeline is bound the first time.
+    m_shader_program_cache->prepare_shader_program(info.shader_stage_descriptor);
     return make_gfx_handle<const gl_graphics_pipeline>(std::forward<const graphics_pipeline_create_info&>(info));
 }
 
 gfx_handle<const gfx_pipeline> gl_graphics_device::create_compute_pipeline(const compute_pipeline_create_info& info) const
 {
+    m_shader_program_cache->prepare_shader_program(info.shader_stage_descriptor);
     return make_gfx_handle<const gl_compute_pipeline>(std::forward<const compute_pipeline_create_info&>(info));
 }
 
+void gl_graphics_device::wait_for_pipelines() const
+{
+    m_shader_program_cache->finish_pending();
+}
+
 gfx_handle<const gfx_buffer> gl_graphics_device::create_buffer(const buffer_create_info& info) const
 {
     return make_gfx_handle<const gl_buffer>(std::forward<const buffer_create_info&>(info));
@@ -178,7 +212,7 @@ gfx_handle<const gfx_image_texture_view> gl_graphics_device::create_image_textur
 
 gfx_handle<const gfx_sampler> gl_graphics_device::create_sampler(const sampler_create_info& info) const
 {
-    return make_gfx_handle<const gl_sampler>(std::forward<const sampler_create_info&>(info));
+    return m_sampler_cache->get_sampler(info);
 }
 
 gfx_handle<const gfx_texture> gl_graphics_device::get_swap_chain_render_target()
@@ -191,6 +225,24 @@ gfx_handle<const gfx_texture> gl_graphics_device::get_swap_chain_depth_stencil_t
     return m_swap_chain_depth_stencil_target;
 }
 
+void gl_graphics_device::collect_api_call_counters(int32& issued_calls, int32& skipped_calls)
+{
+    issued_calls                               = m_shared_graphics_state->api_calls.issued;
+    skipped_calls                              = m_shared_graphics_state->api_calls.skipped;
+    m_shared_graphics_state->api_calls.issued  = 0;
+    m_shared_graphics_state->api_calls.skipped = 0;
+}
+
+bool gl_graphics_device::supports_multi_draw_indirect() const
+{
+    return m_shader_draw_parameters;
+}
+
+int32 gl_graphics_device::get_live_sampler_count() const
+{
+    return m_sampler_cache->get_live_sampler_count();
+}
+
 void gl_graphics_device::on_display_framebuffer_resize(int32 width, int32 height)
 {
     // Swap chain framebuffers are resized with the window in opengl.
@@ -276,3 +328,43 @@ static void GLAPIENTRY debugCallback(gl_enum source, gl_enum type, uint32 id, gl
     MANGO_LOG_ERROR("------------------------------------------------");
 }
 #endif // MANGO_DEBUG
+
+static bool enable_parallel_shader_compile()
+{
+    using max_shader_compiler_threads_function = void(GLAPIENTRY*)(uint32 count);
+
+    int32 extension_count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+    for (int32 i = 0; i < extension_count; ++i)
+    {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        const char* function  = nullptr;
+        if (strcmp(extension, "GL_KHR_parallel_shader_compile") == 0)
+            function = "glMaxShaderCompilerThreadsKHR";
+        else if (strcmp(extension, "GL_ARB_parallel_shader_compile") == 0)
+            function = "glMaxShaderCompilerThreadsARB";
+        else
+            continue;
+
+        auto max_shader_compiler_threads = reinterpret_cast<max_shader_compiler_threads_function>(glfwGetProcAddress(function));
+        if (!max_shader_compiler_threads)
+            continue;
+
+        // 0xFFFFFFFF lets the driver choose the number of threads.
+        max_shader_compiler_threads(0xFFFFFFFF);
+        return true;
+    }
+    return false;
+}
+
+static bool has_extension(const char* name)
+{
+    int32 extension_count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+    for (int32 i = 0; i < extension_count; ++i)
+    {
+        if (strcmp(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)), name) == 0)
+            return true;
+    }
+    return false;
+}
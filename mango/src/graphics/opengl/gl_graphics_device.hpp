@@ -11,6 +11,7 @@
 #include <graphics/graphics_device.hpp>
 #include <graphics/opengl/gl_framebuffer_cache.hpp>
 #include <graphics/opengl/gl_graphics_state.hpp>
+#include <graphics/opengl/gl_sampler_cache.hpp>
 #include <graphics/opengl/gl_shader_program_cache.hpp>
 #include <graphics/opengl/gl_vertex_array_cache.hpp>
 
@@ -32,6 +33,7 @@ namespace mango
         compute_pipeline_create_info provide_compute_pipeline_create_info() override;
         gfx_handle<const gfx_pipeline> create_graphics_pipeline(const graphics_pipeline_create_info& info) const override;
         gfx_handle<const gfx_pipeline> create_compute_pipeline(const compute_pipeline_create_info& info) const override;
+        void wait_for_pipelines() const override;
         gfx_handle<const gfx_buffer> create_buffer(const buffer_create_info& info) const override;
         gfx_handle<const gfx_texture> create_texture(const texture_create_info& info) const override;
         gfx_handle<const gfx_image_texture_view> create_image_texture_view(gfx_handle<const gfx_texture> texture, int32 level) const override;
@@ -40,6 +42,11 @@ namespace mango
         gfx_handle<const gfx_texture> get_swap_chain_render_target() override;
         gfx_handle<const gfx_texture> get_swap_chain_depth_stencil_target() override;
 
+        bool supports_multi_draw_indirect() const override;
+
+        void collect_api_call_counters(int32& issued_calls, int32& skipped_calls) override;
+        int32 get_live_sampler_count() const override;
+
         void on_display_framebuffer_resize(int32 width, int32 height) override;
 
       private:
@@ -59,6 +66,11 @@ namespace mango
         gfx_handle<gl_framebuffer_cache> m_framebuffer_cache;
         //! \brief The shared \a gl_vertex_array_cache of the \a graphics_device.
         gfx_handle<gl_vertex_array_cache> m_vertex_array_cache;
+        //! \brief The shared \a gl_sampler_cache of the \a graphics_device.
+        gfx_handle<gl_sampler_cache> m_sampler_cache;
+
+        //! \brief True if GL_ARB_shader_draw_parameters is available, else false.
+        bool m_shader_draw_parameters;
     };
 } // namespace mango
 
@@ -9,9 +9,208 @@
 #define GLFW_INCLUDE_NONE // Do not include gl headers, will be done by ourselfs later on.
 #include <GLFW/glfw3.h>
 #include <mango/profile.hpp>
+#include <cstring>
 
 using namespace mango;
 
+//! \brief Counts a state changing opengl call as issued or skipped.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in] changed True if the state changes and the call has to be issued, else false.
+//! \return The value of changed.
+static inline bool count_state_change(gl_graphics_state& state, bool changed)
+{
+    if (changed)
+        state.api_calls.issued++;
+    else
+        state.api_calls.skipped++;
+    return changed;
+}
+
+//! \brief Enables or disables an opengl capability, if the cached state differs.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in,out] cached The cached state of the capability.
+//! \param[in] capability The opengl capability.
+//! \param[in] enabled True if the capability should be enabled, else false.
+static inline void set_capability(gl_graphics_state& state, int32& cached, gl_enum capability, bool enabled)
+{
+    if (!count_state_change(state, cached != (enabled ? 1 : 0)))
+        return;
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+    cached = enabled ? 1 : 0;
+}
+
+//! \brief Sets viewports, if the cached viewports differ.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in] first The index of the first viewport to set.
+//! \param[in] count The number of viewports to set.
+//! \param[in] viewports The viewports to set.
+static void set_viewports(gl_graphics_state& state, int32 first, int32 count, const gfx_viewport* viewports)
+{
+    auto& cache  = state.dynamic_state_cache;
+    bool changed = first + count > cache.viewport_count;
+    for (int32 i = 0; !changed && i < count; ++i)
+        changed = std::memcmp(&cache.viewports[first + i], &viewports[i], sizeof(gfx_viewport)) != 0;
+    if (!count_state_change(state, changed))
+        return;
+
+    // Viewport to ouput can be specified in the geometry shader. Default selection is viewport 0.
+    glViewportArrayv(first, count, &viewports[0].x);
+
+    std::copy(viewports, viewports + count, cache.viewports + first);
+    // only viewports without unknown ones in between are known
+    if (first <= std::max(cache.viewport_count, 0))
+        cache.viewport_count = std::max(cache.viewport_count, first + count);
+}
+
+//! \brief Sets scissor rectangles, if the cached scissor rectangles differ.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in] first The index of the first scissor rectangle to set.
+//! \param[in] count The number of scissor rectangles to set.
+//! \param[in] scissors The scissor rectangles to set.
+static void set_scissors(gl_graphics_state& state, int32 first, int32 count, const gfx_scissor_rectangle* scissors)
+{
+    auto& cache  = state.dynamic_state_cache;
+    bool changed = first + count > cache.scissor_count;
+    for (int32 i = 0; !changed && i < count; ++i)
+        changed = std::memcmp(&cache.scissors[first + i], &scissors[i], sizeof(gfx_scissor_rectangle)) != 0;
+    if (!count_state_change(state, changed))
+        return;
+
+    // Scissor are selected with the viewport in the geometry shader. Default selection is scissor 0.
+    glScissorArrayv(first, count, &scissors[0].x_offset);
+
+    std::copy(scissors, scissors + count, cache.scissors + first);
+    if (first <= std::max(cache.scissor_count, 0))
+        cache.scissor_count = std::max(cache.scissor_count, first + count);
+}
+
+//! \brief Sets the stencil function of some faces, if the cached state differs.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in] face GL_FRONT, GL_BACK or GL_FRONT_AND_BACK.
+//! \param[in] func The stencil compare function.
+//! \param[in] reference The stencil reference.
+//! \param[in] compare_mask The stencil compare mask.
+static void set_stencil_function(gl_graphics_state& state, gl_enum face, gl_enum func, uint32 reference, uint32 compare_mask)
+{
+    auto& cache  = state.pipeline_state_cache;
+    auto differs = [func, reference, compare_mask](const gl_graphics_state::stencil_face_cache& c)
+    { return c.compare_operator != func || c.reference != reference || c.compare_mask != compare_mask; };
+    bool front = face != GL_BACK;
+    bool back  = face != GL_FRONT;
+    if (!count_state_change(state, (front && differs(cache.stencil_front)) || (back && differs(cache.stencil_back))))
+        return;
+
+    glStencilFuncSeparate(face, func, reference, compare_mask);
+
+    for (auto* c : { front ? &cache.stencil_front : nullptr, back ? &cache.stencil_back : nullptr })
+    {
+        if (!c)
+            continue;
+        c->compare_operator = func;
+        c->reference        = reference;
+        c->compare_mask     = compare_mask;
+    }
+}
+
+//! \brief Sets the stencil operations of some faces, if the cached state differs.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in] face GL_FRONT, GL_BACK or GL_FRONT_AND_BACK.
+//! \param[in] fail The operation for samples failing the stencil test.
+//! \param[in] depth_fail The operation for samples passing the stencil but failing the depth test.
+//! \param[in] pass The operation for samples passing both tests.
+static void set_stencil_operation(gl_graphics_state& state, gl_enum face, gl_enum fail, gl_enum depth_fail, gl_enum pass)
+{
+    auto& cache  = state.pipeline_state_cache;
+    auto differs = [fail, depth_fail, pass](const gl_graphics_state::stencil_face_cache& c)
+    { return c.fail_operation != fail || c.depth_fail_operation != depth_fail || c.pass_operation != pass; };
+    bool front = face != GL_BACK;
+    bool back  = face != GL_FRONT;
+    if (!count_state_change(state, (front && differs(cache.stencil_front)) || (back && differs(cache.stencil_back))))
+        return;
+
+    glStencilOpSeparate(face, fail, depth_fail, pass);
+
+    for (auto* c : { front ? &cache.stencil_front : nullptr, back ? &cache.stencil_back : nullptr })
+    {
+        if (!c)
+            continue;
+        c->fail_operation       = fail;
+        c->depth_fail_operation = depth_fail;
+        c->pass_operation       = pass;
+    }
+}
+
+//! \brief Sets the stencil write mask of some faces, if the cached state differs.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in] face GL_FRONT, GL_BACK or GL_FRONT_AND_BACK.
+//! \param[in] write_mask The stencil write mask.
+static void set_stencil_write_mask(gl_graphics_state& state, gl_enum face, uint32 write_mask)
+{
+    auto& cache = state.pipeline_state_cache;
+    bool front  = face != GL_BACK;
+    bool back   = face != GL_FRONT;
+    if (!count_state_change(state, (front && cache.stencil_front.write_mask != write_mask) || (back && cache.stencil_back.write_mask != write_mask)))
+        return;
+
+    glStencilMaskSeparate(face, write_mask);
+
+    if (front)
+        cache.stencil_front.write_mask = write_mask;
+    if (back)
+        cache.stencil_back.write_mask = write_mask;
+}
+
+//! \brief Sets the shader program, if the cached one differs.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in] shader_program The \a gl_handle of the shader program.
+static inline void use_program(gl_graphics_state& state, gl_handle shader_program)
+{
+    if (!count_state_change(state, state.pipeline_state_cache.shader_program != static_cast<int32>(shader_program)))
+        return;
+    glUseProgram(shader_program);
+    state.pipeline_state_cache.shader_program = static_cast<int32>(shader_program);
+}
+
+//! \brief Sets the depth bias, if the cached one differs.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in] constant_factor The constant depth bias.
+//! \param[in] slope_factor The slope depth bias.
+static inline void set_polygon_offset(gl_graphics_state& state, float constant_factor, float slope_factor)
+{
+    auto& cache = state.dynamic_state_cache.depth;
+    if (!count_state_change(state, cache.constant_bias != constant_factor || cache.slope_bias != slope_factor))
+        return;
+    glPolygonOffset(slope_factor, constant_factor);
+    cache.constant_bias = constant_factor;
+    cache.slope_bias    = slope_factor;
+}
+
+//! \brief Sets the line width, if the cached one differs.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in] width The line width.
+static inline void set_line_width(gl_graphics_state& state, float width)
+{
+    if (!count_state_change(state, state.dynamic_state_cache.line_width != width))
+        return;
+    glLineWidth(width);
+    state.dynamic_state_cache.line_width = width;
+}
+
+//! \brief Sets the blend constants, if the cached ones differ.
+//! \param[in,out] state The \a gl_graphics_state to count the call in.
+//! \param[in] constants The blend constants.
+static inline void set_blend_color(gl_graphics_state& state, const float constants[4])
+{
+    float* cache = state.dynamic_state_cache.blend_constants;
+    if (!count_state_change(state, cache[0] != constants[0] || cache[1] != constants[1] || cache[2] != constants[2] || cache[3] != constants[3]))
+        return;
+    glBlendColor(constants[0], constants[1], constants[2], constants[3]);
+    std::copy(constants, constants + 4, cache);
+}
+
 gl_graphics_device_context::gl_graphics_device_context(display_impl::native_window_handle display_window_handle, gfx_handle<gl_graphics_state> shared_state,
                                                        gfx_handle<gl_shader_program_cache> shader_program_cache, gfx_handle<gl_framebuffer_cache> framebuffer_cache,
                                                        gfx_handle<gl_vertex_array_cache> vertex_array_cache)
@@ -34,7 +233,8 @@ gl_graphics_device_context::~gl_graphics_device_context()
 
 void gl_graphics_device_context::begin()
 {
-    // TODO Paul: Should we reset all state here?
+    // Other code (like the ui) could have changed the opengl state since the last recording.
+    m_shared_graphics_state->invalidate_pipeline_state();
     submitted = false;
     recording = true;
 }
@@ -101,8 +301,9 @@ void* gl_graphics_device_context::map_buffer_data(gfx_handle<const gfx_buffer> b
     MANGO_ASSERT(offset + size <= buf->m_info.size, "Buffer access out of bounds!");
     MANGO_ASSERT((buf->m_info.buffer_access & gfx_buffer_access::buffer_access_mapped_access_read_write) != gfx_buffer_access::buffer_access_none, "Buffer access violation!");
 
-    // TODO Paul: Check if that persistent and coherent stuff is correct.
-    return glMapNamedBufferRange(buf->m_buffer_gl_handle, offset, size, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    // The mapping flags have to match the storage flags, so write only buffers are not mapped for reading.
+    gl_bitfield access_bits = gfx_buffer_access_to_gl(buf->m_info.buffer_access) & (GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    return glMapNamedBufferRange(buf->m_buffer_gl_handle, offset, size, access_bits);
 }
 
 void gl_graphics_device_context::set_texture_data(gfx_handle<const gfx_texture> texture_handle, const texture_set_description& desc, void* data)
@@ -167,11 +368,7 @@ void gl_graphics_device_context::set_viewport(int32 first, int32 count, const gf
         return;
     }
 
-    // Viewport to ouput can be specified in the geometry shader. Default selection is viewport 0.
-    glViewportArrayv(first, count, &viewports[0].x);
-
-    // Update the graphics state.
-    std::copy(viewports, viewports + count, m_shared_graphics_state->dynamic_state_cache.viewports + first);
+    set_viewports(*m_shared_graphics_state, first, count, viewports);
 }
 
 void gl_graphics_device_context::set_scissor(int32 first, int32 count, const gfx_scissor_rectangle* scissors)
@@ -194,11 +391,7 @@ void gl_graphics_device_context::set_scissor(int32 first, int32 count, const gfx
         return;
     }
 
-    // Scissor are selected with the viewport in the geometry shader. Default selection is scissor 0.
-    glScissorArrayv(first, count, &scissors[0].x_offset);
-
-    // Update the graphics state.
-    std::copy(scissors, scissors + count, m_shared_graphics_state->dynamic_state_cache.scissors + first);
+    set_scissors(*m_shared_graphics_state, first, count, scissors);
 }
 
 void gl_graphics_device_context::set_line_width(float width)
@@ -221,10 +414,7 @@ void gl_graphics_device_context::set_line_width(float width)
         return;
     }
 
-    glLineWidth(width);
-
-    // Update the graphics state.
-    m_shared_graphics_state->dynamic_state_cache.line_width = width;
+    ::set_line_width(*m_shared_graphics_state, width);
 }
 
 void gl_graphics_device_context::set_depth_bias(float constant_factor, float clamp, float slope_factor)
@@ -251,12 +441,10 @@ void gl_graphics_device_context::set_depth_bias(float constant_factor, float cla
     // glPolygonOffsetClamp(slope_factor, constant_factor, clamp);
     MANGO_LOG_WARN("Clamping the depth bias is not supported in OpenGL (yet?)!");
 
-    glPolygonOffset(slope_factor, constant_factor);
+    set_polygon_offset(*m_shared_graphics_state, constant_factor, slope_factor);
 
     // Update the graphics state.
-    m_shared_graphics_state->dynamic_state_cache.depth.constant_bias = constant_factor;
-    m_shared_graphics_state->dynamic_state_cache.depth.bias_clamp    = clamp;
-    m_shared_graphics_state->dynamic_state_cache.depth.slope_bias    = slope_factor;
+    m_shared_graphics_state->dynamic_state_cache.depth.bias_clamp = clamp;
 }
 
 void gl_graphics_device_context::set_blend_constants(const float constants[4])
@@ -279,13 +467,7 @@ void gl_graphics_device_context::set_blend_constants(const float constants[4])
         return;
     }
 
-    glBlendColor(constants[0], constants[1], constants[2], constants[3]);
-
-    // Update the graphics state.
-    m_shared_graphics_state->dynamic_state_cache.blend_constants[0] = constants[0];
-    m_shared_graphics_state->dynamic_state_cache.blend_constants[1] = constants[1];
-    m_shared_graphics_state->dynamic_state_cache.blend_constants[2] = constants[2];
-    m_shared_graphics_state->dynamic_state_cache.blend_constants[3] = constants[3];
+    set_blend_color(*m_shared_graphics_state, constants);
 }
 
 void gl_graphics_device_context::set_stencil_compare_mask_and_reference(gfx_stencil_face_flag_bits face_mask, uint32 compare_mask, uint32 reference)
@@ -313,13 +495,13 @@ void gl_graphics_device_context::set_stencil_compare_mask_and_reference(gfx_sten
     gl_enum func = gfx_compare_operator_to_gl(info.depth_stencil_state.front.compare_operator);
 
     if ((face_mask & gfx_stencil_face_flag_bits::stencil_face_front_and_back_bit) == gfx_stencil_face_flag_bits::stencil_face_front_and_back_bit)
-        glStencilFunc(func, reference, compare_mask);
+        set_stencil_function(*m_shared_graphics_state, GL_FRONT_AND_BACK, func, reference, compare_mask);
     else if ((face_mask & gfx_stencil_face_flag_bits::stencil_face_front_bit) != gfx_stencil_face_flag_bits::stencil_face_none)
-        glStencilFuncSeparate(GL_FRONT, func, reference, compare_mask);
+        set_stencil_function(*m_shared_graphics_state, GL_FRONT, func, reference, compare_mask);
     else if ((face_mask & gfx_stencil_face_flag_bits::stencil_face_back_bit) != gfx_stencil_face_flag_bits::stencil_face_none)
     {
         func = gfx_compare_operator_to_gl(info.depth_stencil_state.back.compare_operator);
-        glStencilFuncSeparate(GL_BACK, func, reference, compare_mask);
+        set_stencil_function(*m_shared_graphics_state, GL_BACK, func, reference, compare_mask);
     }
 
     // Update the graphics state.
@@ -350,11 +532,11 @@ void gl_graphics_device_context::set_stencil_write_mask(gfx_stencil_face_flag_bi
     }
 
     if ((face_mask & gfx_stencil_face_flag_bits::stencil_face_front_and_back_bit) == gfx_stencil_face_flag_bits::stencil_face_front_and_back_bit)
-        glStencilMask(write_mask);
+        ::set_stencil_write_mask(*m_shared_graphics_state, GL_FRONT_AND_BACK, write_mask);
     else if ((face_mask & gfx_stencil_face_flag_bits::stencil_face_front_bit) != gfx_stencil_face_flag_bits::stencil_face_none)
-        glStencilMaskSeparate(GL_FRONT, write_mask);
+        ::set_stencil_write_mask(*m_shared_graphics_state, GL_FRONT, write_mask);
     else if ((face_mask & gfx_stencil_face_flag_bits::stencil_face_back_bit) != gfx_stencil_face_flag_bits::stencil_face_none)
-        glStencilMaskSeparate(GL_BACK, write_mask);
+        ::set_stencil_write_mask(*m_shared_graphics_state, GL_BACK, write_mask);
 
     // Update the graphics state.
     m_shared_graphics_state->dynamic_state_cache.stencil.write_face_mask = face_mask;
@@ -384,7 +566,8 @@ void gl_graphics_device_context::set_render_targets(int32 count, gfx_handle<cons
         {
             MANGO_ASSERT(depth_stencil_target && (static_gfx_handle_cast<const gl_texture>(depth_stencil_target)->m_texture_gl_handle == 0),
                          "Default framebuffer can not use another texture as depth buffer!");
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            if (count_state_change(*m_shared_graphics_state, m_shared_graphics_state->internal.framebuffer_name != 0))
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
             default_framebuffer = true;
             framebuffer         = 0;
         }
@@ -393,7 +576,8 @@ void gl_graphics_device_context::set_render_targets(int32 count, gfx_handle<cons
     if (!default_framebuffer)
     {
         framebuffer = m_framebuffer_cache->get_framebuffer(count, render_targets, depth_stencil_target);
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        if (count_state_change(*m_shared_graphics_state, m_shared_graphics_state->internal.framebuffer_name != static_cast<int32>(framebuffer)))
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
     }
 
     // Update the graphics state.
@@ -461,6 +645,36 @@ void gl_graphics_device_context::calculate_mipmaps(gfx_handle<const gfx_texture>
     glGenerateTextureMipmap(tex->m_texture_gl_handle);
 }
 
+void gl_graphics_device_context::copy_texture(gfx_handle<const gfx_texture> source, int32 source_layer, gfx_handle<const gfx_texture> destination, int32 destination_layer, int32 layer_count)
+{
+    GL_NAMED_PROFILE_ZONE("Copy Texture");
+    NAMED_PROFILE_ZONE("Copy Texture");
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    MANGO_ASSERT(source && destination, "Can not copy from or to no texture!");
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_texture>(source), "Source is not a gl_texture!");
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_texture>(destination), "Destination is not a gl_texture!");
+
+    gfx_handle<const gl_texture> src = static_gfx_handle_cast<const gl_texture>(source);
+    gfx_handle<const gl_texture> dst = static_gfx_handle_cast<const gl_texture>(destination);
+
+    if (src->m_texture_gl_handle == 0 || dst->m_texture_gl_handle == 0)
+    {
+        MANGO_LOG_ERROR("Can not copy from or to swap chain texture!");
+        return;
+    }
+
+    MANGO_ASSERT(src->m_info.width == dst->m_info.width && src->m_info.height == dst->m_info.height, "Textures to copy between have a different size!");
+    MANGO_ASSERT(src->m_info.texture_format == dst->m_info.texture_format, "Textures to copy between have a different format!");
+
+    glCopyImageSubData(src->m_texture_gl_handle, gfx_texture_type_to_gl(src->m_info.texture_type), 0, 0, 0, source_layer, dst->m_texture_gl_handle, gfx_texture_type_to_gl(dst->m_info.texture_type), 0,
+                       0, 0, destination_layer, src->m_info.width, src->m_info.height, layer_count);
+}
+
 void gl_graphics_device_context::clear_render_target(gfx_clear_attachment_flag_bits color_attachment, float clear_color[4])
 {
     GL_NAMED_PROFILE_ZONE("Clear Render Targets");
@@ -537,6 +751,17 @@ void gl_graphics_device_context::set_vertex_buffers(int32 count, gfx_handle<cons
 
     // Update the graphics state.
     MANGO_ASSERT(count < 16, "Too many vertex buffer bindings!"); // TODO Paul: Query max vertex buffers. GL_MAX_VERTEX_ATTRIB_BINDINGS
+
+    // Geometry sharing buffers keeps the vertex array bound.
+    bool unchanged = m_shared_graphics_state->vertex_buffer_count == count;
+    for (int32 i = 0; unchanged && i < count; ++i)
+    {
+        const vertex_buffer_data& set = m_shared_graphics_state->set_vertex_buffers[i];
+        unchanged                     = set.buffer == buffers[i] && set.binding == bindings[i] && set.offset == offsets[i];
+    }
+    if (unchanged)
+        return;
+
     m_shared_graphics_state->vertex_buffer_count = count;
     for (int32 i = 0; i < count; ++i)
     {
@@ -558,6 +783,9 @@ void gl_graphics_device_context::set_index_buffer(gfx_handle<const gfx_buffer> b
 
     // Creation of vertex arrays will be done later before drawing since we also need vertex buffers.
 
+    if (m_shared_graphics_state->set_index_buffer == buffer_handle && m_shared_graphics_state->index_type == index_type)
+        return;
+
     // Update the graphics state.
     m_shared_graphics_state->set_index_buffer = buffer_handle;
     m_shared_graphics_state->index_type       = index_type;
@@ -575,9 +803,13 @@ void gl_graphics_device_context::bind_pipeline(gfx_handle<const gfx_pipeline> pi
         return;
     }
 
+    // Only the state differing from the shadowed opengl state is set.
+    gl_graphics_state& state = *m_shared_graphics_state;
+    auto& cache              = state.pipeline_state_cache;
+
     if (!pipeline_handle)
     {
-        glUseProgram(0);
+        use_program(state, 0);
         return;
     }
 
@@ -591,93 +823,133 @@ void gl_graphics_device_context::bind_pipeline(gfx_handle<const gfx_pipeline> pi
 
         // Shader
         gl_handle shader_program = m_shader_program_cache->get_shader_program(info.shader_stage_descriptor);
-        glUseProgram(shader_program);
+        use_program(state, shader_program);
 
         // Input State has to be done, when set_vertex_buffers is called since we specify settings for the vertex arrays.
         // TODO Paul: Check if we could use the information to preorder the possible vertex arrays to save time later on.
         // Input Assembly is required on (indexed) draw calls and can not be set here.
 
         // Viewport State
-        // Viewport to ouput can be specified in the geometry shader. Default selection is viewport 0.
-        glViewportArrayv(0, info.viewport_state.viewport_count, &info.viewport_state.viewports[0].x);
-        // Scissor are selected with the viewport in the geometry shader. Default selection is scissor 0.
-        glScissorArrayv(0, info.viewport_state.scissor_count, &info.viewport_state.scissors[0].x_offset);
+        if (info.viewport_state.viewport_count > 0)
+            set_viewports(state, 0, info.viewport_state.viewport_count, &info.viewport_state.viewports[0]);
+        if (info.viewport_state.scissor_count > 0)
+            set_scissors(state, 0, info.viewport_state.scissor_count, &info.viewport_state.scissors[0]);
 
         // Raster State
-        glPolygonMode(GL_FRONT_AND_BACK, gfx_polygon_mode_to_gl(info.rasterization_state.polygon_mode)); // TODO Paul: Always Front And Back?
-        if (info.rasterization_state.cull_mode != gfx_cull_mode_flag_bits::mode_none)                    // TODO Paul: Add descriptor option maybe?
+        gl_enum polygon_mode = gfx_polygon_mode_to_gl(info.rasterization_state.polygon_mode);
+        if (count_state_change(state, cache.polygon_mode != polygon_mode))
         {
-            glEnable(GL_CULL_FACE);
+            glPolygonMode(GL_FRONT_AND_BACK, polygon_mode); // TODO Paul: Always Front And Back?
+            cache.polygon_mode = polygon_mode;
+        }
+        set_capability(state, cache.cull_face_enabled, GL_CULL_FACE, info.rasterization_state.cull_mode != gfx_cull_mode_flag_bits::mode_none); // TODO Paul: Add descriptor option maybe?
+        if (info.rasterization_state.cull_mode != gfx_cull_mode_flag_bits::mode_none)
+        {
+            gl_enum cull_face = GL_BACK;
             if ((info.rasterization_state.cull_mode & gfx_cull_mode_flag_bits::mode_front_and_back) == gfx_cull_mode_flag_bits::mode_front_and_back)
-                glCullFace(GL_FRONT_AND_BACK);
+                cull_face = GL_FRONT_AND_BACK;
             else if ((info.rasterization_state.cull_mode & gfx_cull_mode_flag_bits::mode_front) != gfx_cull_mode_flag_bits::mode_none)
-                glCullFace(GL_FRONT);
-            else if ((info.rasterization_state.cull_mode & gfx_cull_mode_flag_bits::mode_back) != gfx_cull_mode_flag_bits::mode_none)
-                glCullFace(GL_BACK);
+                cull_face = GL_FRONT;
+            if (count_state_change(state, cache.cull_face != cull_face))
+            {
+                glCullFace(cull_face);
+                cache.cull_face = cull_face;
+            }
+        }
+        gl_enum front_face = info.rasterization_state.front_face == gfx_front_face::counter_clockwise ? GL_CCW : GL_CW;
+        if (count_state_change(state, cache.front_face != front_face))
+        {
+            glFrontFace(front_face);
+            cache.front_face = front_face;
         }
-        else
-            glDisable(GL_CULL_FACE);
-        glFrontFace(info.rasterization_state.front_face == gfx_front_face::counter_clockwise ? GL_CCW : GL_CW);
         if (info.rasterization_state.enable_depth_bias)
-            glPolygonOffset(info.rasterization_state.depth_bias_slope_factor, info.rasterization_state.constant_depth_bias);
-        glLineWidth(info.rasterization_state.line_width);
+            set_polygon_offset(state, info.rasterization_state.constant_depth_bias, info.rasterization_state.depth_bias_slope_factor);
+        ::set_line_width(state, info.rasterization_state.line_width);
 
         // Depth Stencil State
+        set_capability(state, cache.depth_test_enabled, GL_DEPTH_TEST, info.depth_stencil_state.enable_depth_test);
         if (info.depth_stencil_state.enable_depth_test)
         {
-            glEnable(GL_DEPTH_TEST);
-            glDepthFunc(gfx_compare_operator_to_gl(info.depth_stencil_state.depth_compare_operator));
+            gl_enum depth_func = gfx_compare_operator_to_gl(info.depth_stencil_state.depth_compare_operator);
+            if (count_state_change(state, cache.depth_compare_operator != depth_func))
+            {
+                glDepthFunc(depth_func);
+                cache.depth_compare_operator = depth_func;
+            }
         }
-        else
-            glDisable(GL_DEPTH_TEST);
-        glDepthMask(info.depth_stencil_state.enable_depth_write);
+        int32 depth_write = info.depth_stencil_state.enable_depth_write ? 1 : 0;
+        if (count_state_change(state, cache.depth_write_enabled != depth_write))
+        {
+            glDepthMask(info.depth_stencil_state.enable_depth_write);
+            cache.depth_write_enabled = depth_write;
+        }
+        set_capability(state, cache.stencil_test_enabled, GL_STENCIL_TEST, info.depth_stencil_state.enable_stencil_test);
         if (info.depth_stencil_state.enable_stencil_test)
         {
-            glEnable(GL_STENCIL_TEST);
-            gl_enum func  = gfx_compare_operator_to_gl(info.depth_stencil_state.front.compare_operator);
-            gl_enum fail  = gfx_stencil_operation_to_gl(info.depth_stencil_state.front.fail_operation);
-            gl_enum pass  = gfx_stencil_operation_to_gl(info.depth_stencil_state.front.pass_operation);
-            gl_enum depth = gfx_stencil_operation_to_gl(info.depth_stencil_state.front.depth_fail_operation);
-            glStencilOpSeparate(GL_FRONT, fail, pass, depth);
-            glStencilFuncSeparate(GL_FRONT, func, info.depth_stencil_state.front.reference, info.depth_stencil_state.front.compare_mask);
-            glStencilMaskSeparate(GL_FRONT, info.depth_stencil_state.front.write_mask);
-            func  = gfx_compare_operator_to_gl(info.depth_stencil_state.back.compare_operator);
-            fail  = gfx_stencil_operation_to_gl(info.depth_stencil_state.back.fail_operation);
-            pass  = gfx_stencil_operation_to_gl(info.depth_stencil_state.back.pass_operation);
-            depth = gfx_stencil_operation_to_gl(info.depth_stencil_state.back.depth_fail_operation);
-            glStencilOpSeparate(GL_BACK, fail, pass, depth);
-            glStencilFuncSeparate(GL_BACK, func, info.depth_stencil_state.back.reference, info.depth_stencil_state.back.compare_mask);
-            glStencilMaskSeparate(GL_BACK, info.depth_stencil_state.back.write_mask);
+            const stencil_operation_description& front = info.depth_stencil_state.front;
+            const stencil_operation_description& back  = info.depth_stencil_state.back;
+            set_stencil_operation(state, GL_FRONT, gfx_stencil_operation_to_gl(front.fail_operation), gfx_stencil_operation_to_gl(front.depth_fail_operation),
+                                  gfx_stencil_operation_to_gl(front.pass_operation));
+            set_stencil_function(state, GL_FRONT, gfx_compare_operator_to_gl(front.compare_operator), front.reference, front.compare_mask);
+            ::set_stencil_write_mask(state, GL_FRONT, front.write_mask);
+            set_stencil_operation(state, GL_BACK, gfx_stencil_operation_to_gl(back.fail_operation), gfx_stencil_operation_to_gl(back.depth_fail_operation),
+                                  gfx_stencil_operation_to_gl(back.pass_operation));
+            set_stencil_function(state, GL_BACK, gfx_compare_operator_to_gl(back.compare_operator), back.reference, back.compare_mask);
+            ::set_stencil_write_mask(state, GL_BACK, back.write_mask);
         }
-        else
-            glDisable(GL_STENCIL_TEST);
 
         // Blend State
+        set_capability(state, cache.logic_operation_enabled, GL_COLOR_LOGIC_OP, info.blend_state.enable_logical_operation);
         if (info.blend_state.enable_logical_operation)
         {
-            glEnable(GL_COLOR_LOGIC_OP);
-            glLogicOp(gfx_logic_operator_to_gl(info.blend_state.logic_operator));
+            gl_enum logic_operator = gfx_logic_operator_to_gl(info.blend_state.logic_operator);
+            if (count_state_change(state, cache.logic_operator != logic_operator))
+            {
+                glLogicOp(logic_operator);
+                cache.logic_operator = logic_operator;
+            }
         }
         else
         {
-            glDisable(GL_COLOR_LOGIC_OP);
             // Blending is only enabled, when logic operation is disabled, so we can do that in here.
-            if (info.blend_state.blend_description.enable_blend)
+            const auto& blend = info.blend_state.blend_description;
+            set_capability(state, cache.blend_enabled, GL_BLEND, blend.enable_blend);
+            if (blend.enable_blend)
             {
-                glEnable(GL_BLEND);
-                glBlendColor(info.blend_state.blend_constants[0], info.blend_state.blend_constants[1], info.blend_state.blend_constants[2], info.blend_state.blend_constants[3]);
-                glBlendEquationSeparate(gfx_blend_operation_to_gl(info.blend_state.blend_description.color_blend_operation),
-                                        gfx_blend_operation_to_gl(info.blend_state.blend_description.alpha_blend_operation));
-                glBlendFuncSeparate(
-                    gfx_blend_factor_to_gl(info.blend_state.blend_description.src_color_blend_factor), gfx_blend_factor_to_gl(info.blend_state.blend_description.dst_color_blend_factor),
-                    gfx_blend_factor_to_gl(info.blend_state.blend_description.src_alpha_blend_factor), gfx_blend_factor_to_gl(info.blend_state.blend_description.dst_alpha_blend_factor));
+                set_blend_color(state, info.blend_state.blend_constants.data());
+
+                gl_enum color_operation = gfx_blend_operation_to_gl(blend.color_blend_operation);
+                gl_enum alpha_operation = gfx_blend_operation_to_gl(blend.alpha_blend_operation);
+                if (count_state_change(state, cache.color_blend_operation != color_operation || cache.alpha_blend_operation != alpha_operation))
+                {
+                    glBlendEquationSeparate(color_operation, alpha_operation);
+                    cache.color_blend_operation = color_operation;
+                    cache.alpha_blend_operation = alpha_operation;
+                }
+
+                gl_enum src_color = gfx_blend_factor_to_gl(blend.src_color_blend_factor);
+                gl_enum dst_color = gfx_blend_factor_to_gl(blend.dst_color_blend_factor);
+                gl_enum src_alpha = gfx_blend_factor_to_gl(blend.src_alpha_blend_factor);
+                gl_enum dst_alpha = gfx_blend_factor_to_gl(blend.dst_alpha_blend_factor);
+                if (count_state_change(state, cache.src_color_blend_factor != src_color || cache.dst_color_blend_factor != dst_color || cache.src_alpha_blend_factor != src_alpha ||
+                                                  cache.dst_alpha_blend_factor != dst_alpha))
+                {
+                    glBlendFuncSeparate(src_color, dst_color, src_alpha, dst_alpha);
+                    cache.src_color_blend_factor = src_color;
+                    cache.dst_color_blend_factor = dst_color;
+                    cache.src_alpha_blend_factor = src_alpha;
+                    cache.dst_alpha_blend_factor = dst_alpha;
+                }
             }
-            else
-                glDisable(GL_BLEND);
         }
         bool r, g, b, a;
         create_gl_color_mask(info.blend_state.blend_description.color_write_mask, r, g, b, a);
-        glColorMask(r, g, b, a);
+        int32 color_mask = (r ? 1 : 0) | (g ? 2 : 0) | (b ? 4 : 0) | (a ? 8 : 0);
+        if (count_state_change(state, cache.color_write_mask != color_mask))
+        {
+            glColorMask(r, g, b, a);
+            cache.color_write_mask = color_mask;
+        }
 
         // Dynamic state - Nothing to do here.
         // TODO Paul: Check if pipeline does set some dynamic states accidently or breaks while trying to set them.
@@ -691,14 +963,46 @@ void gl_graphics_device_context::bind_pipeline(gfx_handle<const gfx_pipeline> pi
 
         // Shader
         gl_handle shader_program = m_shader_program_cache->get_shader_program(info.shader_stage_descriptor);
-        glUseProgram(shader_program);
+        use_program(state, shader_program);
     }
 
+    // The vertex array depends on the vertex input state of the pipeline, even if the bound buffers stay the same.
+    if (graphics_pipeline && m_shared_graphics_state->bound_pipeline != pipeline_handle)
+        m_shared_graphics_state->internal.vertex_array_name = -1; // Invalidates.
+
     // Update the graphics state.
     m_shared_graphics_state->bound_pipeline               = static_gfx_handle_cast<const gl_pipeline>(pipeline_handle);
     m_shared_graphics_state->pipeline_resources_submitted = false;
 }
 
+void gl_graphics_device_context::set_shader_resource(const shader_resource_mapping::resource_slot& slot, gfx_handle<const gfx_device_object> resource)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    MANGO_ASSERT(m_shared_graphics_state->bound_pipeline, "No Pipeline is currently bound!");
+
+    m_shared_graphics_state->bound_pipeline->get_resource_mapping()->set(slot, resource);
+    m_shared_graphics_state->pipeline_resources_submitted = false;
+}
+
+void gl_graphics_device_context::set_shader_resource_buffer_range(const shader_resource_mapping::resource_slot& slot, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size)
+{
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    MANGO_ASSERT(m_shared_graphics_state->bound_pipeline, "No Pipeline is currently bound!");
+
+    m_shared_graphics_state->bound_pipeline->get_resource_mapping()->set_buffer_range(slot, buffer, offset, size);
+    m_shared_graphics_state->pipeline_resources_submitted = false;
+}
+
 void gl_graphics_device_context::submit_pipeline_state_resources()
 {
     if (!recording)
@@ -730,24 +1034,7 @@ void gl_graphics_device_context::draw(int32 vertex_count, int32 index_count, int
 
     const auto& info = static_gfx_handle_cast<const gl_graphics_pipeline>(m_shared_graphics_state->bound_pipeline)->m_info;
 
-    if (m_shared_graphics_state->internal.vertex_array_name < 0) // Invalid
-    {
-        vertex_array_data_descriptor desc;
-        desc.input_descriptor    = &info.vertex_input_state;
-        desc.vertex_count        = vertex_count;
-        desc.index_count         = index_count;
-        desc.vertex_buffer_count = m_shared_graphics_state->vertex_buffer_count;
-        desc.vertex_buffers      = &m_shared_graphics_state->set_vertex_buffers[0];
-        desc.index_buffer        = &m_shared_graphics_state->set_index_buffer;
-        desc.index_type          = gfx_format::invalid;
-        if (index_count > 0)
-            desc.index_type = m_shared_graphics_state->index_type;
-
-        gl_enum vertex_array = m_vertex_array_cache->get_vertex_array(desc);
-
-        m_shared_graphics_state->internal.vertex_array_name = vertex_array;
-    }
-    glBindVertexArray(m_shared_graphics_state->internal.vertex_array_name);
+    bind_vertex_array(info, vertex_count, index_count);
 
     MANGO_ASSERT(index_count == 0 || m_shared_graphics_state->set_index_buffer, "Indexed drawing without an index buffer bound");
     MANGO_ASSERT(base_vertex >= 0, "The base vertex index has to be greater than 0!");
@@ -771,6 +1058,40 @@ void gl_graphics_device_context::draw(int32 vertex_count, int32 index_count, int
     }
 }
 
+void gl_graphics_device_context::draw_indexed_indirect(gfx_handle<const gfx_buffer> indirect_buffer, int32 offset, int32 draw_count, int32 stride)
+{
+    GL_NAMED_PROFILE_ZONE("Draw Indexed Indirect");
+    NAMED_PROFILE_ZONE("Draw Indexed Indirect");
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return;
+    }
+
+    MANGO_ASSERT(m_shared_graphics_state->bound_pipeline, "No Pipeline is currently bound!");
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_graphics_pipeline>(m_shared_graphics_state->bound_pipeline), "Pipeline is not a graphics pipeline!");
+    MANGO_ASSERT(m_shared_graphics_state->set_index_buffer, "Indexed drawing without an index buffer bound");
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_buffer>(indirect_buffer), "Buffer is not a gl_buffer!");
+    MANGO_ASSERT(offset >= 0, "The offset of the commands has to be greater than 0!");
+    MANGO_ASSERT(draw_count >= 0, "The draw count has to be greater than 0!");
+
+    if (draw_count == 0)
+        return;
+
+    const auto& info = static_gfx_handle_cast<const gl_graphics_pipeline>(m_shared_graphics_state->bound_pipeline)->m_info;
+
+    // the index count is only required to be non zero, so the index buffer is part of the vertex array.
+    bind_vertex_array(info, 0, 1);
+
+    // not cached, opengl unbinds deleted buffers and a reused name would be mistaken as bound.
+    auto buffer = static_gfx_handle_cast<const gl_buffer>(indirect_buffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer->m_buffer_gl_handle);
+
+    const gfx_primitive_topology& topology = info.input_assembly_state.topology;
+    gl_enum type                           = gfx_format_to_gl(m_shared_graphics_state->index_type);
+    glMultiDrawElementsIndirect(gfx_primitive_topology_to_gl(topology), type, (unsigned char*)NULL + offset, draw_count, stride);
+}
+
 void gl_graphics_device_context::dispatch(int32 x, int32 y, int32 z)
 {
     GL_NAMED_PROFILE_ZONE("Dispatch");
@@ -855,6 +1176,29 @@ void gl_graphics_device_context::client_wait(gfx_handle<const gfx_semaphore> sem
     //    MANGO_LOG_DEBUG("Waited {0} ns.", waiting_time);
 }
 
+bool gl_graphics_device_context::is_signaled(gfx_handle<const gfx_semaphore> semaphore)
+{
+    NAMED_PROFILE_ZONE("Is Signaled");
+    if (!recording)
+    {
+        MANGO_LOG_WARN("Device context is not recording {0}!", __LINE__);
+        return false;
+    }
+
+    if (!semaphore)
+        return false;
+
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_semaphore>(semaphore), "Semaphore is not a gl_semaphore!");
+
+    GLsync sync_object = static_cast<GLsync>(static_gfx_handle_cast<const gl_semaphore>(semaphore)->m_semaphore_gl_handle);
+
+    if (!glIsSync(sync_object))
+        return false;
+    // a zero timeout only polls, the flush makes sure the fence is reached eventually.
+    gl_enum wait_return = glClientWaitSync(sync_object, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    return wait_return == GL_ALREADY_SIGNALED || wait_return == GL_CONDITION_SATISFIED;
+}
+
 void gl_graphics_device_context::wait(gfx_handle<const gfx_semaphore> semaphore)
 {
     GL_NAMED_PROFILE_ZONE("Wait");
@@ -898,3 +1242,29 @@ void gl_graphics_device_context::submit()
 
     submitted = true;
 }
+
+void gl_graphics_device_context::bind_vertex_array(const graphics_pipeline_create_info& info, int32 vertex_count, int32 index_count)
+{
+    if (m_shared_graphics_state->internal.vertex_array_name < 0) // Invalid
+    {
+        vertex_array_data_descriptor desc;
+        desc.input_descriptor    = &info.vertex_input_state;
+        desc.vertex_count        = vertex_count;
+        desc.index_count         = index_count;
+        desc.vertex_buffer_count = m_shared_graphics_state->vertex_buffer_count;
+        desc.vertex_buffers      = &m_shared_graphics_state->set_vertex_buffers[0];
+        desc.index_buffer        = &m_shared_graphics_state->set_index_buffer;
+        desc.index_type          = gfx_format::invalid;
+        if (index_count > 0)
+            desc.index_type = m_shared_graphics_state->index_type;
+
+        gl_enum vertex_array = m_vertex_array_cache->get_vertex_array(desc);
+
+        m_shared_graphics_state->internal.vertex_array_name = vertex_array;
+    }
+    if (count_state_change(*m_shared_graphics_state, m_shared_graphics_state->internal.bound_vertex_array_name != m_shared_graphics_state->internal.vertex_array_name))
+    {
+        glBindVertexArray(m_shared_graphics_state->internal.vertex_array_name);
+        m_shared_graphics_state->internal.bound_vertex_array_name = m_shared_graphics_state->internal.vertex_array_name;
+    }
+}
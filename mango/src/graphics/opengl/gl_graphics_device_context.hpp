@@ -45,23 +45,35 @@ namespace mango
         void set_stencil_write_mask(gfx_stencil_face_flag_bits face_mask, uint32 write_mask) override;
         void set_render_targets(int32 count, gfx_handle<const gfx_texture>* render_targets, gfx_handle<const gfx_texture> depth_stencil_target) override;
         void calculate_mipmaps(gfx_handle<const gfx_texture> texture_handle) override;
+        void copy_texture(gfx_handle<const gfx_texture> source, int32 source_layer, gfx_handle<const gfx_texture> destination, int32 destination_layer, int32 layer_count) override;
         void clear_render_target(gfx_clear_attachment_flag_bits color_attachment, float clear_color[4]) override;
         void clear_depth_stencil(gfx_clear_attachment_flag_bits depth_stencil, float clear_depth, int32 clear_stencil) override;
         void set_vertex_buffers(int32 count, gfx_handle<const gfx_buffer>* buffers, int32* bindings, int32* offsets) override;
         void set_index_buffer(gfx_handle<const gfx_buffer> buffer_handle, gfx_format index_type) override;
         void bind_pipeline(gfx_handle<const gfx_pipeline> pipeline_handle) override;
+        void set_shader_resource(const shader_resource_mapping::resource_slot& slot, gfx_handle<const gfx_device_object> resource) override;
+        void set_shader_resource_buffer_range(const shader_resource_mapping::resource_slot& slot, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size) override;
         void submit_pipeline_state_resources() override;
         void draw(int32 vertex_count, int32 index_count, int32 instance_count, int32 base_vertex, int32 base_instance, int32 index_offset) override;
+        void draw_indexed_indirect(gfx_handle<const gfx_buffer> indirect_buffer, int32 offset, int32 draw_count, int32 stride) override;
         void dispatch(int32 x, int32 y, int32 z) override;
         void end() override;
         void barrier(const barrier_description& desc) override;
         gfx_handle<const gfx_semaphore> fence(const semaphore_create_info& info) override;
         void client_wait(gfx_handle<const gfx_semaphore> semaphore) override;
+        bool is_signaled(gfx_handle<const gfx_semaphore> semaphore) override;
         void wait(gfx_handle<const gfx_semaphore> semaphore) override;
         void present() override;
         void submit() override;
 
       private:
+        //! \brief Binds the vertex array for the currently set vertex buffers, index buffer and bound \a gfx_pipeline.
+        //! \details Retrieves the vertex array from the \a gl_vertex_array_cache if the current one got invalidated.
+        //! \param[in] info The \a graphics_pipeline_create_info of the bound \a gfx_pipeline.
+        //! \param[in] vertex_count The number of vertices to draw.
+        //! \param[in] index_count The number of indices to draw, 0 for draws without index buffer.
+        void bind_vertex_array(const graphics_pipeline_create_info& info, int32 vertex_count, int32 index_count);
+
         //! \brief The handle of the platform window used to create the graphics api.
         display_impl::native_window_handle m_display_window_handle;
         //! \brief The shared \a gl_graphics_state of the \a graphics_device.
@@ -73,7 +85,7 @@ namespace mango
         //! \brief The shared \a gl_vertex_array_cache of the \a graphics_device.
         gfx_handle<gl_vertex_array_cache> m_vertex_array_cache;
 
-        // These are only to restrict everything in case we add deferred contexts.
+        // These restrict everything to the begin() ... end() submit() cycle, deferred contexts replay through the same one.
         //! \brief True if the \a gl_graphics_device context is currently in a recording state, else false.
         bool recording;
         //! \brief True if the \a gl_graphics_device context was submitted since the last begin() call, else false.
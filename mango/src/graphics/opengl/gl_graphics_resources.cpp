@@ -7,37 +7,58 @@
 #include <glad/glad.h>
 #include <graphics/opengl/gl_graphics_resources.hpp>
 #include <mango/profile.hpp>
+#include <util/hashing.hpp>
 
 using namespace mango;
 
 gl_shader_stage::gl_shader_stage(const shader_stage_create_info& info)
     : m_info(info)
+    , m_source(info.shader_source.source, info.shader_source.size)
 {
-    create_shader_from_source();
+    m_info.shader_source.source = m_source.c_str();
 
-    set_key(get_key_low(), m_shader_stage_gl_handle);
+    uint8 stage   = static_cast<uint8>(m_info.stage);
+    m_source_hash = fnv1a_hash::hash_bytes(&stage, sizeof(stage));
+    m_source_hash = fnv1a_hash::hash_bytes(m_source.data(), m_source.size(), m_source_hash);
 }
 
-void gl_shader_stage::create_shader_from_source()
+gl_handle gl_shader_stage::compile() const
 {
+    if (!m_compiled)
+    {
+        create_shader_from_source();
+        m_compiled = true;
+    }
+    return m_shader_stage_gl_handle;
+}
+
+void gl_shader_stage::create_shader_from_source() const
+{
+    PROFILE_ZONE;
     m_shader_stage_gl_handle = glCreateShader(gfx_shader_stage_type_to_gl(m_info.stage));
     glShaderSource(m_shader_stage_gl_handle, 1, &m_info.shader_source.source, &m_info.shader_source.size);
     MANGO_LOG_INFO("Entry point specification is currently not supported and is \"main\"!"); // TODO Paul
     glCompileShader(m_shader_stage_gl_handle);
+}
+
+bool gl_shader_stage::check_compile_status() const
+{
+    if (m_shader_stage_gl_handle == 0)
+        return false;
+
     int32 status = 0;
     glGetShaderiv(m_shader_stage_gl_handle, GL_COMPILE_STATUS, &status);
     if (GL_FALSE == status)
     {
         int32 log_size = 0;
         glGetShaderiv(m_shader_stage_gl_handle, GL_INFO_LOG_LENGTH, &log_size);
-        std::vector<char> info_log(log_size);
+        std::vector<char> info_log(log_size + 1, '\0');
         glGetShaderInfoLog(m_shader_stage_gl_handle, log_size, &log_size, info_log.data());
-        glDeleteShader(m_shader_stage_gl_handle);
-        m_shader_stage_gl_handle = 0;
 
         MANGO_LOG_ERROR("Shader compilation failed: {0} !", info_log.data());
-        return;
+        return false;
     }
+    return true;
 }
 
 gl_shader_stage::~gl_shader_stage()
@@ -177,8 +198,19 @@ bool gl_shader_resource_mapping::set(const string variable_name, gfx_handle<cons
         return false;
     }
 
-    int32 binding               = query->second.first;
-    gfx_shader_resource_type tp = query->second.second;
+    return set(query->second, resource);
+}
+
+bool gl_shader_resource_mapping::set(const resource_slot& slot, gfx_handle<const gfx_device_object> resource)
+{
+    if (slot.first < 0)
+    {
+        MANGO_LOG_ERROR("Shader resource slot is invalid!");
+        return false;
+    }
+
+    int32 binding               = slot.first;
+    gfx_shader_resource_type tp = slot.second;
 
     switch (tp)
     {
@@ -200,6 +232,8 @@ bool gl_shader_resource_mapping::set(const string variable_name, gfx_handle<cons
             device_pair.second = 3;
 
         device_pair.first = static_gfx_handle_cast<const gl_buffer>(resource);
+        if (binding < static_cast<int32>(m_buffer_ranges.size()))
+            m_buffer_ranges[binding] = { 0, 0 };
 
         break;
     }
@@ -272,6 +306,41 @@ bool gl_shader_resource_mapping::set(const string variable_name, gfx_handle<cons
     return true;
 }
 
+bool gl_shader_resource_mapping::set_buffer_range(const string variable_name, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size)
+{
+    auto query = m_name_to_binding_pair.find(variable_name);
+    if (query == m_name_to_binding_pair.end())
+    {
+        MANGO_LOG_ERROR("Mapping for {0} does not exist!", variable_name);
+        return false;
+    }
+
+    return set_buffer_range(query->second, buffer, offset, size);
+}
+
+bool gl_shader_resource_mapping::set_buffer_range(const resource_slot& slot, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size)
+{
+    int32 binding               = slot.first;
+    gfx_shader_resource_type tp = slot.second;
+    if (tp != gfx_shader_resource_type::shader_resource_constant_buffer && tp != gfx_shader_resource_type::shader_resource_buffer_storage)
+    {
+        MANGO_LOG_ERROR("Shader resource at binding {0} with type {1} is not a buffer!", binding, tp);
+        return false;
+    }
+
+    MANGO_ASSERT(std::dynamic_pointer_cast<const gl_buffer>(buffer), "buffer is not a gl_buffer");
+    MANGO_ASSERT(offset >= 0 && size > 0 && offset + size <= static_gfx_handle_cast<const gl_buffer>(buffer)->m_info.size, "Buffer range out of bounds!");
+
+    if (!set(slot, buffer))
+        return false;
+
+    if (static_cast<int32>(m_buffer_ranges.size()) <= binding)
+        m_buffer_ranges.resize(m_buffers.size(), { 0, 0 });
+    m_buffer_ranges[binding] = { offset, size };
+
+    return true;
+}
+
 gl_pipeline_resource_layout::gl_pipeline_resource_layout(std::initializer_list<shader_resource_binding> bindings)
     : m_bindings(std::forward<std::initializer_list<shader_resource_binding>>(bindings))
 {
@@ -614,38 +683,48 @@ void gl_pipeline::submit_pipeline_resources(gfx_handle<gfx_graphics_state> share
         auto& buffer = m_mapping->m_buffers[b];
         if (buffer.second == 0 || buffer.first->m_buffer_gl_handle == 0)
             continue;
+        if (b < static_cast<int32>(m_mapping->m_buffer_ranges.size()) && m_mapping->m_buffer_ranges[b].second > 0)
+        {
+            const auto& range = m_mapping->m_buffer_ranges[b];
+            glBindBufferRange(gfx_buffer_target_to_gl(buffer.first->m_info.buffer_target), b, buffer.first->m_buffer_gl_handle, range.first, range.second);
+            // ranges are not cached, so the next full binding of the buffer is not skipped.
+            shared_graphics_state->record_buffer_binding(buffer.first->m_info.buffer_target, b, nullptr);
+            continue;
+        }
         if (shared_graphics_state->is_buffer_bound(buffer.first->m_info.buffer_target, b, buffer.first->native_handle()))
             continue;
         glBindBufferBase(gfx_buffer_target_to_gl(buffer.first->m_info.buffer_target), b, buffer.first->m_buffer_gl_handle);
         shared_graphics_state->record_buffer_binding(buffer.first->m_info.buffer_target, b, buffer.first->native_handle());
     }
 
-    std::vector<gl_handle> gl_handles;
+    // fixed size, so binding the resources does not allocate once per draw.
+    std::array<gl_handle, 128> gl_handles;
+    uint32 handle_count = 0;
     int32 start_binding = 0;
 
     int32 textures_count = static_cast<int32>(m_mapping->m_textures.size());
-    gl_handles.reserve(textures_count);
+    MANGO_ASSERT(textures_count <= static_cast<int32>(gl_handles.size()), "Texture count does exceed maximum binding!");
     for (int32 b = 0; b < textures_count; ++b)
     {
         auto& texture = m_mapping->m_textures[b];
         if (texture.second == 0)
             continue;
         if (texture.first->m_texture_gl_handle > 0)
-            gl_handles.push_back(texture.first->m_texture_gl_handle);
+            gl_handles[handle_count++] = texture.first->m_texture_gl_handle;
         else
         {
-            if (gl_handles.size())
+            if (handle_count > 0)
             {
-                glBindTextures(start_binding, static_cast<uint32>(gl_handles.size()), gl_handles.data());
-                gl_handles.clear();
+                glBindTextures(start_binding, handle_count, gl_handles.data());
+                handle_count = 0;
             }
             start_binding = b + 1;
         }
     }
-    if (gl_handles.size())
+    if (handle_count > 0)
     {
-        glBindTextures(start_binding, static_cast<uint32>(gl_handles.size()), gl_handles.data());
-        gl_handles.clear();
+        glBindTextures(start_binding, handle_count, gl_handles.data());
+        handle_count = 0;
     }
 
     int32 texture_images_count = static_cast<int32>(m_mapping->m_texture_images.size());
@@ -691,29 +770,32 @@ void gl_pipeline::submit_pipeline_resources(gfx_handle<gfx_graphics_state> share
     }*/
 
     int32 sampler_count = static_cast<int32>(m_mapping->m_samplers.size());
-    gl_handles.reserve(sampler_count);
+    MANGO_ASSERT(sampler_count <= static_cast<int32>(gl_handles.size()), "Sampler count does exceed maximum binding!");
     start_binding = 0;
     for (int32 b = 0; b < sampler_count; ++b)
     {
         auto& sampler = m_mapping->m_samplers[b];
-        if (sampler.second == 0)
-            continue;
-        if (sampler.first->m_sampler_gl_handle > 0)
-            gl_handles.push_back(sampler.first->m_sampler_gl_handle);
+        // samplers are shared, so most of them are already bound.
+        if (sampler.second != 0 && sampler.first->m_sampler_gl_handle > 0 && !shared_graphics_state->is_sampler_bound(b, sampler.first->native_handle()))
+        {
+            if (handle_count == 0)
+                start_binding = b;
+            gl_handles[handle_count++] = sampler.first->m_sampler_gl_handle;
+            shared_graphics_state->record_sampler_binding(b, sampler.first->native_handle());
+        }
         else
         {
-            if (gl_handles.size())
+            if (handle_count > 0)
             {
-                glBindSamplers(start_binding, static_cast<uint32>(gl_handles.size()), gl_handles.data());
-                gl_handles.clear();
+                glBindSamplers(start_binding, handle_count, gl_handles.data());
+                handle_count = 0;
             }
             start_binding = b + 1;
         }
     }
-    if (gl_handles.size())
+    if (handle_count > 0)
     {
-        glBindSamplers(start_binding, static_cast<uint32>(gl_handles.size()), gl_handles.data());
-        gl_handles.clear();
+        glBindSamplers(start_binding, handle_count, gl_handles.data());
     }
 }
 
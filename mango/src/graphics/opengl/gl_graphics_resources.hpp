@@ -32,15 +32,34 @@ namespace mango
             return (void*)(uintptr)m_shader_stage_gl_handle;
         }
 
+        //! \brief Issues compiling the shader stage, if that was not done before.
+        //! \details Compilation is deferred until a shader program has to be linked,
+        //! so stages of programs loaded from the program binary cache never get compiled.
+        //! The result is not checked, so drivers can compile in parallel.
+        //! \return The native opengl handle of the shader.
+        gl_handle compile() const;
+
+        //! \brief Checks if compiling the shader stage succeeded and logs the errors if not.
+        //! \details Waits for the compilation to finish.
+        //! \return True if the shader stage compiled successfully, else false.
+        bool check_compile_status() const;
+
         //! \brief The \a shader_stage_create_info used for creation.
         shader_stage_create_info m_info;
-        //! \brief The native opengl handle.
-        gl_handle m_shader_stage_gl_handle = 0;
+        //! \brief The native opengl handle. 0 until the stage got compiled.
+        mutable gl_handle m_shader_stage_gl_handle = 0;
+        //! \brief Hash of the stage type and the shader source.
+        uint64 m_source_hash;
 
       private:
-        //! \brief Creates the shader stage from a shader source.
-        void create_shader_from_source();
+        //! \brief Creates the shader stage from a shader source without checking the result.
+        void create_shader_from_source() const;
         // void reflect();
+
+        //! \brief Copy of the shader source, the source of the \a shader_stage_create_info is only valid during creation.
+        string m_source;
+        //! \brief True if the compilation was already done.
+        mutable bool m_compiled = false;
     };
 
     //! \brief An opengl \a gfx_buffer.
@@ -187,8 +206,13 @@ namespace mango
         std::vector<resource_pair<const gl_sampler>> m_samplers;
         //! \brief List of \a gl_image_texture_views.
         std::vector<resource_pair<const gl_image_texture_view>> m_texture_images;
+        //! \brief Bound ranges (offset and size) of the \a gl_buffers, the whole buffer is bound if the size is 0.
+        std::vector<std::pair<int32, int32>> m_buffer_ranges;
 
         bool set(const string variable_name, gfx_handle<const gfx_device_object> resource) override;
+        bool set_buffer_range(const string variable_name, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size) override;
+        bool set(const resource_slot& slot, gfx_handle<const gfx_device_object> resource) override;
+        bool set_buffer_range(const resource_slot& slot, gfx_handle<const gfx_buffer> buffer, int32 offset, int32 size) override;
     };
 
     //! \brief An opengl \a pipeline_resource_layout.
@@ -443,6 +467,8 @@ namespace mango
             return GL_SHADER_STORAGE_BUFFER;
         case gfx_buffer_target::buffer_target_texture:
             return GL_TEXTURE_BUFFER;
+        case gfx_buffer_target::buffer_target_indirect:
+            return GL_DRAW_INDIRECT_BUFFER;
         default:
             MANGO_ASSERT(false, "Unknown sampler filter type!");
             return GL_NONE;
@@ -951,6 +977,8 @@ namespace mango
             barrier_bits |= GL_SHADER_STORAGE_BARRIER_BIT;
         if ((bits & gfx_barrier_bit::query_buffer_barrier_bit) != gfx_barrier_bit::unknown_barrier_bit)
             barrier_bits |= GL_QUERY_BUFFER_BARRIER_BIT;
+        if ((bits & gfx_barrier_bit::client_mapped_buffer_barrier_bit) != gfx_barrier_bit::unknown_barrier_bit)
+            barrier_bits |= GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT;
 
         return barrier_bits;
     }
@@ -9,15 +9,22 @@
 
 #include <graphics/graphics_state.hpp>
 #include <graphics/opengl/gl_graphics_resources.hpp>
+#include <limits>
 
 namespace mango
 {
     //! \brief An opengl \a gfx_graphics_state.
     struct gl_graphics_state : public gfx_graphics_state
     {
-        gl_graphics_state()  = default;
+        gl_graphics_state()
+        {
+            invalidate_pipeline_state();
+        }
         ~gl_graphics_state() = default;
 
+        //! \brief Value marking a \a gl_enum in the state cache as unknown.
+        static const gl_enum unknown_enum = 0xffffffffu;
+
         //! \brief The currently bound \a gfx_pipeline.
         gfx_handle<const gl_pipeline> bound_pipeline;
         //! \brief True if the \a gfx_pipeline shader resources were submitted, else false.
@@ -35,7 +42,7 @@ namespace mango
         gfx_handle<const gl_texture> set_render_targets[8 + 1]; // TODO Paul: Query max attachments.
 
         //! \brief The number of currently bound vertex buffers.
-        int32 vertex_buffer_count;
+        int32 vertex_buffer_count = 0;
 
         //! \brief The \a vertex_buffer_data of the currently bound vertex buffers.
         vertex_buffer_data set_vertex_buffers[16]; // TODO Paul: Query max vertex buffers. GL_MAX_VERTEX_ATTRIB_BINDINGS
@@ -43,7 +50,7 @@ namespace mango
         //! \brief The \a gfx_handle of the \a gfx_buffer currently bound as index buffer.
         gfx_handle<const gfx_buffer> set_index_buffer;
         //! \brief The \a gfx_format specifying the current index component type.
-        gfx_format index_type;
+        gfx_format index_type = gfx_format::invalid;
 
         struct
         {
@@ -51,8 +58,129 @@ namespace mango
             int32 framebuffer_name = -1;
             //! \brief The currently bound vertex array \a gl_handle. Represented as int32 to make invalidation possible.
             int32 vertex_array_name = -1;
+            //! \brief The vertex array \a gl_handle actually bound in opengl. Represented as int32 to make invalidation possible.
+            int32 bound_vertex_array_name = -1;
         } internal; //!< Internal data.
 
+        //! \brief Cached opengl state of one stencil face.
+        //! \details Masks and reference are stored as int64, so -1 can mark them as unknown.
+        struct stencil_face_cache
+        {
+            //! \brief The currently set stencil fail operation.
+            gl_enum fail_operation;
+            //! \brief The currently set stencil pass operation.
+            gl_enum pass_operation;
+            //! \brief The currently set depth fail operation.
+            gl_enum depth_fail_operation;
+            //! \brief The currently set stencil compare function.
+            gl_enum compare_operator;
+            //! \brief The currently set stencil reference.
+            int64 reference;
+            //! \brief The currently set stencil compare mask.
+            int64 compare_mask;
+            //! \brief The currently set stencil write mask.
+            int64 write_mask;
+        };
+
+        //! \brief Shadow of the opengl state set by binding \a gfx_pipelines.
+        //! \details Used to only issue calls for state that actually changes. Unknown values are marked with -1, \a unknown_enum or NaN.
+        struct
+        {
+            //! \brief The currently used shader program \a gl_handle.
+            int32 shader_program;
+            //! \brief The currently set polygon mode.
+            gl_enum polygon_mode;
+            //! \brief 1 if face culling is enabled, 0 if not.
+            int32 cull_face_enabled;
+            //! \brief The currently culled faces.
+            gl_enum cull_face;
+            //! \brief The currently set front face winding.
+            gl_enum front_face;
+            //! \brief 1 if depth testing is enabled, 0 if not.
+            int32 depth_test_enabled;
+            //! \brief The currently set depth compare function.
+            gl_enum depth_compare_operator;
+            //! \brief 1 if depth writing is enabled, 0 if not.
+            int32 depth_write_enabled;
+            //! \brief 1 if stencil testing is enabled, 0 if not.
+            int32 stencil_test_enabled;
+            //! \brief The stencil state of front faces.
+            stencil_face_cache stencil_front;
+            //! \brief The stencil state of back faces.
+            stencil_face_cache stencil_back;
+            //! \brief 1 if logical operations are enabled, 0 if not.
+            int32 logic_operation_enabled;
+            //! \brief The currently set logical operation.
+            gl_enum logic_operator;
+            //! \brief 1 if blending is enabled, 0 if not.
+            int32 blend_enabled;
+            //! \brief The currently set color blend equation.
+            gl_enum color_blend_operation;
+            //! \brief The currently set alpha blend equation.
+            gl_enum alpha_blend_operation;
+            //! \brief The currently set source color blend factor.
+            gl_enum src_color_blend_factor;
+            //! \brief The currently set destination color blend factor.
+            gl_enum dst_color_blend_factor;
+            //! \brief The currently set source alpha blend factor.
+            gl_enum src_alpha_blend_factor;
+            //! \brief The currently set destination alpha blend factor.
+            gl_enum dst_alpha_blend_factor;
+            //! \brief The currently set color write mask, one bit per component.
+            int32 color_write_mask;
+        } pipeline_state_cache; //!< Cache data for state set by pipelines.
+
+        struct
+        {
+            //! \brief The number of state changing calls issued to opengl.
+            int32 issued = 0;
+            //! \brief The number of state changing calls skipped, because the state was already set.
+            int32 skipped = 0;
+        } api_calls; //!< Counters for filtered api calls.
+
+        //! \brief Marks all cached pipeline and dynamic state as unknown.
+        //! \details Has to be called when opengl state could have been changed without the \a graphics_device_context.
+        void invalidate_pipeline_state()
+        {
+            const float unknown_float = std::numeric_limits<float>::quiet_NaN();
+
+            pipeline_state_cache.shader_program          = -1;
+            pipeline_state_cache.polygon_mode            = unknown_enum;
+            pipeline_state_cache.cull_face_enabled       = -1;
+            pipeline_state_cache.cull_face               = unknown_enum;
+            pipeline_state_cache.front_face              = unknown_enum;
+            pipeline_state_cache.depth_test_enabled      = -1;
+            pipeline_state_cache.depth_compare_operator  = unknown_enum;
+            pipeline_state_cache.depth_write_enabled     = -1;
+            pipeline_state_cache.stencil_test_enabled    = -1;
+            pipeline_state_cache.stencil_front           = { unknown_enum, unknown_enum, unknown_enum, unknown_enum, -1, -1, -1 };
+            pipeline_state_cache.stencil_back            = { unknown_enum, unknown_enum, unknown_enum, unknown_enum, -1, -1, -1 };
+            pipeline_state_cache.logic_operation_enabled = -1;
+            pipeline_state_cache.logic_operator          = unknown_enum;
+            pipeline_state_cache.blend_enabled           = -1;
+            pipeline_state_cache.color_blend_operation   = unknown_enum;
+            pipeline_state_cache.alpha_blend_operation   = unknown_enum;
+            pipeline_state_cache.src_color_blend_factor  = unknown_enum;
+            pipeline_state_cache.dst_color_blend_factor  = unknown_enum;
+            pipeline_state_cache.src_alpha_blend_factor  = unknown_enum;
+            pipeline_state_cache.dst_alpha_blend_factor  = unknown_enum;
+            pipeline_state_cache.color_write_mask        = -1;
+
+            dynamic_state_cache.viewport_count      = -1;
+            dynamic_state_cache.scissor_count       = -1;
+            dynamic_state_cache.line_width          = unknown_float;
+            dynamic_state_cache.depth.constant_bias = unknown_float;
+            dynamic_state_cache.depth.slope_bias    = unknown_float;
+            dynamic_state_cache.depth.bias_clamp    = unknown_float;
+            for (int32 i = 0; i < 4; ++i)
+                dynamic_state_cache.blend_constants[i] = unknown_float;
+
+            internal.bound_vertex_array_name = -1;
+
+            // the ui binds samplers as well.
+            resources.samplers.fill(unknown_enum);
+        }
+
         struct
         {
             //! \brief The number of currently active \a gfx_viewports.
@@ -108,6 +236,9 @@ namespace mango
             //! \brief List of \a gl_handles of the currently bound texture buffers.
             std::array<gl_handle, 128> texture_buffers; // TODO Paul: See shader_stage_create_info in graphics_resources -> Should be queried.
 
+            //! \brief List of \a gl_handles of the currently bound samplers. Unknown bindings are marked with \a unknown_enum.
+            std::array<gl_handle, 128> samplers; // TODO Paul: Query max texture units. GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS
+
         } resources; //!< Cache data for resources.
 
         bool is_buffer_bound(gfx_buffer_target target, int32 idx, void* native_handle) override
@@ -146,6 +277,16 @@ namespace mango
                 break;
             }
         }
+        bool is_sampler_bound(int32 idx, void* native_handle) override
+        {
+            MANGO_ASSERT(idx < 128, "Index does exceed maximum binding!");
+            return resources.samplers[idx] == static_cast<gl_handle>((uintptr)native_handle);
+        }
+        void record_sampler_binding(int32 idx, void* native_handle) override
+        {
+            MANGO_ASSERT(idx < 128, "Index does exceed maximum binding!");
+            resources.samplers[idx] = static_cast<gl_handle>((uintptr)native_handle);
+        }
     };
 } // namespace mango
 
@@ -0,0 +1,50 @@
+//! \file      gl_sampler_cache.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <graphics/opengl/gl_sampler_cache.hpp>
+#include <mango/profile.hpp>
+
+using namespace mango;
+
+gfx_handle<const gl_sampler> gl_sampler_cache::get_sampler(const sampler_create_info& info)
+{
+    PROFILE_ZONE;
+    sampler_key key;
+    key.info = info;
+
+    auto result = cache.find(key);
+    if (result != cache.end())
+    {
+        gfx_handle<const gl_sampler> shared = result->second.lock();
+        if (shared)
+            return shared;
+    }
+
+    // drop the entries of destroyed samplers before adding a new one.
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        if (it->second.expired())
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+
+    gfx_handle<const gl_sampler> created = make_gfx_handle<const gl_sampler>(info);
+    cache[key]                           = created;
+
+    return created;
+}
+
+int32 gl_sampler_cache::get_live_sampler_count() const
+{
+    int32 count = 0;
+    for (const auto& entry : cache)
+    {
+        if (!entry.second.expired())
+            count++;
+    }
+    return count;
+}
@@ -0,0 +1,85 @@
+//! \file      gl_sampler_cache.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_GL_SAMPLER_CACHE_HPP
+#define MANGO_GL_SAMPLER_CACHE_HPP
+
+#include <graphics/opengl/gl_graphics_resources.hpp>
+
+namespace mango
+{
+    //! \brief Cache for opengl samplers used internally.
+    //! \details Most samplers share one of a few configurations, so \a gl_samplers with the same \a sampler_create_info are shared.
+    class gl_sampler_cache
+    {
+      public:
+        gl_sampler_cache()  = default;
+        ~gl_sampler_cache() = default;
+
+        //! \brief Returns a \a gl_sampler for a given \a sampler_create_info.
+        //! \details Creates the \a gl_sampler if there is no living one with an equal \a sampler_create_info.
+        //! \param[in] info The \a sampler_create_info describing the sampler.
+        //! \return A \a gfx_handle of the shared \a gl_sampler.
+        gfx_handle<const gl_sampler> get_sampler(const sampler_create_info& info);
+
+        //! \brief Returns the number of opengl sampler objects alive.
+        //! \return The number of living \a gl_samplers created by the cache.
+        int32 get_live_sampler_count() const;
+
+      private:
+        //! \brief Key for caching samplers.
+        struct sampler_key
+        {
+            //! \brief The \a sampler_create_info of the cached \a gl_sampler.
+            sampler_create_info info;
+
+            //! \brief Comparison operator equal.
+            //! \param[in] other The other \a sampler_key.
+            //! \return True if other \a sampler_key is equal to the current one, else false.
+            bool operator==(const sampler_key& other) const
+            {
+                return info.sampler_min_filter == other.info.sampler_min_filter && info.sampler_max_filter == other.info.sampler_max_filter &&
+                       info.enable_comparison_mode == other.info.enable_comparison_mode && info.comparison_operator == other.info.comparison_operator &&
+                       info.edge_value_wrap_u == other.info.edge_value_wrap_u && info.edge_value_wrap_v == other.info.edge_value_wrap_v &&
+                       info.edge_value_wrap_w == other.info.edge_value_wrap_w && info.border_color == other.info.border_color &&
+                       info.enable_seamless_cubemap == other.info.enable_seamless_cubemap;
+            }
+        };
+
+        //! \brief Hash for \a sampler_keys.
+        struct sampler_key_hash
+        {
+            //! \brief Function call operator.
+            //! \details Hashes the \a sampler_key.
+            //! \param[in] k The \a sampler_key to hash.
+            //! \return The hash for the given \a sampler_key.
+            std::size_t operator()(const sampler_key& k) const
+            {
+                // https://stackoverflow.com/questions/1646807/quick-and-simple-hash-code-combinations/
+
+                size_t res = 17;
+                res        = res * 31 + std::hash<int32>()(static_cast<int32>(k.info.sampler_min_filter));
+                res        = res * 31 + std::hash<int32>()(static_cast<int32>(k.info.sampler_max_filter));
+                res        = res * 31 + std::hash<bool>()(k.info.enable_comparison_mode);
+                res        = res * 31 + std::hash<int32>()(static_cast<int32>(k.info.comparison_operator));
+                res        = res * 31 + std::hash<int32>()(static_cast<int32>(k.info.edge_value_wrap_u));
+                res        = res * 31 + std::hash<int32>()(static_cast<int32>(k.info.edge_value_wrap_v));
+                res        = res * 31 + std::hash<int32>()(static_cast<int32>(k.info.edge_value_wrap_w));
+                for (float c : k.info.border_color)
+                    res = res * 31 + std::hash<float>()(c);
+                res = res * 31 + std::hash<bool>()(k.info.enable_seamless_cubemap);
+
+                return res;
+            };
+        };
+
+        //! \brief The cache mapping \a sampler_keys to the \a gl_samplers created for them.
+        //! \details Only weak references are held, so samplers are still destroyed when not used anymore.
+        std::unordered_map<sampler_key, std::weak_ptr<const gl_sampler>, sampler_key_hash> cache;
+    };
+} // namespace mango
+
+#endif // MANGO_GL_SAMPLER_CACHE_HPP
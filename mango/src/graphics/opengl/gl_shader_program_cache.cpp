@@ -4,17 +4,76 @@
 //! \date      2022
 //! \copyright Apache License 2.0
 
+#include <cstdio>
+#include <fstream>
 #include <graphics/opengl/gl_shader_program_cache.hpp>
+#include <mango/profile.hpp>
+#include <util/hashing.hpp>
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
 
 using namespace mango;
 
-gl_shader_program_cache::gl_shader_program_cache() {}
+namespace
+{
+    //! \brief Magic number at the start of each program binary.
+    const uint32 program_binary_magic = 0x4250474d; // "MGPB"
+
+    //! \brief The header at the start of each program binary on disk.
+    struct program_binary_header
+    {
+        uint32 magic;
+        uint32 format;
+        uint64 binary_hash;
+        int64 size;
+    };
+
+    //! \brief Creates a folder, if it does not exist.
+    //! \param[in] path The path of the folder.
+    void create_folder(const string& path)
+    {
+#ifdef WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+} // namespace
+
+gl_shader_program_cache::gl_shader_program_cache(const string& binary_cache_path)
+    : m_binary_cache_path(binary_cache_path)
+    , m_pending_count(0)
+    , m_driver_hash(fnv1a_hash::offset_basis)
+    , m_binary_cache_enabled(false)
+{
+    int32 format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (m_binary_cache_path.empty() || format_count == 0)
+    {
+        MANGO_LOG_INFO("Shader program binary cache is disabled!");
+        return;
+    }
+
+    const gl_enum driver_strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for (gl_enum name : driver_strings)
+    {
+        const char* str = reinterpret_cast<const char*>(glGetString(name));
+        if (str)
+            m_driver_hash = fnv1a_hash::hash(str, m_driver_hash);
+    }
+
+    create_folder(m_binary_cache_path);
+    m_binary_cache_enabled = true;
+}
 
 gl_shader_program_cache::~gl_shader_program_cache()
 {
-    for (auto sp_handle : cache)
+    for (auto& entry : cache)
     {
-        glDeleteProgram(sp_handle.second);
+        glDeleteProgram(entry.second.program);
     }
     cache.clear();
 }
@@ -22,10 +81,64 @@ gl_shader_program_cache::~gl_shader_program_cache()
 gl_handle gl_shader_program_cache::get_shader_program(const graphics_shader_stage_descriptor& desc)
 {
     shader_program_key key;
+    gfx_handle<const gl_shader_stage> stages[max_shader_stages];
+    describe(desc, key, stages);
+
+    // TODO Paul: Check these!
+    MANGO_ASSERT(desc.vertex_shader_stage || desc.geometry_shader_stage, "Vertex or Geometry shader has to exist in a graphics pipeline!");
+    MANGO_ASSERT(desc.fragment_shader_stage, "Fragment shader has to exist in a graphics pipeline!");
+
+    program_entry& entry = get_entry(key, stages);
+    finish(entry);
+
+    return entry.program;
+}
+
+gl_handle gl_shader_program_cache::get_shader_program(const compute_shader_stage_descriptor& desc)
+{
+    shader_program_key key;
+    gfx_handle<const gl_shader_stage> stages[max_shader_stages];
+    describe(desc, key, stages);
 
+    MANGO_ASSERT(desc.compute_shader_stage, "Compute pipeline needs a compute shader stage!");
+
+    program_entry& entry = get_entry(key, stages);
+    finish(entry);
+
+    return entry.program;
+}
+
+void gl_shader_program_cache::prepare_shader_program(const graphics_shader_stage_descriptor& desc)
+{
+    shader_program_key key;
+    gfx_handle<const gl_shader_stage> stages[max_shader_stages];
+    if (describe(desc, key, stages))
+        get_entry(key, stages);
+}
+
+void gl_shader_program_cache::prepare_shader_program(const compute_shader_stage_descriptor& desc)
+{
+    shader_program_key key;
+    gfx_handle<const gl_shader_stage> stages[max_shader_stages];
+    if (describe(desc, key, stages))
+        get_entry(key, stages);
+}
+
+void gl_shader_program_cache::finish_pending()
+{
+    PROFILE_ZONE;
+    if (m_pending_count == 0)
+        return;
+
+    for (auto& entry : cache)
+    {
+        finish(entry.second);
+    }
+}
+
+bool gl_shader_program_cache::describe(const graphics_shader_stage_descriptor& desc, shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages])
+{
     key.stage_count = 0;
-    gl_handle handles[3];
-    handles[0] = handles[1] = handles[2] = 0;
 
     if (desc.vertex_shader_stage)
     {
@@ -35,7 +148,7 @@ gl_handle gl_shader_program_cache::get_shader_program(const graphics_shader_stag
         key.stage_types[key.stage_count]       = gfx_shader_stage_type::shader_stage_vertex;
         key.stage_count++;
 
-        handles[0] = vertex_shader->m_shader_stage_gl_handle;
+        stages[0] = vertex_shader;
     }
 
     if (desc.geometry_shader_stage)
@@ -46,7 +159,7 @@ gl_handle gl_shader_program_cache::get_shader_program(const graphics_shader_stag
         key.stage_types[key.stage_count]       = gfx_shader_stage_type::shader_stage_geometry;
         key.stage_count++;
 
-        handles[1] = geometry_shader->m_shader_stage_gl_handle;
+        stages[1] = geometry_shader;
     }
 
     if (desc.fragment_shader_stage)
@@ -57,31 +170,15 @@ gl_handle gl_shader_program_cache::get_shader_program(const graphics_shader_stag
         key.stage_types[key.stage_count]       = gfx_shader_stage_type::shader_stage_fragment;
         key.stage_count++;
 
-        handles[2] = fragment_shader->m_shader_stage_gl_handle;
+        stages[2] = fragment_shader;
     }
 
-    // TODO Paul: Check these!
-    MANGO_ASSERT(desc.vertex_shader_stage || desc.geometry_shader_stage, "Vertex or Geometry shader has to exist in a graphics pipeline!");
-    MANGO_ASSERT(desc.fragment_shader_stage, "Fragment shader has to exist in a graphics pipeline!");
-
-    auto result = cache.find(key);
-
-    if (result != cache.end())
-        return result->second;
-
-    gl_handle created = create(key.stage_count, handles);
-
-    cache.insert({ key, created });
-
-    return created;
+    return (desc.vertex_shader_stage || desc.geometry_shader_stage) && desc.fragment_shader_stage;
 }
 
-gl_handle gl_shader_program_cache::get_shader_program(const compute_shader_stage_descriptor& desc)
+bool gl_shader_program_cache::describe(const compute_shader_stage_descriptor& desc, shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages])
 {
-    shader_program_key key;
-
     key.stage_count = 0;
-    gl_handle handle;
 
     if (desc.compute_shader_stage)
     {
@@ -91,53 +188,167 @@ gl_handle gl_shader_program_cache::get_shader_program(const compute_shader_stage
         key.stage_types[key.stage_count]       = gfx_shader_stage_type::shader_stage_compute;
         key.stage_count++;
 
-        handle = compute_shader->m_shader_stage_gl_handle;
+        stages[0] = compute_shader;
     }
 
-    MANGO_ASSERT(desc.compute_shader_stage, "Compute pipeline needs a compute shader stage!");
+    return desc.compute_shader_stage != nullptr;
+}
 
+gl_shader_program_cache::program_entry& gl_shader_program_cache::get_entry(const shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages])
+{
     auto result = cache.find(key);
 
     if (result != cache.end())
         return result->second;
 
-    gl_handle created = create(key.stage_count, &handle);
+    program_entry& entry = cache[key];
+    for (int32 i = 0; i < max_shader_stages; ++i)
+        entry.stages[i] = stages[i];
 
-    cache.insert({ key, created });
+    begin(entry);
 
-    return created;
+    return entry;
 }
 
-gl_handle gl_shader_program_cache::create(int32 stage_count, gl_handle handles[max_shader_stages])
+void gl_shader_program_cache::begin(program_entry& entry)
 {
-    gl_handle program = glCreateProgram();
+    PROFILE_ZONE;
+    entry.binary_hash = m_driver_hash;
+    for (int32 i = 0; i < max_shader_stages; ++i)
+    {
+        if (entry.stages[i])
+            entry.binary_hash = fnv1a_hash::hash_bytes(&entry.stages[i]->m_source_hash, sizeof(uint64), entry.binary_hash);
+    }
+
+    entry.pending = true;
+    m_pending_count++;
+
+    if (m_binary_cache_enabled)
+    {
+        entry.program     = load_program_binary(entry.binary_hash);
+        entry.from_binary = entry.program != 0;
+        if (entry.from_binary)
+            return;
+    }
 
-    int32 limit = stage_count;
+    link_from_source(entry);
+}
+
+void gl_shader_program_cache::link_from_source(program_entry& entry)
+{
+    entry.program     = glCreateProgram();
+    entry.from_binary = false;
 
-    for (int32 i = 0; i < limit; ++i)
+    for (int32 i = 0; i < max_shader_stages; ++i)
     {
-        if (handles[i] > 0)
-            glAttachShader(program, handles[i]);
-        else
-            limit++;
+        if (!entry.stages[i])
+            continue;
+        gl_handle shader = entry.stages[i]->compile();
+        if (shader > 0)
+            glAttachShader(entry.program, shader);
     }
 
-    glLinkProgram(program);
+    if (m_binary_cache_enabled)
+        glProgramParameteri(entry.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(entry.program);
+}
+
+void gl_shader_program_cache::finish(program_entry& entry)
+{
+    if (!entry.pending)
+        return;
+    PROFILE_ZONE;
 
+    // querying the status waits for the driver.
     int32 status = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    glGetProgramiv(entry.program, GL_LINK_STATUS, &status);
+
+    if (GL_FALSE == status && entry.from_binary)
+    {
+        // drivers reject binaries they can not use anymore, the program is linked from source again then.
+        MANGO_LOG_DEBUG("Cached program binary {0:x} got rejected by the driver.", entry.binary_hash);
+        glDeleteProgram(entry.program);
+        link_from_source(entry);
+        glGetProgramiv(entry.program, GL_LINK_STATUS, &status);
+    }
+
     if (GL_FALSE == status)
     {
+        for (int32 i = 0; i < max_shader_stages; ++i)
+        {
+            if (entry.stages[i])
+                entry.stages[i]->check_compile_status();
+        }
+
         int32 log_length = 0;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
-        std::vector<char> info_log(log_length);
-        glGetProgramInfoLog(program, log_length, &log_length, info_log.data());
+        glGetProgramiv(entry.program, GL_INFO_LOG_LENGTH, &log_length);
+        std::vector<char> info_log(log_length + 1, '\0');
+        glGetProgramInfoLog(entry.program, log_length, &log_length, info_log.data());
 
-        glDeleteProgram(program);
+        glDeleteProgram(entry.program);
+        entry.program = 0;
 
         MANGO_LOG_ERROR("Program link failure : {0} !", info_log.data());
-        return 0;
     }
+    else if (m_binary_cache_enabled && !entry.from_binary)
+        store_program_binary(entry.binary_hash, entry.program);
+
+    entry.pending = false;
+    m_pending_count--;
+    for (int32 i = 0; i < max_shader_stages; ++i)
+        entry.stages[i] = nullptr;
+}
+
+gl_handle gl_shader_program_cache::load_program_binary(uint64 binary_hash)
+{
+    std::ifstream input_stream(get_program_binary_path(binary_hash), std::ios::in | std::ios::binary);
+    if (!input_stream.is_open())
+        return 0;
+
+    program_binary_header header;
+    if (!input_stream.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != program_binary_magic || header.binary_hash != binary_hash || header.size <= 0)
+        return 0;
+
+    std::vector<char> binary(static_cast<size_t>(header.size));
+    if (!input_stream.read(binary.data(), header.size))
+        return 0;
+
+    gl_handle program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), static_cast<int32>(header.size));
 
     return program;
 }
+
+void gl_shader_program_cache::store_program_binary(uint64 binary_hash, gl_handle program)
+{
+    int32 length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    gl_enum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    program_binary_header header;
+    header.magic       = program_binary_magic;
+    header.format      = format;
+    header.binary_hash = binary_hash;
+    header.size        = length;
+
+    std::ofstream output_stream(get_program_binary_path(binary_hash), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!output_stream.is_open())
+    {
+        MANGO_LOG_WARN("Writing program binary {0:x} failed!", binary_hash);
+        return;
+    }
+    output_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output_stream.write(binary.data(), length);
+}
+
+string gl_shader_program_cache::get_program_binary_path(uint64 binary_hash) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(binary_hash));
+    return m_binary_cache_path + name;
+}
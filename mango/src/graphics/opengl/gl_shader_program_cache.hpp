@@ -12,10 +12,16 @@
 namespace mango
 {
     //! \brief Cache for opengl shader programs used internally.
+    //! \details Linked programs are additionally stored as program binaries on disk, keyed by a hash of the sources of all stages and the driver.
+    //! When a program is found on disk, its stages are never compiled.
+    //! Programs can be prepared before they are used. Compiling and linking is then only issued and checked on first use or in finish_pending(),
+    //! so drivers supporting GL_KHR_parallel_shader_compile work on all of them at the same time.
     class gl_shader_program_cache
     {
       public:
-        gl_shader_program_cache();
+        //! \brief Constructs the \a gl_shader_program_cache. Requires a current opengl context.
+        //! \param[in] binary_cache_path The folder to store program binaries in. The binary cache is disabled if it is empty.
+        gl_shader_program_cache(const string& binary_cache_path);
         ~gl_shader_program_cache();
 
         //! \brief Returns the \a gl_handle of a specific gl shader program for a given \a graphics_shader_stage_descriptor.
@@ -30,11 +36,39 @@ namespace mango
         //! \return The \a gl_handle of a specific gl shader program for a given \a compute_shader_stage_descriptor.
         gl_handle get_shader_program(const compute_shader_stage_descriptor& desc);
 
+        //! \brief Starts creating the gl shader program for a given \a graphics_shader_stage_descriptor without waiting for it.
+        //! \details Does nothing if the program is already cached or if the descriptor is incomplete.
+        //! \param[in] desc The \a graphics_shader_stage_descriptor to use for creating the shader program.
+        void prepare_shader_program(const graphics_shader_stage_descriptor& desc);
+
+        //! \brief Starts creating the gl shader program for a given \a compute_shader_stage_descriptor without waiting for it.
+        //! \details Does nothing if the program is already cached or if the descriptor is incomplete.
+        //! \param[in] desc The \a compute_shader_stage_descriptor to use for creating the shader program.
+        void prepare_shader_program(const compute_shader_stage_descriptor& desc);
+
+        //! \brief Waits for all prepared shader programs to be compiled and linked.
+        void finish_pending();
+
         // TODO Paul: Invalidate?
       private:
         //! \brief The maximum number of shader stages.
         static const int32 max_shader_stages = 5; // For now // TODO Paul: Get HW capabilities ...
 
+        //! \brief A cached shader program.
+        struct program_entry
+        {
+            //! \brief The \a gl_handle of the opengl shader program.
+            gl_handle program = 0;
+            //! \brief The hash identifying the program binary.
+            uint64 binary_hash = 0;
+            //! \brief True if compiling or linking was issued, but the result was not checked yet.
+            bool pending = false;
+            //! \brief True if the program was created from a program binary.
+            bool from_binary = false;
+            //! \brief The \a gl_shader_stages of the program, kept alive while it is pending. Unused stages are nullptr.
+            gfx_handle<const gl_shader_stage> stages[max_shader_stages];
+        };
+
         //! \brief Key for caching shader programs.
         struct shader_program_key
         {
@@ -89,14 +123,65 @@ namespace mango
             };
         };
 
-        //! \brief Creates a shader program and returns th handle from opengl.
-        //! \param[in] stage_count The number of active stages.
-        //! \param[in] handles The \a gl_handles of the shaders.
-        //! \return The \a gl_handle of the created opengl framebuffer.
-        gl_handle create(int32 stage_count, gl_handle handles[max_shader_stages]);
-
-        //! \brief The cache mapping \a shader_program_keys to \a gl_handles of opengl shader programs.
-        std::unordered_map<shader_program_key, gl_handle, shader_program_key_hash> cache;
+        //! \brief Creates the key and collects the stages for a \a graphics_shader_stage_descriptor.
+        //! \param[in] desc The \a graphics_shader_stage_descriptor.
+        //! \param[out] key The \a shader_program_key for the descriptor.
+        //! \param[out] stages The \a gl_shader_stages of the descriptor, unused stages are nullptr.
+        //! \return True if the descriptor is complete, else false.
+        bool describe(const graphics_shader_stage_descriptor& desc, shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages]);
+        //! \brief Creates the key and collects the stages for a \a compute_shader_stage_descriptor.
+        //! \param[in] desc The \a compute_shader_stage_descriptor.
+        //! \param[out] key The \a shader_program_key for the descriptor.
+        //! \param[out] stages The \a gl_shader_stages of the descriptor, unused stages are nullptr.
+        //! \return True if the descriptor is complete, else false.
+        bool describe(const compute_shader_stage_descriptor& desc, shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages]);
+
+        //! \brief Returns the cached \a program_entry for a key and starts creating the program if it is not cached.
+        //! \param[in] key The \a shader_program_key of the program.
+        //! \param[in] stages The \a gl_shader_stages of the program, unused stages are nullptr.
+        //! \return The \a program_entry.
+        program_entry& get_entry(const shader_program_key& key, gfx_handle<const gl_shader_stage> stages[max_shader_stages]);
+
+        //! \brief Issues creating a shader program without checking the result.
+        //! \details Loads the program binary if it is cached on disk, else compiles and links the stages.
+        //! \param[in,out] entry The \a program_entry with the stages set.
+        void begin(program_entry& entry);
+
+        //! \brief Issues compiling and linking a shader program from the sources of its stages.
+        //! \param[in,out] entry The \a program_entry with the stages set.
+        void link_from_source(program_entry& entry);
+
+        //! \brief Waits for a pending shader program and checks the result.
+        //! \details Falls back to the sources if a program binary gets rejected and stores the binary of programs linked from source.
+        //! \param[in,out] entry The \a program_entry.
+        void finish(program_entry& entry);
+
+        //! \brief Issues creating a shader program from a program binary stored on disk.
+        //! \param[in] binary_hash The hash identifying the program binary.
+        //! \return The \a gl_handle of the created opengl shader program or 0 if there is no program binary.
+        gl_handle load_program_binary(uint64 binary_hash);
+
+        //! \brief Stores the program binary of a linked shader program on disk.
+        //! \param[in] binary_hash The hash identifying the program binary.
+        //! \param[in] program The \a gl_handle of the linked opengl shader program.
+        void store_program_binary(uint64 binary_hash, gl_handle program);
+
+        //! \brief Returns the path of a program binary on disk.
+        //! \param[in] binary_hash The hash identifying the program binary.
+        //! \return The path of the program binary.
+        string get_program_binary_path(uint64 binary_hash) const;
+
+        //! \brief The cache mapping \a shader_program_keys to \a program_entries of opengl shader programs.
+        std::unordered_map<shader_program_key, program_entry, shader_program_key_hash> cache;
+        //! \brief Number of pending \a program_entries in the cache.
+        int32 m_pending_count;
+
+        //! \brief The folder program binaries are stored in.
+        string m_binary_cache_path;
+        //! \brief Hash of the driver vendor, renderer and version, binaries of other drivers can not be loaded.
+        uint64 m_driver_hash;
+        //! \brief True if the driver supports program binaries and the binary cache is enabled.
+        bool m_binary_cache_enabled;
     };
 } // namespace mango
 
@@ -0,0 +1,152 @@
+//! \file      uniform_ring_buffer.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <cstring>
+#include <graphics/uniform_ring_buffer.hpp>
+#include <mango/profile.hpp>
+
+using namespace mango;
+
+const int32 uniform_ring_buffer::frame_count;
+const int32 uniform_ring_buffer::offset_alignment;
+
+uniform_ring_buffer::uniform_ring_buffer()
+    : m_device(nullptr)
+    , m_mapping(nullptr)
+    , m_current_frame(0)
+    , m_element_size(0)
+    , m_element_stride(0)
+    , m_capacity(0)
+    , m_frame_size(0)
+    , m_count(0)
+{
+}
+
+uniform_ring_buffer::~uniform_ring_buffer() {}
+
+bool uniform_ring_buffer::create(const graphics_device_handle& device, int32 element_size, int32 capacity, const string& name)
+{
+    PROFILE_ZONE;
+    MANGO_ASSERT(element_size > 0, "Element size has to be positive!");
+
+    m_device         = &device;
+    m_name           = name;
+    m_element_size   = element_size;
+    m_element_stride = ((element_size + offset_alignment - 1) / offset_alignment) * offset_alignment;
+    m_count          = 0;
+    m_current_frame  = 0;
+
+    return grow(std::max(capacity, 1));
+}
+
+int32 uniform_ring_buffer::allocate(const void* data)
+{
+    int32 index;
+    if (!m_free_list.empty())
+    {
+        index = m_free_list.back();
+        m_free_list.pop_back();
+    }
+    else
+    {
+        if (m_count == m_capacity && !grow(m_capacity * 2))
+            return -1;
+        index = m_count++;
+    }
+
+    write(index, data);
+    return index;
+}
+
+void uniform_ring_buffer::release(int32 index)
+{
+    if (index < 0 || index >= m_count)
+        return;
+
+    // pending writes of released elements are harmless, the data is just not used anymore.
+    m_free_list.push_back(index);
+}
+
+void uniform_ring_buffer::write(int32 index, const void* data)
+{
+    MANGO_ASSERT(index >= 0 && index < m_count, "Element index out of bounds!");
+
+    memcpy(m_shadow.data() + index * m_element_stride, data, m_element_size);
+
+    if (m_pending[index] == 0)
+        m_pending_list.push_back(index);
+    m_pending[index] = frame_count;
+}
+
+void uniform_ring_buffer::begin_frame(const graphics_device_context_handle& device_context)
+{
+    PROFILE_ZONE;
+    if (!m_mapping)
+        return;
+
+    // all commands recorded so far might read from the current slot.
+    semaphore_create_info semaphore_info;
+    m_frame_fences[m_current_frame] = device_context->fence(semaphore_info);
+
+    m_current_frame = (m_current_frame + 1) % frame_count;
+    device_context->client_wait(m_frame_fences[m_current_frame]);
+    m_frame_fences[m_current_frame] = nullptr;
+
+    uint8* slot = m_mapping + m_current_frame * m_frame_size;
+    for (size_t i = 0; i < m_pending_list.size();)
+    {
+        int32 index = m_pending_list[i];
+        memcpy(slot + index * m_element_stride, m_shadow.data() + index * m_element_stride, m_element_size);
+
+        if (--m_pending[index] > 0)
+        {
+            ++i;
+            continue;
+        }
+        m_pending_list[i] = m_pending_list.back();
+        m_pending_list.pop_back();
+    }
+}
+
+bool uniform_ring_buffer::grow(int32 capacity)
+{
+    PROFILE_ZONE;
+    MANGO_ASSERT(m_device, "Uniform ring buffer is not created!");
+
+    m_capacity   = capacity;
+    m_frame_size = m_capacity * m_element_stride;
+    m_shadow.resize(m_frame_size, 0);
+    m_pending.resize(m_capacity, 0);
+
+    // The old buffer is released by the driver, when it is not used anymore.
+    buffer_create_info buffer_info;
+    buffer_info.buffer_target = gfx_buffer_target::buffer_target_uniform;
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_mapped_access_write;
+    buffer_info.size          = m_frame_size * frame_count;
+    m_buffer                  = (*m_device)->create_buffer(buffer_info);
+    m_mapping                 = nullptr;
+    if (!check_creation(m_buffer.get(), m_name))
+        return false;
+
+    graphics_device_context_handle device_context = (*m_device)->create_graphics_device_context();
+    device_context->begin();
+    m_mapping = static_cast<uint8*>(device_context->map_buffer_data(m_buffer, 0, m_frame_size * frame_count));
+    device_context->end();
+    device_context->submit();
+    if (!check_mapping(m_mapping, m_name))
+        return false;
+
+    // the new buffer is not in use, so every slot gets the latest data.
+    for (int32 f = 0; f < frame_count; ++f)
+        memcpy(m_mapping + f * m_frame_size, m_shadow.data(), m_frame_size);
+    for (int32 index : m_pending_list)
+        m_pending[index] = 0;
+    m_pending_list.clear();
+    for (int32 f = 0; f < frame_count; ++f)
+        m_frame_fences[f] = nullptr;
+
+    return true;
+}
@@ -0,0 +1,128 @@
+//! \file      uniform_ring_buffer.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_UNIFORM_RING_BUFFER_HPP
+#define MANGO_UNIFORM_RING_BUFFER_HPP
+
+#include <graphics/graphics_device.hpp>
+#include <graphics/graphics_device_context.hpp>
+#include <graphics/graphics_resources.hpp>
+#include <mango/assert.hpp>
+#include <util/helpers.hpp>
+
+namespace mango
+{
+    //! \brief Persistently mapped, triple buffered storage for uniform data of many objects of the same type.
+    //! \details The buffer is split into one slot per frame in flight, each slot holds the data of all elements.
+    //! Writes are recorded on the cpu and copied into the slots with plain memcpy in \a begin_frame(), after the fence guarding the slot was waited on.
+    //! Elements are bound by offset, so no buffer object is required per element and no driver upload is issued per element.
+    class uniform_ring_buffer
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(uniform_ring_buffer)
+      public:
+        //! \brief The number of frame slots.
+        static const int32 frame_count = 3;
+        //! \brief The alignment of each element, large enough for every uniform buffer offset alignment.
+        static const int32 offset_alignment = 256;
+
+        uniform_ring_buffer();
+        ~uniform_ring_buffer();
+
+        //! \brief Creates the \a uniform_ring_buffer.
+        //! \param[in] device The \a graphics_device to create the buffer with.
+        //! \param[in] element_size The size of one element in bytes.
+        //! \param[in] capacity The initial number of elements. The buffer grows, if more are allocated.
+        //! \param[in] name The name of the buffer. Used for output.
+        //! \return True on success, else false.
+        bool create(const graphics_device_handle& device, int32 element_size, int32 capacity, const string& name);
+
+        //! \brief Allocates a new element.
+        //! \param[in] data Pointer to the initial data of the element, has to be element size large.
+        //! \return The index of the element.
+        int32 allocate(const void* data);
+
+        //! \brief Releases an element.
+        //! \param[in] index The index of the element to release.
+        void release(int32 index);
+
+        //! \brief Writes the data of an element.
+        //! \details The data is copied to the frame slots in the following calls of \a begin_frame().
+        //! \param[in] index The index of the element to write.
+        //! \param[in] data Pointer to the data to write, has to be element size large.
+        void write(int32 index, const void* data);
+
+        //! \brief Advances to the next frame slot.
+        //! \details Places a fence for the current slot, waits for the fence of the next slot and copies all pending writes into it.
+        //! Has to be called once per frame before any element is bound.
+        //! \param[in] device_context The recording \a graphics_device_context to use.
+        void begin_frame(const graphics_device_context_handle& device_context);
+
+        //! \brief Retrieves the \a gfx_buffer to bind.
+        //! \return The \a gfx_buffer of the \a uniform_ring_buffer.
+        inline const gfx_handle<const gfx_buffer>& get_buffer() const
+        {
+            return m_buffer;
+        }
+
+        //! \brief Retrieves the offset of an element in the current frame slot.
+        //! \param[in] index The index of the element.
+        //! \return The offset in bytes to bind the element with.
+        inline int32 offset(int32 index) const
+        {
+            MANGO_ASSERT(index >= 0 && index < m_capacity, "Element index out of bounds!");
+            return m_current_frame * m_frame_size + index * m_element_stride;
+        }
+
+        //! \brief Retrieves the size of one element.
+        //! \return The size of one element in bytes.
+        inline int32 element_size() const
+        {
+            return m_element_size;
+        }
+
+      private:
+        //! \brief Recreates the buffer with a larger capacity and copies all data into every slot.
+        //! \param[in] capacity The new number of elements.
+        //! \return True on success, else false.
+        bool grow(int32 capacity);
+
+        //! \brief The \a graphics_device used for creation.
+        const graphics_device_handle* m_device;
+        //! \brief The name of the buffer. Used for output.
+        string m_name;
+
+        //! \brief The persistently mapped \a gfx_buffer.
+        gfx_handle<const gfx_buffer> m_buffer;
+        //! \brief The mapping of the buffer.
+        uint8* m_mapping;
+        //! \brief One fence per frame slot.
+        gfx_handle<const gfx_semaphore> m_frame_fences[frame_count];
+        //! \brief The index of the current frame slot.
+        int32 m_current_frame;
+
+        //! \brief The size of one element in bytes.
+        int32 m_element_size;
+        //! \brief The aligned size of one element in bytes.
+        int32 m_element_stride;
+        //! \brief The number of elements fitting into one frame slot.
+        int32 m_capacity;
+        //! \brief The size of one frame slot in bytes.
+        int32 m_frame_size;
+        //! \brief The number of elements ever allocated, freed elements are reused first.
+        int32 m_count;
+
+        //! \brief Cpu copy of the latest data of all elements.
+        std::vector<uint8> m_shadow;
+        //! \brief Number of frame slots still missing the latest data per element.
+        std::vector<uint8> m_pending;
+        //! \brief The indices of all elements with pending writes.
+        std::vector<int32> m_pending_list;
+        //! \brief The indices of all released elements.
+        std::vector<int32> m_free_list;
+    };
+} // namespace mango
+
+#endif // MANGO_UNIFORM_RING_BUFFER_HPP
@@ -55,6 +55,8 @@ namespace mango
         virtual void* allocate(const int64 size)
         {
             int64 unaligned_address = allocate_unaligned(size);
+            if (unaligned_address < 0)
+                return nullptr;
             return reinterpret_cast<void*>(unaligned_address);
         }
 
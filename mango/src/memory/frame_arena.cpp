@@ -0,0 +1,80 @@
+//! \file      frame_arena.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <mango/assert.hpp>
+#include <mango/log.hpp>
+#include <memory/frame_arena.hpp>
+
+using namespace mango;
+
+frame_arena::frame_arena(const int64 frame_size)
+    : m_current(0)
+    , m_frame_usage(0)
+    , m_peak_usage(0)
+{
+    for (frame& f : m_frames)
+    {
+        f.memory = mango::make_unique<linear_allocator>(frame_size);
+        f.memory->init();
+    }
+}
+
+frame_arena::~frame_arena()
+{
+    for (frame& f : m_frames)
+    {
+        for (void* mem : f.overflow)
+            free(mem);
+    }
+}
+
+void frame_arena::begin_frame()
+{
+    m_peak_usage = std::max(m_peak_usage, m_frame_usage.load(std::memory_order_relaxed));
+
+    m_current = 1 - m_current;
+    frame& f  = m_frames[m_current];
+    for (void* mem : f.overflow)
+        free(mem);
+    f.overflow.clear();
+
+    // grow to the peak, so the next frames with the same load fit.
+    int64 size = f.memory->get_total_size();
+    if (m_peak_usage > size)
+    {
+        while (size < m_peak_usage)
+            size *= 2;
+        MANGO_LOG_DEBUG("Growing frame arena to {0} bytes.", size);
+        f.memory = mango::make_unique<linear_allocator>(size);
+        f.memory->init();
+    }
+
+    f.memory->reset();
+    m_frame_usage.store(0, std::memory_order_relaxed);
+}
+
+void* frame_arena::allocate(int64 size, int64 alignment)
+{
+    MANGO_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment has to be a power of two!");
+    int64 required = size + alignment - 1;
+    m_frame_usage.fetch_add(required, std::memory_order_relaxed);
+
+    void* mem = m_frames[m_current].memory->allocate(required);
+    if (!mem)
+    {
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        mem = malloc(required);
+        if (!mem)
+        {
+            MANGO_LOG_ERROR("Malloc failed! Frame arena out of memory!");
+            return nullptr;
+        }
+        m_frames[m_current].overflow.push_back(mem);
+    }
+
+    int64 address = reinterpret_cast<int64>(mem);
+    return reinterpret_cast<void*>((address + alignment - 1) & ~(alignment - 1));
+}
@@ -0,0 +1,143 @@
+//! \file      frame_arena.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_FRAME_ARENA_HPP
+#define MANGO_FRAME_ARENA_HPP
+
+#include <memory/linear_allocator.hpp>
+#include <mutex>
+#include <util/helpers.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief Scratch memory for data only living for one frame.
+    //! \details The arena is double buffered, memory allocated in one frame stays valid until the end of the next frame.
+    //! Each buffer is a \a linear_allocator, so allocating is a thread safe bump of an offset and freeing single allocations is not necessary.
+    //! When a frame needs more memory than available, the rest is allocated from the heap and the buffers grow on their next use,
+    //! so in steady state no heap allocations happen.
+    class frame_arena
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(frame_arena)
+      public:
+        //! \brief Constructs the \a frame_arena.
+        //! \param[in] frame_size The initial size of the memory for each frame in bytes.
+        frame_arena(const int64 frame_size);
+        ~frame_arena();
+
+        //! \brief Starts a new frame.
+        //! \details Invalidates all memory allocated in the frame before the last one. Has to be called when no other thread allocates.
+        void begin_frame();
+
+        //! \brief Allocates memory for the current frame.
+        //! \details Thread safe.
+        //! \param[in] size The size in bytes to allocate.
+        //! \param[in] alignment The alignment in bytes. Has to be a power of two.
+        //! \return A pointer to the allocated memory.
+        void* allocate(int64 size, int64 alignment);
+
+        //! \brief Returns the number of bytes allocated in the current frame.
+        //! \return The number of bytes allocated in the current frame, including memory that did not fit.
+        inline int64 get_frame_usage() const
+        {
+            return m_frame_usage.load(std::memory_order_relaxed);
+        }
+
+        //! \brief Returns the number of bytes reserved for one frame.
+        //! \return The size of the memory of the current frame in bytes.
+        inline int64 get_frame_size() const
+        {
+            return m_frames[m_current].memory->get_total_size();
+        }
+
+      private:
+        //! \brief The memory of one frame.
+        struct frame
+        {
+            unique_ptr<linear_allocator> memory; //!< The preallocated memory.
+            std::vector<void*> overflow;         //!< Heap allocations done after the memory was exhausted.
+        };
+
+        //! \brief The memory of both frames.
+        frame m_frames[2];
+        //! \brief The index of the current frame.
+        int32 m_current;
+        //! \brief The number of bytes allocated in the current frame.
+        std::atomic<int64> m_frame_usage;
+        //! \brief The largest number of bytes allocated in one frame.
+        int64 m_peak_usage;
+        //! \brief Mutex guarding the overflow allocations.
+        std::mutex m_overflow_mutex;
+    };
+
+    //! \brief STL compatible allocator using the memory of the current frame of a \a frame_arena.
+    //! \details Deallocation does nothing, the memory is released with the frame.
+    //! Containers using it must not outlive the next frame.
+    template <typename T>
+    class frame_allocator
+    {
+      public:
+        //! \brief Type of the allocated values.
+        using value_type = T;
+
+        //! \brief Constructs the \a frame_allocator.
+        //! \param[in] arena The \a frame_arena to allocate from.
+        frame_allocator(frame_arena& arena) noexcept
+            : m_arena(&arena)
+        {
+        }
+
+        //! \brief Constructs the \a frame_allocator from one for a different type.
+        //! \param[in] other The \a frame_allocator to copy the \a frame_arena from.
+        template <typename U>
+        frame_allocator(const frame_allocator<U>& other) noexcept
+            : m_arena(other.get_arena())
+        {
+        }
+
+        //! \brief Allocates memory for some values.
+        //! \param[in] count The number of values.
+        //! \return A pointer to the allocated memory.
+        T* allocate(std::size_t count)
+        {
+            return static_cast<T*>(m_arena->allocate(static_cast<int64>(count * sizeof(T)), alignof(T)));
+        }
+
+        //! \brief Does nothing, memory is released with the frame.
+        void deallocate(T*, std::size_t) noexcept {}
+
+        //! \brief Returns the \a frame_arena used by the allocator.
+        //! \return The \a frame_arena used by the allocator.
+        inline frame_arena* get_arena() const noexcept
+        {
+            return m_arena;
+        }
+
+      private:
+        //! \brief The \a frame_arena to allocate from.
+        frame_arena* m_arena;
+    };
+
+    //! \cond NO_COND
+    template <typename T, typename U>
+    inline bool operator==(const frame_allocator<T>& lhs, const frame_allocator<U>& rhs) noexcept
+    {
+        return lhs.get_arena() == rhs.get_arena();
+    }
+
+    template <typename T, typename U>
+    inline bool operator!=(const frame_allocator<T>& lhs, const frame_allocator<U>& rhs) noexcept
+    {
+        return lhs.get_arena() != rhs.get_arena();
+    }
+    //! \endcond
+
+    //! \brief A std::vector using the memory of the current frame.
+    template <typename T>
+    using frame_vector = std::vector<T, frame_allocator<T>>;
+} // namespace mango
+
+#endif // MANGO_FRAME_ARENA_HPP
@@ -11,6 +11,7 @@ using namespace mango;
 
 linear_allocator::linear_allocator(const int64 size)
     : allocator(size)
+    , m_offset(0)
 {
 }
 
@@ -22,17 +23,15 @@ linear_allocator::~linear_allocator()
 
 int64 linear_allocator::allocate_unaligned(const int64 size)
 {
-    int64 address = reinterpret_cast<int64>(m_start) + m_offset;
-
-    if (m_offset + size > m_total_size)
+    // out of memory is not an error here, callers decide how to handle it.
+    int64 offset = m_offset.load(std::memory_order_relaxed);
+    do
     {
-        MANGO_LOG_ERROR("Linear Allocator Out Of Memory!");
-        return -1;
-    }
-
-    m_offset += size;
+        if (offset + size > m_total_size)
+            return -1;
+    } while (!m_offset.compare_exchange_weak(offset, offset + size, std::memory_order_relaxed));
 
-    return address;
+    return reinterpret_cast<int64>(m_start) + offset;
 }
 
 void linear_allocator::free_memory_unaligned(void*)
@@ -42,5 +41,5 @@ void linear_allocator::free_memory_unaligned(void*)
 
 void linear_allocator::reset()
 {
-    m_offset = 0;
+    m_offset.store(0, std::memory_order_relaxed);
 }
@@ -7,12 +7,14 @@
 #ifndef MANGO_LINEAR_ALLOCATOR_HPP
 #define MANGO_LINEAR_ALLOCATOR_HPP
 
+#include <atomic>
 #include <memory/allocator.hpp>
 
 namespace mango
 {
     //! \brief A linear allocator.
     //! \details Memory is allocated on init and returned memory is placed in a linear fashion. Freeing memory is not possible without reseting the allocator.
+    //! Allocating is thread safe, resetting is not. When the memory is exhausted, allocate() returns nullptr.
     class linear_allocator : public allocator
     {
       public:
@@ -24,9 +26,23 @@ namespace mango
 
         void reset() override;
 
+        //! \brief Returns the number of bytes allocated since the last reset.
+        //! \return The number of bytes allocated.
+        inline int64 get_used_size() const
+        {
+            return m_offset.load(std::memory_order_relaxed);
+        }
+
+        //! \brief Returns the size of the managed memory.
+        //! \return The size of the managed memory in bytes.
+        inline int64 get_total_size() const
+        {
+            return m_total_size;
+        }
+
       private:
         //! \brief The current offset from the memory start.
-        int64 m_offset;
+        std::atomic<int64> m_offset;
 
         virtual int64 allocate_unaligned(const int64 size) override;
         void free_memory_unaligned(void* mem) override;
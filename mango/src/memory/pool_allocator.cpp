@@ -0,0 +1,518 @@
+//! \file      pool_allocator.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <mango/assert.hpp>
+#include <memory/pool_allocator.hpp>
+#ifdef WIN32
+#include <intrin.h>
+#endif // WIN32
+
+using namespace mango;
+
+//! \brief A region of memory requested from the system.
+//! \details The first block of the large block heap follows directly, the region ends with a used sentinel block of size zero.
+struct pool_allocator::region
+{
+    region* next; //!< The next region.
+    region* prev; //!< The previous region.
+    int64 size;   //!< The size of the region in bytes, including this header.
+    int64 pad;    //!< Padding to keep the blocks aligned.
+};
+
+//! \brief A block of the large block heap.
+//! \details The free list pointers are only valid if the block is free, they are part of the block data otherwise.
+struct pool_allocator::tlsf_block
+{
+    tlsf_block* prev_physical; //!< The block directly before this one in memory or nullptr if this is the first block of a region.
+    uint64 header;             //!< The size of the block data in bytes combined with the block flags.
+    tlsf_block* next_free;     //!< The next block in the same free list.
+    tlsf_block* prev_free;     //!< The previous block in the same free list.
+};
+
+//! \brief A slab of equally sized small blocks, stored in the data of a large block.
+//! \details Each small block is prefixed with the owning slab and a header marking it as small block.
+struct pool_allocator::slab
+{
+    slab* next;       //!< The next slab with free blocks of the same size class.
+    slab* prev;       //!< The previous slab with free blocks of the same size class.
+    uint8* free_list; //!< The first freed block. Each freed block stores the next one in its data.
+    int32 used;       //!< Number of used blocks.
+    int32 capacity;   //!< Number of blocks fitting in the slab.
+    int32 size_class; //!< The size class of the blocks.
+    int32 touched;    //!< Number of blocks used at least once, blocks after that are not initialized yet.
+};
+
+namespace
+{
+    //! \brief The alignment of all blocks as power of two.
+    const int32 alignment_log2 = 4;
+    //! \brief The alignment of all blocks.
+    const int64 block_alignment = 1 << alignment_log2;
+    //! \brief The size of the header in front of each block.
+    const int64 block_header_size = 16;
+    //! \brief The minimum size of a block of the large block heap. Free blocks need to store the list pointers.
+    const int64 min_block_size = 16;
+    //! \brief Flag marking a free block of the large block heap.
+    const uint64 block_free_flag = 1;
+    //! \brief Flag marking a small block.
+    const uint64 block_small_flag = 2;
+    //! \brief Mask for the flags of a block header.
+    const uint64 block_flag_mask = block_alignment - 1;
+    //! \brief The size of the slab header, rounded up to the block alignment.
+    const int64 slab_header_size = 48;
+    //! \brief The block sizes of the small size classes.
+    const int64 size_classes[] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048 };
+    //! \brief The largest size served by the small size classes.
+    const int64 small_size_limit = 2048;
+
+    //! \brief Returns the index of the highest set bit.
+    //! \param[in] value The value, must not be zero.
+    //! \return The index of the highest set bit.
+    inline int32 highest_bit(uint64 value)
+    {
+#ifdef WIN32
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int32>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif // WIN32
+    }
+
+    //! \brief Returns the index of the lowest set bit.
+    //! \param[in] value The value, must not be zero.
+    //! \return The index of the lowest set bit.
+    inline int32 lowest_bit(uint64 value)
+    {
+#ifdef WIN32
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<int32>(index);
+#else
+        return __builtin_ctzll(value);
+#endif // WIN32
+    }
+
+    //! \brief Rounds a size up to the block alignment.
+    //! \param[in] size The size in bytes.
+    //! \return The aligned size in bytes.
+    inline int64 align_size(int64 size)
+    {
+        return (size + block_alignment - 1) & ~(block_alignment - 1);
+    }
+
+    //! \brief Calculates the free list of the large block heap a block of a given size belongs to.
+    //! \details Sizes below 512 bytes are distributed linearly, larger sizes are split into 32 lists per power of two.
+    //! \param[in] size The size of the block in bytes.
+    //! \param[out] fl The first level index.
+    //! \param[out] sl The second level index.
+    inline void mapping_insert(int64 size, int32& fl, int32& sl)
+    {
+        const int32 sl_log2 = 5;
+        if (size < (1 << (sl_log2 + alignment_log2)))
+        {
+            fl = 0;
+            sl = static_cast<int32>(size >> alignment_log2);
+            return;
+        }
+        int32 bit = highest_bit(static_cast<uint64>(size));
+        sl        = static_cast<int32>(size >> (bit - sl_log2)) ^ (1 << sl_log2);
+        fl        = bit - (sl_log2 + alignment_log2) + 1;
+    }
+
+    //! \brief Rounds a size up to the next free list boundary, so every block in the list found for it is large enough.
+    //! \param[in] size The size in bytes.
+    //! \return The rounded size in bytes.
+    inline int64 round_search_size(int64 size)
+    {
+        const int32 sl_log2 = 5;
+        if (size < (1 << (sl_log2 + alignment_log2)))
+            return size;
+        return size + (int64(1) << (highest_bit(static_cast<uint64>(size)) - sl_log2)) - 1;
+    }
+
+    //! \brief Returns the size class for a small size.
+    //! \param[in] size The size in bytes, has to be smaller or equal small_size_limit.
+    //! \return The index of the smallest size class fitting the size.
+    inline int32 get_size_class(int64 size)
+    {
+        int32 size_class = 0;
+        while (size_classes[size_class] < size)
+            ++size_class;
+        return size_class;
+    }
+} // namespace
+
+pool_allocator::pool_allocator(const int64 region_size)
+    : allocator(0)
+    , m_fl_bitmap(0)
+    , m_regions(nullptr)
+    , m_region_size(region_size)
+{
+    static_assert(sizeof(region) % block_alignment == 0, "Region header breaks block alignment!");
+    static_assert(sizeof(slab) <= slab_header_size, "Slab header does not fit!");
+    static_assert(sizeof(size_classes) / sizeof(size_classes[0]) == size_class_count, "Size class count mismatch!");
+    std::fill(std::begin(m_sl_bitmap), std::end(m_sl_bitmap), 0u);
+    std::fill(&m_free_lists[0][0], &m_free_lists[0][0] + fl_index_count * sl_index_count, nullptr);
+    std::fill(std::begin(m_partial_slabs), std::end(m_partial_slabs), nullptr);
+}
+
+pool_allocator::~pool_allocator()
+{
+    reset();
+}
+
+void pool_allocator::init()
+{
+    reset();
+}
+
+void pool_allocator::reset()
+{
+    while (m_regions)
+    {
+        region* next = m_regions->next;
+        free(m_regions);
+        m_regions = next;
+    }
+
+    m_fl_bitmap = 0;
+    std::fill(std::begin(m_sl_bitmap), std::end(m_sl_bitmap), 0u);
+    std::fill(&m_free_lists[0][0], &m_free_lists[0][0] + fl_index_count * sl_index_count, nullptr);
+    std::fill(std::begin(m_partial_slabs), std::end(m_partial_slabs), nullptr);
+    m_statistics = pool_allocator_statistics();
+    m_total_size = 0;
+}
+
+pool_allocator_statistics pool_allocator::get_statistics() const
+{
+    pool_allocator_statistics result = m_statistics;
+    for (int32 fl = 0; fl < fl_index_count; ++fl)
+    {
+        for (int32 sl = 0; sl < sl_index_count; ++sl)
+        {
+            for (tlsf_block* block = m_free_lists[fl][sl]; block; block = block->next_free)
+            {
+                int64 size = static_cast<int64>(block->header & ~block_flag_mask);
+                result.free_bytes += size;
+                result.largest_free_block = std::max(result.largest_free_block, size);
+            }
+        }
+    }
+    if (result.free_bytes > 0)
+        result.fragmentation = 1.0f - static_cast<float>(result.largest_free_block) / static_cast<float>(result.free_bytes);
+
+    return result;
+}
+
+int64 pool_allocator::allocate_unaligned(const int64 size)
+{
+    int64 required = std::max(size, int64(1));
+    if (required <= small_size_limit)
+    {
+        int32 size_class = get_size_class(required);
+        int64 address    = allocate_small(size_class);
+        if (address < 0)
+        {
+            MANGO_LOG_ERROR("Pool Allocator Out Of Memory!");
+            return -1;
+        }
+        m_statistics.allocated_bytes += size_classes[size_class];
+        m_statistics.allocation_count++;
+        return address;
+    }
+
+    tlsf_block* block = allocate_large(required);
+    if (!block)
+    {
+        MANGO_LOG_ERROR("Pool Allocator Out Of Memory!");
+        return -1;
+    }
+    m_statistics.allocated_bytes += static_cast<int64>(block->header & ~block_flag_mask);
+    m_statistics.allocation_count++;
+    return reinterpret_cast<int64>(block) + block_header_size;
+}
+
+void pool_allocator::free_memory_unaligned(void* mem)
+{
+    if (!mem)
+        return;
+
+    uint64 header = reinterpret_cast<uint64*>(mem)[-1];
+    if (header & block_small_flag)
+    {
+        free_small(mem);
+        return;
+    }
+
+    MANGO_ASSERT(!(header & block_free_flag), "Freeing memory that is already free!");
+    tlsf_block* block = reinterpret_cast<tlsf_block*>(static_cast<uint8*>(mem) - block_header_size);
+    m_statistics.allocated_bytes -= static_cast<int64>(header & ~block_flag_mask);
+    m_statistics.allocation_count--;
+    free_large(block);
+}
+
+int64 pool_allocator::allocate_small(int32 size_class)
+{
+    slab* s = m_partial_slabs[size_class];
+    if (!s)
+    {
+        tlsf_block* block = allocate_large(slab_size);
+        if (!block)
+            return -1;
+
+        s             = reinterpret_cast<slab*>(reinterpret_cast<uint8*>(block) + block_header_size);
+        s->next       = nullptr;
+        s->prev       = nullptr;
+        s->free_list  = nullptr;
+        s->used       = 0;
+        s->capacity   = static_cast<int32>((slab_size - slab_header_size) / (block_header_size + size_classes[size_class]));
+        s->size_class = size_class;
+        s->touched    = 0;
+
+        m_partial_slabs[size_class] = s;
+        m_statistics.slab_count++;
+    }
+
+    uint8* mem = nullptr;
+    if (s->free_list)
+    {
+        mem          = s->free_list;
+        s->free_list = *reinterpret_cast<uint8**>(mem);
+    }
+    else
+    {
+        // blocks are only initialized on first use, so untouched pages of a slab are never committed.
+        mem                                = reinterpret_cast<uint8*>(s) + slab_header_size + s->touched * (block_header_size + size_classes[size_class]) + block_header_size;
+        reinterpret_cast<slab**>(mem)[-2]  = s;
+        reinterpret_cast<uint64*>(mem)[-1] = (static_cast<uint64>(size_class) << alignment_log2) | block_small_flag;
+        s->touched++;
+    }
+
+    s->used++;
+    if (s->used == s->capacity)
+    {
+        // full slabs are not in the partial list.
+        m_partial_slabs[size_class] = s->next;
+        if (s->next)
+            s->next->prev = nullptr;
+        s->next = nullptr;
+    }
+
+    return reinterpret_cast<int64>(mem);
+}
+
+void pool_allocator::free_small(void* mem)
+{
+    uint8* block     = static_cast<uint8*>(mem);
+    slab* s          = reinterpret_cast<slab**>(block)[-2];
+    int32 size_class = s->size_class;
+    MANGO_ASSERT(s->used > 0, "Freeing a small block of an empty slab!");
+
+    m_statistics.allocated_bytes -= size_classes[size_class];
+    m_statistics.allocation_count--;
+
+    bool was_full                     = s->used == s->capacity;
+    *reinterpret_cast<uint8**>(block) = s->free_list;
+    s->free_list                      = block;
+    s->used--;
+
+    if (was_full)
+    {
+        s->prev = nullptr;
+        s->next = m_partial_slabs[size_class];
+        if (s->next)
+            s->next->prev = s;
+        m_partial_slabs[size_class] = s;
+    }
+
+    // keep one empty slab per size class, so alternating allocations do not request and free slabs all the time.
+    if (s->used == 0 && (s->next || s->prev))
+    {
+        if (s->prev)
+            s->prev->next = s->next;
+        else
+            m_partial_slabs[size_class] = s->next;
+        if (s->next)
+            s->next->prev = s->prev;
+
+        m_statistics.slab_count--;
+        free_large(reinterpret_cast<tlsf_block*>(reinterpret_cast<uint8*>(s) - block_header_size));
+    }
+}
+
+pool_allocator::tlsf_block* pool_allocator::allocate_large(int64 size)
+{
+    int64 adjusted    = std::max(align_size(size), min_block_size);
+    tlsf_block* block = find_free_block(adjusted);
+    if (!block)
+    {
+        if (!add_region(round_search_size(adjusted)))
+            return nullptr;
+        block = find_free_block(adjusted);
+        MANGO_ASSERT(block, "New region does not contain a fitting block!");
+    }
+    remove_free_block(block);
+
+    int64 block_size = static_cast<int64>(block->header & ~block_flag_mask);
+    uint8* data      = reinterpret_cast<uint8*>(block) + block_header_size;
+    if (block_size - adjusted >= block_header_size + min_block_size)
+    {
+        // split off the remaining memory.
+        tlsf_block* remainder    = reinterpret_cast<tlsf_block*>(data + adjusted);
+        remainder->prev_physical = block;
+        remainder->header        = static_cast<uint64>(block_size - adjusted - block_header_size) | block_free_flag;
+
+        tlsf_block* next    = reinterpret_cast<tlsf_block*>(data + block_size);
+        next->prev_physical = remainder;
+        insert_free_block(remainder);
+
+        block_size = adjusted;
+    }
+    block->header = static_cast<uint64>(block_size);
+
+    return block;
+}
+
+void pool_allocator::free_large(tlsf_block* block)
+{
+    block->header |= block_free_flag;
+
+    // merge with the previous block.
+    tlsf_block* prev = block->prev_physical;
+    if (prev && (prev->header & block_free_flag))
+    {
+        remove_free_block(prev);
+        prev->header += block_header_size + (block->header & ~block_flag_mask);
+        block = prev;
+    }
+
+    // merge with the next block. The sentinel at the end of each region is never free.
+    tlsf_block* next = reinterpret_cast<tlsf_block*>(reinterpret_cast<uint8*>(block) + block_header_size + (block->header & ~block_flag_mask));
+    if (next->header & block_free_flag)
+    {
+        remove_free_block(next);
+        block->header += block_header_size + (next->header & ~block_flag_mask);
+        next = reinterpret_cast<tlsf_block*>(reinterpret_cast<uint8*>(block) + block_header_size + (block->header & ~block_flag_mask));
+    }
+    next->prev_physical = block;
+
+    // give completely free regions back, but keep the last one.
+    bool region_free = !block->prev_physical && (next->header & ~block_flag_mask) == 0;
+    if (region_free && m_statistics.region_count > 1)
+    {
+        remove_region(reinterpret_cast<region*>(reinterpret_cast<uint8*>(block) - sizeof(region)));
+        return;
+    }
+
+    insert_free_block(block);
+}
+
+bool pool_allocator::add_region(int64 size)
+{
+    int64 region_size = std::max(m_region_size, static_cast<int64>(sizeof(region)) + block_header_size + size + block_header_size);
+    region_size       = align_size(region_size);
+
+    region* r = static_cast<region*>(malloc(region_size));
+    if (!r)
+    {
+        MANGO_LOG_ERROR("Malloc failed! Pool Allocator can not grow!");
+        return false;
+    }
+    r->size = region_size;
+    r->prev = nullptr;
+    r->next = m_regions;
+    if (m_regions)
+        m_regions->prev = r;
+    m_regions = r;
+
+    int64 block_size        = region_size - static_cast<int64>(sizeof(region)) - 2 * block_header_size;
+    tlsf_block* block       = reinterpret_cast<tlsf_block*>(reinterpret_cast<uint8*>(r) + sizeof(region));
+    block->prev_physical    = nullptr;
+    block->header           = static_cast<uint64>(block_size) | block_free_flag;
+    tlsf_block* sentinel    = reinterpret_cast<tlsf_block*>(reinterpret_cast<uint8*>(block) + block_header_size + block_size);
+    sentinel->prev_physical = block;
+    sentinel->header        = 0;
+    insert_free_block(block);
+
+    m_statistics.reserved_bytes += region_size;
+    m_statistics.region_count++;
+    m_total_size = m_statistics.reserved_bytes;
+    return true;
+}
+
+void pool_allocator::remove_region(region* r)
+{
+    if (r->prev)
+        r->prev->next = r->next;
+    else
+        m_regions = r->next;
+    if (r->next)
+        r->next->prev = r->prev;
+
+    m_statistics.reserved_bytes -= r->size;
+    m_statistics.region_count--;
+    m_total_size = m_statistics.reserved_bytes;
+    free(r);
+}
+
+void pool_allocator::insert_free_block(tlsf_block* block)
+{
+    int32 fl, sl;
+    mapping_insert(static_cast<int64>(block->header & ~block_flag_mask), fl, sl);
+    MANGO_ASSERT(fl < fl_index_count, "Block too large for the pool allocator!");
+
+    tlsf_block* head = m_free_lists[fl][sl];
+    block->next_free = head;
+    block->prev_free = nullptr;
+    if (head)
+        head->prev_free = block;
+    m_free_lists[fl][sl] = block;
+    m_fl_bitmap |= uint64(1) << fl;
+    m_sl_bitmap[fl] |= 1u << sl;
+}
+
+void pool_allocator::remove_free_block(tlsf_block* block)
+{
+    int32 fl, sl;
+    mapping_insert(static_cast<int64>(block->header & ~block_flag_mask), fl, sl);
+
+    if (block->prev_free)
+        block->prev_free->next_free = block->next_free;
+    else
+        m_free_lists[fl][sl] = block->next_free;
+    if (block->next_free)
+        block->next_free->prev_free = block->prev_free;
+
+    if (!m_free_lists[fl][sl])
+    {
+        m_sl_bitmap[fl] &= ~(1u << sl);
+        if (!m_sl_bitmap[fl])
+            m_fl_bitmap &= ~(uint64(1) << fl);
+    }
+}
+
+pool_allocator::tlsf_block* pool_allocator::find_free_block(int64 size)
+{
+    int32 fl, sl;
+    mapping_insert(round_search_size(size), fl, sl);
+    if (fl >= fl_index_count)
+        return nullptr;
+
+    // any block in a list with a higher index fits.
+    uint32 sl_map = m_sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map)
+    {
+        uint64 fl_map = m_fl_bitmap & (~uint64(0) << (fl + 1));
+        if (!fl_map)
+            return nullptr;
+        fl     = lowest_bit(fl_map);
+        sl_map = m_sl_bitmap[fl];
+    }
+    sl = lowest_bit(sl_map);
+
+    return m_free_lists[fl][sl];
+}
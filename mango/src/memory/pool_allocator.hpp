@@ -0,0 +1,122 @@
+//! \file      pool_allocator.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_POOL_ALLOCATOR_HPP
+#define MANGO_POOL_ALLOCATOR_HPP
+
+#include <memory/allocator.hpp>
+
+namespace mango
+{
+    //! \brief Statistics of a \a pool_allocator.
+    struct pool_allocator_statistics
+    {
+        int64 reserved_bytes     = 0; //!< Memory requested from the system in bytes.
+        int64 allocated_bytes    = 0; //!< Memory handed out to the user in bytes, including the rounding to the block sizes.
+        int64 free_bytes         = 0; //!< Memory in free blocks of the large block heap in bytes.
+        int64 largest_free_block = 0; //!< The size of the largest free block of the large block heap in bytes.
+        int32 allocation_count   = 0; //!< Number of live allocations.
+        int32 region_count       = 0; //!< Number of regions requested from the system.
+        int32 slab_count         = 0; //!< Number of slabs used for small blocks.
+        float fragmentation      = 0.0f; //!< Fragmentation of the large block heap. 0 if all free memory is one block, close to 1 if it is scattered in small blocks.
+    };
+
+    //! \brief A general purpose allocator with segregated size classes.
+    //! \details Small blocks are served from slabs of equally sized blocks per size class.
+    //! Larger blocks and the slabs themselves are managed by a two level segregated fit heap (TLSF).
+    //! Allocating and freeing is O(1) in both cases.
+    //! Memory is requested from the system in regions on demand and regions are given back as soon as they are completely free.
+    //! The allocator is not thread safe.
+    class pool_allocator : public allocator
+    {
+      public:
+        //! \brief Constructs the \a pool_allocator.
+        //! \details Does not allocate any memory. To use the allocator init() has to be called.
+        //! \param[in] region_size The size of the memory regions requested from the system when the allocator grows. Larger blocks get a region of their own size.
+        pool_allocator(const int64 region_size);
+        ~pool_allocator();
+
+        //! \brief Initializes the \a pool_allocator.
+        //! \details Does not reserve any memory, the first region is requested by the first allocation.
+        void init() override;
+        void reset() override;
+
+        //! \brief Returns the current statistics of the \a pool_allocator.
+        //! \return The \a pool_allocator_statistics.
+        pool_allocator_statistics get_statistics() const;
+
+      private:
+        struct region;
+        struct tlsf_block;
+        struct slab;
+
+        //! \brief Number of second level lists per first level of the large block heap as power of two.
+        static const int32 sl_index_log2 = 5;
+        //! \brief Number of second level lists per first level of the large block heap.
+        static const int32 sl_index_count = 1 << sl_index_log2;
+        //! \brief Number of first level lists of the large block heap.
+        static const int32 fl_index_count = 40;
+        //! \brief Number of small block size classes.
+        static const int32 size_class_count = 14;
+        //! \brief The size of a slab.
+        static const int64 slab_size = 65536;
+
+        virtual int64 allocate_unaligned(const int64 size) override;
+        void free_memory_unaligned(void* mem) override;
+
+        //! \brief Allocates a small block from the slabs of a size class.
+        //! \param[in] size_class The size class of the block.
+        //! \return The address of the block or -1 if out of memory.
+        int64 allocate_small(int32 size_class);
+        //! \brief Frees a small block.
+        //! \param[in] mem The block to free.
+        void free_small(void* mem);
+
+        //! \brief Allocates a block from the large block heap.
+        //! \param[in] size The required size in bytes.
+        //! \return The block or nullptr if out of memory.
+        tlsf_block* allocate_large(int64 size);
+        //! \brief Frees a block of the large block heap and merges it with its free neighbours.
+        //! \param[in] block The block to free.
+        void free_large(tlsf_block* block);
+
+        //! \brief Requests a new region from the system and adds its memory to the large block heap.
+        //! \param[in] size The size of the block required from the new region.
+        //! \return True on success, else false.
+        bool add_region(int64 size);
+        //! \brief Gives a region back to the system.
+        //! \param[in] r The region to release. Its only block has to be free and removed from the free lists.
+        void remove_region(region* r);
+
+        //! \brief Inserts a free block into its free list.
+        //! \param[in] block The block to insert.
+        void insert_free_block(tlsf_block* block);
+        //! \brief Removes a free block from its free list.
+        //! \param[in] block The block to remove.
+        void remove_free_block(tlsf_block* block);
+        //! \brief Finds a free block of at least a given size in O(1).
+        //! \param[in] size The required size in bytes.
+        //! \return A fitting free block or nullptr if there is none.
+        tlsf_block* find_free_block(int64 size);
+
+        //! \brief Bitmap of non empty first level lists.
+        uint64 m_fl_bitmap;
+        //! \brief Bitmaps of non empty second level lists per first level.
+        uint32 m_sl_bitmap[fl_index_count];
+        //! \brief Heads of the free lists of the large block heap.
+        tlsf_block* m_free_lists[fl_index_count][sl_index_count];
+        //! \brief Heads of the lists of slabs with free blocks per size class.
+        slab* m_partial_slabs[size_class_count];
+        //! \brief Head of the list of regions.
+        region* m_regions;
+        //! \brief The minimum size of a region.
+        int64 m_region_size;
+        //! \brief The current statistics, the free block statistics are calculated on demand.
+        pool_allocator_statistics m_statistics;
+    };
+} // namespace mango
+
+#endif // MANGO_POOL_ALLOCATOR_HPP
@@ -154,7 +154,7 @@ void debug_drawer::add(const vec3& point0, const vec3& point1)
     m_vertices.push_back(m_color.as_vec3());
 }
 
-void debug_drawer::update_buffer()
+void debug_drawer::update_buffer(graphics_device_context_handle& device_context)
 {
     PROFILE_ZONE;
     auto& graphics_device = m_shared_context->get_graphics_device();
@@ -171,11 +171,7 @@ void debug_drawer::update_buffer()
         check_creation(m_vertex_buffer.get(), "debug draw vertex buffer");
     }
 
-    auto device_context = graphics_device->create_graphics_device_context();
-    device_context->begin();
     device_context->set_buffer_data(m_vertex_buffer, 0, static_cast<int32>(m_vertices.size()) * sizeof(vec3), m_vertices.data());
-    device_context->end();
-    device_context->submit();
     m_vertex_count = static_cast<int32>(m_vertices.size()) / 2;
 }
 
@@ -34,7 +34,9 @@ namespace mango
         void add(const vec3& point0, const vec3& point1);
 
         //! \brief Updates the internal \a gfx_buffer with the current list of points and colors.
-        void update_buffer();
+        //! \details The upload is recorded in the given context, so no additional context is created each frame.
+        //! \param[in] device_context The \a graphics_device_context to record the upload in.
+        void update_buffer(graphics_device_context_handle& device_context);
 
         //! \brief Draws the lines.
         void execute(graphics_device_context_handle& device_context);
@@ -0,0 +1,290 @@
+//! \file      light_clusters.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <cmath>
+#include <mango/assert.hpp>
+#include <mango/profile.hpp>
+#include <rendering/light_clusters.hpp>
+
+using namespace mango;
+
+const int32 light_clusters::grid_x;
+const int32 light_clusters::grid_y;
+const int32 light_clusters::grid_z;
+const int32 light_clusters::cluster_count;
+
+//! \brief Calculates the tile of a normalized device coordinate.
+//! \param[in] ndc The normalized device coordinate.
+//! \param[in] tiles The number of tiles.
+//! \return The tile, clamped to the grid.
+static int32 ndc_tile(float ndc, int32 tiles)
+{
+    int32 tile = static_cast<int32>(std::floor((ndc * 0.5f + 0.5f) * static_cast<float>(tiles)));
+    return std::min(std::max(tile, 0), tiles - 1);
+}
+
+light_clusters::light_clusters()
+    : m_device(nullptr)
+    , m_bounds_projection(mat4::Zero())
+    , m_bounds_near(0.0f)
+    , m_bounds_far(0.0f)
+    , m_z_scale(0.0f)
+    , m_z_bias(0.0f)
+    , m_light_capacity(0)
+    , m_light_index_capacity(0)
+{
+    clear();
+}
+
+light_clusters::~light_clusters() {}
+
+void light_clusters::create(const graphics_device_handle& device)
+{
+    m_device               = &device;
+    m_light_capacity       = 0;
+    m_light_index_capacity = 0;
+    m_light_buffer         = nullptr;
+    m_cluster_buffer       = nullptr;
+    m_light_index_buffer   = nullptr;
+    clear();
+}
+
+void light_clusters::clear()
+{
+    m_lights.clear();
+    m_light_indices.clear();
+    m_assignments.clear();
+    m_clusters.assign(cluster_count, light_cluster{ 0, 0 });
+}
+
+void light_clusters::add(const point_light& light, const vec3& position)
+{
+    const vec3& color = light.color.as_vec3();
+
+    punctual_light_data data;
+    data.position_range       = vec4(position.x(), position.y(), position.z(), light.range);
+    data.color_intensity      = vec4(color.x(), color.y(), color.z(), light.intensity / (4.0f * static_cast<float>(PI)));
+    data.direction_spot_scale = vec4(0.0f, -1.0f, 0.0f, 0.0f);
+    data.spot_offset          = vec4(1.0f, 0.0f, 0.0f, 0.0f);
+    m_lights.push_back(data);
+}
+
+void light_clusters::add(const spot_light& light, const vec3& position, const vec3& direction)
+{
+    const vec3& color = light.color.as_vec3();
+    float cos_outer   = std::cos(light.outer_cone_angle);
+    float cos_inner   = std::cos(std::min(light.inner_cone_angle, light.outer_cone_angle));
+    float scale       = 1.0f / std::max(cos_inner - cos_outer, 1e-4f);
+    vec3 dir          = direction.squaredNorm() > 0.0f ? direction.normalized() : vec3(0.0f, -1.0f, 0.0f);
+
+    // the intensity is independent of the cone angle, so changing the cone does not change the brightness.
+    punctual_light_data data;
+    data.position_range       = vec4(position.x(), position.y(), position.z(), light.range);
+    data.color_intensity      = vec4(color.x(), color.y(), color.z(), light.intensity / static_cast<float>(PI));
+    data.direction_spot_scale = vec4(dir.x(), dir.y(), dir.z(), scale);
+    data.spot_offset          = vec4(-cos_outer * scale, 0.0f, 0.0f, 0.0f);
+    m_lights.push_back(data);
+}
+
+void light_clusters::build(const mat4& view, const mat4& projection, float z_near, float z_far)
+{
+    PROFILE_ZONE;
+    z_near = std::max(z_near, 1e-4f);
+    z_far  = std::max(z_far, z_near * 1.001f);
+
+    if (projection != m_bounds_projection || z_near != m_bounds_near || z_far != m_bounds_far)
+        update_cluster_bounds(projection, z_near, z_far);
+
+    float log_ratio = std::log(z_far / z_near);
+    m_z_scale       = static_cast<float>(grid_z) / log_ratio;
+    m_z_bias        = -static_cast<float>(grid_z) * std::log(z_near) / log_ratio;
+
+    for (light_cluster& c : m_clusters)
+    {
+        c.offset = 0;
+        c.count  = 0;
+    }
+    m_assignments.clear();
+
+    for (uint32 i = 0; i < static_cast<uint32>(m_lights.size()); ++i)
+    {
+        const vec4& position_range = m_lights[i].position_range;
+        float radius               = position_range.w();
+        vec3 center                = (view * vec4(position_range.x(), position_range.y(), position_range.z(), 1.0f)).head<3>();
+        float min_depth            = -center.z() - radius;
+        float max_depth            = -center.z() + radius;
+        if (radius <= 0.0f || max_depth < z_near || min_depth > z_far)
+            continue;
+
+        int32 z_begin = depth_slice(std::max(min_depth, z_near));
+        int32 z_end   = depth_slice(std::min(max_depth, z_far));
+
+        // lights reaching behind the near plane can not be projected and cover all tiles.
+        int32 x_begin = 0;
+        int32 x_end   = grid_x - 1;
+        int32 y_begin = 0;
+        int32 y_end   = grid_y - 1;
+        if (min_depth > z_near)
+        {
+            vec2 ndc_min = vec2(1e30f, 1e30f);
+            vec2 ndc_max = vec2(-1e30f, -1e30f);
+            for (int32 c = 0; c < 8; ++c)
+            {
+                vec3 corner = center + vec3((c & 1) ? radius : -radius, (c & 2) ? radius : -radius, (c & 4) ? radius : -radius);
+                vec4 clip   = projection * vec4(corner.x(), corner.y(), corner.z(), 1.0f);
+                vec2 ndc    = clip.head<2>() / clip.w();
+                ndc_min     = ndc_min.cwiseMin(ndc);
+                ndc_max     = ndc_max.cwiseMax(ndc);
+            }
+            if (ndc_max.x() < -1.0f || ndc_min.x() > 1.0f || ndc_max.y() < -1.0f || ndc_min.y() > 1.0f)
+                continue;
+            x_begin = ndc_tile(ndc_min.x(), grid_x);
+            x_end   = ndc_tile(ndc_max.x(), grid_x);
+            y_begin = ndc_tile(ndc_min.y(), grid_y);
+            y_end   = ndc_tile(ndc_max.y(), grid_y);
+        }
+
+        float radius_squared = radius * radius;
+        for (int32 z = z_begin; z <= z_end; ++z)
+        {
+            for (int32 y = y_begin; y <= y_end; ++y)
+            {
+                for (int32 x = x_begin; x <= x_end; ++x)
+                {
+                    int32 index                  = cluster_index(x, y, z);
+                    const cluster_bounds& bounds = m_cluster_bounds[index];
+                    vec3 closest                 = center.cwiseMax(bounds.min).cwiseMin(bounds.max);
+                    if ((closest - center).squaredNorm() > radius_squared)
+                        continue;
+
+                    m_assignments.push_back({ static_cast<uint32>(index), i });
+                    m_clusters[index].count++;
+                }
+            }
+        }
+    }
+
+    // counting sort of the assignments by cluster, lights in a cluster stay in the order they were added.
+    uint32 offset = 0;
+    for (light_cluster& c : m_clusters)
+    {
+        c.offset = offset;
+        offset += c.count;
+        c.count = 0;
+    }
+    m_light_indices.resize(offset);
+    for (const auto& a : m_assignments)
+    {
+        light_cluster& c                    = m_clusters[a.first];
+        m_light_indices[c.offset + c.count] = a.second;
+        c.count++;
+    }
+}
+
+bool light_clusters::upload(const graphics_device_context_handle& device_context)
+{
+    PROFILE_ZONE;
+    MANGO_ASSERT(m_device, "Light clusters are not created!");
+
+    int32 light_count = static_cast<int32>(m_lights.size());
+    int32 index_count = static_cast<int32>(m_light_indices.size());
+
+    // the buffers always exist, so they can be bound even without any lights.
+    buffer_create_info buffer_info;
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_dynamic_storage;
+    buffer_info.buffer_target = gfx_buffer_target::buffer_target_shader_storage;
+    if (!m_light_buffer || light_count > m_light_capacity)
+    {
+        m_light_capacity = std::max(std::max(light_count, 1), m_light_capacity * 2);
+        buffer_info.size = static_cast<int64>(m_light_capacity) * sizeof(punctual_light_data);
+        m_light_buffer   = (*m_device)->create_buffer(buffer_info);
+        if (!check_creation(m_light_buffer.get(), "punctual light buffer"))
+            return false;
+    }
+    if (!m_cluster_buffer)
+    {
+        buffer_info.size = static_cast<int64>(cluster_count) * sizeof(light_cluster);
+        m_cluster_buffer = (*m_device)->create_buffer(buffer_info);
+        if (!check_creation(m_cluster_buffer.get(), "light cluster buffer"))
+            return false;
+    }
+    if (!m_light_index_buffer || index_count > m_light_index_capacity)
+    {
+        m_light_index_capacity = std::max(std::max(index_count, 1), m_light_index_capacity * 2);
+        buffer_info.size       = static_cast<int64>(m_light_index_capacity) * sizeof(uint32);
+        m_light_index_buffer   = (*m_device)->create_buffer(buffer_info);
+        if (!check_creation(m_light_index_buffer.get(), "light index buffer"))
+            return false;
+    }
+
+    if (light_count > 0)
+        device_context->set_buffer_data(m_light_buffer, 0, light_count * static_cast<int32>(sizeof(punctual_light_data)), m_lights.data());
+    device_context->set_buffer_data(m_cluster_buffer, 0, cluster_count * static_cast<int32>(sizeof(light_cluster)), m_clusters.data());
+    if (index_count > 0)
+        device_context->set_buffer_data(m_light_index_buffer, 0, index_count * static_cast<int32>(sizeof(uint32)), m_light_indices.data());
+
+    return true;
+}
+
+void light_clusters::update_cluster_bounds(const mat4& projection, float z_near, float z_far)
+{
+    PROFILE_ZONE;
+    m_bounds_projection = projection;
+    m_bounds_near       = z_near;
+    m_bounds_far        = z_far;
+    m_cluster_bounds.resize(cluster_count);
+
+    mat4 inverse_projection = projection.inverse();
+    auto unproject          = [&inverse_projection](float x, float y, float z) {
+        vec4 p = inverse_projection * vec4(x, y, z, 1.0f);
+        return vec3(p.head<3>() / p.w());
+    };
+
+    for (int32 y = 0; y < grid_y; ++y)
+    {
+        for (int32 x = 0; x < grid_x; ++x)
+        {
+            // the rays through the corners of the tile, from the near to the far plane.
+            vec3 ray_start[4];
+            vec3 ray_end[4];
+            for (int32 c = 0; c < 4; ++c)
+            {
+                float ndc_x  = -1.0f + 2.0f * static_cast<float>(x + (c & 1)) / static_cast<float>(grid_x);
+                float ndc_y  = -1.0f + 2.0f * static_cast<float>(y + ((c >> 1) & 1)) / static_cast<float>(grid_y);
+                ray_start[c] = unproject(ndc_x, ndc_y, -1.0f);
+                ray_end[c]   = unproject(ndc_x, ndc_y, 1.0f);
+            }
+
+            for (int32 z = 0; z < grid_z; ++z)
+            {
+                float slice_near = z_near * std::pow(z_far / z_near, static_cast<float>(z) / static_cast<float>(grid_z));
+                float slice_far  = z_near * std::pow(z_far / z_near, static_cast<float>(z + 1) / static_cast<float>(grid_z));
+
+                cluster_bounds& bounds = m_cluster_bounds[cluster_index(x, y, z)];
+                bounds.min             = make_vec3(1e30f);
+                bounds.max             = make_vec3(-1e30f);
+                for (int32 c = 0; c < 4; ++c)
+                {
+                    vec3 direction = ray_end[c] - ray_start[c];
+                    for (float depth : { slice_near, slice_far })
+                    {
+                        float t    = (-depth - ray_start[c].z()) / direction.z();
+                        vec3 point = ray_start[c] + t * direction;
+                        bounds.min = bounds.min.cwiseMin(point);
+                        bounds.max = bounds.max.cwiseMax(point);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int32 light_clusters::depth_slice(float depth) const
+{
+    int32 slice = static_cast<int32>(std::floor(std::log(depth) * m_z_scale + m_z_bias));
+    return std::min(std::max(slice, 0), grid_z - 1);
+}
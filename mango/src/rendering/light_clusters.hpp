@@ -0,0 +1,222 @@
+//! \file      light_clusters.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_LIGHT_CLUSTERS_HPP
+#define MANGO_LIGHT_CLUSTERS_HPP
+
+#include <graphics/graphics_device.hpp>
+#include <graphics/graphics_device_context.hpp>
+#include <graphics/graphics_resources.hpp>
+#include <mango/scene_structures.hpp>
+#include <util/helpers.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief The gpu data of a point or spot light.
+    //! \details Mirrors the std430 structure punctual_light_data in light.glsl.
+    //! Point lights have a spot scale of 0.0 and a spot offset of 1.0, so they are not attenuated by the cone.
+    struct punctual_light_data
+    {
+        //! \brief World space position xyz, range w.
+        vec4 position_range;
+        //! \brief Color rgb, luminous intensity in candela w.
+        vec4 color_intensity;
+        //! \brief Normalized world space direction the light points in xyz, cone attenuation scale w.
+        vec4 direction_spot_scale;
+        //! \brief Cone attenuation offset x, yzw unused.
+        vec4 spot_offset;
+    };
+
+    //! \brief The lights of one cluster in the light index list.
+    //! \details Mirrors an uvec2 in the std430 light cluster buffer in light.glsl.
+    struct light_cluster
+    {
+        //! \brief The index of the first light index of the cluster.
+        uint32 offset;
+        //! \brief The number of lights influencing the cluster.
+        uint32 count;
+    };
+
+    //! \brief Assigns point and spot lights to the clusters of a view space froxel grid.
+    //! \details The view frustum is split into tiles in screen space and into exponentially distributed slices in depth.
+    //! Each light is only tested against the clusters inside its projected bounds, the results are stored as one list of light indices with an offset and a count per cluster.
+    //! Shaders find the cluster of a fragment from its screen position and view depth and only evaluate the lights in it,
+    //! so the lighting cost depends on the number of lights close to the fragment and not on the total number of lights.
+    class light_clusters
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(light_clusters)
+      public:
+        //! \brief The number of clusters in x direction.
+        static const int32 grid_x = 16;
+        //! \brief The number of clusters in y direction.
+        static const int32 grid_y = 9;
+        //! \brief The number of depth slices.
+        static const int32 grid_z = 24;
+        //! \brief The total number of clusters.
+        static const int32 cluster_count = grid_x * grid_y * grid_z;
+
+        light_clusters();
+        ~light_clusters();
+
+        //! \brief Creates the \a light_clusters.
+        //! \param[in] device The \a graphics_device to create the buffers with.
+        void create(const graphics_device_handle& device);
+
+        //! \brief Removes all lights and empties all clusters.
+        void clear();
+
+        //! \brief Adds a \a point_light.
+        //! \param[in] light The \a point_light to add.
+        //! \param[in] position The world space position of the light.
+        void add(const point_light& light, const vec3& position);
+
+        //! \brief Adds a \a spot_light.
+        //! \param[in] light The \a spot_light to add.
+        //! \param[in] position The world space position of the light.
+        //! \param[in] direction The world space direction the light points in.
+        void add(const spot_light& light, const vec3& position, const vec3& direction);
+
+        //! \brief Assigns the lights added since the last \a clear() to the clusters.
+        //! \param[in] view The view matrix of the camera.
+        //! \param[in] projection The projection matrix of the camera.
+        //! \param[in] z_near The distance to the near plane of the camera.
+        //! \param[in] z_far The distance to the far plane of the camera.
+        void build(const mat4& view, const mat4& projection, float z_near, float z_far);
+
+        //! \brief Uploads the lights, the clusters and the light indices.
+        //! \details The buffers grow, if they are too small.
+        //! \param[in] device_context The recording \a graphics_device_context to use.
+        //! \return True on success, else false.
+        bool upload(const graphics_device_context_handle& device_context);
+
+        //! \brief Retrieves the index of a cluster.
+        //! \param[in] x The tile in x direction.
+        //! \param[in] y The tile in y direction.
+        //! \param[in] z The depth slice.
+        //! \return The index of the cluster in the cluster list.
+        static inline int32 cluster_index(int32 x, int32 y, int32 z)
+        {
+            return (z * grid_y + y) * grid_x + x;
+        }
+
+        //! \brief Retrieves the scale to calculate the depth slice from the logarithm of the view space depth.
+        //! \return The depth slice scale.
+        inline float get_z_scale() const
+        {
+            return m_z_scale;
+        }
+
+        //! \brief Retrieves the bias to calculate the depth slice from the logarithm of the view space depth.
+        //! \return The depth slice bias.
+        inline float get_z_bias() const
+        {
+            return m_z_bias;
+        }
+
+        //! \brief Retrieves the lights added since the last \a clear().
+        //! \return The list of \a punctual_light_data.
+        inline const std::vector<punctual_light_data>& get_lights() const
+        {
+            return m_lights;
+        }
+
+        //! \brief Retrieves the clusters created by \a build().
+        //! \return The list of \a light_clusters, indexed with \a cluster_index().
+        inline const std::vector<light_cluster>& get_clusters() const
+        {
+            return m_clusters;
+        }
+
+        //! \brief Retrieves the light indices created by \a build().
+        //! \return The list of light indices referenced by the clusters.
+        inline const std::vector<uint32>& get_light_indices() const
+        {
+            return m_light_indices;
+        }
+
+        //! \brief Retrieves the shader storage \a gfx_buffer with the \a punctual_light_data.
+        //! \return The \a gfx_buffer to bind as punctual light buffer.
+        inline const gfx_handle<const gfx_buffer>& get_light_buffer() const
+        {
+            return m_light_buffer;
+        }
+
+        //! \brief Retrieves the shader storage \a gfx_buffer with the \a light_clusters.
+        //! \return The \a gfx_buffer to bind as light cluster buffer.
+        inline const gfx_handle<const gfx_buffer>& get_cluster_buffer() const
+        {
+            return m_cluster_buffer;
+        }
+
+        //! \brief Retrieves the shader storage \a gfx_buffer with the light indices.
+        //! \return The \a gfx_buffer to bind as light index buffer.
+        inline const gfx_handle<const gfx_buffer>& get_light_index_buffer() const
+        {
+            return m_light_index_buffer;
+        }
+
+      private:
+        //! \brief View space bounds of a cluster.
+        struct cluster_bounds
+        {
+            //! \brief The minimum corner.
+            vec3 min;
+            //! \brief The maximum corner.
+            vec3 max;
+        };
+
+        //! \brief Calculates the view space bounds of all clusters.
+        //! \param[in] projection The projection matrix of the camera.
+        //! \param[in] z_near The distance to the near plane of the camera.
+        //! \param[in] z_far The distance to the far plane of the camera.
+        void update_cluster_bounds(const mat4& projection, float z_near, float z_far);
+
+        //! \brief Calculates the depth slice of a view space depth.
+        //! \param[in] depth The positive view space depth.
+        //! \return The depth slice, clamped to the grid.
+        int32 depth_slice(float depth) const;
+
+        //! \brief The \a graphics_device used for creation.
+        const graphics_device_handle* m_device;
+
+        //! \brief The lights added since the last \a clear().
+        std::vector<punctual_light_data> m_lights;
+        //! \brief The clusters, each referencing a range in the light indices.
+        std::vector<light_cluster> m_clusters;
+        //! \brief The light indices of all clusters.
+        std::vector<uint32> m_light_indices;
+        //! \brief The cluster and light index pairs found while building.
+        std::vector<std::pair<uint32, uint32>> m_assignments;
+
+        //! \brief The view space bounds of each cluster.
+        std::vector<cluster_bounds> m_cluster_bounds;
+        //! \brief The projection the cluster bounds were calculated with.
+        mat4 m_bounds_projection;
+        //! \brief The near plane distance the cluster bounds were calculated with.
+        float m_bounds_near;
+        //! \brief The far plane distance the cluster bounds were calculated with.
+        float m_bounds_far;
+
+        //! \brief The scale to calculate the depth slice from the logarithm of the view space depth.
+        float m_z_scale;
+        //! \brief The bias to calculate the depth slice from the logarithm of the view space depth.
+        float m_z_bias;
+
+        //! \brief The shader storage \a gfx_buffer holding the lights.
+        gfx_handle<const gfx_buffer> m_light_buffer;
+        //! \brief The number of lights fitting into the light buffer.
+        int32 m_light_capacity;
+        //! \brief The shader storage \a gfx_buffer holding the clusters.
+        gfx_handle<const gfx_buffer> m_cluster_buffer;
+        //! \brief The shader storage \a gfx_buffer holding the light indices.
+        gfx_handle<const gfx_buffer> m_light_index_buffer;
+        //! \brief The number of indices fitting into the light index buffer.
+        int32 m_light_index_capacity;
+    };
+} // namespace mango
+
+#endif // MANGO_LIGHT_CLUSTERS_HPP
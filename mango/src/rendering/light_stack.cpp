@@ -7,12 +7,13 @@
 #include <mango/profile.hpp>
 #include <rendering/light_stack.hpp>
 #include <resources/resources_impl.hpp>
+#include <scene/scene_impl.hpp>
 #include <util/helpers.hpp>
 
 using namespace mango;
 
 light_stack::light_stack()
-    : m_allocator(524288) // 0.5 MiB
+    : m_allocator(262144) // 256 KiB regions
 {
     m_current_light_data.directional_light_direction    = vec3(0.5f, 0.5f, 0.5f);
     m_current_light_data.directional_light_color        = make_vec3(1.0f);
@@ -22,6 +23,10 @@ light_stack::light_stack()
 
     m_current_light_data.skylight_intensity = default_skylight_intensity;
     m_current_light_data.skylight_valid     = false;
+
+    m_current_light_data.light_cluster_grid    = ivec3(light_clusters::grid_x, light_clusters::grid_y, light_clusters::grid_z);
+    m_current_light_data.light_cluster_z_scale = 0.0f;
+    m_current_light_data.light_cluster_z_bias  = 0.0f;
 }
 
 light_stack::~light_stack() {}
@@ -31,6 +36,8 @@ bool light_stack::init(const shared_ptr<context_impl>& context)
     m_allocator.init();
     m_shared_context = context;
 
+    m_light_clusters.create(m_shared_context->get_graphics_device());
+
     if (!m_skylight_builder.init(m_shared_context))
         return false;
 
@@ -54,6 +61,16 @@ void light_stack::push(const atmospheric_light& light)
     m_atmosphere_stack.emplace_back(light);
 }
 
+void light_stack::push(const point_light& light, const vec3& position)
+{
+    m_point_stack.push_back({ light, position });
+}
+
+void light_stack::push(const spot_light& light, const vec3& position, const vec3& direction)
+{
+    m_spot_stack.push_back({ light, position, direction });
+}
+
 void light_stack::update(scene_impl* scene)
 {
     PROFILE_ZONE;
@@ -69,6 +86,7 @@ void light_stack::update(scene_impl* scene)
     update_directional_lights();
     // update_atmosphere_lights();
     update_skylights(scene);
+    update_punctual_lights(scene);
 
     for (auto it = m_light_cache.begin(); it != m_light_cache.end();)
     {
@@ -87,6 +105,13 @@ void light_stack::update(scene_impl* scene)
     m_directional_stack.clear();
     m_atmosphere_stack.clear();
     m_skylight_stack.clear();
+    m_point_stack.clear();
+    m_spot_stack.clear();
+}
+
+bool light_stack::upload(const graphics_device_context_handle& device_context)
+{
+    return m_light_clusters.upload(device_context);
 }
 
 void light_stack::update_directional_lights()
@@ -252,6 +277,28 @@ void light_stack::update_skylights(scene_impl* scene)
     }
 }
 
+void light_stack::update_punctual_lights(scene_impl* scene)
+{
+    PROFILE_ZONE;
+    m_light_clusters.clear();
+
+    // the clusters are built in the view space of the active camera, without one there is nothing to light.
+    auto camera = scene->get_active_camera_gpu_data();
+    if (!camera)
+        return;
+
+    for (const auto& p : m_point_stack)
+        m_light_clusters.add(p.light, p.position);
+    for (const auto& s : m_spot_stack)
+        m_light_clusters.add(s.light, s.position, s.direction);
+
+    const camera_data& cam = camera->per_camera_data;
+    m_light_clusters.build(cam.view_matrix, cam.projection_matrix, cam.camera_near, cam.camera_far);
+
+    m_current_light_data.light_cluster_z_scale = m_light_clusters.get_z_scale();
+    m_current_light_data.light_cluster_z_bias  = m_light_clusters.get_z_bias();
+}
+
 int64 light_stack::calculate_checksum(uint8* bytes, int64 size)
 {
     int64 sum = 0;
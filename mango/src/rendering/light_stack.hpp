@@ -7,7 +7,8 @@
 #ifndef MANGO_LIGHT_STACK_HPP
 #define MANGO_LIGHT_STACK_HPP
 
-#include <memory/free_list_allocator.hpp>
+#include <memory/pool_allocator.hpp>
+#include <rendering/light_clusters.hpp>
 #include <rendering/render_data_builder.hpp>
 #include <rendering/renderer_impl.hpp>
 #include <scene/scene_structures_internal.hpp>
@@ -40,10 +41,33 @@ namespace mango
         //! \param[in] light A reference to the \a atmospheric_light to push.
         void push(const atmospheric_light& light);
 
+        //! \brief Pushes a \a point_light on the stack.
+        //! \param[in] light A reference to the \a point_light to push.
+        //! \param[in] position The world space position of the \a point_light.
+        void push(const point_light& light, const vec3& position);
+
+        //! \brief Pushes a \a spot_light on the stack.
+        //! \param[in] light A reference to the \a spot_light to push.
+        //! \param[in] position The world space position of the \a spot_light.
+        //! \param[in] direction The world space direction the \a spot_light points in.
+        void push(const spot_light& light, const vec3& position, const vec3& direction);
+
         //! \brief Updates the stack.
         //! \param[in] scene A pointer to the current scene.
         void update(scene_impl* scene);
 
+        //! \brief Uploads the point and spot lights and their assignment to the light clusters.
+        //! \param[in] device_context The recording \a graphics_device_context to use.
+        //! \return True on success, else false.
+        bool upload(const graphics_device_context_handle& device_context);
+
+        //! \brief Retrieves the \a light_clusters with the point and spot lights of the last update.
+        //! \return The \a light_clusters of the \a light_stack.
+        inline const light_clusters& get_light_clusters() const
+        {
+            return m_light_clusters;
+        }
+
         //! \brief Retrieves the current \a light_data of the \a light_stack.
         //! \return The current \a light_data of the \a light_stack.
         inline light_data& get_light_data()
@@ -53,7 +77,7 @@ namespace mango
 
         //! \brief Retrieves all lights casting shadows (atm only directional lights).
         //! \return A vector of lights that cast shadows.
-        inline std::vector<directional_light> get_shadow_casters() const
+        inline const std::vector<directional_light>& get_shadow_casters() const
         {
             return m_current_shadow_casters;
         }
@@ -107,6 +131,24 @@ namespace mango
         //! \brief Updates skylights.
         //! \param[in] scene A pointer to the current scene.
         void update_skylights(scene_impl* scene);
+        //! \brief Updates point and spot lights and assigns them to the light clusters of the active camera.
+        //! \param[in] scene A pointer to the current scene.
+        void update_punctual_lights(scene_impl* scene);
+
+        //! \brief A \a point_light pushed on the stack.
+        struct point_light_entry
+        {
+            point_light light; //!< The light.
+            vec3 position;     //!< The world space position.
+        };
+
+        //! \brief A \a spot_light pushed on the stack.
+        struct spot_light_entry
+        {
+            spot_light light; //!< The light.
+            vec3 position;    //!< The world space position.
+            vec3 direction;   //!< The world space direction.
+        };
 
         //! \brief Calculates the checksum of some bytes.
         //! \param[in] bytes Pointer to the bytes to calculate checksum for.
@@ -120,9 +162,16 @@ namespace mango
         std::vector<atmospheric_light> m_atmosphere_stack;
         //! \brief Skylight stack.
         std::vector<skylight> m_skylight_stack;
+        //! \brief Point light stack.
+        std::vector<point_light_entry> m_point_stack;
+        //! \brief Spot light stack.
+        std::vector<spot_light_entry> m_spot_stack;
+
+        //! \brief The clustered assignment of point and spot lights.
+        light_clusters m_light_clusters;
 
         //! \brief The allocator for render data.
-        free_list_allocator m_allocator;
+        pool_allocator m_allocator;
 
         //! \brief The light cache mapping checksum to render data.
         std::unordered_map<int64, cache_entry> m_light_cache;
@@ -0,0 +1,198 @@
+//! \file      multi_draw_batcher.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <mango/assert.hpp>
+#include <mango/profile.hpp>
+#include <rendering/multi_draw_batcher.hpp>
+
+using namespace mango;
+
+//! \brief Returns the size of one index in bytes.
+//! \param[in] index_type The \a gfx_format of the indices.
+//! \return The size of one index in bytes.
+static int32 index_size(gfx_format index_type)
+{
+    switch (index_type)
+    {
+    case gfx_format::t_unsigned_byte:
+        return 1;
+    case gfx_format::t_unsigned_short:
+        return 2;
+    case gfx_format::t_unsigned_int:
+        return 4;
+    default:
+        MANGO_ASSERT(false, "Invalid index type!");
+        return 1;
+    }
+}
+
+multi_draw_batcher::multi_draw_batcher()
+    : m_device(nullptr)
+    , m_model_data_capacity(0)
+    , m_command_capacity(0)
+{
+}
+
+multi_draw_batcher::~multi_draw_batcher() {}
+
+void multi_draw_batcher::create(const graphics_device_handle& device)
+{
+    m_device              = &device;
+    m_model_data_capacity = 0;
+    m_command_capacity    = 0;
+    m_model_data_buffer   = nullptr;
+    m_command_buffer      = nullptr;
+    clear();
+}
+
+void multi_draw_batcher::clear()
+{
+    m_draws.clear();
+    m_batches.clear();
+    m_entries.clear();
+    m_commands.clear();
+}
+
+void multi_draw_batcher::add(int32 group, const gfx_handle<const gfx_pipeline>& pipeline, const primitive_gpu_data& geometry, const model_data& model, const material& mat,
+                             const material_gpu_data& mat_gpu_data, bool material_dependent)
+{
+    draw d;
+    d.group        = group;
+    d.pipeline     = pipeline;
+    d.geometry     = &geometry;
+    d.model        = &model;
+    d.mat          = &mat;
+    d.mat_gpu_data = &mat_gpu_data;
+    d.material_key = material_dependent ? &mat : nullptr;
+    d.order        = static_cast<int32>(m_draws.size());
+    m_draws.push_back(d);
+}
+
+void multi_draw_batcher::build()
+{
+    PROFILE_ZONE;
+    m_batches.clear();
+    m_entries.clear();
+    m_commands.clear();
+
+    // the order is unique, so sorting is deterministic and keeps the order of draws within a batch.
+    std::sort(m_draws.begin(), m_draws.end(), [](const draw& a, const draw& b) {
+        if (a.group != b.group)
+            return a.group < b.group;
+        if (a.pipeline.get() != b.pipeline.get())
+            return a.pipeline.get() < b.pipeline.get();
+        const gfx_buffer* a_indices = a.geometry->index_buffer_view.graphics_buffer.get();
+        const gfx_buffer* b_indices = b.geometry->index_buffer_view.graphics_buffer.get();
+        if (a_indices != b_indices)
+            return a_indices < b_indices;
+        const gfx_buffer* a_vertices = a.geometry->vertex_buffer_views.empty() ? nullptr : a.geometry->vertex_buffer_views[0].graphics_buffer.get();
+        const gfx_buffer* b_vertices = b.geometry->vertex_buffer_views.empty() ? nullptr : b.geometry->vertex_buffer_views[0].graphics_buffer.get();
+        if (a_vertices != b_vertices)
+            return a_vertices < b_vertices;
+        if (a.material_key != b.material_key)
+            return a.material_key < b.material_key;
+        return a.order < b.order;
+    });
+
+    m_entries.reserve(m_draws.size());
+    for (int32 i = 0; i < static_cast<int32>(m_draws.size()); ++i)
+    {
+        const draw& d                    = m_draws[i];
+        const draw_call_description& dcd = d.geometry->draw_call_desc;
+        bool indexed                     = dcd.index_count > 0;
+        int32 entry                      = static_cast<int32>(m_entries.size());
+        m_entries.push_back(*d.model);
+
+        if (!indexed || m_batches.empty() || m_batches.back().first_command < 0 || !can_merge(m_draws[i - 1], d))
+        {
+            batch b;
+            b.group         = d.group;
+            b.pipeline      = d.pipeline;
+            b.geometry      = d.geometry;
+            b.mat           = d.mat;
+            b.mat_gpu_data  = d.mat_gpu_data;
+            b.first_command = indexed ? static_cast<int32>(m_commands.size()) : -1;
+            b.draw_count    = 0;
+            b.first_entry   = entry;
+            b.vertex_count  = 0;
+            m_batches.push_back(b);
+        }
+
+        batch& current = m_batches.back();
+        current.draw_count++;
+        current.vertex_count += std::max(dcd.vertex_count, dcd.index_count);
+
+        if (indexed)
+        {
+            draw_indexed_indirect_command command;
+            command.index_count    = static_cast<uint32>(dcd.index_count);
+            command.instance_count = static_cast<uint32>(std::max(dcd.instance_count, 1));
+            command.first_index    = static_cast<uint32>(dcd.index_offset / index_size(d.geometry->index_type));
+            command.base_vertex    = dcd.base_vertex;
+            command.base_instance  = static_cast<uint32>(entry);
+            m_commands.push_back(command);
+        }
+    }
+}
+
+bool multi_draw_batcher::upload(const graphics_device_context_handle& device_context)
+{
+    PROFILE_ZONE;
+    MANGO_ASSERT(m_device, "Multi draw batcher is not created!");
+    if (m_entries.empty())
+        return true;
+
+    int32 entry_count   = static_cast<int32>(m_entries.size());
+    int32 command_count = static_cast<int32>(m_commands.size());
+
+    buffer_create_info buffer_info;
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_dynamic_storage;
+    if (entry_count > m_model_data_capacity)
+    {
+        m_model_data_capacity     = std::max(entry_count, m_model_data_capacity * 2);
+        buffer_info.buffer_target = gfx_buffer_target::buffer_target_shader_storage;
+        buffer_info.size          = static_cast<int64>(m_model_data_capacity) * sizeof(model_data);
+        m_model_data_buffer       = (*m_device)->create_buffer(buffer_info);
+        if (!check_creation(m_model_data_buffer.get(), "multi draw model data buffer"))
+            return false;
+    }
+    if (command_count > m_command_capacity)
+    {
+        m_command_capacity        = std::max(command_count, m_command_capacity * 2);
+        buffer_info.buffer_target = gfx_buffer_target::buffer_target_indirect;
+        buffer_info.size          = static_cast<int64>(m_command_capacity) * sizeof(draw_indexed_indirect_command);
+        m_command_buffer          = (*m_device)->create_buffer(buffer_info);
+        if (!check_creation(m_command_buffer.get(), "multi draw command buffer"))
+            return false;
+    }
+
+    device_context->set_buffer_data(m_model_data_buffer, 0, entry_count * static_cast<int32>(sizeof(model_data)), m_entries.data());
+    if (command_count > 0)
+        device_context->set_buffer_data(m_command_buffer, 0, command_count * static_cast<int32>(sizeof(draw_indexed_indirect_command)), m_commands.data());
+
+    return true;
+}
+
+bool multi_draw_batcher::can_merge(const draw& a, const draw& b)
+{
+    if (a.group != b.group || a.pipeline.get() != b.pipeline.get() || a.material_key != b.material_key)
+        return false;
+
+    const primitive_gpu_data& ga = *a.geometry;
+    const primitive_gpu_data& gb = *b.geometry;
+    if (ga.index_type != gb.index_type || ga.index_buffer_view.graphics_buffer.get() != gb.index_buffer_view.graphics_buffer.get())
+        return false;
+    if (ga.vertex_buffer_views.size() != gb.vertex_buffer_views.size())
+        return false;
+    for (size_t i = 0; i < ga.vertex_buffer_views.size(); ++i)
+    {
+        if (ga.vertex_buffer_views[i].graphics_buffer.get() != gb.vertex_buffer_views[i].graphics_buffer.get() ||
+            ga.vertex_buffer_views[i].offset != gb.vertex_buffer_views[i].offset)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,164 @@
+//! \file      multi_draw_batcher.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_MULTI_DRAW_BATCHER_HPP
+#define MANGO_MULTI_DRAW_BATCHER_HPP
+
+#include <graphics/graphics_device.hpp>
+#include <graphics/graphics_device_context.hpp>
+#include <graphics/graphics_resources.hpp>
+#include <scene/scene_structures_internal.hpp>
+#include <util/helpers.hpp>
+#include <vector>
+
+namespace mango
+{
+    // The entries are uploaded as is, so the layout has to match the std430 stride of model_entry in model.glsl.
+    static_assert(sizeof(model_data) == 128, "model_data does not match the std430 stride of model_entry!");
+
+    //! \brief Merges draws into batches, each submitted with a single multi draw indirect call.
+    //! \details Indexed draws sharing the \a gfx_pipeline, the geometry buffers and the material end up in the same batch.
+    //! The \a model_data of every draw is copied into a shader storage buffer, the base instance of each draw is the index of its entry.
+    //! Draws without indices can not be merged and get a batch of their own, which is drawn with a plain draw call.
+    class multi_draw_batcher
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(multi_draw_batcher)
+      public:
+        //! \brief Draws recorded together with a single call.
+        struct batch
+        {
+            //! \brief The group of all draws in the batch.
+            int32 group;
+            //! \brief The \a gfx_pipeline to draw the batch with.
+            gfx_handle<const gfx_pipeline> pipeline;
+            //! \brief The \a primitive_gpu_data of the first draw, providing the buffers of all draws.
+            const primitive_gpu_data* geometry;
+            //! \brief The \a material of the first draw.
+            const material* mat;
+            //! \brief The \a material_gpu_data of the first draw.
+            const material_gpu_data* mat_gpu_data;
+            //! \brief The index of the first \a draw_indexed_indirect_command, -1 for a single draw without indices.
+            int32 first_command;
+            //! \brief The number of draws in the batch.
+            int32 draw_count;
+            //! \brief The index of the \a model_data entry of the first draw.
+            int32 first_entry;
+            //! \brief The number of vertices or indices drawn.
+            int32 vertex_count;
+        };
+
+        multi_draw_batcher();
+        ~multi_draw_batcher();
+
+        //! \brief Creates the \a multi_draw_batcher.
+        //! \param[in] device The \a graphics_device to create the buffers with.
+        void create(const graphics_device_handle& device);
+
+        //! \brief Removes all draws and batches.
+        void clear();
+
+        //! \brief Adds a draw.
+        //! \details The pointed to data has to stay valid until the batches are recorded.
+        //! \param[in] group The group of the draw. Batches never span multiple groups and are ordered by group first.
+        //! \param[in] pipeline The \a gfx_pipeline to draw with.
+        //! \param[in] geometry The \a primitive_gpu_data to draw.
+        //! \param[in] model The \a model_data of the draw.
+        //! \param[in] mat The \a material to draw with.
+        //! \param[in] mat_gpu_data The \a material_gpu_data of the material.
+        //! \param[in] material_dependent False if the draw looks the same with every material, so it can be merged with draws of other materials.
+        void add(int32 group, const gfx_handle<const gfx_pipeline>& pipeline, const primitive_gpu_data& geometry, const model_data& model, const material& mat,
+                 const material_gpu_data& mat_gpu_data, bool material_dependent);
+
+        //! \brief Sorts the draws added since the last \a clear() and builds the batches.
+        //! \details Draws of a batch keep the order they were added in.
+        void build();
+
+        //! \brief Uploads the \a model_data entries and the indirect commands of the batches.
+        //! \details The buffers grow, if they are too small.
+        //! \param[in] device_context The recording \a graphics_device_context to use.
+        //! \return True on success, else false.
+        bool upload(const graphics_device_context_handle& device_context);
+
+        //! \brief Retrieves the batches created by \a build().
+        //! \return The list of batches, ordered by group.
+        inline const std::vector<batch>& get_batches() const
+        {
+            return m_batches;
+        }
+
+        //! \brief Retrieves the indirect commands created by \a build().
+        //! \return The list of \a draw_indexed_indirect_commands.
+        inline const std::vector<draw_indexed_indirect_command>& get_commands() const
+        {
+            return m_commands;
+        }
+
+        //! \brief Retrieves the shader storage \a gfx_buffer with one \a model_data entry per draw.
+        //! \return The \a gfx_buffer to bind as model data.
+        inline const gfx_handle<const gfx_buffer>& get_model_data_buffer() const
+        {
+            return m_model_data_buffer;
+        }
+
+        //! \brief Retrieves the indirect \a gfx_buffer with the \a draw_indexed_indirect_commands.
+        //! \return The \a gfx_buffer to draw indirect from.
+        inline const gfx_handle<const gfx_buffer>& get_command_buffer() const
+        {
+            return m_command_buffer;
+        }
+
+      private:
+        //! \brief One draw added to the \a multi_draw_batcher.
+        struct draw
+        {
+            //! \brief The group of the draw.
+            int32 group;
+            //! \brief The \a gfx_pipeline to draw with.
+            gfx_handle<const gfx_pipeline> pipeline;
+            //! \brief The \a primitive_gpu_data to draw.
+            const primitive_gpu_data* geometry;
+            //! \brief The \a model_data of the draw.
+            const model_data* model;
+            //! \brief The \a material to draw with.
+            const material* mat;
+            //! \brief The \a material_gpu_data of the material.
+            const material_gpu_data* mat_gpu_data;
+            //! \brief The material compared for batching, nullptr if every material can be used.
+            const material* material_key;
+            //! \brief The order the draw was added in.
+            int32 order;
+        };
+
+        //! \brief Checks if two draws can be in the same batch.
+        //! \param[in] a The first draw.
+        //! \param[in] b The second draw.
+        //! \return True if both can be drawn with one multi draw indirect call, else false.
+        static bool can_merge(const draw& a, const draw& b);
+
+        //! \brief The \a graphics_device used for creation.
+        const graphics_device_handle* m_device;
+
+        //! \brief The draws added since the last \a clear().
+        std::vector<draw> m_draws;
+        //! \brief The batches built from the draws.
+        std::vector<batch> m_batches;
+        //! \brief The \a model_data entries of all draws, in the order of the batches.
+        std::vector<model_data> m_entries;
+        //! \brief The indirect commands of all indexed draws, in the order of the batches.
+        std::vector<draw_indexed_indirect_command> m_commands;
+
+        //! \brief The shader storage \a gfx_buffer holding the entries.
+        gfx_handle<const gfx_buffer> m_model_data_buffer;
+        //! \brief The number of entries fitting into the model data buffer.
+        int32 m_model_data_capacity;
+        //! \brief The indirect \a gfx_buffer holding the commands.
+        gfx_handle<const gfx_buffer> m_command_buffer;
+        //! \brief The number of commands fitting into the command buffer.
+        int32 m_command_capacity;
+    };
+} // namespace mango
+
+#endif // MANGO_MULTI_DRAW_BATCHER_HPP
@@ -0,0 +1,127 @@
+//! \file      occlusion_culler.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <cmath>
+#include <mango/assert.hpp>
+#include <mango/profile.hpp>
+#include <rendering/occlusion_culler.hpp>
+
+using namespace mango;
+
+occlusion_culler::occlusion_culler()
+    : m_texel_size(1)
+    , m_viewport_width(0)
+    , m_viewport_height(0)
+    , m_view_projection(mat4::Identity())
+{
+}
+
+occlusion_culler::~occlusion_culler() {}
+
+void occlusion_culler::set_depth(const hi_z_readback& readback)
+{
+    PROFILE_ZONE;
+    MANGO_ASSERT(readback.depth && readback.width > 0 && readback.height > 0, "Invalid hi-z readback!");
+    m_texel_size      = std::max(readback.texel_size, 1);
+    m_viewport_width  = readback.viewport_width;
+    m_viewport_height = readback.viewport_height;
+    m_view_projection = readback.view_projection;
+
+    // levels are reused between frames, so the memory does not need to be allocated again.
+    size_t level_count = 1;
+    for (int32 w = readback.width, h = readback.height; w > 1 || h > 1; w = std::max(w / 2, 1), h = std::max(h / 2, 1))
+        level_count++;
+    m_levels.resize(level_count);
+
+    level& first = m_levels[0];
+    first.width  = readback.width;
+    first.height = readback.height;
+    first.depth.assign(readback.depth, readback.depth + readback.width * readback.height);
+
+    // the same reduction as on the gpu: the last texel of an odd row or column also takes the remaining one.
+    for (size_t l = 1; l < level_count; ++l)
+    {
+        const level& previous = m_levels[l - 1];
+        level& current        = m_levels[l];
+        current.width         = std::max(previous.width / 2, 1);
+        current.height        = std::max(previous.height / 2, 1);
+        current.depth.resize(current.width * current.height);
+        for (int32 y = 0; y < current.height; ++y)
+        {
+            int32 y_end = (y == current.height - 1) ? previous.height - 1 : 2 * y + 1;
+            for (int32 x = 0; x < current.width; ++x)
+            {
+                int32 x_end     = (x == current.width - 1) ? previous.width - 1 : 2 * x + 1;
+                float max_depth = 0.0f;
+                for (int32 py = 2 * y; py <= y_end; ++py)
+                {
+                    for (int32 px = 2 * x; px <= x_end; ++px)
+                        max_depth = std::max(max_depth, previous.depth[py * previous.width + px]);
+                }
+                current.depth[y * current.width + x] = max_depth;
+            }
+        }
+    }
+}
+
+void occlusion_culler::reset()
+{
+    m_levels.clear();
+}
+
+bool occlusion_culler::is_occluded(const axis_aligned_bounding_box& box) const
+{
+    if (m_levels.empty())
+        return false;
+
+    vec2 ndc_min    = vec2(1e30f, 1e30f);
+    vec2 ndc_max    = vec2(-1e30f, -1e30f);
+    float min_depth = 1.0f;
+    for (int32 c = 0; c < 8; ++c)
+    {
+        vec3 corner = box.center + vec3((c & 1) ? box.extents.x() : -box.extents.x(), (c & 2) ? box.extents.y() : -box.extents.y(), (c & 4) ? box.extents.z() : -box.extents.z());
+        vec4 clip   = m_view_projection * vec4(corner.x(), corner.y(), corner.z(), 1.0f);
+        // corners behind the near plane can not be projected.
+        if (clip.w() < 1e-5f || clip.z() < -clip.w())
+            return false;
+
+        vec3 ndc  = clip.head<3>() / clip.w();
+        ndc_min   = ndc_min.cwiseMin(ndc.head<2>());
+        ndc_max   = ndc_max.cwiseMax(ndc.head<2>());
+        min_depth = std::min(min_depth, ndc.z() * 0.5f + 0.5f);
+    }
+
+    // nothing is known about areas outside of the old view.
+    if (ndc_min.x() < -1.0f || ndc_min.y() < -1.0f || ndc_max.x() > 1.0f || ndc_max.y() > 1.0f)
+        return false;
+
+    const level& first = m_levels[0];
+    auto to_texel      = [this](float ndc, int32 viewport_size, int32 texel_count) {
+        int32 pixel = static_cast<int32>(std::floor((ndc * 0.5f + 0.5f) * static_cast<float>(viewport_size)));
+        pixel       = std::min(std::max(pixel, 0), viewport_size - 1);
+        return std::min(pixel / m_texel_size, texel_count - 1);
+    };
+    int32 x_begin = to_texel(ndc_min.x(), m_viewport_width, first.width);
+    int32 x_end   = to_texel(ndc_max.x(), m_viewport_width, first.width);
+    int32 y_begin = to_texel(ndc_min.y(), m_viewport_height, first.height);
+    int32 y_end   = to_texel(ndc_max.y(), m_viewport_height, first.height);
+
+    // the finest level where the rectangle covers at most 2x2 texels.
+    size_t l = 0;
+    while (l + 1 < m_levels.size() && ((x_end >> l) - (x_begin >> l) > 1 || (y_end >> l) - (y_begin >> l) > 1))
+        ++l;
+
+    const level& test_level = m_levels[l];
+    float max_depth         = 0.0f;
+    for (int32 y = std::min(y_begin >> l, test_level.height - 1); y <= std::min(y_end >> l, test_level.height - 1); ++y)
+    {
+        for (int32 x = std::min(x_begin >> l, test_level.width - 1); x <= std::min(x_end >> l, test_level.width - 1); ++x)
+            max_depth = std::max(max_depth, test_level.depth[y * test_level.width + x]);
+    }
+
+    return min_depth > max_depth;
+}
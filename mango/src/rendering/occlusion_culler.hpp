@@ -0,0 +1,94 @@
+//! \file      occlusion_culler.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_OCCLUSION_CULLER_HPP
+#define MANGO_OCCLUSION_CULLER_HPP
+
+#include <mango/intersect.hpp>
+#include <mango/types.hpp>
+#include <util/helpers.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief One level of a hierarchical depth buffer read back from the gpu.
+    struct hi_z_readback
+    {
+        //! \brief The maximum depth of each texel, row by row starting at the bottom left.
+        const float* depth;
+        //! \brief The width of the level in texels.
+        int32 width;
+        //! \brief The height of the level in texels.
+        int32 height;
+        //! \brief The number of pixels in x and y direction reduced into one texel.
+        //! \details The last texel in a row or column also covers the remaining pixels.
+        int32 texel_size;
+        //! \brief The width of the depth buffer the level was reduced from.
+        int32 viewport_width;
+        //! \brief The height of the depth buffer the level was reduced from.
+        int32 viewport_height;
+        //! \brief The view projection matrix the depth buffer was rendered with.
+        mat4 view_projection;
+    };
+
+    //! \brief Tests bounding boxes against a hierarchical depth buffer of a previous frame.
+    //! \details The read back level is reduced further on the cpu until a single texel is left.
+    //! A box is projected with the view projection the depth was rendered with and tested against the level where its screen rectangle covers at most 2x2 texels.
+    //! It is occluded, if its nearest depth is behind the farthest depth stored in all of these texels.
+    //! Boxes crossing the near plane or reaching outside of the old view are never occluded.
+    class occlusion_culler
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(occlusion_culler)
+      public:
+        occlusion_culler();
+        ~occlusion_culler();
+
+        //! \brief Sets the depth to test against.
+        //! \details The depth is copied, so the readback memory can be reused afterwards.
+        //! \param[in] readback The \a hi_z_readback to test against.
+        void set_depth(const hi_z_readback& readback);
+
+        //! \brief Removes the depth, nothing is occluded afterwards.
+        void reset();
+
+        //! \brief Checks if there is any depth to test against.
+        //! \return True if a depth was set, else false.
+        inline bool has_depth() const
+        {
+            return !m_levels.empty();
+        }
+
+        //! \brief Tests an \a axis_aligned_bounding_box against the depth.
+        //! \param[in] box The world space \a axis_aligned_bounding_box to test.
+        //! \return True if the box is certainly hidden, else false.
+        bool is_occluded(const axis_aligned_bounding_box& box) const;
+
+      private:
+        //! \brief One level of the depth hierarchy.
+        struct level
+        {
+            //! \brief The width in texels.
+            int32 width;
+            //! \brief The height in texels.
+            int32 height;
+            //! \brief The maximum depth of each texel.
+            std::vector<float> depth;
+        };
+
+        //! \brief The depth hierarchy, starting with the read back level.
+        std::vector<level> m_levels;
+        //! \brief The number of pixels reduced into one texel of the first level.
+        int32 m_texel_size;
+        //! \brief The width of the depth buffer the first level was reduced from.
+        int32 m_viewport_width;
+        //! \brief The height of the depth buffer the first level was reduced from.
+        int32 m_viewport_height;
+        //! \brief The view projection matrix the depth buffer was rendered with.
+        mat4 m_view_projection;
+    };
+} // namespace mango
+
+#endif // MANGO_OCCLUSION_CULLER_HPP
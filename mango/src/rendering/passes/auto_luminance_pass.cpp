@@ -67,9 +67,6 @@ void auto_luminance_pass::execute(graphics_device_context_handle& device_context
     device_context->submit_pipeline_state_resources();
 
     device_context->dispatch(1, 1, 1);
-
-    bd.barrier_bit = gfx_barrier_bit::buffer_update_barrier_bit;
-    device_context->barrier(bd);
 }
 
 bool auto_luminance_pass::create_pass_resources()
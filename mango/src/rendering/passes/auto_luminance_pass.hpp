@@ -36,6 +36,14 @@ namespace mango
             return m_luminance_data_mapping->luminance;
         }
 
+        //! \brief Retrieves the buffer the luminance is calculated into.
+        //! \details The buffer is read on the cpu, so it needs a barrier after \a execute().
+        //! \return The mapped luminance data buffer.
+        inline const gfx_handle<const gfx_buffer>& get_luminance_data_buffer() const
+        {
+            return m_luminance_data_buffer;
+        }
+
         //! \brief Set input texture.
         //! \param[in] hdr_input The input texture.
         inline void set_hdr_input(const gfx_handle<const gfx_texture>& hdr_input)
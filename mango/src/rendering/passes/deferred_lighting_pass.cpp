@@ -31,37 +31,44 @@ void deferred_lighting_pass::execute(graphics_device_context_handle& device_cont
 
     device_context->set_render_targets(static_cast<int32>(m_render_targets.size()) - 1, m_render_targets.data(), m_render_targets.back());
 
+    auto mapping = m_lighting_pass_pipeline->get_resource_mapping();
     if (m_camera_data_buffer)
-        m_lighting_pass_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
+        mapping->set(m_slots.camera_data, m_camera_data_buffer);
     if (m_renderer_data_buffer)
-        m_lighting_pass_pipeline->get_resource_mapping()->set("renderer_data", m_renderer_data_buffer);
+        mapping->set(m_slots.renderer_data, m_renderer_data_buffer);
     if (m_light_data_buffer)
-        m_lighting_pass_pipeline->get_resource_mapping()->set("light_data", m_light_data_buffer);
+        mapping->set(m_slots.light_data, m_light_data_buffer);
     if (m_shadow_data_buffer)
-        m_lighting_pass_pipeline->get_resource_mapping()->set("shadow_data", m_shadow_data_buffer);
-
-    m_lighting_pass_pipeline->get_resource_mapping()->set("texture_gbuffer_c0", m_gbuffer[0]);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_gbuffer_c0", m_gbuffer_sampler);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("texture_gbuffer_c1", m_gbuffer[1]);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_gbuffer_c1", m_gbuffer_sampler);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("texture_gbuffer_c2", m_gbuffer[2]);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_gbuffer_c2", m_gbuffer_sampler);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("texture_gbuffer_c3", m_gbuffer[3]);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_gbuffer_c3", m_gbuffer_sampler);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("texture_gbuffer_depth", m_gbuffer[4]);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_gbuffer_depth", m_gbuffer_sampler);
-
-    m_lighting_pass_pipeline->get_resource_mapping()->set("texture_irradiance_map", m_irradiance_map);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_irradiance_map", m_irradiance_map_sampler);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("texture_radiance_map", m_radiance_map);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_radiance_map", m_radiance_map_sampler);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("texture_brdf_integration_lut", m_brdf_integration_lut);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_brdf_integration_lut", m_brdf_integration_lut_sampler);
-
-    m_lighting_pass_pipeline->get_resource_mapping()->set("texture_shadow_map_comp", m_shadow_map);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("texture_shadow_map", m_shadow_map);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_shadow_shadow_map", m_shadow_map_compare_sampler);
-    m_lighting_pass_pipeline->get_resource_mapping()->set("sampler_shadow_map", m_shadow_map_sampler);
+        mapping->set(m_slots.shadow_data, m_shadow_data_buffer);
+    if (m_punctual_light_buffer)
+        mapping->set(m_slots.punctual_light_buffer, m_punctual_light_buffer);
+    if (m_light_cluster_buffer)
+        mapping->set(m_slots.light_cluster_buffer, m_light_cluster_buffer);
+    if (m_light_index_buffer)
+        mapping->set(m_slots.light_index_buffer, m_light_index_buffer);
+
+    mapping->set(m_slots.texture_gbuffer_c0, m_gbuffer[0]);
+    mapping->set(m_slots.sampler_gbuffer_c0, m_gbuffer_sampler);
+    mapping->set(m_slots.texture_gbuffer_c1, m_gbuffer[1]);
+    mapping->set(m_slots.sampler_gbuffer_c1, m_gbuffer_sampler);
+    mapping->set(m_slots.texture_gbuffer_c2, m_gbuffer[2]);
+    mapping->set(m_slots.sampler_gbuffer_c2, m_gbuffer_sampler);
+    mapping->set(m_slots.texture_gbuffer_c3, m_gbuffer[3]);
+    mapping->set(m_slots.sampler_gbuffer_c3, m_gbuffer_sampler);
+    mapping->set(m_slots.texture_gbuffer_depth, m_gbuffer[4]);
+    mapping->set(m_slots.sampler_gbuffer_depth, m_gbuffer_sampler);
+
+    mapping->set(m_slots.texture_irradiance_map, m_irradiance_map);
+    mapping->set(m_slots.sampler_irradiance_map, m_irradiance_map_sampler);
+    mapping->set(m_slots.texture_radiance_map, m_radiance_map);
+    mapping->set(m_slots.sampler_radiance_map, m_radiance_map_sampler);
+    mapping->set(m_slots.texture_brdf_integration_lut, m_brdf_integration_lut);
+    mapping->set(m_slots.sampler_brdf_integration_lut, m_brdf_integration_lut_sampler);
+
+    mapping->set(m_slots.texture_shadow_map_comp, m_shadow_map);
+    mapping->set(m_slots.texture_shadow_map, m_shadow_map);
+    mapping->set(m_slots.sampler_shadow_shadow_map, m_shadow_map_compare_sampler);
+    mapping->set(m_slots.sampler_shadow_map, m_shadow_map_sampler);
 
     device_context->submit_pipeline_state_resources();
 
@@ -113,13 +120,16 @@ bool deferred_lighting_pass::create_pass_resources()
         shader_info.stage         = gfx_shader_stage_type::shader_stage_fragment;
         shader_info.shader_source = source_desc;
 
-        shader_info.resource_count = 24;
+        shader_info.resource_count = 27;
 
         shader_info.resources = { {
             { gfx_shader_stage_type::shader_stage_fragment, CAMERA_DATA_BUFFER_BINDING_POINT, "camera_data", gfx_shader_resource_type::shader_resource_constant_buffer, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, RENDERER_DATA_BUFFER_BINDING_POINT, "renderer_data", gfx_shader_resource_type::shader_resource_constant_buffer, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, LIGHT_DATA_BUFFER_BINDING_POINT, "light_data", gfx_shader_resource_type::shader_resource_constant_buffer, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, SHADOW_DATA_BUFFER_BINDING_POINT, "shadow_data", gfx_shader_resource_type::shader_resource_constant_buffer, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, "punctual_light_buffer", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, LIGHT_CLUSTER_BUFFER_BINDING_POINT, "light_cluster_buffer", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, LIGHT_INDEX_BUFFER_BINDING_POINT, "light_index_buffer", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
 
             { gfx_shader_stage_type::shader_stage_fragment, GBUFFER_TEXTURE_SAMPLER_TARGET0, "texture_gbuffer_c0", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, GBUFFER_TEXTURE_SAMPLER_TARGET0, "sampler_gbuffer_c0", gfx_shader_resource_type::shader_resource_sampler, 1 },
@@ -168,6 +178,12 @@ bool deferred_lighting_pass::create_pass_resources()
                       { gfx_shader_stage_type::shader_stage_fragment, LIGHT_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer, gfx_shader_resource_access::shader_access_dynamic },
                       { gfx_shader_stage_type::shader_stage_fragment, SHADOW_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer,
                         gfx_shader_resource_access::shader_access_dynamic },
+                      { gfx_shader_stage_type::shader_stage_fragment, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+                        gfx_shader_resource_access::shader_access_dynamic },
+                      { gfx_shader_stage_type::shader_stage_fragment, LIGHT_CLUSTER_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+                        gfx_shader_resource_access::shader_access_dynamic },
+                      { gfx_shader_stage_type::shader_stage_fragment, LIGHT_INDEX_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+                        gfx_shader_resource_access::shader_access_dynamic },
 
                       { gfx_shader_stage_type::shader_stage_fragment, GBUFFER_TEXTURE_SAMPLER_TARGET0, gfx_shader_resource_type::shader_resource_input_attachment,
                         gfx_shader_resource_access::shader_access_dynamic },
@@ -223,5 +239,35 @@ bool deferred_lighting_pass::create_pass_resources()
 
     m_lighting_pass_pipeline = graphics_device->create_graphics_pipeline(lighting_pass_info);
 
+    // Resolve the shader resource slots once, so no names have to be looked up when executing.
+    auto mapping = m_lighting_pass_pipeline->get_resource_mapping();
+    m_slots.camera_data                  = mapping->get_slot("camera_data");
+    m_slots.renderer_data                = mapping->get_slot("renderer_data");
+    m_slots.light_data                   = mapping->get_slot("light_data");
+    m_slots.shadow_data                  = mapping->get_slot("shadow_data");
+    m_slots.texture_gbuffer_c0           = mapping->get_slot("texture_gbuffer_c0");
+    m_slots.sampler_gbuffer_c0           = mapping->get_slot("sampler_gbuffer_c0");
+    m_slots.texture_gbuffer_c1           = mapping->get_slot("texture_gbuffer_c1");
+    m_slots.sampler_gbuffer_c1           = mapping->get_slot("sampler_gbuffer_c1");
+    m_slots.texture_gbuffer_c2           = mapping->get_slot("texture_gbuffer_c2");
+    m_slots.sampler_gbuffer_c2           = mapping->get_slot("sampler_gbuffer_c2");
+    m_slots.texture_gbuffer_c3           = mapping->get_slot("texture_gbuffer_c3");
+    m_slots.sampler_gbuffer_c3           = mapping->get_slot("sampler_gbuffer_c3");
+    m_slots.texture_gbuffer_depth        = mapping->get_slot("texture_gbuffer_depth");
+    m_slots.sampler_gbuffer_depth        = mapping->get_slot("sampler_gbuffer_depth");
+    m_slots.texture_irradiance_map       = mapping->get_slot("texture_irradiance_map");
+    m_slots.sampler_irradiance_map       = mapping->get_slot("sampler_irradiance_map");
+    m_slots.texture_radiance_map         = mapping->get_slot("texture_radiance_map");
+    m_slots.sampler_radiance_map         = mapping->get_slot("sampler_radiance_map");
+    m_slots.texture_brdf_integration_lut = mapping->get_slot("texture_brdf_integration_lut");
+    m_slots.sampler_brdf_integration_lut = mapping->get_slot("sampler_brdf_integration_lut");
+    m_slots.texture_shadow_map_comp      = mapping->get_slot("texture_shadow_map_comp");
+    m_slots.texture_shadow_map           = mapping->get_slot("texture_shadow_map");
+    m_slots.sampler_shadow_shadow_map    = mapping->get_slot("sampler_shadow_shadow_map");
+    m_slots.sampler_shadow_map           = mapping->get_slot("sampler_shadow_map");
+    m_slots.punctual_light_buffer        = mapping->get_slot("punctual_light_buffer");
+    m_slots.light_cluster_buffer         = mapping->get_slot("light_cluster_buffer");
+    m_slots.light_index_buffer           = mapping->get_slot("light_index_buffer");
+
     return true;
 }
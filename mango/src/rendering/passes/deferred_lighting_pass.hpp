@@ -57,6 +57,18 @@ namespace mango
             m_shadow_data_buffer = shadow_data_buffer;
         }
 
+        //! \brief Set the buffers of the clustered point and spot lights.
+        //! \param[in] punctual_light_buffer The punctual light buffer.
+        //! \param[in] light_cluster_buffer The light cluster buffer.
+        //! \param[in] light_index_buffer The light index buffer.
+        inline void set_light_cluster_buffers(const gfx_handle<const gfx_buffer>& punctual_light_buffer, const gfx_handle<const gfx_buffer>& light_cluster_buffer,
+                                              const gfx_handle<const gfx_buffer>& light_index_buffer)
+        {
+            m_punctual_light_buffer = punctual_light_buffer;
+            m_light_cluster_buffer  = light_cluster_buffer;
+            m_light_index_buffer    = light_index_buffer;
+        }
+
         //! \brief Set the viewport.
         //! \param[in] viewport The viewport to use.
         inline void set_viewport(const gfx_viewport& viewport)
@@ -155,6 +167,37 @@ namespace mango
         gfx_handle<const gfx_shader_stage> m_lighting_pass_fragment;
         //! \brief Graphics \a gfx_pipeline calculating deferred lighting.
         gfx_handle<const gfx_pipeline> m_lighting_pass_pipeline;
+        //! \brief The pre-resolved shader resource slots of the lighting \a gfx_pipeline.
+        struct
+        {
+            shader_resource_mapping::resource_slot camera_data;
+            shader_resource_mapping::resource_slot renderer_data;
+            shader_resource_mapping::resource_slot light_data;
+            shader_resource_mapping::resource_slot shadow_data;
+            shader_resource_mapping::resource_slot texture_gbuffer_c0;
+            shader_resource_mapping::resource_slot sampler_gbuffer_c0;
+            shader_resource_mapping::resource_slot texture_gbuffer_c1;
+            shader_resource_mapping::resource_slot sampler_gbuffer_c1;
+            shader_resource_mapping::resource_slot texture_gbuffer_c2;
+            shader_resource_mapping::resource_slot sampler_gbuffer_c2;
+            shader_resource_mapping::resource_slot texture_gbuffer_c3;
+            shader_resource_mapping::resource_slot sampler_gbuffer_c3;
+            shader_resource_mapping::resource_slot texture_gbuffer_depth;
+            shader_resource_mapping::resource_slot sampler_gbuffer_depth;
+            shader_resource_mapping::resource_slot texture_irradiance_map;
+            shader_resource_mapping::resource_slot sampler_irradiance_map;
+            shader_resource_mapping::resource_slot texture_radiance_map;
+            shader_resource_mapping::resource_slot sampler_radiance_map;
+            shader_resource_mapping::resource_slot texture_brdf_integration_lut;
+            shader_resource_mapping::resource_slot sampler_brdf_integration_lut;
+            shader_resource_mapping::resource_slot texture_shadow_map_comp;
+            shader_resource_mapping::resource_slot texture_shadow_map;
+            shader_resource_mapping::resource_slot sampler_shadow_shadow_map;
+            shader_resource_mapping::resource_slot sampler_shadow_map;
+            shader_resource_mapping::resource_slot punctual_light_buffer;
+            shader_resource_mapping::resource_slot light_cluster_buffer;
+            shader_resource_mapping::resource_slot light_index_buffer;
+        } m_slots;
 
         //! \brief The \a gfx_viewport to render to.
         gfx_viewport m_viewport;
@@ -175,6 +218,12 @@ namespace mango
         gfx_handle<const gfx_buffer> m_light_data_buffer;
         //! \brief The shadow data \a gfx_buffer.
         gfx_handle<const gfx_buffer> m_shadow_data_buffer;
+        //! \brief The punctual light \a gfx_buffer.
+        gfx_handle<const gfx_buffer> m_punctual_light_buffer;
+        //! \brief The light cluster \a gfx_buffer.
+        gfx_handle<const gfx_buffer> m_light_cluster_buffer;
+        //! \brief The light index \a gfx_buffer.
+        gfx_handle<const gfx_buffer> m_light_index_buffer;
 
         //! \brief The irradiance map \a gfx_texture.
         gfx_handle<const gfx_texture> m_irradiance_map;
@@ -5,6 +5,7 @@
 //! \copyright Apache License 2.0
 
 #include <mango/profile.hpp>
+#include <memory/frame_arena.hpp>
 #include <rendering/passes/geometry_pass.hpp>
 #include <rendering/renderer_bindings.hpp>
 #include <resources/resources_impl.hpp>
@@ -30,8 +31,6 @@ void geometry_pass::attach(const shared_ptr<context_impl>& context)
 
 void geometry_pass::execute(graphics_device_context_handle& device_context)
 {
-    auto warn_missing_draw = [](string what) { MANGO_LOG_WARN("{0} missing for draw. Skipping DrawCall!", what); };
-
     m_rpei.draw_calls = 0;
     m_rpei.vertices   = 0;
     // gbuffer pass
@@ -39,37 +38,22 @@ void geometry_pass::execute(graphics_device_context_handle& device_context)
     GL_NAMED_PROFILE_ZONE("GBuffer Pass");
     NAMED_PROFILE_ZONE("GBuffer Pass");
     device_context->set_render_targets(static_cast<int32>(m_render_targets.size()) - 1, m_render_targets.data(), m_render_targets.back());
+
+    if (m_multi_draw && m_multi_draw_supported)
+    {
+        execute_multi_draw(device_context);
+        return;
+    }
+
+    auto warn_missing_draw = [](string what) { MANGO_LOG_WARN("{0} missing for draw. Skipping DrawCall!", what); };
+
+    const uniform_ring_buffer& model_ring = m_scene->get_model_data_ring();
     for (int32 c = 0; c < m_opaque_count; ++c)
     {
-        auto& dc = m_draws->operator[](c);
+        const draw_key& dc = m_draws[c];
 
-        if (m_frustum_culling)
-        {
-            auto& bb = dc.bounding_box;
-            if (!m_camera_frustum.intersects(bb))
-                continue;
-        }
         if (m_debug_bounds)
-        {
-            auto& bb     = dc.bounding_box;
-            auto corners = bb.get_corners();
-            m_debug_drawer->set_color(color_rgb(1.0f, 0.0f, 0.0f));
-            m_debug_drawer->add(corners[0], corners[1]);
-            m_debug_drawer->add(corners[1], corners[3]);
-            m_debug_drawer->add(corners[3], corners[2]);
-            m_debug_drawer->add(corners[2], corners[6]);
-            m_debug_drawer->add(corners[6], corners[4]);
-            m_debug_drawer->add(corners[4], corners[0]);
-            m_debug_drawer->add(corners[0], corners[2]);
-
-            m_debug_drawer->add(corners[5], corners[4]);
-            m_debug_drawer->add(corners[4], corners[6]);
-            m_debug_drawer->add(corners[6], corners[7]);
-            m_debug_drawer->add(corners[7], corners[3]);
-            m_debug_drawer->add(corners[3], corners[1]);
-            m_debug_drawer->add(corners[1], corners[5]);
-            m_debug_drawer->add(corners[5], corners[7]);
-        }
+            draw_debug_bounds(dc.bounding_box);
 
         optional<primitive_gpu_data&> prim_gpu_data = m_scene->get_primitive_gpu_data(dc.primitive_gpu_data_id);
         if (!prim_gpu_data)
@@ -83,7 +67,7 @@ void geometry_pass::execute(graphics_device_context_handle& device_context)
             warn_missing_draw("Mesh gpu data");
             continue;
         }
-        optional<material&> mat                   = m_scene->get_material(dc.material_hnd);
+        optional<const material&> mat             = m_scene->read_material(dc.material_hnd);
         optional<material_gpu_data&> mat_gpu_data = m_scene->get_material_gpu_data(mat->gpu_data);
         if (!mat || !mat_gpu_data)
         {
@@ -91,121 +75,235 @@ void geometry_pass::execute(graphics_device_context_handle& device_context)
             continue;
         }
 
-        gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache->get_opaque(prim_gpu_data->vertex_layout, prim_gpu_data->input_assembly, m_wireframe, mat->double_sided);
+        gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache->get_opaque(prim_gpu_data->vertex_layout, prim_gpu_data->input_assembly, m_wireframe, mat->double_sided, false);
 
         device_context->bind_pipeline(dc_pipeline);
+        auto mapping = dc_pipeline->get_resource_mapping();
+        if (!m_slots.resolved)
+            resolve_resource_slots(mapping, m_slots);
         device_context->set_viewport(0, 1, &m_viewport);
 
-        dc_pipeline->get_resource_mapping()->set("model_data", m_gpu_data->model_data_buffer);
-        dc_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
-        dc_pipeline->get_resource_mapping()->set("material_data", mat_gpu_data->material_data_buffer);
+        mapping->set_buffer_range(m_slots.model_data, model_ring.get_buffer(), model_ring.offset(m_gpu_data->model_data_index), model_ring.element_size());
+        mapping->set(m_slots.camera_data, m_camera_data_buffer);
+        if (!bind_material(mapping, m_slots, mat.value(), mat_gpu_data.value()))
+            continue;
 
-        if (mat_gpu_data->per_material_data.base_color_texture)
-        {
-            MANGO_ASSERT(mat->base_color_texture_gpu_data.has_value(), "Texture has no gpu data!");
-            optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat->base_color_texture_gpu_data.value());
-            if (!tex)
-            {
-                warn_missing_draw("Base Color Texture");
-                continue;
-            }
-            dc_pipeline->get_resource_mapping()->set("texture_base_color", tex->graphics_texture);
-            dc_pipeline->get_resource_mapping()->set("sampler_base_color", tex->graphics_sampler);
-        }
-        else
+        device_context->submit_pipeline_state_resources();
+
+        bind_geometry(device_context, prim_gpu_data.value());
+
+        m_rpei.draw_calls++;
+        m_rpei.vertices += std::max(prim_gpu_data->draw_call_desc.vertex_count, prim_gpu_data->draw_call_desc.index_count);
+        device_context->draw(prim_gpu_data->draw_call_desc.vertex_count, prim_gpu_data->draw_call_desc.index_count, prim_gpu_data->draw_call_desc.instance_count,
+                             prim_gpu_data->draw_call_desc.base_vertex, prim_gpu_data->draw_call_desc.base_instance, prim_gpu_data->draw_call_desc.index_offset);
+    }
+}
+
+void geometry_pass::execute_multi_draw(graphics_device_context_handle& device_context)
+{
+    auto warn_missing_draw = [](string what) { MANGO_LOG_WARN("{0} missing for draw. Skipping DrawCall!", what); };
+
+    m_batcher.clear();
+    for (int32 c = 0; c < m_opaque_count; ++c)
+    {
+        const draw_key& dc = m_draws[c];
+
+        if (m_debug_bounds)
+            draw_debug_bounds(dc.bounding_box);
+
+        optional<primitive_gpu_data&> prim_gpu_data = m_scene->get_primitive_gpu_data(dc.primitive_gpu_data_id);
+        if (!prim_gpu_data)
         {
-            dc_pipeline->get_resource_mapping()->set("texture_base_color", m_default_texture_2D);
+            warn_missing_draw("Primitive gpu data");
+            continue;
         }
-        if (mat_gpu_data->per_material_data.roughness_metallic_texture)
+        optional<mesh_gpu_data&> m_gpu_data = m_scene->get_mesh_gpu_data(dc.mesh_gpu_data_id);
+        if (!m_gpu_data)
         {
-            MANGO_ASSERT(mat->metallic_roughness_texture_gpu_data.has_value(), "Texture has no gpu data!");
-            optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat->metallic_roughness_texture_gpu_data.value());
-            if (!tex)
-            {
-                warn_missing_draw("Roughness Metallic Texture");
-                continue;
-            }
-            dc_pipeline->get_resource_mapping()->set("texture_roughness_metallic", tex->graphics_texture);
-            dc_pipeline->get_resource_mapping()->set("sampler_roughness_metallic", tex->graphics_sampler);
+            warn_missing_draw("Mesh gpu data");
+            continue;
         }
-        else
+        optional<const material&> mat             = m_scene->read_material(dc.material_hnd);
+        optional<material_gpu_data&> mat_gpu_data = m_scene->get_material_gpu_data(mat->gpu_data);
+        if (!mat || !mat_gpu_data)
         {
-            dc_pipeline->get_resource_mapping()->set("texture_roughness_metallic", m_default_texture_2D);
+            warn_missing_draw("Material");
+            continue;
         }
-        if (mat_gpu_data->per_material_data.occlusion_texture)
+
+        gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache->get_opaque(prim_gpu_data->vertex_layout, prim_gpu_data->input_assembly, m_wireframe, mat->double_sided, true);
+        m_batcher.add(0, dc_pipeline, prim_gpu_data.value(), m_gpu_data->per_mesh_data, mat.value(), mat_gpu_data.value(), true);
+    }
+
+    m_batcher.build();
+    if (!m_batcher.upload(device_context))
+        return;
+
+    for (const multi_draw_batcher::batch& b : m_batcher.get_batches())
+    {
+        device_context->bind_pipeline(b.pipeline);
+        auto mapping = b.pipeline->get_resource_mapping();
+        if (!m_multi_draw_slots.resolved)
+            resolve_resource_slots(mapping, m_multi_draw_slots);
+        device_context->set_viewport(0, 1, &m_viewport);
+
+        mapping->set(m_multi_draw_slots.model_data, m_batcher.get_model_data_buffer());
+        mapping->set(m_multi_draw_slots.camera_data, m_camera_data_buffer);
+        if (!bind_material(mapping, m_multi_draw_slots, *b.mat, *b.mat_gpu_data))
+            continue;
+
+        device_context->submit_pipeline_state_resources();
+
+        bind_geometry(device_context, *b.geometry);
+
+        m_rpei.draw_calls++;
+        m_rpei.vertices += b.vertex_count;
+        if (b.first_command < 0)
         {
-            MANGO_ASSERT(mat->occlusion_texture_gpu_data.has_value(), "Texture has no gpu data!");
-            optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat->occlusion_texture_gpu_data.value());
-            if (!tex)
-            {
-                warn_missing_draw("Occlusion Texture");
-                continue;
-            }
-            dc_pipeline->get_resource_mapping()->set("texture_occlusion", tex->graphics_texture);
-            dc_pipeline->get_resource_mapping()->set("sampler_occlusion", tex->graphics_sampler);
+            const draw_call_description& dcd = b.geometry->draw_call_desc;
+            device_context->draw(dcd.vertex_count, dcd.index_count, dcd.instance_count, dcd.base_vertex, b.first_entry, dcd.index_offset);
         }
         else
         {
-            dc_pipeline->get_resource_mapping()->set("texture_occlusion", m_default_texture_2D);
+            device_context->draw_indexed_indirect(m_batcher.get_command_buffer(), b.first_command * static_cast<int32>(sizeof(draw_indexed_indirect_command)), b.draw_count,
+                                                  static_cast<int32>(sizeof(draw_indexed_indirect_command)));
         }
-        if (mat_gpu_data->per_material_data.normal_texture)
+    }
+}
+
+void geometry_pass::draw_debug_bounds(const axis_aligned_bounding_box& bb)
+{
+    auto corners = bb.get_corners();
+    m_debug_drawer->set_color(color_rgb(1.0f, 0.0f, 0.0f));
+    m_debug_drawer->add(corners[0], corners[1]);
+    m_debug_drawer->add(corners[1], corners[3]);
+    m_debug_drawer->add(corners[3], corners[2]);
+    m_debug_drawer->add(corners[2], corners[6]);
+    m_debug_drawer->add(corners[6], corners[4]);
+    m_debug_drawer->add(corners[4], corners[0]);
+    m_debug_drawer->add(corners[0], corners[2]);
+
+    m_debug_drawer->add(corners[5], corners[4]);
+    m_debug_drawer->add(corners[4], corners[6]);
+    m_debug_drawer->add(corners[6], corners[7]);
+    m_debug_drawer->add(corners[7], corners[3]);
+    m_debug_drawer->add(corners[3], corners[1]);
+    m_debug_drawer->add(corners[1], corners[5]);
+    m_debug_drawer->add(corners[5], corners[7]);
+}
+
+bool geometry_pass::bind_material(const gfx_handle<shader_resource_mapping>& mapping, const resource_slots& slots, const material& mat, const material_gpu_data& mat_gpu_data)
+{
+    auto warn_missing_draw = [](string what) { MANGO_LOG_WARN("{0} missing for draw. Skipping DrawCall!", what); };
+
+    const uniform_ring_buffer& material_ring = m_scene->get_material_data_ring();
+    mapping->set_buffer_range(slots.material_data, material_ring.get_buffer(), material_ring.offset(mat_gpu_data.material_data_index), material_ring.element_size());
+
+    if (mat_gpu_data.per_material_data.base_color_texture)
+    {
+        MANGO_ASSERT(mat.base_color_texture_gpu_data.has_value(), "Texture has no gpu data!");
+        optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat.base_color_texture_gpu_data.value());
+        if (!tex)
         {
-            MANGO_ASSERT(mat->normal_texture_gpu_data.has_value(), "Texture has no gpu data!");
-            optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat->normal_texture_gpu_data.value());
-            if (!tex)
-            {
-                warn_missing_draw("Normal Texture");
-                continue;
-            }
-            dc_pipeline->get_resource_mapping()->set("texture_normal", tex->graphics_texture);
-            dc_pipeline->get_resource_mapping()->set("sampler_normal", tex->graphics_sampler);
+            warn_missing_draw("Base Color Texture");
+            return false;
         }
-        else
+        mapping->set(slots.texture_base_color, tex->graphics_texture);
+        mapping->set(slots.sampler_base_color, tex->graphics_sampler);
+    }
+    else
+    {
+        mapping->set(slots.texture_base_color, m_default_texture_2D);
+    }
+    if (mat_gpu_data.per_material_data.roughness_metallic_texture)
+    {
+        MANGO_ASSERT(mat.metallic_roughness_texture_gpu_data.has_value(), "Texture has no gpu data!");
+        optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat.metallic_roughness_texture_gpu_data.value());
+        if (!tex)
         {
-            dc_pipeline->get_resource_mapping()->set("texture_normal", m_default_texture_2D);
+            warn_missing_draw("Roughness Metallic Texture");
+            return false;
         }
-        if (mat_gpu_data->per_material_data.emissive_color_texture)
+        mapping->set(slots.texture_roughness_metallic, tex->graphics_texture);
+        mapping->set(slots.sampler_roughness_metallic, tex->graphics_sampler);
+    }
+    else
+    {
+        mapping->set(slots.texture_roughness_metallic, m_default_texture_2D);
+    }
+    if (mat_gpu_data.per_material_data.occlusion_texture)
+    {
+        MANGO_ASSERT(mat.occlusion_texture_gpu_data.has_value(), "Texture has no gpu data!");
+        optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat.occlusion_texture_gpu_data.value());
+        if (!tex)
         {
-            MANGO_ASSERT(mat->emissive_texture_gpu_data.has_value(), "Texture has no gpu data!");
-            optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat->emissive_texture_gpu_data.value());
-            if (!tex)
-            {
-                warn_missing_draw("Emissive Color Texture");
-                continue;
-            }
-            dc_pipeline->get_resource_mapping()->set("texture_emissive_color", tex->graphics_texture);
-            dc_pipeline->get_resource_mapping()->set("sampler_emissive_color", tex->graphics_sampler);
+            warn_missing_draw("Occlusion Texture");
+            return false;
         }
-        else
+        mapping->set(slots.texture_occlusion, tex->graphics_texture);
+        mapping->set(slots.sampler_occlusion, tex->graphics_sampler);
+    }
+    else
+    {
+        mapping->set(slots.texture_occlusion, m_default_texture_2D);
+    }
+    if (mat_gpu_data.per_material_data.normal_texture)
+    {
+        MANGO_ASSERT(mat.normal_texture_gpu_data.has_value(), "Texture has no gpu data!");
+        optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat.normal_texture_gpu_data.value());
+        if (!tex)
         {
-            dc_pipeline->get_resource_mapping()->set("texture_emissive_color", m_default_texture_2D);
+            warn_missing_draw("Normal Texture");
+            return false;
         }
-
-        device_context->submit_pipeline_state_resources();
-
-        device_context->set_index_buffer(prim_gpu_data->index_buffer_view.graphics_buffer, prim_gpu_data->index_type);
-
-        std::vector<gfx_handle<const gfx_buffer>> vbs;
-        vbs.reserve(prim_gpu_data->vertex_buffer_views.size());
-        std::vector<int32> bindings;
-        bindings.reserve(prim_gpu_data->vertex_buffer_views.size());
-        std::vector<int32> offsets;
-        offsets.reserve(prim_gpu_data->vertex_buffer_views.size());
-        int32 idx = 0;
-        for (auto vbv : prim_gpu_data->vertex_buffer_views)
+        mapping->set(slots.texture_normal, tex->graphics_texture);
+        mapping->set(slots.sampler_normal, tex->graphics_sampler);
+    }
+    else
+    {
+        mapping->set(slots.texture_normal, m_default_texture_2D);
+    }
+    if (mat_gpu_data.per_material_data.emissive_color_texture)
+    {
+        MANGO_ASSERT(mat.emissive_texture_gpu_data.has_value(), "Texture has no gpu data!");
+        optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat.emissive_texture_gpu_data.value());
+        if (!tex)
         {
-            vbs.push_back(vbv.graphics_buffer);
-            bindings.push_back(idx++);
-            offsets.push_back(vbv.offset);
+            warn_missing_draw("Emissive Color Texture");
+            return false;
         }
+        mapping->set(slots.texture_emissive_color, tex->graphics_texture);
+        mapping->set(slots.sampler_emissive_color, tex->graphics_sampler);
+    }
+    else
+    {
+        mapping->set(slots.texture_emissive_color, m_default_texture_2D);
+    }
 
-        device_context->set_vertex_buffers(static_cast<int32>(prim_gpu_data->vertex_buffer_views.size()), vbs.data(), bindings.data(), offsets.data());
+    return true;
+}
 
-        m_rpei.draw_calls++;
-        m_rpei.vertices += std::max(prim_gpu_data->draw_call_desc.vertex_count, prim_gpu_data->draw_call_desc.index_count);
-        device_context->draw(prim_gpu_data->draw_call_desc.vertex_count, prim_gpu_data->draw_call_desc.index_count, prim_gpu_data->draw_call_desc.instance_count,
-                             prim_gpu_data->draw_call_desc.base_vertex, prim_gpu_data->draw_call_desc.base_instance, prim_gpu_data->draw_call_desc.index_offset);
+void geometry_pass::bind_geometry(graphics_device_context_handle& device_context, const primitive_gpu_data& prim_gpu_data)
+{
+    frame_arena& arena = *m_shared_context->get_frame_arena();
+
+    device_context->set_index_buffer(prim_gpu_data.index_buffer_view.graphics_buffer, prim_gpu_data.index_type);
+
+    frame_vector<gfx_handle<const gfx_buffer>> vbs(arena);
+    vbs.reserve(prim_gpu_data.vertex_buffer_views.size());
+    frame_vector<int32> bindings(arena);
+    bindings.reserve(prim_gpu_data.vertex_buffer_views.size());
+    frame_vector<int32> offsets(arena);
+    offsets.reserve(prim_gpu_data.vertex_buffer_views.size());
+    int32 idx = 0;
+    for (const auto& vbv : prim_gpu_data.vertex_buffer_views)
+    {
+        vbs.push_back(vbv.graphics_buffer);
+        bindings.push_back(idx++);
+        offsets.push_back(vbv.offset);
     }
+
+    device_context->set_vertex_buffers(static_cast<int32>(prim_gpu_data.vertex_buffer_views.size()), vbs.data(), bindings.data(), offsets.data());
 }
 
 bool geometry_pass::create_pass_resources()
@@ -213,6 +311,7 @@ bool geometry_pass::create_pass_resources()
     PROFILE_ZONE;
     auto& graphics_device    = m_shared_context->get_graphics_device();
     auto& internal_resources = m_shared_context->get_internal_resources();
+    m_multi_draw_supported   = graphics_device->supports_multi_draw_indirect();
 
     shader_stage_create_info shader_info;
     shader_resource_resource_description res_resource_desc;
@@ -242,6 +341,22 @@ bool geometry_pass::create_pass_resources()
         if (!check_creation(m_geometry_pass_vertex.get(), "Geometry pass vertex shader"))
             return false;
 
+        if (m_multi_draw_supported)
+        {
+            res_resource_desc.defines.push_back({ "MULTI_DRAW", "" });
+            source = internal_resources->acquire(res_resource_desc);
+
+            source_desc.source = source->source.c_str();
+            source_desc.size   = static_cast<int32>(source->source.size());
+
+            shader_info.shader_source = source_desc;
+            shader_info.resources[1]  = { gfx_shader_stage_type::shader_stage_vertex, MODEL_DATA_BUFFER_BINDING_POINT, "model_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 };
+
+            m_geometry_pass_multi_draw_vertex = graphics_device->create_shader_stage(shader_info);
+            if (!check_creation(m_geometry_pass_multi_draw_vertex.get(), "Geometry pass multi draw vertex shader"))
+                return false;
+        }
+
         res_resource_desc.defines.clear();
     }
     // Geometry Pass Fragement Stage
@@ -282,40 +397,59 @@ bool geometry_pass::create_pass_resources()
         if (!check_creation(m_geometry_pass_fragment.get(), "Geometry pass fragment shader"))
             return false;
 
+        // the model data entries are bound for the vertex stage, the fragment stage reads the same buffer.
+        if (m_multi_draw_supported)
+        {
+            res_resource_desc.defines.push_back({ "MULTI_DRAW", "" });
+            source = internal_resources->acquire(res_resource_desc);
+
+            source_desc.source = source->source.c_str();
+            source_desc.size   = static_cast<int32>(source->source.size());
+
+            shader_info.shader_source = source_desc;
+
+            m_geometry_pass_multi_draw_fragment = graphics_device->create_shader_stage(shader_info);
+            if (!check_creation(m_geometry_pass_multi_draw_fragment.get(), "Geometry pass multi draw fragment shader"))
+                return false;
+        }
+
         res_resource_desc.defines.clear();
     }
 
-    graphics_pipeline_create_info geometry_pass_info = graphics_device->provide_graphics_pipeline_create_info();
-    auto geometry_pass_pipeline_layout               = graphics_device->create_pipeline_resource_layout({
-                      { gfx_shader_stage_type::shader_stage_vertex, CAMERA_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer, gfx_shader_resource_access::shader_access_dynamic },
-                      { gfx_shader_stage_type::shader_stage_vertex, MODEL_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer, gfx_shader_resource_access::shader_access_dynamic },
+    // model data is one uniform buffer per draw, or one shader storage buffer with all draws for multi draw indirect.
+    auto create_pipeline_layout = [&graphics_device](gfx_shader_resource_type model_data_type) {
+        return graphics_device->create_pipeline_resource_layout({
+            { gfx_shader_stage_type::shader_stage_vertex, CAMERA_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_vertex, MODEL_DATA_BUFFER_BINDING_POINT, model_data_type, gfx_shader_resource_access::shader_access_dynamic },
 
-                      { gfx_shader_stage_type::shader_stage_fragment, MATERIAL_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer,
-                        gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, MATERIAL_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer,
+              gfx_shader_resource_access::shader_access_dynamic },
 
-                      { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR, gfx_shader_resource_type::shader_resource_input_attachment,
-                        gfx_shader_resource_access::shader_access_dynamic },
-                      { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
 
-                      { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_ROUGHNESS_METALLIC, gfx_shader_resource_type::shader_resource_input_attachment,
-                        gfx_shader_resource_access::shader_access_dynamic },
-                      { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_ROUGHNESS_METALLIC, gfx_shader_resource_type::shader_resource_sampler,
-                        gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_ROUGHNESS_METALLIC, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_ROUGHNESS_METALLIC, gfx_shader_resource_type::shader_resource_sampler,
+              gfx_shader_resource_access::shader_access_dynamic },
 
-                      { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_OCCLUSION, gfx_shader_resource_type::shader_resource_input_attachment,
-                        gfx_shader_resource_access::shader_access_dynamic },
-                      { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_OCCLUSION, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_OCCLUSION, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_OCCLUSION, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
 
-                      { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_NORMAL, gfx_shader_resource_type::shader_resource_input_attachment,
-                        gfx_shader_resource_access::shader_access_dynamic },
-                      { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_NORMAL, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_NORMAL, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_NORMAL, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
 
-                      { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_EMISSIVE_COLOR, gfx_shader_resource_type::shader_resource_input_attachment,
-                        gfx_shader_resource_access::shader_access_dynamic },
-                      { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_EMISSIVE_COLOR, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
-    });
+            { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_EMISSIVE_COLOR, gfx_shader_resource_type::shader_resource_input_attachment,
+              gfx_shader_resource_access::shader_access_dynamic },
+            { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_EMISSIVE_COLOR, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+        });
+    };
 
-    geometry_pass_info.pipeline_layout = geometry_pass_pipeline_layout;
+    graphics_pipeline_create_info geometry_pass_info = graphics_device->provide_graphics_pipeline_create_info();
+    geometry_pass_info.pipeline_layout               = create_pipeline_layout(gfx_shader_resource_type::shader_resource_constant_buffer);
 
     geometry_pass_info.shader_stage_descriptor.vertex_shader_stage   = m_geometry_pass_vertex;
     geometry_pass_info.shader_stage_descriptor.fragment_shader_stage = m_geometry_pass_fragment;
@@ -333,5 +467,33 @@ bool geometry_pass::create_pass_resources()
 
     m_pipeline_cache->set_opaque_base(geometry_pass_info);
 
+    if (m_multi_draw_supported)
+    {
+        geometry_pass_info.pipeline_layout                               = create_pipeline_layout(gfx_shader_resource_type::shader_resource_buffer_storage);
+        geometry_pass_info.shader_stage_descriptor.vertex_shader_stage   = m_geometry_pass_multi_draw_vertex;
+        geometry_pass_info.shader_stage_descriptor.fragment_shader_stage = m_geometry_pass_multi_draw_fragment;
+
+        m_pipeline_cache->set_opaque_multi_draw_base(geometry_pass_info);
+        m_batcher.create(graphics_device);
+    }
+
     return true;
 }
+
+void geometry_pass::resolve_resource_slots(const gfx_handle<shader_resource_mapping>& mapping, resource_slots& slots)
+{
+    slots.model_data                 = mapping->get_slot("model_data");
+    slots.camera_data                = mapping->get_slot("camera_data");
+    slots.material_data              = mapping->get_slot("material_data");
+    slots.texture_base_color         = mapping->get_slot("texture_base_color");
+    slots.sampler_base_color         = mapping->get_slot("sampler_base_color");
+    slots.texture_roughness_metallic = mapping->get_slot("texture_roughness_metallic");
+    slots.sampler_roughness_metallic = mapping->get_slot("sampler_roughness_metallic");
+    slots.texture_occlusion          = mapping->get_slot("texture_occlusion");
+    slots.sampler_occlusion          = mapping->get_slot("sampler_occlusion");
+    slots.texture_normal             = mapping->get_slot("texture_normal");
+    slots.sampler_normal             = mapping->get_slot("sampler_normal");
+    slots.texture_emissive_color     = mapping->get_slot("texture_emissive_color");
+    slots.sampler_emissive_color     = mapping->get_slot("sampler_emissive_color");
+    slots.resolved                   = true;
+}
@@ -9,6 +9,7 @@
 
 #include <graphics/graphics.hpp>
 #include <rendering/debug_drawer.hpp>
+#include <rendering/multi_draw_batcher.hpp>
 #include <rendering/passes/render_pass.hpp>
 #include <rendering/renderer_pipeline_cache.hpp>
 
@@ -64,13 +65,6 @@ namespace mango
             m_render_targets = render_targets;
         }
 
-        //! \brief Set frustum culling.
-        //! \param[in] frustum_culling True if frustum culling is enabled, else false.
-        inline void set_frustum_culling(bool frustum_culling)
-        {
-            m_frustum_culling = frustum_culling;
-        }
-
         //! \brief Set debug bounds drawing.
         //! \param[in] debug_bounds True if drawing debug bounds is enabled, else false.
         inline void set_debug_bounds(bool debug_bounds)
@@ -85,6 +79,14 @@ namespace mango
             m_wireframe = wireframe;
         }
 
+        //! \brief Set multi draw indirect submission.
+        //! \details Only used, if the \a graphics_device supports multi draw indirect.
+        //! \param[in] multi_draw True if draws should be batched and submitted with multi draw indirect, else false.
+        inline void set_multi_draw(bool multi_draw)
+        {
+            m_multi_draw = multi_draw;
+        }
+
         //! \brief Set a default 2d texture.
         //! \param[in] default_texture_2D The default 2d texture.
         inline void set_default_texture_2D(const gfx_handle<const gfx_texture>& default_texture_2D)
@@ -92,13 +94,6 @@ namespace mango
             m_default_texture_2D = default_texture_2D;
         }
 
-        //! \brief Set the camera frustum.
-        //! \param[in] camera_frustum The cameras \a bounding_frustum.
-        inline void set_camera_frustum(const bounding_frustum& camera_frustum)
-        {
-            m_camera_frustum = camera_frustum;
-        }
-
         //! \brief Set the number of opaque draw calls in draws.
         //! \param[in] opaque_count The number of opaque draw calls in draws.
         inline void set_opaque_count(int32 opaque_count)
@@ -107,10 +102,13 @@ namespace mango
         }
 
         //! \brief Set draws.
-        //! \param[in] draws The list of \a draw_keys.
-        inline void set_draws(const shared_ptr<std::vector<draw_key>>& draws)
+        //! \details The \a draw_keys are not copied and have to stay valid until the pass is executed.
+        //! \param[in] draws Pointer to the list of \a draw_keys.
+        //! \param[in] draw_count The number of \a draw_keys in draws.
+        inline void set_draws(const draw_key* draws, int32 draw_count)
         {
-            m_draws = draws;
+            m_draws      = draws;
+            m_draw_count = draw_count;
         }
 
       private:
@@ -119,10 +117,61 @@ namespace mango
 
         bool create_pass_resources() override;
 
+        //! \brief The shader resource slots of the geometry \a gfx_pipelines.
+        struct resource_slots
+        {
+            //! \cond NO_COND
+            bool resolved = false;
+            shader_resource_mapping::resource_slot model_data;
+            shader_resource_mapping::resource_slot camera_data;
+            shader_resource_mapping::resource_slot material_data;
+            shader_resource_mapping::resource_slot texture_base_color;
+            shader_resource_mapping::resource_slot sampler_base_color;
+            shader_resource_mapping::resource_slot texture_roughness_metallic;
+            shader_resource_mapping::resource_slot sampler_roughness_metallic;
+            shader_resource_mapping::resource_slot texture_occlusion;
+            shader_resource_mapping::resource_slot sampler_occlusion;
+            shader_resource_mapping::resource_slot texture_normal;
+            shader_resource_mapping::resource_slot sampler_normal;
+            shader_resource_mapping::resource_slot texture_emissive_color;
+            shader_resource_mapping::resource_slot sampler_emissive_color;
+            //! \endcond
+        };
+
+        //! \brief Resolves the shader resource slots of the geometry \a gfx_pipelines.
+        //! \param[in] mapping The \a shader_resource_mapping of one of the geometry \a gfx_pipelines.
+        //! \param[out] slots The \a resource_slots to fill.
+        void resolve_resource_slots(const gfx_handle<shader_resource_mapping>& mapping, resource_slots& slots);
+
+        //! \brief Draws the opaque draws batched with multi draw indirect.
+        //! \param[in] device_context The \a graphics_device_context to record to.
+        void execute_multi_draw(graphics_device_context_handle& device_context);
+
+        //! \brief Adds the lines of a bounding box to the \a debug_drawer.
+        //! \param[in] bb The \a axis_aligned_bounding_box to draw.
+        void draw_debug_bounds(const axis_aligned_bounding_box& bb);
+
+        //! \brief Sets the material data and textures of a draw.
+        //! \param[in] mapping The \a shader_resource_mapping of the bound \a gfx_pipeline.
+        //! \param[in] slots The resolved \a resource_slots of the bound \a gfx_pipeline.
+        //! \param[in] mat The \a material to set.
+        //! \param[in] mat_gpu_data The \a material_gpu_data of the material.
+        //! \return True on success, false if a texture is missing.
+        bool bind_material(const gfx_handle<shader_resource_mapping>& mapping, const resource_slots& slots, const material& mat, const material_gpu_data& mat_gpu_data);
+
+        //! \brief Sets the vertex and index buffers of a draw.
+        //! \param[in] device_context The \a graphics_device_context to record to.
+        //! \param[in] prim_gpu_data The \a primitive_gpu_data to draw.
+        void bind_geometry(graphics_device_context_handle& device_context, const primitive_gpu_data& prim_gpu_data);
+
         //! \brief The vertex \a gfx_shader_stage for the deferred geometry pass.
         gfx_handle<const gfx_shader_stage> m_geometry_pass_vertex;
         //! \brief The fragment \a gfx_shader_stage for the deferred geometry pass.
         gfx_handle<const gfx_shader_stage> m_geometry_pass_fragment;
+        //! \brief The vertex \a gfx_shader_stage for the deferred geometry pass drawing with multi draw indirect.
+        gfx_handle<const gfx_shader_stage> m_geometry_pass_multi_draw_vertex;
+        //! \brief The fragment \a gfx_shader_stage for the deferred geometry pass drawing with multi draw indirect.
+        gfx_handle<const gfx_shader_stage> m_geometry_pass_multi_draw_fragment;
 
         //! \brief The \a renderer_pipeline_cache to create and cache \a gfx_pipelines for the geometry.
         shared_ptr<renderer_pipeline_cache> m_pipeline_cache;
@@ -136,17 +185,12 @@ namespace mango
         //! \brief The \a gfx_viewport to render to.
         gfx_viewport m_viewport;
 
-        //! \brief The \a bounding_frustum of the camera.
-        bounding_frustum m_camera_frustum;
-
         //! \brief The render targets to render to.
         std::vector<gfx_handle<const gfx_texture>> m_render_targets;
 
         //! \brief The camera data \a gfx_buffer.
         gfx_handle<const gfx_buffer> m_camera_data_buffer;
 
-        //! \brief True if frustum culling is enabled, else false.
-        bool m_frustum_culling;
         //! \brief True if drawing debug bounds is enabled, else false.
         bool m_debug_bounds;
         //! \brief True if wireframe drawing is enabled, else false.
@@ -158,8 +202,23 @@ namespace mango
         //! \brief The default 2d \a gfx_texture.
         gfx_handle<const gfx_texture> m_default_texture_2D;
 
+        //! \brief True if multi draw indirect submission is enabled, else false.
+        bool m_multi_draw = false;
+        //! \brief True if the \a graphics_device supports multi draw indirect, else false.
+        bool m_multi_draw_supported = false;
+        //! \brief The \a multi_draw_batcher batching the draws for multi draw indirect.
+        multi_draw_batcher m_batcher;
+
+        //! \brief The pre-resolved shader resource slots of the geometry \a gfx_pipelines.
+        //! \details All of them are created with the same layout and shader stages, so the slots are resolved once with the first one.
+        resource_slots m_slots;
+        //! \brief The pre-resolved shader resource slots of the geometry \a gfx_pipelines drawing with multi draw indirect.
+        resource_slots m_multi_draw_slots;
+
         //! \brief The list of \a draw_keys.
-        shared_ptr<std::vector<draw_key>> m_draws;
+        const draw_key* m_draws = nullptr;
+        //! \brief The number of \a draw_keys in the list.
+        int32 m_draw_count = 0;
     };
 } // namespace mango
 
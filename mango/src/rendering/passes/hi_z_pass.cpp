@@ -0,0 +1,322 @@
+//! \file      hi_z_pass.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <mango/profile.hpp>
+#include <rendering/passes/hi_z_pass.hpp>
+#include <rendering/renderer_bindings.hpp>
+#include <resources/resources_impl.hpp>
+
+using namespace mango;
+
+const render_pass_execution_info hi_z_pass::s_rpei{ 0, 0 };
+
+const int32 hi_z_pass::readback_max_size;
+const int32 hi_z_pass::readback_slots;
+
+//! \brief Calculates the number of work groups to cover a size with groups of 8 invocations.
+//! \param[in] size The size to cover.
+//! \return The number of work groups.
+static int32 group_count(int32 size)
+{
+    return (size + 7) / 8;
+}
+
+hi_z_pass::hi_z_pass()
+    : m_input_width(0)
+    , m_input_height(0)
+    , m_view_projection(mat4::Identity())
+    , m_pyramid_dirty(true)
+    , m_readback_level(0)
+    , m_last_slot(-1)
+{
+}
+
+void hi_z_pass::attach(const shared_ptr<context_impl>& context)
+{
+    m_shared_context = context;
+
+    create_pass_resources();
+}
+
+void hi_z_pass::execute(graphics_device_context_handle& device_context)
+{
+    GL_NAMED_PROFILE_ZONE("Hi-Z Pyramid");
+    NAMED_PROFILE_ZONE("Hi-Z Pyramid");
+
+    if (!m_depth_input || m_input_width <= 0 || m_input_height <= 0)
+        return;
+    if (m_pyramid_dirty && !create_pyramid(device_context))
+        return;
+
+    barrier_description bd;
+    bd.barrier_bit = gfx_barrier_bit::shader_image_access_barrier_bit;
+
+    // first level from the depth buffer
+    device_context->bind_pipeline(m_depth_reduction_pipeline);
+    auto mapping = m_depth_reduction_pipeline->get_resource_mapping();
+    mapping->set("texture_depth_input", m_depth_input);
+    mapping->set("sampler_depth_input", m_depth_sampler);
+    mapping->set("image_hi_z_destination", m_level_views[0]);
+    device_context->submit_pipeline_state_resources();
+
+    int32 level_width  = std::max(m_input_width / 2, 1);
+    int32 level_height = std::max(m_input_height / 2, 1);
+    device_context->dispatch(group_count(level_width), group_count(level_height), 1);
+
+    // all other levels from the previous one
+    device_context->bind_pipeline(m_level_reduction_pipeline);
+    mapping = m_level_reduction_pipeline->get_resource_mapping();
+    for (int32 level = 1; level < static_cast<int32>(m_level_views.size()); ++level)
+    {
+        device_context->barrier(bd);
+
+        mapping->set("image_hi_z_source", m_level_views[level - 1]);
+        mapping->set("image_hi_z_destination", m_level_views[level]);
+        device_context->submit_pipeline_state_resources();
+
+        level_width  = std::max(level_width / 2, 1);
+        level_height = std::max(level_height / 2, 1);
+        device_context->dispatch(group_count(level_width), group_count(level_height), 1);
+    }
+
+    device_context->barrier(bd);
+
+    // readback for the cpu
+    int32 slot_index    = (m_last_slot + 1) % readback_slots;
+    readback_slot& slot = m_readback_slots[slot_index];
+
+    device_context->bind_pipeline(m_readback_pipeline);
+    mapping = m_readback_pipeline->get_resource_mapping();
+    mapping->set("image_hi_z_source", m_level_views[m_readback_level]);
+    mapping->set("hi_z_readback", slot.buffer);
+    device_context->submit_pipeline_state_resources();
+
+    device_context->dispatch(group_count(slot.readback.width), group_count(slot.readback.height), 1);
+
+    // the cpu reads through the persistent mapping.
+    bd.barrier_bit = gfx_barrier_bit::client_mapped_buffer_barrier_bit;
+    device_context->barrier(bd);
+
+    slot.readback.view_projection = m_view_projection;
+    slot.written                  = device_context->fence(semaphore_create_info());
+    m_last_slot                   = slot_index;
+}
+
+const hi_z_readback* hi_z_pass::get_readback(graphics_device_context_handle& device_context)
+{
+    PROFILE_ZONE;
+    if (m_last_slot < 0)
+        return nullptr;
+
+    // the slot written next is not checked, the gpu could still be writing it this frame.
+    for (int32 age = 0; age < readback_slots - 1; ++age)
+    {
+        readback_slot& slot = m_readback_slots[(m_last_slot + readback_slots - age) % readback_slots];
+        if (slot.written && device_context->is_signaled(slot.written))
+            return &slot.readback;
+    }
+
+    return nullptr;
+}
+
+bool hi_z_pass::create_pyramid(graphics_device_context_handle& device_context)
+{
+    PROFILE_ZONE;
+    auto& graphics_device = m_shared_context->get_graphics_device();
+    m_last_slot           = -1;
+
+    int32 width  = std::max(m_input_width / 2, 1);
+    int32 height = std::max(m_input_height / 2, 1);
+
+    texture_create_info texture_info;
+    texture_info.texture_type   = gfx_texture_type::texture_type_2d;
+    texture_info.texture_format = gfx_format::r32f;
+    texture_info.width          = width;
+    texture_info.height         = height;
+    texture_info.miplevels      = graphics::calculate_mip_count(width, height);
+    texture_info.array_layers   = 1;
+    m_hi_z_texture              = graphics_device->create_texture(texture_info);
+    if (!check_creation(m_hi_z_texture.get(), "hi-z texture"))
+        return false;
+
+    m_level_views.clear();
+    for (int32 level = 0; level < texture_info.miplevels; ++level)
+        m_level_views.push_back(graphics_device->create_image_texture_view(m_hi_z_texture, level));
+
+    // the first level small enough for the cpu, each texel covers 2^(level + 1) pixels.
+    m_readback_level = 0;
+    while (std::max(width, height) > readback_max_size && m_readback_level + 1 < texture_info.miplevels)
+    {
+        width  = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+        ++m_readback_level;
+    }
+
+    buffer_create_info buffer_info;
+    buffer_info.buffer_target = gfx_buffer_target::buffer_target_shader_storage;
+    buffer_info.buffer_access = gfx_buffer_access::buffer_access_mapped_access_read;
+    buffer_info.size          = static_cast<int64>(width) * height * sizeof(float);
+    for (readback_slot& slot : m_readback_slots)
+    {
+        slot.buffer = graphics_device->create_buffer(buffer_info);
+        if (!check_creation(slot.buffer.get(), "hi-z readback buffer"))
+            return false;
+
+        slot.readback.depth = static_cast<const float*>(device_context->map_buffer_data(slot.buffer, 0, static_cast<int32>(buffer_info.size)));
+        if (!check_mapping(slot.readback.depth, "hi-z readback buffer"))
+            return false;
+
+        slot.written                  = nullptr;
+        slot.readback.width           = width;
+        slot.readback.height          = height;
+        slot.readback.texel_size      = 2 << m_readback_level;
+        slot.readback.viewport_width  = m_input_width;
+        slot.readback.viewport_height = m_input_height;
+        slot.readback.view_projection = mat4::Identity();
+    }
+
+    m_pyramid_dirty = false;
+    return true;
+}
+
+bool hi_z_pass::create_pass_resources()
+{
+    PROFILE_ZONE;
+    auto& graphics_device    = m_shared_context->get_graphics_device();
+    auto& internal_resources = m_shared_context->get_internal_resources();
+
+    shader_stage_create_info shader_info;
+    shader_resource_resource_description res_resource_desc;
+    shader_source_description source_desc;
+
+    // Depth Reduction Compute Stage
+    {
+        res_resource_desc.path = "res/shader/hi_z_compute/c_hi_z_reduction.glsl";
+        res_resource_desc.defines.push_back({ "COMPUTE", "" });
+        res_resource_desc.defines.push_back({ "REDUCE_DEPTH_BUFFER", "" });
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 3;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_DEPTH_SAMPLER, "texture_depth_input", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_DEPTH_SAMPLER, "sampler_depth_input", gfx_shader_resource_type::shader_resource_sampler, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_IMAGE_DESTINATION, "image_hi_z_destination", gfx_shader_resource_type::shader_resource_image_storage, 1 },
+        } };
+
+        m_depth_reduction_compute = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_depth_reduction_compute.get(), "hi-z depth reduction compute shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+    // Level Reduction Compute Stage
+    {
+        res_resource_desc.path = "res/shader/hi_z_compute/c_hi_z_reduction.glsl";
+        res_resource_desc.defines.push_back({ "COMPUTE", "" });
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 2;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_IMAGE_SOURCE, "image_hi_z_source", gfx_shader_resource_type::shader_resource_image_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_IMAGE_DESTINATION, "image_hi_z_destination", gfx_shader_resource_type::shader_resource_image_storage, 1 },
+        } };
+
+        m_level_reduction_compute = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_level_reduction_compute.get(), "hi-z level reduction compute shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+    // Readback Compute Stage
+    {
+        res_resource_desc.path = "res/shader/hi_z_compute/c_hi_z_readback.glsl";
+        res_resource_desc.defines.push_back({ "COMPUTE", "" });
+        const shader_resource* source = internal_resources->acquire(res_resource_desc);
+
+        source_desc.entry_point = "main";
+        source_desc.source      = source->source.c_str();
+        source_desc.size        = static_cast<int32>(source->source.size());
+
+        shader_info.stage         = gfx_shader_stage_type::shader_stage_compute;
+        shader_info.shader_source = source_desc;
+
+        shader_info.resource_count = 2;
+
+        shader_info.resources = { {
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_IMAGE_SOURCE, "image_hi_z_source", gfx_shader_resource_type::shader_resource_image_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_compute, HI_Z_READBACK_BUFFER_BINDING_POINT, "hi_z_readback", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+        } };
+
+        m_readback_compute = graphics_device->create_shader_stage(shader_info);
+        if (!check_creation(m_readback_compute.get(), "hi-z readback compute shader"))
+            return false;
+
+        res_resource_desc.defines.clear();
+    }
+
+    // Depth Reduction Pipeline
+    {
+        compute_pipeline_create_info reduction_pass_info = graphics_device->provide_compute_pipeline_create_info();
+        auto reduction_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
+                         { gfx_shader_stage_type::shader_stage_compute, HI_Z_DEPTH_SAMPLER, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+                         { gfx_shader_stage_type::shader_stage_compute, HI_Z_DEPTH_SAMPLER, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+                         { gfx_shader_stage_type::shader_stage_compute, HI_Z_IMAGE_DESTINATION, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        reduction_pass_info.pipeline_layout = reduction_pass_pipeline_layout;
+
+        reduction_pass_info.shader_stage_descriptor.compute_shader_stage = m_depth_reduction_compute;
+
+        m_depth_reduction_pipeline = graphics_device->create_compute_pipeline(reduction_pass_info);
+    }
+    // Level Reduction Pipeline
+    {
+        compute_pipeline_create_info reduction_pass_info = graphics_device->provide_compute_pipeline_create_info();
+        auto reduction_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
+                         { gfx_shader_stage_type::shader_stage_compute, HI_Z_IMAGE_SOURCE, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_dynamic },
+                         { gfx_shader_stage_type::shader_stage_compute, HI_Z_IMAGE_DESTINATION, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        reduction_pass_info.pipeline_layout = reduction_pass_pipeline_layout;
+
+        reduction_pass_info.shader_stage_descriptor.compute_shader_stage = m_level_reduction_compute;
+
+        m_level_reduction_pipeline = graphics_device->create_compute_pipeline(reduction_pass_info);
+    }
+    // Readback Pipeline
+    {
+        compute_pipeline_create_info readback_pass_info = graphics_device->provide_compute_pipeline_create_info();
+        auto readback_pass_pipeline_layout              = graphics_device->create_pipeline_resource_layout({
+                         { gfx_shader_stage_type::shader_stage_compute, HI_Z_IMAGE_SOURCE, gfx_shader_resource_type::shader_resource_image_storage, gfx_shader_resource_access::shader_access_dynamic },
+                         { gfx_shader_stage_type::shader_stage_compute, HI_Z_READBACK_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+                           gfx_shader_resource_access::shader_access_dynamic },
+        });
+
+        readback_pass_info.pipeline_layout = readback_pass_pipeline_layout;
+
+        readback_pass_info.shader_stage_descriptor.compute_shader_stage = m_readback_compute;
+
+        m_readback_pipeline = graphics_device->create_compute_pipeline(readback_pass_info);
+    }
+
+    return true;
+}
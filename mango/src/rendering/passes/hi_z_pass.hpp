@@ -0,0 +1,145 @@
+//! \file      hi_z_pass.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_HI_Z_PASS_HPP
+#define MANGO_HI_Z_PASS_HPP
+
+#include <graphics/graphics.hpp>
+#include <rendering/occlusion_culler.hpp>
+#include <rendering/passes/render_pass.hpp>
+
+namespace mango
+{
+    //! \brief A \a render_pass building a hierarchical depth buffer with the maximum depth of each texel.
+    //! \details The pyramid starts at half the resolution of the input depth and is reduced down to a single texel.
+    //! One coarse level is copied into a mapped buffer, so it can be used for occlusion culling on the cpu in the following frame.
+    class hi_z_pass : public render_pass
+    {
+      public:
+        hi_z_pass();
+        ~hi_z_pass() = default;
+
+        void attach(const shared_ptr<context_impl>& context) override;
+        void execute(graphics_device_context_handle& device_context) override;
+
+        void on_ui_widget() override{};
+
+        inline render_pass_execution_info get_info() override
+        {
+            return s_rpei;
+        }
+
+        //! \brief Set the depth texture to build the pyramid from.
+        //! \param[in] depth_input The depth texture.
+        //! \param[in] depth_sampler The \a gfx_sampler to sample the depth texture with.
+        inline void set_depth_input(const gfx_handle<const gfx_texture>& depth_input, const gfx_handle<const gfx_sampler>& depth_sampler)
+        {
+            m_depth_input   = depth_input;
+            m_depth_sampler = depth_sampler;
+        }
+
+        //! \brief Set the size of the depth texture.
+        //! \param[in] width Depth texture width.
+        //! \param[in] height Depth texture height.
+        inline void set_input_size(int32 width, int32 height)
+        {
+            m_pyramid_dirty |= width != m_input_width || height != m_input_height;
+            m_input_width  = width;
+            m_input_height = height;
+        }
+
+        //! \brief Set the view projection matrix the depth texture was rendered with.
+        //! \param[in] view_projection The view projection matrix.
+        inline void set_view_projection(const mat4& view_projection)
+        {
+            m_view_projection = view_projection;
+        }
+
+        //! \brief Retrieves the hierarchical depth texture.
+        //! \return The \a gfx_texture with the maximum depth in each mip level.
+        inline const gfx_handle<const gfx_texture>& get_hi_z_texture() const
+        {
+            return m_hi_z_texture;
+        }
+
+        //! \brief Retrieves the read back level of the last execution.
+        //! \details Has to be called before \a execute() in a frame, so the last execution is the previous frame.
+        //! Never waits for the gpu. If the previous frame is not finished yet, the one before is returned instead.
+        //! \param[in] device_context The recording \a graphics_device_context to check the fences with.
+        //! \return A pointer to the \a hi_z_readback or nullptr if no finished readback is available.
+        const hi_z_readback* get_readback(graphics_device_context_handle& device_context);
+
+        //! \brief The maximum width or height of the level read back for the cpu.
+        static const int32 readback_max_size = 128;
+
+      private:
+        //! \brief Execution info of this pass.
+        static const render_pass_execution_info s_rpei;
+
+        bool create_pass_resources() override;
+
+        //! \brief Creates the pyramid texture and the readback buffers for the current input size.
+        //! \param[in] device_context The recording \a graphics_device_context used to map the readback buffers.
+        //! \return True on success, else false.
+        bool create_pyramid(graphics_device_context_handle& device_context);
+
+        //! \brief The number of readback buffers used in turns.
+        //! \details The two newest can be read, while the gpu writes the oldest one.
+        static const int32 readback_slots = 3;
+
+        //! \brief A readback buffer with the data describing its content.
+        struct readback_slot
+        {
+            //! \brief The mapped shader storage buffer written by the gpu.
+            gfx_handle<const gfx_buffer> buffer;
+            //! \brief The fence signaled after the buffer was written.
+            gfx_handle<const gfx_semaphore> written;
+            //! \brief The \a hi_z_readback pointing to the mapped buffer.
+            hi_z_readback readback;
+        };
+
+        //! \brief The compute \a shader_stage reducing the depth input to the first level.
+        gfx_handle<const gfx_shader_stage> m_depth_reduction_compute;
+        //! \brief The compute \a shader_stage reducing a level to the next one.
+        gfx_handle<const gfx_shader_stage> m_level_reduction_compute;
+        //! \brief The compute \a shader_stage copying a level into a readback buffer.
+        gfx_handle<const gfx_shader_stage> m_readback_compute;
+
+        //! \brief Compute pipeline reducing the depth input to the first level.
+        gfx_handle<const gfx_pipeline> m_depth_reduction_pipeline;
+        //! \brief Compute pipeline reducing a level to the next one.
+        gfx_handle<const gfx_pipeline> m_level_reduction_pipeline;
+        //! \brief Compute pipeline copying a level into a readback buffer.
+        gfx_handle<const gfx_pipeline> m_readback_pipeline;
+
+        //! \brief The depth texture to build the pyramid from.
+        gfx_handle<const gfx_texture> m_depth_input;
+        //! \brief The \a gfx_sampler to sample the depth texture with.
+        gfx_handle<const gfx_sampler> m_depth_sampler;
+        //! \brief The depth textures width.
+        int32 m_input_width;
+        //! \brief The depth textures height.
+        int32 m_input_height;
+        //! \brief The view projection matrix the depth texture was rendered with.
+        mat4 m_view_projection;
+
+        //! \brief True if the pyramid has to be created for a new input size, else false.
+        bool m_pyramid_dirty;
+        //! \brief The hierarchical depth texture.
+        gfx_handle<const gfx_texture> m_hi_z_texture;
+        //! \brief The image views of all levels of the hierarchical depth texture.
+        std::vector<gfx_handle<const gfx_image_texture_view>> m_level_views;
+        //! \brief The level copied into the readback buffers.
+        int32 m_readback_level;
+
+        //! \brief The readback buffers used in turns.
+        readback_slot m_readback_slots[readback_slots];
+        //! \brief The readback slot written by the last execution, -1 if there was none.
+        int32 m_last_slot;
+    };
+} // namespace mango
+
+#endif // MANGO_HI_Z_PASS_HPP
@@ -23,32 +23,24 @@ namespace mango
         float view_depth;
         bool transparent;
         axis_aligned_bounding_box bounding_box; // Does not contribute to order.
+        //! \endcond
 
-        bool operator<(const draw_key& other) const
+        //! \brief Packs the sort relevant data into one 64 bit key, so draws can be radix sorted.
+        //! \details Bit layout from most to least significant: 1 bit transparency, 24 bits quantized view distance (near to far),
+        //! 16 bits material index and 23 bits primitive index. Ascending keys give the same order as the members.
+        //! \param[in] camera_near The near plane distance of the camera the depth is quantized for.
+        //! \param[in] camera_far The far plane distance of the camera the depth is quantized for.
+        //! \return The 64 bit sort key.
+        inline uint64 sort_key(float camera_near, float camera_far) const
         {
-            if (transparent < other.transparent)
-                return true;
-            if (other.transparent < transparent)
-                return false;
-
-            if (view_depth > other.view_depth)
-                return true;
-            if (other.view_depth > view_depth)
-                return false;
-
-            if (material_hnd < other.material_hnd)
-                return true;
-            if (other.material_hnd < material_hnd)
-                return false;
+            // view space looks along the negative z axis, so the view depth is negated to get the distance.
+            float t      = (-view_depth - camera_near) / std::max(camera_far - camera_near, 1e-5f);
+            t            = std::min(std::max(t, 0.0f), 1.0f);
+            uint64 depth = static_cast<uint64>(t * static_cast<float>(0xffffff));
 
-            if (primitive_gpu_data_id < other.primitive_gpu_data_id)
-                return true;
-            if (other.primitive_gpu_data_id < primitive_gpu_data_id)
-                return false;
-
-            return false;
+            return (static_cast<uint64>(transparent ? 1 : 0) << 63) | (depth << 39) | ((material_hnd.id_unchecked() & 0xffffull) << 23) |
+                   (primitive_gpu_data_id & 0x7fffffull);
         }
-        //! \endcond
     };
 
     //! \brief Information about \a pass draw calls and vertex count.
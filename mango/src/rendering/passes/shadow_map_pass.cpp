@@ -4,8 +4,11 @@
 //! \date      2022
 //! \copyright Apache License 2.0
 
+#include <algorithm>
 #include <mango/imgui_helper.hpp>
 #include <mango/profile.hpp>
+#include <memory/frame_arena.hpp>
+#include <numeric>
 #include <rendering/passes/shadow_map_pass.hpp>
 #include <rendering/renderer_bindings.hpp>
 #include <rendering/renderer_impl.hpp>
@@ -48,7 +51,8 @@ shadow_map_pass::~shadow_map_pass() {}
 bool shadow_map_pass::create_pass_resources()
 {
     PROFILE_ZONE;
-    auto& graphics_device = m_shared_context->get_graphics_device();
+    auto& graphics_device  = m_shared_context->get_graphics_device();
+    m_multi_draw_supported = graphics_device->supports_multi_draw_indirect();
     // buffers
     buffer_create_info buffer_info;
     buffer_info.buffer_target = gfx_buffer_target::buffer_target_uniform;
@@ -89,6 +93,22 @@ bool shadow_map_pass::create_pass_resources()
         if (!check_creation(m_shadow_pass_vertex.get(), "shadow pass vertex shader"))
             return false;
 
+        if (m_multi_draw_supported)
+        {
+            res_resource_desc.defines.push_back({ "MULTI_DRAW", "" });
+            source = internal_resources->acquire(res_resource_desc);
+
+            source_desc.source = source->source.c_str();
+            source_desc.size   = static_cast<int32>(source->source.size());
+
+            shader_info.shader_source = source_desc;
+            shader_info.resources[0]  = { gfx_shader_stage_type::shader_stage_vertex, MODEL_DATA_BUFFER_BINDING_POINT, "model_data", gfx_shader_resource_type::shader_resource_buffer_storage, 1 };
+
+            m_shadow_pass_multi_draw_vertex = graphics_device->create_shader_stage(shader_info);
+            if (!check_creation(m_shadow_pass_multi_draw_vertex.get(), "shadow pass multi draw vertex shader"))
+                return false;
+        }
+
         res_resource_desc.defines.clear();
     }
     // geometry stage
@@ -142,22 +162,24 @@ bool shadow_map_pass::create_pass_resources()
     }
     // Pass Pipeline Base
     {
-        auto shadow_pass_info            = graphics_device->provide_graphics_pipeline_create_info();
-        auto shadow_pass_pipeline_layout = graphics_device->create_pipeline_resource_layout({
-            { gfx_shader_stage_type::shader_stage_vertex, MODEL_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer,
-              gfx_shader_resource_access::shader_access_dynamic },
+        // model data is one uniform buffer per draw, or one shader storage buffer with all draws for multi draw indirect.
+        auto create_pipeline_layout = [&graphics_device](gfx_shader_resource_type model_data_type) {
+            return graphics_device->create_pipeline_resource_layout({
+                { gfx_shader_stage_type::shader_stage_vertex, MODEL_DATA_BUFFER_BINDING_POINT, model_data_type, gfx_shader_resource_access::shader_access_dynamic },
 
-            { gfx_shader_stage_type::shader_stage_geometry, SHADOW_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer,
-              gfx_shader_resource_access::shader_access_dynamic },
+                { gfx_shader_stage_type::shader_stage_geometry, SHADOW_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer,
+                  gfx_shader_resource_access::shader_access_dynamic },
 
-            { gfx_shader_stage_type::shader_stage_fragment, 0, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
-            { gfx_shader_stage_type::shader_stage_fragment, 0, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
+                { gfx_shader_stage_type::shader_stage_fragment, 0, gfx_shader_resource_type::shader_resource_input_attachment, gfx_shader_resource_access::shader_access_dynamic },
+                { gfx_shader_stage_type::shader_stage_fragment, 0, gfx_shader_resource_type::shader_resource_sampler, gfx_shader_resource_access::shader_access_dynamic },
 
-            { gfx_shader_stage_type::shader_stage_fragment, MATERIAL_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer,
-              gfx_shader_resource_access::shader_access_dynamic },
-        });
+                { gfx_shader_stage_type::shader_stage_fragment, MATERIAL_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer,
+                  gfx_shader_resource_access::shader_access_dynamic },
+            });
+        };
 
-        shadow_pass_info.pipeline_layout = shadow_pass_pipeline_layout;
+        auto shadow_pass_info            = graphics_device->provide_graphics_pipeline_create_info();
+        shadow_pass_info.pipeline_layout = create_pipeline_layout(gfx_shader_resource_type::shader_resource_constant_buffer);
 
         shadow_pass_info.shader_stage_descriptor.vertex_shader_stage   = m_shadow_pass_vertex;
         shadow_pass_info.shader_stage_descriptor.geometry_shader_stage = m_shadow_pass_geometry;
@@ -179,6 +201,15 @@ bool shadow_map_pass::create_pass_resources()
         shadow_pass_info.dynamic_state.dynamic_states = gfx_dynamic_state_flag_bits::dynamic_state_viewport | gfx_dynamic_state_flag_bits::dynamic_state_scissor;
 
         m_pipeline_cache->set_shadow_base(shadow_pass_info);
+
+        if (m_multi_draw_supported)
+        {
+            shadow_pass_info.pipeline_layout                             = create_pipeline_layout(gfx_shader_resource_type::shader_resource_buffer_storage);
+            shadow_pass_info.shader_stage_descriptor.vertex_shader_stage = m_shadow_pass_multi_draw_vertex;
+
+            m_pipeline_cache->set_shadow_multi_draw_base(shadow_pass_info);
+            m_batcher.create(graphics_device);
+        }
     }
 
     return true;
@@ -200,6 +231,13 @@ bool shadow_map_pass::create_shadow_map()
     if (!check_creation(m_shadow_map.get(), "shadow map texture"))
         return false;
 
+    // the static layers are created with the new resolution, when they are needed.
+    for (static_cascade& sc : m_static_cascades)
+    {
+        sc.shadow_map = nullptr;
+        sc.valid      = false;
+    }
+
     return true;
 }
 
@@ -212,143 +250,389 @@ void shadow_map_pass::attach(const shared_ptr<context_impl>& context)
 
 void shadow_map_pass::execute(graphics_device_context_handle& device_context)
 {
-    auto warn_missing_draw = [](string what) { MANGO_LOG_WARN("{0} missing for draw. Skipping DrawCall!", what); };
-
     m_rpei.draw_calls = 0;
     m_rpei.vertices   = 0;
 
     GL_NAMED_PROFILE_ZONE("Shadow Pass");
     NAMED_PROFILE_ZONE("Shadow Pass");
 
-    if (!m_debug_view_enabled && !m_shadow_casters.empty())
+    device_context->set_render_targets(0, nullptr, m_shadow_map);
+    if (m_debug_view_enabled || m_shadow_casters.empty())
+    {
+        device_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
+        return;
+    }
+
+    // The static layers hold the depth for one light only, with more shadow casters everything is drawn each frame.
+    const bool cache_static      = m_static_caching && m_shadow_casters.size() == 1;
+    const uint32 static_revision = m_scene->get_static_primitive_revision();
+    if (!cache_static || static_revision != m_static_primitive_revision)
+    {
+        for (static_cascade& sc : m_static_cascades)
+            sc.valid = false;
+        m_static_primitive_revision = static_revision;
+    }
+
+    // Cached static layers overwrite the shadow map, so it only has to be cleared without them.
+    if (!cache_static)
+        device_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
+
+    const bool multi_draw = m_multi_draw && m_multi_draw_supported;
+    for (auto& sc : m_shadow_casters)
     {
-        for (auto& sc : m_shadow_casters)
+        update_cascades(sc.direction, cache_static);
+
+        if (cache_static)
         {
-            update_cascades(sc.direction);
+            update_static_cascades(device_context);
             device_context->set_render_targets(0, nullptr, m_shadow_map);
+        }
 
+        if (multi_draw)
+            m_batcher.clear();
+
+        if (m_debug_bounds)
+        {
             for (int32 casc = 0; casc < m_shadow_data.shadow_cascade_count; ++casc)
             {
-                auto& cascade_frustum = m_cascade_data.frusta[casc];
+                auto corners = bounding_frustum::get_corners(m_shadow_data.shadow_view_projection_matrices[casc]);
+                m_debug_drawer->set_color(color_rgb(0.5f));
+                m_debug_drawer->add(corners[0], corners[1]);
+                m_debug_drawer->add(corners[1], corners[3]);
+                m_debug_drawer->add(corners[3], corners[2]);
+                m_debug_drawer->add(corners[2], corners[6]);
+                m_debug_drawer->add(corners[6], corners[4]);
+                m_debug_drawer->add(corners[4], corners[0]);
+                m_debug_drawer->add(corners[0], corners[2]);
+
+                m_debug_drawer->add(corners[5], corners[4]);
+                m_debug_drawer->add(corners[4], corners[6]);
+                m_debug_drawer->add(corners[6], corners[7]);
+                m_debug_drawer->add(corners[7], corners[3]);
+                m_debug_drawer->add(corners[3], corners[1]);
+                m_debug_drawer->add(corners[1], corners[5]);
+                m_debug_drawer->add(corners[5], corners[7]);
+            }
+        }
 
-                m_shadow_data.shadow_cascade = casc;
+        // dynamic casters are composited on top of the copied static layers.
+        const caster_selection selection = cache_static ? caster_selection::dynamic_casters : caster_selection::all_casters;
+        if (m_single_pass_cascades)
+        {
+            collect_casters(0, m_shadow_data.shadow_cascade_count, selection);
+            draw_casters(device_context, multi_draw);
+        }
+        else
+        {
+            for (int32 casc = 0; casc < m_shadow_data.shadow_cascade_count; ++casc)
+            {
+                collect_casters(casc, 1, selection);
+                draw_casters(device_context, multi_draw);
+            }
+        }
 
-                if (m_debug_bounds)
-                {
-                    auto corners = bounding_frustum::get_corners(m_shadow_data.shadow_view_projection_matrices[casc]);
-                    m_debug_drawer->set_color(color_rgb(0.5f));
-                    m_debug_drawer->add(corners[0], corners[1]);
-                    m_debug_drawer->add(corners[1], corners[3]);
-                    m_debug_drawer->add(corners[3], corners[2]);
-                    m_debug_drawer->add(corners[2], corners[6]);
-                    m_debug_drawer->add(corners[6], corners[4]);
-                    m_debug_drawer->add(corners[4], corners[0]);
-                    m_debug_drawer->add(corners[0], corners[2]);
-
-                    m_debug_drawer->add(corners[5], corners[4]);
-                    m_debug_drawer->add(corners[4], corners[6]);
-                    m_debug_drawer->add(corners[6], corners[7]);
-                    m_debug_drawer->add(corners[7], corners[3]);
-                    m_debug_drawer->add(corners[3], corners[1]);
-                    m_debug_drawer->add(corners[1], corners[5]);
-                    m_debug_drawer->add(corners[5], corners[7]);
-                }
+        if (multi_draw)
+            draw_batches(device_context);
+    }
+}
+
+void shadow_map_pass::update_static_cascades(graphics_device_context_handle& device_context)
+{
+    const bool multi_draw = m_multi_draw && m_multi_draw_supported;
+    for (int32 casc = 0; casc < m_shadow_data.shadow_cascade_count; ++casc)
+    {
+        static_cascade& sc = m_static_cascades[casc];
+        if (!sc.shadow_map)
+        {
+            auto& graphics_device = m_shared_context->get_graphics_device();
+
+            texture_create_info static_map_info;
+            static_map_info.texture_type   = gfx_texture_type::texture_type_2d;
+            static_map_info.width          = m_shadow_data.shadow_resolution;
+            static_map_info.height         = m_shadow_data.shadow_resolution;
+            static_map_info.miplevels      = 1;
+            static_map_info.array_layers   = 1;
+            static_map_info.texture_format = gfx_format::depth_component32;
+
+            sc.shadow_map = graphics_device->create_texture(static_map_info);
+            sc.valid      = false;
+            if (!check_creation(sc.shadow_map.get(), "static shadow map texture"))
+                return;
+        }
+
+        if (!sc.valid)
+        {
+            NAMED_PROFILE_ZONE("Static Shadow Cascade");
+            // the layer is not layered, so the geometry shader can route to any cascade.
+            device_context->set_render_targets(0, nullptr, sc.shadow_map);
+            device_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
+
+            if (multi_draw)
+                m_batcher.clear();
+            collect_casters(casc, 1, caster_selection::static_casters);
+            draw_casters(device_context, multi_draw);
+            if (multi_draw)
+                draw_batches(device_context);
+
+            sc.valid = true;
+        }
+
+        device_context->copy_texture(sc.shadow_map, 0, m_shadow_map, casc, 1);
+    }
+}
 
-                for (uint32 c = 0; c < m_draws->size(); ++c)
+void shadow_map_pass::collect_casters(int32 first_cascade, int32 cascade_count, caster_selection selection)
+{
+    const std::vector<primitive_instance>& instances = m_scene->get_primitive_instances();
+    const bounding_frustum* cascade_frusta           = &m_cascade_data.frusta[first_cascade];
+    const uint32 cascades                            = ((1u << cascade_count) - 1u) << first_cascade;
+
+    m_cascade_instances.clear();
+    m_cascade_masks.clear();
+    if (selection == caster_selection::dynamic_casters)
+    {
+        // Usually only few casters are dynamic, so testing them directly is cheaper than querying the scene hierarchy.
+        for (uint32 c : m_scene->get_dynamic_primitive_instances())
+        {
+            uint32 mask = cascades;
+            if (m_frustum_culling)
+            {
+                mask = 0;
+                for (int32 casc = 0; casc < cascade_count; ++casc)
                 {
-                    auto& dc = m_draws->operator[](c);
-
-                    if (m_frustum_culling)
-                    {
-                        auto& bb = dc.bounding_box;
-                        if (!cascade_frustum.intersects(bb))
-                            continue;
-                    }
-
-                    optional<primitive_gpu_data&> prim_gpu_data = m_scene->get_primitive_gpu_data(dc.primitive_gpu_data_id);
-                    if (!prim_gpu_data)
-                    {
-                        warn_missing_draw("Primitive gpu m_shadow_data");
-                        continue;
-                    }
-                    optional<mesh_gpu_data&> m_gpu_data = m_scene->get_mesh_gpu_data(dc.mesh_gpu_data_id);
-                    if (!m_gpu_data)
-                    {
-                        warn_missing_draw("Mesh gpu m_shadow_data");
-                        continue;
-                    }
-                    optional<material&> mat                   = m_scene->get_material(dc.material_hnd);
-                    optional<material_gpu_data&> mat_gpu_data = m_scene->get_material_gpu_data(mat->gpu_data);
-                    if (!mat || !mat_gpu_data)
-                    {
-                        warn_missing_draw("Material");
-                        continue;
-                    }
-
-                    gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache->get_shadow(prim_gpu_data->vertex_layout, prim_gpu_data->input_assembly, mat->double_sided);
-
-                    device_context->bind_pipeline(dc_pipeline);
-                    gfx_viewport shadow_viewport{ 0.0f, 0.0f, static_cast<float>(m_shadow_data.shadow_resolution), static_cast<float>(m_shadow_data.shadow_resolution) };
-                    device_context->set_viewport(0, 1, &shadow_viewport);
-
-                    device_context->set_buffer_data(m_shadow_data_buffer, 0, sizeof(shadow_data), &(m_shadow_data));
-                    dc_pipeline->get_resource_mapping()->set("shadow_data", m_shadow_data_buffer);
-
-                    dc_pipeline->get_resource_mapping()->set("model_data", m_gpu_data->model_data_buffer);
-
-                    if (mat_gpu_data->per_material_data.alpha_mode > 1)
-                        continue; // TODO Paul: Transparent shadows?!
-
-                    dc_pipeline->get_resource_mapping()->set("material_data", mat_gpu_data->material_data_buffer);
-
-                    if (mat_gpu_data->per_material_data.base_color_texture)
-                    {
-                        MANGO_ASSERT(mat->base_color_texture_gpu_data.has_value(), "Texture has no gpu m_shadow_data!");
-                        optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat->base_color_texture_gpu_data.value());
-                        if (!tex)
-                        {
-                            warn_missing_draw("Base Color Texture");
-                            continue;
-                        }
-                        dc_pipeline->get_resource_mapping()->set("texture_base_color", tex->graphics_texture);
-                        dc_pipeline->get_resource_mapping()->set("sampler_base_color", tex->graphics_sampler);
-                    }
-                    else
-                    {
-                        dc_pipeline->get_resource_mapping()->set("texture_base_color", m_default_texture_2D);
-                    }
-
-                    device_context->submit_pipeline_state_resources();
-
-                    device_context->set_index_buffer(prim_gpu_data->index_buffer_view.graphics_buffer, prim_gpu_data->index_type);
-
-                    std::vector<gfx_handle<const gfx_buffer>> vbs;
-                    vbs.reserve(prim_gpu_data->vertex_buffer_views.size());
-                    std::vector<int32> bindings;
-                    bindings.reserve(prim_gpu_data->vertex_buffer_views.size());
-                    std::vector<int32> offsets;
-                    offsets.reserve(prim_gpu_data->vertex_buffer_views.size());
-                    int32 idx = 0;
-                    for (auto vbv : prim_gpu_data->vertex_buffer_views)
-                    {
-                        vbs.push_back(vbv.graphics_buffer);
-                        bindings.push_back(idx++);
-                        offsets.push_back(vbv.offset);
-                    }
-
-                    device_context->set_vertex_buffers(static_cast<int32>(prim_gpu_data->vertex_buffer_views.size()), vbs.data(), bindings.data(), offsets.data());
-
-                    m_rpei.draw_calls++;
-                    m_rpei.vertices += std::max(prim_gpu_data->draw_call_desc.vertex_count, prim_gpu_data->draw_call_desc.index_count);
-                    device_context->draw(prim_gpu_data->draw_call_desc.vertex_count, prim_gpu_data->draw_call_desc.index_count, prim_gpu_data->draw_call_desc.instance_count,
-                                         prim_gpu_data->draw_call_desc.base_vertex, prim_gpu_data->draw_call_desc.base_instance, prim_gpu_data->draw_call_desc.index_offset);
+                    if (cascade_frusta[casc].intersects(instances[c].bounding_box))
+                        mask |= 1u << (first_cascade + casc);
                 }
             }
+            if (mask == 0)
+                continue;
+            m_cascade_instances.push_back(c);
+            m_cascade_masks.push_back(mask);
+        }
+        return;
+    }
+
+    // Casters outside of the camera frustum still cast shadows, so the cascades query the scene hierarchy themselves.
+    if (m_frustum_culling)
+    {
+        m_scene->get_primitive_bvh().query(cascade_frusta, cascade_count, m_cascade_instances, m_cascade_masks);
+        for (uint32& mask : m_cascade_masks)
+            mask <<= first_cascade;
+    }
+    else
+    {
+        m_cascade_instances.resize(instances.size());
+        std::iota(m_cascade_instances.begin(), m_cascade_instances.end(), 0u);
+        m_cascade_masks.assign(instances.size(), cascades);
+    }
+
+    if (selection == caster_selection::static_casters)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < m_cascade_instances.size(); ++i)
+        {
+            if (instances[m_cascade_instances[i]].dynamic)
+                continue;
+            m_cascade_instances[count] = m_cascade_instances[i];
+            m_cascade_masks[count]     = m_cascade_masks[i];
+            ++count;
+        }
+        m_cascade_instances.resize(count);
+        m_cascade_masks.resize(count);
+    }
+}
+
+void shadow_map_pass::draw_casters(graphics_device_context_handle& device_context, bool multi_draw)
+{
+    auto warn_missing_draw = [](string what) { MANGO_LOG_WARN("{0} missing for draw. Skipping DrawCall!", what); };
+
+    const uniform_ring_buffer& model_ring            = m_scene->get_model_data_ring();
+    const std::vector<primitive_instance>& instances = m_scene->get_primitive_instances();
+
+    // the batcher groups by mask itself, single draws are sorted, so the shadow data only changes once per distinct mask.
+    m_draw_order.resize(m_cascade_instances.size());
+    std::iota(m_draw_order.begin(), m_draw_order.end(), 0u);
+    if (!multi_draw)
+    {
+        std::sort(m_draw_order.begin(), m_draw_order.end(), [this](uint32 a, uint32 b) { return m_cascade_masks[a] < m_cascade_masks[b] || (m_cascade_masks[a] == m_cascade_masks[b] && a < b); });
+    }
+    uint32 uploaded_mask = 0;
+
+    for (uint32 i : m_draw_order)
+    {
+        const primitive_instance& dc = instances[m_cascade_instances[i]];
+        const uint32 cascade_mask    = m_cascade_masks[i];
+
+        optional<primitive&> prim = m_scene->get_primitive(dc.primitive_hnd);
+        if (!prim)
+        {
+            warn_missing_draw("Primitive");
+            continue;
+        }
+        optional<primitive_gpu_data&> prim_gpu_data = m_scene->get_primitive_gpu_data(prim->gpu_data);
+        if (!prim_gpu_data)
+        {
+            warn_missing_draw("Primitive gpu m_shadow_data");
+            continue;
+        }
+        optional<mesh_gpu_data&> m_gpu_data = m_scene->get_mesh_gpu_data(dc.mesh_gpu_data_id);
+        if (!m_gpu_data)
+        {
+            warn_missing_draw("Mesh gpu m_shadow_data");
+            continue;
+        }
+        optional<const material&> mat             = m_scene->read_material(prim->primitive_material);
+        optional<material_gpu_data&> mat_gpu_data = m_scene->get_material_gpu_data(mat->gpu_data);
+        if (!mat || !mat_gpu_data)
+        {
+            warn_missing_draw("Material");
+            continue;
+        }
+
+        if (multi_draw)
+        {
+            if (mat_gpu_data->per_material_data.alpha_mode > 1)
+                continue; // TODO Paul: Transparent shadows?!
+
+            // opaque materials do not discard, so they are all drawn the same and batched together.
+            gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache->get_shadow(prim_gpu_data->vertex_layout, prim_gpu_data->input_assembly, mat->double_sided, true);
+            m_batcher.add(static_cast<int32>(cascade_mask), dc_pipeline, prim_gpu_data.value(), m_gpu_data->per_mesh_data, mat.value(), mat_gpu_data.value(),
+                          mat_gpu_data->per_material_data.alpha_mode != 0);
+            continue;
+        }
+
+        gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache->get_shadow(prim_gpu_data->vertex_layout, prim_gpu_data->input_assembly, mat->double_sided, false);
+
+        device_context->bind_pipeline(dc_pipeline);
+        if (!m_slots.resolved)
+            resolve_resource_slots(dc_pipeline->get_resource_mapping(), m_slots);
+        gfx_viewport shadow_viewport{ 0.0f, 0.0f, static_cast<float>(m_shadow_data.shadow_resolution), static_cast<float>(m_shadow_data.shadow_resolution) };
+        device_context->set_viewport(0, 1, &shadow_viewport);
+
+        if (mat_gpu_data->per_material_data.alpha_mode > 1)
+            continue; // TODO Paul: Transparent shadows?!
+
+        // the geometry shader draws the caster into all cascades of the mask at once.
+        if (cascade_mask != uploaded_mask)
+        {
+            m_shadow_data.shadow_cascade_mask = static_cast<int32>(cascade_mask);
+            device_context->set_buffer_data(m_shadow_data_buffer, 0, sizeof(shadow_data), &(m_shadow_data));
+            uploaded_mask = cascade_mask;
         }
+        device_context->set_shader_resource(m_slots.shadow_data, m_shadow_data_buffer);
+
+        device_context->set_shader_resource_buffer_range(m_slots.model_data, model_ring.get_buffer(), model_ring.offset(m_gpu_data->model_data_index), model_ring.element_size());
+
+        if (!bind_material(device_context, m_slots, mat.value(), mat_gpu_data.value()))
+            continue;
+
+        device_context->submit_pipeline_state_resources();
+
+        bind_geometry(device_context, prim_gpu_data.value());
+
+        m_rpei.draw_calls++;
+        m_rpei.vertices += std::max(prim_gpu_data->draw_call_desc.vertex_count, prim_gpu_data->draw_call_desc.index_count);
+        device_context->draw(prim_gpu_data->draw_call_desc.vertex_count, prim_gpu_data->draw_call_desc.index_count, prim_gpu_data->draw_call_desc.instance_count,
+                             prim_gpu_data->draw_call_desc.base_vertex, prim_gpu_data->draw_call_desc.base_instance, prim_gpu_data->draw_call_desc.index_offset);
     }
 }
 
-void shadow_map_pass::update_cascades(const vec3& directional_light_direction)
+void shadow_map_pass::draw_batches(graphics_device_context_handle& device_context)
+{
+    m_batcher.build();
+    if (!m_batcher.upload(device_context))
+        return;
+
+    int32 cascade_mask = 0;
+    for (const multi_draw_batcher::batch& b : m_batcher.get_batches())
+    {
+        device_context->bind_pipeline(b.pipeline);
+        if (!m_multi_draw_slots.resolved)
+            resolve_resource_slots(b.pipeline->get_resource_mapping(), m_multi_draw_slots);
+        gfx_viewport shadow_viewport{ 0.0f, 0.0f, static_cast<float>(m_shadow_data.shadow_resolution), static_cast<float>(m_shadow_data.shadow_resolution) };
+        device_context->set_viewport(0, 1, &shadow_viewport);
+
+        // batches are grouped and ordered by cascade mask, so the shadow data changes only once per mask.
+        if (b.group != cascade_mask)
+        {
+            cascade_mask                      = b.group;
+            m_shadow_data.shadow_cascade_mask = cascade_mask;
+            device_context->set_buffer_data(m_shadow_data_buffer, 0, sizeof(shadow_data), &(m_shadow_data));
+        }
+        device_context->set_shader_resource(m_multi_draw_slots.shadow_data, m_shadow_data_buffer);
+        device_context->set_shader_resource(m_multi_draw_slots.model_data, m_batcher.get_model_data_buffer());
+
+        if (!bind_material(device_context, m_multi_draw_slots, *b.mat, *b.mat_gpu_data))
+            continue;
+
+        device_context->submit_pipeline_state_resources();
+
+        bind_geometry(device_context, *b.geometry);
+
+        m_rpei.draw_calls++;
+        m_rpei.vertices += b.vertex_count;
+        if (b.first_command < 0)
+        {
+            const draw_call_description& dcd = b.geometry->draw_call_desc;
+            device_context->draw(dcd.vertex_count, dcd.index_count, dcd.instance_count, dcd.base_vertex, b.first_entry, dcd.index_offset);
+        }
+        else
+        {
+            device_context->draw_indexed_indirect(m_batcher.get_command_buffer(), b.first_command * static_cast<int32>(sizeof(draw_indexed_indirect_command)), b.draw_count,
+                                                  static_cast<int32>(sizeof(draw_indexed_indirect_command)));
+        }
+    }
+}
+
+bool shadow_map_pass::bind_material(graphics_device_context_handle& device_context, const resource_slots& slots, const material& mat, const material_gpu_data& mat_gpu_data)
+{
+    const uniform_ring_buffer& material_ring = m_scene->get_material_data_ring();
+    device_context->set_shader_resource_buffer_range(slots.material_data, material_ring.get_buffer(), material_ring.offset(mat_gpu_data.material_data_index), material_ring.element_size());
+
+    if (mat_gpu_data.per_material_data.base_color_texture)
+    {
+        MANGO_ASSERT(mat.base_color_texture_gpu_data.has_value(), "Texture has no gpu m_shadow_data!");
+        optional<texture_gpu_data&> tex = m_scene->get_texture_gpu_data(mat.base_color_texture_gpu_data.value());
+        if (!tex)
+        {
+            MANGO_LOG_WARN("Base Color Texture missing for draw. Skipping DrawCall!");
+            return false;
+        }
+        device_context->set_shader_resource(slots.texture_base_color, tex->graphics_texture);
+        device_context->set_shader_resource(slots.sampler_base_color, tex->graphics_sampler);
+    }
+    else
+    {
+        device_context->set_shader_resource(slots.texture_base_color, m_default_texture_2D);
+    }
+
+    return true;
+}
+
+void shadow_map_pass::bind_geometry(graphics_device_context_handle& device_context, const primitive_gpu_data& prim_gpu_data)
+{
+    frame_arena& arena = *m_shared_context->get_frame_arena();
+
+    device_context->set_index_buffer(prim_gpu_data.index_buffer_view.graphics_buffer, prim_gpu_data.index_type);
+
+    frame_vector<gfx_handle<const gfx_buffer>> vbs(arena);
+    vbs.reserve(prim_gpu_data.vertex_buffer_views.size());
+    frame_vector<int32> bindings(arena);
+    bindings.reserve(prim_gpu_data.vertex_buffer_views.size());
+    frame_vector<int32> offsets(arena);
+    offsets.reserve(prim_gpu_data.vertex_buffer_views.size());
+    int32 idx = 0;
+    for (const auto& vbv : prim_gpu_data.vertex_buffer_views)
+    {
+        vbs.push_back(vbv.graphics_buffer);
+        bindings.push_back(idx++);
+        offsets.push_back(vbv.offset);
+    }
+
+    device_context->set_vertex_buffers(static_cast<int32>(prim_gpu_data.vertex_buffer_views.size()), vbs.data(), bindings.data(), offsets.data());
+}
+
+void shadow_map_pass::update_cascades(const vec3& directional_light_direction, bool cache_static)
 {
     // Update only with 30 fps
     static float fps_lock = 0.0f;
@@ -421,6 +705,31 @@ void shadow_map_pass::update_cascades(const vec3& directional_light_direction)
         }
         radius = std::ceil(radius * 16.0f) / 16.0f;
 
+        m_shadow_data.shadow_split_depth[casc] = (clip_near + split_dist * clip_range);
+
+        if (cache_static)
+        {
+            // A static layer keeps its texel snapped projection, until the cascade leaves the margin around it.
+            static_cascade& sc = m_static_cascades[casc];
+            if (sc.valid && sc.radius == radius && sc.offset == m_shadow_map_offset && sc.light_direction == directional_light_direction)
+            {
+                vec3 moved = sc.light_rotation * (center - sc.center);
+                if (moved.cwiseAbs().maxCoeff() <= sc.margin)
+                    continue;
+            }
+
+            // the cascade is extended by the margin on each side, so the texel size stays the same for the whole shadow map.
+            float resolution   = static_cast<float>(m_shadow_data.shadow_resolution);
+            float extended     = radius * resolution / (resolution - 2.0f * static_cast<float>(m_static_cache_margin));
+            sc.valid           = false;
+            sc.center          = center;
+            sc.radius          = radius;
+            sc.margin          = extended - radius;
+            sc.offset          = m_shadow_map_offset;
+            sc.light_direction = directional_light_direction;
+            radius             = extended;
+        }
+
         vec3 max_extends = make_vec3(radius);
         vec3 min_extends = -max_extends;
 
@@ -452,9 +761,9 @@ void shadow_map_pass::update_cascades(const vec3& directional_light_direction)
         offset.w() = 0.0f;
         projection.col(3) += offset;
 
-        m_shadow_data.shadow_split_depth[casc]              = (clip_near + split_dist * clip_range);
         m_shadow_data.shadow_view_projection_matrices[casc] = projection * view;
         m_cascade_data.frusta[casc]                         = bounding_frustum(view, projection);
+        m_static_cascades[casc].light_rotation              = view.block<3, 3>(0, 0);
     }
 }
 
@@ -470,6 +779,26 @@ void shadow_map_pass::on_ui_widget()
     if (m_shadow_data.shadow_resolution != r)
         create_shadow_map();
 
+    checkbox("Single Pass Cascades", &m_single_pass_cascades, true);
+    checkbox("Cache Static Casters", &m_static_caching, true);
+    if (m_static_caching)
+    {
+        int32 margin            = m_static_cache_margin;
+        int32 default_margin[1] = { 32 };
+        slider_int_n("Cache Margin (px)", &margin, 1, default_margin, 0, 128);
+        if (margin != m_static_cache_margin)
+        {
+            m_static_cache_margin = margin;
+            for (static_cascade& sc : m_static_cascades)
+                sc.valid = false;
+        }
+    }
+    else
+    {
+        for (static_cascade& sc : m_static_cascades)
+            sc.shadow_map = nullptr;
+    }
+
     // Filter Type
     const char* filter[3] = { "Hard Shadows", "Soft Shadows", "PCCF Shadows" };
     int32& current_filter = m_shadow_data.shadow_filter_mode;
@@ -515,3 +844,13 @@ void shadow_map_pass::on_ui_widget()
     slider_float_n("Cascade Splits Lambda", &m_cascade_data.lambda, 1, default_value, 0.0f, 1.0f);
     ImGui::PopID();
 }
+
+void shadow_map_pass::resolve_resource_slots(const gfx_handle<shader_resource_mapping>& mapping, resource_slots& slots)
+{
+    slots.shadow_data        = mapping->get_slot("shadow_data");
+    slots.model_data         = mapping->get_slot("model_data");
+    slots.material_data      = mapping->get_slot("material_data");
+    slots.texture_base_color = mapping->get_slot("texture_base_color");
+    slots.sampler_base_color = mapping->get_slot("sampler_base_color");
+    slots.resolved           = true;
+}
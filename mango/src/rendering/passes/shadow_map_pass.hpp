@@ -9,6 +9,7 @@
 
 #include <graphics/graphics.hpp>
 #include <rendering/debug_drawer.hpp>
+#include <rendering/multi_draw_batcher.hpp>
 #include <rendering/passes/render_pass.hpp>
 #include <rendering/renderer_pipeline_cache.hpp>
 #include <mango/intersect.hpp>
@@ -90,6 +91,14 @@ namespace mango
             m_wireframe = wireframe;
         }
 
+        //! \brief Set multi draw indirect submission.
+        //! \details Only used, if the \a graphics_device supports multi draw indirect.
+        //! \param[in] multi_draw True if draws should be batched and submitted with multi draw indirect, else false.
+        inline void set_multi_draw(bool multi_draw)
+        {
+            m_multi_draw = multi_draw;
+        }
+
         //! \brief Set debug view status.
         //! \param[in] debug_view_enabled True if debug view is enabled, else false.
         inline void set_debug_view_enabled(bool debug_view_enabled)
@@ -146,27 +155,81 @@ namespace mango
             m_shadow_casters = shadow_casters;
         }
 
-        //! \brief Set draws.
-        //! \param[in] draws The list of \a draw_keys.
-        inline void set_draws(const shared_ptr<std::vector<draw_key>>& draws)
-        {
-            m_draws = draws;
-        }
-
       private:
         //! \brief Execution info of this pass.
         render_pass_execution_info m_rpei;
 
         bool create_pass_resources() override;
 
+        //! \brief The shader resource slots of the shadow \a gfx_pipelines.
+        struct resource_slots
+        {
+            //! \cond NO_COND
+            bool resolved = false;
+            shader_resource_mapping::resource_slot shadow_data;
+            shader_resource_mapping::resource_slot model_data;
+            shader_resource_mapping::resource_slot material_data;
+            shader_resource_mapping::resource_slot texture_base_color;
+            shader_resource_mapping::resource_slot sampler_base_color;
+            //! \endcond
+        };
+
+        //! \brief The casters drawn into a cascade.
+        enum class caster_selection : uint8
+        {
+            all_casters,     //!< Static and dynamic casters.
+            static_casters,  //!< Only casters classified as static by the \a scene_impl.
+            dynamic_casters  //!< Only casters classified as dynamic by the \a scene_impl.
+        };
+
+        //! \brief Collects the casters of a range of cascades into \a m_cascade_instances and their cascade masks into \a m_cascade_masks.
+        //! \details All cascades of the range are culled in one pass over the casters.
+        //! \param[in] first_cascade The index of the first cascade.
+        //! \param[in] cascade_count The number of cascades.
+        //! \param[in] selection The \a caster_selection to collect.
+        void collect_casters(int32 first_cascade, int32 cascade_count, caster_selection selection);
+
+        //! \brief Draws the casters in \a m_cascade_instances once into all cascades of their mask, or adds them to the \a multi_draw_batcher.
+        //! \param[in] device_context The \a graphics_device_context to record to.
+        //! \param[in] multi_draw True if the draws should be added to the \a multi_draw_batcher, else false.
+        void draw_casters(graphics_device_context_handle& device_context, bool multi_draw);
+
+        //! \brief Re-renders the static layers not valid any longer and copies all of them into the shadow map.
+        //! \param[in] device_context The \a graphics_device_context to record to.
+        void update_static_cascades(graphics_device_context_handle& device_context);
+
+        //! \brief Resolves the shader resource slots of the shadow \a gfx_pipelines.
+        //! \param[in] mapping The \a shader_resource_mapping of one of the shadow \a gfx_pipelines.
+        //! \param[out] slots The \a resource_slots to fill.
+        void resolve_resource_slots(const gfx_handle<shader_resource_mapping>& mapping, resource_slots& slots);
+
+        //! \brief Builds, uploads and draws the batches of all cascades of the current shadow caster.
+        //! \param[in] device_context The \a graphics_device_context to record to.
+        void draw_batches(graphics_device_context_handle& device_context);
+
+        //! \brief Sets the material data and the base color texture of a draw.
+        //! \param[in] device_context The \a graphics_device_context to record to.
+        //! \param[in] slots The resolved \a resource_slots of the bound \a gfx_pipeline.
+        //! \param[in] mat The \a material to set.
+        //! \param[in] mat_gpu_data The \a material_gpu_data of the material.
+        //! \return True on success, false if a texture is missing.
+        bool bind_material(graphics_device_context_handle& device_context, const resource_slots& slots, const material& mat, const material_gpu_data& mat_gpu_data);
+
+        //! \brief Sets the vertex and index buffers of a draw.
+        //! \param[in] device_context The \a graphics_device_context to record to.
+        //! \param[in] prim_gpu_data The \a primitive_gpu_data to draw.
+        void bind_geometry(graphics_device_context_handle& device_context, const primitive_gpu_data& prim_gpu_data);
+
         //! \brief Creates the shadow map.
         //! \return True on success, else false.
         bool create_shadow_map();
 
         //! \brief Updates the cascades for CSM.
         //! \details Calculates the camera frustum, the cascade split depths and the view projection matrices for a given directional light.
+        //! Cascades with a valid static layer keep their projection, until the camera moves out of the margin around them.
         //! \param[in] directional_light_direction The direction to the light.
-        void update_cascades(const vec3& directional_light_direction);
+        //! \param[in] cache_static True if the static casters are cached, else false.
+        void update_cascades(const vec3& directional_light_direction, bool cache_static);
 
         //! \brief The \a shadow_settings for the pass.
         shadow_settings m_settings;
@@ -179,6 +242,8 @@ namespace mango
         gfx_handle<const gfx_sampler> m_shadow_map_sampler;
         //! \brief The vertex \a shader_stage for the shadow map pass.
         gfx_handle<const gfx_shader_stage> m_shadow_pass_vertex;
+        //! \brief The vertex \a shader_stage for the shadow map pass drawing with multi draw indirect.
+        gfx_handle<const gfx_shader_stage> m_shadow_pass_multi_draw_vertex;
         //! \brief The geometry \a shader_stage for the shadow map pass.
         gfx_handle<const gfx_shader_stage> m_shadow_pass_geometry;
         //! \brief The fragment \a shader_stage for the shadow map pass.
@@ -226,8 +291,50 @@ namespace mango
         //! \brief The default 2d \a gfx_texture.
         gfx_handle<const gfx_texture> m_default_texture_2D;
 
-        //! \brief The list of \a draw_keys.
-        shared_ptr<std::vector<draw_key>> m_draws;
+        //! \brief True if multi draw indirect submission is enabled, else false.
+        bool m_multi_draw = false;
+        //! \brief True if the \a graphics_device supports multi draw indirect, else false.
+        bool m_multi_draw_supported = false;
+        //! \brief The \a multi_draw_batcher batching the draws of all cascades for multi draw indirect.
+        multi_draw_batcher m_batcher;
+
+        //! \brief The pre-resolved shader resource slots of the shadow \a gfx_pipelines.
+        //! \details All of them are created with the same layout and shader stages, so the slots are resolved once with the first one.
+        resource_slots m_slots;
+        //! \brief The pre-resolved shader resource slots of the shadow \a gfx_pipelines drawing with multi draw indirect.
+        resource_slots m_multi_draw_slots;
+
+        //! \brief The indices of the scenes \a primitive_instances rendered into the current cascades.
+        std::vector<uint32> m_cascade_instances;
+        //! \brief The masks of the cascades each of the \a m_cascade_instances is rendered into.
+        std::vector<uint32> m_cascade_masks;
+        //! \brief The order the \a m_cascade_instances are drawn in, grouped by their cascade mask.
+        std::vector<uint32> m_draw_order;
+        //! \brief True if all cascades are culled together and every caster is drawn once into all its cascades, else false.
+        bool m_single_pass_cascades = true;
+
+        //! \brief The cached depth of the static casters of one cascade.
+        struct static_cascade
+        {
+            gfx_handle<const gfx_texture> shadow_map; //!< The 2d depth texture holding the static casters.
+            bool valid = false;                       //!< True if the shadow map holds the static casters for the current projection, else false.
+            vec3 center;                              //!< The center of the cascade the projection was calculated for.
+            float radius;                             //!< The radius of the cascade the projection was calculated for, without the margin.
+            float margin;                             //!< The margin around the cascade in world units, the cascade can move inside.
+            float offset;                             //!< The shadow map offset the projection was calculated for.
+            vec3 light_direction;                     //!< The direction to the light the projection was calculated for.
+            mat3 light_rotation;                      //!< The rotation of the light view the projection was calculated for.
+        };
+
+        //! \brief The cached static layers of all cascades.
+        static_cascade m_static_cascades[max_shadow_mapping_cascades];
+        //! \brief True if static casters are cached, else false.
+        bool m_static_caching = true;
+        //! \brief The margin in texels added around cached cascades.
+        //! \details The camera can move this many texels, before a static layer has to be re-rendered.
+        int32 m_static_cache_margin = 32;
+        //! \brief The revision of the static \a primitive_instances the static layers were rendered with.
+        uint32 m_static_primitive_revision = 0;
 
         //! \brief The offset for the projection.
         float m_shadow_map_offset = 0.0f; // TODO Paul: This can probably be done better.
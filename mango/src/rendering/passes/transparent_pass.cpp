@@ -5,6 +5,7 @@
 //! \copyright Apache License 2.0
 
 #include <mango/profile.hpp>
+#include <memory/frame_arena.hpp>
 #include <rendering/passes/transparent_pass.hpp>
 #include <rendering/renderer_bindings.hpp>
 #include <resources/resources_impl.hpp>
@@ -39,16 +40,13 @@ void transparent_pass::execute(graphics_device_context_handle& device_context)
     GL_NAMED_PROFILE_ZONE("Transparent Pass");
     NAMED_PROFILE_ZONE("Transparent Pass");
     device_context->set_render_targets(static_cast<int32>(m_render_targets.size()) - 1, m_render_targets.data(), m_render_targets.back());
-    for (int32 c = m_transparent_start; c < m_draws->size(); ++c)
+    const uniform_ring_buffer& model_ring    = m_scene->get_model_data_ring();
+    const uniform_ring_buffer& material_ring = m_scene->get_material_data_ring();
+    frame_arena& arena                       = *m_shared_context->get_frame_arena();
+    for (int32 c = m_transparent_start; c < m_draw_count; ++c)
     {
-        auto& dc = m_draws->operator[](c);
+        const draw_key& dc = m_draws[c];
 
-        if (m_frustum_culling)
-        {
-            auto& bb = dc.bounding_box;
-            if (!m_camera_frustum.intersects(bb))
-                continue;
-        }
         if (m_debug_bounds)
         {
             auto& bb     = dc.bounding_box;
@@ -83,7 +81,7 @@ void transparent_pass::execute(graphics_device_context_handle& device_context)
             warn_missing_draw("Mesh gpu data");
             continue;
         }
-        optional<material&> mat                   = m_scene->get_material(dc.material_hnd);
+        optional<const material&> mat             = m_scene->read_material(dc.material_hnd);
         optional<material_gpu_data&> mat_gpu_data = m_scene->get_material_gpu_data(mat->gpu_data);
         if (!mat || !mat_gpu_data)
         {
@@ -94,13 +92,16 @@ void transparent_pass::execute(graphics_device_context_handle& device_context)
         gfx_handle<const gfx_pipeline> dc_pipeline = m_pipeline_cache->get_transparent(prim_gpu_data->vertex_layout, prim_gpu_data->input_assembly, m_wireframe, mat->double_sided);
 
         device_context->bind_pipeline(dc_pipeline);
+        auto mapping = dc_pipeline->get_resource_mapping();
+        if (!m_slots.resolved)
+            resolve_resource_slots(mapping);
         device_context->set_viewport(0, 1, &m_viewport);
 
-        dc_pipeline->get_resource_mapping()->set("model_data", m_gpu_data->model_data_buffer);
-        dc_pipeline->get_resource_mapping()->set("camera_data", m_camera_data_buffer);
-        dc_pipeline->get_resource_mapping()->set("light_data", m_light_data_buffer);
-        dc_pipeline->get_resource_mapping()->set("renderer_data", m_renderer_data_buffer);
-        dc_pipeline->get_resource_mapping()->set("material_data", mat_gpu_data->material_data_buffer);
+        mapping->set_buffer_range(m_slots.model_data, model_ring.get_buffer(), model_ring.offset(m_gpu_data->model_data_index), model_ring.element_size());
+        mapping->set(m_slots.camera_data, m_camera_data_buffer);
+        mapping->set(m_slots.light_data, m_light_data_buffer);
+        mapping->set(m_slots.renderer_data, m_renderer_data_buffer);
+        mapping->set_buffer_range(m_slots.material_data, material_ring.get_buffer(), material_ring.offset(mat_gpu_data->material_data_index), material_ring.element_size());
 
         if (mat_gpu_data->per_material_data.base_color_texture)
         {
@@ -111,12 +112,12 @@ void transparent_pass::execute(graphics_device_context_handle& device_context)
                 warn_missing_draw("Base Color Texture");
                 continue;
             }
-            dc_pipeline->get_resource_mapping()->set("texture_base_color", tex->graphics_texture);
-            dc_pipeline->get_resource_mapping()->set("sampler_base_color", tex->graphics_sampler);
+            mapping->set(m_slots.texture_base_color, tex->graphics_texture);
+            mapping->set(m_slots.sampler_base_color, tex->graphics_sampler);
         }
         else
         {
-            dc_pipeline->get_resource_mapping()->set("texture_base_color", m_default_texture_2D);
+            mapping->set(m_slots.texture_base_color, m_default_texture_2D);
         }
         if (mat_gpu_data->per_material_data.roughness_metallic_texture)
         {
@@ -127,12 +128,12 @@ void transparent_pass::execute(graphics_device_context_handle& device_context)
                 warn_missing_draw("Roughness Metallic Texture");
                 continue;
             }
-            dc_pipeline->get_resource_mapping()->set("texture_roughness_metallic", tex->graphics_texture);
-            dc_pipeline->get_resource_mapping()->set("sampler_roughness_metallic", tex->graphics_sampler);
+            mapping->set(m_slots.texture_roughness_metallic, tex->graphics_texture);
+            mapping->set(m_slots.sampler_roughness_metallic, tex->graphics_sampler);
         }
         else
         {
-            dc_pipeline->get_resource_mapping()->set("texture_roughness_metallic", m_default_texture_2D);
+            mapping->set(m_slots.texture_roughness_metallic, m_default_texture_2D);
         }
         if (mat_gpu_data->per_material_data.occlusion_texture)
         {
@@ -143,12 +144,12 @@ void transparent_pass::execute(graphics_device_context_handle& device_context)
                 warn_missing_draw("Occlusion Texture");
                 continue;
             }
-            dc_pipeline->get_resource_mapping()->set("texture_occlusion", tex->graphics_texture);
-            dc_pipeline->get_resource_mapping()->set("sampler_occlusion", tex->graphics_sampler);
+            mapping->set(m_slots.texture_occlusion, tex->graphics_texture);
+            mapping->set(m_slots.sampler_occlusion, tex->graphics_sampler);
         }
         else
         {
-            dc_pipeline->get_resource_mapping()->set("texture_occlusion", m_default_texture_2D);
+            mapping->set(m_slots.texture_occlusion, m_default_texture_2D);
         }
         if (mat_gpu_data->per_material_data.normal_texture)
         {
@@ -159,12 +160,12 @@ void transparent_pass::execute(graphics_device_context_handle& device_context)
                 warn_missing_draw("Normal Texture");
                 continue;
             }
-            dc_pipeline->get_resource_mapping()->set("texture_normal", tex->graphics_texture);
-            dc_pipeline->get_resource_mapping()->set("sampler_normal", tex->graphics_sampler);
+            mapping->set(m_slots.texture_normal, tex->graphics_texture);
+            mapping->set(m_slots.sampler_normal, tex->graphics_sampler);
         }
         else
         {
-            dc_pipeline->get_resource_mapping()->set("texture_normal", m_default_texture_2D);
+            mapping->set(m_slots.texture_normal, m_default_texture_2D);
         }
         if (mat_gpu_data->per_material_data.emissive_color_texture)
         {
@@ -175,38 +176,45 @@ void transparent_pass::execute(graphics_device_context_handle& device_context)
                 warn_missing_draw("Emissive Color Texture");
                 continue;
             }
-            dc_pipeline->get_resource_mapping()->set("texture_emissive_color", tex->graphics_texture);
-            dc_pipeline->get_resource_mapping()->set("sampler_emissive_color", tex->graphics_sampler);
+            mapping->set(m_slots.texture_emissive_color, tex->graphics_texture);
+            mapping->set(m_slots.sampler_emissive_color, tex->graphics_sampler);
         }
         else
         {
-            dc_pipeline->get_resource_mapping()->set("texture_emissive_color", m_default_texture_2D);
+            mapping->set(m_slots.texture_emissive_color, m_default_texture_2D);
         }
 
-        dc_pipeline->get_resource_mapping()->set("texture_irradiance_map", m_irradiance_map);
-        dc_pipeline->get_resource_mapping()->set("sampler_irradiance_map", m_irradiance_map_sampler);
-        dc_pipeline->get_resource_mapping()->set("texture_radiance_map", m_radiance_map);
-        dc_pipeline->get_resource_mapping()->set("sampler_radiance_map", m_radiance_map_sampler);
-        dc_pipeline->get_resource_mapping()->set("texture_brdf_integration_lut", m_brdf_integration_lut);
-        dc_pipeline->get_resource_mapping()->set("sampler_brdf_integration_lut", m_brdf_integration_lut_sampler);
-
-        dc_pipeline->get_resource_mapping()->set("texture_shadow_map_comp", m_shadow_map);
-        dc_pipeline->get_resource_mapping()->set("texture_shadow_map", m_shadow_map);
-        dc_pipeline->get_resource_mapping()->set("sampler_shadow_shadow_map", m_shadow_map_compare_sampler);
-        dc_pipeline->get_resource_mapping()->set("sampler_shadow_map", m_shadow_map_sampler);
+        mapping->set(m_slots.texture_irradiance_map, m_irradiance_map);
+        mapping->set(m_slots.sampler_irradiance_map, m_irradiance_map_sampler);
+        mapping->set(m_slots.texture_radiance_map, m_radiance_map);
+        mapping->set(m_slots.sampler_radiance_map, m_radiance_map_sampler);
+        mapping->set(m_slots.texture_brdf_integration_lut, m_brdf_integration_lut);
+        mapping->set(m_slots.sampler_brdf_integration_lut, m_brdf_integration_lut_sampler);
+
+        mapping->set(m_slots.texture_shadow_map_comp, m_shadow_map);
+        mapping->set(m_slots.texture_shadow_map, m_shadow_map);
+        mapping->set(m_slots.sampler_shadow_shadow_map, m_shadow_map_compare_sampler);
+        mapping->set(m_slots.sampler_shadow_map, m_shadow_map_sampler);
+
+        if (m_punctual_light_buffer)
+            mapping->set(m_slots.punctual_light_buffer, m_punctual_light_buffer);
+        if (m_light_cluster_buffer)
+            mapping->set(m_slots.light_cluster_buffer, m_light_cluster_buffer);
+        if (m_light_index_buffer)
+            mapping->set(m_slots.light_index_buffer, m_light_index_buffer);
 
         device_context->submit_pipeline_state_resources();
 
         device_context->set_index_buffer(prim_gpu_data->index_buffer_view.graphics_buffer, prim_gpu_data->index_type);
 
-        std::vector<gfx_handle<const gfx_buffer>> vbs;
+        frame_vector<gfx_handle<const gfx_buffer>> vbs(arena);
         vbs.reserve(prim_gpu_data->vertex_buffer_views.size());
-        std::vector<int32> bindings;
+        frame_vector<int32> bindings(arena);
         bindings.reserve(prim_gpu_data->vertex_buffer_views.size());
-        std::vector<int32> offsets;
+        frame_vector<int32> offsets(arena);
         offsets.reserve(prim_gpu_data->vertex_buffer_views.size());
         int32 idx = 0;
-        for (auto vbv : prim_gpu_data->vertex_buffer_views)
+        for (const auto& vbv : prim_gpu_data->vertex_buffer_views)
         {
             vbs.push_back(vbv.graphics_buffer);
             bindings.push_back(idx++);
@@ -271,7 +279,7 @@ bool transparent_pass::create_pass_resources()
         shader_info.stage         = gfx_shader_stage_type::shader_stage_fragment;
         shader_info.shader_source = source_desc;
 
-        shader_info.resource_count = 26;
+        shader_info.resource_count = 29;
 
         shader_info.resources = { {
             { gfx_shader_stage_type::shader_stage_fragment, MATERIAL_DATA_BUFFER_BINDING_POINT, "material_data", gfx_shader_resource_type::shader_resource_constant_buffer, 1 },
@@ -280,6 +288,9 @@ bool transparent_pass::create_pass_resources()
             { gfx_shader_stage_type::shader_stage_fragment, RENDERER_DATA_BUFFER_BINDING_POINT, "renderer_data", gfx_shader_resource_type::shader_resource_constant_buffer, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, LIGHT_DATA_BUFFER_BINDING_POINT, "light_data", gfx_shader_resource_type::shader_resource_constant_buffer, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, SHADOW_DATA_BUFFER_BINDING_POINT, "shadow_data", gfx_shader_resource_type::shader_resource_constant_buffer, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, "punctual_light_buffer", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, LIGHT_CLUSTER_BUFFER_BINDING_POINT, "light_cluster_buffer", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
+            { gfx_shader_stage_type::shader_stage_fragment, LIGHT_INDEX_BUFFER_BINDING_POINT, "light_index_buffer", gfx_shader_resource_type::shader_resource_buffer_storage, 1 },
 
             { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR, "texture_base_color", gfx_shader_resource_type::shader_resource_input_attachment, 1 },
             { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR, "sampler_base_color", gfx_shader_resource_type::shader_resource_sampler, 1 },
@@ -334,6 +345,12 @@ bool transparent_pass::create_pass_resources()
                       { gfx_shader_stage_type::shader_stage_fragment, LIGHT_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer, gfx_shader_resource_access::shader_access_dynamic },
                       { gfx_shader_stage_type::shader_stage_fragment, SHADOW_DATA_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_constant_buffer,
                         gfx_shader_resource_access::shader_access_dynamic },
+                      { gfx_shader_stage_type::shader_stage_fragment, PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+                        gfx_shader_resource_access::shader_access_dynamic },
+                      { gfx_shader_stage_type::shader_stage_fragment, LIGHT_CLUSTER_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+                        gfx_shader_resource_access::shader_access_dynamic },
+                      { gfx_shader_stage_type::shader_stage_fragment, LIGHT_INDEX_BUFFER_BINDING_POINT, gfx_shader_resource_type::shader_resource_buffer_storage,
+                        gfx_shader_resource_access::shader_access_dynamic },
 
                       { gfx_shader_stage_type::shader_stage_fragment, GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR, gfx_shader_resource_type::shader_resource_input_attachment,
                         gfx_shader_resource_access::shader_access_dynamic },
@@ -401,3 +418,36 @@ bool transparent_pass::create_pass_resources()
 
     return true;
 }
+
+void transparent_pass::resolve_resource_slots(const gfx_handle<shader_resource_mapping>& mapping)
+{
+    m_slots.model_data                   = mapping->get_slot("model_data");
+    m_slots.camera_data                  = mapping->get_slot("camera_data");
+    m_slots.light_data                   = mapping->get_slot("light_data");
+    m_slots.renderer_data                = mapping->get_slot("renderer_data");
+    m_slots.material_data                = mapping->get_slot("material_data");
+    m_slots.texture_base_color           = mapping->get_slot("texture_base_color");
+    m_slots.sampler_base_color           = mapping->get_slot("sampler_base_color");
+    m_slots.texture_roughness_metallic   = mapping->get_slot("texture_roughness_metallic");
+    m_slots.sampler_roughness_metallic   = mapping->get_slot("sampler_roughness_metallic");
+    m_slots.texture_occlusion            = mapping->get_slot("texture_occlusion");
+    m_slots.sampler_occlusion            = mapping->get_slot("sampler_occlusion");
+    m_slots.texture_normal               = mapping->get_slot("texture_normal");
+    m_slots.sampler_normal               = mapping->get_slot("sampler_normal");
+    m_slots.texture_emissive_color       = mapping->get_slot("texture_emissive_color");
+    m_slots.sampler_emissive_color       = mapping->get_slot("sampler_emissive_color");
+    m_slots.texture_irradiance_map       = mapping->get_slot("texture_irradiance_map");
+    m_slots.sampler_irradiance_map       = mapping->get_slot("sampler_irradiance_map");
+    m_slots.texture_radiance_map         = mapping->get_slot("texture_radiance_map");
+    m_slots.sampler_radiance_map         = mapping->get_slot("sampler_radiance_map");
+    m_slots.texture_brdf_integration_lut = mapping->get_slot("texture_brdf_integration_lut");
+    m_slots.sampler_brdf_integration_lut = mapping->get_slot("sampler_brdf_integration_lut");
+    m_slots.texture_shadow_map_comp      = mapping->get_slot("texture_shadow_map_comp");
+    m_slots.texture_shadow_map           = mapping->get_slot("texture_shadow_map");
+    m_slots.sampler_shadow_shadow_map    = mapping->get_slot("sampler_shadow_shadow_map");
+    m_slots.sampler_shadow_map           = mapping->get_slot("sampler_shadow_map");
+    m_slots.punctual_light_buffer        = mapping->get_slot("punctual_light_buffer");
+    m_slots.light_cluster_buffer         = mapping->get_slot("light_cluster_buffer");
+    m_slots.light_index_buffer           = mapping->get_slot("light_index_buffer");
+    m_slots.resolved                     = true;
+}
@@ -78,6 +78,18 @@ namespace mango
             m_shadow_data_buffer = shadow_data_buffer;
         }
 
+        //! \brief Set the buffers of the clustered point and spot lights.
+        //! \param[in] punctual_light_buffer The punctual light buffer.
+        //! \param[in] light_cluster_buffer The light cluster buffer.
+        //! \param[in] light_index_buffer The light index buffer.
+        inline void set_light_cluster_buffers(const gfx_handle<const gfx_buffer>& punctual_light_buffer, const gfx_handle<const gfx_buffer>& light_cluster_buffer,
+                                              const gfx_handle<const gfx_buffer>& light_index_buffer)
+        {
+            m_punctual_light_buffer = punctual_light_buffer;
+            m_light_cluster_buffer  = light_cluster_buffer;
+            m_light_index_buffer    = light_index_buffer;
+        }
+
         //! \brief Set the irradiance map.
         //! \param[in] irradiance_map The irradiance map to sample.
         inline void set_irradiance_map(const gfx_handle<const gfx_texture>& irradiance_map)
@@ -148,13 +160,6 @@ namespace mango
             m_render_targets = render_targets;
         }
 
-        //! \brief Set frustum culling.
-        //! \param[in] frustum_culling True if frustum culling is enabled, else false.
-        inline void set_frustum_culling(bool frustum_culling)
-        {
-            m_frustum_culling = frustum_culling;
-        }
-
         //! \brief Set debug bounds drawing.
         //! \param[in] debug_bounds True if drawing debug bounds is enabled, else false.
         inline void set_debug_bounds(bool debug_bounds)
@@ -176,13 +181,6 @@ namespace mango
             m_default_texture_2D = default_texture_2D;
         }
 
-        //! \brief Set the camera frustum.
-        //! \param[in] camera_frustum The cameras \a bounding_frustum.
-        inline void set_camera_frustum(const bounding_frustum& camera_frustum)
-        {
-            m_camera_frustum = camera_frustum;
-        }
-
         //! \brief Offset in draws where transparent draws start.
         //! \param[in] transparent_start The offset of transparent draw calls in draws.
         inline void set_transparent_start(int32 transparent_start)
@@ -191,10 +189,13 @@ namespace mango
         }
 
         //! \brief Set draws.
-        //! \param[in] draws The list of \a draw_keys.
-        inline void set_draws(const shared_ptr<std::vector<draw_key>>& draws)
+        //! \details The \a draw_keys are not copied and have to stay valid until the pass is executed.
+        //! \param[in] draws Pointer to the list of \a draw_keys.
+        //! \param[in] draw_count The number of \a draw_keys in draws.
+        inline void set_draws(const draw_key* draws, int32 draw_count)
         {
-            m_draws = draws;
+            m_draws      = draws;
+            m_draw_count = draw_count;
         }
 
       private:
@@ -203,6 +204,10 @@ namespace mango
 
         bool create_pass_resources() override;
 
+        //! \brief Resolves the shader resource slots of the transparent \a gfx_pipelines.
+        //! \param[in] mapping The \a shader_resource_mapping of one of the transparent \a gfx_pipelines.
+        void resolve_resource_slots(const gfx_handle<shader_resource_mapping>& mapping);
+
         //! \brief The vertex \a gfx_shader_stage for the deferred geometry pass.
         gfx_handle<const gfx_shader_stage> m_transparent_pass_vertex;
         //! \brief The fragment \a gfx_shader_stage for the deferred geometry pass.
@@ -220,9 +225,6 @@ namespace mango
         //! \brief The \a gfx_viewport to render to.
         gfx_viewport m_viewport;
 
-        //! \brief The \a bounding_frustum of the camera.
-        bounding_frustum m_camera_frustum;
-
         //! \brief The render targets to render to.
         std::vector<gfx_handle<const gfx_texture>> m_render_targets;
 
@@ -234,6 +236,12 @@ namespace mango
         gfx_handle<const gfx_buffer> m_light_data_buffer;
         //! \brief The shadow data \a gfx_buffer.
         gfx_handle<const gfx_buffer> m_shadow_data_buffer;
+        //! \brief The punctual light \a gfx_buffer.
+        gfx_handle<const gfx_buffer> m_punctual_light_buffer;
+        //! \brief The light cluster \a gfx_buffer.
+        gfx_handle<const gfx_buffer> m_light_cluster_buffer;
+        //! \brief The light index \a gfx_buffer.
+        gfx_handle<const gfx_buffer> m_light_index_buffer;
 
         //! \brief The irradiance map \a gfx_texture.
         gfx_handle<const gfx_texture> m_irradiance_map;
@@ -255,8 +263,6 @@ namespace mango
         //! \brief The shadow map comparison \a gfx_sampler.
         gfx_handle<const gfx_sampler> m_shadow_map_compare_sampler;
 
-        //! \brief True if frustum culling is enabled, else false.
-        bool m_frustum_culling;
         //! \brief True if drawing debug bounds is enabled, else false.
         bool m_debug_bounds;
         //! \brief True if wireframe drawing is enabled, else false.
@@ -268,8 +274,45 @@ namespace mango
         //! \brief The default 2d \a gfx_texture.
         gfx_handle<const gfx_texture> m_default_texture_2D;
 
+        //! \brief The pre-resolved shader resource slots of the transparent \a gfx_pipelines.
+        //! \details All of them are created with the same layout and shader stages, so the slots are resolved once with the first one.
+        struct
+        {
+            bool resolved = false;
+            shader_resource_mapping::resource_slot model_data;
+            shader_resource_mapping::resource_slot camera_data;
+            shader_resource_mapping::resource_slot light_data;
+            shader_resource_mapping::resource_slot renderer_data;
+            shader_resource_mapping::resource_slot material_data;
+            shader_resource_mapping::resource_slot texture_base_color;
+            shader_resource_mapping::resource_slot sampler_base_color;
+            shader_resource_mapping::resource_slot texture_roughness_metallic;
+            shader_resource_mapping::resource_slot sampler_roughness_metallic;
+            shader_resource_mapping::resource_slot texture_occlusion;
+            shader_resource_mapping::resource_slot sampler_occlusion;
+            shader_resource_mapping::resource_slot texture_normal;
+            shader_resource_mapping::resource_slot sampler_normal;
+            shader_resource_mapping::resource_slot texture_emissive_color;
+            shader_resource_mapping::resource_slot sampler_emissive_color;
+            shader_resource_mapping::resource_slot texture_irradiance_map;
+            shader_resource_mapping::resource_slot sampler_irradiance_map;
+            shader_resource_mapping::resource_slot texture_radiance_map;
+            shader_resource_mapping::resource_slot sampler_radiance_map;
+            shader_resource_mapping::resource_slot texture_brdf_integration_lut;
+            shader_resource_mapping::resource_slot sampler_brdf_integration_lut;
+            shader_resource_mapping::resource_slot texture_shadow_map_comp;
+            shader_resource_mapping::resource_slot texture_shadow_map;
+            shader_resource_mapping::resource_slot sampler_shadow_shadow_map;
+            shader_resource_mapping::resource_slot sampler_shadow_map;
+            shader_resource_mapping::resource_slot punctual_light_buffer;
+            shader_resource_mapping::resource_slot light_cluster_buffer;
+            shader_resource_mapping::resource_slot light_index_buffer;
+        } m_slots;
+
         //! \brief The list of \a draw_keys.
-        shared_ptr<std::vector<draw_key>> m_draws;
+        const draw_key* m_draws = nullptr;
+        //! \brief The number of \a draw_keys in the list.
+        int32 m_draw_count = 0;
     };
 } // namespace mango
 
@@ -4,9 +4,12 @@
 //! \date      2022
 //! \copyright Apache License 2.0
 
+#include <core/job_system.hpp>
 #include <glad/glad.h>
 #include <mango/imgui_helper.hpp>
 #include <mango/profile.hpp>
+#include <memory/frame_arena.hpp>
+#include <numeric>
 #include <rendering/passes/environment_display_pass.hpp>
 #include <rendering/passes/fxaa_pass.hpp>
 #include <rendering/passes/shadow_map_pass.hpp>
@@ -14,9 +17,13 @@
 #include <resources/resources_impl.hpp>
 #include <scene/scene_impl.hpp>
 #include <util/helpers.hpp>
+#include <util/radix_sort.hpp>
 
 using namespace mango;
 
+//! \brief Number of render instances processed by one job when generating draw keys.
+static const uint32 draw_generation_chunk_size = 512;
+
 //! \brief Default 2D \a gfx_texture to bind when no other texture is available.
 gfx_handle<const gfx_texture> default_texture_2D;
 //! \brief Default cube \a gfx_texture to bind when no other texture is available.
@@ -49,6 +56,9 @@ deferred_pbr_renderer::deferred_pbr_renderer(const renderer_configuration& confi
     m_renderer_data.metallic_debug_view         = false;
     m_renderer_data.show_cascades               = false;
 
+    // multi draw is used where available, the passes only get the setting in update_passes().
+    m_multi_draw = m_graphics_device->supports_multi_draw_indirect();
+
     if (!create_renderer_resources())
     {
         MANGO_LOG_ERROR("Resource Creation Failed! Renderer is not available!");
@@ -57,8 +67,9 @@ deferred_pbr_renderer::deferred_pbr_renderer(const renderer_configuration& confi
 
     m_vsync           = configuration.is_vsync_enabled();
     m_wireframe       = configuration.should_draw_wireframe();
-    m_frustum_culling = configuration.is_frustum_culling_enabled();
-    m_debug_bounds    = configuration.should_draw_debug_bounds();
+    m_frustum_culling   = configuration.is_frustum_culling_enabled();
+    m_occlusion_culling = true;
+    m_debug_bounds      = configuration.should_draw_debug_bounds();
 
     auto device_context = m_graphics_device->create_graphics_device_context();
     device_context->begin();
@@ -149,40 +160,7 @@ bool deferred_pbr_renderer::create_textures_and_samplers()
     attachment_info.array_layers = 1;
     attachment_info.texture_type = gfx_texture_type::texture_type_2d;
 
-    m_gbuffer_render_targets.clear();
-    attachment_info.texture_format = gfx_format::rgba8;
-    m_gbuffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.texture_format = gfx_format::rgb10_a2;
-    m_gbuffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.texture_format = gfx_format::rgba32f;
-    m_gbuffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.texture_format = gfx_format::rgba8;
-    m_gbuffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.texture_format = gfx_format::depth_component32f;
-    m_gbuffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-
-    for (auto rt : m_gbuffer_render_targets)
-    {
-        if (!check_creation(rt.get(), "gbuffer render targets"))
-            return false;
-    }
-
-    // HDR for auto exposure
-    m_hdr_buffer_render_targets.clear();
-    attachment_info.miplevels      = graphics::calculate_mip_count(w, h);
-    attachment_info.texture_format = gfx_format::rgba32f;
-    m_hdr_buffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.miplevels      = 1;
-    attachment_info.texture_format = gfx_format::depth_component32f;
-    m_hdr_buffer_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-
-    for (auto rt : m_hdr_buffer_render_targets)
-    {
-        if (!check_creation(rt.get(), "hdr buffer render targets"))
-            return false;
-    }
-
-    // output
+    // output, all other targets are transient and owned by the render graph.
     attachment_info.miplevels      = 1;
     attachment_info.texture_format = gfx_format::rgba8;
     m_output_target                = m_graphics_device->create_texture(attachment_info);
@@ -198,20 +176,6 @@ bool deferred_pbr_renderer::create_textures_and_samplers()
     if (antialiasing)
         antialiasing->set_output_targets(m_output_target, m_ouput_depth_target);
 
-    // postprocessing render targets
-    m_post_render_targets.clear();
-    attachment_info.miplevels      = 1;
-    attachment_info.texture_format = gfx_format::rgba8;
-    m_post_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-    attachment_info.texture_format = gfx_format::depth_component32f;
-    m_post_render_targets.push_back(m_graphics_device->create_texture(attachment_info));
-
-    for (auto rt : m_post_render_targets)
-    {
-        if (!check_creation(rt.get(), "postprocessing buffer render targets"))
-            return false;
-    }
-
     sampler_create_info sampler_info;
     sampler_info.sampler_min_filter      = gfx_sampler_filter::sampler_filter_nearest;
     sampler_info.sampler_max_filter      = gfx_sampler_filter::sampler_filter_nearest;
@@ -274,6 +238,7 @@ bool deferred_pbr_renderer::create_passes()
     m_transparent_pass.attach(m_shared_context);
     m_composing_pass.attach(m_shared_context);
     m_auto_luminance_pass.attach(m_shared_context);
+    m_hi_z_pass.attach(m_shared_context);
 
     // optional passes
     const bool* render_passes = m_configuration.get_render_extensions();
@@ -299,6 +264,9 @@ bool deferred_pbr_renderer::create_passes()
         m_pipeline_extensions[mango::render_pipeline_extension::fxaa] = std::static_pointer_cast<render_pass>(pass_fxaa);
     }
 
+    // shaders of all passes compile in parallel if the driver supports it, wait here instead of in the first frame.
+    m_graphics_device->wait_for_pipelines();
+
     return update_passes();
 }
 
@@ -308,15 +276,12 @@ bool deferred_pbr_renderer::update_passes()
                                   static_cast<float>(m_renderer_info.canvas.height) };
 
     m_opaque_geometry_pass.set_viewport(window_viewport);
-    m_opaque_geometry_pass.set_render_targets(m_gbuffer_render_targets);
     m_opaque_geometry_pass.set_debug_bounds(m_debug_bounds);
-    m_opaque_geometry_pass.set_frustum_culling(m_frustum_culling);
     m_opaque_geometry_pass.set_wireframe(m_wireframe);
+    m_opaque_geometry_pass.set_multi_draw(m_multi_draw);
     m_opaque_geometry_pass.set_default_texture_2D(default_texture_2D);
 
     m_deferred_lighting_pass.set_viewport(window_viewport);
-    m_deferred_lighting_pass.set_render_targets(m_hdr_buffer_render_targets);
-    m_deferred_lighting_pass.set_gbuffer(m_gbuffer_render_targets, m_linear_sampler);
     m_deferred_lighting_pass.set_renderer_data_buffer(m_renderer_data_buffer);
     m_deferred_lighting_pass.set_irradiance_map_sampler(m_mipmapped_linear_sampler);
     m_deferred_lighting_pass.set_radiance_map_sampler(m_mipmapped_linear_sampler);
@@ -325,9 +290,7 @@ bool deferred_pbr_renderer::update_passes()
     m_deferred_lighting_pass.set_shadow_map_compare_sampler(m_linear_compare_sampler);
 
     m_transparent_pass.set_viewport(window_viewport);
-    m_transparent_pass.set_render_targets(m_hdr_buffer_render_targets);
     m_transparent_pass.set_debug_bounds(m_debug_bounds);
-    m_transparent_pass.set_frustum_culling(m_frustum_culling);
     m_transparent_pass.set_wireframe(m_wireframe);
     m_transparent_pass.set_default_texture_2D(default_texture_2D);
     m_transparent_pass.set_renderer_data_buffer(m_renderer_data_buffer);
@@ -339,14 +302,13 @@ bool deferred_pbr_renderer::update_passes()
 
     m_composing_pass.set_viewport(window_viewport);
     m_composing_pass.set_renderer_data_buffer(m_renderer_data_buffer);
-    m_composing_pass.set_hdr_input(m_hdr_buffer_render_targets[0]);
     m_composing_pass.set_hdr_input_sampler(m_nearest_sampler);
-    m_composing_pass.set_depth_input(m_hdr_buffer_render_targets.back());
     m_composing_pass.set_depth_input_sampler(m_nearest_sampler);
 
-    m_auto_luminance_pass.set_hdr_input(m_hdr_buffer_render_targets[0]);
     m_auto_luminance_pass.set_input_size(m_renderer_info.canvas.width, m_renderer_info.canvas.height);
 
+    m_hi_z_pass.set_input_size(m_renderer_info.canvas.width, m_renderer_info.canvas.height);
+
     // optional
     auto environment_display = std::static_pointer_cast<environment_display_pass>(m_pipeline_extensions[mango::render_pipeline_extension::environment_display]);
     if (environment_display)
@@ -358,6 +320,7 @@ bool deferred_pbr_renderer::update_passes()
         shadow_pass->set_frustum_culling(m_frustum_culling);
         shadow_pass->set_debug_bounds(m_debug_bounds);
         shadow_pass->set_wireframe(m_wireframe);
+        shadow_pass->set_multi_draw(m_multi_draw);
         shadow_pass->set_debug_view_enabled(m_renderer_data.debug_view_enabled);
         shadow_pass->set_default_texture_2D(default_texture_2D);
     }
@@ -377,8 +340,18 @@ void deferred_pbr_renderer::update(float dt)
 void deferred_pbr_renderer::render(scene_impl* scene, float dt)
 {
     PROFILE_ZONE;
-    m_renderer_info.last_frame.draw_calls = 0;
-    m_renderer_info.last_frame.vertices   = 0;
+    // create pipelines for newly loaded geometry before it gets drawn.
+    scene->collect_new_geometry_layouts(m_new_geometry_layouts);
+    if (!m_new_geometry_layouts.empty())
+    {
+        m_pipeline_cache->prewarm(m_new_geometry_layouts);
+        m_new_geometry_layouts.clear();
+    }
+
+    m_renderer_info.last_frame.draw_calls       = 0;
+    m_renderer_info.last_frame.vertices         = 0;
+    m_renderer_info.last_frame.frustum_culled   = 0;
+    m_renderer_info.last_frame.occlusion_culled = 0;
 
     m_frame_context->begin();
     float clear_color[4] = { 0.1f, 0.1f, 0.1f, 1.0f }; // TODO Paul: member or dynamic?
@@ -386,27 +359,10 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
 
     auto shadow_pass = std::static_pointer_cast<shadow_map_pass>(m_pipeline_extensions[mango::render_pipeline_extension::shadow_map]);
 
-    // clear all framebuffers
+    // the render graph only clears the targets it needs cleared, the swap chain is not part of it.
     {
         GL_NAMED_PROFILE_ZONE("Clear Framebuffers");
         NAMED_PROFILE_ZONE("Clear Framebuffers");
-        if (shadow_pass)
-        {
-            m_frame_context->set_render_targets(0, nullptr, shadow_pass->get_shadow_maps_texture());
-            m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
-        }
-        m_frame_context->set_render_targets(static_cast<int32>(m_gbuffer_render_targets.size()) - 1, m_gbuffer_render_targets.data(), m_gbuffer_render_targets.back());
-        m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
-        m_frame_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, clear_color);
-        m_frame_context->set_render_targets(static_cast<int32>(m_hdr_buffer_render_targets.size()) - 1, m_hdr_buffer_render_targets.data(), m_hdr_buffer_render_targets.back());
-        m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
-        m_frame_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, clear_color);
-        m_frame_context->set_render_targets(static_cast<int32>(m_post_render_targets.size()) - 1, m_post_render_targets.data(), m_post_render_targets.back());
-        m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
-        m_frame_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, clear_color);
-        m_frame_context->set_render_targets(1, &m_output_target, m_ouput_depth_target);
-        m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
-        m_frame_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, clear_color);
         // TODO Paul: Is the renderer in charge here?
         m_frame_context->set_render_targets(1, &swap_buffer, m_graphics_device->get_swap_chain_depth_stencil_target());
         m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
@@ -417,11 +373,17 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
 
     auto active_camera_data = scene->get_active_camera_gpu_data();
     if (!active_camera_data.has_value())
+    {
+        // without a camera nothing is rendered into the output.
+        m_frame_context->set_render_targets(1, &m_output_target, m_ouput_depth_target);
+        m_frame_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, 1.0f, 0);
+        m_frame_context->clear_render_target(gfx_clear_attachment_flag_bits::clear_flag_all_draw_buffers, clear_color);
         return;
+    }
 
-    shared_ptr<std::vector<draw_key>> draws = std::make_shared<std::vector<draw_key>>();
-    int32 opaque_count                      = 0;
-    auto instances                          = scene->get_render_instances();
+    // all per frame lists live in the frame arena.
+    frame_arena& arena = *m_shared_context->get_frame_arena();
+    int32 opaque_count = 0;
     if (m_debug_bounds)
         m_debug_drawer->clear();
     bounding_frustum camera_frustum;
@@ -450,217 +412,409 @@ void deferred_pbr_renderer::render(scene_impl* scene, float dt)
         }
     }
 
-    for (auto instance : instances)
+    // Only primitives intersecting the camera frustum get draws, the hierarchy rejects whole subtrees at once.
+    const std::vector<primitive_instance>& instances = scene->get_primitive_instances();
+    std::vector<uint32>& visible_instances           = m_visible_instances;
+    visible_instances.clear();
+    if (m_frustum_culling)
+        scene->get_primitive_bvh().query(camera_frustum, visible_instances);
+    else
     {
-        // we can assume the stuff exists - we also want to be fast
-        optional<node&> node = scene->get_node(instance.node_hnd);
-        MANGO_ASSERT(node, "Non existing node in instances!");
-        optional<mat4&> global_transformation_matrix = scene->get_global_transformation_matrix(node->global_matrix_hnd);
-        MANGO_ASSERT(global_transformation_matrix, "Non existing transformation matrix in instances!");
+        visible_instances.resize(instances.size());
+        std::iota(visible_instances.begin(), visible_instances.end(), 0u);
+    }
 
-        if ((node->type & node_type::mesh) != node_type::hierarchy)
+    // The hierarchical depth of the last frame is read back one frame late and rejects primitives hidden behind it.
+    const hi_z_readback* readback = m_occlusion_culling ? m_hi_z_pass.get_readback(m_frame_context) : nullptr;
+    if (readback)
+        m_occlusion_culler.set_depth(*readback);
+    else
+        m_occlusion_culler.reset();
+
+    // Draw keys are generated in parallel chunks, every chunk fills its own list.
+    job_system* jobs               = m_shared_context->get_job_system().get();
+    const camera_data& cam_data    = active_camera_data->per_camera_data;
+    const occlusion_culler& culler = m_occlusion_culler;
+    const uint32 visible_count     = static_cast<uint32>(visible_instances.size());
+    frame_vector<frame_vector<draw_key>> chunk_draws(job_system::chunk_count(visible_count, draw_generation_chunk_size), frame_vector<draw_key>(arena), arena);
+
+    jobs->parallel_for(visible_count, draw_generation_chunk_size, [scene, &instances, &visible_instances, &cam_data, &culler, &chunk_draws](uint32 begin, uint32 end) {
+        frame_vector<draw_key>& chunk = chunk_draws[begin / draw_generation_chunk_size];
+        chunk.reserve(end - begin);
+        // the view depth is the third row of the view matrix applied to a point
+        const vec3 view_z_axis = cam_data.view_matrix.row(2).head<3>().transpose();
+        const float view_z     = cam_data.view_matrix(2, 3);
+
+        for (uint32 i = begin; i < end; ++i)
         {
+            // we can assume the stuff exists - we also want to be fast
+            const primitive_instance& instance = instances[visible_instances[i]];
+            if (culler.is_occluded(instance.bounding_box))
+                continue;
+
+            optional<primitive&> prim = scene->get_primitive(instance.primitive_hnd);
+            MANGO_ASSERT(prim, "Non existing primitive in instances!");
+            optional<const material&> mat = scene->read_material(prim->primitive_material);
+            MANGO_ASSERT(mat, "Non existing material in instances!");
+
             draw_key a_draw;
+            a_draw.mesh_gpu_data_id      = instance.mesh_gpu_data_id;
+            a_draw.primitive_gpu_data_id = prim->gpu_data;
+            a_draw.material_hnd          = prim->primitive_material;
 
-            MANGO_ASSERT(node->mesh_hnd.valid(), "Node with mesh has no mesh attached!");
-            optional<mesh&> mesh = scene->get_mesh(node->mesh_hnd);
-            MANGO_ASSERT(mesh, "Non existing mesh in instances!");
-            a_draw.mesh_gpu_data_id = mesh->gpu_data;
+            a_draw.transparent = mat->alpha_mode > material_alpha_mode::mode_mask;
 
-            for (auto p : mesh->primitives)
-            {
-                optional<primitive&> prim = scene->get_primitive(p);
-                MANGO_ASSERT(prim, "Non existing primitive in instances!");
-                optional<material&> mat = scene->get_material(prim->primitive_material);
-                MANGO_ASSERT(mat, "Non existing material in instances!");
-
-                a_draw.primitive_gpu_data_id = prim->gpu_data;
-                a_draw.material_hnd          = prim->primitive_material;
-
-                a_draw.transparent = mat->alpha_mode > material_alpha_mode::mode_mask;
-                opaque_count += a_draw.transparent ? 0 : 1;
-
-                a_draw.bounding_box = prim->bounding_box.get_transformed(global_transformation_matrix.value());
-
-                if (!a_draw.transparent)
-                    a_draw.view_depth = active_camera_data->per_camera_data.camera_far + 1.0f;
-                else
-                    a_draw.view_depth = active_camera_data->per_camera_data.camera_near - 1.0f;
-
-                std::array<vec3, 8> bb_corners = a_draw.bounding_box.get_corners();
-                for (const vec3& corner : bb_corners)
-                {
-                    if (!a_draw.transparent)
-                        a_draw.view_depth = min(a_draw.view_depth, (active_camera_data->per_camera_data.view_matrix * vec4(corner.x(), corner.y(), corner.z(), 1.0f)).z());
-                    else
-                        a_draw.view_depth = max(a_draw.view_depth, (active_camera_data->per_camera_data.view_matrix * vec4(corner.x(), corner.y(), corner.z(), 1.0f)).z());
-                }
-                // MANGO_LOG_INFO("{0}", a_draw.view_depth);
-
-                draws->push_back(a_draw);
-            }
+            a_draw.bounding_box = instance.bounding_box;
+
+            // Minimum (opaque) or maximum (transparent) view depth of all corners without projecting them.
+            const float center_depth = view_z_axis.dot(a_draw.bounding_box.center) + view_z;
+            const float depth_extent = view_z_axis.cwiseAbs().dot(a_draw.bounding_box.extents);
+            a_draw.view_depth        = a_draw.transparent ? center_depth + depth_extent : center_depth - depth_extent;
+
+            chunk.push_back(a_draw);
         }
-    }
+    });
 
-    std::sort(draws->begin(), draws->end());
+    size_t draw_count = 0;
+    for (const frame_vector<draw_key>& chunk : chunk_draws)
+        draw_count += chunk.size();
 
-    auto warn_missing_draw = [](string what) { MANGO_LOG_WARN("{0} missing for draw. Skipping DrawCall!", what); };
+    m_renderer_info.last_frame.frustum_culled   = static_cast<int32>(instances.size()) - static_cast<int32>(visible_count);
+    m_renderer_info.last_frame.occlusion_culled = static_cast<int32>(visible_count) - static_cast<int32>(draw_count);
 
-    const light_stack& ls = scene->get_light_stack();
-    auto light_data       = scene->get_light_gpu_data();
+    // Sort the packed keys and gather the draws in order.
+    frame_vector<draw_key> unsorted_draws(arena);
+    unsorted_draws.reserve(draw_count);
+    for (const frame_vector<draw_key>& chunk : chunk_draws)
+        unsorted_draws.insert(unsorted_draws.end(), chunk.begin(), chunk.end());
 
-    // shadow pass
-    if (shadow_pass)
+    frame_vector<sort_pair> sort_pairs(draw_count, sort_pair(), arena);
+    for (uint32 i = 0; i < static_cast<uint32>(draw_count); ++i)
     {
-        shadow_pass->set_camera_data_buffer(active_camera_data->camera_data_buffer);
-        shadow_pass->set_scene_pointer(scene);
-        shadow_pass->set_camera_frustum(camera_frustum);
-        shadow_pass->set_draws(draws);
-        shadow_pass->set_delta_time(dt);
-        shadow_pass->set_camera_near(active_camera_data->per_camera_data.camera_near);
-        shadow_pass->set_camera_far(active_camera_data->per_camera_data.camera_far);
-        shadow_pass->set_camera_inverse_view_projection(active_camera_data->per_camera_data.inverse_view_projection);
-        shadow_pass->set_shadow_casters(ls.get_shadow_casters());
-
-        shadow_pass->execute(m_frame_context);
-
-        auto pass_info = shadow_pass->get_info();
-        m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
-        m_renderer_info.last_frame.vertices += pass_info.vertices;
+        sort_pairs[i].sort_key = unsorted_draws[i].sort_key(cam_data.camera_near, cam_data.camera_far);
+        sort_pairs[i].index    = i;
+        opaque_count += unsorted_draws[i].transparent ? 0 : 1;
     }
 
-    // gbuffer pass
-    {
-        m_opaque_geometry_pass.set_camera_data_buffer(active_camera_data->camera_data_buffer);
-        m_opaque_geometry_pass.set_scene_pointer(scene);
-        m_opaque_geometry_pass.set_camera_frustum(camera_frustum);
-        m_opaque_geometry_pass.set_draws(draws);
-        m_opaque_geometry_pass.set_opaque_count(opaque_count);
-
-        m_opaque_geometry_pass.execute(m_frame_context);
-
-        auto pass_info = m_opaque_geometry_pass.get_info();
-        m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
-        m_renderer_info.last_frame.vertices += pass_info.vertices;
-    }
+    radix_sort(sort_pairs.data(), static_cast<uint32>(draw_count), arena, jobs);
 
-    // lighting pass
-    auto irradiance = ls.get_skylight_irradiance_map();
-    auto specular   = ls.get_skylight_specular_prefilter_map();
-    auto brdf_lut   = ls.get_skylight_brdf_lookup();
-    {
-        m_deferred_lighting_pass.set_camera_data_buffer(active_camera_data->camera_data_buffer);
-        m_deferred_lighting_pass.set_light_data_buffer(light_data.light_data_buffer);
-        m_deferred_lighting_pass.set_shadow_data_buffer(shadow_pass ? shadow_pass->get_shadow_data_buffer() : nullptr);
+    // the draws stay in the arena until the passes recorded them.
+    frame_vector<draw_key> draws(arena);
+    draws.reserve(draw_count);
+    for (uint32 i = 0; i < static_cast<uint32>(draw_count); ++i)
+        draws.push_back(unsorted_draws[sort_pairs[i].index]);
 
-        m_deferred_lighting_pass.set_irradiance_map(irradiance ? irradiance : default_texture_cube);
-        m_deferred_lighting_pass.set_radiance_map(specular ? specular : default_texture_cube);
-        m_deferred_lighting_pass.set_brdf_integration_lut(brdf_lut ? brdf_lut : default_texture_2D);
+    auto warn_missing_draw = [](string what) { MANGO_LOG_WARN("{0} missing for draw. Skipping DrawCall!", what); };
 
-        m_deferred_lighting_pass.set_shadow_map(shadow_pass ? shadow_pass->get_shadow_maps_texture() : default_texture_array);
+    const light_stack& ls = scene->get_light_stack();
+    auto light_data       = scene->get_light_gpu_data();
 
-        m_deferred_lighting_pass.execute(m_frame_context);
+    auto irradiance          = ls.get_skylight_irradiance_map();
+    auto specular            = ls.get_skylight_specular_prefilter_map();
+    auto brdf_lut            = ls.get_skylight_brdf_lookup();
+    auto environment_display = std::static_pointer_cast<environment_display_pass>(m_pipeline_extensions[mango::render_pipeline_extension::environment_display]);
+    auto antialiasing        = std::static_pointer_cast<fxaa_pass>(m_pipeline_extensions[mango::render_pipeline_extension::fxaa]);
+
+    // The passes declare what they read and write, the render graph culls, clears and synchronizes them and shares transient targets.
+    m_render_graph.reset();
+    const vec4 clear_value = vec4(0.1f, 0.1f, 0.1f, 1.0f);
+
+    texture_create_info target_info;
+    target_info.texture_type   = gfx_texture_type::texture_type_2d;
+    target_info.width          = m_renderer_info.canvas.width;
+    target_info.height         = m_renderer_info.canvas.height;
+    target_info.miplevels      = 1;
+    target_info.array_layers   = 1;
+    target_info.texture_format = gfx_format::rgba8;
+    const render_graph_resource gbuffer_0 = m_render_graph.create_texture("GBuffer Target 0", target_info);
+    target_info.texture_format            = gfx_format::rgb10_a2;
+    const render_graph_resource gbuffer_1 = m_render_graph.create_texture("GBuffer Target 1", target_info);
+    target_info.texture_format            = gfx_format::rgba32f;
+    const render_graph_resource gbuffer_2 = m_render_graph.create_texture("GBuffer Target 2", target_info);
+    target_info.texture_format            = gfx_format::rgba8;
+    const render_graph_resource gbuffer_3 = m_render_graph.create_texture("GBuffer Target 3", target_info);
+    target_info.texture_format            = gfx_format::depth_component32f;
+    const render_graph_resource gbuffer_d = m_render_graph.create_texture("GBuffer Depth", target_info);
 
-        auto pass_info = m_deferred_lighting_pass.get_info();
-        m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
-        m_renderer_info.last_frame.vertices += pass_info.vertices;
+    // HDR for auto exposure
+    target_info.miplevels                 = graphics::calculate_mip_count(target_info.width, target_info.height);
+    target_info.texture_format            = gfx_format::rgba32f;
+    const render_graph_resource hdr_color = m_render_graph.create_texture("HDR Color", target_info);
+    target_info.miplevels                 = 1;
+    target_info.texture_format            = gfx_format::depth_component32f;
+    const render_graph_resource hdr_depth = m_render_graph.create_texture("HDR Depth", target_info);
+
+    const render_graph_resource output         = m_render_graph.import_texture("Output Color", m_output_target);
+    const render_graph_resource output_depth   = m_render_graph.import_texture("Output Depth", m_ouput_depth_target);
+    const render_graph_resource luminance_data = m_render_graph.import_buffer("Luminance Data", m_auto_luminance_pass.get_luminance_data_buffer(), render_graph_access::host);
+    const render_graph_resource shadow_maps    = shadow_pass ? m_render_graph.import_texture("Shadow Maps", shadow_pass->get_shadow_maps_texture()) : invalid_render_graph_resource;
+
+    // postprocessing extensions read the composed image, otherwise it is composed into the output directly.
+    render_graph_resource composed_color = output;
+    render_graph_resource composed_depth = output_depth;
+    if (antialiasing)
+    {
+        target_info.texture_format = gfx_format::rgba8;
+        composed_color             = m_render_graph.create_texture("Post Color", target_info);
+        target_info.texture_format = gfx_format::depth_component32f;
+        composed_depth             = m_render_graph.create_texture("Post Depth", target_info);
     }
 
-    // cubemap pass
-    if (!m_renderer_data.debug_view_enabled)
+    // shadow pass, clears the shadow maps itself, cached static casters are copied in instead.
+    if (shadow_pass)
     {
-        auto environment_display = std::static_pointer_cast<environment_display_pass>(m_pipeline_extensions[mango::render_pipeline_extension::environment_display]);
-        if (environment_display && specular)
-        {
-            environment_display->set_camera_data_buffer(active_camera_data->camera_data_buffer);
-            environment_display->set_cubemap(specular);
-
-            environment_display->execute(m_frame_context);
+        m_render_graph.add_pass(
+            "Shadow Maps", [&](render_graph_builder& builder) { builder.write(shadow_maps, render_graph_access::render_target); },
+            [&](const render_graph&, graphics_device_context_handle& device_context) {
+                shadow_pass->set_camera_data_buffer(active_camera_data->camera_data_buffer);
+                shadow_pass->set_scene_pointer(scene);
+                shadow_pass->set_camera_frustum(camera_frustum);
+                shadow_pass->set_delta_time(dt);
+                shadow_pass->set_camera_near(active_camera_data->per_camera_data.camera_near);
+                shadow_pass->set_camera_far(active_camera_data->per_camera_data.camera_far);
+                shadow_pass->set_camera_inverse_view_projection(active_camera_data->per_camera_data.inverse_view_projection);
+                shadow_pass->set_shadow_casters(ls.get_shadow_casters());
+
+                shadow_pass->execute(device_context);
+
+                auto pass_info = shadow_pass->get_info();
+                m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
+                m_renderer_info.last_frame.vertices += pass_info.vertices;
+            });
+    }
 
-            auto pass_info = environment_display->get_info();
+    // gbuffer pass
+    m_render_graph.add_pass(
+        "GBuffer",
+        [&](render_graph_builder& builder) {
+            builder.clear_color(gbuffer_0, clear_value);
+            builder.clear_color(gbuffer_1, clear_value);
+            builder.clear_color(gbuffer_2, clear_value);
+            builder.clear_color(gbuffer_3, clear_value);
+            builder.clear_depth(gbuffer_d, 1.0f);
+        },
+        [&](const render_graph& graph, graphics_device_context_handle& device_context) {
+            m_opaque_geometry_pass.set_render_targets(
+                { graph.get_texture(gbuffer_0), graph.get_texture(gbuffer_1), graph.get_texture(gbuffer_2), graph.get_texture(gbuffer_3), graph.get_texture(gbuffer_d) });
+            m_opaque_geometry_pass.set_camera_data_buffer(active_camera_data->camera_data_buffer);
+            m_opaque_geometry_pass.set_scene_pointer(scene);
+            m_opaque_geometry_pass.set_draws(draws.data(), static_cast<int32>(draws.size()));
+            m_opaque_geometry_pass.set_opaque_count(opaque_count);
+
+            m_opaque_geometry_pass.execute(device_context);
+
+            auto pass_info = m_opaque_geometry_pass.get_info();
             m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
             m_renderer_info.last_frame.vertices += pass_info.vertices;
-        }
-    }
+        });
 
-    // transparent pass
+    // hi-z pass
+    if (m_occlusion_culling)
     {
-        m_transparent_pass.set_camera_data_buffer(active_camera_data->camera_data_buffer);
-        m_transparent_pass.set_light_data_buffer(light_data.light_data_buffer);
-        m_transparent_pass.set_shadow_data_buffer(shadow_pass ? shadow_pass->get_shadow_data_buffer() : nullptr);
-
-        m_transparent_pass.set_scene_pointer(scene);
-        m_transparent_pass.set_camera_frustum(camera_frustum);
-        m_transparent_pass.set_draws(draws);
-        m_transparent_pass.set_transparent_start(opaque_count);
-
-        m_transparent_pass.set_irradiance_map(irradiance ? irradiance : default_texture_cube);
-        m_transparent_pass.set_radiance_map(specular ? specular : default_texture_cube);
-        m_transparent_pass.set_brdf_integration_lut(brdf_lut ? brdf_lut : default_texture_2D);
-
-        m_transparent_pass.set_shadow_map(shadow_pass ? shadow_pass->get_shadow_maps_texture() : default_texture_array);
+        m_render_graph.add_pass(
+            "Hi-Z Pyramid",
+            [&](render_graph_builder& builder) {
+                builder.read(gbuffer_d, render_graph_access::sampled);
+                // the pyramid is read back for the next frame.
+                builder.side_effects();
+            },
+            [&](const render_graph& graph, graphics_device_context_handle& device_context) {
+                m_hi_z_pass.set_depth_input(graph.get_texture(gbuffer_d), m_nearest_sampler);
+                m_hi_z_pass.set_view_projection(active_camera_data->per_camera_data.view_projection_matrix);
+                m_hi_z_pass.execute(device_context);
+            });
+    }
 
-        m_transparent_pass.execute(m_frame_context);
+    // lighting pass
+    m_render_graph.add_pass(
+        "Deferred Lighting",
+        [&](render_graph_builder& builder) {
+            builder.read(gbuffer_0, render_graph_access::sampled);
+            builder.read(gbuffer_1, render_graph_access::sampled);
+            builder.read(gbuffer_2, render_graph_access::sampled);
+            builder.read(gbuffer_3, render_graph_access::sampled);
+            builder.read(gbuffer_d, render_graph_access::sampled);
+            if (shadow_pass)
+                builder.read(shadow_maps, render_graph_access::sampled);
+            builder.clear_color(hdr_color, clear_value);
+            builder.clear_depth(hdr_depth, 1.0f);
+        },
+        [&](const render_graph& graph, graphics_device_context_handle& device_context) {
+            m_deferred_lighting_pass.set_render_targets({ graph.get_texture(hdr_color), graph.get_texture(hdr_depth) });
+            m_deferred_lighting_pass.set_gbuffer(
+                { graph.get_texture(gbuffer_0), graph.get_texture(gbuffer_1), graph.get_texture(gbuffer_2), graph.get_texture(gbuffer_3), graph.get_texture(gbuffer_d) },
+                m_linear_sampler);
+            m_deferred_lighting_pass.set_camera_data_buffer(active_camera_data->camera_data_buffer);
+            m_deferred_lighting_pass.set_light_data_buffer(light_data.light_data_buffer);
+            m_deferred_lighting_pass.set_shadow_data_buffer(shadow_pass ? shadow_pass->get_shadow_data_buffer() : nullptr);
+            m_deferred_lighting_pass.set_light_cluster_buffers(light_data.punctual_light_buffer, light_data.light_cluster_buffer, light_data.light_index_buffer);
+
+            m_deferred_lighting_pass.set_irradiance_map(irradiance ? irradiance : default_texture_cube);
+            m_deferred_lighting_pass.set_radiance_map(specular ? specular : default_texture_cube);
+            m_deferred_lighting_pass.set_brdf_integration_lut(brdf_lut ? brdf_lut : default_texture_2D);
+
+            m_deferred_lighting_pass.set_shadow_map(shadow_pass ? shadow_pass->get_shadow_maps_texture() : default_texture_array);
+
+            m_deferred_lighting_pass.execute(device_context);
+
+            auto pass_info = m_deferred_lighting_pass.get_info();
+            m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
+            m_renderer_info.last_frame.vertices += pass_info.vertices;
+        });
 
-        auto pass_info = m_transparent_pass.get_info();
-        m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
-        m_renderer_info.last_frame.vertices += pass_info.vertices;
+    // cubemap pass
+    if (!m_renderer_data.debug_view_enabled && environment_display && specular)
+    {
+        m_render_graph.add_pass(
+            "Environment Display",
+            [&](render_graph_builder& builder) {
+                builder.read(hdr_color, render_graph_access::render_target);
+                builder.read(hdr_depth, render_graph_access::render_target);
+                builder.write(hdr_color, render_graph_access::render_target);
+            },
+            [&](const render_graph& graph, graphics_device_context_handle& device_context) {
+                gfx_handle<const gfx_texture> hdr_target = graph.get_texture(hdr_color);
+                device_context->set_render_targets(1, &hdr_target, graph.get_texture(hdr_depth));
+                environment_display->set_camera_data_buffer(active_camera_data->camera_data_buffer);
+                environment_display->set_cubemap(specular);
+
+                environment_display->execute(device_context);
+
+                auto pass_info = environment_display->get_info();
+                m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
+                m_renderer_info.last_frame.vertices += pass_info.vertices;
+            });
     }
 
-    m_debug_drawer->update_buffer();
+    // transparent pass
+    m_render_graph.add_pass(
+        "Transparent",
+        [&](render_graph_builder& builder) {
+            if (shadow_pass)
+                builder.read(shadow_maps, render_graph_access::sampled);
+            builder.read(hdr_color, render_graph_access::render_target);
+            builder.read(hdr_depth, render_graph_access::render_target);
+            builder.write(hdr_color, render_graph_access::render_target);
+            builder.write(hdr_depth, render_graph_access::render_target);
+        },
+        [&](const render_graph& graph, graphics_device_context_handle& device_context) {
+            m_transparent_pass.set_render_targets({ graph.get_texture(hdr_color), graph.get_texture(hdr_depth) });
+            m_transparent_pass.set_camera_data_buffer(active_camera_data->camera_data_buffer);
+            m_transparent_pass.set_light_data_buffer(light_data.light_data_buffer);
+            m_transparent_pass.set_shadow_data_buffer(shadow_pass ? shadow_pass->get_shadow_data_buffer() : nullptr);
+            m_transparent_pass.set_light_cluster_buffers(light_data.punctual_light_buffer, light_data.light_cluster_buffer, light_data.light_index_buffer);
+
+            m_transparent_pass.set_scene_pointer(scene);
+            m_transparent_pass.set_draws(draws.data(), static_cast<int32>(draws.size()));
+            m_transparent_pass.set_transparent_start(opaque_count);
+
+            m_transparent_pass.set_irradiance_map(irradiance ? irradiance : default_texture_cube);
+            m_transparent_pass.set_radiance_map(specular ? specular : default_texture_cube);
+            m_transparent_pass.set_brdf_integration_lut(brdf_lut ? brdf_lut : default_texture_2D);
+
+            m_transparent_pass.set_shadow_map(shadow_pass ? shadow_pass->get_shadow_maps_texture() : default_texture_array);
+
+            m_transparent_pass.execute(device_context);
+
+            auto pass_info = m_transparent_pass.get_info();
+            m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
+            m_renderer_info.last_frame.vertices += pass_info.vertices;
+        });
 
     // auto exposure
     if (scene->calculate_auto_exposure())
     {
-        m_auto_luminance_pass.set_delta_time(dt);
-
-        m_auto_luminance_pass.execute(m_frame_context);
+        m_render_graph.add_pass(
+            "Auto Exposure",
+            [&](render_graph_builder& builder) {
+                builder.read(hdr_color, render_graph_access::storage_image);
+                // the mipmaps are generated for the luminance calculation.
+                builder.write(hdr_color, render_graph_access::transfer);
+                builder.write(luminance_data, render_graph_access::storage_buffer);
+            },
+            [&](const render_graph& graph, graphics_device_context_handle& device_context) {
+                m_auto_luminance_pass.set_hdr_input(graph.get_texture(hdr_color));
+                m_auto_luminance_pass.set_delta_time(dt);
+
+                m_auto_luminance_pass.execute(device_context);
+            });
     }
 
-    auto antialiasing          = std::static_pointer_cast<fxaa_pass>(m_pipeline_extensions[mango::render_pipeline_extension::fxaa]);
-    bool postprocessing_buffer = antialiasing != nullptr;
-
     // composing pass
-    {
-        if (postprocessing_buffer)
-            m_composing_pass.set_render_targets(m_post_render_targets);
-        else
-            m_composing_pass.set_render_targets({ m_output_target, m_ouput_depth_target });
-
-        m_composing_pass.set_camera_data_buffer(active_camera_data->camera_data_buffer);
-
-        m_composing_pass.execute(m_frame_context);
-
-        auto pass_info = m_composing_pass.get_info();
-        m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
-        m_renderer_info.last_frame.vertices += pass_info.vertices;
-    }
+    m_render_graph.add_pass(
+        "Composing",
+        [&](render_graph_builder& builder) {
+            builder.read(hdr_color, render_graph_access::sampled);
+            builder.read(hdr_depth, render_graph_access::sampled);
+            builder.write(composed_color, render_graph_access::render_target);
+            builder.write(composed_depth, render_graph_access::render_target);
+        },
+        [&](const render_graph& graph, graphics_device_context_handle& device_context) {
+            m_composing_pass.set_render_targets({ graph.get_texture(composed_color), graph.get_texture(composed_depth) });
+            m_composing_pass.set_hdr_input(graph.get_texture(hdr_color));
+            m_composing_pass.set_depth_input(graph.get_texture(hdr_depth));
+            m_composing_pass.set_camera_data_buffer(active_camera_data->camera_data_buffer);
+
+            m_composing_pass.execute(device_context);
+
+            auto pass_info = m_composing_pass.get_info();
+            m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
+            m_renderer_info.last_frame.vertices += pass_info.vertices;
+        });
 
     // debug lines
     if (m_debug_bounds)
     {
-        m_renderer_info.last_frame.draw_calls++;
-        m_renderer_info.last_frame.vertices += m_debug_drawer->vertex_count();
-        // use already set last render targets and just add lines on top!
-        m_debug_drawer->execute(m_frame_context);
+        m_render_graph.add_pass(
+            "Debug Lines",
+            [&](render_graph_builder& builder) {
+                builder.read(composed_color, render_graph_access::render_target);
+                builder.read(composed_depth, render_graph_access::render_target);
+                builder.write(composed_color, render_graph_access::render_target);
+            },
+            [&](const render_graph& graph, graphics_device_context_handle& device_context) {
+                // the lines were added by the geometry passes.
+                m_debug_drawer->update_buffer(device_context);
+
+                gfx_handle<const gfx_texture> composed_target = graph.get_texture(composed_color);
+                device_context->set_render_targets(1, &composed_target, graph.get_texture(composed_depth));
+                m_renderer_info.last_frame.draw_calls++;
+                m_renderer_info.last_frame.vertices += m_debug_drawer->vertex_count();
+                m_debug_drawer->execute(device_context);
+            });
     }
 
     // fxaa
     if (antialiasing)
     {
-        antialiasing->set_input_texture(m_post_render_targets[0]); // TODO Paul Hardcoded post targets -> meh.
-        m_renderer_info.last_frame.draw_calls++;
-        m_renderer_info.last_frame.vertices += 3;
-        antialiasing->execute(m_frame_context);
-
-        auto pass_info = antialiasing->get_info();
-        m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
-        m_renderer_info.last_frame.vertices += pass_info.vertices;
+        m_render_graph.add_pass(
+            "FXAA",
+            [&](render_graph_builder& builder) {
+                builder.read(composed_color, render_graph_access::sampled);
+                builder.write(output, render_graph_access::render_target);
+                // fxaa does not write depth.
+                builder.clear_depth(output_depth, 1.0f);
+            },
+            [&](const render_graph& graph, graphics_device_context_handle& device_context) {
+                antialiasing->set_input_texture(graph.get_texture(composed_color));
+                m_renderer_info.last_frame.draw_calls++;
+                m_renderer_info.last_frame.vertices += 3;
+                antialiasing->execute(device_context);
+
+                auto pass_info = antialiasing->get_info();
+                m_renderer_info.last_frame.draw_calls += pass_info.draw_calls;
+                m_renderer_info.last_frame.vertices += pass_info.vertices;
+            });
     }
 
+    if (m_render_graph.compile() && m_render_graph.realize(m_graphics_device))
+        m_render_graph.execute(m_frame_context);
     m_frame_context->bind_pipeline(nullptr);
     // TODO Paul: Is the renderer in charge here?
     m_frame_context->set_render_targets(1, &swap_buffer, m_graphics_device->get_swap_chain_depth_stencil_target());
+
+    m_graphics_device->collect_api_call_counters(m_renderer_info.last_frame.api_calls_issued, m_renderer_info.last_frame.api_calls_skipped);
+    m_renderer_info.last_frame.live_samplers = m_graphics_device->get_live_sampler_count();
 }
 
 void deferred_pbr_renderer::present()
@@ -705,6 +859,9 @@ void deferred_pbr_renderer::on_ui_widget()
         device_context->submit();
     }
     changed |= checkbox("Frustum Culling", &m_frustum_culling, true);
+    changed |= checkbox("Occlusion Culling", &m_occlusion_culling, true);
+    if (m_graphics_device->supports_multi_draw_indirect())
+        changed |= checkbox("Multi Draw Indirect", &m_multi_draw, true);
     ImGui::Separator();
     bool has_environment_display = m_pipeline_extensions[mango::render_pipeline_extension::environment_display] != nullptr;
     bool has_shadow_map          = m_pipeline_extensions[mango::render_pipeline_extension::shadow_map] != nullptr;
@@ -749,6 +906,8 @@ void deferred_pbr_renderer::on_ui_widget()
                 pass_shadow_map->attach(m_shared_context);
                 m_pipeline_extensions[mango::render_pipeline_extension::shadow_map] = std::static_pointer_cast<render_pass>(pass_shadow_map);
                 m_renderer_data.shadow_pass_enabled                                 = true;
+                // shadow pipelines for all geometry loaded so far.
+                m_pipeline_cache->prewarm(std::vector<geometry_layout>());
             }
             else
             {
@@ -9,6 +9,8 @@
 
 #include <rendering/debug_drawer.hpp>
 #include <rendering/light_stack.hpp>
+#include <rendering/occlusion_culler.hpp>
+#include <rendering/render_graph.hpp>
 #include <rendering/renderer_impl.hpp>
 #include <rendering/renderer_pipeline_cache.hpp>
 #include <rendering/renderer_bindings.hpp>
@@ -17,6 +19,7 @@
 #include <rendering/passes/transparent_pass.hpp>
 #include <rendering/passes/composing_pass.hpp>
 #include <rendering/passes/auto_luminance_pass.hpp>
+#include <rendering/passes/hi_z_pass.hpp>
 
 namespace mango
 {
@@ -55,12 +58,8 @@ namespace mango
 
         //! \brief The \a graphics_device of the \a renderer.
         const graphics_device_handle& m_graphics_device;
-        //! \brief The gbuffer render targets of the deferred pipeline.
-        std::vector<gfx_handle<const gfx_texture>> m_gbuffer_render_targets;
-        //! \brief The hdr buffer render targets of the deferred pipeline. Used for auto exposure.
-        std::vector<gfx_handle<const gfx_texture>> m_hdr_buffer_render_targets;
-        //! \brief The postprocessing render targets of the deferred pipeline.
-        std::vector<gfx_handle<const gfx_texture>> m_post_render_targets;
+        //! \brief The \a render_graph declaring all passes and transient targets of a frame.
+        render_graph m_render_graph;
 
         //! \brief A sampler with nearest filtering and "clamp to edge" edge handling.
         gfx_handle<const gfx_sampler> m_nearest_sampler;
@@ -86,9 +85,16 @@ namespace mango
         composing_pass m_composing_pass;
         //! \brief The \a renderers \a auto_luminance_pass.
         auto_luminance_pass m_auto_luminance_pass;
+        //! \brief The \a renderers \a hi_z_pass.
+        hi_z_pass m_hi_z_pass;
+
+        //! \brief The \a occlusion_culler testing draws against the depth of the previous frame.
+        occlusion_culler m_occlusion_culler;
 
         //! \brief The \a renderers \a renderer_pipeline_cache to create and cache \a gfx_pipelines for the geometry.
         shared_ptr<renderer_pipeline_cache> m_pipeline_cache;
+        //! \brief The \a geometry_layouts of newly loaded geometry, pipelines are prewarmed for them before drawing.
+        std::vector<geometry_layout> m_new_geometry_layouts;
 
         //! \brief The \a renderers \a graphics_device_context to execute per frame graphics commands.
         graphics_device_context_handle m_frame_context;
@@ -126,6 +132,16 @@ namespace mango
         //! \brief True if the renderer should cull primitives against camera and shadow frusta, else false.
         bool m_frustum_culling;
 
+        //! \brief True if the renderer should cull primitives hidden in the depth buffer of the previous frame, else false.
+        bool m_occlusion_culling;
+
+        //! \brief True if the renderer should batch opaque and shadow draws with multi draw indirect, else false.
+        bool m_multi_draw;
+
+        //! \brief The indices of the scenes \a primitive_instances visible in the current frame.
+        //! \details Kept between frames, so the memory is reused.
+        std::vector<uint32> m_visible_instances;
+
         float get_average_luminance() const override;
     };
 
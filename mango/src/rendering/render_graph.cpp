@@ -0,0 +1,507 @@
+//! \file      render_graph.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <mango/assert.hpp>
+#include <mango/log.hpp>
+#include <mango/profile.hpp>
+#include <rendering/render_graph.hpp>
+
+using namespace mango;
+
+//! \brief Checks if two \a texture_create_infos describe interchangeable textures.
+//! \param[in] lhs The first \a texture_create_info.
+//! \param[in] rhs The second \a texture_create_info.
+//! \return True if textures created with them are interchangeable, else false.
+static bool same_texture(const texture_create_info& lhs, const texture_create_info& rhs)
+{
+    return lhs.texture_type == rhs.texture_type && lhs.texture_format == rhs.texture_format && lhs.width == rhs.width && lhs.height == rhs.height &&
+           lhs.miplevels == rhs.miplevels && lhs.array_layers == rhs.array_layers;
+}
+
+//! \brief Checks if writes with a \a render_graph_access are incoherent and have to be made visible with a barrier.
+//! \param[in] access The \a render_graph_access.
+//! \return True if a barrier is required before other accesses, else false.
+static bool is_incoherent_write(render_graph_access access)
+{
+    return access == render_graph_access::storage_image || access == render_graph_access::storage_buffer;
+}
+
+//! \brief Retrieves the \a gfx_barrier_bit making incoherent writes visible to an access.
+//! \param[in] access The \a render_graph_access following the incoherent write.
+//! \param[in] buffer True if the accessed resource is a buffer, else false.
+//! \return The \a gfx_barrier_bit required before the access.
+static gfx_barrier_bit barrier_for(render_graph_access access, bool buffer)
+{
+    switch (access)
+    {
+    case render_graph_access::render_target:
+        return gfx_barrier_bit::framebuffer_barrier_bit;
+    case render_graph_access::sampled:
+        return gfx_barrier_bit::texture_fetch_barrier_bit;
+    case render_graph_access::storage_image:
+        return gfx_barrier_bit::shader_image_access_barrier_bit;
+    case render_graph_access::storage_buffer:
+        return gfx_barrier_bit::shader_storage_barrier_bit;
+    case render_graph_access::uniform_buffer:
+        return gfx_barrier_bit::uniform_barrier_bit;
+    case render_graph_access::indirect:
+        return gfx_barrier_bit::command_barrier_bit;
+    case render_graph_access::transfer:
+        return buffer ? gfx_barrier_bit::buffer_update_barrier_bit : gfx_barrier_bit::texture_update_barrier_bit;
+    case render_graph_access::host:
+        return gfx_barrier_bit::buffer_update_barrier_bit;
+    default:
+        return gfx_barrier_bit::unknown_barrier_bit;
+    }
+}
+
+render_graph_builder::render_graph_builder(render_graph& graph, int32 pass)
+    : m_graph(graph)
+    , m_pass(pass)
+{
+}
+
+void render_graph_builder::read(render_graph_resource resource, render_graph_access access)
+{
+    MANGO_ASSERT(resource >= 0 && resource < m_graph.m_resource_count, "Invalid render graph resource!");
+    m_graph.m_passes[m_pass].accesses.push_back({ resource, access, false });
+}
+
+void render_graph_builder::write(render_graph_resource resource, render_graph_access access)
+{
+    MANGO_ASSERT(resource >= 0 && resource < m_graph.m_resource_count, "Invalid render graph resource!");
+    m_graph.m_passes[m_pass].accesses.push_back({ resource, access, true });
+}
+
+void render_graph_builder::clear_color(render_graph_resource resource, const vec4& color)
+{
+    write(resource, render_graph_access::render_target);
+    m_graph.m_passes[m_pass].requested_clears.push_back({ resource, false, color, 1.0f });
+}
+
+void render_graph_builder::clear_depth(render_graph_resource resource, float depth)
+{
+    write(resource, render_graph_access::render_target);
+    m_graph.m_passes[m_pass].requested_clears.push_back({ resource, true, vec4::Zero(), depth });
+}
+
+void render_graph_builder::side_effects()
+{
+    m_graph.m_passes[m_pass].side_effects = true;
+}
+
+render_graph::render_graph()
+    : m_pass_count(0)
+    , m_resource_count(0)
+    , m_execute_memory(4096)
+    , m_final_barrier(gfx_barrier_bit::unknown_barrier_bit)
+{
+}
+
+render_graph::~render_graph()
+{
+    reset();
+}
+
+void render_graph::reset()
+{
+    for (int32 i = 0; i < m_pass_count; ++i)
+        m_passes[i].destroy(m_passes[i].execute_function);
+    // the functions of the last declaration are destroyed, so their memory can be reused.
+    m_execute_memory.begin_frame();
+
+    // imported objects are released, everything else is overwritten by the next declaration.
+    for (int32 r = 0; r < m_resource_count; ++r)
+    {
+        m_resources[r].texture       = nullptr;
+        m_resources[r].buffer_handle = nullptr;
+    }
+
+    m_pass_count     = 0;
+    m_resource_count = 0;
+    m_physical_infos.clear();
+    m_physical_textures.clear();
+    m_final_barrier = gfx_barrier_bit::unknown_barrier_bit;
+}
+
+render_graph_resource render_graph::add_resource(const char* name)
+{
+    if (m_resource_count == static_cast<int32>(m_resources.size()))
+        m_resources.emplace_back();
+
+    resource& res    = m_resources[m_resource_count];
+    res.name         = name;
+    res.buffer       = false;
+    res.imported     = false;
+    res.final_access = render_graph_access::none;
+    res.first_use    = -1;
+    res.last_use     = -1;
+    res.physical     = -1;
+    return m_resource_count++;
+}
+
+render_graph_resource render_graph::create_texture(const char* name, const texture_create_info& info)
+{
+    render_graph_resource r = add_resource(name);
+    m_resources[r].info     = info;
+    return r;
+}
+
+render_graph_resource render_graph::import_texture(const char* name, const gfx_handle<const gfx_texture>& texture)
+{
+    render_graph_resource r = add_resource(name);
+    resource& res           = m_resources[r];
+    res.imported            = true;
+    res.texture             = texture;
+    return r;
+}
+
+render_graph_resource render_graph::import_buffer(const char* name, const gfx_handle<const gfx_buffer>& buffer, render_graph_access final_access)
+{
+    render_graph_resource r = add_resource(name);
+    resource& res           = m_resources[r];
+    res.buffer              = true;
+    res.imported            = true;
+    res.buffer_handle       = buffer;
+    res.final_access        = final_access;
+    return r;
+}
+
+render_graph::pass& render_graph::add_pass(const char* name)
+{
+    if (m_pass_count == static_cast<int32>(m_passes.size()))
+        m_passes.emplace_back();
+
+    // clearing keeps the capacity of the lists.
+    pass& p = m_passes[m_pass_count++];
+    p.name  = name;
+    p.accesses.clear();
+    p.requested_clears.clear();
+    p.clears.clear();
+    p.barrier      = gfx_barrier_bit::unknown_barrier_bit;
+    p.side_effects = false;
+    p.culled       = false;
+    return p;
+}
+
+bool render_graph::compile()
+{
+    PROFILE_ZONE;
+    m_physical_infos.clear();
+    m_physical_textures.clear();
+    m_final_barrier = gfx_barrier_bit::unknown_barrier_bit;
+
+    cull_passes();
+    calculate_lifetimes();
+    assign_physical_textures();
+
+    // reading transient textures nothing wrote before is an error in the declaration.
+    m_written.assign(m_resource_count, false);
+    for (int32 i = 0; i < m_pass_count; ++i)
+    {
+        const pass& p = m_passes[i];
+        if (p.culled)
+            continue;
+        for (const access& a : p.accesses)
+        {
+            const resource& res = m_resources[a.resource];
+            if (!a.write && !res.imported && !m_written[a.resource])
+            {
+                MANGO_LOG_ERROR("Pass {0} reads {1}, which is not written before!", p.name, res.name);
+                return false;
+            }
+        }
+        for (const access& a : p.accesses)
+            m_written[a.resource] = m_written[a.resource] || a.write;
+    }
+
+    calculate_clears_and_barriers();
+
+    return true;
+}
+
+void render_graph::cull_passes()
+{
+    // walking backwards, a pass is needed if it writes something a later needed pass reads.
+    std::vector<bool>& needed = m_written;
+    needed.assign(m_resource_count, false);
+    for (int32 i = m_pass_count - 1; i >= 0; --i)
+    {
+        pass& p    = m_passes[i];
+        bool alive = p.side_effects;
+        for (const access& a : p.accesses)
+            alive |= a.write && (m_resources[a.resource].imported || needed[a.resource]);
+
+        p.culled = !alive;
+        if (p.culled)
+            continue;
+
+        for (const access& a : p.accesses)
+        {
+            if (!a.write)
+                needed[a.resource] = true;
+        }
+    }
+}
+
+void render_graph::calculate_lifetimes()
+{
+    for (int32 r = 0; r < m_resource_count; ++r)
+    {
+        resource& res = m_resources[r];
+        res.first_use = -1;
+        res.last_use  = -1;
+        res.physical  = -1;
+    }
+
+    for (int32 i = 0; i < m_pass_count; ++i)
+    {
+        if (m_passes[i].culled)
+            continue;
+        for (const access& a : m_passes[i].accesses)
+        {
+            resource& res = m_resources[a.resource];
+            if (res.first_use < 0)
+                res.first_use = i;
+            res.last_use = i;
+        }
+    }
+}
+
+void render_graph::assign_physical_textures()
+{
+    m_transients.clear();
+    for (int32 r = 0; r < m_resource_count; ++r)
+    {
+        if (!m_resources[r].imported && m_resources[r].first_use >= 0)
+            m_transients.push_back(r);
+    }
+    // ties keep the declaration order, std::stable_sort would allocate.
+    std::sort(m_transients.begin(), m_transients.end(), [this](int32 lhs, int32 rhs) {
+        return m_resources[lhs].first_use < m_resources[rhs].first_use || (m_resources[lhs].first_use == m_resources[rhs].first_use && lhs < rhs);
+    });
+
+    // a physical texture is reused by the next texture with the same description after its last user.
+    std::vector<int32>& physical_last_use = m_physical_last_use;
+    physical_last_use.clear();
+    for (int32 r : m_transients)
+    {
+        resource& res = m_resources[r];
+        for (int32 p = 0; p < static_cast<int32>(m_physical_infos.size()); ++p)
+        {
+            if (physical_last_use[p] < res.first_use && same_texture(m_physical_infos[p], res.info))
+            {
+                res.physical = p;
+                break;
+            }
+        }
+        if (res.physical < 0)
+        {
+            res.physical = static_cast<int32>(m_physical_infos.size());
+            m_physical_infos.push_back(res.info);
+            physical_last_use.push_back(-1);
+        }
+        physical_last_use[res.physical] = res.last_use;
+    }
+}
+
+void render_graph::calculate_clears_and_barriers()
+{
+    std::vector<bool>& written = m_written;
+    written.assign(m_resource_count, false);
+    // resources with incoherent writes and the barriers already issued for them since.
+    std::vector<bool>& dirty = m_dirty;
+    dirty.assign(m_resource_count, false);
+    std::vector<gfx_barrier_bit>& visible = m_visible;
+    visible.assign(m_resource_count, gfx_barrier_bit::unknown_barrier_bit);
+
+    for (int32 i = 0; i < m_pass_count; ++i)
+    {
+        pass& p = m_passes[i];
+        p.clears.clear();
+        p.barrier = gfx_barrier_bit::unknown_barrier_bit;
+        if (p.culled)
+            continue;
+
+        // only the first write to a target needs the clear, imported targets are expected to be overwritten every frame.
+        for (const clear& c : p.requested_clears)
+        {
+            if (!written[c.resource])
+                p.clears.push_back(c);
+        }
+
+        for (const access& a : p.accesses)
+        {
+            gfx_barrier_bit bit = barrier_for(a.type, m_resources[a.resource].buffer);
+            if (dirty[a.resource] && (visible[a.resource] & bit) != bit)
+            {
+                p.barrier |= bit;
+                visible[a.resource] |= bit;
+            }
+        }
+        for (const access& a : p.accesses)
+        {
+            if (!a.write)
+                continue;
+            written[a.resource] = true;
+            if (is_incoherent_write(a.type))
+            {
+                dirty[a.resource]   = true;
+                visible[a.resource] = gfx_barrier_bit::unknown_barrier_bit;
+            }
+        }
+    }
+
+    for (int32 r = 0; r < m_resource_count; ++r)
+    {
+        const resource& res = m_resources[r];
+        if (!res.imported || res.final_access == render_graph_access::none || !dirty[r])
+            continue;
+        gfx_barrier_bit bit = barrier_for(res.final_access, res.buffer);
+        if ((visible[r] & bit) != bit)
+            m_final_barrier |= bit;
+    }
+}
+
+bool render_graph::realize(const graphics_device_handle& graphics_device)
+{
+    PROFILE_ZONE;
+    // physical textures of earlier frames are taken over in order, so a graph declared the same way gets the same textures.
+    std::vector<bool>& taken = m_pool_taken;
+    taken.assign(m_texture_pool.size(), false);
+    m_physical_textures.assign(m_physical_infos.size(), nullptr);
+    for (int32 p = 0; p < static_cast<int32>(m_physical_infos.size()); ++p)
+    {
+        for (int32 t = 0; t < static_cast<int32>(m_texture_pool.size()); ++t)
+        {
+            if (!taken[t] && same_texture(m_texture_pool[t].info, m_physical_infos[p]))
+            {
+                taken[t]               = true;
+                m_physical_textures[p] = m_texture_pool[t].texture;
+                break;
+            }
+        }
+    }
+
+    std::vector<physical_texture>& pool = m_next_pool;
+    pool.clear();
+    for (int32 p = 0; p < static_cast<int32>(m_physical_infos.size()); ++p)
+    {
+        if (!m_physical_textures[p])
+        {
+            m_physical_textures[p] = graphics_device->create_texture(m_physical_infos[p]);
+            if (!check_creation(m_physical_textures[p].get(), "render graph texture"))
+                return false;
+        }
+        pool.push_back({ m_physical_infos[p], m_physical_textures[p] });
+    }
+    // textures not taken over are released with the old pool, swapping keeps the memory of both lists.
+    m_texture_pool.swap(pool);
+    pool.clear();
+
+    return true;
+}
+
+void render_graph::execute(graphics_device_context_handle& device_context)
+{
+    PROFILE_ZONE;
+    MANGO_ASSERT(m_physical_textures.size() == m_physical_infos.size(), "Render graph is not realized!");
+    barrier_description bd;
+    for (int32 i = 0; i < m_pass_count; ++i)
+    {
+        const pass& p = m_passes[i];
+        if (p.culled)
+            continue;
+
+        if (p.barrier != gfx_barrier_bit::unknown_barrier_bit)
+        {
+            bd.barrier_bit = p.barrier;
+            device_context->barrier(bd);
+        }
+
+        if (!p.clears.empty())
+        {
+            std::vector<gfx_handle<const gfx_texture>>& color_targets = m_clear_targets;
+            gfx_handle<const gfx_texture> depth_target;
+            float depth_value = 1.0f;
+            for (const clear& c : p.clears)
+            {
+                if (c.depth)
+                {
+                    depth_target = get_texture(c.resource);
+                    depth_value  = c.depth_value;
+                }
+                else
+                    color_targets.push_back(get_texture(c.resource));
+            }
+
+            device_context->set_render_targets(static_cast<int32>(color_targets.size()), color_targets.data(), depth_target);
+            color_targets.clear();
+            if (depth_target)
+                device_context->clear_depth_stencil(gfx_clear_attachment_flag_bits::clear_flag_depth_buffer, depth_value, 0);
+            int32 color_index = 0;
+            for (const clear& c : p.clears)
+            {
+                if (c.depth)
+                    continue;
+                float color[4] = { c.color.x(), c.color.y(), c.color.z(), c.color.w() };
+                uint8 shift    = static_cast<uint8>(gfx_clear_attachment_flag_bits::clear_flag_draw_buffer0) << color_index++;
+                device_context->clear_render_target(static_cast<gfx_clear_attachment_flag_bits>(shift), color);
+            }
+        }
+
+        p.execute(p.execute_function, *this, device_context);
+    }
+
+    if (m_final_barrier != gfx_barrier_bit::unknown_barrier_bit)
+    {
+        bd.barrier_bit = m_final_barrier;
+        device_context->barrier(bd);
+    }
+}
+
+const gfx_handle<const gfx_texture>& render_graph::get_texture(render_graph_resource resource) const
+{
+    MANGO_ASSERT(resource >= 0 && resource < m_resource_count, "Invalid render graph resource!");
+    const render_graph::resource& res = m_resources[resource];
+    MANGO_ASSERT(!res.buffer, "Render graph resource is not a texture!");
+    if (res.imported)
+        return res.texture;
+    MANGO_ASSERT(res.physical >= 0 && res.physical < static_cast<int32>(m_physical_textures.size()), "Render graph texture is not used or not realized!");
+    return m_physical_textures[res.physical];
+}
+
+const gfx_handle<const gfx_buffer>& render_graph::get_buffer(render_graph_resource resource) const
+{
+    MANGO_ASSERT(resource >= 0 && resource < m_resource_count, "Invalid render graph resource!");
+    MANGO_ASSERT(m_resources[resource].buffer, "Render graph resource is not a buffer!");
+    return m_resources[resource].buffer_handle;
+}
+
+bool render_graph::is_culled(int32 pass) const
+{
+    MANGO_ASSERT(pass >= 0 && pass < m_pass_count, "Invalid render graph pass!");
+    return m_passes[pass].culled;
+}
+
+const std::vector<render_graph::clear>& render_graph::get_clears(int32 pass) const
+{
+    MANGO_ASSERT(pass >= 0 && pass < m_pass_count, "Invalid render graph pass!");
+    return m_passes[pass].clears;
+}
+
+gfx_barrier_bit render_graph::get_barrier(int32 pass) const
+{
+    MANGO_ASSERT(pass >= 0 && pass < m_pass_count, "Invalid render graph pass!");
+    return m_passes[pass].barrier;
+}
+
+int32 render_graph::get_physical_index(render_graph_resource resource) const
+{
+    MANGO_ASSERT(resource >= 0 && resource < m_resource_count, "Invalid render graph resource!");
+    return m_resources[resource].physical;
+}
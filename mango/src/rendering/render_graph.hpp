@@ -0,0 +1,360 @@
+//! \file      render_graph.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_RENDER_GRAPH_HPP
+#define MANGO_RENDER_GRAPH_HPP
+
+#include <graphics/graphics_device.hpp>
+#include <graphics/graphics_device_context.hpp>
+#include <graphics/graphics_resources.hpp>
+#include <mango/assert.hpp>
+#include <memory/frame_arena.hpp>
+#include <new>
+#include <util/helpers.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief Index of a resource declared in a \a render_graph.
+    using render_graph_resource = int32;
+
+    //! \brief An invalid \a render_graph_resource.
+    const render_graph_resource invalid_render_graph_resource = -1;
+
+    //! \brief The ways a pass can access a resource of a \a render_graph.
+    enum class render_graph_access : uint8
+    {
+        none,           //!< No access.
+        render_target,  //!< Color or depth attachment of a framebuffer.
+        sampled,        //!< Sampled or fetched in a shader.
+        storage_image,  //!< Image load or store in a shader.
+        storage_buffer, //!< Shader storage buffer access.
+        uniform_buffer, //!< Uniform buffer access.
+        indirect,       //!< Indirect draw or dispatch arguments.
+        transfer,       //!< Copies, uploads and mipmap generation.
+        host            //!< Read by the cpu through a mapping.
+    };
+
+    class render_graph;
+
+    //! \brief Declares the resource accesses of a pass added to a \a render_graph.
+    class render_graph_builder
+    {
+      public:
+        //! \brief Declares a read of a resource.
+        //! \param[in] resource The \a render_graph_resource to read.
+        //! \param[in] access The \a render_graph_access used to read.
+        void read(render_graph_resource resource, render_graph_access access);
+
+        //! \brief Declares a write to a resource.
+        //! \details Rendering to a target only writing parts of it or blending with its content requires a \a read() as well.
+        //! \param[in] resource The \a render_graph_resource to write.
+        //! \param[in] access The \a render_graph_access used to write.
+        void write(render_graph_resource resource, render_graph_access access);
+
+        //! \brief Declares a write to a color target, that has to be cleared before the pass.
+        //! \details The clear is dropped, if an earlier pass already wrote the target.
+        //! \param[in] resource The \a render_graph_resource to clear and write.
+        //! \param[in] color The clear color.
+        void clear_color(render_graph_resource resource, const vec4& color);
+
+        //! \brief Declares a write to a depth target, that has to be cleared before the pass.
+        //! \details The clear is dropped, if an earlier pass already wrote the target.
+        //! \param[in] resource The \a render_graph_resource to clear and write.
+        //! \param[in] depth The clear depth.
+        void clear_depth(render_graph_resource resource, float depth);
+
+        //! \brief Marks the pass as having effects outside of the graph, so it is never culled.
+        void side_effects();
+
+      private:
+        friend class render_graph;
+
+        //! \brief Constructs a \a render_graph_builder declaring the accesses of one pass.
+        //! \param[in] graph The \a render_graph the pass was added to.
+        //! \param[in] pass The index of the pass.
+        render_graph_builder(render_graph& graph, int32 pass);
+
+        //! \brief The \a render_graph the pass was added to.
+        render_graph& m_graph;
+        //! \brief The index of the pass.
+        int32 m_pass;
+    };
+
+    //! \brief A graph of passes declaring the resources they read and write.
+    //! \details The graph is declared, compiled and executed each frame.
+    //! Declaring a graph the same way as in the frame before does not allocate, the storage of passes and resources is kept and only cleared.
+    //! Compilation culls passes nothing depends on and assigns the transient textures to physical textures.
+    //! Transient textures with the same \a texture_create_info and disjoint lifetimes share one physical texture.
+    //! Clears of targets are only kept for the first pass writing them and barriers are derived from the accesses.
+    //! Physical textures are kept between frames and only created, when the graph needs more of them.
+    class render_graph
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(render_graph)
+      public:
+        //! \brief A clear of a render target done before a pass.
+        struct clear
+        {
+            //! \brief The cleared \a render_graph_resource.
+            render_graph_resource resource;
+            //! \brief True if the resource is a depth target, else false.
+            bool depth;
+            //! \brief The clear color of color targets.
+            vec4 color;
+            //! \brief The clear depth of depth targets.
+            float depth_value;
+        };
+
+        render_graph();
+        ~render_graph();
+
+        //! \brief Removes all passes and resources, physical textures and the memory of the declaration are kept.
+        void reset();
+
+        //! \brief Declares a transient texture, which only lives while the graph is executed.
+        //! \param[in] name The name of the texture. Not copied, has to stay valid until the next \a reset().
+        //! \param[in] info The \a texture_create_info of the texture.
+        //! \return The \a render_graph_resource of the texture.
+        render_graph_resource create_texture(const char* name, const texture_create_info& info);
+
+        //! \brief Imports a texture living outside of the graph.
+        //! \param[in] name The name of the texture. Not copied, has to stay valid until the next \a reset().
+        //! \param[in] texture The texture to import.
+        //! \return The \a render_graph_resource of the texture.
+        render_graph_resource import_texture(const char* name, const gfx_handle<const gfx_texture>& texture);
+
+        //! \brief Imports a buffer living outside of the graph.
+        //! \param[in] name The name of the buffer. Not copied, has to stay valid until the next \a reset().
+        //! \param[in] buffer The buffer to import.
+        //! \param[in] final_access The \a render_graph_access the buffer is used with after the graph, a barrier is added if needed.
+        //! \return The \a render_graph_resource of the buffer.
+        render_graph_resource import_buffer(const char* name, const gfx_handle<const gfx_buffer>& buffer, render_graph_access final_access = render_graph_access::none);
+
+        //! \brief Adds a pass.
+        //! \details Passes are executed in the order they were added. Passes writing imported resources are never culled.
+        //! The execute function is moved into memory owned by the graph and destroyed on the next \a reset().
+        //! \param[in] name The name of the pass. Not copied, has to stay valid until the next \a reset().
+        //! \param[in] setup Function taking a \a render_graph_builder& to declare the resource accesses, called immediately.
+        //! \param[in] execute Function taking the const \a render_graph& and the \a graphics_device_context_handle& recording the pass.
+        template <typename Setup, typename Execute>
+        void add_pass(const char* name, const Setup& setup, Execute execute)
+        {
+            pass& p = add_pass(name);
+
+            void* memory = m_execute_memory.allocate(sizeof(Execute), alignof(Execute));
+            MANGO_ASSERT(memory, "Render graph could not store the execute function!");
+            p.execute_function = new (memory) Execute(std::move(execute));
+            p.execute          = [](void* function, const render_graph& graph, graphics_device_context_handle& device_context) { (*static_cast<Execute*>(function))(graph, device_context); };
+            p.destroy          = [](void* function) { static_cast<Execute*>(function)->~Execute(); };
+
+            render_graph_builder builder(*this, m_pass_count - 1);
+            setup(builder);
+        }
+
+        //! \brief Culls passes, calculates lifetimes, clears and barriers and assigns physical textures.
+        //! \return True on success, else false.
+        bool compile();
+
+        //! \brief Creates the physical textures not available from previous frames.
+        //! \details Has to be called after \a compile(). Physical textures not used any longer are released.
+        //! \param[in] graphics_device The \a graphics_device to create textures with.
+        //! \return True on success, else false.
+        bool realize(const graphics_device_handle& graphics_device);
+
+        //! \brief Executes all passes not culled.
+        //! \param[in] device_context The recording \a graphics_device_context to execute the passes with.
+        void execute(graphics_device_context_handle& device_context);
+
+        //! \brief Retrieves the texture of a resource.
+        //! \details Only valid while the graph is executed for transient textures.
+        //! \param[in] resource The \a render_graph_resource of the texture.
+        //! \return The texture.
+        const gfx_handle<const gfx_texture>& get_texture(render_graph_resource resource) const;
+
+        //! \brief Retrieves the buffer of a resource.
+        //! \param[in] resource The \a render_graph_resource of the buffer.
+        //! \return The buffer.
+        const gfx_handle<const gfx_buffer>& get_buffer(render_graph_resource resource) const;
+
+        //! \brief Checks if a pass got culled by the last \a compile().
+        //! \param[in] pass The index of the pass in the order they were added.
+        //! \return True if the pass is culled, else false.
+        bool is_culled(int32 pass) const;
+
+        //! \brief Retrieves the clears done before a pass.
+        //! \param[in] pass The index of the pass in the order they were added.
+        //! \return The clears done before the pass.
+        const std::vector<clear>& get_clears(int32 pass) const;
+
+        //! \brief Retrieves the barrier issued before a pass.
+        //! \param[in] pass The index of the pass in the order they were added.
+        //! \return The \a gfx_barrier_bit to issue before the pass.
+        gfx_barrier_bit get_barrier(int32 pass) const;
+
+        //! \brief Retrieves the barrier issued after all passes.
+        //! \return The \a gfx_barrier_bit to issue after the last pass.
+        inline gfx_barrier_bit get_final_barrier() const
+        {
+            return m_final_barrier;
+        }
+
+        //! \brief Retrieves the physical texture a transient texture got assigned to.
+        //! \param[in] resource The \a render_graph_resource of the texture.
+        //! \return The index of the physical texture, -1 for imported and unused resources.
+        int32 get_physical_index(render_graph_resource resource) const;
+
+        //! \brief Retrieves the number of physical textures the transient textures were assigned to.
+        //! \return The number of physical textures.
+        inline int32 get_physical_texture_count() const
+        {
+            return static_cast<int32>(m_physical_infos.size());
+        }
+
+        //! \brief Retrieves the number of passes added since the last \a reset().
+        //! \return The number of passes.
+        inline int32 get_pass_count() const
+        {
+            return m_pass_count;
+        }
+
+      private:
+        friend class render_graph_builder;
+
+        //! \brief An access of a pass to a resource.
+        struct access
+        {
+            //! \brief The accessed \a render_graph_resource.
+            render_graph_resource resource;
+            //! \brief The \a render_graph_access used.
+            render_graph_access type;
+            //! \brief True if the resource is written, else false.
+            bool write;
+        };
+
+        //! \brief A declared pass.
+        struct pass
+        {
+            //! \brief The name of the pass.
+            const char* name;
+            //! \brief The execute function stored in \a m_execute_memory.
+            void* execute_function;
+            //! \brief Calls the execute function.
+            void (*execute)(void* function, const render_graph& graph, graphics_device_context_handle& device_context);
+            //! \brief Destroys the execute function.
+            void (*destroy)(void* function);
+            //! \brief All accesses of the pass in the order they were declared.
+            std::vector<access> accesses;
+            //! \brief The clears requested by the pass.
+            std::vector<clear> requested_clears;
+            //! \brief The clears done before the pass.
+            std::vector<clear> clears;
+            //! \brief The barrier issued before the pass.
+            gfx_barrier_bit barrier;
+            //! \brief True if the pass has effects outside of the graph, else false.
+            bool side_effects;
+            //! \brief True if the pass got culled, else false.
+            bool culled;
+        };
+
+        //! \brief A declared resource.
+        struct resource
+        {
+            //! \brief The name of the resource.
+            const char* name;
+            //! \brief True if the resource is a buffer, else false.
+            bool buffer;
+            //! \brief True if the resource lives outside of the graph, else false.
+            bool imported;
+            //! \brief The \a texture_create_info of transient textures.
+            texture_create_info info;
+            //! \brief The texture of imported textures.
+            gfx_handle<const gfx_texture> texture;
+            //! \brief The buffer of imported buffers.
+            gfx_handle<const gfx_buffer> buffer_handle;
+            //! \brief The \a render_graph_access after the graph.
+            render_graph_access final_access;
+            //! \brief The index of the first pass using the resource, -1 if unused.
+            int32 first_use;
+            //! \brief The index of the last pass using the resource, -1 if unused.
+            int32 last_use;
+            //! \brief The index of the physical texture of transient textures, -1 if there is none.
+            int32 physical;
+        };
+
+        //! \brief A physical texture kept between frames.
+        struct physical_texture
+        {
+            //! \brief The \a texture_create_info the texture was created with.
+            texture_create_info info;
+            //! \brief The texture.
+            gfx_handle<const gfx_texture> texture;
+        };
+
+        //! \brief Adds a pass without an execute function, reusing the storage of an earlier declaration.
+        //! \param[in] name The name of the pass.
+        //! \return The added pass.
+        pass& add_pass(const char* name);
+
+        //! \brief Adds a resource, reusing the storage of an earlier declaration.
+        //! \param[in] name The name of the resource.
+        //! \return The \a render_graph_resource of the added resource.
+        render_graph_resource add_resource(const char* name);
+
+        //! \brief Culls all passes nothing depends on.
+        void cull_passes();
+
+        //! \brief Calculates the first and last use of every resource.
+        void calculate_lifetimes();
+
+        //! \brief Assigns all transient textures to physical textures.
+        void assign_physical_textures();
+
+        //! \brief Drops clears of targets already written and calculates the barriers before each pass.
+        void calculate_clears_and_barriers();
+
+        //! \brief All declared passes in the order they were added.
+        //! \details Only the first \a m_pass_count are in use, the others are kept to be reused.
+        std::vector<pass> m_passes;
+        //! \brief The number of declared passes.
+        int32 m_pass_count;
+        //! \brief All declared resources.
+        //! \details Only the first \a m_resource_count are in use, the others are kept to be reused.
+        std::vector<resource> m_resources;
+        //! \brief The number of declared resources.
+        int32 m_resource_count;
+        //! \brief The memory the execute functions of the passes are stored in.
+        frame_arena m_execute_memory;
+        //! \brief The \a texture_create_infos of the physical textures needed by the compiled graph.
+        std::vector<texture_create_info> m_physical_infos;
+        //! \brief The physical textures needed by the compiled graph, valid after \a realize().
+        std::vector<gfx_handle<const gfx_texture>> m_physical_textures;
+        //! \brief The physical textures kept between frames.
+        std::vector<physical_texture> m_texture_pool;
+        //! \brief The barrier issued after the last pass.
+        gfx_barrier_bit m_final_barrier;
+
+        // Scratch memory of compile(), realize() and execute(), kept to not allocate every frame.
+
+        //! \brief Per resource flags, if it was written or is needed.
+        std::vector<bool> m_written;
+        //! \brief Per resource flags, if it has incoherent writes.
+        std::vector<bool> m_dirty;
+        //! \brief Per resource barriers issued since the last incoherent write.
+        std::vector<gfx_barrier_bit> m_visible;
+        //! \brief The transient textures ordered by their first use.
+        std::vector<int32> m_transients;
+        //! \brief The last use of each physical texture.
+        std::vector<int32> m_physical_last_use;
+        //! \brief Per pooled texture flags, if it is taken by the compiled graph.
+        std::vector<bool> m_pool_taken;
+        //! \brief The pool for the next frame, swapped with \a m_texture_pool.
+        std::vector<physical_texture> m_next_pool;
+        //! \brief The color targets cleared before a pass.
+        std::vector<gfx_handle<const gfx_texture>> m_clear_targets;
+    };
+} // namespace mango
+
+#endif // MANGO_RENDER_GRAPH_HPP
@@ -29,6 +29,14 @@ namespace mango
 #define CUBEMAP_DATA_BUFFER_BINDING_POINT 3
     //! \brief The binding point for the \a fxaa_data buffer.
 #define FXAA_DATA_BUFFER_BINDING_POINT 1
+    //! \brief The binding point for the \a punctual_light_data storage buffer.
+#define PUNCTUAL_LIGHT_BUFFER_BINDING_POINT 7
+    //! \brief The binding point for the light cluster storage buffer.
+#define LIGHT_CLUSTER_BUFFER_BINDING_POINT 8
+    //! \brief The binding point for the light index storage buffer.
+#define LIGHT_INDEX_BUFFER_BINDING_POINT 9
+    //! \brief The binding point for the hierarchical depth readback storage buffer.
+#define HI_Z_READBACK_BUFFER_BINDING_POINT 10
 
     //! \brief The vertex input binding point for the position vertex attribute.
 #define VERTEX_INPUT_POSITION 0
@@ -89,6 +97,13 @@ namespace mango
     //! \brief The image binding point for the output target color hdr attachment to compute the average luminance for.
 #define HDR_IMAGE_LUMINANCE_COMPUTE 0
 
+    //! \brief The sampler and texture binding point for the depth buffer to build the hierarchical depth from.
+#define HI_Z_DEPTH_SAMPLER 0
+    //! \brief The image binding point for the hierarchical depth level to reduce.
+#define HI_Z_IMAGE_SOURCE 1
+    //! \brief The image binding point for the hierarchical depth level to write.
+#define HI_Z_IMAGE_DESTINATION 2
+
 } // namespace mango
 
 #endif // MANGO_RENDERER_BINDINGS_HPP
\ No newline at end of file
@@ -5,22 +5,26 @@
 //! \copyright Apache License 2.0
 
 #include <graphics/graphics.hpp>
+#include <mango/profile.hpp>
 #include <rendering/renderer_pipeline_cache.hpp>
 
 using namespace mango;
 
-gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_opaque(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool wireframe, bool double_sided)
+gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_opaque(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool wireframe, bool double_sided,
+                                                                    bool multi_draw)
 {
+    MANGO_ASSERT(!multi_draw || m_has_opaque_multi_draw_base, "No multi draw base for opaque geometry set!");
     pipeline_key key;
-    key.vid       = geo_vid;
-    key.iad       = geo_iad;
-    key.wireframe = wireframe;
+    key.vid          = geo_vid;
+    key.iad          = geo_iad;
+    key.wireframe    = wireframe;
     key.double_sided = double_sided;
-    auto it       = m_opaque_cache.find(key);
+    key.multi_draw   = multi_draw;
+    auto it          = m_opaque_cache.find(key);
     if (it != m_opaque_cache.end())
         return it->second;
 
-    auto create_info = m_opaque_create_info;
+    auto create_info = multi_draw ? m_opaque_multi_draw_create_info : m_opaque_create_info;
 
     create_info.vertex_input_state   = geo_vid;
     create_info.input_assembly_state = geo_iad;
@@ -45,6 +49,7 @@ gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_transparent(const ve
     key.iad       = geo_iad;
     key.wireframe = wireframe;
     key.double_sided = double_sided;
+    key.multi_draw   = false;
     auto it       = m_transparent_cache.find(key);
     if (it != m_transparent_cache.end())
         return it->second;
@@ -67,18 +72,20 @@ gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_transparent(const ve
     return created_pipeline;
 }
 
-gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_shadow(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool double_sided)
+gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_shadow(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool double_sided, bool multi_draw)
 {
+    MANGO_ASSERT(!multi_draw || m_has_shadow_multi_draw_base, "No multi draw base for shadow pass geometry set!");
     pipeline_key key;
-    key.vid       = geo_vid;
-    key.iad       = geo_iad;
-    key.wireframe = false;
+    key.vid          = geo_vid;
+    key.iad          = geo_iad;
+    key.wireframe    = false;
     key.double_sided = double_sided;
-    auto it       = m_shadow_cache.find(key);
+    key.multi_draw   = multi_draw;
+    auto it          = m_shadow_cache.find(key);
     if (it != m_shadow_cache.end())
         return it->second;
 
-    auto create_info = m_shadow_create_info;
+    auto create_info = multi_draw ? m_shadow_multi_draw_create_info : m_shadow_create_info;
 
     create_info.vertex_input_state   = geo_vid;
     create_info.input_assembly_state = geo_iad;
@@ -92,4 +99,41 @@ gfx_handle<const gfx_pipeline> renderer_pipeline_cache::get_shadow(const vertex_
     m_shadow_cache.insert({ key, created_pipeline });
 
     return created_pipeline;
-}
\ No newline at end of file
+}
+
+void renderer_pipeline_cache::prewarm(const std::vector<geometry_layout>& layouts)
+{
+    PROFILE_ZONE;
+    for (const geometry_layout& layout : layouts)
+    {
+        pipeline_key key;
+        key.vid          = layout.vertex_layout;
+        key.iad          = layout.input_assembly;
+        key.wireframe    = false;
+        key.double_sided = false;
+        key.multi_draw   = false;
+        m_prewarmed_layouts.insert(key);
+    }
+
+    // pipelines already cached are only looked up, shaders of new ones start compiling on creation.
+    for (const pipeline_key& key : m_prewarmed_layouts)
+    {
+        for (int32 permutation = 0; permutation < 4; ++permutation)
+        {
+            bool wireframe    = (permutation & 1) != 0;
+            bool double_sided = (permutation & 2) != 0;
+            if (m_has_opaque_base)
+                get_opaque(key.vid, key.iad, wireframe, double_sided, false);
+            if (m_has_opaque_multi_draw_base)
+                get_opaque(key.vid, key.iad, wireframe, double_sided, true);
+            if (m_has_transparent_base)
+                get_transparent(key.vid, key.iad, wireframe, double_sided);
+            if (m_has_shadow_base && !wireframe)
+                get_shadow(key.vid, key.iad, double_sided, false);
+            if (m_has_shadow_multi_draw_base && !wireframe)
+                get_shadow(key.vid, key.iad, double_sided, true);
+        }
+    }
+
+    m_shared_context->get_graphics_device()->wait_for_pipelines();
+}
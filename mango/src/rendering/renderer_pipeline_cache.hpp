@@ -8,6 +8,8 @@
 #define MANGO_RENDERER_PIPELINE_CACHE_HPP
 
 #include <core/context_impl.hpp>
+#include <scene/scene_structures_internal.hpp>
+#include <unordered_set>
 
 namespace mango
 {
@@ -19,7 +21,12 @@ namespace mango
         //! \brief Constructs a new \a renderer_pipeline_cache.
         //! \param[in] context The internally shared context of mango.
         renderer_pipeline_cache(const shared_ptr<context_impl>& context)
-            : m_shared_context(context){};
+            : m_has_opaque_base(false)
+            , m_has_transparent_base(false)
+            , m_has_shadow_base(false)
+            , m_has_opaque_multi_draw_base(false)
+            , m_has_shadow_multi_draw_base(false)
+            , m_shared_context(context){};
 
         ~renderer_pipeline_cache() = default;
 
@@ -28,18 +35,37 @@ namespace mango
         inline void set_opaque_base(const graphics_pipeline_create_info& basic_create_info)
         {
             m_opaque_create_info = basic_create_info;
+            m_has_opaque_base    = true;
         }
         //! \brief Sets a \a graphics_pipeline_create_info as base for graphics \a gfx_pipelines for transparent geometry.
         //! \param[in] basic_create_info The \a graphics_pipeline_create_info to set.
         inline void set_transparent_base(const graphics_pipeline_create_info& basic_create_info)
         {
             m_transparent_create_info = basic_create_info;
+            m_has_transparent_base    = true;
         }
         //! \brief Sets a \a graphics_pipeline_create_info as base for graphics \a gfx_pipelines for shadow pass geometry.
         //! \param[in] basic_create_info The \a graphics_pipeline_create_info to set.
         inline void set_shadow_base(const graphics_pipeline_create_info& basic_create_info)
         {
             m_shadow_create_info = basic_create_info;
+            m_has_shadow_base    = true;
+        }
+
+        //! \brief Sets a \a graphics_pipeline_create_info as base for graphics \a gfx_pipelines for opaque geometry drawn with multi draw indirect.
+        //! \param[in] basic_create_info The \a graphics_pipeline_create_info to set.
+        inline void set_opaque_multi_draw_base(const graphics_pipeline_create_info& basic_create_info)
+        {
+            m_opaque_multi_draw_create_info = basic_create_info;
+            m_has_opaque_multi_draw_base    = true;
+        }
+
+        //! \brief Sets a \a graphics_pipeline_create_info as base for graphics \a gfx_pipelines for shadow pass geometry drawn with multi draw indirect.
+        //! \param[in] basic_create_info The \a graphics_pipeline_create_info to set.
+        inline void set_shadow_multi_draw_base(const graphics_pipeline_create_info& basic_create_info)
+        {
+            m_shadow_multi_draw_create_info = basic_create_info;
+            m_has_shadow_multi_draw_base    = true;
         }
 
         //! \brief Gets a graphics \a gfx_pipeline for opaque geometry.
@@ -47,8 +73,9 @@ namespace mango
         //! \param[in] geo_iad The \a input_assembly_dedscriptor of the geometry.
         //! \param[in] wireframe True if the pipeline should render wireframe, else false.
         //! \param[in] double_sided True if the pipeline should render double sided, else false.
+        //! \param[in] multi_draw True if the pipeline is used with multi draw indirect, else false.
         //! \return A \a gfx_handle of a \a gfx_pipeline to use for rendering opaque geometry.
-        gfx_handle<const gfx_pipeline> get_opaque(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool wireframe, bool double_sided);
+        gfx_handle<const gfx_pipeline> get_opaque(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool wireframe, bool double_sided, bool multi_draw);
         //! \brief Gets a graphics \a gfx_pipeline for transparent geometry.
         //! \param[in] geo_vid The \a vertex_input_descriptor of the geometry.
         //! \param[in] geo_iad The \a input_assembly_dedscriptor of the geometry.
@@ -60,8 +87,15 @@ namespace mango
         //! \param[in] geo_vid The \a vertex_input_descriptor of the geometry.
         //! \param[in] geo_iad The \a input_assembly_dedscriptor of the geometry.
         //! \param[in] double_sided True if the pipeline should render double sided, else false.
+        //! \param[in] multi_draw True if the pipeline is used with multi draw indirect, else false.
         //! \return A \a gfx_handle of a \a gfx_pipeline to use for rendering shadow pass geometry.
-        gfx_handle<const gfx_pipeline> get_shadow(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool double_sided);
+        gfx_handle<const gfx_pipeline> get_shadow(const vertex_input_descriptor& geo_vid, const input_assembly_descriptor& geo_iad, bool double_sided, bool multi_draw);
+
+        //! \brief Creates the \a gfx_pipelines of all permutations for some \a geometry_layouts, so drawing the geometry does not create pipelines.
+        //! \details The layouts are remembered, every call creates the missing permutations for all bases set so far.
+        //! Waits until the shaders of all pipelines are ready.
+        //! \param[in] layouts The \a geometry_layouts to create the \a gfx_pipelines for.
+        void prewarm(const std::vector<geometry_layout>& layouts);
 
       private:
         //! \brief Key for caching \a gfx_pipelines.
@@ -75,6 +109,8 @@ namespace mango
             bool wireframe;
             //! \brief True if the pipeline should render double sided, else false.
             bool double_sided;
+            //! \brief True if the pipeline is used with multi draw indirect, else false.
+            bool multi_draw;
 
             //! \brief Comparison operator equal.
             //! \param[in] other The other \a pipeline_key.
@@ -85,6 +121,8 @@ namespace mango
                     return false;
                 if (double_sided != other.double_sided)
                     return false;
+                if (multi_draw != other.multi_draw)
+                    return false;
 
                 if (vid.binding_description_count != other.vid.binding_description_count)
                     return false;
@@ -136,6 +174,7 @@ namespace mango
 
                 res = res * 31 + std::hash<bool>()(k.wireframe);
                 res = res * 31 + std::hash<bool>()(k.double_sided);
+                res = res * 31 + std::hash<bool>()(k.multi_draw);
                 res = res * 31 + std::hash<int32>()(k.vid.binding_description_count);
                 res = res * 31 + std::hash<uint8>()(static_cast<uint8>(k.iad.topology));
 
@@ -166,6 +205,24 @@ namespace mango
         //! \brief The \a graphics_pipeline_create_info used as base for creating \a gfx_pipelines rendering shadow pass geometry.
         graphics_pipeline_create_info m_shadow_create_info;
 
+        //! \brief The \a graphics_pipeline_create_info used as base for creating \a gfx_pipelines rendering opaque geometry with multi draw indirect.
+        graphics_pipeline_create_info m_opaque_multi_draw_create_info;
+        //! \brief The \a graphics_pipeline_create_info used as base for creating \a gfx_pipelines rendering shadow pass geometry with multi draw indirect.
+        graphics_pipeline_create_info m_shadow_multi_draw_create_info;
+        //! \brief True if the base for opaque geometry is set, else false.
+        bool m_has_opaque_base;
+        //! \brief True if the base for transparent geometry is set, else false.
+        bool m_has_transparent_base;
+        //! \brief True if the base for shadow pass geometry is set, else false.
+        bool m_has_shadow_base;
+        //! \brief True if the base for opaque geometry drawn with multi draw indirect is set, else false.
+        bool m_has_opaque_multi_draw_base;
+        //! \brief True if the base for shadow pass geometry drawn with multi draw indirect is set, else false.
+        bool m_has_shadow_multi_draw_base;
+
+        //! \brief The layouts \a gfx_pipelines got prewarmed for, stored as \a pipeline_keys without wireframe, double sided rendering and multi draw.
+        std::unordered_set<pipeline_key, pipeline_key_hash> m_prewarmed_layouts;
+
         //! \brief The cache mapping \a pipeline_keys to \a gfx_pipelines of rendering opaque geometry.
         std::unordered_map<pipeline_key, gfx_handle<const gfx_pipeline>, pipeline_key_hash> m_opaque_cache;
         //! \brief The cache mapping \a pipeline_keys to \a gfx_pipelines of rendering transparent geometry.
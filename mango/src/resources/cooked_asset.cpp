@@ -0,0 +1,963 @@
+//! \file      cooked_asset.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <graphics/graphics.hpp>
+#include <mango/log.hpp>
+#include <mango/profile.hpp>
+#include <resources/cooked_asset.hpp>
+#include <sys/stat.h>
+#include <thread>
+
+using namespace mango;
+
+namespace
+{
+    //! \brief Magic number at the start of each cooked asset.
+    const uint32 cooked_magic = 0x4b434e4d; // "MNCK"
+    //! \brief Alignment of each blob in a cooked asset.
+    const int64 cooked_blob_alignment = 16;
+
+    //! \brief The type of a cooked asset.
+    enum class cooked_asset_type : uint32
+    {
+        image = 1,
+        model = 2
+    };
+
+    //! \brief The header at the start of each cooked asset.
+    struct cooked_header
+    {
+        uint32 magic;
+        uint32 version;
+        cooked_asset_type type;
+        uint32 flags;
+        uint64 source_size;
+        int64 source_modification_time;
+        uint64 dependencies_offset;
+        uint64 dependencies_size;
+        uint64 description_offset;
+        uint64 description_size;
+        uint64 blob_table_offset;
+        uint64 blob_count;
+    };
+
+    //! \brief An entry in the blob table of a cooked asset.
+    struct cooked_blob
+    {
+        uint64 offset;
+        uint64 size;
+    };
+
+    //! \brief Serializes values into a byte array.
+    class binary_writer
+    {
+      public:
+        template <typename T>
+        void write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written!");
+            const uint8* bytes = reinterpret_cast<const uint8*>(&value);
+            m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+        }
+
+        void write_string(const string& value)
+        {
+            write(static_cast<uint32>(value.size()));
+            m_data.insert(m_data.end(), value.begin(), value.end());
+        }
+
+        template <typename T>
+        void write_vector(const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written!");
+            write(static_cast<uint32>(values.size()));
+            const uint8* bytes = reinterpret_cast<const uint8*>(values.data());
+            m_data.insert(m_data.end(), bytes, bytes + values.size() * sizeof(T));
+        }
+
+        const std::vector<uint8>& data() const
+        {
+            return m_data;
+        }
+
+      private:
+        std::vector<uint8> m_data;
+    };
+
+    //! \brief Deserializes values from a byte array. Reading past the end fails the reader and returns default values.
+    class binary_reader
+    {
+      public:
+        binary_reader(const uint8* data, int64 size)
+            : m_current(data)
+            , m_end(data + size)
+            , m_failed(false)
+        {
+        }
+
+        template <typename T>
+        T read()
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read!");
+            T value = T();
+            if (!check(sizeof(T)))
+                return value;
+            std::memcpy(&value, m_current, sizeof(T));
+            m_current += sizeof(T);
+            return value;
+        }
+
+        string read_string()
+        {
+            uint32 size = read<uint32>();
+            if (!check(size))
+                return string();
+            string value(reinterpret_cast<const char*>(m_current), size);
+            m_current += size;
+            return value;
+        }
+
+        uint32 read_count()
+        {
+            // every element needs at least one byte, this prevents huge allocations for corrupt files.
+            uint32 count = read<uint32>();
+            if (!check(count))
+                return 0;
+            return count;
+        }
+
+        template <typename T>
+        std::vector<T> read_vector()
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read!");
+            uint32 count = read<uint32>();
+            if (!check(static_cast<int64>(count) * sizeof(T)))
+                return std::vector<T>();
+            std::vector<T> values(count);
+            std::memcpy(values.data(), m_current, count * sizeof(T));
+            m_current += count * sizeof(T);
+            return values;
+        }
+
+        bool failed() const
+        {
+            return m_failed;
+        }
+
+      private:
+        bool check(int64 size)
+        {
+            if (m_failed || size > m_end - m_current)
+                m_failed = true;
+            return !m_failed;
+        }
+
+        const uint8* m_current;
+        const uint8* m_end;
+        bool m_failed;
+    };
+
+    //! \brief A blob to write into a cooked asset.
+    struct blob_source
+    {
+        const void* data;
+        int64 size;
+    };
+
+    void stamp_dependency(cooked_dependency& dependency)
+    {
+        cooked_source_stamp stamp;
+        if (!get_cooked_source_stamp(dependency.path, 0, stamp))
+        {
+            // a missing file is recorded as well, so the asset is cooked again once it exists.
+            dependency.size              = std::numeric_limits<uint64>::max();
+            dependency.modification_time = 0;
+            return;
+        }
+        dependency.size              = stamp.size;
+        dependency.modification_time = stamp.modification_time;
+    }
+
+    string decode_uri(const string& uri)
+    {
+        string decoded;
+        decoded.reserve(uri.size());
+        for (size_t i = 0; i < uri.size(); ++i)
+        {
+            if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(static_cast<unsigned char>(uri[i + 1])) && std::isxdigit(static_cast<unsigned char>(uri[i + 2])))
+            {
+                decoded.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+                i += 2;
+            }
+            else
+                decoded.push_back(uri[i]);
+        }
+        return decoded;
+    }
+
+    int64 align_offset(int64 offset)
+    {
+        return (offset + cooked_blob_alignment - 1) & ~(cooked_blob_alignment - 1);
+    }
+
+    bool write_cooked_file(const string& cooked_path, cooked_asset_type type, const cooked_source_stamp& stamp, const std::vector<cooked_dependency>& dependencies,
+                           const binary_writer& description, const std::vector<blob_source>& blobs)
+    {
+        PROFILE_ZONE;
+
+        binary_writer dependency_table;
+        dependency_table.write(static_cast<uint32>(dependencies.size()));
+        for (const cooked_dependency& dependency : dependencies)
+        {
+            dependency_table.write_string(dependency.path);
+            dependency_table.write(dependency.size);
+            dependency_table.write(dependency.modification_time);
+        }
+
+        cooked_header header;
+        header.magic                    = cooked_magic;
+        header.version                  = cooked_asset_version;
+        header.type                     = type;
+        header.flags                    = stamp.flags;
+        header.source_size              = stamp.size;
+        header.source_modification_time = stamp.modification_time;
+        header.dependencies_offset      = sizeof(cooked_header);
+        header.dependencies_size        = dependency_table.data().size();
+        header.description_offset       = header.dependencies_offset + header.dependencies_size;
+        header.description_size         = description.data().size();
+        header.blob_table_offset        = header.description_offset + header.description_size;
+        header.blob_count               = blobs.size();
+
+        std::vector<cooked_blob> table(blobs.size());
+        int64 offset = align_offset(static_cast<int64>(header.blob_table_offset + blobs.size() * sizeof(cooked_blob)));
+        for (int32 i = 0; i < static_cast<int32>(blobs.size()); ++i)
+        {
+            table[i].offset = static_cast<uint64>(offset);
+            table[i].size   = static_cast<uint64>(blobs[i].size);
+            offset          = align_offset(offset + blobs[i].size);
+        }
+
+        // write to a temporary file first, so other loaders never map a partially written asset.
+        string temporary_path = cooked_path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream output(temporary_path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!output.is_open())
+                return false;
+
+            const char padding[cooked_blob_alignment] = {};
+            output.write(reinterpret_cast<const char*>(&header), sizeof(cooked_header));
+            output.write(reinterpret_cast<const char*>(dependency_table.data().data()), static_cast<std::streamsize>(dependency_table.data().size()));
+            output.write(reinterpret_cast<const char*>(description.data().data()), static_cast<std::streamsize>(description.data().size()));
+            output.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(cooked_blob)));
+            int64 written = static_cast<int64>(header.blob_table_offset + table.size() * sizeof(cooked_blob));
+            for (int32 i = 0; i < static_cast<int32>(blobs.size()); ++i)
+            {
+                output.write(padding, static_cast<std::streamsize>(static_cast<int64>(table[i].offset) - written));
+                output.write(static_cast<const char*>(blobs[i].data), static_cast<std::streamsize>(blobs[i].size));
+                written = static_cast<int64>(table[i].offset) + blobs[i].size;
+            }
+
+            if (!output.good())
+            {
+                output.close();
+                std::remove(temporary_path.c_str());
+                return false;
+            }
+        }
+
+        std::remove(cooked_path.c_str());
+        if (std::rename(temporary_path.c_str(), cooked_path.c_str()) != 0)
+        {
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+
+        MANGO_LOG_DEBUG("Cooked asset written to {0}.", cooked_path);
+        return true;
+    }
+
+    bool read_cooked_file(const mapped_file& file, cooked_asset_type type, const cooked_source_stamp& stamp, const uint8*& description, int64& description_size,
+                          std::vector<const uint8*>& blob_data, std::vector<int64>& blob_sizes)
+    {
+        uint64 file_size = static_cast<uint64>(file.size());
+        if (!file.is_open() || file_size < sizeof(cooked_header))
+            return false;
+
+        cooked_header header;
+        std::memcpy(&header, file.data(), sizeof(cooked_header));
+        if (header.magic != cooked_magic || header.version != cooked_asset_version || header.type != type)
+            return false;
+        if (header.flags != stamp.flags || header.source_size != stamp.size || header.source_modification_time != stamp.modification_time)
+            return false;
+        if (header.dependencies_offset > file_size || header.dependencies_size > file_size - header.dependencies_offset)
+            return false;
+        if (header.description_offset > file_size || header.description_size > file_size - header.description_offset)
+            return false;
+
+        binary_reader dependency_table(file.data() + header.dependencies_offset, static_cast<int64>(header.dependencies_size));
+        uint32 dependency_count = dependency_table.read_count();
+        for (uint32 i = 0; i < dependency_count; ++i)
+        {
+            cooked_dependency recorded;
+            recorded.path              = dependency_table.read_string();
+            recorded.size              = dependency_table.read<uint64>();
+            recorded.modification_time = dependency_table.read<int64>();
+            if (dependency_table.failed())
+                return false;
+
+            cooked_dependency current = { recorded.path, 0, 0 };
+            stamp_dependency(current);
+            if (current.size != recorded.size || current.modification_time != recorded.modification_time)
+                return false;
+        }
+
+        if (header.blob_table_offset > file_size || header.blob_count > (file_size - header.blob_table_offset) / sizeof(cooked_blob))
+            return false;
+
+        description      = file.data() + header.description_offset;
+        description_size = static_cast<int64>(header.description_size);
+
+        blob_data.resize(header.blob_count);
+        blob_sizes.resize(header.blob_count);
+        for (uint64 i = 0; i < header.blob_count; ++i)
+        {
+            cooked_blob blob;
+            std::memcpy(&blob, file.data() + header.blob_table_offset + i * sizeof(cooked_blob), sizeof(cooked_blob));
+            if (blob.offset > file_size || blob.size > file_size - blob.offset)
+                return false;
+            blob_data[i]  = blob.size > 0 ? file.data() + blob.offset : nullptr;
+            blob_sizes[i] = static_cast<int64>(blob.size);
+        }
+
+        return true;
+    }
+
+    float srgb_to_linear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float linear_to_srgb(float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    float load_component(const uint8* source, int32 component_size, bool is_float, bool to_linear)
+    {
+        float value;
+        if (is_float)
+        {
+            std::memcpy(&value, source, sizeof(float));
+            return value;
+        }
+        if (component_size == 2)
+        {
+            uint16 v;
+            std::memcpy(&v, source, sizeof(uint16));
+            value = static_cast<float>(v) / 65535.0f;
+        }
+        else
+            value = static_cast<float>(*source) / 255.0f;
+
+        return to_linear ? srgb_to_linear(value) : value;
+    }
+
+    void store_component(uint8* target, float value, int32 component_size, bool is_float, bool to_srgb)
+    {
+        if (is_float)
+        {
+            std::memcpy(target, &value, sizeof(float));
+            return;
+        }
+        value = std::max(0.0f, std::min(1.0f, to_srgb ? linear_to_srgb(value) : value));
+        if (component_size == 2)
+        {
+            uint16 v = static_cast<uint16>(value * 65535.0f + 0.5f);
+            std::memcpy(target, &v, sizeof(uint16));
+        }
+        else
+            *target = static_cast<uint8>(value * 255.0f + 0.5f);
+    }
+
+    void downsample_level(const uint8* source, int32 source_width, int32 source_height, uint8* target, int32 target_width, int32 target_height, int32 components, int32 component_size,
+                          bool is_float, bool standard_color_space)
+    {
+        int64 pixel_size = static_cast<int64>(components) * component_size;
+        for (int32 y = 0; y < target_height; ++y)
+        {
+            int32 y0 = std::min(y * 2, source_height - 1);
+            int32 y1 = std::min(y * 2 + 1, source_height - 1);
+            for (int32 x = 0; x < target_width; ++x)
+            {
+                int32 x0 = std::min(x * 2, source_width - 1);
+                int32 x1 = std::min(x * 2 + 1, source_width - 1);
+
+                const uint8* p00 = source + (static_cast<int64>(y0) * source_width + x0) * pixel_size;
+                const uint8* p01 = source + (static_cast<int64>(y0) * source_width + x1) * pixel_size;
+                const uint8* p10 = source + (static_cast<int64>(y1) * source_width + x0) * pixel_size;
+                const uint8* p11 = source + (static_cast<int64>(y1) * source_width + x1) * pixel_size;
+                uint8* t         = target + (static_cast<int64>(y) * target_width + x) * pixel_size;
+
+                for (int32 c = 0; c < components; ++c)
+                {
+                    // alpha is always stored linear.
+                    bool srgb    = standard_color_space && components >= 3 && c < 3;
+                    int64 offset = static_cast<int64>(c) * component_size;
+                    float sum    = load_component(p00 + offset, component_size, is_float, srgb) + load_component(p01 + offset, component_size, is_float, srgb) +
+                                load_component(p10 + offset, component_size, is_float, srgb) + load_component(p11 + offset, component_size, is_float, srgb);
+                    store_component(t + offset, sum * 0.25f, component_size, is_float, srgb);
+                }
+            }
+        }
+    }
+
+    void write_texture_info(binary_writer& writer, int32 index, int32 tex_coord)
+    {
+        writer.write(index);
+        writer.write(tex_coord);
+    }
+} // namespace
+
+string mango::get_cooked_path(const string& source_path)
+{
+    return source_path + ".cooked";
+}
+
+bool mango::get_cooked_source_stamp(const string& source_path, uint32 flags, cooked_source_stamp& stamp)
+{
+    struct stat info;
+    if (stat(source_path.c_str(), &info) != 0)
+        return false;
+
+    stamp.size              = static_cast<uint64>(info.st_size);
+    stamp.modification_time = static_cast<int64>(info.st_mtime);
+    stamp.flags             = flags;
+    return true;
+}
+
+std::vector<cooked_dependency> mango::get_cooked_model_dependencies(const string& source_path, const tinygltf::Model& model)
+{
+    string directory = source_path.substr(0, source_path.find_last_of("/\\") + 1);
+
+    std::vector<cooked_dependency> dependencies;
+    auto add_dependency = [&directory, &dependencies](const string& uri)
+    {
+        // data uris are embedded in the source file.
+        if (uri.empty() || uri.compare(0, 5, "data:") == 0)
+            return;
+        cooked_dependency dependency = { directory + decode_uri(uri), 0, 0 };
+        for (const cooked_dependency& d : dependencies)
+        {
+            if (d.path == dependency.path)
+                return;
+        }
+        stamp_dependency(dependency);
+        dependencies.push_back(dependency);
+    };
+
+    for (const tinygltf::Buffer& buffer : model.buffers)
+        add_dependency(buffer.uri);
+    for (const tinygltf::Image& image : model.images)
+    {
+        if (image.bufferView < 0)
+            add_dependency(image.uri);
+    }
+
+    return dependencies;
+}
+
+int64 mango::get_image_level_size(const image_resource& img, int32 level)
+{
+    int64 width          = std::max(1, img.width >> level);
+    int64 height         = std::max(1, img.height >> level);
+    int64 component_size = img.description.is_hdr ? static_cast<int64>(sizeof(float)) : img.bits / 8;
+    return width * height * img.number_components * component_size;
+}
+
+int32 mango::generate_mip_chain(const image_resource& img, bool standard_color_space, std::vector<uint8>& chain)
+{
+    PROFILE_ZONE;
+    int32 levels = graphics::calculate_mip_count(img.width, img.height);
+
+    int64 chain_size = 0;
+    for (int32 level = 0; level < levels; ++level)
+        chain_size += get_image_level_size(img, level);
+    chain.resize(static_cast<size_t>(chain_size));
+
+    const uint8* source = static_cast<const uint8*>(img.data);
+    std::copy(source, source + get_image_level_size(img, 0), chain.data());
+
+    bool is_float        = img.description.is_hdr;
+    int32 component_size = is_float ? static_cast<int32>(sizeof(float)) : img.bits / 8;
+    int64 offset         = 0;
+    for (int32 level = 1; level < levels; ++level)
+    {
+        int64 next_offset = offset + get_image_level_size(img, level - 1);
+        downsample_level(chain.data() + offset, std::max(1, img.width >> (level - 1)), std::max(1, img.height >> (level - 1)), chain.data() + next_offset, std::max(1, img.width >> level),
+                         std::max(1, img.height >> level), img.number_components, component_size, is_float, standard_color_space);
+        offset = next_offset;
+    }
+
+    return levels;
+}
+
+bool mango::write_cooked_image(const string& cooked_path, const cooked_source_stamp& stamp, const image_resource& img)
+{
+    binary_writer description;
+    description.write(img.width);
+    description.write(img.height);
+    description.write(img.number_components);
+    description.write(img.bits);
+    description.write(img.mip_levels);
+
+    int64 size = 0;
+    for (int32 level = 0; level < img.mip_levels; ++level)
+        size += get_image_level_size(img, level);
+
+    return write_cooked_file(cooked_path, cooked_asset_type::image, stamp, {}, description, { { img.data, size } });
+}
+
+bool mango::read_cooked_image(const mapped_file& file, const cooked_source_stamp& stamp, image_resource& img)
+{
+    const uint8* description_data = nullptr;
+    int64 description_size        = 0;
+    std::vector<const uint8*> blob_data;
+    std::vector<int64> blob_sizes;
+    if (!read_cooked_file(file, cooked_asset_type::image, stamp, description_data, description_size, blob_data, blob_sizes) || blob_data.size() != 1)
+        return false;
+
+    binary_reader description(description_data, description_size);
+    img.width             = description.read<int32>();
+    img.height            = description.read<int32>();
+    img.number_components = description.read<int32>();
+    img.bits              = description.read<int32>();
+    img.mip_levels        = description.read<int32>();
+    if (description.failed() || img.width <= 0 || img.height <= 0 || img.mip_levels <= 0)
+        return false;
+
+    int64 size = 0;
+    for (int32 level = 0; level < img.mip_levels; ++level)
+        size += get_image_level_size(img, level);
+    if (size != blob_sizes[0])
+        return false;
+
+    img.data = const_cast<uint8*>(blob_data[0]);
+    return true;
+}
+
+void mango::calculate_missing_bounds(tinygltf::Model& model)
+{
+    PROFILE_ZONE;
+    for (const tinygltf::Mesh& t_mesh : model.meshes)
+    {
+        for (const tinygltf::Primitive& t_primitive : t_mesh.primitives)
+        {
+            auto position = t_primitive.attributes.find("POSITION");
+            if (position == t_primitive.attributes.end() || position->second < 0 || position->second >= static_cast<int32>(model.accessors.size()))
+                continue;
+
+            tinygltf::Accessor& accessor = model.accessors[position->second];
+            if (accessor.minValues.size() >= 3 && accessor.maxValues.size() >= 3)
+                continue;
+            if (accessor.sparse.isSparse || accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || accessor.type != TINYGLTF_TYPE_VEC3 || accessor.bufferView < 0)
+                continue;
+
+            const tinygltf::BufferView& bv = model.bufferViews[accessor.bufferView];
+            int32 stride                   = accessor.ByteStride(bv);
+            if (stride <= 0 || bv.buffer < 0 || accessor.count == 0)
+                continue;
+
+            const tinygltf::Buffer& buffer = model.buffers[bv.buffer];
+            size_t start                   = bv.byteOffset + accessor.byteOffset;
+            if (start + (accessor.count - 1) * stride + 3 * sizeof(float) > buffer.data.size())
+                continue;
+
+            vec3 min = make_vec3(std::numeric_limits<float>::max());
+            vec3 max = make_vec3(-std::numeric_limits<float>::max());
+            for (size_t i = 0; i < accessor.count; ++i)
+            {
+                float p[3];
+                std::memcpy(p, buffer.data.data() + start + i * stride, sizeof(p));
+                min = min.cwiseMin(vec3(p[0], p[1], p[2]));
+                max = max.cwiseMax(vec3(p[0], p[1], p[2]));
+            }
+
+            accessor.minValues = { min.x(), min.y(), min.z() };
+            accessor.maxValues = { max.x(), max.y(), max.z() };
+        }
+    }
+}
+
+bool mango::write_cooked_model(const string& cooked_path, const cooked_source_stamp& stamp, const std::vector<cooked_dependency>& dependencies, const tinygltf::Model& model)
+{
+    PROFILE_ZONE;
+    binary_writer description;
+    std::vector<blob_source> blobs;
+
+    description.write(static_cast<int32>(model.defaultScene));
+
+    description.write(static_cast<uint32>(model.scenes.size()));
+    for (const tinygltf::Scene& t_scene : model.scenes)
+    {
+        description.write_string(t_scene.name);
+        description.write_vector(t_scene.nodes);
+    }
+
+    description.write(static_cast<uint32>(model.nodes.size()));
+    for (const tinygltf::Node& n : model.nodes)
+    {
+        description.write_string(n.name);
+        description.write(static_cast<int32>(n.mesh));
+        description.write(static_cast<int32>(n.camera));
+        description.write_vector(n.children);
+        description.write_vector(n.matrix);
+        description.write_vector(n.translation);
+        description.write_vector(n.rotation);
+        description.write_vector(n.scale);
+    }
+
+    description.write(static_cast<uint32>(model.meshes.size()));
+    for (const tinygltf::Mesh& t_mesh : model.meshes)
+    {
+        description.write_string(t_mesh.name);
+        description.write(static_cast<uint32>(t_mesh.primitives.size()));
+        for (const tinygltf::Primitive& t_primitive : t_mesh.primitives)
+        {
+            description.write(static_cast<uint32>(t_primitive.attributes.size()));
+            for (auto& attrib : t_primitive.attributes)
+            {
+                description.write_string(attrib.first);
+                description.write(static_cast<int32>(attrib.second));
+            }
+            description.write(static_cast<int32>(t_primitive.indices));
+            description.write(static_cast<int32>(t_primitive.material));
+            description.write(static_cast<int32>(t_primitive.mode));
+        }
+    }
+
+    // only buffer views used by accessors are stored, views for encoded images are not needed anymore.
+    std::vector<bool> referenced(model.bufferViews.size(), false);
+    description.write(static_cast<uint32>(model.accessors.size()));
+    for (const tinygltf::Accessor& accessor : model.accessors)
+    {
+        description.write(static_cast<int32>(accessor.bufferView));
+        description.write(static_cast<uint64>(accessor.byteOffset));
+        description.write(static_cast<int32>(accessor.componentType));
+        description.write(static_cast<uint64>(accessor.count));
+        description.write(static_cast<int32>(accessor.type));
+        description.write(static_cast<uint8>(accessor.normalized));
+        description.write(static_cast<uint8>(accessor.sparse.isSparse));
+        description.write_vector(accessor.minValues);
+        description.write_vector(accessor.maxValues);
+
+        if (accessor.bufferView >= 0 && accessor.bufferView < static_cast<int32>(referenced.size()))
+            referenced[accessor.bufferView] = true;
+    }
+
+    description.write(static_cast<uint32>(model.bufferViews.size()));
+    for (int32 i = 0; i < static_cast<int32>(model.bufferViews.size()); ++i)
+    {
+        const tinygltf::BufferView& bv = model.bufferViews[i];
+        bool valid                     = referenced[i] && bv.buffer >= 0 && bv.buffer < static_cast<int32>(model.buffers.size()) &&
+                     bv.byteOffset + bv.byteLength <= model.buffers[bv.buffer].data.size();
+
+        description.write(static_cast<uint64>(valid ? bv.byteLength : 0));
+        description.write(static_cast<uint64>(bv.byteStride));
+        description.write(static_cast<int32>(bv.target));
+        if (valid)
+            blobs.push_back({ model.buffers[bv.buffer].data.data() + bv.byteOffset, static_cast<int64>(bv.byteLength) });
+        else
+            blobs.push_back({ nullptr, 0 });
+    }
+
+    description.write(static_cast<uint32>(model.materials.size()));
+    for (const tinygltf::Material& t_material : model.materials)
+    {
+        auto& pbr = t_material.pbrMetallicRoughness;
+        description.write_string(t_material.name);
+        description.write_string(t_material.alphaMode);
+        description.write(static_cast<double>(t_material.alphaCutoff));
+        description.write(static_cast<uint8>(t_material.doubleSided));
+        description.write_vector(t_material.emissiveFactor);
+        description.write_vector(pbr.baseColorFactor);
+        description.write(static_cast<double>(pbr.metallicFactor));
+        description.write(static_cast<double>(pbr.roughnessFactor));
+        write_texture_info(description, pbr.baseColorTexture.index, pbr.baseColorTexture.texCoord);
+        write_texture_info(description, pbr.metallicRoughnessTexture.index, pbr.metallicRoughnessTexture.texCoord);
+        write_texture_info(description, t_material.occlusionTexture.index, t_material.occlusionTexture.texCoord);
+        write_texture_info(description, t_material.normalTexture.index, t_material.normalTexture.texCoord);
+        write_texture_info(description, t_material.emissiveTexture.index, t_material.emissiveTexture.texCoord);
+    }
+
+    description.write(static_cast<uint32>(model.textures.size()));
+    for (const tinygltf::Texture& t_texture : model.textures)
+    {
+        description.write(static_cast<int32>(t_texture.source));
+        description.write(static_cast<int32>(t_texture.sampler));
+    }
+
+    description.write(static_cast<uint32>(model.samplers.size()));
+    for (const tinygltf::Sampler& sampler : model.samplers)
+    {
+        description.write(static_cast<int32>(sampler.minFilter));
+        description.write(static_cast<int32>(sampler.magFilter));
+        description.write(static_cast<int32>(sampler.wrapS));
+        description.write(static_cast<int32>(sampler.wrapT));
+    }
+
+    // color textures are filtered in linear space.
+    std::vector<bool> standard_color_space(model.images.size(), false);
+    auto mark_standard_color_space = [&model, &standard_color_space](int32 texture_index)
+    {
+        if (texture_index < 0 || texture_index >= static_cast<int32>(model.textures.size()))
+            return;
+        int32 source = model.textures[texture_index].source;
+        if (source >= 0 && source < static_cast<int32>(standard_color_space.size()))
+            standard_color_space[source] = true;
+    };
+    for (const tinygltf::Material& t_material : model.materials)
+    {
+        mark_standard_color_space(t_material.pbrMetallicRoughness.baseColorTexture.index);
+        mark_standard_color_space(t_material.emissiveTexture.index);
+    }
+
+    std::vector<std::vector<uint8>> mip_chains(model.images.size());
+    description.write(static_cast<uint32>(model.images.size()));
+    for (int32 i = 0; i < static_cast<int32>(model.images.size()); ++i)
+    {
+        const tinygltf::Image& image = model.images[i];
+
+        image_resource img;
+        img.data                                = const_cast<uint8*>(image.image.data());
+        img.width                               = image.width;
+        img.height                              = image.height;
+        img.number_components                   = image.component;
+        img.bits                                = image.bits;
+        img.description.is_standard_color_space = standard_color_space[i];
+        img.description.is_hdr                  = false;
+
+        bool valid = image.width > 0 && image.height > 0 && static_cast<int64>(image.image.size()) >= get_image_level_size(img, 0);
+
+        img.mip_levels = valid ? generate_mip_chain(img, standard_color_space[i], mip_chains[i]) : 0;
+
+        description.write_string(image.name);
+        description.write_string(image.uri);
+        description.write(static_cast<int32>(image.width));
+        description.write(static_cast<int32>(image.height));
+        description.write(static_cast<int32>(image.component));
+        description.write(static_cast<int32>(image.bits));
+        description.write(img.mip_levels);
+        blobs.push_back({ mip_chains[i].data(), static_cast<int64>(mip_chains[i].size()) });
+    }
+
+    description.write(static_cast<uint32>(model.cameras.size()));
+    for (const tinygltf::Camera& t_camera : model.cameras)
+    {
+        description.write_string(t_camera.type);
+        description.write(static_cast<double>(t_camera.perspective.aspectRatio));
+        description.write(static_cast<double>(t_camera.perspective.yfov));
+        description.write(static_cast<double>(t_camera.perspective.zfar));
+        description.write(static_cast<double>(t_camera.perspective.znear));
+        description.write(static_cast<double>(t_camera.orthographic.xmag));
+        description.write(static_cast<double>(t_camera.orthographic.ymag));
+        description.write(static_cast<double>(t_camera.orthographic.zfar));
+        description.write(static_cast<double>(t_camera.orthographic.znear));
+    }
+
+    return write_cooked_file(cooked_path, cooked_asset_type::model, stamp, dependencies, description, blobs);
+}
+
+bool mango::read_cooked_model(const mapped_file& file, const cooked_source_stamp& stamp, model_resource& model)
+{
+    PROFILE_ZONE;
+    const uint8* description_data = nullptr;
+    int64 description_size        = 0;
+    std::vector<const uint8*> blob_data;
+    std::vector<int64> blob_sizes;
+    if (!read_cooked_file(file, cooked_asset_type::model, stamp, description_data, description_size, blob_data, blob_sizes))
+        return false;
+
+    binary_reader description(description_data, description_size);
+    tinygltf::Model& m = model.gltf_model;
+    m                  = tinygltf::Model();
+
+    m.defaultScene = description.read<int32>();
+
+    m.scenes.resize(description.read_count());
+    for (tinygltf::Scene& t_scene : m.scenes)
+    {
+        t_scene.name  = description.read_string();
+        t_scene.nodes = description.read_vector<int>();
+        if (description.failed())
+            return false;
+    }
+
+    m.nodes.resize(description.read_count());
+    for (tinygltf::Node& n : m.nodes)
+    {
+        n.name        = description.read_string();
+        n.mesh        = description.read<int32>();
+        n.camera      = description.read<int32>();
+        n.children    = description.read_vector<int>();
+        n.matrix      = description.read_vector<double>();
+        n.translation = description.read_vector<double>();
+        n.rotation    = description.read_vector<double>();
+        n.scale       = description.read_vector<double>();
+        if (description.failed())
+            return false;
+    }
+
+    m.meshes.resize(description.read_count());
+    for (tinygltf::Mesh& t_mesh : m.meshes)
+    {
+        t_mesh.name = description.read_string();
+        t_mesh.primitives.resize(description.read_count());
+        for (tinygltf::Primitive& t_primitive : t_mesh.primitives)
+        {
+            uint32 attribute_count = description.read_count();
+            for (uint32 i = 0; i < attribute_count && !description.failed(); ++i)
+            {
+                string name                  = description.read_string();
+                t_primitive.attributes[name] = description.read<int32>();
+            }
+            t_primitive.indices  = description.read<int32>();
+            t_primitive.material = description.read<int32>();
+            t_primitive.mode     = description.read<int32>();
+            if (description.failed())
+                return false;
+        }
+    }
+
+    m.accessors.resize(description.read_count());
+    for (tinygltf::Accessor& accessor : m.accessors)
+    {
+        accessor.bufferView      = description.read<int32>();
+        accessor.byteOffset      = static_cast<size_t>(description.read<uint64>());
+        accessor.componentType   = description.read<int32>();
+        accessor.count           = static_cast<size_t>(description.read<uint64>());
+        accessor.type            = description.read<int32>();
+        accessor.normalized      = description.read<uint8>() != 0;
+        accessor.sparse.isSparse = description.read<uint8>() != 0;
+        accessor.minValues       = description.read_vector<double>();
+        accessor.maxValues       = description.read_vector<double>();
+        if (description.failed())
+            return false;
+    }
+
+    // each buffer view is stored in its own blob.
+    m.bufferViews.resize(description.read_count());
+    if (m.bufferViews.size() > blob_data.size())
+        return false;
+    model.buffer_view_data.resize(m.bufferViews.size());
+    for (int32 i = 0; i < static_cast<int32>(m.bufferViews.size()); ++i)
+    {
+        tinygltf::BufferView& bv = m.bufferViews[i];
+        bv.byteOffset            = 0;
+        bv.byteLength            = static_cast<size_t>(description.read<uint64>());
+        bv.byteStride            = static_cast<size_t>(description.read<uint64>());
+        bv.target                = description.read<int32>();
+        if (description.failed() || static_cast<int64>(bv.byteLength) != blob_sizes[i])
+            return false;
+        model.buffer_view_data[i] = blob_data[i];
+    }
+
+    m.materials.resize(description.read_count());
+    for (tinygltf::Material& t_material : m.materials)
+    {
+        auto& pbr                             = t_material.pbrMetallicRoughness;
+        t_material.name                       = description.read_string();
+        t_material.alphaMode                  = description.read_string();
+        t_material.alphaCutoff                = description.read<double>();
+        t_material.doubleSided                = description.read<uint8>() != 0;
+        t_material.emissiveFactor             = description.read_vector<double>();
+        pbr.baseColorFactor                   = description.read_vector<double>();
+        pbr.metallicFactor                    = description.read<double>();
+        pbr.roughnessFactor                   = description.read<double>();
+        pbr.baseColorTexture.index            = description.read<int32>();
+        pbr.baseColorTexture.texCoord         = description.read<int32>();
+        pbr.metallicRoughnessTexture.index    = description.read<int32>();
+        pbr.metallicRoughnessTexture.texCoord = description.read<int32>();
+        t_material.occlusionTexture.index     = description.read<int32>();
+        t_material.occlusionTexture.texCoord  = description.read<int32>();
+        t_material.normalTexture.index        = description.read<int32>();
+        t_material.normalTexture.texCoord     = description.read<int32>();
+        t_material.emissiveTexture.index      = description.read<int32>();
+        t_material.emissiveTexture.texCoord   = description.read<int32>();
+        if (description.failed())
+            return false;
+    }
+
+    m.textures.resize(description.read_count());
+    for (tinygltf::Texture& t_texture : m.textures)
+    {
+        t_texture.source  = description.read<int32>();
+        t_texture.sampler = description.read<int32>();
+    }
+
+    m.samplers.resize(description.read_count());
+    for (tinygltf::Sampler& sampler : m.samplers)
+    {
+        sampler.minFilter = description.read<int32>();
+        sampler.magFilter = description.read<int32>();
+        sampler.wrapS     = description.read<int32>();
+        sampler.wrapT     = description.read<int32>();
+    }
+
+    // image blobs follow the buffer view blobs.
+    m.images.resize(description.read_count());
+    if (m.bufferViews.size() + m.images.size() > blob_data.size())
+        return false;
+    model.images.resize(m.images.size());
+    for (int32 i = 0; i < static_cast<int32>(m.images.size()); ++i)
+    {
+        tinygltf::Image& image = m.images[i];
+        image.name             = description.read_string();
+        image.uri              = description.read_string();
+        image.width            = description.read<int32>();
+        image.height           = description.read<int32>();
+        image.component        = description.read<int32>();
+        image.bits             = description.read<int32>();
+        if (description.failed())
+            return false;
+
+        image_resource& img                     = model.images[i];
+        img.width                               = image.width;
+        img.height                              = image.height;
+        img.number_components                   = image.component;
+        img.bits                                = image.bits;
+        img.mip_levels                          = description.read<int32>();
+        img.description.path                    = image.uri.c_str();
+        img.description.is_standard_color_space = false;
+        img.description.is_hdr                  = false;
+
+        int64 size = 0;
+        for (int32 level = 0; level < img.mip_levels; ++level)
+            size += get_image_level_size(img, level);
+        if (description.failed() || size != blob_sizes[m.bufferViews.size() + i])
+            return false;
+        img.data = const_cast<uint8*>(blob_data[m.bufferViews.size() + i]);
+    }
+
+    m.cameras.resize(description.read_count());
+    for (tinygltf::Camera& t_camera : m.cameras)
+    {
+        t_camera.type                    = description.read_string();
+        t_camera.perspective.aspectRatio = description.read<double>();
+        t_camera.perspective.yfov        = description.read<double>();
+        t_camera.perspective.zfar        = description.read<double>();
+        t_camera.perspective.znear       = description.read<double>();
+        t_camera.orthographic.xmag       = description.read<double>();
+        t_camera.orthographic.ymag       = description.read<double>();
+        t_camera.orthographic.zfar       = description.read<double>();
+        t_camera.orthographic.znear      = description.read<double>();
+    }
+
+    return !description.failed();
+}
@@ -0,0 +1,105 @@
+//! \file      cooked_asset.hpp
+//! This file provides the binary cooked asset format for models and images.
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_COOKED_ASSET_HPP
+#define MANGO_COOKED_ASSET_HPP
+
+#include <mango/resource_structures.hpp>
+#include <util/mapped_file.hpp>
+
+namespace mango
+{
+    //! \brief The version of the cooked asset format. Cooked assets with a different version are cooked again.
+    const uint32 cooked_asset_version = 2;
+
+    //! \brief Identifies the source of a cooked asset. A cooked asset is stale if any of the values differ.
+    struct cooked_source_stamp
+    {
+        uint64 size;             //!< The size of the source file in bytes.
+        int64 modification_time; //!< The last modification time of the source file.
+        uint32 flags;            //!< Flags for loading options changing the cooked data.
+    };
+
+    //! \brief An external file a cooked asset is created from besides its source file. A cooked asset is stale if the file changed.
+    struct cooked_dependency
+    {
+        string path;             //!< The full path of the file.
+        uint64 size;             //!< The size of the file in bytes, the maximum value if the file does not exist.
+        int64 modification_time; //!< The last modification time of the file.
+    };
+
+    //! \brief Returns the path of the cooked asset for a source file.
+    //! \param[in] source_path The full path of the source file.
+    //! \return The full path of the cooked asset.
+    string get_cooked_path(const string& source_path);
+
+    //! \brief Creates the \a cooked_source_stamp for a source file.
+    //! \param[in] source_path The full path of the source file.
+    //! \param[in] flags Flags for loading options changing the cooked data.
+    //! \param[out] stamp The \a cooked_source_stamp of the source file.
+    //! \return True on success, false if the source file does not exist.
+    bool get_cooked_source_stamp(const string& source_path, uint32 flags, cooked_source_stamp& stamp);
+
+    //! \brief Collects the external buffer and image files of a gltf model.
+    //! \details Embedded data is part of the source file and has no dependency.
+    //! \param[in] source_path The full path of the gltf file, uris are relative to its directory.
+    //! \param[in] model The parsed gltf model.
+    //! \return The \a cooked_dependencies of the model with their current size and modification time.
+    std::vector<cooked_dependency> get_cooked_model_dependencies(const string& source_path, const tinygltf::Model& model);
+
+    //! \brief Returns the size of a single mip level of an image.
+    //! \details Mip levels are tightly packed, floating point data is used for images with high dynamic range.
+    //! \param[in] img The \a image_resource.
+    //! \param[in] level The mip level.
+    //! \return The size of the mip level in bytes.
+    int64 get_image_level_size(const image_resource& img, int32 level);
+
+    //! \brief Generates the full mip chain for the first level of an image with a box filter.
+    //! \param[in] img The \a image_resource with the first mip level in its data.
+    //! \param[in] standard_color_space True if the color channels should be filtered in linear space, else false.
+    //! \param[out] chain All mip levels stored one after another.
+    //! \return The number of mip levels in the chain.
+    int32 generate_mip_chain(const image_resource& img, bool standard_color_space, std::vector<uint8>& chain);
+
+    //! \brief Writes a cooked image.
+    //! \param[in] cooked_path The full path of the cooked asset to write.
+    //! \param[in] stamp The \a cooked_source_stamp of the source image.
+    //! \param[in] img The \a image_resource to write, including all mip levels.
+    //! \return True on success, else false.
+    bool write_cooked_image(const string& cooked_path, const cooked_source_stamp& stamp, const image_resource& img);
+
+    //! \brief Reads a cooked image from a mapped file.
+    //! \details The image data points into the mapping, so the \a mapped_file has to stay open as long as the data is used.
+    //! \param[in] file The \a mapped_file of the cooked asset.
+    //! \param[in] stamp The \a cooked_source_stamp of the source image.
+    //! \param[in,out] img The \a image_resource to fill. The description has to be set, since it decides the size of the data.
+    //! \return True on success, false if the cooked asset is invalid or stale.
+    bool read_cooked_image(const mapped_file& file, const cooked_source_stamp& stamp, image_resource& img);
+
+    //! \brief Fills missing position bounds of a gltf model with bounds calculated from the vertex data.
+    //! \param[in,out] model The gltf model.
+    void calculate_missing_bounds(tinygltf::Model& model);
+
+    //! \brief Writes a cooked model.
+    //! \details Stores the node hierarchy, meshes, materials and cameras together with the data of each buffer view referenced by an accessor and the mip chain of each image.
+    //! \param[in] cooked_path The full path of the cooked asset to write.
+    //! \param[in] stamp The \a cooked_source_stamp of the source model.
+    //! \param[in] dependencies The \a cooked_dependencies of the source model.
+    //! \param[in] model The gltf model to write. Position bounds are expected to be complete.
+    //! \return True on success, else false.
+    bool write_cooked_model(const string& cooked_path, const cooked_source_stamp& stamp, const std::vector<cooked_dependency>& dependencies, const tinygltf::Model& model);
+
+    //! \brief Reads a cooked model from a mapped file.
+    //! \details The buffer view and image data of the \a model_resource point into the mapping, so the \a mapped_file has to stay open as long as the data is used.
+    //! \param[in] file The \a mapped_file of the cooked asset.
+    //! \param[in] stamp The \a cooked_source_stamp of the source model.
+    //! \param[out] model The \a model_resource to fill. Image paths point into the model, so it has to be filled in place.
+    //! \return True on success, false if the cooked asset is invalid or stale, including changes of its dependencies.
+    bool read_cooked_model(const mapped_file& file, const cooked_source_stamp& stamp, model_resource& model);
+} // namespace mango
+
+#endif // MANGO_COOKED_ASSET_HPP
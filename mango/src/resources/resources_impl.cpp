@@ -6,6 +6,7 @@
 
 #include <mango/log.hpp>
 #include <mango/profile.hpp>
+#include <resources/cooked_asset.hpp>
 #include <resources/resources_impl.hpp>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -19,30 +20,70 @@
 
 using namespace mango;
 
+namespace
+{
+    //! \brief Returns the number of data bytes held by an \a image_resource.
+    //! \param[in] img The \a image_resource.
+    //! \return The size of all mip levels in bytes.
+    int64 get_resource_size(const image_resource& img)
+    {
+        int64 size = 0;
+        for (int32 level = 0; level < img.mip_levels; ++level)
+            size += get_image_level_size(img, level);
+        return size;
+    }
+
+    //! \brief Returns the number of data bytes held by a \a model_resource.
+    //! \param[in] m The \a model_resource.
+    //! \return The size of the mapped cooked model or the size of all parsed buffers and images in bytes.
+    int64 get_resource_size(const model_resource& m)
+    {
+        if (m.cooked_mapping)
+            return m.cooked_mapping->size();
+
+        int64 size = 0;
+        for (const tinygltf::Buffer& buffer : m.gltf_model.buffers)
+            size += static_cast<int64>(buffer.data.size());
+        for (const tinygltf::Image& image : m.gltf_model.images)
+            size += static_cast<int64>(image.image.size());
+        return size;
+    }
+
+    //! \brief Returns the number of data bytes held by a \a shader_resource.
+    //! \param[in] s The \a shader_resource.
+    //! \return The size of the shader source in bytes.
+    int64 get_resource_size(const shader_resource& s)
+    {
+        return static_cast<int64>(s.source.size());
+    }
+} // namespace
+
 resources_impl::resources_impl()
-    : m_allocator(1073741824) // 1 GiB TODO Paul: Size???
+    : m_allocator(16777216) // 16 MiB regions, larger images get their own.
 {
     m_allocator.init();
 }
 
 resources_impl::~resources_impl()
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     for (auto it = m_resource_cache.begin(); it != m_resource_cache.end();)
     {
-        it = m_resource_cache.erase(it);
+        it = remove_cached(it);
     }
     m_allocator.reset();
 }
 
 void resources_impl::update(float)
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
     // release unused resources (ref count == 0).
     for (auto it = m_resource_cache.begin(); it != m_resource_cache.end();)
     {
-        auto res = static_cast<resource_base*>(it->second);
-        if (!res->reference_count)
+        if (!it->second.resource->reference_count)
         {
-            it = m_resource_cache.erase(it);
+            it = remove_cached(it);
         }
         else
             it++;
@@ -51,213 +92,344 @@ void resources_impl::update(float)
     // TODO Paul: Update resources on demand?
 }
 
+resource_cache_statistics resources_impl::get_cache_statistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+}
+
 const image_resource* resources_impl::acquire(const image_resource_description& description)
 {
     PROFILE_ZONE;
     resource_id res_id = resource_hash::get_id(description);
-    auto cached        = m_resource_cache.find(res_id);
-    if (cached == m_resource_cache.end())
     {
-        image_resource* img = load_image_from_file(description);
-        if (!img)
-            return nullptr;
-        m_resource_cache.insert({ res_id, img });
-        img->reference_count = 1;
-        return img;
-    }
-    else
-    {
-        image_resource* img = static_cast<image_resource*>(cached->second);
-        img->reference_count++;
-        return img;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        resource_base* cached = find_cached(res_id);
+        if (cached)
+            return static_cast<image_resource*>(cached);
     }
+
+    // load without holding the lock, so other resources can be acquired in the meantime.
+    image_resource* img = load_image_from_file(description);
+    if (!img)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<image_resource*>(insert_cached(res_id, { img, resource_type::image, get_resource_size(*img) }));
 }
 
 void resources_impl::release(const image_resource* resource)
 {
     PROFILE_ZONE;
-    auto cached = std::find_if(std::begin(m_resource_cache), std::end(m_resource_cache), [&resource](std::pair<resource_id, void*>&& r) { return r.second == (void*)resource; });
-    if (cached == m_resource_cache.end())
-    {
-        return;
-    }
-    else
-    {
-        image_resource* img = static_cast<image_resource*>(cached->second);
-        img->reference_count--;
-        if (img->reference_count <= 0)
-        {
-            m_allocator.free_memory(static_cast<void*>(img->data));
-            m_allocator.free_memory(static_cast<void*>(img));
-            img->reference_count = 0;
-            m_resource_cache.erase(cached);
-        }
-    }
+    release_cached(resource);
 }
 
 const model_resource* resources_impl::acquire(const model_resource_description& description)
 {
     PROFILE_ZONE;
     resource_id res_id = resource_hash::get_id(description);
-    auto cached        = m_resource_cache.find(res_id);
-    if (cached == m_resource_cache.end())
     {
-        model_resource* m = load_model_from_file(description);
-        if (!m)
-            return nullptr;
-        m_resource_cache.insert({ res_id, m });
-        m->reference_count = 1;
-        return m;
-    }
-    else
-    {
-        model_resource* m = static_cast<model_resource*>(cached->second);
-        m->reference_count++;
-        return m;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        resource_base* cached = find_cached(res_id);
+        if (cached)
+            return static_cast<model_resource*>(cached);
     }
+
+    // load without holding the lock, so other resources can be acquired in the meantime.
+    model_resource* m = load_model_from_file(description);
+    if (!m)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<model_resource*>(insert_cached(res_id, { m, resource_type::model, get_resource_size(*m) }));
 }
 
 void resources_impl::release(const model_resource* resource)
 {
     PROFILE_ZONE;
-    auto cached = std::find_if(std::begin(m_resource_cache), std::end(m_resource_cache), [&resource](std::pair<resource_id, void*>&& r) { return r.second == (void*)resource; });
-    if (cached == m_resource_cache.end())
-    {
-        return;
-    }
-    else
-    {
-        model_resource* m = static_cast<model_resource*>(cached->second);
-        m->reference_count--;
-        if (m->reference_count <= 0)
-        {
-            m_allocator.free_memory(static_cast<void*>(m));
-            m->reference_count = 0;
-            m_resource_cache.erase(cached);
-        }
-    }
+    release_cached(resource);
 }
 
 const shader_resource* resources_impl::acquire(const shader_resource_resource_description& description)
 {
     PROFILE_ZONE;
     resource_id res_id = resource_hash::get_id(description);
-    auto cached        = m_resource_cache.find(res_id);
-    if (cached == m_resource_cache.end())
     {
-        shader_resource* s = load_shader_from_file(description);
-        if (!s)
-            return nullptr;
-        m_resource_cache.insert({ res_id, s });
-        s->reference_count = 1;
-        return s;
-    }
-    else
-    {
-        shader_resource* s = static_cast<shader_resource*>(cached->second);
-        s->reference_count++;
-        return s;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        resource_base* cached = find_cached(res_id);
+        if (cached)
+            return static_cast<shader_resource*>(cached);
     }
+
+    // load without holding the lock, so other resources can be acquired in the meantime.
+    shader_resource* s = load_shader_from_file(description);
+    if (!s)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<shader_resource*>(insert_cached(res_id, { s, resource_type::shader, get_resource_size(*s) }));
 }
 
 void resources_impl::release(const shader_resource* resource)
 {
     PROFILE_ZONE;
-    auto cached = std::find_if(std::begin(m_resource_cache), std::end(m_resource_cache), [&resource](std::pair<resource_id, void*>&& r) { return r.second == (void*)resource; });
+    release_cached(resource);
+}
+
+resource_base* resources_impl::find_cached(resource_id id)
+{
+    auto cached = m_resource_cache.find(id);
     if (cached == m_resource_cache.end())
     {
-        return;
+        m_statistics.misses++;
+        return nullptr;
     }
-    else
+
+    m_statistics.hits++;
+    resource_base* res = cached->second.resource;
+    res->reference_count++;
+    return res;
+}
+
+resource_base* resources_impl::insert_cached(resource_id id, const cache_entry& entry)
+{
+    auto inserted = m_resource_cache.insert({ id, entry });
+    if (!inserted.second)
     {
-        shader_resource* s = static_cast<shader_resource*>(cached->second);
-        s->reference_count--;
-        if (s->reference_count <= 0)
-        {
-            m_allocator.free_memory(static_cast<void*>(s));
-            s->reference_count = 0;
-            m_resource_cache.erase(cached);
-        }
+        // loaded concurrently by another thread, use the cached one.
+        free_entry(entry);
+        resource_base* res = inserted.first->second.resource;
+        res->reference_count++;
+        return res;
     }
+
+    m_resource_ids.insert({ entry.resource, id });
+    m_statistics.bytes_resident += entry.size;
+    m_statistics.resources_resident++;
+    entry.resource->reference_count = 1;
+    return entry.resource;
+}
+
+void resources_impl::release_cached(const resource_base* resource)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto id = m_resource_ids.find(resource);
+    if (id == m_resource_ids.end())
+        return;
+
+    auto cached = m_resource_cache.find(id->second);
+    MANGO_ASSERT(cached != m_resource_cache.end(), "Resource cache and id index are out of sync!");
+    resource_base* res = cached->second.resource;
+    res->reference_count--;
+    if (res->reference_count <= 0)
+        remove_cached(cached);
+}
+
+std::unordered_map<resource_id, resources_impl::cache_entry>::iterator resources_impl::remove_cached(std::unordered_map<resource_id, cache_entry>::iterator it)
+{
+    const cache_entry entry = it->second;
+    m_resource_ids.erase(entry.resource);
+    m_statistics.bytes_resident -= entry.size;
+    m_statistics.resources_resident--;
+    auto next = m_resource_cache.erase(it);
+    free_entry(entry);
+    return next;
+}
+
+void resources_impl::free_entry(const cache_entry& entry)
+{
+    switch (entry.type)
+    {
+    case resource_type::image:
+        free_image(static_cast<image_resource*>(entry.resource));
+        break;
+    case resource_type::model:
+        free_model(static_cast<model_resource*>(entry.resource));
+        break;
+    case resource_type::shader:
+        free_shader(static_cast<shader_resource*>(entry.resource));
+        break;
+    }
+}
+
+void resources_impl::free_image(image_resource* resource)
+{
+    // cooked data is owned by the mapping.
+    if (!resource->cooked_mapping)
+        m_allocator.free_memory(static_cast<void*>(resource->data));
+    resource->~image_resource();
+    m_allocator.free_memory(static_cast<void*>(resource));
+}
+
+void resources_impl::free_model(model_resource* resource)
+{
+    resource->~model_resource();
+    m_allocator.free_memory(static_cast<void*>(resource));
+}
+
+void resources_impl::free_shader(shader_resource* resource)
+{
+    resource->~shader_resource();
+    m_allocator.free_memory(static_cast<void*>(resource));
 }
 
 image_resource* resources_impl::load_image_from_file(const image_resource_description& description)
 {
     PROFILE_ZONE;
 
-    image_resource* img = static_cast<image_resource*>(m_allocator.allocate(sizeof(image_resource)));
+    // the color space changes the mip filtering, so the options are part of the stamp.
+    uint32 flags       = (description.is_standard_color_space ? 1 : 0) | (description.is_hdr ? 2 : 0);
+    string cooked_path = get_cooked_path(description.path);
+    cooked_source_stamp stamp;
+    bool cookable = get_cooked_source_stamp(description.path, flags, stamp);
+    if (cookable)
+    {
+        image_resource* cooked = load_cooked_image(cooked_path, stamp, description);
+        if (cooked)
+            return cooked;
+    }
 
+    // decode first, only the copy into the allocator requires the lock.
     int width = 0, height = 0, components = 0;
+    int32 bits    = 8;
     int64 img_len = sizeof(uint8);
+    void* data    = nullptr;
     if (!description.is_hdr)
     {
-        img->bits           = 8;
-        unsigned char* data = nullptr;
-
         if (stbi_is_16_bit(description.path))
         {
-            data = reinterpret_cast<unsigned char*>(stbi_load_16(description.path, &width, &height, &components, 0));
+            data = stbi_load_16(description.path, &width, &height, &components, 0);
             if (data)
             {
-                img->bits = 16;
+                bits = 16;
                 img_len *= 2;
             }
         }
         if (!data)
             data = stbi_load(description.path, &width, &height, &components, 0);
+    }
+    else
+    {
+        data    = stbi_loadf(description.path, &width, &height, &components, 0);
+        img_len = sizeof(float);
+        bits    = stbi_is_16_bit(description.path) ? 16 : 32;
+    }
 
-        if (!data)
+    if (!data)
+    {
+        MANGO_LOG_ERROR("Could not load image from path '{0}! Image resource not valid!", description.path);
+        return nullptr;
+    }
+
+    if (cookable)
+    {
+        image_resource decoded;
+        decoded.data              = data;
+        decoded.width             = width;
+        decoded.height            = height;
+        decoded.number_components = components;
+        decoded.bits              = bits;
+        decoded.description       = description;
+
+        std::vector<uint8> chain;
+        decoded.mip_levels = generate_mip_chain(decoded, description.is_standard_color_space, chain);
+        decoded.data       = chain.data();
+        if (write_cooked_image(cooked_path, stamp, decoded))
         {
-            MANGO_LOG_ERROR("Could not load image from path '{0}! Image resource not valid!", description.path);
-            return nullptr;
+            image_resource* cooked = load_cooked_image(cooked_path, stamp, description);
+            if (cooked)
+            {
+                stbi_image_free(data);
+                return cooked;
+            }
         }
-
-        img_len *= width * height * components;
-        img->data = m_allocator.allocate(img_len);
-        std::copy(data, data + img_len, static_cast<uint8*>(img->data));
-        stbi_image_free(data);
+        MANGO_LOG_WARN("Cooking image {0} failed! Using the decoded image.", description.path);
     }
-    else
-    {
-        float* data = stbi_loadf(description.path, &width, &height, &components, 0);
 
-        if (!data)
+    img_len *= width * height * components;
+
+    image_resource* img = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        void* mem    = m_allocator.allocate(sizeof(image_resource));
+        void* pixels = mem ? m_allocator.allocate(img_len) : nullptr;
+        if (!pixels)
         {
-            MANGO_LOG_ERROR("Could not load image from path '{0}! Image resource not valid!", description.path);
+            if (mem)
+                m_allocator.free_memory(mem);
+            MANGO_LOG_ERROR("Allocating {0} bytes for image '{1}' failed! Image resource not valid!", img_len, description.path);
+            stbi_image_free(data);
             return nullptr;
         }
-
-        img_len   = width * height * components;
-        img->bits = stbi_is_16_bit(description.path) ? 16 : 32;
-        img->data = m_allocator.allocate(img_len);
-        std::copy(data, data + img_len, static_cast<float*>(img->data));
-        stbi_image_free(data);
+        img       = new (mem) image_resource;
+        img->data = pixels;
     }
+    std::copy(static_cast<uint8*>(data), static_cast<uint8*>(data) + img_len, static_cast<uint8*>(img->data));
+    stbi_image_free(data);
 
+    img->bits              = bits;
     img->width             = width;
     img->height            = height;
     img->number_components = components;
+    img->mip_levels        = 1;
     img->description       = description;
 
     return img;
 }
 
+image_resource* resources_impl::load_cooked_image(const string& cooked_path, const cooked_source_stamp& stamp, const image_resource_description& description)
+{
+    PROFILE_ZONE;
+    auto mapping = std::make_shared<mapped_file>();
+    if (!mapping->open(cooked_path))
+        return nullptr;
+
+    image_resource cooked;
+    cooked.description = description;
+    if (!read_cooked_image(*mapping, stamp, cooked))
+        return nullptr;
+
+    void* mem = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        mem = m_allocator.allocate(sizeof(image_resource));
+    }
+    if (!mem)
+    {
+        MANGO_LOG_ERROR("Allocating the cooked image '{0}' failed! Image resource not valid!", cooked_path);
+        return nullptr;
+    }
+    image_resource* img = new (mem) image_resource(cooked);
+    img->cooked_mapping = mapping;
+
+    return img;
+}
+
 model_resource* resources_impl::load_model_from_file(const model_resource_description& description)
 {
     PROFILE_ZONE;
 
-    void* mem         = m_allocator.allocate(sizeof(model_resource));
-    model_resource* m = new (mem) model_resource;
+    string cooked_path = get_cooked_path(description.path);
+    cooked_source_stamp stamp;
+    bool cookable = get_cooked_source_stamp(description.path, 0, stamp);
+    if (cookable)
+    {
+        model_resource* cooked = load_cooked_model(cooked_path, stamp);
+        if (cooked)
+            return cooked;
+    }
 
+    // parse first, only the allocation requires the lock.
+    tinygltf::Model gltf_model;
     tinygltf::TinyGLTF loader;
     string err;
     string warn;
     auto ext = string(description.path).substr(string(description.path).find_last_of(".") + 1);
     bool ret = false;
     if (ext == "gltf")
-        ret = loader.LoadASCIIFromFile(&(m->gltf_model), &err, &warn, description.path);
+        ret = loader.LoadASCIIFromFile(&gltf_model, &err, &warn, description.path);
     else if (ext == "glb")
-        ret = loader.LoadBinaryFromFile(&(m->gltf_model), &err, &warn, description.path);
+        ret = loader.LoadBinaryFromFile(&gltf_model, &err, &warn, description.path);
 
     if (!warn.empty())
     {
@@ -276,34 +448,130 @@ model_resource* resources_impl::load_model_from_file(const model_resource_descri
         return nullptr;
     }
 
+    calculate_missing_bounds(gltf_model);
+
+    if (cookable)
+    {
+        // the parsed model is dropped after cooking, everything is uploaded from the mapping.
+        // external buffers and images are recorded, so editing them cooks the model again.
+        if (write_cooked_model(cooked_path, stamp, get_cooked_model_dependencies(description.path, gltf_model), gltf_model))
+        {
+            model_resource* cooked = load_cooked_model(cooked_path, stamp);
+            if (cooked)
+                return cooked;
+        }
+        MANGO_LOG_WARN("Cooking model {0} failed! Using the parsed model.", description.path);
+    }
+
+    void* mem = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        mem = m_allocator.allocate(sizeof(model_resource));
+    }
+    if (!mem)
+    {
+        MANGO_LOG_ERROR("Allocating the model '{0}' failed! Model is not valid!", description.path);
+        return nullptr;
+    }
+    model_resource* m = new (mem) model_resource;
+    m->gltf_model     = std::move(gltf_model);
+
+    // the views point into the parsed model.
+    const tinygltf::Model& parsed = m->gltf_model;
+    m->buffer_view_data.resize(parsed.bufferViews.size(), nullptr);
+    for (int32 i = 0; i < static_cast<int32>(parsed.bufferViews.size()); ++i)
+    {
+        const tinygltf::BufferView& bv = parsed.bufferViews[i];
+        if (bv.buffer >= 0 && bv.buffer < static_cast<int32>(parsed.buffers.size()))
+            m->buffer_view_data[i] = parsed.buffers[bv.buffer].data.data() + bv.byteOffset;
+    }
+    m->images.resize(parsed.images.size());
+    for (int32 i = 0; i < static_cast<int32>(parsed.images.size()); ++i)
+    {
+        const tinygltf::Image& image            = parsed.images[i];
+        image_resource& img                     = m->images[i];
+        img.data                                = const_cast<uint8*>(image.image.data());
+        img.width                               = image.width;
+        img.height                              = image.height;
+        img.number_components                   = image.component;
+        img.bits                                = image.bits;
+        img.mip_levels                          = 1;
+        img.description.path                    = image.uri.c_str();
+        img.description.is_standard_color_space = false;
+        img.description.is_hdr                  = false;
+    }
+
     return m;
 }
 
-shader_resource* resources_impl::load_shader_from_file(const shader_resource_resource_description& description)
+model_resource* resources_impl::load_cooked_model(const string& cooked_path, const cooked_source_stamp& stamp)
 {
     PROFILE_ZONE;
+    auto mapping = std::make_shared<mapped_file>();
+    if (!mapping->open(cooked_path))
+        return nullptr;
 
-    void* mem          = m_allocator.allocate(sizeof(shader_resource));
-    shader_resource* s = new (mem) shader_resource;
+    void* mem = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        mem = m_allocator.allocate(sizeof(model_resource));
+    }
+    if (!mem)
+    {
+        MANGO_LOG_ERROR("Allocating the cooked model '{0}' failed! Model is not valid!", cooked_path);
+        return nullptr;
+    }
+    // read in place, the image paths point into the model.
+    model_resource* m = new (mem) model_resource;
+    if (!read_cooked_model(*mapping, stamp, *m))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        free_model(m);
+        return nullptr;
+    }
+    m->cooked_mapping = mapping;
 
-    s->description = description;
+    return m;
+}
+
+shader_resource* resources_impl::load_shader_from_file(const shader_resource_resource_description& description)
+{
+    PROFILE_ZONE;
 
-    s->source = "";
+    string source = "";
 
-    s->source += "#version 430 core\n"; // version in first line is important!
+    source += "#version 430 core\n"; // version in first line is important!
     // insert defines
     for (shader_define def : description.defines)
     {
-        s->source += "#define ";
-        s->source += def.name;
-        s->source += " ";
-        s->source += def.value;
-        s->source += "\n";
+        source += "#define ";
+        source += def.name;
+        source += " ";
+        source += def.value;
+        source += "\n";
     }
     // reset line count
-    s->source += "#line 1\n";
+    source += "#line 1\n";
 
-    s->source += load_shader_string_from_file(description.path, false);
+    {
+        std::lock_guard<std::mutex> lock(m_shader_file_mutex);
+        source += load_shader_string_from_file(description.path, false);
+    }
+
+    void* mem = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        mem = m_allocator.allocate(sizeof(shader_resource));
+    }
+    if (!mem)
+    {
+        MANGO_LOG_ERROR("Allocating the shader '{0}' failed! Shader resource not valid!", description.path);
+        return nullptr;
+    }
+    shader_resource* s = new (mem) shader_resource;
+
+    s->description = description;
+    s->source      = std::move(source);
 
     return s;
 }
@@ -312,56 +580,86 @@ string resources_impl::load_shader_string_from_file(const string& path, bool rec
 {
     string source_string = "";
 
+    const string* file = get_shader_file(path);
+    if (!file)
+    {
+        MANGO_LOG_ERROR("Opening shader file failed: {0} !", path);
+        return source_string;
+    }
+
     // incl. recursive includes
     string include_id = "#include <";
-    std::ifstream input_stream;
-    input_stream.open(path, std::ios::in);
 
     // retrieving the current folder path, because include is relative.
     auto path_end      = path.find_last_of("/\\");
     string folder_path = path.substr(0, path_end + 1);
 
-    if (input_stream.is_open())
+    source_string.reserve(file->size());
+    int32 line_nr     = 1;
+    size_t line_start = 0;
+    while (line_start < file->size())
     {
-        string line;
-        int32 line_nr = 1;
-        while (getline(input_stream, line))
+        size_t line_end = file->find('\n', line_start);
+        if (line_end == string::npos)
+            line_end = file->size();
+        size_t next_line = line_end + 1;
+        // the file is read in binary mode, so windows line endings have to be dropped here.
+        if (line_end > line_start && (*file)[line_end - 1] == '\r')
+            line_end--;
+        string line = file->substr(line_start, line_end - line_start);
+        line_start  = next_line;
+
+        auto offset = line.find(include_id);
+        if (offset != string::npos)
         {
-            auto offset = line.find(include_id);
-            if (offset != string::npos)
+            auto include_end = line.find_first_of(">");
+            if (include_end == string::npos)
             {
-                auto include_end = line.find_first_of(">");
-                if (include_end == string::npos)
-                {
-                    MANGO_LOG_ERROR("Including shader file failed: {0} !", line);
-                    return source_string;
-                }
-
-                string new_path = folder_path + line.substr(offset + include_id.size(), include_end - (offset + include_id.size()));
-
-                // TODO Paul: Line count for included shaders is okay, but in error messages the compiled shader is shown and not the included one.
-                // reset line count
-                source_string += "#line 0\n";
-                source_string += load_shader_string_from_file(new_path, true);
-                // reset line count
-                source_string += "#line " + std::to_string(++line_nr) + "\n";
-
-                continue;
+                MANGO_LOG_ERROR("Including shader file failed: {0} !", line);
+                return source_string;
             }
 
-            source_string += line + "\n";
-            line_nr++;
-        }
+            string new_path = folder_path + line.substr(offset + include_id.size(), include_end - (offset + include_id.size()));
 
-        if (!recursive)
-            source_string += "\0";
+            // TODO Paul: Line count for included shaders is okay, but in error messages the compiled shader is shown and not the included one.
+            // reset line count
+            source_string += "#line 0\n";
+            source_string += load_shader_string_from_file(new_path, true);
+            // reset line count
+            source_string += "#line " + std::to_string(++line_nr) + "\n";
 
-        input_stream.close();
-        return source_string;
-    }
-    else
-    {
-        MANGO_LOG_ERROR("Opening shader file failed: {0} !", path);
-        return source_string;
+            continue;
+        }
+
+        source_string += line + "\n";
+        line_nr++;
     }
+
+    if (!recursive)
+        source_string += "\0";
+
+    return source_string;
+}
+
+const string* resources_impl::get_shader_file(const string& path)
+{
+    cooked_source_stamp stamp;
+    if (!get_cooked_source_stamp(path, 0, stamp))
+        return nullptr;
+
+    auto cached = m_shader_files.find(path);
+    if (cached != m_shader_files.end() && cached->second.stamp.size == stamp.size && cached->second.stamp.modification_time == stamp.modification_time)
+        return &cached->second.source;
+
+    std::ifstream input_stream(path, std::ios::in | std::ios::binary);
+    if (!input_stream.is_open())
+        return nullptr;
+
+    shader_file& file = m_shader_files[path];
+    file.stamp        = stamp;
+    file.source.assign(static_cast<size_t>(stamp.size), '\0');
+    input_stream.read(&file.source[0], static_cast<std::streamsize>(stamp.size));
+    file.source.resize(static_cast<size_t>(input_stream.gcount()));
+
+    return &file.source;
 }
@@ -9,7 +9,9 @@
 
 #include <core/context_impl.hpp>
 #include <mango/resources.hpp>
-#include <memory/free_list_allocator.hpp>
+#include <memory/pool_allocator.hpp>
+#include <mutex>
+#include <resources/cooked_asset.hpp>
 #include <util/hashing.hpp>
 #include <util/helpers.hpp>
 
@@ -18,38 +20,60 @@ namespace mango
     //! \brief Id used for resources.
     using resource_id = uint64;
     //! \brief Hash for \a resource_description.
+    //! \details Ids are calculated from the full path and all options changing the loaded data, so equally named files in different folders do not collide.
     struct resource_hash
     {
       public:
-        //! \brief Returns a \a resource_id for a given \a resource_description.
-        //! \param[in] description The \a resource_description.
-        static inline resource_id get_id(const resource_description& description)
+        //! \brief Returns a \a resource_id for a given \a image_resource_description.
+        //! \param[in] description The \a image_resource_description.
+        static inline resource_id get_id(const image_resource_description& description)
         {
-            auto start = string(description.path).find_last_of("\\/") + 1;
-            auto name  = string(description.path).substr(start, string(description.path).find_last_of(".") - start);
-            return djb2_string_hash::hash(name.c_str());
+            uint8 flags = (description.is_standard_color_space ? 1 : 0) | (description.is_hdr ? 2 : 0);
+            return fnv1a_hash::hash_bytes(&flags, sizeof(flags), hash_path(description.path, 'i'));
+        }
+
+        //! \brief Returns a \a resource_id for a given \a model_resource_description.
+        //! \param[in] description The \a model_resource_description.
+        static inline resource_id get_id(const model_resource_description& description)
+        {
+            return hash_path(description.path, 'm');
         }
 
         //! \brief Returns a \a resource_id for a given \a shader_resource_resource_description.
-        //! \param[in] description The \a resource_description.
+        //! \details The defines are hashed in order, since they are injected in order as well.
+        //! \param[in] description The \a shader_resource_resource_description.
         static inline resource_id get_id(const shader_resource_resource_description& description)
         {
-            auto start = string(description.path).find_last_of("\\/") + 1;
-            auto name  = string(description.path).substr(start, string(description.path).find_last_of(".") - start);
-            auto r_hash = djb2_string_hash::hash(name.c_str());
-
-            for (auto define : description.defines)
+            resource_id r_hash = hash_path(description.path, 's');
+            for (const shader_define& define : description.defines)
             {
-                r_hash += djb2_string_hash::hash(define.name); // TODO: Overflow?
-                r_hash += djb2_string_hash::hash(define.value); // TODO: Overflow?
+                r_hash = fnv1a_hash::hash(define.name, r_hash);
+                r_hash = fnv1a_hash::hash(define.value, r_hash);
             }
-
             return r_hash;
         }
+
+      private:
+        //! \brief Hashes a path with unified separators.
+        //! \param[in] path The full path.
+        //! \param[in] type A character identifying the resource type, so different resources from the same file do not collide.
+        //! \return The hash of the path.
+        static inline uint64 hash_path(const char* path, char type)
+        {
+            uint64 hash = fnv1a_hash::hash_bytes(&type, sizeof(type));
+            for (const char* c = path; *c; ++c)
+            {
+                char unified = (*c == '\\') ? '/' : *c;
+                hash         = fnv1a_hash::hash_bytes(&unified, sizeof(unified), hash);
+            }
+            return hash;
+        }
     };
 
     //! \brief The \a resources of mango.
     //! \details Responsible for loading and releasing resources.
+    //! Resources can be acquired and released from any thread. Files are loaded and decoded without holding the lock.
+    //! Images and models are cooked on first load into a binary file next to the source, later loads map the cooked file instead of decoding and parsing again.
     class resources_impl : public resources
     {
         MANGO_DISABLE_COPY_AND_ASSIGNMENT(resources_impl)
@@ -64,36 +88,118 @@ namespace mango
         void release(const model_resource* resource) override;
         const shader_resource* acquire(const shader_resource_resource_description& description) override;
         void release(const shader_resource* resource) override;
+        resource_cache_statistics get_cache_statistics() override;
 
         //! \brief Updates the \a resources_impl.
         //! \param[in] dt Past time since last call.
         void update(float dt);
 
       private:
+        //! \brief The type of a cached resource.
+        enum class resource_type : uint8
+        {
+            image,
+            model,
+            shader
+        };
+
+        //! \brief An entry in the resource cache.
+        struct cache_entry
+        {
+            resource_base* resource; //!< The cached resource.
+            resource_type type;      //!< The type of the resource.
+            int64 size;              //!< The number of data bytes held by the resource.
+        };
+
         //! \brief The allocator used to store the resources.
-        free_list_allocator m_allocator;
+        pool_allocator m_allocator;
+
+        //! \brief Looks up a cached resource and adds a reference. Requires the lock to be held.
+        //! \param[in] id The \a resource_id of the resource.
+        //! \return The cached resource or nullptr if it is not cached.
+        resource_base* find_cached(resource_id id);
+        //! \brief Inserts a loaded resource into the cache with one reference. Requires the lock to be held.
+        //! \details If the resource was inserted concurrently by another thread, the loaded one is freed and the cached one is referenced instead.
+        //! \param[in] id The \a resource_id of the resource.
+        //! \param[in] entry The \a cache_entry for the loaded resource.
+        //! \return The cached resource.
+        resource_base* insert_cached(resource_id id, const cache_entry& entry);
+        //! \brief Removes a reference from a cached resource and frees it if it is not referenced anymore.
+        //! \param[in] resource The resource to release.
+        void release_cached(const resource_base* resource);
+        //! \brief Removes an entry from the cache and frees its resource. Requires the lock to be held.
+        //! \param[in] it The iterator pointing to the entry to remove.
+        //! \return The iterator following the removed entry.
+        std::unordered_map<resource_id, cache_entry>::iterator remove_cached(std::unordered_map<resource_id, cache_entry>::iterator it);
+        //! \brief Frees the resource of a \a cache_entry. Requires the lock to be held.
+        //! \param[in] entry The \a cache_entry.
+        void free_entry(const cache_entry& entry);
 
         //! \brief Loads \a image_resource from file.
         //! \param[in] description The \a image_resource_description used for loading the \a image_resource.
         //! \return A pointer to the \a image_resource.
         image_resource* load_image_from_file(const image_resource_description& description);
+        //! \brief Loads \a image_resource from a cooked file.
+        //! \param[in] cooked_path The full path of the cooked image.
+        //! \param[in] stamp The \a cooked_source_stamp of the source image.
+        //! \param[in] description The \a image_resource_description used for loading the \a image_resource.
+        //! \return A pointer to the \a image_resource or nullptr if the cooked file is missing or stale.
+        image_resource* load_cooked_image(const string& cooked_path, const cooked_source_stamp& stamp, const image_resource_description& description);
         //! \brief Loads \a model_resource from file.
         //! \param[in] description The \a model_resource_description used for loading the \a model_resource.
         //! \return A pointer to the \a model_resource.
         model_resource* load_model_from_file(const model_resource_description& description);
+        //! \brief Loads \a model_resource from a cooked file.
+        //! \param[in] cooked_path The full path of the cooked model.
+        //! \param[in] stamp The \a cooked_source_stamp of the source model.
+        //! \return A pointer to the \a model_resource or nullptr if the cooked file is missing or stale.
+        model_resource* load_cooked_model(const string& cooked_path, const cooked_source_stamp& stamp);
         //! \brief Loads \a shader_resource from file.
         //! \param[in] description The \a shader_resource_resource_description used for loading the \a shader_resource.
         //! \return A pointer to the \a shader_resource.
         shader_resource* load_shader_from_file(const shader_resource_resource_description& description);
 
-        //! \brief Loads a shader string from a file.
+        //! \brief Frees an \a image_resource that is not in the cache. Requires the lock to be held.
+        //! \param[in] resource The \a image_resource to free.
+        void free_image(image_resource* resource);
+        //! \brief Frees a \a model_resource that is not in the cache. Requires the lock to be held.
+        //! \param[in] resource The \a model_resource to free.
+        void free_model(model_resource* resource);
+        //! \brief Frees a \a shader_resource that is not in the cache. Requires the lock to be held.
+        //! \param[in] resource The \a shader_resource to free.
+        void free_shader(shader_resource* resource);
+
+        //! \brief Loads a shader string from a file. Requires the shader file lock to be held.
         //! \param[in] path The full path of the shader source.
         //! \param[in] recursive True if function is called recursive for included shader.
         //! \return The shader source string with all includes and defines.
         string load_shader_string_from_file(const string& path, bool recursive);
 
-        //! \brief Cache for resources, mapping \a resource_ids to resource pointers.
-        std::unordered_map<resource_id, void*> m_resource_cache;
+        //! \brief A shader source file in the include cache.
+        struct shader_file
+        {
+            cooked_source_stamp stamp; //!< Size and modification time of the file when it was read.
+            string source;             //!< The content of the file.
+        };
+
+        //! \brief Returns the content of a shader source file. Requires the shader file lock to be held.
+        //! \details The file is only read from disk if it is not cached or its size or modification time changed.
+        //! \param[in] path The full path of the shader source.
+        //! \return A pointer to the content of the file or nullptr if it could not be read.
+        const string* get_shader_file(const string& path);
+
+        //! \brief Cache for resources, mapping \a resource_ids to \a cache_entries.
+        std::unordered_map<resource_id, cache_entry> m_resource_cache;
+        //! \brief Reverse index of the cache, mapping resource pointers to \a resource_ids.
+        std::unordered_map<const resource_base*, resource_id> m_resource_ids;
+        //! \brief The statistics of the resource cache.
+        resource_cache_statistics m_statistics;
+        //! \brief Mutex guarding the resource cache and the allocator.
+        std::mutex m_mutex;
+        //! \brief Cache for shader source files, so includes shared by many shaders are only read once.
+        std::unordered_map<string, shader_file> m_shader_files;
+        //! \brief Mutex guarding the shader file cache.
+        std::mutex m_shader_file_mutex;
     };
 } // namespace mango
 
@@ -0,0 +1,381 @@
+//! \file      bounding_volume_hierarchy.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <limits>
+#include <mango/assert.hpp>
+#include <mango/profile.hpp>
+#include <scene/bounding_volume_hierarchy.hpp>
+
+using namespace mango;
+
+//! \brief The number of bins used to evaluate the surface area heuristic.
+static const uint32 sah_bin_count = 12;
+
+//! \brief Calculates the surface area of a box given by minimum and maximum points.
+//! \param[in] min_point The minimum point.
+//! \param[in] max_point The maximum point.
+//! \return The surface area.
+static inline float surface_area(const vec3& min_point, const vec3& max_point)
+{
+    vec3 d = (max_point - min_point).cwiseMax(0.0f);
+    return 2.0f * (d.x() * d.y() + d.y() * d.z() + d.z() * d.x());
+}
+
+const uint32 bounding_volume_hierarchy::invalid_index;
+const uint32 bounding_volume_hierarchy::max_leaf_items;
+
+bounding_volume_hierarchy::bounding_volume_hierarchy() {}
+
+bounding_volume_hierarchy::~bounding_volume_hierarchy() {}
+
+void bounding_volume_hierarchy::build(const std::vector<axis_aligned_bounding_box>& item_bounds)
+{
+    PROFILE_ZONE;
+    clear();
+
+    const uint32 count = static_cast<uint32>(item_bounds.size());
+    if (count == 0)
+        return;
+
+    m_item_bounds = item_bounds;
+    m_item_min.resize(count);
+    m_item_max.resize(count);
+    m_item_order.resize(count);
+    m_item_leaves.resize(count, invalid_index);
+    std::vector<vec3> centers(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        m_item_min[i]   = item_bounds[i].center - item_bounds[i].extents;
+        m_item_max[i]   = item_bounds[i].center + item_bounds[i].extents;
+        m_item_order[i] = i;
+        centers[i]      = item_bounds[i].center;
+    }
+
+    // a binary tree with at least one item per leaf has at most 2 * count - 1 nodes
+    m_nodes.reserve(2 * count - 1);
+    build_node(0, count, invalid_index, centers);
+}
+
+void bounding_volume_hierarchy::clear()
+{
+    m_nodes.clear();
+    m_item_order.clear();
+    m_item_min.clear();
+    m_item_max.clear();
+    m_item_bounds.clear();
+    m_item_leaves.clear();
+}
+
+void bounding_volume_hierarchy::update_item(uint32 item, const axis_aligned_bounding_box& bounds)
+{
+    MANGO_ASSERT(item < item_count(), "Item is not part of the bounding volume hierarchy!");
+
+    m_item_bounds[item] = bounds;
+    m_item_min[item]    = bounds.center - bounds.extents;
+    m_item_max[item]    = bounds.center + bounds.extents;
+
+    uint32 node = m_item_leaves[item];
+    while (node != invalid_index && refit_node(node))
+        node = m_nodes[node].parent;
+}
+
+void bounding_volume_hierarchy::query(const bounding_frustum& frustum, std::vector<uint32>& items) const
+{
+    if (m_nodes.empty())
+        return;
+
+    // items of leaves only intersecting the frustum are collected and tested together
+    bounding_box_batch& candidate_bounds = m_candidate_bounds;
+    std::vector<uint32>& candidate_items = m_candidate_items;
+    candidate_bounds.clear();
+    candidate_items.clear();
+
+    std::vector<uint32>& stack = m_node_stack;
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        uint32 index = stack.back();
+        stack.pop_back();
+        const bvh_node& node = m_nodes[index];
+
+        containment_result result = frustum.contains(axis_aligned_bounding_box::from_min_max(node.min, node.max));
+        if (result == containment_result::disjoint)
+            continue;
+
+        if (result == containment_result::contain)
+        {
+            items.insert(items.end(), m_item_order.begin() + node.first_item, m_item_order.begin() + node.first_item + node.item_count);
+            continue;
+        }
+
+        if (node.right_child == invalid_index)
+        {
+            for (uint32 i = node.first_item; i < node.first_item + node.item_count; ++i)
+            {
+                candidate_bounds.push_back(m_item_bounds[m_item_order[i]]);
+                candidate_items.push_back(m_item_order[i]);
+            }
+            continue;
+        }
+
+        stack.push_back(node.right_child);
+        stack.push_back(index + 1);
+    }
+
+    if (candidate_items.empty())
+        return;
+
+    std::vector<uint32>& visibility = m_visibility;
+    frustum.intersects(candidate_bounds, visibility);
+    for (uint32 i = 0; i < static_cast<uint32>(candidate_items.size()); ++i)
+    {
+        if (bounding_box_batch::visible(visibility, i))
+            items.push_back(candidate_items[i]);
+    }
+}
+
+void bounding_volume_hierarchy::query(const bounding_frustum* frusta, int32 frustum_count, std::vector<uint32>& items, std::vector<uint32>& masks) const
+{
+    MANGO_ASSERT(frustum_count >= 0 && frustum_count <= 32, "Only up to 32 frusta can be queried at once!");
+    if (m_nodes.empty() || frustum_count == 0)
+        return;
+
+    // items of leaves only intersecting some frusta are collected and tested together
+    bounding_box_batch& candidate_bounds     = m_candidate_bounds;
+    std::vector<traversal_entry>& candidates = m_candidates;
+    candidate_bounds.clear();
+    candidates.clear();
+
+    std::vector<traversal_entry>& stack = m_entry_stack;
+    stack.clear();
+    stack.push_back({ 0, 0u, (frustum_count == 32) ? 0xffffffffu : ((1u << frustum_count) - 1u) });
+    while (!stack.empty())
+    {
+        traversal_entry entry = stack.back();
+        stack.pop_back();
+        const bvh_node& node = m_nodes[entry.index];
+
+        axis_aligned_bounding_box node_bounds = axis_aligned_bounding_box::from_min_max(node.min, node.max);
+        uint32 partial                        = 0;
+        for (int32 f = 0; f < frustum_count; ++f)
+        {
+            const uint32 bit = 1u << f;
+            if ((entry.partial & bit) == 0)
+                continue;
+
+            containment_result result = frusta[f].contains(node_bounds);
+            if (result == containment_result::contain)
+                entry.inside |= bit;
+            else if (result != containment_result::disjoint)
+                partial |= bit;
+        }
+        entry.partial = partial;
+
+        if ((entry.inside | entry.partial) == 0)
+            continue;
+
+        if (entry.partial == 0)
+        {
+            items.insert(items.end(), m_item_order.begin() + node.first_item, m_item_order.begin() + node.first_item + node.item_count);
+            masks.insert(masks.end(), node.item_count, entry.inside);
+            continue;
+        }
+
+        if (node.right_child == invalid_index)
+        {
+            for (uint32 i = node.first_item; i < node.first_item + node.item_count; ++i)
+            {
+                candidate_bounds.push_back(m_item_bounds[m_item_order[i]]);
+                candidates.push_back({ m_item_order[i], entry.inside, entry.partial });
+            }
+            continue;
+        }
+
+        stack.push_back({ node.right_child, entry.inside, entry.partial });
+        stack.push_back({ entry.index + 1, entry.inside, entry.partial });
+    }
+
+    if (candidates.empty())
+        return;
+
+    // one batch test per frustum, results for frusta a candidate was not partially intersecting are ignored
+    std::vector<uint32>& candidate_masks = m_candidate_masks;
+    candidate_masks.resize(candidates.size());
+    for (uint32 i = 0; i < static_cast<uint32>(candidates.size()); ++i)
+        candidate_masks[i] = candidates[i].inside;
+
+    std::vector<uint32>& visibility = m_visibility;
+    for (int32 f = 0; f < frustum_count; ++f)
+    {
+        frusta[f].intersects(candidate_bounds, visibility);
+        for (uint32 i = 0; i < static_cast<uint32>(candidates.size()); ++i)
+        {
+            if ((candidates[i].partial & (1u << f)) && bounding_box_batch::visible(visibility, i))
+                candidate_masks[i] |= 1u << f;
+        }
+    }
+
+    for (uint32 i = 0; i < static_cast<uint32>(candidates.size()); ++i)
+    {
+        if (candidate_masks[i] == 0)
+            continue;
+        items.push_back(candidates[i].index);
+        masks.push_back(candidate_masks[i]);
+    }
+}
+
+axis_aligned_bounding_box bounding_volume_hierarchy::get_bounds() const
+{
+    if (m_nodes.empty())
+        return axis_aligned_bounding_box();
+    return axis_aligned_bounding_box::from_min_max(m_nodes[0].min, m_nodes[0].max);
+}
+
+uint32 bounding_volume_hierarchy::build_node(uint32 first, uint32 count, uint32 parent, const std::vector<vec3>& centers)
+{
+    const uint32 index = static_cast<uint32>(m_nodes.size());
+    m_nodes.emplace_back();
+
+    vec3 node_min   = make_vec3(std::numeric_limits<float>::max());
+    vec3 node_max   = make_vec3(std::numeric_limits<float>::lowest());
+    vec3 center_min = node_min;
+    vec3 center_max = node_max;
+    for (uint32 i = first; i < first + count; ++i)
+    {
+        uint32 item = m_item_order[i];
+        node_min    = node_min.cwiseMin(m_item_min[item]);
+        node_max    = node_max.cwiseMax(m_item_max[item]);
+        center_min  = center_min.cwiseMin(centers[item]);
+        center_max  = center_max.cwiseMax(centers[item]);
+    }
+
+    bvh_node& node   = m_nodes[index];
+    node.min         = node_min;
+    node.max         = node_max;
+    node.first_item  = first;
+    node.item_count  = count;
+    node.right_child = invalid_index;
+    node.parent      = parent;
+
+    if (count <= max_leaf_items)
+    {
+        for (uint32 i = first; i < first + count; ++i)
+            m_item_leaves[m_item_order[i]] = index;
+        return index;
+    }
+
+    // split along the axis with the largest center extent
+    vec3 center_extent = center_max - center_min;
+    int32 axis         = 0;
+    if (center_extent.y() > center_extent[axis])
+        axis = 1;
+    if (center_extent.z() > center_extent[axis])
+        axis = 2;
+
+    uint32 left_count = count / 2;
+    if (center_extent[axis] > 0.0f)
+    {
+        // binned surface area heuristic
+        const float bin_scale = static_cast<float>(sah_bin_count) / center_extent[axis];
+        auto bin_of           = [&](uint32 item) { return std::min(sah_bin_count - 1, static_cast<uint32>((centers[item][axis] - center_min[axis]) * bin_scale)); };
+
+        uint32 bin_counts[sah_bin_count] = {};
+        vec3 bin_min[sah_bin_count];
+        vec3 bin_max[sah_bin_count];
+        for (uint32 b = 0; b < sah_bin_count; ++b)
+        {
+            bin_min[b] = make_vec3(std::numeric_limits<float>::max());
+            bin_max[b] = make_vec3(std::numeric_limits<float>::lowest());
+        }
+        for (uint32 i = first; i < first + count; ++i)
+        {
+            uint32 item = m_item_order[i];
+            uint32 b    = bin_of(item);
+            bin_counts[b]++;
+            bin_min[b] = bin_min[b].cwiseMin(m_item_min[item]);
+            bin_max[b] = bin_max[b].cwiseMax(m_item_max[item]);
+        }
+
+        // sweep from the right to get the cost of everything right of each split
+        float right_costs[sah_bin_count];
+        vec3 acc_min     = make_vec3(std::numeric_limits<float>::max());
+        vec3 acc_max     = make_vec3(std::numeric_limits<float>::lowest());
+        uint32 acc_count = 0;
+        for (uint32 b = sah_bin_count - 1; b > 0; --b)
+        {
+            acc_min = acc_min.cwiseMin(bin_min[b]);
+            acc_max = acc_max.cwiseMax(bin_max[b]);
+            acc_count += bin_counts[b];
+            right_costs[b] = acc_count > 0 ? acc_count * surface_area(acc_min, acc_max) : 0.0f;
+        }
+
+        float best_cost  = std::numeric_limits<float>::max();
+        uint32 best_bin  = 0;
+        uint32 best_left = 0;
+        acc_min          = make_vec3(std::numeric_limits<float>::max());
+        acc_max          = make_vec3(std::numeric_limits<float>::lowest());
+        acc_count        = 0;
+        for (uint32 b = 0; b < sah_bin_count - 1; ++b)
+        {
+            acc_min = acc_min.cwiseMin(bin_min[b]);
+            acc_max = acc_max.cwiseMax(bin_max[b]);
+            acc_count += bin_counts[b];
+            if (acc_count == 0 || acc_count == count)
+                continue;
+            float cost = acc_count * surface_area(acc_min, acc_max) + right_costs[b + 1];
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_bin  = b;
+                best_left = acc_count;
+            }
+        }
+
+        if (best_left > 0)
+        {
+            std::partition(m_item_order.begin() + first, m_item_order.begin() + first + count, [&](uint32 item) { return bin_of(item) <= best_bin; });
+            left_count = best_left;
+        }
+    }
+
+    build_node(first, left_count, index, centers);
+    uint32 right                = build_node(first + left_count, count - left_count, index, centers);
+    m_nodes[index].right_child = right;
+
+    return index;
+}
+
+bool bounding_volume_hierarchy::refit_node(uint32 node)
+{
+    bvh_node& n  = m_nodes[node];
+    vec3 new_min = make_vec3(std::numeric_limits<float>::max());
+    vec3 new_max = make_vec3(std::numeric_limits<float>::lowest());
+
+    if (n.right_child == invalid_index)
+    {
+        for (uint32 i = n.first_item; i < n.first_item + n.item_count; ++i)
+        {
+            new_min = new_min.cwiseMin(m_item_min[m_item_order[i]]);
+            new_max = new_max.cwiseMax(m_item_max[m_item_order[i]]);
+        }
+    }
+    else
+    {
+        const bvh_node& left  = m_nodes[node + 1];
+        const bvh_node& right = m_nodes[n.right_child];
+        new_min               = left.min.cwiseMin(right.min);
+        new_max               = left.max.cwiseMax(right.max);
+    }
+
+    if (new_min == n.min && new_max == n.max)
+        return false;
+
+    n.min = new_min;
+    n.max = new_max;
+    return true;
+}
@@ -0,0 +1,155 @@
+//! \file      bounding_volume_hierarchy.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_BOUNDING_VOLUME_HIERARCHY_HPP
+#define MANGO_BOUNDING_VOLUME_HIERARCHY_HPP
+
+#include <mango/intersect.hpp>
+#include <mango/types.hpp>
+#include <vector>
+
+namespace mango
+{
+    //! \brief Bounding volume hierarchy over a list of \a axis_aligned_bounding_boxes.
+    //! \details Items are identified by their index in the list given to \a build().
+    //! The tree is built with the surface area heuristic and refitted when single items move.
+    //! Nodes are stored in depth first order, the items of every subtree are stored contiguously,
+    //! so subtrees completely inside a \a bounding_frustum are accepted without testing any further node or item.
+    class bounding_volume_hierarchy
+    {
+      public:
+        //! \brief Index used for invalid nodes and lookups.
+        static const uint32 invalid_index = 0xffffffffu;
+        //! \brief The maximum number of items stored in one leaf.
+        static const uint32 max_leaf_items = 4;
+
+        bounding_volume_hierarchy();
+        ~bounding_volume_hierarchy();
+
+        //! \brief Builds the \a bounding_volume_hierarchy.
+        //! \details Replaces all previous items.
+        //! \param[in] item_bounds The world space bounds of all items.
+        void build(const std::vector<axis_aligned_bounding_box>& item_bounds);
+
+        //! \brief Removes all items from the \a bounding_volume_hierarchy.
+        void clear();
+
+        //! \brief Updates the bounds of one item and refits all nodes above it.
+        //! \details Refitting stops at the first ancestor whose bounds do not change.
+        //! The tree is not restructured, so it can degrade when items move far. Call \a build() after bigger changes.
+        //! \param[in] item The index of the item.
+        //! \param[in] bounds The new world space bounds of the item.
+        void update_item(uint32 item, const axis_aligned_bounding_box& bounds);
+
+        //! \brief Retrieves all items intersecting a \a bounding_frustum.
+        //! \details Whole subtrees are rejected or accepted by one test. Items in leaves intersecting the frustum are tested in one batch.
+        //! The traversal uses scratch storage of the \a bounding_volume_hierarchy, so one hierarchy can not be queried from multiple threads at once.
+        //! \param[in] frustum The \a bounding_frustum to test against.
+        //! \param[out] items List the indices of the intersecting items get appended to. The order is unspecified.
+        void query(const bounding_frustum& frustum, std::vector<uint32>& items) const;
+
+        //! \brief Retrieves all items intersecting at least one of multiple \a bounding_frusta in one traversal.
+        //! \details Each node is only tested against the frusta its parent was partially intersecting.
+        //! The traversal uses scratch storage of the \a bounding_volume_hierarchy, so one hierarchy can not be queried from multiple threads at once.
+        //! \param[in] frusta Pointer to the list of \a bounding_frusta to test against.
+        //! \param[in] frustum_count The number of \a bounding_frusta, at most 32.
+        //! \param[out] items List the indices of the intersecting items get appended to. Every item is added only once, the order is unspecified.
+        //! \param[out] masks List with one entry per appended item, bit i is set if the item intersects the i-th frustum.
+        void query(const bounding_frustum* frusta, int32 frustum_count, std::vector<uint32>& items, std::vector<uint32>& masks) const;
+
+        //! \brief Retrieves the number of items in the \a bounding_volume_hierarchy.
+        //! \return The number of items.
+        inline uint32 item_count() const
+        {
+            return static_cast<uint32>(m_item_bounds.size());
+        }
+
+        //! \brief Retrieves the number of nodes in the \a bounding_volume_hierarchy.
+        //! \return The number of nodes.
+        inline uint32 node_count() const
+        {
+            return static_cast<uint32>(m_nodes.size());
+        }
+
+        //! \brief Retrieves the bounds of the root node.
+        //! \return The bounds enclosing all items.
+        axis_aligned_bounding_box get_bounds() const;
+
+      private:
+        //! \brief A node in the \a bounding_volume_hierarchy.
+        struct bvh_node
+        {
+            //! \brief The minimum point of the node bounds.
+            vec3 min;
+            //! \brief The maximum point of the node bounds.
+            vec3 max;
+            //! \brief The first entry of the subtree in the item order.
+            uint32 first_item;
+            //! \brief The number of items in the subtree.
+            uint32 item_count;
+            //! \brief The index of the right child, \a invalid_index for leaves. The left child always follows its parent.
+            uint32 right_child;
+            //! \brief The index of the parent node, \a invalid_index for the root.
+            uint32 parent;
+        };
+
+        //! \brief A node or item visited by the multi frustum query.
+        struct traversal_entry
+        {
+            //! \brief The node while traversing, the item for candidates.
+            uint32 index;
+            //! \brief Bitmask of the frusta the entry is completely inside.
+            uint32 inside;
+            //! \brief Bitmask of the frusta the entry only intersects.
+            uint32 partial;
+        };
+
+        //! \brief Recursively builds the subtree for a range of the item order.
+        //! \param[in] first The first entry in the item order.
+        //! \param[in] count The number of items.
+        //! \param[in] parent The index of the parent node.
+        //! \param[in] centers The centers of all items.
+        //! \return The index of the created node.
+        uint32 build_node(uint32 first, uint32 count, uint32 parent, const std::vector<vec3>& centers);
+
+        //! \brief Recalculates the bounds of a node from its children or items.
+        //! \param[in] node The index of the node.
+        //! \return True if the bounds changed, else false.
+        bool refit_node(uint32 node);
+
+        //! \brief The nodes in depth first order, the root is at index 0.
+        std::vector<bvh_node> m_nodes;
+        //! \brief The item indices ordered by leaf.
+        std::vector<uint32> m_item_order;
+        //! \brief The minimum points of the item bounds per item.
+        std::vector<vec3> m_item_min;
+        //! \brief The maximum points of the item bounds per item.
+        std::vector<vec3> m_item_max;
+        //! \brief The item bounds per item.
+        std::vector<axis_aligned_bounding_box> m_item_bounds;
+        //! \brief The leaf node index per item.
+        std::vector<uint32> m_item_leaves;
+
+        // Scratch storage of the queries. Cleared, but never freed, so querying does not allocate once warm.
+
+        //! \brief The node stack of the single frustum query.
+        mutable std::vector<uint32> m_node_stack;
+        //! \brief The entry stack of the multi frustum query.
+        mutable std::vector<traversal_entry> m_entry_stack;
+        //! \brief The bounds of the items in leaves only intersecting the frusta.
+        mutable bounding_box_batch m_candidate_bounds;
+        //! \brief The items of the single frustum query tested in one batch.
+        mutable std::vector<uint32> m_candidate_items;
+        //! \brief The items of the multi frustum query tested in one batch.
+        mutable std::vector<traversal_entry> m_candidates;
+        //! \brief The frustum masks of the items of the multi frustum query.
+        mutable std::vector<uint32> m_candidate_masks;
+        //! \brief The visibility bitmask of the batch tests.
+        mutable std::vector<uint32> m_visibility;
+    };
+} // namespace mango
+
+#endif // MANGO_BOUNDING_VOLUME_HIERARCHY_HPP
@@ -5,9 +5,12 @@
 //! \copyright Apache License 2.0
 
 #include <core/context_impl.hpp>
+#include <core/job_system.hpp>
 #include <glad/glad.h>
+#include <memory/frame_arena.hpp>
 #include <mango/profile.hpp>
 #include <mango/resources.hpp>
+#include <resources/cooked_asset.hpp>
 #include <scene/scene_helper.hpp>
 #include <scene/scene_impl.hpp>
 #include <ui/dear_imgui/icons_font_awesome_5.hpp>
@@ -19,6 +22,32 @@ static int32 get_attrib_component_count_from_tinygltf_types(int32 type);
 static gfx_sampler_filter get_texture_filter_from_tinygltf(int32 filter);
 static gfx_sampler_edge_wrap get_texture_wrap_from_tinygltf(int32 wrap);
 
+//! \brief Number of elements updated by one job in \a scene_impl::update().
+static const uint32 scene_update_chunk_size = 256;
+
+//! \brief Number of bytes uploaded per frame for finished asynchronous loads.
+static const int64 async_upload_budget = 32 * 1024 * 1024;
+
+//! \brief Returns the \a sampler_create_info used for \a textures loaded from images.
+//! \return The \a sampler_create_info.
+static sampler_create_info image_texture_sampler_info();
+
+//! \brief Returns the number of bytes uploaded for an \a image_resource, including all stored mip levels.
+//! \param[in] img The \a image_resource.
+//! \return The number of bytes uploaded.
+static int64 get_image_upload_size(const image_resource& img);
+
+//! \brief Calls a function for all marked elements of a \a slotmap in parallel chunks.
+//! \details Duplicates and \a keys of elements that do not exist anymore are removed from the list first.
+//! Afterwards the list only contains the \a keys of the elements that need an upload.
+//! \param[in] jobs Pointer to the \a job_system to use, the update is done serially if it is null.
+//! \param[in] arena The \a frame_arena to allocate the per element results from.
+//! \param[in,out] data The \a slotmap to update.
+//! \param[in,out] dirty The \a keys of all possibly changed elements.
+//! \param[in] update_function The function to call per element. Has to return true if the element changed and needs an upload.
+template <typename T, typename F>
+static void parallel_update(job_system* jobs, frame_arena& arena, slotmap<T>& data, std::vector<key>& dirty, const F& update_function);
+
 scene_impl::scene_impl(const string& name, const shared_ptr<context_impl>& context)
     : m_shared_context(context)
     , m_light_stack()
@@ -28,6 +57,7 @@ scene_impl::scene_impl(const string& name, const shared_ptr<context_impl>& conte
     , m_nodes()
     , m_transforms()
     , m_global_transformation_matrices()
+    , m_transform_hierarchy()
     , m_meshes()
     , m_mesh_gpu_data()
     , m_primitives()
@@ -42,8 +72,11 @@ scene_impl::scene_impl(const string& name, const shared_ptr<context_impl>& conte
     , m_directional_lights()
     , m_skylights()
     , m_atmospheric_lights()
-    , m_buffer_views()
+    , m_point_lights()
+    , m_spot_lights()
+    , m_async_loads(std::make_shared<async_load_queue>())
     , m_scene_graphics_device(m_shared_context->get_graphics_device())
+    , m_update_context(m_scene_graphics_device->create_graphics_device_context())
 {
     PROFILE_ZONE;
     MANGO_UNUSED(name);
@@ -51,6 +84,13 @@ scene_impl::scene_impl(const string& name, const shared_ptr<context_impl>& conte
     // create light stack
     m_light_stack.init(m_shared_context);
 
+    // per object uniform data
+    m_model_data_ring.create(m_scene_graphics_device, sizeof(model_data), 1024, "model data ring buffer");
+    m_material_data_ring.create(m_scene_graphics_device, sizeof(material_data), 256, "material data ring buffer");
+
+    // shared vertex and index buffers
+    m_geometry_heap.create(m_scene_graphics_device);
+
     node root("Root");
 
     transform tr;
@@ -63,6 +103,8 @@ scene_impl::scene_impl(const string& name, const shared_ptr<context_impl>& conte
     root.type              = node_type::hierarchy;
     root.global_matrix_hnd = handle<mat4>(m_global_transformation_matrices.insert(mat4::Identity()));
     m_root_node            = m_nodes.insert(root);
+
+    m_transform_hierarchy.add(m_root_node.id_unchecked(), root.transform_hnd.id_unchecked(), NONE);
 }
 
 scene_impl::~scene_impl() {}
@@ -84,6 +126,7 @@ handle<node> scene_impl::add_node(const string& name, handle<node> parent_node)
     new_node.global_matrix_hnd = handle<mat4>(m_global_transformation_matrices.insert(mat4::Identity()));
     key node_id                = m_nodes.insert(new_node);
     handle<node> node_hnd      = handle<node>(node_id);
+    m_dirty_transform_nodes.push_back(node_id);
 
     if (!parent_node.valid())
     {
@@ -301,18 +344,51 @@ handle<atmospheric_light> scene_impl::add_atmospheric_light(atmospheric_light& n
     return light_id;
 }
 
+handle<point_light> scene_impl::add_point_light(point_light& new_point_light, handle<node> node_hnd)
+{
+    PROFILE_ZONE;
+
+    if (!node_hnd.valid() || !m_nodes.valid(node_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not exist! Can not add point light!", node_hnd);
+        return NULL_HND<point_light>;
+    }
+
+    key light_id = m_point_lights.insert(new_point_light);
+
+    node& nd = m_nodes[node_hnd.id_unchecked()];
+
+    nd.point_light_hnd = handle<point_light>(light_id);
+    nd.type |= node_type::point_light;
+
+    return light_id;
+}
+
+handle<spot_light> scene_impl::add_spot_light(spot_light& new_spot_light, handle<node> node_hnd)
+{
+    PROFILE_ZONE;
+
+    if (!node_hnd.valid() || !m_nodes.valid(node_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not exist! Can not add spot light!", node_hnd);
+        return NULL_HND<spot_light>;
+    }
+
+    key light_id = m_spot_lights.insert(new_spot_light);
+
+    node& nd = m_nodes[node_hnd.id_unchecked()];
+
+    nd.spot_light_hnd = handle<spot_light>(light_id);
+    nd.type |= node_type::spot_light;
+
+    return light_id;
+}
+
 handle<material> scene_impl::build_material(material& new_material)
 {
     PROFILE_ZONE;
 
-    buffer_create_info buffer_info;
-    buffer_info.buffer_target = gfx_buffer_target::buffer_target_uniform;
-    buffer_info.buffer_access = gfx_buffer_access::buffer_access_dynamic_storage;
-    buffer_info.size          = sizeof(material_data);
     material_gpu_data data;
-    data.material_data_buffer = m_scene_graphics_device->create_buffer(buffer_info);
-    if (!check_creation(data.material_data_buffer.get(), "material data buffer"))
-        return NULL_HND<material>;
 
     data.per_material_data.base_color                 = new_material.base_color.as_vec4();
     data.per_material_data.emissive_color             = new_material.emissive_color.as_vec3();
@@ -328,11 +404,9 @@ handle<material> scene_impl::build_material(material& new_material)
     data.per_material_data.alpha_mode                 = static_cast<uint8>(new_material.alpha_mode);
     data.per_material_data.alpha_cutoff               = new_material.alpha_cutoff;
 
-    auto device_context = m_scene_graphics_device->create_graphics_device_context();
-    device_context->begin();
-    device_context->set_buffer_data(data.material_data_buffer, 0, sizeof(material_data), const_cast<void*>((void*)(&(data.per_material_data))));
-    device_context->end();
-    device_context->submit();
+    data.material_data_index = m_material_data_ring.allocate(&data.per_material_data);
+    if (data.material_data_index < 0)
+        return NULL_HND<material>;
 
     new_material.changed  = false;
     new_material.gpu_data = m_material_gpu_data.insert(data);
@@ -351,22 +425,7 @@ handle<texture> scene_impl::load_texture_from_image(const string& path, bool sta
     tex.standard_color_space = standard_color_space;
     tex.high_dynamic_range   = high_dynamic_range;
 
-    // TODO Paul: We probably want more exposed settings here!
-    sampler_create_info sampler_info;
-    sampler_info.sampler_min_filter      = gfx_sampler_filter::sampler_filter_linear_mipmap_linear;
-    sampler_info.sampler_max_filter      = gfx_sampler_filter::sampler_filter_linear;
-    sampler_info.enable_comparison_mode  = false;
-    sampler_info.comparison_operator     = gfx_compare_operator::compare_operator_always;
-    sampler_info.edge_value_wrap_u       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
-    sampler_info.edge_value_wrap_v       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
-    sampler_info.edge_value_wrap_w       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
-    sampler_info.border_color[0]         = 0;
-    sampler_info.border_color[1]         = 0;
-    sampler_info.border_color[2]         = 0;
-    sampler_info.border_color[3]         = 0;
-    sampler_info.enable_seamless_cubemap = false;
-
-    auto texture_sampler_pair = create_gfx_texture_and_sampler(path, standard_color_space, high_dynamic_range, sampler_info);
+    auto texture_sampler_pair = create_gfx_texture_and_sampler(path, standard_color_space, high_dynamic_range, image_texture_sampler_info());
 
     texture_gpu_data data;
     data.graphics_texture = texture_sampler_pair.first;
@@ -391,6 +450,193 @@ handle<model> scene_impl::load_model_from_gltf(const string& path)
     return handle<model>(model_id);
 }
 
+handle<texture> scene_impl::load_texture_from_image_async(const string& path, bool standard_color_space, bool high_dynamic_range)
+{
+    PROFILE_ZONE;
+
+    texture tex;
+    tex.file_path            = path;
+    tex.standard_color_space = standard_color_space;
+    tex.high_dynamic_range   = high_dynamic_range;
+    tex.pending              = true;
+
+    texture_gpu_data data;
+    data.graphics_texture = pending_texture_placeholder();
+    data.graphics_sampler = m_scene_graphics_device->create_sampler(image_texture_sampler_info());
+    tex.gpu_data          = m_texture_gpu_data.insert(data);
+
+    handle<texture> texture_hnd = handle<texture>(m_textures.insert(tex));
+
+    resources_handle res                 = m_shared_context->get_resources();
+    shared_ptr<async_load_queue> results = m_async_loads;
+    m_shared_context->get_job_system()->execute(
+        [res, results, texture_hnd, path, standard_color_space, high_dynamic_range]()
+        {
+            NAMED_PROFILE_ZONE("Decode Image Async");
+            image_resource_description desc;
+            desc.path                    = path.c_str();
+            desc.is_standard_color_space = standard_color_space;
+            desc.is_hdr                  = high_dynamic_range;
+
+            async_load_result result;
+            result.texture_hnd = texture_hnd;
+            result.image       = res->acquire(desc);
+            if (result.image)
+                result.upload_size = get_image_upload_size(*result.image);
+
+            std::lock_guard<std::mutex> lock(results->mutex);
+            results->finished.push_back(result);
+        });
+
+    return texture_hnd;
+}
+
+handle<model> scene_impl::load_model_from_gltf_async(const string& path)
+{
+    PROFILE_ZONE;
+
+    model mod;
+    mod.file_path = path;
+    mod.pending   = true;
+
+    handle<model> model_hnd = handle<model>(m_models.insert(mod));
+
+    resources_handle res                 = m_shared_context->get_resources();
+    shared_ptr<async_load_queue> results = m_async_loads;
+    m_shared_context->get_job_system()->execute(
+        [res, results, model_hnd, path]()
+        {
+            NAMED_PROFILE_ZONE("Parse Model Async");
+            model_resource_description desc;
+            desc.path = path.c_str();
+
+            async_load_result result;
+            result.model_hnd = model_hnd;
+            result.model     = res->acquire(desc);
+            if (result.model)
+            {
+                // images are decoded by the parser or cooked as well, so everything left is the upload.
+                for (const tinygltf::BufferView& bv : result.model->gltf_model.bufferViews)
+                    result.upload_size += static_cast<int64>(bv.byteLength);
+                for (const image_resource& image : result.model->images)
+                    result.upload_size += get_image_upload_size(image);
+            }
+
+            std::lock_guard<std::mutex> lock(results->mutex);
+            results->finished.push_back(result);
+        });
+
+    return model_hnd;
+}
+
+void scene_impl::process_async_loads()
+{
+    PROFILE_ZONE;
+
+    auto res            = m_shared_context->get_resources();
+    int64 upload_budget = async_upload_budget;
+    while (upload_budget > 0)
+    {
+        async_load_result result;
+        {
+            std::lock_guard<std::mutex> lock(m_async_loads->mutex);
+            if (m_async_loads->finished.empty())
+                return;
+            result = m_async_loads->finished.front();
+            m_async_loads->finished.pop_front();
+        }
+        upload_budget -= result.upload_size;
+
+        if (result.texture_hnd.valid())
+        {
+            if (!m_textures.valid(result.texture_hnd.id_unchecked()))
+            {
+                // removed while loading
+                if (result.image)
+                    res->release(result.image);
+                continue;
+            }
+
+            texture& tex = m_textures[result.texture_hnd.id_unchecked()];
+            tex.pending  = false;
+            if (!result.image)
+            {
+                MANGO_LOG_ERROR("Loading texture {0} failed! Keeping the placeholder.", tex.file_path);
+                continue;
+            }
+
+            auto texture_sampler_pair = create_gfx_texture_and_sampler(*result.image, tex.standard_color_space, tex.high_dynamic_range, image_texture_sampler_info());
+            res->release(result.image);
+
+            // the placeholder was used for alpha tests in cached static shadows until now.
+            replace_texture_gpu_data(m_texture_gpu_data[tex.gpu_data], texture_sampler_pair, m_static_primitive_revision);
+        }
+        else if (result.model_hnd.valid())
+        {
+            if (!m_models.valid(result.model_hnd.id_unchecked()))
+            {
+                // removed while loading
+                if (result.model)
+                    res->release(result.model);
+                continue;
+            }
+
+            model& mod  = m_models[result.model_hnd.id_unchecked()];
+            mod.pending = false;
+            if (!result.model)
+            {
+                MANGO_LOG_ERROR("Loading model {0} failed!", mod.file_path);
+                continue;
+            }
+
+            // the model is still cached, so acquiring it again while building does not parse again.
+            int32 default_scenario = 0;
+            auto scenarios         = load_model_from_file(mod.file_path, default_scenario);
+            res->release(result.model);
+
+            mod.scenarios        = scenarios;
+            mod.default_scenario = default_scenario;
+        }
+    }
+}
+
+gfx_handle<const gfx_texture> scene_impl::pending_texture_placeholder()
+{
+    if (m_pending_texture_placeholder)
+        return m_pending_texture_placeholder;
+
+    texture_create_info tex_info;
+    tex_info.texture_type   = gfx_texture_type::texture_type_2d;
+    tex_info.texture_format = gfx_format::rgba8;
+    tex_info.width          = 1;
+    tex_info.height         = 1;
+    tex_info.miplevels      = 1;
+    tex_info.array_layers   = 1;
+
+    m_pending_texture_placeholder = m_scene_graphics_device->create_texture(tex_info);
+
+    texture_set_description set_desc;
+    set_desc.level          = 0;
+    set_desc.x_offset       = 0;
+    set_desc.y_offset       = 0;
+    set_desc.z_offset       = 0;
+    set_desc.width          = 1;
+    set_desc.height         = 1;
+    set_desc.depth          = 1;
+    set_desc.pixel_format   = gfx_format::rgba;
+    set_desc.component_type = gfx_format::t_unsigned_byte;
+
+    uint8 white[4] = { 255, 255, 255, 255 };
+
+    auto device_context = m_scene_graphics_device->create_graphics_device_context();
+    device_context->begin();
+    device_context->set_texture_data(m_pending_texture_placeholder, set_desc, white);
+    device_context->end();
+    device_context->submit();
+
+    return m_pending_texture_placeholder;
+}
+
 handle<skylight> scene_impl::add_skylight_from_hdr(const string& path, handle<node> node_hnd)
 {
     PROFILE_ZONE;
@@ -444,6 +690,12 @@ void scene_impl::add_model_to_scene(handle<model> model_to_add, handle<scenario>
     key scenario_id = scenario_hnd.id_unchecked();
     model mod       = m_models[model_to_add.id_unchecked()];
 
+    if (mod.pending)
+    {
+        MANGO_LOG_WARN("Model {0} is still loading! Can not add model to scene!", mod.file_path);
+        return;
+    }
+
     auto found = std::find(mod.scenarios.begin(), mod.scenarios.end(), scenario_hnd);
     if (found == mod.scenarios.end())
     {
@@ -476,6 +728,14 @@ void scene_impl::remove_node(handle<node> node_hnd)
 
     key node_id = node_hnd.id_unchecked();
 
+    optional<key> parent_id = m_transform_hierarchy.get_parent(node_id);
+    if (parent_id.has_value() && m_nodes.valid(parent_id.value()))
+    {
+        // also clean up children already marked as deleted
+        std::vector<handle<node>>& siblings = m_nodes[parent_id.value()].children;
+        siblings.erase(std::remove_if(siblings.begin(), siblings.end(), [node_hnd](const handle<node>& c) { return !c.valid() || c == node_hnd; }), siblings.end());
+    }
+
     const node& to_remove = m_nodes[node_id];
 
     if ((to_remove.type & node_type::mesh) != node_type::hierarchy)
@@ -490,13 +750,21 @@ void scene_impl::remove_node(handle<node> node_hnd)
         remove_skylight(node_hnd);
     if ((to_remove.type & node_type::atmospheric_light) != node_type::hierarchy)
         remove_atmospheric_light(node_hnd);
+    if ((to_remove.type & node_type::point_light) != node_type::hierarchy)
+        remove_point_light(node_hnd);
+    if ((to_remove.type & node_type::spot_light) != node_type::hierarchy)
+        remove_spot_light(node_hnd);
 
-    for (auto c : to_remove.children)
+    // removing children can move nodes in the slotmap, so the list has to be taken out first
+    std::vector<handle<node>> children;
+    children.swap(m_nodes[node_id].children);
+    for (auto c : children)
     {
         if (c.valid())
             remove_node(c.id_unchecked());
     }
 
+    m_transform_hierarchy.remove(node_id);
     m_nodes.erase(node_id);
 }
 
@@ -616,8 +884,10 @@ void scene_impl::remove_mesh(handle<node> node_hnd)
     node.type &= ~node_type::mesh;
     node.mesh_hnd = NULL_HND<mesh>;
 
+    m_model_data_ring.release(m_mesh_gpu_data[gpu_data_id].model_data_index);
     m_mesh_gpu_data.erase(gpu_data_id);
     m_meshes.erase(mesh_id);
+    m_primitive_instances_changed = true;
 }
 
 void scene_impl::remove_directional_light(handle<node> node_hnd)
@@ -727,6 +997,72 @@ void scene_impl::remove_atmospheric_light(handle<node> node_hnd)
     m_atmospheric_lights.erase(light_hnd.id_unchecked());
 }
 
+void scene_impl::remove_point_light(handle<node> node_hnd)
+{
+    PROFILE_ZONE;
+
+    if (!node_hnd.valid() || !m_nodes.valid(node_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not exist! Can not remove point light!", node_hnd);
+        return;
+    }
+
+    key node_id = node_hnd.id_unchecked();
+    node& node  = m_nodes[node_id];
+
+    if ((node.type & node_type::point_light) == node_type::hierarchy)
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not contain a point light! Can not remove point light!", node_id);
+        return;
+    }
+
+    handle<point_light> light_hnd = node.point_light_hnd;
+
+    if (!light_hnd.valid() || !m_point_lights.valid(light_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Point light with ID {0} does not exist! Can not remove point light!", light_hnd);
+        return;
+    }
+
+    node.type &= ~node_type::point_light;
+    node.point_light_hnd = NULL_HND<point_light>;
+
+    m_point_lights.erase(light_hnd.id_unchecked());
+}
+
+void scene_impl::remove_spot_light(handle<node> node_hnd)
+{
+    PROFILE_ZONE;
+
+    if (!node_hnd.valid() || !m_nodes.valid(node_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not exist! Can not remove spot light!", node_hnd);
+        return;
+    }
+
+    key node_id = node_hnd.id_unchecked();
+    node& node  = m_nodes[node_id];
+
+    if ((node.type & node_type::spot_light) == node_type::hierarchy)
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not contain a spot light! Can not remove spot light!", node_id);
+        return;
+    }
+
+    handle<spot_light> light_hnd = node.spot_light_hnd;
+
+    if (!light_hnd.valid() || !m_spot_lights.valid(light_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Spot light with ID {0} does not exist! Can not remove spot light!", light_hnd);
+        return;
+    }
+
+    node.type &= ~node_type::spot_light;
+    node.spot_light_hnd = NULL_HND<spot_light>;
+
+    m_spot_lights.erase(light_hnd.id_unchecked());
+}
+
 void scene_impl::unload_gltf_model(handle<model> model_hnd)
 {
     PROFILE_ZONE;
@@ -785,19 +1121,16 @@ void scene_impl::instantiate_model_scene(handle<node> node_hnd, handle<node> par
         mesh copy               = m_meshes[nd.mesh_hnd.id_unchecked()];
         mesh_gpu_data data_copy = m_mesh_gpu_data[copy.gpu_data];
 
-        buffer_create_info buffer_info;
-        buffer_info.buffer_target   = gfx_buffer_target::buffer_target_uniform;
-        buffer_info.buffer_access   = gfx_buffer_access::buffer_access_dynamic_storage;
-        buffer_info.size            = sizeof(model_data);
-        data_copy.model_data_buffer = nullptr;
-        data_copy.model_data_buffer = m_scene_graphics_device->create_buffer(buffer_info);
-        if (!check_creation(data_copy.model_data_buffer.get(), "model data buffer"))
+        data_copy.model_data_index = m_model_data_ring.allocate(&data_copy.per_mesh_data);
+        if (data_copy.model_data_index < 0)
             return;
 
         copy.gpu_data     = m_mesh_gpu_data.insert(data_copy);
         copy.node_hnd     = instance_hnd;
         copy.changed      = true;
         instance.mesh_hnd = handle<mesh>(m_meshes.insert(copy));
+        m_dirty_meshes.push_back(instance.mesh_hnd.id_unchecked());
+        m_primitive_instances_changed = true;
     }
 
     if (nd.perspective_camera_hnd.valid() && m_perspective_cameras.valid(nd.perspective_camera_hnd.id_unchecked()))
@@ -818,6 +1151,7 @@ void scene_impl::instantiate_model_scene(handle<node> node_hnd, handle<node> par
         copy.node_hnd                   = instance_hnd;
         copy.changed                    = true;
         instance.perspective_camera_hnd = handle<perspective_camera>(m_perspective_cameras.insert(copy));
+        m_dirty_perspective_cameras.push_back(instance.perspective_camera_hnd.id_unchecked());
     }
 
     if (nd.orthographic_camera_hnd.valid() && m_orthographic_cameras.valid(nd.orthographic_camera_hnd.id_unchecked()))
@@ -838,6 +1172,7 @@ void scene_impl::instantiate_model_scene(handle<node> node_hnd, handle<node> par
         copy.node_hnd                    = instance_hnd;
         copy.changed                     = true;
         instance.orthographic_camera_hnd = handle<orthographic_camera>(m_orthographic_cameras.insert(copy));
+        m_dirty_orthographic_cameras.push_back(instance.orthographic_camera_hnd.id_unchecked());
     }
 
     if (nd.directional_light_hnd.valid() && m_directional_lights.valid(nd.directional_light_hnd.id_unchecked()))
@@ -862,6 +1197,20 @@ void scene_impl::instantiate_model_scene(handle<node> node_hnd, handle<node> par
         instance.atmospheric_light_hnd = handle<atmospheric_light>(m_atmospheric_lights.insert(copy));
     }
 
+    if (nd.point_light_hnd.valid() && m_point_lights.valid(nd.point_light_hnd.id_unchecked()))
+    {
+        point_light copy         = m_point_lights[nd.point_light_hnd.id_unchecked()];
+        copy.changed             = true;
+        instance.point_light_hnd = handle<point_light>(m_point_lights.insert(copy));
+    }
+
+    if (nd.spot_light_hnd.valid() && m_spot_lights.valid(nd.spot_light_hnd.id_unchecked()))
+    {
+        spot_light copy         = m_spot_lights[nd.spot_light_hnd.id_unchecked()];
+        copy.changed            = true;
+        instance.spot_light_hnd = handle<spot_light>(m_spot_lights.insert(copy));
+    }
+
     transform& tr             = m_transforms[nd.transform_hnd.id_unchecked()];
     transform& instance_tr    = m_transforms[instance.transform_hnd.id_unchecked()];
     instance_tr.position      = tr.position;
@@ -869,6 +1218,7 @@ void scene_impl::instantiate_model_scene(handle<node> node_hnd, handle<node> par
     instance_tr.scale         = tr.scale;
     instance_tr.rotation_hint = tr.rotation_hint;
     instance_tr.changed       = true;
+    m_dirty_transform_nodes.push_back(instance_id);
 
     for (auto c : nd.children)
     {
@@ -914,6 +1264,9 @@ optional<transform&> scene_impl::get_transform(handle<node> node_hnd)
         return NONE;
     }
 
+    // the caller may change the transform
+    m_dirty_transform_nodes.push_back(node_hnd.id_unchecked());
+
     return m_transforms[nd.transform_hnd.id_unchecked()];
 }
 
@@ -943,6 +1296,9 @@ optional<perspective_camera&> scene_impl::get_perspective_camera(handle<node> no
         return NONE;
     }
 
+    // the caller may change the camera
+    m_dirty_perspective_cameras.push_back(camera_hnd.id_unchecked());
+
     return m_perspective_cameras[camera_hnd.id_unchecked()];
 }
 
@@ -972,6 +1328,9 @@ optional<orthographic_camera&> scene_impl::get_orthographic_camera(handle<node>
         return NONE;
     }
 
+    // the caller may change the camera
+    m_dirty_orthographic_cameras.push_back(camera_hnd.id_unchecked());
+
     return m_orthographic_cameras[camera_hnd.id_unchecked()];
 }
 
@@ -1062,6 +1421,64 @@ optional<atmospheric_light&> scene_impl::get_atmospheric_light(handle<node> node
     return m_atmospheric_lights[light_hnd.id_unchecked()];
 }
 
+optional<point_light&> scene_impl::get_point_light(handle<node> node_hnd)
+{
+    PROFILE_ZONE;
+
+    if (!node_hnd.valid() || !m_nodes.valid(node_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not exist! Can not retrieve point light!", node_hnd);
+        return NONE;
+    }
+
+    const node& nd = m_nodes[node_hnd.id_unchecked()];
+
+    if ((nd.type & node_type::point_light) == node_type::hierarchy)
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not contain a point light! Can not retrieve point light!", node_hnd.id_unchecked());
+        return NONE;
+    }
+
+    handle<point_light> light_hnd = nd.point_light_hnd;
+
+    if (!light_hnd.valid() || !m_point_lights.valid(light_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Point light with ID {0} does not exist! Can not retrieve point light!", light_hnd);
+        return NONE;
+    }
+
+    return m_point_lights[light_hnd.id_unchecked()];
+}
+
+optional<spot_light&> scene_impl::get_spot_light(handle<node> node_hnd)
+{
+    PROFILE_ZONE;
+
+    if (!node_hnd.valid() || !m_nodes.valid(node_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not exist! Can not retrieve spot light!", node_hnd);
+        return NONE;
+    }
+
+    const node& nd = m_nodes[node_hnd.id_unchecked()];
+
+    if ((nd.type & node_type::spot_light) == node_type::hierarchy)
+    {
+        MANGO_LOG_WARN("Node with ID {0} does not contain a spot light! Can not retrieve spot light!", node_hnd.id_unchecked());
+        return NONE;
+    }
+
+    handle<spot_light> light_hnd = nd.spot_light_hnd;
+
+    if (!light_hnd.valid() || !m_spot_lights.valid(light_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Spot light with ID {0} does not exist! Can not retrieve spot light!", light_hnd);
+        return NONE;
+    }
+
+    return m_spot_lights[light_hnd.id_unchecked()];
+}
+
 optional<model&> scene_impl::get_model(handle<model> instance_hnd)
 {
     PROFILE_ZONE;
@@ -1098,6 +1515,20 @@ optional<material&> scene_impl::get_material(handle<material> instance_hnd)
         return NONE;
     }
 
+    // the caller may change the material
+    m_dirty_materials.push_back(instance_hnd.id_unchecked());
+
+    return m_materials[instance_hnd.id_unchecked()];
+}
+
+optional<const material&> scene_impl::read_material(handle<material> instance_hnd) const
+{
+    if (!instance_hnd.valid() || !m_materials.valid(instance_hnd.id_unchecked()))
+    {
+        MANGO_LOG_WARN("Material with ID {0} does not exist! Can not retrieve material!", instance_hnd);
+        return NONE;
+    }
+
     return m_materials[instance_hnd.id_unchecked()];
 }
 
@@ -1111,6 +1542,9 @@ optional<texture&> scene_impl::get_texture(handle<texture> instance_hnd)
         return NONE;
     }
 
+    // the caller may change the texture
+    m_dirty_textures.push_back(instance_hnd.id_unchecked());
+
     return m_textures[instance_hnd.id_unchecked()];
 }
 
@@ -1183,18 +1617,42 @@ void scene_impl::attach(handle<node> child_node, handle<node> parent_node)
         return;
     }
 
-    node& child = m_nodes[child_node.id_unchecked()];
+    key child_id  = child_node.id_unchecked();
+    key parent_id = parent_node.id_unchecked();
 
-    auto found = std::find(child.children.begin(), child.children.end(), parent_node);
-    if (found != child.children.end())
+    if (!m_transform_hierarchy.contains(parent_id))
     {
-        MANGO_LOG_ERROR("Parent is attached to child! Can not attach in a circle!"); // TODO Paul: We need to check the whole subtree!
+        MANGO_LOG_WARN("Parent node with ID {0} is not part of the scene graph! Can not attach!", parent_node);
         return;
     }
 
-    node& parent = m_nodes[parent_node.id_unchecked()];
+    if (m_transform_hierarchy.is_ancestor(child_id, parent_id))
+    {
+        MANGO_LOG_ERROR("Parent is part of the childs subtree! Can not attach in a circle!");
+        return;
+    }
 
-    parent.children.push_back(child_node);
+    if (!m_transform_hierarchy.contains(child_id))
+    {
+        const node& child = m_nodes[child_id];
+        m_transform_hierarchy.add(child_id, child.transform_hnd.id_unchecked(), parent_id);
+        m_nodes[parent_id].children.push_back(child_node);
+        return;
+    }
+
+    // a node can only have one parent, so it is moved
+    optional<key> old_parent_id = m_transform_hierarchy.get_parent(child_id);
+    if (old_parent_id.has_value())
+    {
+        if (old_parent_id.value() == parent_id)
+            return;
+
+        std::vector<handle<node>>& siblings = m_nodes[old_parent_id.value()].children;
+        siblings.erase(std::remove(siblings.begin(), siblings.end(), child_node), siblings.end());
+    }
+
+    m_transform_hierarchy.set_parent(child_id, parent_id);
+    m_nodes[parent_id].children.push_back(child_node);
 }
 
 void scene_impl::detach(handle<node> child_node, handle<node> parent_node)
@@ -1212,7 +1670,7 @@ void scene_impl::detach(handle<node> child_node, handle<node> parent_node)
         return;
     }
 
-    node& parent = m_nodes[parent_node.id_unchecked()];
+    const node& parent = m_nodes[parent_node.id_unchecked()];
 
     auto found = std::find(parent.children.begin(), parent.children.end(), child_node);
     if (found == parent.children.end())
@@ -1221,7 +1679,8 @@ void scene_impl::detach(handle<node> child_node, handle<node> parent_node)
         return;
     }
 
-    parent.children.erase(found);
+    // detached nodes are moved to the root node
+    attach(child_node, m_root_node);
 }
 
 void scene_impl::remove_texture(handle<texture> instance_hnd)
@@ -1342,19 +1801,6 @@ const light_gpu_data& scene_impl::get_light_gpu_data()
     return m_light_gpu_data;
 }
 
-optional<buffer_view&> scene_impl::get_buffer_view(handle<buffer_view> instance_hnd)
-{
-    PROFILE_ZONE;
-
-    if (!instance_hnd.valid() || !m_buffer_views.valid(instance_hnd.id_unchecked()))
-    {
-        MANGO_LOG_WARN("Buffer view with ID {0} does not exist! Can not retrieve buffer view!", instance_hnd);
-        return NONE;
-    }
-
-    return m_buffer_views[instance_hnd.id_unchecked()];
-}
-
 optional<camera_gpu_data&> scene_impl::get_active_camera_gpu_data()
 {
     PROFILE_ZONE;
@@ -1407,8 +1853,6 @@ optional<camera_gpu_data&> scene_impl::get_active_camera_gpu_data()
 std::pair<gfx_handle<const gfx_texture>, gfx_handle<const gfx_sampler>> scene_impl::create_gfx_texture_and_sampler(const string& path, bool standard_color_space, bool high_dynamic_range,
                                                                                                                    const sampler_create_info& sampler_info)
 {
-    auto& graphics_device = m_shared_context->get_graphics_device();
-
     image_resource_description desc;
     desc.path                    = path.c_str();
     desc.is_standard_color_space = standard_color_space;
@@ -1416,42 +1860,11 @@ std::pair<gfx_handle<const gfx_texture>, gfx_handle<const gfx_sampler>> scene_im
 
     auto res                  = m_shared_context->get_resources();
     const image_resource* img = res->acquire(desc);
-    gfx_format internal       = gfx_format::invalid;
-    gfx_format pixel_format   = gfx_format::invalid;
-    gfx_format component_type = gfx_format::invalid;
-    graphics::get_formats_for_image(img->number_components, img->bits, desc.is_standard_color_space, desc.is_hdr, internal, pixel_format, component_type);
+    if (!check_acquisition(img, "image"))
+        return std::pair<gfx_handle<const gfx_texture>, gfx_handle<const gfx_sampler>>();
 
-    // TODO Paul: We probably want more exposed settings here!
-    texture_create_info tex_info;
-    tex_info.texture_type   = gfx_texture_type::texture_type_2d; // TODO Is it?
-    tex_info.texture_format = internal;
-    tex_info.width          = img->width;
-    tex_info.height         = img->height;
-    tex_info.miplevels      = graphics::calculate_mip_count(img->width, img->height);
-    tex_info.array_layers   = 1;
-
-    std::pair<gfx_handle<const gfx_texture>, gfx_handle<const gfx_sampler>> result;
-    result.first  = graphics_device->create_texture(tex_info);
-    result.second = graphics_device->create_sampler(sampler_info);
-
-    // upload data
-    texture_set_description set_desc;
-    set_desc.level          = 0;
-    set_desc.x_offset       = 0;
-    set_desc.y_offset       = 0;
-    set_desc.z_offset       = 0;
-    set_desc.width          = img->width;
-    set_desc.height         = img->height;
-    set_desc.depth          = 1; // TODO Paul: Is it?
-    set_desc.pixel_format   = pixel_format;
-    set_desc.component_type = component_type;
-
-    auto device_context = graphics_device->create_graphics_device_context();
-    device_context->begin();
-    device_context->set_texture_data(result.first, set_desc, img->data);
-    device_context->calculate_mipmaps(result.first);
-    device_context->end();
-    device_context->submit();
+    auto result = create_gfx_texture_and_sampler(*img, standard_color_space, high_dynamic_range, sampler_info);
+    res->release(img);
 
     return result;
 }
@@ -1481,20 +1894,27 @@ std::pair<gfx_handle<const gfx_texture>, gfx_handle<const gfx_sampler>> scene_im
 
     // upload data
     texture_set_description set_desc;
-    set_desc.level          = 0;
     set_desc.x_offset       = 0;
     set_desc.y_offset       = 0;
     set_desc.z_offset       = 0;
-    set_desc.width          = img.width;
-    set_desc.height         = img.height;
     set_desc.depth          = 1; // TODO Paul: Is it?
     set_desc.pixel_format   = pixel_format;
     set_desc.component_type = component_type;
 
     auto device_context = graphics_device->create_graphics_device_context();
     device_context->begin();
-    device_context->set_texture_data(result.first, set_desc, img.data);
-    device_context->calculate_mipmaps(result.first);
+    // cooked images come with all mip levels, others are filtered on the gpu.
+    uint8* level_data = static_cast<uint8*>(img.data);
+    for (int32 level = 0; level < img.mip_levels; ++level)
+    {
+        set_desc.level  = level;
+        set_desc.width  = std::max(1, img.width >> level);
+        set_desc.height = std::max(1, img.height >> level);
+        device_context->set_texture_data(result.first, set_desc, level_data);
+        level_data += get_image_level_size(img, level);
+    }
+    if (img.mip_levels < tex_info.miplevels)
+        device_context->calculate_mipmaps(result.first);
     device_context->end();
     device_context->submit();
 
@@ -1510,12 +1930,15 @@ std::vector<handle<scenario>> scene_impl::load_model_from_file(const string& pat
 
     auto res                 = m_shared_context->get_resources();
     const model_resource* mr = res->acquire(desc);
+    if (!check_acquisition(mr, "model"))
+        return std::vector<handle<scenario>>();
 
-    tinygltf::Model& m = const_cast<model_resource*>(mr)->gltf_model;
+    const tinygltf::Model& m = mr->gltf_model;
 
     if (m.scenes.size() <= 0)
     {
         MANGO_LOG_DEBUG("No scenarios in the gltf model found! Can not load invalid gltf.");
+        res->release(mr);
         return std::vector<handle<scenario>>();
     }
     else
@@ -1523,42 +1946,6 @@ std::vector<handle<scenario>> scene_impl::load_model_from_file(const string& pat
         MANGO_LOG_DEBUG("The gltf model has {0} scenarios.", m.scenes.size());
     }
 
-    // load buffer views and data
-    std::vector<key> buffer_view_ids(m.bufferViews.size());
-    for (int32 i = 0; i < static_cast<int32>(m.bufferViews.size()); ++i)
-    {
-        const tinygltf::BufferView& bv = m.bufferViews[i];
-        if (bv.target == 0)
-        {
-            MANGO_LOG_DEBUG("Buffer view target is zero!"); // We can continue here.
-        }
-
-        buffer_view view;
-        view.offset = 0; // bv.byteOffset; -> Is done on upload.
-        view.size   = static_cast<int32>(bv.byteLength);
-        view.stride = static_cast<int32>(bv.byteStride);
-
-        buffer_create_info buffer_info;
-        buffer_info.buffer_access = gfx_buffer_access::buffer_access_dynamic_storage;
-        buffer_info.buffer_target = (bv.target == 0 || bv.target == GL_ARRAY_BUFFER) ? gfx_buffer_target::buffer_target_vertex : gfx_buffer_target::buffer_target_index;
-        buffer_info.size          = bv.byteLength;
-
-        view.graphics_buffer = graphics_device->create_buffer(buffer_info);
-
-        // upload data
-        const tinygltf::Buffer& buffer = m.buffers[bv.buffer];
-        auto device_context            = graphics_device->create_graphics_device_context();
-        device_context->begin();
-        const unsigned char* buffer_start = buffer.data.data() + bv.byteOffset;
-        const void* buffer_data           = static_cast<const void*>(buffer_start);
-        device_context->set_buffer_data(view.graphics_buffer, 0, view.size, const_cast<void*>(buffer_data));
-        device_context->end();
-        device_context->submit();
-        // TODO Paul: Are interleaved buffers loaded multiple times? Could we just preprocess them?
-
-        buffer_view_ids[i] = m_buffer_views.insert(view);
-    }
-
     default_scenario = m.defaultScene > -1 ? m.defaultScene : 0;
 
     std::vector<handle<scenario>> all_scenarios;
@@ -1570,7 +1957,10 @@ std::vector<handle<scenario>> scene_impl::load_model_from_file(const string& pat
     // light_data is filled by the light_stack
     m_light_gpu_data.light_data_buffer = m_scene_graphics_device->create_buffer(buffer_info);
     if (!check_creation(m_light_gpu_data.light_data_buffer.get(), "light data buffer"))
+    {
+        res->release(mr);
         return std::vector<handle<scenario>>();
+    }
 
     for (const tinygltf::Scene& t_scene : m.scenes)
     {
@@ -1578,19 +1968,30 @@ std::vector<handle<scenario>> scene_impl::load_model_from_file(const string& pat
 
         for (int32 i = 0; i < static_cast<int32>(t_scene.nodes.size()); ++i)
         {
-            scen.root_nodes.push_back(build_model_node(m, m.nodes.at(t_scene.nodes[i]), buffer_view_ids));
+            scen.root_nodes.push_back(build_model_node(*mr, m.nodes.at(t_scene.nodes[i])));
         }
 
         key scenario_id = m_scenarios.insert(scen);
         all_scenarios.push_back(handle<scenario>(scenario_id));
     }
 
+    // upload the geometry of all meshes at once.
+    auto device_context = graphics_device->create_graphics_device_context();
+    device_context->begin();
+    m_geometry_heap.flush(device_context);
+    device_context->end();
+    device_context->submit();
+
+    // everything is uploaded, so the model data is not required anymore.
+    res->release(mr);
+
     return all_scenarios;
 }
 
-handle<node> scene_impl::build_model_node(tinygltf::Model& m, tinygltf::Node& n, const std::vector<key>& buffer_view_ids)
+handle<node> scene_impl::build_model_node(const model_resource& mr, const tinygltf::Node& n)
 {
     PROFILE_ZONE;
+    const tinygltf::Model& m = mr.gltf_model;
 
     node model_node(n.name);
 
@@ -1598,7 +1999,7 @@ handle<node> scene_impl::build_model_node(tinygltf::Model& m, tinygltf::Node& n,
 
     if (n.matrix.size() == 16)
     {
-        dmat4 dinput = Eigen::Map<Eigen::Matrix<double, 4, 4>>(n.matrix.data());
+        dmat4 dinput = Eigen::Map<const Eigen::Matrix<double, 4, 4>>(n.matrix.data());
         mat4 input   = dinput.cast<float>();
         vec3 s;
         vec4 p;
@@ -1643,7 +2044,7 @@ handle<node> scene_impl::build_model_node(tinygltf::Model& m, tinygltf::Node& n,
     {
         MANGO_ASSERT(n.mesh < static_cast<int32>(m.meshes.size()), "Invalid gltf mesh!");
         MANGO_LOG_DEBUG("Node is a mesh!");
-        auto loaded = build_model_mesh(m, m.meshes.at(n.mesh), node_hnd, buffer_view_ids);
+        auto loaded = build_model_mesh(mr, m.meshes.at(n.mesh), node_hnd);
         if (loaded.valid())
         {
             m_nodes[node_id].mesh_hnd = loaded;
@@ -1665,14 +2066,14 @@ handle<node> scene_impl::build_model_node(tinygltf::Model& m, tinygltf::Node& n,
     {
         MANGO_ASSERT(n.children[i] < static_cast<int32>(m.nodes.size()), "Invalid gltf node!");
 
-        handle<node> child_hnd = build_model_node(m, m.nodes.at(n.children[i]), buffer_view_ids);
+        handle<node> child_hnd = build_model_node(mr, m.nodes.at(n.children[i]));
         m_nodes[node_id].children.push_back(child_hnd);
     }
 
     return node_id;
 }
 
-void scene_impl::build_model_camera(tinygltf::Camera& t_camera, handle<node> node_hnd, const vec3& target)
+void scene_impl::build_model_camera(const tinygltf::Camera& t_camera, handle<node> node_hnd, const vec3& target)
 {
     PROFILE_ZONE;
 
@@ -1733,9 +2134,10 @@ void scene_impl::build_model_camera(tinygltf::Camera& t_camera, handle<node> nod
     }
 }
 
-handle<mesh> scene_impl::build_model_mesh(tinygltf::Model& m, tinygltf::Mesh& t_mesh, handle<node> node_hnd, const std::vector<key>& buffer_view_ids)
+handle<mesh> scene_impl::build_model_mesh(const model_resource& mr, const tinygltf::Mesh& t_mesh, handle<node> node_hnd)
 {
     PROFILE_ZONE;
+    const tinygltf::Model& m = mr.gltf_model;
     mesh model_mesh;
     model_mesh.name     = t_mesh.name;
     model_mesh.node_hnd = node_hnd;
@@ -1758,15 +2160,16 @@ handle<mesh> scene_impl::build_model_mesh(tinygltf::Model& m, tinygltf::Mesh& t_
 
         prim_gpu_data.input_assembly.topology = static_cast<gfx_primitive_topology>(t_primitive.mode + 1); // cast should be okay
 
+        const void* index_data       = nullptr;
+        gfx_format source_index_type = gfx_format::invalid;
         if (t_primitive.indices >= 0)
         {
             const tinygltf::Accessor& index_accessor = m.accessors[t_primitive.indices];
 
-            key view_id                               = buffer_view_ids[index_accessor.bufferView];
-            prim_gpu_data.index_buffer_view           = m_buffer_views[view_id];
-            prim_gpu_data.index_type                  = static_cast<gfx_format>(index_accessor.componentType); // cast should be okay
-            prim_gpu_data.draw_call_desc.index_count  = static_cast<int32>(index_accessor.count);
-            prim_gpu_data.draw_call_desc.index_offset = static_cast<int32>(index_accessor.byteOffset);
+            index_data                               = mr.buffer_view_data[index_accessor.bufferView] + index_accessor.byteOffset;
+            source_index_type                        = static_cast<gfx_format>(index_accessor.componentType); // cast should be okay
+            prim_gpu_data.index_type                 = geometry_heap::index_type;
+            prim_gpu_data.draw_call_desc.index_count = static_cast<int32>(index_accessor.count);
         }
         else
         {
@@ -1778,7 +2181,7 @@ handle<mesh> scene_impl::build_model_mesh(tinygltf::Model& m, tinygltf::Mesh& t_
         handle<material> material_hnd;
         if (t_primitive.material >= 0)
         {
-            auto loaded = load_material(m.materials[t_primitive.material], m);
+            auto loaded = load_material(m.materials[t_primitive.material], mr);
             if (loaded.valid())
                 material_hnd = loaded;
             else
@@ -1791,6 +2194,8 @@ handle<mesh> scene_impl::build_model_mesh(tinygltf::Model& m, tinygltf::Mesh& t_
 
         int32 vertex_buffer_binding = 0;
         int32 description_index     = 0;
+        int32 vertex_count          = 0;
+        geometry_stream streams[16];
 
         for (auto& attrib : t_primitive.attributes)
         {
@@ -1822,13 +2227,15 @@ handle<mesh> scene_impl::build_model_mesh(tinygltf::Model& m, tinygltf::Mesh& t_
 
             if (attrib_location > -1)
             {
-                key view_id   = buffer_view_ids[accessor.bufferView];
-                auto buffer_v = m_buffer_views[view_id];
-                buffer_v.offset += static_cast<int32>(accessor.byteOffset);
-                prim_gpu_data.vertex_buffer_views.emplace_back(buffer_v);
+                // the heap stores every attribute tightly packed, aligned to 4 bytes.
+                geometry_stream& stream = streams[description_index];
+                stream.data             = mr.buffer_view_data[accessor.bufferView] + accessor.byteOffset;
+                stream.stride           = accessor.ByteStride(m.bufferViews[accessor.bufferView]);
+                stream.element_size     = tinygltf::GetComponentSizeInBytes(accessor.componentType) * tinygltf::GetNumComponentsInType(accessor.type);
+                vertex_count            = static_cast<int32>(accessor.count);
 
                 binding_desc.binding    = vertex_buffer_binding;
-                binding_desc.stride     = accessor.ByteStride(m.bufferViews[accessor.bufferView]);
+                binding_desc.stride     = (stream.element_size + 3) & ~3;
                 binding_desc.input_rate = gfx_vertex_input_rate::per_vertex; // TODO Paul: This will probably change later.
 
                 attrib_desc.binding = vertex_buffer_binding;
@@ -1864,6 +2271,28 @@ handle<mesh> scene_impl::build_model_mesh(tinygltf::Model& m, tinygltf::Mesh& t_
         }
         prim_gpu_data.vertex_layout.binding_description_count   = description_index;
         prim_gpu_data.vertex_layout.attribute_description_count = description_index;
+        m_new_geometry_layouts.push_back(geometry_layout{ prim_gpu_data.vertex_layout, prim_gpu_data.input_assembly });
+
+        geometry_allocation allocation;
+        if (!m_geometry_heap.allocate(prim_gpu_data.vertex_layout, streams, vertex_count, index_data, source_index_type, prim_gpu_data.draw_call_desc.index_count, allocation))
+        {
+            MANGO_LOG_ERROR("Adding geometry of mesh {0} to the geometry heap failed!", t_mesh.name);
+            return NULL_HND<mesh>;
+        }
+
+        // primitives in the same heap page share their buffers and only differ in base vertex and index offset.
+        for (int32 b = 0; b < allocation.vertex_buffer_count; ++b)
+        {
+            buffer_view view;
+            view.stride          = prim_gpu_data.vertex_layout.binding_descriptions[b].stride;
+            view.size            = vertex_count * view.stride;
+            view.graphics_buffer = allocation.vertex_buffers[b];
+            prim_gpu_data.vertex_buffer_views.push_back(view);
+        }
+        prim_gpu_data.index_buffer_view.graphics_buffer = allocation.index_buffer;
+        prim_gpu_data.index_buffer_view.size            = prim_gpu_data.draw_call_desc.index_count * static_cast<int32>(sizeof(uint32));
+        prim_gpu_data.draw_call_desc.base_vertex        = allocation.base_vertex;
+        prim_gpu_data.draw_call_desc.index_offset       = allocation.index_offset;
 
         key prim_gpu_data_id = m_primitive_gpu_data.insert(prim_gpu_data);
         prim.gpu_data        = prim_gpu_data_id;
@@ -1884,9 +2313,10 @@ handle<mesh> scene_impl::build_model_mesh(tinygltf::Model& m, tinygltf::Mesh& t_
     return handle<mesh>(m_meshes.insert(model_mesh));
 }
 
-handle<material> scene_impl::load_material(const tinygltf::Material& primitive_material, tinygltf::Model& m)
+handle<material> scene_impl::load_material(const tinygltf::Material& primitive_material, const model_resource& mr)
 {
     PROFILE_ZONE;
+    const tinygltf::Model& m = mr.gltf_model;
 
     material new_material;
     new_material.name = "Unnamed";
@@ -1972,15 +2402,9 @@ handle<material> scene_impl::load_material(const tinygltf::Material& primitive_m
         tex.standard_color_space = standard_color_space;
         tex.high_dynamic_range   = high_dynamic_range;
 
-        image_resource img;
-        img.data                                = const_cast<void*>(static_cast<const void*>(image.image.data()));
-        img.width                               = image.width;
-        img.height                              = image.height;
-        img.bits                                = image.bits;
-        img.number_components                   = image.component;
+        image_resource img                      = mr.images[base_col.source];
         img.description.is_standard_color_space = standard_color_space;
         img.description.is_hdr                  = high_dynamic_range;
-        img.description.path                    = image.uri.c_str();
 
         auto texture_sampler_pair = create_gfx_texture_and_sampler(img, standard_color_space, high_dynamic_range, sampler_info);
 
@@ -2037,15 +2461,9 @@ handle<material> scene_impl::load_material(const tinygltf::Material& primitive_m
         tex.standard_color_space = standard_color_space;
         tex.high_dynamic_range   = high_dynamic_range;
 
-        image_resource img;
-        img.data                                = const_cast<void*>(static_cast<const void*>(image.image.data()));
-        img.width                               = image.width;
-        img.height                              = image.height;
-        img.bits                                = image.bits;
-        img.number_components                   = image.component;
+        image_resource img                      = mr.images[o_r_m_t.source];
         img.description.is_standard_color_space = standard_color_space;
         img.description.is_hdr                  = high_dynamic_range;
-        img.description.path                    = image.uri.c_str();
 
         auto texture_sampler_pair = create_gfx_texture_and_sampler(img, standard_color_space, high_dynamic_range, sampler_info);
 
@@ -2105,15 +2523,9 @@ handle<material> scene_impl::load_material(const tinygltf::Material& primitive_m
             tex.standard_color_space = standard_color_space;
             tex.high_dynamic_range   = high_dynamic_range;
 
-            image_resource img;
-            img.data                                = const_cast<void*>(static_cast<const void*>(image.image.data()));
-            img.width                               = image.width;
-            img.height                              = image.height;
-            img.bits                                = image.bits;
-            img.number_components                   = image.component;
+            image_resource img                      = mr.images[occ.source];
             img.description.is_standard_color_space = standard_color_space;
             img.description.is_hdr                  = high_dynamic_range;
-            img.description.path                    = image.uri.c_str();
 
             auto texture_sampler_pair = create_gfx_texture_and_sampler(img, standard_color_space, high_dynamic_range, sampler_info);
 
@@ -2166,15 +2578,9 @@ handle<material> scene_impl::load_material(const tinygltf::Material& primitive_m
         tex.standard_color_space = standard_color_space;
         tex.high_dynamic_range   = high_dynamic_range;
 
-        image_resource img;
-        img.data                                = const_cast<void*>(static_cast<const void*>(image.image.data()));
-        img.width                               = image.width;
-        img.height                              = image.height;
-        img.bits                                = image.bits;
-        img.number_components                   = image.component;
+        image_resource img                      = mr.images[norm.source];
         img.description.is_standard_color_space = standard_color_space;
         img.description.is_hdr                  = high_dynamic_range;
-        img.description.path                    = image.uri.c_str();
 
         auto texture_sampler_pair = create_gfx_texture_and_sampler(img, standard_color_space, high_dynamic_range, sampler_info);
 
@@ -2231,15 +2637,9 @@ handle<material> scene_impl::load_material(const tinygltf::Material& primitive_m
         tex.standard_color_space = standard_color_space;
         tex.high_dynamic_range   = high_dynamic_range;
 
-        image_resource img;
-        img.data                                = const_cast<void*>(static_cast<const void*>(image.image.data()));
-        img.width                               = image.width;
-        img.height                              = image.height;
-        img.bits                                = image.bits;
-        img.number_components                   = image.component;
+        image_resource img                      = mr.images[emissive.source];
         img.description.is_standard_color_space = standard_color_space;
         img.description.is_hdr                  = high_dynamic_range;
-        img.description.path                    = image.uri.c_str();
 
         auto texture_sampler_pair = create_gfx_texture_and_sampler(img, standard_color_space, high_dynamic_range, sampler_info);
 
@@ -2331,95 +2731,112 @@ handle<material> scene_impl::default_material()
 //     return environment_entity;
 // }
 
-void scene_impl::update_scene_graph(handle<node> node_hnd, handle<node> parent_hnd, bool force_update)
+void scene_impl::update_scene_graph(job_system* jobs)
 {
-    key node_id   = node_hnd.id_unchecked();
-    node& nd      = m_nodes[node_id];
-    transform& tr = m_transforms[nd.transform_hnd.id_unchecked()];
+    PROFILE_ZONE;
 
-    if (tr.changed || force_update)
-    {
-        // recalculate node matrices
-        mat4 local_transformation_matrix = mat4::Identity() * translate(tr.position);
-        local_transformation_matrix      = local_transformation_matrix * quaternion_to_mat4(tr.rotation);
-        local_transformation_matrix      = local_transformation_matrix * scale(tr.scale);
+    // indices are only stable after reordering
+    m_transform_hierarchy.reorder();
+    const uint32 count = m_transform_hierarchy.size();
 
-        mat4 parent_transformation_matrix = mat4::Identity();
-        if (parent_hnd.valid() && m_nodes.valid(parent_hnd.id_unchecked()))
+    // only transforms that were handed out or created can be changed
+    for (key node_id : m_dirty_transform_nodes)
+    {
+        uint32 i = m_transform_hierarchy.index_of(node_id);
+        if (i == transform_hierarchy::invalid_index)
+            continue;
+        transform& tr = m_transforms[m_transform_hierarchy.transform_id(i)];
+        if (tr.changed)
         {
-            const node& parent = m_nodes[parent_hnd.id_unchecked()];
-            MANGO_ASSERT(parent.global_matrix_hnd.valid(), "Parent does not have a global matrix calculated!");
-            parent_transformation_matrix = m_global_transformation_matrices[parent.global_matrix_hnd.id_unchecked()];
+            m_transform_hierarchy.set_local(i, tr.position, tr.rotation, tr.scale);
+            tr.changed = false;
         }
+    }
+    m_dirty_transform_nodes.clear();
 
-        MANGO_ASSERT(nd.global_matrix_hnd.valid(), "Node does not have a global matrix attached!");
-        mat4& global_transformation_matrix = m_global_transformation_matrices[nd.global_matrix_hnd.id_unchecked()];
+    // recalculate node matrices
+    m_transform_hierarchy.update(jobs);
 
-        global_transformation_matrix = parent_transformation_matrix * local_transformation_matrix;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        key node_id = m_transform_hierarchy.node_id(i);
+        node& nd    = m_nodes[node_id];
 
-        // Set changed flags
-        if ((nd.type & node_type::mesh) != node_type::hierarchy)
+        if (m_transform_hierarchy.updated(i))
         {
-            MANGO_ASSERT(nd.mesh_hnd.valid(), "Mesh node has no mesh attached!");
-            mesh& m   = m_meshes[nd.mesh_hnd.id_unchecked()];
-            m.changed = true;
+            MANGO_ASSERT(nd.global_matrix_hnd.valid(), "Node does not have a global matrix attached!");
+            m_global_transformation_matrices[nd.global_matrix_hnd.id_unchecked()] = m_transform_hierarchy.global_matrix(i);
+
+            // Set changed flags
+            if ((nd.type & node_type::mesh) != node_type::hierarchy)
+            {
+                MANGO_ASSERT(nd.mesh_hnd.valid(), "Mesh node has no mesh attached!");
+                mesh& m   = m_meshes[nd.mesh_hnd.id_unchecked()];
+                m.changed = true;
+                m_dirty_meshes.push_back(nd.mesh_hnd.id_unchecked());
+            }
+            if ((nd.type & node_type::perspective_camera) != node_type::hierarchy)
+            {
+                MANGO_ASSERT(nd.perspective_camera_hnd.valid(), "Perspective camera node has no perspective camera attached!");
+                key camera_id           = nd.perspective_camera_hnd.id_unchecked();
+                perspective_camera& cam = m_perspective_cameras[camera_id];
+                cam.changed             = true;
+                m_dirty_perspective_cameras.push_back(camera_id);
+            }
+            if ((nd.type & node_type::orthographic_camera) != node_type::hierarchy)
+            {
+                MANGO_ASSERT(nd.orthographic_camera_hnd.valid(), "Orthographic camera node has no orthographic camera attached!");
+                key camera_id            = nd.orthographic_camera_hnd.id_unchecked();
+                orthographic_camera& cam = m_orthographic_cameras[camera_id];
+                cam.changed              = true;
+                m_dirty_orthographic_cameras.push_back(camera_id);
+            }
         }
-        if ((nd.type & node_type::perspective_camera) != node_type::hierarchy)
+        // light changes are handled by the light stack
+        if ((nd.type & node_type::directional_light) != node_type::hierarchy)
         {
-            MANGO_ASSERT(nd.perspective_camera_hnd.valid(), "Perspective camera node has no perspective camera attached!");
-            key camera_id           = nd.perspective_camera_hnd.id_unchecked();
-            perspective_camera& cam = m_perspective_cameras[camera_id];
-            cam.changed             = true;
+            MANGO_ASSERT(nd.directional_light_hnd.valid(), "Directional light node has no directional light attached!");
+            key light_id         = nd.directional_light_hnd.id_unchecked();
+            directional_light& l = m_directional_lights[light_id];
+            m_light_stack.push(l);
         }
-        if ((nd.type & node_type::orthographic_camera) != node_type::hierarchy)
+        if ((nd.type & node_type::skylight) != node_type::hierarchy)
         {
-            MANGO_ASSERT(nd.orthographic_camera_hnd.valid(), "Orthographic camera node has no orthographic camera attached!");
-            key camera_id            = nd.orthographic_camera_hnd.id_unchecked();
-            orthographic_camera& cam = m_orthographic_cameras[camera_id];
-            cam.changed              = true;
+            MANGO_ASSERT(nd.skylight_hnd.valid(), "Skylight node has no skylight light attached!");
+            key light_id = nd.skylight_hnd.id_unchecked();
+            skylight& l  = m_skylights[light_id];
+            m_light_stack.push(l);
         }
-
-        tr.changed   = false;
-        force_update = true;
-    }
-    // light changes are handled by the light stack
-    if ((nd.type & node_type::directional_light) != node_type::hierarchy)
-    {
-        MANGO_ASSERT(nd.directional_light_hnd.valid(), "Directional light node has no directional light attached!");
-        key light_id         = nd.directional_light_hnd.id_unchecked();
-        directional_light& l = m_directional_lights[light_id];
-        m_light_stack.push(l);
-    }
-    if ((nd.type & node_type::skylight) != node_type::hierarchy)
-    {
-        MANGO_ASSERT(nd.skylight_hnd.valid(), "Skylight node has no skylight light attached!");
-        key light_id = nd.skylight_hnd.id_unchecked();
-        skylight& l  = m_skylights[light_id];
-        m_light_stack.push(l);
-    }
-    if ((nd.type & node_type::atmospheric_light) != node_type::hierarchy)
-    {
-        MANGO_ASSERT(nd.atmospheric_light_hnd.valid(), "Atmospheric light node has no atmospheric light  attached!");
-        key light_id         = nd.atmospheric_light_hnd.id_unchecked();
-        atmospheric_light& l = m_atmospheric_lights[light_id];
-        m_light_stack.push(l);
-    }
-
-    // add to render instances
-    m_render_instances.push_back(render_instance(node_id));
-
-    for (auto it = nd.children.begin(); it != nd.children.end();)
-    {
-        auto c = *it;
-        if (c.valid() && m_nodes.valid(c.id_unchecked()))
+        if ((nd.type & node_type::atmospheric_light) != node_type::hierarchy)
         {
-            update_scene_graph(c.id_unchecked(), node_id, force_update);
-            it++;
+            MANGO_ASSERT(nd.atmospheric_light_hnd.valid(), "Atmospheric light node has no atmospheric light  attached!");
+            key light_id         = nd.atmospheric_light_hnd.id_unchecked();
+            atmospheric_light& l = m_atmospheric_lights[light_id];
+            m_light_stack.push(l);
         }
-        else
+        if ((nd.type & (node_type::point_light | node_type::spot_light)) != node_type::hierarchy)
         {
-            it = nd.children.erase(it);
+            MANGO_ASSERT(nd.global_matrix_hnd.valid(), "Node does not have a global matrix attached!");
+            const mat4& trafo = m_global_transformation_matrices[nd.global_matrix_hnd.id_unchecked()];
+            vec3 position     = trafo.col(3).head<3>();
+            if ((nd.type & node_type::point_light) != node_type::hierarchy)
+            {
+                MANGO_ASSERT(nd.point_light_hnd.valid(), "Point light node has no point light attached!");
+                key light_id   = nd.point_light_hnd.id_unchecked();
+                point_light& l = m_point_lights[light_id];
+                m_light_stack.push(l, position);
+            }
+            if ((nd.type & node_type::spot_light) != node_type::hierarchy)
+            {
+                MANGO_ASSERT(nd.spot_light_hnd.valid(), "Spot light node has no spot light attached!");
+                key light_id  = nd.spot_light_hnd.id_unchecked();
+                spot_light& l = m_spot_lights[light_id];
+                m_light_stack.push(l, position, trafo.block<3, 3>(0, 0) * l.direction);
+            }
         }
+
+        // add to render instances
+        m_render_instances.push_back(render_instance(node_id));
     }
 }
 
@@ -2430,247 +2847,360 @@ void scene_impl::update(float dt)
 
     m_render_instances.clear();
 
-    update_scene_graph(m_root_node, NULL_HND<node>, false);
+    job_system* jobs   = m_shared_context->get_job_system().get();
+    frame_arena& arena = *m_shared_context->get_frame_arena();
+
+    // Finished asynchronous loads are uploaded first, so built models are part of this update.
+    process_async_loads();
+
+    update_scene_graph(jobs);
+
+    // Cameras with adaptive exposure have to be calculated each frame.
+    m_requires_auto_exposure = false;
+    for (const perspective_camera& cam : m_perspective_cameras)
+    {
+        if (!cam.adaptive_exposure)
+            continue;
+        m_requires_auto_exposure = true;
+        m_dirty_perspective_cameras.push_back(m_nodes[cam.node_hnd.id_unchecked()].perspective_camera_hnd.id_unchecked());
+    }
+    for (const orthographic_camera& cam : m_orthographic_cameras)
+    {
+        if (!cam.adaptive_exposure)
+            continue;
+        m_requires_auto_exposure = true;
+        m_dirty_orthographic_cameras.push_back(m_nodes[cam.node_hnd.id_unchecked()].orthographic_camera_hnd.id_unchecked());
+    }
+
+    // Everything else is only updated for the elements marked as possibly changed.
+    // The data is calculated in parallel chunks, the upload to the gpu stays on this thread.
+    parallel_update(jobs, arena, m_meshes, m_dirty_meshes, [this](mesh& m) {
+        if (!m.changed)
+            return false;
+
+        mesh_gpu_data& data = m_mesh_gpu_data[m.gpu_data];
+        // we can assume these exist, because of update_scene_graph()
+        const node& nd    = m_nodes[m.node_hnd.id_unchecked()];
+        const mat4& trafo = m_global_transformation_matrices[nd.global_matrix_hnd.id_unchecked()];
+
+        data.per_mesh_data.model_matrix  = trafo;
+        data.per_mesh_data.normal_matrix = trafo.block(0, 0, 3, 3).inverse().transpose();
+        return true;
+    });
+
+    update_primitive_instances();
+
+    parallel_update(jobs, arena, m_perspective_cameras, m_dirty_perspective_cameras, [this](perspective_camera& cam) {
+        if (!cam.changed && !cam.adaptive_exposure)
+            return false;
+
+        camera_gpu_data& data = m_camera_gpu_data[cam.gpu_data];
+        // we can assume these exist, because of update_scene_graph()
+        const node& nd       = m_nodes[cam.node_hnd.id_unchecked()];
+        const mat4& trafo    = m_global_transformation_matrices[nd.global_matrix_hnd.id_unchecked()];
+        vec3 camera_position = trafo.col(3).head<3>();
+
+        mat4 view, projection;
+        view_projection_perspective_camera(cam, camera_position, view, projection);
+        update_camera_data(cam, data, camera_position, view, projection);
+        return true;
+    });
+
+    parallel_update(jobs, arena, m_orthographic_cameras, m_dirty_orthographic_cameras, [this](orthographic_camera& cam) {
+        if (!cam.changed && !cam.adaptive_exposure)
+            return false;
+
+        camera_gpu_data& data = m_camera_gpu_data[cam.gpu_data];
+        // we can assume these exist, because of update_scene_graph()
+        const node& nd       = m_nodes[cam.node_hnd.id_unchecked()];
+        const mat4& trafo    = m_global_transformation_matrices[nd.global_matrix_hnd.id_unchecked()];
+        vec3 camera_position = trafo.col(3).head<3>();
+
+        mat4 view, projection;
+        view_projection_orthographic_camera(cam, camera_position, view, projection);
+        update_camera_data(cam, data, camera_position, view, projection);
+        return true;
+    });
+
+    parallel_update(jobs, arena, m_materials, m_dirty_materials, [this](material& mat) {
+        if (!mat.changed)
+            return false;
+
+        material_gpu_data& data = m_material_gpu_data[mat.gpu_data];
+
+        data.per_material_data.base_color                 = mat.base_color.as_vec4();
+        data.per_material_data.emissive_color             = mat.emissive_color.as_vec3();
+        data.per_material_data.metallic                   = mat.metallic;
+        data.per_material_data.roughness                  = mat.roughness;
+        data.per_material_data.base_color_texture         = mat.base_color_texture.valid() && m_textures.valid(mat.base_color_texture.id_unchecked());
+        data.per_material_data.roughness_metallic_texture = mat.metallic_roughness_texture.valid() && m_textures.valid(mat.metallic_roughness_texture.id_unchecked());
+        data.per_material_data.occlusion_texture          = mat.occlusion_texture.valid() && m_textures.valid(mat.occlusion_texture.id_unchecked());
+        data.per_material_data.packed_occlusion           = mat.packed_occlusion;
+        data.per_material_data.normal_texture             = mat.normal_texture.valid() && m_textures.valid(mat.normal_texture.id_unchecked());
+        data.per_material_data.emissive_color_texture     = mat.emissive_texture.valid() && m_textures.valid(mat.emissive_texture.id_unchecked());
+        data.per_material_data.emissive_intensity         = mat.emissive_intensity;
+        data.per_material_data.alpha_mode                 = static_cast<uint8>(mat.alpha_mode);
+        data.per_material_data.alpha_cutoff               = mat.alpha_cutoff;
+        return true;
+    });
 
-    // Everything else can be updated in ecs style for changed stuff
-    // TODO Paul: This could probably be done in parallel...
-    for (auto m : m_meshes)
+    // Lights are only updated if they are instantiated in the hierarchy.
+    m_light_stack.update(this);
+    m_light_gpu_data.scene_light_data = m_light_stack.get_light_data();
+
+    // Upload everything that changed, the dirty lists are consumed.
+    graphics_device_context_handle& device_context = m_update_context;
+    device_context->begin();
+
+    for (key mesh_id : m_dirty_meshes)
     {
-        if (m.changed)
-        {
-            mesh_gpu_data& data = m_mesh_gpu_data[m.gpu_data];
-            // we can assume these exist, because of update_scene_graph()
-            const node& nd    = m_nodes[m.node_hnd.id_unchecked()];
-            const mat4& trafo = m_global_transformation_matrices[nd.global_matrix_hnd.id_unchecked()];
+        mesh& m             = m_meshes[mesh_id];
+        mesh_gpu_data& data = m_mesh_gpu_data[m.gpu_data];
+        if (data.model_data_index >= 0)
+            m_model_data_ring.write(data.model_data_index, &data.per_mesh_data);
+        m.changed = false;
+    }
+    m_dirty_meshes.clear();
 
-            data.per_mesh_data.model_matrix  = trafo;
-            data.per_mesh_data.normal_matrix = trafo.block(0, 0, 3, 3).inverse().transpose();
+    for (key camera_id : m_dirty_perspective_cameras)
+    {
+        perspective_camera& cam = m_perspective_cameras[camera_id];
+        camera_gpu_data& data   = m_camera_gpu_data[cam.gpu_data];
+        device_context->set_buffer_data(data.camera_data_buffer, 0, sizeof(camera_data), const_cast<void*>((void*)(&(data.per_camera_data))));
+        cam.changed = false;
+    }
+    m_dirty_perspective_cameras.clear();
 
-            auto device_context = m_scene_graphics_device->create_graphics_device_context();
-            device_context->begin();
-            device_context->set_buffer_data(data.model_data_buffer, 0, sizeof(model_data), const_cast<void*>((void*)(&(data.per_mesh_data))));
-            device_context->end();
-            device_context->submit();
+    for (key camera_id : m_dirty_orthographic_cameras)
+    {
+        orthographic_camera& cam = m_orthographic_cameras[camera_id];
+        camera_gpu_data& data    = m_camera_gpu_data[cam.gpu_data];
+        device_context->set_buffer_data(data.camera_data_buffer, 0, sizeof(camera_data), const_cast<void*>((void*)(&(data.per_camera_data))));
+        cam.changed = false;
+    }
+    m_dirty_orthographic_cameras.clear();
 
-            m.changed = false;
-        }
+    device_context->set_buffer_data(m_light_gpu_data.light_data_buffer, 0, sizeof(light_data), const_cast<void*>((void*)(&(m_light_gpu_data.scene_light_data))));
+    if (m_light_stack.upload(device_context))
+    {
+        const light_clusters& clusters        = m_light_stack.get_light_clusters();
+        m_light_gpu_data.punctual_light_buffer = clusters.get_light_buffer();
+        m_light_gpu_data.light_cluster_buffer  = clusters.get_cluster_buffer();
+        m_light_gpu_data.light_index_buffer    = clusters.get_light_index_buffer();
     }
-    m_requires_auto_exposure = false;
-    for (auto cam : m_perspective_cameras)
+
+    // cached static shadow casters depend on the alpha mode, the cutoff and the base color texture of their materials.
+    if (!m_dirty_materials.empty())
     {
-        m_requires_auto_exposure |= cam.adaptive_exposure;
-        if (cam.changed)
+        for (const primitive_instance& instance : m_primitive_instances)
         {
-            camera_gpu_data& data = m_camera_gpu_data[cam.gpu_data];
-            // we can assume these exist, because of update_scene_graph()
-            const node& nd       = m_nodes[cam.node_hnd.id_unchecked()];
-            const mat4& trafo    = m_global_transformation_matrices[nd.global_matrix_hnd.id_unchecked()];
-            vec3 camera_position = trafo.col(3).head<3>();
-
-            mat4 view, projection;
-            view_projection_perspective_camera(cam, camera_position, view, projection);
-            const mat4 view_projection = projection * view;
-
-            data.per_camera_data.view_matrix             = view;
-            data.per_camera_data.projection_matrix       = projection;
-            data.per_camera_data.view_projection_matrix  = view_projection;
-            data.per_camera_data.inverse_view_projection = view_projection.inverse();
-            data.per_camera_data.camera_position         = camera_position;
-            data.per_camera_data.camera_near             = cam.z_near;
-            data.per_camera_data.camera_far              = cam.z_far;
-
-            float ape;
-            float shu;
-            float iso;
-            if (cam.adaptive_exposure) // Has to be calculated each frame if enabled.
-            {
-                ape = default_camera_aperture;
-                shu = default_camera_shutter_speed;
-                iso = default_camera_iso;
-
-                // K is a light meter calibration constant
-                static const float K = 12.5f;
-                static const float S = 100.0f;
-                float target_ev      = log2f(m_average_luminance * S / K);
-
-                // Compute the resulting ISO if we left both shutter and aperture here
-                iso                 = clamp(((ape * ape) * 100.0f) / (shu * exp2f(target_ev)), min_camera_iso, max_camera_iso);
-                float unclamped_iso = (shu * exp2f(target_ev));
-                MANGO_UNUSED(unclamped_iso);
-
-                // Apply half the difference in EV to the aperture
-                float ev_diff = target_ev - log2f(((ape * ape) * 100.0f) / (shu * iso));
-                ape           = clamp(ape * powf(sqrtf(2.0f), ev_diff * 0.5f), min_camera_aperture, max_camera_aperture);
-
-                // Apply the remaining difference to the shutter speed
-                ev_diff = target_ev - log2f(((ape * ape) * 100.0f) / (shu * iso));
-                shu     = clamp(shu * powf(2.0f, -ev_diff), min_camera_shutter_speed, max_camera_shutter_speed);
-            }
-            else
+            if (instance.dynamic || !m_primitives.valid(instance.primitive_hnd.id_unchecked()))
+                continue;
+            key material_id = m_primitives[instance.primitive_hnd.id_unchecked()].primitive_material.id_unchecked();
+            if (std::binary_search(m_dirty_materials.begin(), m_dirty_materials.end(), material_id))
             {
-                ape = cam.physical.aperture;
-                shu = cam.physical.shutter_speed;
-                iso = cam.physical.iso;
+                ++m_static_primitive_revision;
+                break;
             }
-            cam.physical.aperture                = clamp(ape, min_camera_aperture, max_camera_aperture);
-            cam.physical.shutter_speed           = clamp(shu, min_camera_shutter_speed, max_camera_shutter_speed);
-            cam.physical.iso                     = clamp(iso, min_camera_iso, max_camera_iso);
-            float e                              = ((ape * ape) * 100.0f) / (shu * iso);
-            data.per_camera_data.camera_exposure = 1.0f / (1.2f * e);
-
-            auto device_context = m_scene_graphics_device->create_graphics_device_context();
-            device_context->begin();
-            device_context->set_buffer_data(data.camera_data_buffer, 0, sizeof(camera_data), const_cast<void*>((void*)(&(data.per_camera_data))));
-            device_context->end();
-            device_context->submit();
-
-            cam.changed = false;
         }
     }
-    for (auto cam : m_orthographic_cameras)
+
+    for (key material_id : m_dirty_materials)
     {
-        m_requires_auto_exposure |= cam.adaptive_exposure;
-        if (cam.changed)
-        {
-            camera_gpu_data& data = m_camera_gpu_data[cam.gpu_data];
-            // we can assume these exist, because of update_scene_graph()
-            const node& nd       = m_nodes[cam.node_hnd.id_unchecked()];
-            const mat4& trafo    = m_global_transformation_matrices[nd.global_matrix_hnd.id_unchecked()];
-            vec3 camera_position = trafo.col(3).head<3>();
-
-            mat4 view, projection;
-            view_projection_orthographic_camera(cam, camera_position, view, projection);
-            const mat4 view_projection = projection * view;
-
-            data.per_camera_data.view_matrix             = view;
-            data.per_camera_data.projection_matrix       = projection;
-            data.per_camera_data.view_projection_matrix  = view_projection;
-            data.per_camera_data.inverse_view_projection = view_projection.inverse();
-            data.per_camera_data.camera_position         = camera_position;
-            data.per_camera_data.camera_near             = cam.z_near;
-            data.per_camera_data.camera_far              = cam.z_far;
-
-            float ape;
-            float shu;
-            float iso;
-            if (cam.adaptive_exposure) // Has to be calculated each frame if enabled.
-            {
-                ape = default_camera_aperture;
-                shu = default_camera_shutter_speed;
-                iso = default_camera_iso;
-
-                // K is a light meter calibration constant
-                static const float K = 12.5f;
-                static const float S = 100.0f;
-                float target_ev      = log2f(m_average_luminance * S / K);
-
-                // Compute the resulting ISO if we left both shutter and aperture here
-                iso                 = clamp(((ape * ape) * 100.0f) / (shu * exp2f(target_ev)), min_camera_iso, max_camera_iso);
-                float unclamped_iso = (shu * exp2f(target_ev));
-                MANGO_UNUSED(unclamped_iso);
-
-                // Apply half the difference in EV to the aperture
-                float ev_diff = target_ev - log2f(((ape * ape) * 100.0f) / (shu * iso));
-                ape           = clamp(ape * powf(sqrtf(2.0f), ev_diff * 0.5f), min_camera_aperture, max_camera_aperture);
-
-                // Apply the remaining difference to the shutter speed
-                ev_diff = target_ev - log2f(((ape * ape) * 100.0f) / (shu * iso));
-                shu     = clamp(shu * powf(2.0f, -ev_diff), min_camera_shutter_speed, max_camera_shutter_speed);
-            }
-            else
-            {
-                ape = cam.physical.aperture;
-                shu = cam.physical.shutter_speed;
-                iso = cam.physical.iso;
-            }
-            cam.physical.aperture                = clamp(ape, min_camera_aperture, max_camera_aperture);
-            cam.physical.shutter_speed           = clamp(shu, min_camera_shutter_speed, max_camera_shutter_speed);
-            cam.physical.iso                     = clamp(iso, min_camera_iso, max_camera_iso);
-            float e                              = ((ape * ape) * 100.0f) / (shu * iso);
-            data.per_camera_data.camera_exposure = 1.0f / (1.2f * e);
-
-            auto device_context = m_scene_graphics_device->create_graphics_device_context();
-            device_context->begin();
-            device_context->set_buffer_data(data.camera_data_buffer, 0, sizeof(camera_data), const_cast<void*>((void*)(&(data.per_camera_data))));
-            device_context->end();
-            device_context->submit();
-
-            cam.changed = false;
-        }
+        material& mat           = m_materials[material_id];
+        material_gpu_data& data = m_material_gpu_data[mat.gpu_data];
+        m_material_data_ring.write(data.material_data_index, &data.per_material_data);
+        mat.changed = false;
     }
+    m_dirty_materials.clear();
 
-    // Lights are only updated if they are instantiated in the hierarchy.
-    m_light_stack.update(this);
-    m_light_gpu_data.scene_light_data = m_light_stack.get_light_data();
+    // copies all pending writes into the frame slot used for rendering this frame.
+    m_model_data_ring.begin_frame(device_context);
+    m_material_data_ring.begin_frame(device_context);
 
-    auto device_context = m_scene_graphics_device->create_graphics_device_context();
-    device_context->begin();
-    device_context->set_buffer_data(m_light_gpu_data.light_data_buffer, 0, sizeof(light_data), const_cast<void*>((void*)(&(m_light_gpu_data.scene_light_data))));
     device_context->end();
     device_context->submit();
 
-    for (auto mat : m_materials)
+    for (key texture_id : m_dirty_textures)
     {
-        if (mat.changed)
+        // the texture could have been removed after it was handed out
+        if (!m_textures.valid(texture_id))
+            continue;
+
+        texture& tex = m_textures[texture_id];
+        if (!tex.changed || tex.pending)
+            continue;
+
+        // TODO Paul: This does crash when we do this for textures from a model -.-...
+
+        // just replacing the texture should work, but is not the fancy way. Also we reload the file even though it is not required.
+
+        // TODO Paul: We probably want more exposed settings here!
+        sampler_create_info sampler_info;
+        sampler_info.sampler_min_filter      = gfx_sampler_filter::sampler_filter_linear_mipmap_linear;
+        sampler_info.sampler_max_filter      = gfx_sampler_filter::sampler_filter_linear;
+        sampler_info.enable_comparison_mode  = false;
+        sampler_info.comparison_operator     = gfx_compare_operator::compare_operator_always;
+        sampler_info.edge_value_wrap_u       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
+        sampler_info.edge_value_wrap_v       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
+        sampler_info.edge_value_wrap_w       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
+        sampler_info.border_color[0]         = 0;
+        sampler_info.border_color[1]         = 0;
+        sampler_info.border_color[2]         = 0;
+        sampler_info.border_color[3]         = 0;
+        sampler_info.enable_seamless_cubemap = false;
+
+        auto texture_sampler_pair = create_gfx_texture_and_sampler(tex.file_path, tex.standard_color_space, tex.high_dynamic_range, sampler_info);
+
+        replace_texture_gpu_data(m_texture_gpu_data[tex.gpu_data], texture_sampler_pair, m_static_primitive_revision);
+
+        tex.changed = false;
+    }
+    m_dirty_textures.clear();
+}
+
+void scene_impl::replace_texture_gpu_data(texture_gpu_data& data, const std::pair<gfx_handle<const gfx_texture>, gfx_handle<const gfx_sampler>>& texture_sampler_pair,
+                                          uint32& static_primitive_revision)
+{
+    data.graphics_texture = texture_sampler_pair.first;
+    data.graphics_sampler = texture_sampler_pair.second;
+
+    // the texture could be the base color texture of a cached static shadow caster.
+    ++static_primitive_revision;
+}
+
+void scene_impl::update_primitive_instances()
+{
+    PROFILE_ZONE;
+
+    if (!m_primitive_instances_changed)
+    {
+        // only the primitives of moved meshes have to be refitted
+        for (key mesh_id : m_dirty_meshes)
         {
-            material_gpu_data& data = m_material_gpu_data[mat.gpu_data];
-
-            data.per_material_data.base_color                 = mat.base_color.as_vec4();
-            data.per_material_data.emissive_color             = mat.emissive_color.as_vec3();
-            data.per_material_data.metallic                   = mat.metallic;
-            data.per_material_data.roughness                  = mat.roughness;
-            data.per_material_data.base_color_texture         = mat.base_color_texture.valid() && m_textures.valid(mat.base_color_texture.id_unchecked());
-            data.per_material_data.roughness_metallic_texture = mat.metallic_roughness_texture.valid() && m_textures.valid(mat.metallic_roughness_texture.id_unchecked());
-            data.per_material_data.occlusion_texture          = mat.occlusion_texture.valid() && m_textures.valid(mat.occlusion_texture.id_unchecked());
-            data.per_material_data.packed_occlusion           = mat.packed_occlusion;
-            data.per_material_data.normal_texture             = mat.normal_texture.valid() && m_textures.valid(mat.normal_texture.id_unchecked());
-            data.per_material_data.emissive_color_texture     = mat.emissive_texture.valid() && m_textures.valid(mat.emissive_texture.id_unchecked());
-            data.per_material_data.emissive_intensity         = mat.emissive_intensity;
-            data.per_material_data.alpha_mode                 = static_cast<uint8>(mat.alpha_mode);
-            data.per_material_data.alpha_cutoff               = mat.alpha_cutoff;
-
-            device_context->begin();
-            device_context->set_buffer_data(data.material_data_buffer, 0, sizeof(material_data), const_cast<void*>((void*)(&(data.per_material_data))));
-            device_context->end();
-            device_context->submit();
-
-            mat.changed = false;
+            auto it = m_mesh_to_primitive_instance.find(mesh_id);
+            if (it == m_mesh_to_primitive_instance.end())
+                continue;
+
+            const mesh& m     = m_meshes[mesh_id];
+            const mat4& trafo = m_mesh_gpu_data[m.gpu_data].per_mesh_data.model_matrix;
+            uint32 index      = it->second;
+            for (const handle<primitive>& p : m.primitives)
+            {
+                primitive_instance& instance = m_primitive_instances[index];
+                instance.bounding_box        = m_primitives[p.id_unchecked()].bounding_box.get_transformed(trafo);
+                instance.unmoved_updates     = 0;
+                m_primitive_bvh.update_item(index, instance.bounding_box);
+                if (!instance.dynamic)
+                {
+                    instance.dynamic = true;
+                    m_dynamic_primitive_instances.push_back(index);
+                    ++m_static_primitive_revision;
+                }
+                ++index;
+            }
         }
+
+        // primitives staying in place long enough are static again
+        auto first_static = std::remove_if(m_dynamic_primitive_instances.begin(), m_dynamic_primitive_instances.end(), [this](uint32 index) {
+            primitive_instance& instance = m_primitive_instances[index];
+            if (++instance.unmoved_updates < static_primitive_update_count)
+                return false;
+            instance.dynamic = false;
+            return true;
+        });
+        if (first_static != m_dynamic_primitive_instances.end())
+        {
+            m_dynamic_primitive_instances.erase(first_static, m_dynamic_primitive_instances.end());
+            ++m_static_primitive_revision;
+        }
+        return;
     }
 
-    for (auto tex : m_textures)
+    // all primitives start static
+    m_primitive_instances.clear();
+    m_dynamic_primitive_instances.clear();
+    ++m_static_primitive_revision;
+    m_mesh_to_primitive_instance.clear();
+    std::vector<axis_aligned_bounding_box> bounds;
+
+    // the render instances contain every node in the scene graph
+    for (const render_instance& ri : m_render_instances)
     {
-        if (tex.changed)
+        const node& nd = m_nodes[ri.node_hnd.id_unchecked()];
+        if ((nd.type & node_type::mesh) == node_type::hierarchy)
+            continue;
+
+        key mesh_id       = nd.mesh_hnd.id_unchecked();
+        const mesh& m     = m_meshes[mesh_id];
+        const mat4& trafo = m_global_transformation_matrices[nd.global_matrix_hnd.id_unchecked()];
+        m_mesh_to_primitive_instance.emplace(mesh_id, static_cast<uint32>(m_primitive_instances.size()));
+        for (const handle<primitive>& p : m.primitives)
         {
-            // TODO Paul: This does crash when we do this for textures from a model -.-...
+            primitive_instance instance;
+            instance.primitive_hnd    = p;
+            instance.mesh_gpu_data_id = m.gpu_data;
+            instance.bounding_box     = m_primitives[p.id_unchecked()].bounding_box.get_transformed(trafo);
+            m_primitive_instances.push_back(instance);
+            bounds.push_back(instance.bounding_box);
+        }
+    }
 
-            // just replacing the texture should work, but is not the fancy way. Also we reload the file even though it is not required.
+    m_primitive_bvh.build(bounds);
+    m_primitive_instances_changed = false;
+}
 
-            // TODO Paul: We probably want more exposed settings here!
-            sampler_create_info sampler_info;
-            sampler_info.sampler_min_filter      = gfx_sampler_filter::sampler_filter_linear_mipmap_linear;
-            sampler_info.sampler_max_filter      = gfx_sampler_filter::sampler_filter_linear;
-            sampler_info.enable_comparison_mode  = false;
-            sampler_info.comparison_operator     = gfx_compare_operator::compare_operator_always;
-            sampler_info.edge_value_wrap_u       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
-            sampler_info.edge_value_wrap_v       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
-            sampler_info.edge_value_wrap_w       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
-            sampler_info.border_color[0]         = 0;
-            sampler_info.border_color[1]         = 0;
-            sampler_info.border_color[2]         = 0;
-            sampler_info.border_color[3]         = 0;
-            sampler_info.enable_seamless_cubemap = false;
+template <typename camera_type>
+void scene_impl::update_camera_data(camera_type& cam, camera_gpu_data& data, const vec3& camera_position, const mat4& view, const mat4& projection)
+{
+    const mat4 view_projection = projection * view;
 
-            auto texture_sampler_pair = create_gfx_texture_and_sampler(tex.file_path, tex.standard_color_space, tex.high_dynamic_range, sampler_info);
+    data.per_camera_data.view_matrix             = view;
+    data.per_camera_data.projection_matrix       = projection;
+    data.per_camera_data.view_projection_matrix  = view_projection;
+    data.per_camera_data.inverse_view_projection = view_projection.inverse();
+    data.per_camera_data.camera_position         = camera_position;
+    data.per_camera_data.camera_near             = cam.z_near;
+    data.per_camera_data.camera_far              = cam.z_far;
 
-            texture_gpu_data data = m_texture_gpu_data[tex.gpu_data];
+    float ape;
+    float shu;
+    float iso;
+    if (cam.adaptive_exposure)
+    {
+        ape = default_camera_aperture;
+        shu = default_camera_shutter_speed;
+        iso = default_camera_iso;
 
-            data.graphics_texture = texture_sampler_pair.first;
-            data.graphics_sampler = texture_sampler_pair.second;
+        // K is a light meter calibration constant
+        static const float K = 12.5f;
+        static const float S = 100.0f;
+        float target_ev      = log2f(m_average_luminance * S / K);
 
-            tex.changed = false;
-        }
+        // Compute the resulting ISO if we left both shutter and aperture here
+        iso                 = clamp(((ape * ape) * 100.0f) / (shu * exp2f(target_ev)), min_camera_iso, max_camera_iso);
+        float unclamped_iso = (shu * exp2f(target_ev));
+        MANGO_UNUSED(unclamped_iso);
+
+        // Apply half the difference in EV to the aperture
+        float ev_diff = target_ev - log2f(((ape * ape) * 100.0f) / (shu * iso));
+        ape           = clamp(ape * powf(sqrtf(2.0f), ev_diff * 0.5f), min_camera_aperture, max_camera_aperture);
+
+        // Apply the remaining difference to the shutter speed
+        ev_diff = target_ev - log2f(((ape * ape) * 100.0f) / (shu * iso));
+        shu     = clamp(shu * powf(2.0f, -ev_diff), min_camera_shutter_speed, max_camera_shutter_speed);
     }
+    else
+    {
+        ape = cam.physical.aperture;
+        shu = cam.physical.shutter_speed;
+        iso = cam.physical.iso;
+    }
+    cam.physical.aperture                = clamp(ape, min_camera_aperture, max_camera_aperture);
+    cam.physical.shutter_speed           = clamp(shu, min_camera_shutter_speed, max_camera_shutter_speed);
+    cam.physical.iso                     = clamp(iso, min_camera_iso, max_camera_iso);
+    float e                              = ((ape * ape) * 100.0f) / (shu * iso);
+    data.per_camera_data.camera_exposure = 1.0f / (1.2f * e);
 }
 
 void scene_impl::draw_scene_hierarchy(handle<node>& selected)
@@ -2737,9 +3267,7 @@ std::vector<handle<node>> scene_impl::draw_scene_hierarchy_internal(handle<node>
             IM_ASSERT(payload->DataSize == sizeof(handle<node>) * 2);
             const handle<node>* dropped = (const handle<node>*)payload->Data;
             MANGO_ASSERT(dropped[0].valid(), "Dropped node is NULL_HND!");
-            attach(dropped[0], current);
-            if (dropped[1].valid())
-                detach(dropped[0], dropped[1]);
+            attach(dropped[0], current); // also removes it from the old parent
         }
         ImGui::EndDragDropTarget();
     }
@@ -2793,9 +3321,44 @@ string scene_impl::get_display_name(node_type type, const string name) // TODO P
     {
         return name.empty() ? string(ICON_FA_LIGHTBULB) + "Unnamed" : string(ICON_FA_LIGHTBULB) + " " + name + postfix;
     }
+    if ((type & node_type::point_light) != node_type::hierarchy)
+    {
+        return name.empty() ? string(ICON_FA_LIGHTBULB) + "Unnamed" : string(ICON_FA_LIGHTBULB) + " " + name + postfix;
+    }
+    if ((type & node_type::spot_light) != node_type::hierarchy)
+    {
+        return name.empty() ? string(ICON_FA_LIGHTBULB) + "Unnamed" : string(ICON_FA_LIGHTBULB) + " " + name + postfix;
+    }
     return name.empty() ? string(ICON_FA_VECTOR_SQUARE) + "Unnamed" : string(ICON_FA_VECTOR_SQUARE) + " " + name + postfix;
 }
 
+static sampler_create_info image_texture_sampler_info()
+{
+    // TODO Paul: We probably want more exposed settings here!
+    sampler_create_info sampler_info;
+    sampler_info.sampler_min_filter      = gfx_sampler_filter::sampler_filter_linear_mipmap_linear;
+    sampler_info.sampler_max_filter      = gfx_sampler_filter::sampler_filter_linear;
+    sampler_info.enable_comparison_mode  = false;
+    sampler_info.comparison_operator     = gfx_compare_operator::compare_operator_always;
+    sampler_info.edge_value_wrap_u       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
+    sampler_info.edge_value_wrap_v       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
+    sampler_info.edge_value_wrap_w       = gfx_sampler_edge_wrap::sampler_edge_wrap_repeat;
+    sampler_info.border_color[0]         = 0;
+    sampler_info.border_color[1]         = 0;
+    sampler_info.border_color[2]         = 0;
+    sampler_info.border_color[3]         = 0;
+    sampler_info.enable_seamless_cubemap = false;
+    return sampler_info;
+}
+
+static int64 get_image_upload_size(const image_resource& img)
+{
+    int64 size = 0;
+    for (int32 level = 0; level < img.mip_levels; ++level)
+        size += get_image_level_size(img, level);
+    return size;
+}
+
 static int32 get_attrib_component_count_from_tinygltf_types(int32 type)
 {
     switch (type)
@@ -2856,3 +3419,34 @@ static gfx_sampler_edge_wrap get_texture_wrap_from_tinygltf(int32 wrap)
         return gfx_sampler_edge_wrap::sampler_edge_wrap_unknown;
     }
 }
+
+template <typename T, typename F>
+static void parallel_update(job_system* jobs, frame_arena& arena, slotmap<T>& data, std::vector<key>& dirty, const F& update_function)
+{
+    // elements can be marked multiple times per frame and could be removed in between
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+    dirty.erase(std::remove_if(dirty.begin(), dirty.end(), [&data](key k) { return !data.valid(k); }), dirty.end());
+
+    const uint32 count = static_cast<uint32>(dirty.size());
+    frame_vector<uint8> needs_upload(count, 0, arena);
+
+    auto update_chunk = [&data, &dirty, &needs_upload, &update_function](uint32 begin, uint32 end) {
+        // the keys are unique, so no synchronization is required
+        for (uint32 i = begin; i < end; ++i)
+            needs_upload[i] = update_function(data[dirty[i]]) ? 1 : 0;
+    };
+
+    if (jobs)
+        jobs->parallel_for(count, scene_update_chunk_size, update_chunk);
+    else
+        update_chunk(0, count);
+
+    uint32 kept = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (needs_upload[i])
+            dirty[kept++] = dirty[i];
+    }
+    dirty.resize(kept);
+}
@@ -7,13 +7,20 @@
 #ifndef MANGO_SCENE_IMPL_HPP
 #define MANGO_SCENE_IMPL_HPP
 
+#include <graphics/geometry_heap.hpp>
 #include <graphics/graphics.hpp>
+#include <graphics/uniform_ring_buffer.hpp>
 #include <mango/scene.hpp>
 #include <mango/slotmap.hpp>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <queue>
+#include <unordered_map>
 #include <rendering/light_stack.hpp>
+#include <scene/bounding_volume_hierarchy.hpp>
 #include <scene/scene_structures_internal.hpp>
+#include <scene/transform_hierarchy.hpp>
 #include <util/helpers.hpp>
 
 namespace mango
@@ -35,11 +42,15 @@ namespace mango
         handle<directional_light> add_directional_light(directional_light& new_directional_light, handle<node> node_hnd) override;
         handle<skylight> add_skylight(skylight& new_skylight, handle<node> node_hnd) override;
         handle<atmospheric_light> add_atmospheric_light(atmospheric_light& new_atmospheric_light, handle<node> node_hnd) override;
+        handle<point_light> add_point_light(point_light& new_point_light, handle<node> node_hnd) override;
+        handle<spot_light> add_spot_light(spot_light& new_spot_light, handle<node> node_hnd) override;
 
         handle<material> build_material(material& new_material) override;
         handle<texture> load_texture_from_image(const string& path, bool standard_color_space, bool high_dynamic_range) override;
 
         handle<model> load_model_from_gltf(const string& path) override;
+        handle<texture> load_texture_from_image_async(const string& path, bool standard_color_space, bool high_dynamic_range) override;
+        handle<model> load_model_from_gltf_async(const string& path) override;
         void add_model_to_scene(handle<model> model_to_add, handle<scenario> scenario_hnd, handle<node> node_hnd) override;
 
         handle<skylight> add_skylight_from_hdr(const string& path, handle<node> node_hnd) override;
@@ -53,6 +64,8 @@ namespace mango
         void remove_directional_light(handle<node> node_hnd) override;
         void remove_skylight(handle<node> node_hnd) override;
         void remove_atmospheric_light(handle<node> node_hnd) override;
+        void remove_point_light(handle<node> node_hnd) override;
+        void remove_spot_light(handle<node> node_hnd) override;
         void unload_gltf_model(handle<model> model_hnd) override;
 
         optional<node&> get_node(handle<node> node_hnd) override;
@@ -62,6 +75,8 @@ namespace mango
         optional<directional_light&> get_directional_light(handle<node> node_hnd) override;
         optional<skylight&> get_skylight(handle<node> node_hnd) override;
         optional<atmospheric_light&> get_atmospheric_light(handle<node> node_hnd) override;
+        optional<point_light&> get_point_light(handle<node> node_hnd) override;
+        optional<spot_light&> get_spot_light(handle<node> node_hnd) override;
 
         optional<model&> get_model(handle<model> instance_hnd) override;
         optional<mesh&> get_mesh(handle<mesh> instance_hnd) override;
@@ -85,6 +100,12 @@ namespace mango
         //! \return An optional \a primitive reference.
         optional<primitive&> get_primitive(handle<primitive> instance_hnd);
 
+        //! \brief Retrieves a \a material from the \a scene for reading.
+        //! \details Other than \a get_material() this does not mark the \a material as possibly changed.
+        //! \param[in] instance_hnd The \a handle of the \a material to retrieve from the \a scene.
+        //! \return An optional constant \a material reference.
+        optional<const material&> read_material(handle<material> instance_hnd) const;
+
         //! \brief Retrieves a global transformation matrix from the \a scene.
         //! \param[in] instance_hnd The \a handle of the \a mat4 to retrieve from the \a scene.
         //! \return An optional matrix reference.
@@ -119,11 +140,6 @@ namespace mango
         //! \return The constant \a light_gpu_data reference.
         const light_gpu_data& get_light_gpu_data();
 
-        //! \brief Retrieves a \a buffer_view from the \a scene.
-        //! \param[in] instance_hnd The \a handle of the \a buffer_view to retrieve from the \a scene.
-        //! \return An optional \a buffer_view reference.
-        optional<buffer_view&> get_buffer_view(handle<buffer_view> instance_hnd);
-
         //! \brief Retrieves the \a camera_gpu_data from the active \a camera from the \a scene.
         //! \return The optional \a camera_gpu_data referenced from the active \a camera.
         optional<camera_gpu_data&> get_active_camera_gpu_data();
@@ -154,6 +170,39 @@ namespace mango
             return m_render_instances;
         }
 
+        //! \brief Retrieves the list of \a primitive_instances from the \a scene to render.
+        //! \details The indices are the items of the \a bounding_volume_hierarchy retrieved by \a get_primitive_bvh().
+        //! \return The list of \a primitive_instances from the \a scene to render.
+        inline const std::vector<primitive_instance>& get_primitive_instances()
+        {
+            return m_primitive_instances;
+        }
+
+        //! \brief Retrieves the indices of all dynamic \a primitive_instances.
+        //! \return The indices of the \a primitive_instances, that moved recently.
+        inline const std::vector<uint32>& get_dynamic_primitive_instances()
+        {
+            return m_dynamic_primitive_instances;
+        }
+
+        //! \brief Retrieves the revision of the static \a primitive_instances.
+        //! \details The revision changes, whenever the set of static \a primitive_instances changes,
+        //! or a \a material or \a texture used to draw them is changed.
+        //! Everything cached for the static \a primitive_instances is valid as long as the revision stays the same.
+        //! \return The revision of the static \a primitive_instances.
+        inline uint32 get_static_primitive_revision()
+        {
+            return m_static_primitive_revision;
+        }
+
+        //! \brief Retrieves the \a bounding_volume_hierarchy over the world bounds of all \a primitive_instances.
+        //! \details Used by the \a renderer to cull against camera and shadow frusta.
+        //! \return The \a bounding_volume_hierarchy of the \a scene.
+        inline const bounding_volume_hierarchy& get_primitive_bvh()
+        {
+            return m_primitive_bvh;
+        }
+
         //! \brief Draws the hierarchy of \a nodes in a ui widget.
         //! \param[in,out] selected The \a handle of the selected \a node.
         //! \details Does not create an ImGui window, only draws contents.
@@ -173,6 +222,22 @@ namespace mango
             return m_light_stack;
         }
 
+        //! \brief Retrieves the \a uniform_ring_buffer holding the \a model_data of all \a mesh instances.
+        //! \details Bind the \a model_data of some \a mesh_gpu_data with its model_data_index.
+        //! \return The \a uniform_ring_buffer for \a model_data.
+        inline const uniform_ring_buffer& get_model_data_ring()
+        {
+            return m_model_data_ring;
+        }
+
+        //! \brief Retrieves the \a uniform_ring_buffer holding the \a material_data of all \a materials.
+        //! \details Bind the \a material_data of some \a material_gpu_data with its material_data_index.
+        //! \return The \a uniform_ring_buffer for \a material_data.
+        inline const uniform_ring_buffer& get_material_data_ring()
+        {
+            return m_material_data_ring;
+        }
+
         //! \brief Returns if a camera in the \a scene requires auto exposure calculations.
         //! \return True if a camera in the \a scene requires auto exposure calculations, else false.
         inline bool calculate_auto_exposure()
@@ -180,6 +245,23 @@ namespace mango
             return m_requires_auto_exposure;
         }
 
+        //! \brief Retrieves the \a geometry_layouts of all \a primitives loaded since the last call.
+        //! \details Used by the \a renderer to create pipelines for new geometry before it gets drawn.
+        //! \param[out] layouts The list to append the \a geometry_layouts to.
+        inline void collect_new_geometry_layouts(std::vector<geometry_layout>& layouts)
+        {
+            layouts.insert(layouts.end(), m_new_geometry_layouts.begin(), m_new_geometry_layouts.end());
+            m_new_geometry_layouts.clear();
+        }
+
+        //! \brief Replaces the \a gfx_texture and \a gfx_sampler of a \a texture_gpu_data.
+        //! \details Bumps the revision of the static \a primitive_instances, since the \a texture could be used by a cached static shadow caster.
+        //! \param[in,out] data The \a texture_gpu_data to change.
+        //! \param[in] texture_sampler_pair The new \a gfx_texture and \a gfx_sampler.
+        //! \param[in,out] static_primitive_revision The revision of the static \a primitive_instances to bump.
+        static void replace_texture_gpu_data(texture_gpu_data& data, const std::pair<gfx_handle<const gfx_texture>, gfx_handle<const gfx_sampler>>& texture_sampler_pair,
+                                             uint32& static_primitive_revision);
+
       private:
         //! \brief Loads an image from a path and creates and returns a \a gfx_texture and \a gfx_sampler for the image.
         //! \param[in] path The full path to the image to load.
@@ -199,6 +281,14 @@ namespace mango
         std::pair<gfx_handle<const gfx_texture>, gfx_handle<const gfx_sampler>> create_gfx_texture_and_sampler(const image_resource& img, bool standard_color_space, bool high_dynamic_range,
                                                                                                                const sampler_create_info& sampler_info);
 
+        //! \brief Uploads the results of finished asynchronous loads.
+        //! \details Processes the results in order until the upload budget of the frame is used up, at least one result is processed per call.
+        void process_async_loads();
+
+        //! \brief Returns the placeholder \a gfx_texture for pending \a textures and creates it if not already done.
+        //! \return The 1x1 white placeholder \a gfx_texture.
+        gfx_handle<const gfx_texture> pending_texture_placeholder();
+
         //! \brief Loads a model file and creates a \a scenario list with \a handles of all \a scenarios in the model.
         //! \details Creates and stores all necessary resources and structures to add the model to a scene.
         //! \param[in] path The full path to the model to load.
@@ -207,31 +297,30 @@ namespace mango
         std::vector<handle<scenario>> load_model_from_file(const string& path, int32& default_scenario);
 
         //! \brief Builds a \a node from a tinygltf model node.
-        //! \param[in] m The loaded tinygltf model.
+        //! \param[in] mr The loaded \a model_resource.
         //! \param[in] n The tinygltf model node.
-        //! \param[in] buffer_view_ids The \a keys of all loaded \a buffer_views.
         //! \return The \a handle of the created \a node.
-        handle<node> build_model_node(tinygltf::Model& m, tinygltf::Node& n, const std::vector<key>& buffer_view_ids);
+        handle<node> build_model_node(const model_resource& mr, const tinygltf::Node& n);
 
         //! \brief Builds a \a camera from a tinygltf model camera.
         //! \param[in] t_camera The loaded tinygltf model camera.
         //! \param[in] node_hnd The \a key of the \a handle of the \a node the \a camera should be added to.
         //! \param[in] target The target vector of the \a camera to build.
-        void build_model_camera(tinygltf::Camera& t_camera, handle<node> node_hnd, const vec3& target);
+        void build_model_camera(const tinygltf::Camera& t_camera, handle<node> node_hnd, const vec3& target);
 
         //! \brief Builds a \a mesh from a tinygltf model mesh.
-        //! \param[in] m The loaded tinygltf model.
+        //! \details The geometry is added to the \a geometry_heap and uploaded with the next flush of the heap.
+        //! \param[in] mr The loaded \a model_resource.
         //! \param[in] t_mesh The loaded tinygltf model mesh.
         //! \param[in] node_hnd The \a handle of the \a node the \a mesh should be added to.
-        //! \param[in] buffer_view_ids The \a keys of all loaded \a buffer_views.
         //! \return The \a handle of the created \a mesh or NULL_HND on error.
-        handle<mesh> build_model_mesh(tinygltf::Model& m, tinygltf::Mesh& t_mesh, handle<node> node_hnd, const std::vector<key>& buffer_view_ids);
+        handle<mesh> build_model_mesh(const model_resource& mr, const tinygltf::Mesh& t_mesh, handle<node> node_hnd);
 
         //! \brief Builds a \a material from a tinygltf model material.
         //! \param[in] primitive_material The loaded tinygltf model material.
-        //! \param[in] m The loaded tinygltf model.
+        //! \param[in] mr The loaded \a model_resource.
         //! \return The \a handle of the created \a material or NULL_HND on error.
-        handle<material> load_material(const tinygltf::Material& primitive_material, tinygltf::Model& m);
+        handle<material> load_material(const tinygltf::Material& primitive_material, const model_resource& mr);
 
         //! \brief Returns the \a handle of the default material and creates it if not already done.
         handle<material> default_material();
@@ -245,11 +334,25 @@ namespace mango
         //! \param[in] node_hnd The \a handle of the \a node to remove.
         void remove_model_node(handle<node> node_hnd);
 
-        //! \brief Traverses a \a node and its children in the scene graph and updates the transformation if necessary; also creates render instances.
-        //! \param[in] node_hnd The \a handle of the node.
-        //! \param[in] parent_hnd The \a handle of the parent or NULL_HND, when root.
-        //! \param[in] force_update Force the update (when the parent had to be updated).
-        void update_scene_graph(handle<node> node_hnd, handle<node> parent_hnd, bool force_update);
+        //! \brief Updates the transformations of all \a nodes in the scene graph if necessary; also creates render instances.
+        //! \details Iterates the \a transform_hierarchy linearly instead of traversing the scene graph recursively.
+        //! \param[in] jobs Pointer to the \a job_system used to update the \a transform_hierarchy.
+        void update_scene_graph(job_system* jobs);
+
+        //! \brief Updates the \a primitive_instances and their \a bounding_volume_hierarchy.
+        //! \details Rebuilds everything after \a meshes were added or removed, else only refits the \a primitives of changed \a meshes.
+        //! Moved \a primitives are classified as dynamic, until they stayed in place for \a static_primitive_update_count updates.
+        //! Has to be called after the \a meshes were updated and before the dirty list of \a meshes is consumed.
+        void update_primitive_instances();
+
+        //! \brief Calculates the \a camera_data of a camera and the resulting exposure.
+        //! \param[in,out] cam The \a perspective_camera or \a orthographic_camera, the physical parameters are updated when adaptive exposure is enabled.
+        //! \param[out] data The \a camera_gpu_data to write to.
+        //! \param[in] camera_position The position of the camera.
+        //! \param[in] view The view matrix of the camera.
+        //! \param[in] projection The projection matrix of the camera.
+        template <typename camera_type>
+        void update_camera_data(camera_type& cam, camera_gpu_data& data, const vec3& camera_position, const mat4& view, const mat4& projection);
 
         //! \brief Mangos internal context for shared usage in all \a scenes.
         shared_ptr<context_impl> m_shared_context;
@@ -258,6 +361,10 @@ namespace mango
         light_stack m_light_stack;
         //! \brief The \a light_gpu_data in the \a scene.
         light_gpu_data m_light_gpu_data;
+        //! \brief The \a uniform_ring_buffer holding the \a model_data of all \a mesh instances.
+        uniform_ring_buffer m_model_data_ring;
+        //! \brief The \a uniform_ring_buffer holding the \a material_data of all \a materials.
+        uniform_ring_buffer m_material_data_ring;
         //! \brief The \a slotmap for all \a models in the \a scene.
         slotmap<model> m_models;
         //! \brief The \a slotmap for all \a scenarios in the \a scene.
@@ -268,6 +375,8 @@ namespace mango
         slotmap<transform> m_transforms;
         //! \brief The \a slotmap for all world transformations of the \a nodes in the \a scene.
         slotmap<mat4> m_global_transformation_matrices;
+        //! \brief The flat \a transform_hierarchy of all \a nodes instantiated in the scene graph.
+        transform_hierarchy m_transform_hierarchy;
 
         //! \brief The \a slotmap for all \a meshes in the \a scene.
         slotmap<mesh> m_meshes;
@@ -299,9 +408,47 @@ namespace mango
         slotmap<skylight> m_skylights;
         //! \brief The \a slotmap for all \a atmospheric_lights in the \a scene.
         slotmap<atmospheric_light> m_atmospheric_lights;
+        //! \brief The \a slotmap for all \a point_lights in the \a scene.
+        slotmap<point_light> m_point_lights;
+        //! \brief The \a slotmap for all \a spot_lights in the \a scene.
+        slotmap<spot_light> m_spot_lights;
+
+        //! \brief The \a geometry_heap holding the vertices and indices of all \a primitives in the \a scene.
+        geometry_heap m_geometry_heap;
+
+        //! \brief The result of a finished asynchronous load, waiting for the upload on the main thread.
+        struct async_load_result
+        {
+            //! \brief The \a handle of the pending \a texture or NULL_HND.
+            handle<texture> texture_hnd;
+            //! \brief The \a handle of the pending \a model or NULL_HND.
+            handle<model> model_hnd;
+            //! \brief The loaded \a image_resource for a \a texture or nullptr on failure.
+            const image_resource* image = nullptr;
+            //! \brief The loaded \a model_resource for a \a model or nullptr on failure.
+            const model_resource* model = nullptr;
+            //! \brief The number of bytes to upload.
+            int64 upload_size = 0;
+        };
+
+        //! \brief The results of finished asynchronous loads, shared with the loading jobs.
+        //! \details Shared, so jobs finishing after the \a scene is destroyed do not access freed memory.
+        struct async_load_queue
+        {
+            //! \brief Mutex guarding the results.
+            std::mutex mutex;
+            //! \brief The results in order of completion.
+            std::deque<async_load_result> finished;
+        };
+
+        //! \brief The \a async_load_queue of the \a scene.
+        shared_ptr<async_load_queue> m_async_loads;
 
-        //! \brief The \a slotmap for all \a buffer_views in the \a scene.
-        slotmap<buffer_view> m_buffer_views;
+        //! \brief The placeholder \a gfx_texture for pending \a textures.
+        gfx_handle<const gfx_texture> m_pending_texture_placeholder;
+
+        //! \brief The \a geometry_layouts of \a primitives loaded since they were last collected by the \a renderer.
+        std::vector<geometry_layout> m_new_geometry_layouts;
 
         //! \brief Maps names of materials to already loaded \a material \a handles.
         std::map<string, handle<material>> m_material_name_to_handle;
@@ -321,10 +468,41 @@ namespace mango
 
         //! \brief The \a graphics_device of the \a scene.
         const graphics_device_handle& m_scene_graphics_device;
+        //! \brief The \a graphics_device_context recording the uploads of each \a update(), kept to not create one every frame.
+        graphics_device_context_handle m_update_context;
 
         //! \brief The current list if \a render_instances.
         std::vector<render_instance> m_render_instances;
 
+        //! \brief The \a primitive_instances of all \a meshes instantiated in the scene graph.
+        std::vector<primitive_instance> m_primitive_instances;
+        //! \brief Maps \a mesh \a keys to the index of their first \a primitive_instance.
+        std::unordered_map<key, uint32> m_mesh_to_primitive_instance;
+        //! \brief The \a bounding_volume_hierarchy over the world bounds of all \a primitive_instances.
+        bounding_volume_hierarchy m_primitive_bvh;
+        //! \brief True if \a meshes were added or removed and the \a primitive_instances have to be rebuilt, else false.
+        bool m_primitive_instances_changed = true;
+        //! \brief The indices of all dynamic \a primitive_instances.
+        std::vector<uint32> m_dynamic_primitive_instances;
+        //! \brief The revision of the static \a primitive_instances, incremented whenever they change.
+        uint32 m_static_primitive_revision = 0;
+        //! \brief The number of scene updates a dynamic \a primitive_instance has to stay in place to become static again.
+        static const int32 static_primitive_update_count = 60;
+
+        //! \brief The \a keys of all \a nodes with possibly changed \a transforms since the last update.
+        //! \details Filled when a \a transform is created or handed out, so the update only has to look at these.
+        std::vector<key> m_dirty_transform_nodes;
+        //! \brief The \a keys of all \a meshes requiring an update of their \a model_data.
+        std::vector<key> m_dirty_meshes;
+        //! \brief The \a keys of all possibly changed \a perspective_cameras.
+        std::vector<key> m_dirty_perspective_cameras;
+        //! \brief The \a keys of all possibly changed \a orthographic_cameras.
+        std::vector<key> m_dirty_orthographic_cameras;
+        //! \brief The \a keys of all possibly changed \a materials.
+        std::vector<key> m_dirty_materials;
+        //! \brief The \a keys of all possibly changed \a textures.
+        std::vector<key> m_dirty_textures;
+
         //! \brief The \a handle of the root \a node.
         handle<node> m_root_node;
 
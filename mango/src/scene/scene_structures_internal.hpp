@@ -43,10 +43,13 @@ namespace mango
     {
         //! \brief The gpu data per material.
         material_data per_material_data;
-        //! \brief The graphics uniform buffer for uploading \a material_data.
-        gfx_handle<const gfx_buffer> material_data_buffer;
+        //! \brief The index of the \a material_data in the scenes material \a uniform_ring_buffer.
+        int32 material_data_index;
 
-        material_gpu_data() = default;
+        material_gpu_data()
+            : material_data_index(-1)
+        {
+        }
         //! \brief The \a material_gpu_data is an internal scene structure.
         DECLARE_SCENE_INTERNAL(material_gpu_data);
     };
@@ -75,6 +78,15 @@ namespace mango
         DECLARE_SCENE_INTERNAL(buffer_view);
     };
 
+    //! \brief The layout of the geometry of a \a primitive, used to create pipelines before the geometry gets drawn.
+    struct geometry_layout
+    {
+        //! \brief The \a vertex_input_descriptor of the geometry.
+        vertex_input_descriptor vertex_layout;
+        //! \brief The \a input_assembly_descriptor of the geometry.
+        input_assembly_descriptor input_assembly;
+    };
+
     //! \brief The \a primitive gpu data.
     struct primitive_gpu_data
     {
@@ -107,10 +119,13 @@ namespace mango
     {
         //! \brief The gpu data per mesh.
         model_data per_mesh_data;
-        //! \brief The graphics uniform buffer for uploading \a model_data.
-        gfx_handle<const gfx_buffer> model_data_buffer;
+        //! \brief The index of the \a model_data in the scenes model \a uniform_ring_buffer, -1 for meshes only used as storage.
+        int32 model_data_index;
 
-        mesh_gpu_data() = default;
+        mesh_gpu_data()
+            : model_data_index(-1)
+        {
+        }
         //! \brief The \a mesh_gpu_data is an internal scene structure.
         DECLARE_SCENE_INTERNAL(mesh_gpu_data);
     };
@@ -135,6 +150,12 @@ namespace mango
         light_data scene_light_data;
         //! \brief The graphics uniform buffer for uploading \a light_data. Filled with data provided by the \a light_stack.
         gfx_handle<const gfx_buffer> light_data_buffer;
+        //! \brief The shader storage buffer holding the point and spot lights.
+        gfx_handle<const gfx_buffer> punctual_light_buffer;
+        //! \brief The shader storage buffer holding the offset and count of the lights of each light cluster.
+        gfx_handle<const gfx_buffer> light_cluster_buffer;
+        //! \brief The shader storage buffer holding the light indices referenced by the light clusters.
+        gfx_handle<const gfx_buffer> light_index_buffer;
 
         light_gpu_data() = default;
         //! \brief The \a light_gpu_data is an internal scene structure.
@@ -158,6 +179,32 @@ namespace mango
         DECLARE_SCENE_INTERNAL(render_instance);
     };
 
+    //! \brief An internal structure holding one \a primitive of a \a mesh instantiated in the scene graph.
+    //! \details The index of a \a primitive_instance is the item index in the scenes \a bounding_volume_hierarchy.
+    struct primitive_instance
+    {
+        //! \brief The \a handle of the instantiated \a primitive.
+        handle<primitive> primitive_hnd;
+        //! \brief The \a key of the \a mesh_gpu_data of the \a mesh the \a primitive belongs to.
+        key mesh_gpu_data_id;
+        //! \brief The world space bounds of the \a primitive.
+        axis_aligned_bounding_box bounding_box;
+        //! \brief True if the \a primitive moved recently and is expected to move again, else false.
+        //! \details Static \a primitives can be cached by the renderer, dynamic ones have to be drawn every frame.
+        bool dynamic;
+        //! \brief The number of scene updates the \a primitive did not move, only counted while it is dynamic.
+        int32 unmoved_updates;
+
+        primitive_instance()
+            : mesh_gpu_data_id(0)
+            , dynamic(false)
+            , unmoved_updates(0)
+        {
+        }
+        //! \brief The \a primitive_instance is an internal scene structure.
+        DECLARE_SCENE_INTERNAL(primitive_instance);
+    };
+
 #undef DECLARE_SCENE_INTERNAL
 } // namespace mango
 
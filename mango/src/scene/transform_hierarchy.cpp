@@ -0,0 +1,339 @@
+//! \file      transform_hierarchy.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <core/job_system.hpp>
+#include <mango/profile.hpp>
+#include <scene/transform_hierarchy.hpp>
+
+using namespace mango;
+
+//! \brief Reorders some data with a given order.
+//! \param[in,out] data The data to reorder.
+//! \param[in] order The new order, order[new_index] == old_index.
+template <typename T>
+static void apply_order(std::vector<T>& data, const std::vector<uint32>& order);
+
+//! \brief The number of entries updated by one job.
+static const uint32 update_chunk_size = 1024;
+
+const uint32 transform_hierarchy::invalid_index;
+
+transform_hierarchy::transform_hierarchy()
+    : m_needs_compaction(false)
+    , m_needs_sort(false)
+{
+}
+
+transform_hierarchy::~transform_hierarchy() {}
+
+void transform_hierarchy::add(key node_id, key transform_id, optional<key> parent_node_id)
+{
+    MANGO_ASSERT(!contains(node_id), "Node is already part of the transform hierarchy!");
+
+    uint32 parent = parent_node_id.has_value() ? index_of(parent_node_id.value()) : invalid_index;
+    MANGO_ASSERT(!parent_node_id.has_value() || parent != invalid_index, "Parent is not part of the transform hierarchy!");
+
+    uint32 index = size();
+    uint32 depth = (parent != invalid_index) ? m_depths[parent] + 1 : 0;
+    if (!m_depths.empty() && depth < m_depths.back())
+        m_needs_sort = true;
+
+    m_node_ids.push_back(node_id);
+    m_transform_ids.push_back(transform_id);
+    m_parents.push_back(parent);
+    m_depths.push_back(depth);
+    m_positions.push_back(make_vec3(0.0f));
+    m_rotations.push_back(quat(1.0f, 0.0f, 0.0f, 0.0f));
+    m_scales.push_back(make_vec3(1.0f));
+    m_local_matrices.push_back(mat4::Identity());
+    m_global_matrices.push_back(mat4::Identity());
+    m_dirty.push_back(1);
+    m_updated.push_back(0);
+    m_removed.push_back(0);
+
+    m_node_to_index.insert({ node_id, index });
+}
+
+void transform_hierarchy::remove(key node_id)
+{
+    auto found = m_node_to_index.find(node_id);
+    if (found == m_node_to_index.end())
+        return;
+
+    m_removed[found->second] = 1;
+    m_node_to_index.erase(found);
+    m_needs_compaction = true;
+}
+
+void transform_hierarchy::set_parent(key node_id, optional<key> parent_node_id)
+{
+    uint32 index = index_of(node_id);
+    MANGO_ASSERT(index != invalid_index, "Node is not part of the transform hierarchy!");
+
+    uint32 parent = parent_node_id.has_value() ? index_of(parent_node_id.value()) : invalid_index;
+    MANGO_ASSERT(!parent_node_id.has_value() || parent != invalid_index, "Parent is not part of the transform hierarchy!");
+
+    m_parents[index] = parent;
+    m_dirty[index]   = 1;
+
+    // the depth of the whole subtree changes
+    m_needs_sort = true;
+}
+
+bool transform_hierarchy::contains(key node_id) const
+{
+    return m_node_to_index.find(node_id) != m_node_to_index.end();
+}
+
+bool transform_hierarchy::is_ancestor(key ancestor_node_id, key node_id) const
+{
+    uint32 ancestor = index_of(ancestor_node_id);
+    uint32 current  = index_of(node_id);
+    if (ancestor == invalid_index)
+        return false;
+
+    while (current != invalid_index)
+    {
+        if (current == ancestor)
+            return true;
+        current = m_parents[current];
+    }
+
+    return false;
+}
+
+optional<key> transform_hierarchy::get_parent(key node_id) const
+{
+    uint32 index = index_of(node_id);
+    if (index == invalid_index || m_parents[index] == invalid_index)
+        return NONE;
+
+    return m_node_ids[m_parents[index]];
+}
+
+uint32 transform_hierarchy::index_of(key node_id) const
+{
+    auto found = m_node_to_index.find(node_id);
+    if (found == m_node_to_index.end())
+        return invalid_index;
+
+    return found->second;
+}
+
+void transform_hierarchy::set_local(uint32 index, const vec3& position, const quat& rotation, const vec3& scale)
+{
+    MANGO_ASSERT(index < size(), "Index out of bounds!");
+
+    m_positions[index] = position;
+    m_rotations[index] = rotation;
+    m_scales[index]    = scale;
+    m_dirty[index]     = 1;
+}
+
+void transform_hierarchy::reorder()
+{
+    if (m_needs_compaction)
+        compact();
+    if (m_needs_sort)
+        sort();
+}
+
+void transform_hierarchy::update(job_system* jobs)
+{
+    PROFILE_ZONE;
+
+    reorder();
+
+    const uint32 count = size();
+    if (!jobs || jobs->get_worker_count() == 0 || count <= update_chunk_size)
+    {
+        for (uint32 i = 0; i < count; ++i)
+        {
+            update_local(i);
+            update_global(i);
+        }
+        return;
+    }
+
+    jobs->parallel_for(count, update_chunk_size, [this](uint32 begin, uint32 end) {
+        for (uint32 i = begin; i < end; ++i)
+            update_local(i);
+    });
+
+    // entries are sorted by depth, all parents of one level are finished before the level starts
+    uint32 level_begin = 0;
+    while (level_begin < count)
+    {
+        uint32 level_end = level_begin;
+        while (level_end < count && m_depths[level_end] == m_depths[level_begin])
+            ++level_end;
+
+        jobs->parallel_for(level_end - level_begin, update_chunk_size, [this, level_begin](uint32 begin, uint32 end) {
+            for (uint32 i = level_begin + begin; i < level_begin + end; ++i)
+                update_global(i);
+        });
+
+        level_begin = level_end;
+    }
+}
+
+void transform_hierarchy::update_local(uint32 index)
+{
+    if (!m_dirty[index])
+        return;
+
+    // local = translate(position) * rotate(rotation) * scale(scale) without the full matrix multiplications.
+    mat4& local             = m_local_matrices[index];
+    local.block<3, 3>(0, 0) = m_rotations[index].toRotationMatrix() * m_scales[index].asDiagonal();
+    local.block<3, 1>(0, 3) = m_positions[index];
+    local.block<1, 3>(3, 0) = Eigen::RowVector3f::Zero();
+    local(3, 3)             = 1.0f;
+}
+
+void transform_hierarchy::update_global(uint32 index)
+{
+    const uint32 parent       = m_parents[index];
+    const bool parent_updated = parent != invalid_index && m_updated[parent];
+
+    if (m_dirty[index] || parent_updated)
+    {
+        if (parent != invalid_index)
+            m_global_matrices[index] = m_global_matrices[parent] * m_local_matrices[index];
+        else
+            m_global_matrices[index] = m_local_matrices[index];
+        m_updated[index] = 1;
+    }
+    else
+    {
+        m_updated[index] = 0;
+    }
+
+    m_dirty[index] = 0;
+}
+
+void transform_hierarchy::compact()
+{
+    const uint32 count = size();
+
+    std::vector<uint32> order;
+    std::vector<uint32> old_to_new(count, invalid_index);
+    order.reserve(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (m_removed[i])
+            continue;
+        old_to_new[i] = static_cast<uint32>(order.size());
+        order.push_back(i);
+    }
+
+    apply_order(m_node_ids, order);
+    apply_order(m_transform_ids, order);
+    apply_order(m_parents, order);
+    apply_order(m_depths, order);
+    apply_order(m_positions, order);
+    apply_order(m_rotations, order);
+    apply_order(m_scales, order);
+    apply_order(m_local_matrices, order);
+    apply_order(m_global_matrices, order);
+    apply_order(m_dirty, order);
+    apply_order(m_updated, order);
+    apply_order(m_removed, order);
+
+    for (uint32 i = 0; i < size(); ++i)
+    {
+        uint32& parent = m_parents[i];
+        if (parent != invalid_index)
+        {
+            if (old_to_new[parent] == invalid_index)
+            {
+                // lost its parent
+                m_dirty[i]   = 1;
+                m_needs_sort = true;
+            }
+            parent = old_to_new[parent];
+        }
+        m_node_to_index[m_node_ids[i]] = i;
+    }
+
+    m_needs_compaction = false;
+}
+
+void transform_hierarchy::sort()
+{
+    PROFILE_ZONE;
+    const uint32 count = size();
+
+    // calculate depth for every entry, walking up until some depth is known
+    std::vector<uint32>& depths = m_depths;
+    depths.assign(count, invalid_index);
+    std::vector<uint32> chain;
+    uint32 max_depth = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        uint32 current = i;
+        chain.clear();
+        while (current != invalid_index && depths[current] == invalid_index)
+        {
+            chain.push_back(current);
+            current = m_parents[current];
+            MANGO_ASSERT(chain.size() <= count, "Cycle in transform hierarchy!");
+        }
+        uint32 depth = (current == invalid_index) ? 0 : depths[current] + 1;
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+        {
+            max_depth   = std::max(max_depth, depth);
+            depths[*it] = depth++;
+        }
+    }
+
+    // stable counting sort by depth
+    std::vector<uint32> offsets(max_depth + 2, 0);
+    for (uint32 i = 0; i < count; ++i)
+        offsets[depths[i] + 1]++;
+    for (uint32 d = 1; d < offsets.size(); ++d)
+        offsets[d] += offsets[d - 1];
+
+    std::vector<uint32> order(count);
+    std::vector<uint32> old_to_new(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        uint32 new_index = offsets[depths[i]]++;
+        order[new_index] = i;
+        old_to_new[i]    = new_index;
+    }
+
+    apply_order(m_node_ids, order);
+    apply_order(m_transform_ids, order);
+    apply_order(m_parents, order);
+    apply_order(m_depths, order);
+    apply_order(m_positions, order);
+    apply_order(m_rotations, order);
+    apply_order(m_scales, order);
+    apply_order(m_local_matrices, order);
+    apply_order(m_global_matrices, order);
+    apply_order(m_dirty, order);
+    apply_order(m_updated, order);
+    apply_order(m_removed, order);
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (m_parents[i] != invalid_index)
+            m_parents[i] = old_to_new[m_parents[i]];
+        m_node_to_index[m_node_ids[i]] = i;
+    }
+
+    m_needs_sort = false;
+}
+
+template <typename T>
+static void apply_order(std::vector<T>& data, const std::vector<uint32>& order)
+{
+    std::vector<T> ordered;
+    ordered.reserve(order.size());
+    for (uint32 old_index : order)
+        ordered.push_back(data[old_index]);
+    data.swap(ordered);
+}
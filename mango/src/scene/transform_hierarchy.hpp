@@ -0,0 +1,185 @@
+//! \file      transform_hierarchy.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_TRANSFORM_HIERARCHY_HPP
+#define MANGO_TRANSFORM_HIERARCHY_HPP
+
+#include <mango/types.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace mango
+{
+    class job_system;
+
+    //! \brief Flat, parent index ordered storage of all \a transforms instantiated in the scene graph.
+    //! \details All data is stored as structure of arrays. Entries are kept ordered by their depth, so every parent is stored before any of its children.
+    //! This makes it possible to calculate all global transformation matrices in one linear pass without any recursion, or level by level in parallel.
+    class transform_hierarchy
+    {
+      public:
+        //! \brief Index used for entries without parent and invalid lookups.
+        static const uint32 invalid_index = 0xffffffffu;
+
+        transform_hierarchy();
+        ~transform_hierarchy();
+
+        //! \brief Adds a new entry to the \a transform_hierarchy.
+        //! \details The entry is appended. If it is less deep than the last entry the hierarchy gets reordered on the next call of \a update().
+        //! \param[in] node_id The \a key of the node the entry belongs to.
+        //! \param[in] transform_id The \a key of the \a transform of the node.
+        //! \param[in] parent_node_id The optional \a key of the parent node, NONE when the entry has no parent.
+        void add(key node_id, key transform_id, optional<key> parent_node_id);
+
+        //! \brief Removes an entry from the \a transform_hierarchy.
+        //! \details Removed entries get compacted on the next call of \a update().
+        //! Children of the removed entry that are still present lose their parent.
+        //! \param[in] node_id The \a key of the node to remove.
+        void remove(key node_id);
+
+        //! \brief Sets the parent of an entry in the \a transform_hierarchy.
+        //! \details The hierarchy gets reordered on the next call of \a update(), since the depth of the entry and its children may change.
+        //! \param[in] node_id The \a key of the node to reparent.
+        //! \param[in] parent_node_id The optional \a key of the new parent node, NONE when the entry should have no parent.
+        void set_parent(key node_id, optional<key> parent_node_id);
+
+        //! \brief Checks if a node is part of the \a transform_hierarchy.
+        //! \param[in] node_id The \a key of the node to check.
+        //! \return True if the node is part of the \a transform_hierarchy, else false.
+        bool contains(key node_id) const;
+
+        //! \brief Checks if a node is an ancestor of another node.
+        //! \param[in] ancestor_node_id The \a key of the possible ancestor.
+        //! \param[in] node_id The \a key of the node to check the ancestors for.
+        //! \return True if the node with \a ancestor_node_id is an ancestor of (or equal to) the node with \a node_id, else false.
+        bool is_ancestor(key ancestor_node_id, key node_id) const;
+
+        //! \brief Retrieves the \a key of the parent node of some node.
+        //! \param[in] node_id The \a key of the node to retrieve the parent for.
+        //! \return The optional \a key of the parent node.
+        optional<key> get_parent(key node_id) const;
+
+        //! \brief Sets the local transformation of an entry and marks it for recalculation.
+        //! \param[in] index The index of the entry.
+        //! \param[in] position The local position.
+        //! \param[in] rotation The local rotation.
+        //! \param[in] scale The local scale.
+        void set_local(uint32 index, const vec3& position, const quat& rotation, const vec3& scale);
+
+        //! \brief Compacts and reorders the entries of the \a transform_hierarchy if necessary.
+        //! \details Invalidates all indices retrieved before.
+        void reorder();
+
+        //! \brief Updates the \a transform_hierarchy.
+        //! \details Calls \a reorder() and recalculates all local and global transformation matrices that changed in one linear pass.
+        //! When a \a job_system is given, local matrices are calculated in parallel chunks and global matrices in parallel chunks level by level.
+        //! \param[in] jobs Optional pointer to the \a job_system to use.
+        void update(job_system* jobs = nullptr);
+
+        //! \brief Retrieves the number of entries in the \a transform_hierarchy.
+        //! \return The number of entries.
+        inline uint32 size() const
+        {
+            return static_cast<uint32>(m_node_ids.size());
+        }
+
+        //! \brief Retrieves the \a key of the node for an entry.
+        //! \param[in] index The index of the entry.
+        //! \return The \a key of the node.
+        inline key node_id(uint32 index) const
+        {
+            return m_node_ids[index];
+        }
+
+        //! \brief Retrieves the \a key of the \a transform for an entry.
+        //! \param[in] index The index of the entry.
+        //! \return The \a key of the \a transform.
+        inline key transform_id(uint32 index) const
+        {
+            return m_transform_ids[index];
+        }
+
+        //! \brief Retrieves the index of the parent of an entry.
+        //! \param[in] index The index of the entry.
+        //! \return The index of the parent or \a invalid_index.
+        inline uint32 parent_index(uint32 index) const
+        {
+            return m_parents[index];
+        }
+
+        //! \brief Retrieves the global transformation matrix of an entry.
+        //! \param[in] index The index of the entry.
+        //! \return The global transformation matrix calculated in the last \a update().
+        inline const mat4& global_matrix(uint32 index) const
+        {
+            return m_global_matrices[index];
+        }
+
+        //! \brief Checks if the global transformation matrix of an entry was recalculated in the last \a update().
+        //! \param[in] index The index of the entry.
+        //! \return True if the global transformation matrix was recalculated, else false.
+        inline bool updated(uint32 index) const
+        {
+            return m_updated[index] != 0;
+        }
+
+        //! \brief Retrieves the index of an entry.
+        //! \param[in] node_id The \a key of the node.
+        //! \return The index of the entry or \a invalid_index if the node is not part of the \a transform_hierarchy.
+        uint32 index_of(key node_id) const;
+
+      private:
+        //! \brief Removes all entries marked as removed, preserving the order of the remaining ones.
+        void compact();
+
+        //! \brief Reorders all entries by their depth, so that every parent is stored before all its children.
+        void sort();
+
+        //! \brief Recalculates the local transformation matrix of an entry if it is dirty.
+        //! \param[in] index The index of the entry.
+        void update_local(uint32 index);
+
+        //! \brief Recalculates the global transformation matrix of an entry if it or its parent changed.
+        //! \details The parent has to be updated before.
+        //! \param[in] index The index of the entry.
+        void update_global(uint32 index);
+
+        //! \brief The \a keys of the nodes.
+        std::vector<key> m_node_ids;
+        //! \brief The \a keys of the \a transforms.
+        std::vector<key> m_transform_ids;
+        //! \brief The parent indices.
+        std::vector<uint32> m_parents;
+        //! \brief The depths in the hierarchy, entries without parent have depth 0.
+        std::vector<uint32> m_depths;
+        //! \brief The local positions.
+        std::vector<vec3> m_positions;
+        //! \brief The local rotations.
+        std::vector<quat> m_rotations;
+        //! \brief The local scales.
+        std::vector<vec3> m_scales;
+        //! \brief The local transformation matrices.
+        std::vector<mat4> m_local_matrices;
+        //! \brief The global transformation matrices.
+        std::vector<mat4> m_global_matrices;
+        //! \brief Flags marking entries with changed local transformation.
+        std::vector<uint8> m_dirty;
+        //! \brief Flags marking entries with recalculated global transformation in the last update.
+        std::vector<uint8> m_updated;
+        //! \brief Flags marking removed entries.
+        std::vector<uint8> m_removed;
+
+        //! \brief Maps node \a keys to entry indices.
+        std::unordered_map<key, uint32> m_node_to_index;
+
+        //! \brief True if entries were removed since the last update, else false.
+        bool m_needs_compaction;
+        //! \brief True if the depth order is broken since the last update, else false.
+        bool m_needs_sort;
+    };
+} // namespace mango
+
+#endif // MANGO_TRANSFORM_HIERARCHY_HPP
@@ -96,6 +96,24 @@ namespace mango
             ImGui::Text("%d", info.last_frame.vertices);
             column_next();
             ImGui::SeparatorEx(ImGuiSeparatorFlags_SpanAllColumns | ImGuiSeparatorFlags_Horizontal);
+            text_wrapped("API Calls Issued / Skipped:");
+            column_next();
+            ImGui::AlignTextToFramePadding();
+            ImGui::Text("%d / %d", info.last_frame.api_calls_issued, info.last_frame.api_calls_skipped);
+            column_next();
+            ImGui::SeparatorEx(ImGuiSeparatorFlags_SpanAllColumns | ImGuiSeparatorFlags_Horizontal);
+            text_wrapped("Sampler Objects:");
+            column_next();
+            ImGui::AlignTextToFramePadding();
+            ImGui::Text("%d", info.last_frame.live_samplers);
+            column_next();
+            ImGui::SeparatorEx(ImGuiSeparatorFlags_SpanAllColumns | ImGuiSeparatorFlags_Horizontal);
+            text_wrapped("Frustum / Occlusion Culled:");
+            column_next();
+            ImGui::AlignTextToFramePadding();
+            ImGui::Text("%d / %d", info.last_frame.frustum_culled, info.last_frame.occlusion_culled);
+            column_next();
+            ImGui::SeparatorEx(ImGuiSeparatorFlags_SpanAllColumns | ImGuiSeparatorFlags_Horizontal);
             text_wrapped("Canvas Size:");
             column_next();
             ImGui::AlignTextToFramePadding();
@@ -211,6 +229,8 @@ namespace mango
             bool has_directional_light   = node.directional_light_hnd.valid();
             bool has_skylight            = node.skylight_hnd.valid();
             bool has_atmospheric_light   = node.atmospheric_light_hnd.valid();
+            bool has_point_light         = node.point_light_hnd.valid();
+            bool has_spot_light          = node.spot_light_hnd.valid();
 
             if (ImGui::BeginPopup("##component_addition_popup"))
             {
@@ -239,6 +259,16 @@ namespace mango
                     auto al = atmospheric_light();
                     application_scene->add_atmospheric_light(al, node_hnd);
                 }
+                if (!has_point_light && ImGui::Selectable("Add Point Light"))
+                {
+                    auto pl = point_light();
+                    application_scene->add_point_light(pl, node_hnd);
+                }
+                if (!has_spot_light && ImGui::Selectable("Add Spot Light"))
+                {
+                    auto sl = spot_light();
+                    application_scene->add_spot_light(sl, node_hnd);
+                }
 
                 ImGui::EndPopup();
             }
@@ -396,6 +426,89 @@ namespace mango
                 });
         }
 
+        //! \brief Draws ui for a given \a point_light.
+        //! \param[in] node_hnd The \a handle of the \a node the \a point_light is in.
+        //! \param[in] application_scene The current \a scene of the \a application.
+        void inspect_point_light(handle<node> node_hnd, const unique_ptr<scene_impl>& application_scene)
+        {
+            optional<point_light&> l = application_scene->get_point_light(node_hnd);
+            MANGO_ASSERT(l, "Point light to inspect does not exist!");
+            details::draw_component(
+                "Point Light",
+                [&application_scene, &l]()
+                {
+                    bool changed         = false;
+                    float default_fl3[3] = { 1.0f, 1.0f, 1.0f };
+                    changed |= color_edit("Color", &l->color[0], 3, default_fl3);
+
+                    float default_value[1] = { mango::default_punctual_intensity };
+                    changed |= slider_float_n("Intensity", &l->intensity, 1, default_value, 0.0f, 100000.0f, "%.1f", false);
+
+                    default_value[0] = mango::default_punctual_range;
+                    changed |= slider_float_n("Range", &l->range, 1, default_value, 0.01f, 1000.0f, "%.2f", false);
+
+                    l->changed |= changed;
+                },
+                [node_hnd, &application_scene]()
+                {
+                    if (ImGui::Selectable("Remove"))
+                    {
+                        application_scene->remove_point_light(node_hnd);
+                        return false;
+                    }
+                    return true;
+                });
+        }
+
+        //! \brief Draws ui for a given \a spot_light.
+        //! \param[in] node_hnd The \a handle of the \a node the \a spot_light is in.
+        //! \param[in] application_scene The current \a scene of the \a application.
+        void inspect_spot_light(handle<node> node_hnd, const unique_ptr<scene_impl>& application_scene)
+        {
+            optional<spot_light&> l = application_scene->get_spot_light(node_hnd);
+            MANGO_ASSERT(l, "Spot light to inspect does not exist!");
+            details::draw_component(
+                "Spot Light",
+                [&application_scene, &l]()
+                {
+                    bool changed         = false;
+                    float default_fl3[3] = { 0.0f, -1.0f, 0.0f };
+                    changed |= drag_float_n("Direction", &l->direction[0], 3, default_fl3, 0.08f, 0.0f, 0.0f, "%.2f", true);
+
+                    default_fl3[0] = 1.0f;
+                    default_fl3[1] = 1.0f;
+                    default_fl3[2] = 1.0f;
+                    changed |= color_edit("Color", &l->color[0], 3, default_fl3);
+
+                    float default_value[1] = { mango::default_punctual_intensity };
+                    changed |= slider_float_n("Intensity", &l->intensity, 1, default_value, 0.0f, 100000.0f, "%.1f", false);
+
+                    default_value[0] = mango::default_punctual_range;
+                    changed |= slider_float_n("Range", &l->range, 1, default_value, 0.01f, 1000.0f, "%.2f", false);
+
+                    // angles are edited in degrees.
+                    float inner      = rad_to_deg(l->inner_cone_angle);
+                    float outer      = rad_to_deg(l->outer_cone_angle);
+                    default_value[0] = 0.0f;
+                    changed |= slider_float_n("Inner Cone Angle", &inner, 1, default_value, 0.0f, 90.0f, "%.1f", false);
+                    default_value[0] = 45.0f;
+                    changed |= slider_float_n("Outer Cone Angle", &outer, 1, default_value, 0.0f, 90.0f, "%.1f", false);
+                    l->outer_cone_angle = deg_to_rad(outer);
+                    l->inner_cone_angle = deg_to_rad(std::min(inner, outer));
+
+                    l->changed |= changed;
+                },
+                [node_hnd, &application_scene]()
+                {
+                    if (ImGui::Selectable("Remove"))
+                    {
+                        application_scene->remove_spot_light(node_hnd);
+                        return false;
+                    }
+                    return true;
+                });
+        }
+
         //! \brief Draws ui for a given \a mesh.
         //! \param[in] node_hnd The \a handle of the \a node the \a mesh is in.
         //! \param[in] instance The \a handle of the \a mesh instance.
@@ -1028,7 +1141,7 @@ namespace mango
                     auto ext       = queried.substr(queried.find_last_of(".") + 1);
                     if (ext == "glb" || ext == "gltf")
                     {
-                        application_scene->load_model_from_gltf(queried);
+                        application_scene->load_model_from_gltf_async(queried);
                     }
                 }
             }
@@ -1039,6 +1152,11 @@ namespace mango
                     auto mod   = application_scene->get_model(m);
                     auto start = mod->file_path.find_last_of("\\/") + 1;
                     auto name  = mod->file_path.substr(start, mod->file_path.find_last_of(".") - start);
+                    if (mod->pending)
+                    {
+                        ImGui::TextDisabled("%s (loading)", name.c_str());
+                        continue;
+                    }
                     if (ImGui::BeginMenu((name + "##instantiation").c_str()))
                     {
                         int32 scenario_nr = 0;
@@ -1097,8 +1215,11 @@ namespace mango
             bool is_directional_light   = (nd->type & node_type::directional_light) != node_type::hierarchy;
             bool is_skylight            = (nd->type & node_type::skylight) != node_type::hierarchy;
             bool is_atmospheric_light   = (nd->type & node_type::atmospheric_light) != node_type::hierarchy;
+            bool is_point_light         = (nd->type & node_type::point_light) != node_type::hierarchy;
+            bool is_spot_light          = (nd->type & node_type::spot_light) != node_type::hierarchy;
             bool is_mesh                = (nd->type & node_type::mesh) != node_type::hierarchy;
             bool is_camera              = is_perspective_camera || is_orthographic_camera;
+            // point and spot lights are placed with their transform, so only the other lights disable it.
             bool is_light               = is_directional_light || is_skylight || is_atmospheric_light;
             details::inspect_transform(node_hnd, application_scene, is_camera, is_light);
             if (is_directional_light)
@@ -1113,6 +1234,14 @@ namespace mango
             {
                 details::inspect_atmospheric_light(node_hnd, application_scene);
             }
+            if (is_point_light)
+            {
+                details::inspect_point_light(node_hnd, application_scene);
+            }
+            if (is_spot_light)
+            {
+                details::inspect_spot_light(node_hnd, application_scene);
+            }
             if (is_mesh)
             {
                 MANGO_ASSERT(nd->mesh_hnd.valid(), "Node with mesh does not have a mesh attached!");
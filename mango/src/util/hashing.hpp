@@ -33,6 +33,42 @@ namespace mango
             return hash;
         }
     };
+
+    //! \brief fnv1a_hash
+    //! \details 64 bit fnv1a hash. Hashes can be continued with more data, so multiple values can be combined depending on their order.
+    class fnv1a_hash
+    {
+      public:
+        //! \brief The hash of no data.
+        static constexpr uint64 offset_basis = 14695981039346656037ull;
+
+        //! \brief Calculate the hash for a given range of bytes.
+        //! \param[in] data The bytes to hash.
+        //! \param[in] size The number of bytes to hash.
+        //! \param[in] seed The hash to continue.
+        //! \return The hash.
+        static uint64 hash_bytes(const void* data, ptr_size size, uint64 seed = offset_basis)
+        {
+            const uint8* bytes = static_cast<const uint8*>(data);
+            uint64 hash        = seed;
+            for (ptr_size i = 0; i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull; // fnv prime
+            }
+            return hash;
+        }
+
+        //! \brief Calculate the hash for a given string, including the terminating null character.
+        //! \details Including the terminator separates consecutive strings, so ("ab", "c") and ("a", "bc") hash differently.
+        //! \param[in] str The string to hash.
+        //! \param[in] seed The hash to continue.
+        //! \return The hash.
+        static uint64 hash(const char* str, uint64 seed = offset_basis)
+        {
+            return hash_bytes(str, std::char_traits<char>::length(str) + 1, seed);
+        }
+    };
 } // namespace mango
 
 #endif // MANGO_HASHING_HPP
\ No newline at end of file
@@ -6,6 +6,14 @@
 
 #include <mango/intersect.hpp>
 
+#if defined(__AVX__)
+#define MANGO_INTERSECT_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MANGO_INTERSECT_SSE
+#include <emmintrin.h>
+#endif
+
 using namespace mango;
 
 bool bounding_sphere::intersects(const bounding_sphere& other) const
@@ -93,25 +101,118 @@ bool bounding_frustum::intersects(const bounding_sphere& other) const
 
 bool bounding_frustum::intersects(const axis_aligned_bounding_box& other) const
 {
-    auto corners = other.get_corners();
+    // The corner farthest along the plane normal is in front of the plane, if the box is not completely behind it.
+    for (int32 i = 0; i < 6; ++i)
+    {
+        const vec3 normal = planes[i].head<3>();
+        float distance    = normal.dot(other.center) + planes[i].w();
+        float radius      = normal.cwiseAbs().dot(other.extents);
+        if (distance + radius < 0.0f)
+            return false;
+    }
+
+    return true;
+}
 
+containment_result bounding_frustum::contains(const axis_aligned_bounding_box& other) const
+{
+    containment_result result = containment_result::contain;
     for (int32 i = 0; i < 6; ++i)
     {
-        bool inside = false;
-        for (int j = 0; j < 8; ++j)
+        const vec3 normal = planes[i].head<3>();
+        float distance    = normal.dot(other.center) + planes[i].w();
+        float radius      = normal.cwiseAbs().dot(other.extents);
+        if (distance + radius < 0.0f)
+            return containment_result::disjoint;
+        if (distance - radius < 0.0f)
+            result = containment_result::intersect;
+    }
+
+    return result;
+}
+
+void bounding_frustum::intersects(const bounding_box_batch& boxes, std::vector<uint32>& visibility) const
+{
+    const uint32 count = boxes.size();
+    visibility.assign((count + 31) / 32, 0u);
+
+    const float* cx = boxes.center_x.data();
+    const float* cy = boxes.center_y.data();
+    const float* cz = boxes.center_z.data();
+    const float* ex = boxes.extent_x.data();
+    const float* ey = boxes.extent_y.data();
+    const float* ez = boxes.extent_z.data();
+
+    float abs_normals[6][3];
+    for (int32 p = 0; p < 6; ++p)
+    {
+        abs_normals[p][0] = std::abs(planes[p].x());
+        abs_normals[p][1] = std::abs(planes[p].y());
+        abs_normals[p][2] = std::abs(planes[p].z());
+    }
+
+    uint32 i = 0;
+#if defined(MANGO_INTERSECT_AVX)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x      = _mm256_loadu_ps(cx + i);
+        __m256 y      = _mm256_loadu_ps(cy + i);
+        __m256 z      = _mm256_loadu_ps(cz + i);
+        __m256 e_x    = _mm256_loadu_ps(ex + i);
+        __m256 e_y    = _mm256_loadu_ps(ey + i);
+        __m256 e_z    = _mm256_loadu_ps(ez + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int32 p = 0; p < 6; ++p)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p].x()), x), _mm256_mul_ps(_mm256_set1_ps(planes[p].y()), y)),
+                                            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p].z()), z), _mm256_set1_ps(planes[p].w())));
+            __m256 radius   = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(abs_normals[p][0]), e_x), _mm256_mul_ps(_mm256_set1_ps(abs_normals[p][1]), e_y)),
+                                          _mm256_mul_ps(_mm256_set1_ps(abs_normals[p][2]), e_z));
+            inside          = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        visibility[i >> 5] |= static_cast<uint32>(_mm256_movemask_ps(inside)) << (i & 31);
+    }
+#elif defined(MANGO_INTERSECT_SSE)
+    for (; i + 8 <= count; i += 8)
+    {
+        uint32 mask = 0;
+        // two times four boxes
+        for (uint32 h = 0; h < 8; h += 4)
         {
-            if (planes[i].dot(vec4(corners[j].x(), corners[j].y(), corners[j].z(), 1.0f)) >= 0.0f)
+            __m128 x      = _mm_loadu_ps(cx + i + h);
+            __m128 y      = _mm_loadu_ps(cy + i + h);
+            __m128 z      = _mm_loadu_ps(cz + i + h);
+            __m128 e_x    = _mm_loadu_ps(ex + i + h);
+            __m128 e_y    = _mm_loadu_ps(ey + i + h);
+            __m128 e_z    = _mm_loadu_ps(ez + i + h);
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int32 p = 0; p < 6; ++p)
             {
-                inside = true;
-                break;
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].x()), x), _mm_mul_ps(_mm_set1_ps(planes[p].y()), y)),
+                                             _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].z()), z), _mm_set1_ps(planes[p].w())));
+                __m128 radius   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(abs_normals[p][0]), e_x), _mm_mul_ps(_mm_set1_ps(abs_normals[p][1]), e_y)),
+                                           _mm_mul_ps(_mm_set1_ps(abs_normals[p][2]), e_z));
+                inside          = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
             }
+            mask |= static_cast<uint32>(_mm_movemask_ps(inside)) << h;
         }
-
-        if (!inside)
-            return false;
+        visibility[i >> 5] |= mask << (i & 31);
     }
+#endif
 
-    return true;
+    // remaining boxes
+    for (; i < count; ++i)
+    {
+        bool inside = true;
+        for (int32 p = 0; p < 6 && inside; ++p)
+        {
+            float distance = planes[p].x() * cx[i] + planes[p].y() * cy[i] + planes[p].z() * cz[i] + planes[p].w();
+            float radius   = abs_normals[p][0] * ex[i] + abs_normals[p][1] * ey[i] + abs_normals[p][2] * ez[i];
+            inside         = distance + radius >= 0.0f;
+        }
+        if (inside)
+            visibility[i >> 5] |= 1u << (i & 31);
+    }
 }
 
 axis_aligned_bounding_box axis_aligned_bounding_box::from_min_max(const vec3& min_point, const vec3& max_point)
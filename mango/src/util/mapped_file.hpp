@@ -0,0 +1,68 @@
+//! \file      mapped_file.hpp
+//! This file provides a read only memory mapping of files.
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_MAPPED_FILE_HPP
+#define MANGO_MAPPED_FILE_HPP
+
+#include <mango/types.hpp>
+#include <util/helpers.hpp>
+
+namespace mango
+{
+    //! \brief A read only memory mapping of a complete file.
+    //! \details Pages are only loaded by the operating system when they are accessed and can be dropped again under memory pressure.
+    class mapped_file
+    {
+        MANGO_DISABLE_COPY_AND_ASSIGNMENT(mapped_file)
+      public:
+        mapped_file() = default;
+        ~mapped_file();
+
+        //! \brief Maps a file. Closes an already mapped file before.
+        //! \param[in] path The full path of the file to map.
+        //! \return True on success, else false.
+        bool open(const string& path);
+
+        //! \brief Unmaps the file. Pointers into the mapping are invalid afterwards.
+        void close();
+
+        //! \brief Checks if a file is mapped.
+        //! \return True if a file is mapped, else false.
+        inline bool is_open() const
+        {
+            return m_data != nullptr;
+        }
+
+        //! \brief Returns the start of the mapped memory.
+        //! \return The start of the mapped memory or nullptr if nothing is mapped.
+        inline const uint8* data() const
+        {
+            return m_data;
+        }
+
+        //! \brief Returns the size of the mapped file.
+        //! \return The size of the mapped file in bytes.
+        inline int64 size() const
+        {
+            return m_size;
+        }
+
+      private:
+        //! \brief The start of the mapped memory.
+        const uint8* m_data = nullptr;
+        //! \brief The size of the mapped memory in bytes.
+        int64 m_size = 0;
+#ifdef WIN32
+        //! \brief The file handle.
+        void* m_file = nullptr;
+        //! \brief The file mapping handle.
+        void* m_mapping = nullptr;
+#endif // WIN32
+    };
+} // namespace mango
+
+#endif // MANGO_MAPPED_FILE_HPP
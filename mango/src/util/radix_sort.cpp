@@ -0,0 +1,157 @@
+//! \file      radix_sort.cpp
+//! This file provides a radix sort for 64 bit sort keys.
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <core/job_system.hpp>
+#include <mango/profile.hpp>
+#include <memory/frame_arena.hpp>
+#include <util/radix_sort.hpp>
+
+using namespace mango;
+
+//! \brief Number of bits sorted per pass.
+static const uint32 radix_bits = 8;
+//! \brief Number of buckets per pass.
+static const uint32 radix_buckets = 1u << radix_bits;
+//! \brief Number of passes required for 64 bit keys.
+static const uint32 radix_passes = 64 / radix_bits;
+//! \brief Number of pairs counted and scattered by one job.
+static const uint32 radix_sort_chunk_size = 16384;
+
+//! \brief Retrieves one digit of a sort key.
+//! \param[in] sort_key The sort key.
+//! \param[in] pass The pass to retrieve the digit for.
+//! \return The digit of the sort key in the given pass.
+static inline uint32 digit(uint64 sort_key, uint32 pass)
+{
+    return static_cast<uint32>((sort_key >> (pass * radix_bits)) & (radix_buckets - 1));
+}
+
+//! \brief Retrieves the number of pairs processed by one job.
+//! \param[in] count The number of pairs to sort.
+//! \param[in] jobs Optional pointer to the \a job_system to use.
+//! \return The number of pairs processed by one job.
+static inline uint32 sort_chunk_size(uint32 count, job_system* jobs)
+{
+    // Without workers everything is one chunk, then the histograms of the first count are valid for all passes.
+    return (jobs && jobs->get_worker_count() > 0) ? radix_sort_chunk_size : count;
+}
+
+//! \brief Sorts \a sort_pairs with caller provided memory.
+//! \param[in] pairs The \a sort_pairs to sort.
+//! \param[in] scratch Memory for count \a sort_pairs used for the passes.
+//! \param[in] count The number of \a sort_pairs.
+//! \param[in] totals Memory for the total histograms, chunks * radix_passes * radix_buckets values.
+//! \param[in] offsets Memory for the chunk offsets, chunks * radix_buckets values.
+//! \param[in] jobs Optional pointer to the \a job_system to use.
+//! \return Either pairs or scratch, depending on where the sorted result ended up.
+static sort_pair* sort_pairs(sort_pair* pairs, sort_pair* scratch, uint32 count, uint32* totals, uint32* offsets, job_system* jobs)
+{
+    const uint32 chunk_size = sort_chunk_size(count, jobs);
+    const uint32 chunks     = job_system::chunk_count(count, chunk_size);
+    // generic, so the lambdas are handed to the job system without being wrapped in a std::function.
+    auto for_chunks = [jobs, count, chunks, chunk_size](const auto& func) {
+        if (chunks > 1)
+        {
+            jobs->parallel_for(count, chunk_size, func);
+            return;
+        }
+        func(0, count);
+    };
+
+    // The total histograms do not depend on the order, so they are only calculated once to find passes that can be skipped.
+    std::fill(totals, totals + chunks * radix_passes * radix_buckets, 0);
+    for_chunks([pairs, totals, chunk_size](uint32 begin, uint32 end) {
+        uint32* histogram = totals + (begin / chunk_size) * radix_passes * radix_buckets;
+        for (uint32 i = begin; i < end; ++i)
+        {
+            const uint64 sort_key = pairs[i].sort_key;
+            for (uint32 p = 0; p < radix_passes; ++p)
+                ++histogram[p * radix_buckets + digit(sort_key, p)];
+        }
+    });
+
+    sort_pair* source = pairs;
+    sort_pair* target = scratch;
+
+    for (uint32 p = 0; p < radix_passes; ++p)
+    {
+        const uint32 first_digit = digit(source[0].sort_key, p);
+        uint32 first_count       = 0;
+        for (uint32 c = 0; c < chunks; ++c)
+            first_count += totals[(c * radix_passes + p) * radix_buckets + first_digit];
+        if (first_count == count)
+            continue;
+
+        if (chunks > 1)
+        {
+            // histograms per chunk for the current order
+            std::fill(offsets, offsets + chunks * radix_buckets, 0);
+            for_chunks([source, offsets, p, chunk_size](uint32 begin, uint32 end) {
+                uint32* histogram = offsets + (begin / chunk_size) * radix_buckets;
+                for (uint32 i = begin; i < end; ++i)
+                    ++histogram[digit(source[i].sort_key, p)];
+            });
+        }
+        else
+            std::copy(totals + p * radix_buckets, totals + (p + 1) * radix_buckets, offsets);
+
+        // digit major, chunk minor prefix sum keeps the sort stable
+        uint32 sum = 0;
+        for (uint32 d = 0; d < radix_buckets; ++d)
+        {
+            for (uint32 c = 0; c < chunks; ++c)
+            {
+                uint32& offset = offsets[c * radix_buckets + d];
+                uint32 h       = offset;
+                offset         = sum;
+                sum += h;
+            }
+        }
+
+        for_chunks([source, target, offsets, p, chunk_size](uint32 begin, uint32 end) {
+            uint32* offset = offsets + (begin / chunk_size) * radix_buckets;
+            for (uint32 i = begin; i < end; ++i)
+                target[offset[digit(source[i].sort_key, p)]++] = source[i];
+        });
+
+        std::swap(source, target);
+    }
+
+    return source;
+}
+
+void mango::radix_sort(std::vector<sort_pair>& pairs, job_system* jobs)
+{
+    PROFILE_ZONE;
+    const uint32 count = static_cast<uint32>(pairs.size());
+    if (count < 2)
+        return;
+
+    const uint32 chunks = job_system::chunk_count(count, sort_chunk_size(count, jobs));
+    std::vector<uint32> totals(chunks * radix_passes * radix_buckets);
+    std::vector<uint32> offsets(chunks * radix_buckets);
+    std::vector<sort_pair> scratch(count);
+
+    if (sort_pairs(pairs.data(), scratch.data(), count, totals.data(), offsets.data(), jobs) != pairs.data())
+        pairs.swap(scratch);
+}
+
+void mango::radix_sort(sort_pair* pairs, uint32 count, frame_arena& arena, job_system* jobs)
+{
+    PROFILE_ZONE;
+    if (count < 2)
+        return;
+
+    const uint32 chunks = job_system::chunk_count(count, sort_chunk_size(count, jobs));
+    uint32* totals      = static_cast<uint32*>(arena.allocate(chunks * radix_passes * radix_buckets * sizeof(uint32), alignof(uint32)));
+    uint32* offsets     = static_cast<uint32*>(arena.allocate(chunks * radix_buckets * sizeof(uint32), alignof(uint32)));
+    sort_pair* scratch  = static_cast<sort_pair*>(arena.allocate(count * sizeof(sort_pair), alignof(sort_pair)));
+
+    sort_pair* sorted = sort_pairs(pairs, scratch, count, totals, offsets, jobs);
+    if (sorted != pairs)
+        std::copy(sorted, sorted + count, pairs);
+}
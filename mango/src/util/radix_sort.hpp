@@ -0,0 +1,42 @@
+//! \file      radix_sort.hpp
+//! This file provides a radix sort for 64 bit sort keys.
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#ifndef MANGO_RADIX_SORT_HPP
+#define MANGO_RADIX_SORT_HPP
+
+#include <mango/types.hpp>
+
+namespace mango
+{
+    class job_system;
+    class frame_arena;
+
+    //! \brief Pair of a 64 bit sort key and the index of the element it belongs to.
+    struct sort_pair
+    {
+        uint64 sort_key; //!< The key to sort by.
+        uint32 index;    //!< The index of the sorted element.
+    };
+
+    //! \brief Sorts \a sort_pairs ascending by their sort key.
+    //! \details Least significant digit radix sort with 8 bit digits. The sort is stable.
+    //! Passes over digits equal for all keys are skipped.
+    //! When a \a job_system is given, counting and scattering are done in parallel chunks.
+    //! \param[in,out] pairs The \a sort_pairs to sort.
+    //! \param[in] jobs Optional pointer to the \a job_system to use.
+    void radix_sort(std::vector<sort_pair>& pairs, job_system* jobs = nullptr);
+
+    //! \brief Sorts \a sort_pairs ascending by their sort key, using scratch memory of the current frame.
+    //! \details Same as the std::vector version, but does not allocate any heap memory.
+    //! \param[in,out] pairs Pointer to the \a sort_pairs to sort.
+    //! \param[in] count The number of \a sort_pairs.
+    //! \param[in] arena The \a frame_arena to allocate the scratch memory from.
+    //! \param[in] jobs Optional pointer to the \a job_system to use.
+    void radix_sort(sort_pair* pairs, uint32 count, frame_arena& arena, job_system* jobs = nullptr);
+} // namespace mango
+
+#endif // MANGO_RADIX_SORT_HPP
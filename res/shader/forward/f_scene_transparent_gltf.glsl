@@ -27,6 +27,7 @@ void main()
 
     // lights
     vec3 directional_contribution = calculate_directional_light(base_color.rgb, normal, view, n_dot_v, perceptual_roughness, metallic, f0, occlusion);
+    vec3 punctual_contribution    = calculate_punctual_lights(fs_in.position, base_color.rgb, normal, view, n_dot_v, perceptual_roughness, metallic, f0, occlusion);
 
     float shadow = 1.0;
     vec3 cascade_color = vec3(1.0);
@@ -42,6 +43,7 @@ void main()
     vec3 lighting = vec3(0.0);
     lighting += skylight_contribution;
     lighting += directional_contribution * shadow;
+    lighting += punctual_contribution;
     lighting += get_emissive();
 
     lighting *= cascade_color;
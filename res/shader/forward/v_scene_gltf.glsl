@@ -1,3 +1,7 @@
+#ifdef MULTI_DRAW
+#extension GL_ARB_shader_draw_parameters : require
+#endif // MULTI_DRAW
+
 #include <../include/scene_geometry.glsl>
 
 void get_normal_tangent_bitangent(out vec3 normal, out vec3 tangent, out vec3 bitangent)
@@ -30,5 +34,9 @@ void main()
     // Normals, Tangents, Bitangents
     get_normal_tangent_bitangent(vs_out.normal, vs_out.tangent, vs_out.bitangent);
 
+#ifdef MULTI_DRAW
+    vs_out.model_entry = gl_BaseInstanceARB;
+#endif // MULTI_DRAW
+
     gl_Position = view_projection_matrix * world_position;
 }
@@ -0,0 +1,21 @@
+#include <../include/common_constants_and_functions.glsl>
+#include <../include/bindings.glsl>
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = HI_Z_IMAGE_SOURCE, r32f) uniform readonly image2D image_hi_z_source;
+
+layout(binding = HI_Z_READBACK_BUFFER_BINDING_POINT, std430) writeonly buffer hi_z_readback
+{
+    float hi_z_depth[];
+};
+
+void main()
+{
+    ivec2 size  = imageSize(image_hi_z_source);
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (texel.x >= size.x || texel.y >= size.y)
+        return;
+
+    hi_z_depth[texel.y * size.x + texel.x] = imageLoad(image_hi_z_source, texel).r;
+}
@@ -0,0 +1,52 @@
+#include <../include/common_constants_and_functions.glsl>
+#include <../include/bindings.glsl>
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+#ifdef REDUCE_DEPTH_BUFFER
+layout(binding = HI_Z_DEPTH_SAMPLER) uniform sampler2D sampler_depth_input;
+#else
+layout(binding = HI_Z_IMAGE_SOURCE, r32f) uniform readonly image2D image_hi_z_source;
+#endif // REDUCE_DEPTH_BUFFER
+layout(binding = HI_Z_IMAGE_DESTINATION, r32f) uniform writeonly image2D image_hi_z_destination;
+
+float load_source(in ivec2 texel)
+{
+#ifdef REDUCE_DEPTH_BUFFER
+    return texelFetch(sampler_depth_input, texel, 0).r;
+#else
+    return imageLoad(image_hi_z_source, texel).r;
+#endif // REDUCE_DEPTH_BUFFER
+}
+
+void main()
+{
+    ivec2 destination_size = imageSize(image_hi_z_destination);
+    ivec2 texel            = ivec2(gl_GlobalInvocationID.xy);
+    if (texel.x >= destination_size.x || texel.y >= destination_size.y)
+        return;
+
+#ifdef REDUCE_DEPTH_BUFFER
+    ivec2 source_size = textureSize(sampler_depth_input, 0);
+#else
+    ivec2 source_size = imageSize(image_hi_z_source);
+#endif // REDUCE_DEPTH_BUFFER
+
+    // the last texel of a row or column also takes the remaining source texel of odd sizes, so nothing is lost.
+    ivec2 source_begin = texel * 2;
+    ivec2 source_end   = source_begin + 1;
+    if (texel.x == destination_size.x - 1)
+        source_end.x = source_size.x - 1;
+    if (texel.y == destination_size.y - 1)
+        source_end.y = source_size.y - 1;
+    source_end = min(source_end, source_size - 1);
+
+    float max_depth = 0.0;
+    for (int y = source_begin.y; y <= source_end.y; ++y)
+    {
+        for (int x = source_begin.x; x <= source_end.x; ++x)
+            max_depth = max(max_depth, load_source(ivec2(x, y)));
+    }
+
+    imageStore(image_hi_z_destination, texel, vec4(max_depth));
+}
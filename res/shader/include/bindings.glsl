@@ -11,6 +11,10 @@
 #define IBL_GEN_DATA_BUFFER_BINDING_POINT 3
 #define CUBEMAP_DATA_BUFFER_BINDING_POINT 3
 #define FXAA_DATA_BUFFER_BINDING_POINT 1
+#define PUNCTUAL_LIGHT_BUFFER_BINDING_POINT 7
+#define LIGHT_CLUSTER_BUFFER_BINDING_POINT 8
+#define LIGHT_INDEX_BUFFER_BINDING_POINT 9
+#define HI_Z_READBACK_BUFFER_BINDING_POINT 10
 
 #define VERTEX_INPUT_POSITION 0
 #define VERTEX_INPUT_NORMAL 1
@@ -45,4 +49,8 @@
 
 #define HDR_IMAGE_LUMINANCE_COMPUTE 0
 
+#define HI_Z_DEPTH_SAMPLER 0
+#define HI_Z_IMAGE_SOURCE 1
+#define HI_Z_IMAGE_DESTINATION 2
+
 #endif // MANGO_BINDINGS_GLSL
\ No newline at end of file
@@ -13,6 +13,34 @@ layout(binding = LIGHT_DATA_BUFFER_BINDING_POINT, std140) uniform light_data
 
     float skylight_intensity;
     bool  skylight_valid;
+
+    ivec3 light_cluster_grid;    // The number of light clusters in x, y and z direction.
+    float light_cluster_z_scale; // Scale to calculate the depth slice of a light cluster from the logarithm of the view space depth.
+    float light_cluster_z_bias;  // Bias to calculate the depth slice of a light cluster from the logarithm of the view space depth.
+};
+
+// A point or spot light. Point lights have a spot scale of 0.0 and a spot offset of 1.0, so they are not attenuated by the cone.
+struct punctual_light_data
+{
+    vec4 position_range;       // World space position xyz, range w.
+    vec4 color_intensity;      // Color rgb, luminous intensity in candela w.
+    vec4 direction_spot_scale; // Normalized world space direction the light points in xyz, cone attenuation scale w.
+    vec4 spot_offset;          // Cone attenuation offset x, yzw unused.
+};
+
+layout(binding = PUNCTUAL_LIGHT_BUFFER_BINDING_POINT, std430) readonly buffer punctual_light_buffer
+{
+    punctual_light_data punctual_lights[];
+};
+
+layout(binding = LIGHT_CLUSTER_BUFFER_BINDING_POINT, std430) readonly buffer light_cluster_buffer
+{
+    uvec2 light_clusters[]; // Offset into light_indices x, number of lights y.
+};
+
+layout(binding = LIGHT_INDEX_BUFFER_BINDING_POINT, std430) readonly buffer light_index_buffer
+{
+    uint light_indices[];
 };
 
 #endif // MANGO_LIGHT_GLSL
\ No newline at end of file
@@ -76,4 +76,56 @@ vec3 calculate_directional_light(in vec3 base_color, in vec3 normal, in vec3 vie
     return lighting;
 }
 
+vec3 calculate_punctual_lights(in vec3 position, in vec3 base_color, in vec3 normal, in vec3 view, in float n_dot_v, in float perceptual_roughness, in float metallic, in vec3 f0, in float occlusion)
+{
+    // find the cluster from the screen position and the logarithmic view depth.
+    vec4 clip         = view_projection_matrix * vec4(position, 1.0);
+    vec2 uv           = saturate((clip.xy / clip.w) * 0.5 + 0.5);
+    float view_depth  = max(-(view_matrix * vec4(position, 1.0)).z, 1e-4);
+    ivec3 cluster     = ivec3(uv * vec2(light_cluster_grid.xy), floor(log(view_depth) * light_cluster_z_scale + light_cluster_z_bias));
+    cluster           = clamp(cluster, ivec3(0), light_cluster_grid - 1);
+    uvec2 light_range = light_clusters[(cluster.z * light_cluster_grid.y + cluster.y) * light_cluster_grid.x + cluster.x];
+
+    float alpha = perceptual_roughness * perceptual_roughness;
+    vec3 albedo = base_color * (1.0 - metallic);
+
+    vec3 lighting = vec3(0.0);
+    for(uint i = 0; i < light_range.y; ++i)
+    {
+        punctual_light_data light = punctual_lights[light_indices[light_range.x + i]];
+
+        vec3 to_light           = light.position_range.xyz - position;
+        float distance_squared  = max(dot(to_light, to_light), 1e-4);
+        vec3 light_dir          = to_light * inversesqrt(distance_squared);
+
+        // windowed inverse square falloff reaching zero at the range.
+        float range_factor = distance_squared / (light.position_range.w * light.position_range.w);
+        float attenuation  = saturate(1.0 - range_factor * range_factor);
+        attenuation        = attenuation * attenuation / distance_squared;
+
+        // cone falloff, point lights have a scale of 0.0 and an offset of 1.0.
+        float cone   = saturate(dot(-light_dir, light.direction_spot_scale.xyz) * light.direction_spot_scale.w + light.spot_offset.x);
+        attenuation *= cone * cone;
+
+        float n_dot_l = saturate(dot(normal, light_dir));
+        if(attenuation * n_dot_l <= 0.0)
+            continue;
+
+        vec3 halfway  = normalize(light_dir + view);
+        float n_dot_h = saturate(dot(normal, halfway));
+        float l_dot_h = saturate(dot(light_dir, halfway));
+
+        float D = D_GGX(n_dot_h, alpha);
+        vec3 F  = F_Schlick(l_dot_h, f0, 1.0);
+        float V = V_SmithGGXCorrelated(n_dot_v, n_dot_l, alpha);
+
+        vec3 Fr = D * V * F * INV_PI;
+        vec3 Fd = albedo * Fd_BurleyRenormalized(n_dot_v, n_dot_l, l_dot_h, alpha) * INV_PI;
+
+        lighting += (n_dot_l * Fd * occlusion + n_dot_l * Fr) * light.color_intensity.rgb * light.color_intensity.w * attenuation;
+    }
+
+    return lighting;
+}
+
 #endif // MANGO_LIGHTING_FUNCTIONS_GLSL
@@ -3,6 +3,34 @@
 
 #include <bindings.glsl>
 
+#ifdef MULTI_DRAW
+
+// The model data of all draws of a multi draw, the base instance of each draw is the index of its entry.
+struct model_entry
+{
+    mat4  model_matrix;
+    mat3  normal_matrix;
+    bool  has_normals;
+    bool  has_tangents;
+};
+
+layout(binding = MODEL_DATA_BUFFER_BINDING_POINT, std430) readonly buffer model_entries_data
+{
+    model_entry model_entries[];
+};
+
+// Fragment stages have to define the index forwarded by the vertex stage.
+#ifndef MODEL_ENTRY_INDEX
+#define MODEL_ENTRY_INDEX gl_BaseInstanceARB
+#endif
+
+#define model_matrix model_entries[MODEL_ENTRY_INDEX].model_matrix
+#define normal_matrix model_entries[MODEL_ENTRY_INDEX].normal_matrix
+#define has_normals model_entries[MODEL_ENTRY_INDEX].has_normals
+#define has_tangents model_entries[MODEL_ENTRY_INDEX].has_tangents
+
+#else
+
 layout(binding = MODEL_DATA_BUFFER_BINDING_POINT, std140) uniform model_data
 {
     mat4  model_matrix;  // The model matrix.
@@ -11,4 +39,6 @@ layout(binding = MODEL_DATA_BUFFER_BINDING_POINT, std140) uniform model_data
     bool  has_tangents;  // Specifies if the mesh has tangents as a vertex attribute.
 };
 
+#endif // MULTI_DRAW
+
 #endif // MANGO_MODEL_GLSL
\ No newline at end of file
@@ -18,6 +18,9 @@ out shared_data
     vec3 normal;
     vec3 tangent;
     vec3 bitangent;
+#ifdef MULTI_DRAW
+    flat int model_entry;
+#endif // MULTI_DRAW
 } vs_out;
 
 #include <camera.glsl>
@@ -40,8 +43,15 @@ in shared_data
     vec3 normal;
     vec3 tangent;
     vec3 bitangent;
+#ifdef MULTI_DRAW
+    flat int model_entry;
+#endif // MULTI_DRAW
 } fs_in;
 
+#ifdef MULTI_DRAW
+#define MODEL_ENTRY_INDEX fs_in.model_entry
+#endif // MULTI_DRAW
+
 layout(binding = GEOMETRY_TEXTURE_SAMPLER_BASE_COLOR) uniform sampler2D sampler_base_color; // texture "texture_base_color"
 layout(binding = GEOMETRY_TEXTURE_SAMPLER_ROUGHNESS_METALLIC) uniform sampler2D sampler_roughness_metallic; // texture "texture_roughness_metallic"
 layout(binding = GEOMETRY_TEXTURE_SAMPLER_OCCLUSION) uniform sampler2D sampler_occlusion; // texture "texture_occlusion"
@@ -1,8 +1,9 @@
-layout(triangles) in;
-layout(triangle_strip, max_vertices = 3) out;
-
 #include <../include/shadow.glsl>
 
+// one invocation per cascade, invocations of cascades not in the mask emit nothing.
+layout(triangles, invocations = MAX_SHADOW_CASCADES) in;
+layout(triangle_strip, max_vertices = 3) out;
+
 in shared_data
 {
     vec2 texcoord;
@@ -15,8 +16,11 @@ out shared_data
 
 void main()
 {
-    gl_Layer = shadow_cascade;
-    mat4 view_projection_matrix = shadow_view_projection_matrices[shadow_cascade];
+    if ((shadow_cascade_mask & (1 << gl_InvocationID)) == 0)
+        return;
+
+    gl_Layer = gl_InvocationID;
+    mat4 view_projection_matrix = shadow_view_projection_matrices[gl_InvocationID];
     for(int i = 0; i < gl_in.length(); ++i)
     {
         vec4 pos = view_projection_matrix * gl_in[i].gl_Position;
@@ -1,3 +1,7 @@
+#ifdef MULTI_DRAW
+#extension GL_ARB_shader_draw_parameters : require
+#endif // MULTI_DRAW
+
 #include <../include/bindings.glsl>
 
 layout(location = VERTEX_INPUT_POSITION) in vec3 vertex_data_position;
@@ -0,0 +1,216 @@
+//! \file      bounding_volume_hierarchy_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <scene/bounding_volume_hierarchy.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class bounding_volume_hierarchy_test : public ::testing::Test
+    {
+      protected:
+        bounding_volume_hierarchy_test()
+            : frustum(mango::lookAt(make_vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f)), mango::perspective(mango::deg_to_rad(45.0f), 16.0f / 9.0f, 0.1f, 50.0f))
+        {
+        }
+
+        ~bounding_volume_hierarchy_test() override {}
+
+        void SetUp() override {}
+
+        void TearDown() override {}
+
+        std::vector<axis_aligned_bounding_box> random_boxes(uint32 count, float range)
+        {
+            std::uniform_real_distribution<float> position(-range, range);
+            std::uniform_real_distribution<float> size(0.01f, 2.0f);
+            std::vector<axis_aligned_bounding_box> boxes(count);
+            for (auto& b : boxes)
+            {
+                b.center  = vec3(position(rng), position(rng), position(rng));
+                b.extents = vec3(size(rng), size(rng), size(rng));
+            }
+            return boxes;
+        }
+
+        std::vector<uint32> brute_force(const std::vector<axis_aligned_bounding_box>& boxes)
+        {
+            std::vector<uint32> result;
+            for (uint32 i = 0; i < static_cast<uint32>(boxes.size()); ++i)
+            {
+                if (frustum.intersects(boxes[i]))
+                    result.push_back(i);
+            }
+            return result;
+        }
+
+        std::vector<uint32> sorted_query(const bounding_volume_hierarchy& bvh)
+        {
+            std::vector<uint32> result;
+            bvh.query(frustum, result);
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        std::mt19937 rng{ 11 };
+        bounding_frustum frustum;
+    };
+
+    TEST_F(bounding_volume_hierarchy_test, empty_hierarchy_returns_nothing)
+    {
+        bounding_volume_hierarchy bvh;
+        bvh.build({});
+        ASSERT_EQ(bvh.item_count(), 0);
+        ASSERT_EQ(bvh.node_count(), 0);
+        ASSERT_TRUE(sorted_query(bvh).empty());
+    }
+
+    TEST_F(bounding_volume_hierarchy_test, query_matches_brute_force)
+    {
+        std::vector<axis_aligned_bounding_box> boxes = random_boxes(5000, 60.0f);
+        bounding_volume_hierarchy bvh;
+        bvh.build(boxes);
+
+        ASSERT_EQ(bvh.item_count(), 5000);
+        ASSERT_LE(bvh.node_count(), 2 * 5000 - 1);
+
+        std::vector<uint32> expected = brute_force(boxes);
+        ASSERT_GT(expected.size(), 0);
+        ASSERT_LT(expected.size(), boxes.size());
+        ASSERT_EQ(sorted_query(bvh), expected);
+    }
+
+    TEST_F(bounding_volume_hierarchy_test, identical_boxes_are_split)
+    {
+        std::vector<axis_aligned_bounding_box> boxes(100, axis_aligned_bounding_box(vec3(0.0f, 0.0f, -5.0f), make_vec3(1.0f)));
+        bounding_volume_hierarchy bvh;
+        bvh.build(boxes);
+
+        ASSERT_GT(bvh.node_count(), 1);
+        ASSERT_EQ(sorted_query(bvh), brute_force(boxes));
+    }
+
+    TEST_F(bounding_volume_hierarchy_test, refit_after_update_matches_brute_force)
+    {
+        std::vector<axis_aligned_bounding_box> boxes = random_boxes(2000, 60.0f);
+        bounding_volume_hierarchy bvh;
+        bvh.build(boxes);
+
+        // move some boxes anywhere, including into and out of the frustum
+        std::vector<axis_aligned_bounding_box> moved = random_boxes(200, 60.0f);
+        std::uniform_int_distribution<uint32> item(0, 1999);
+        for (auto& b : moved)
+        {
+            uint32 i = item(rng);
+            boxes[i] = b;
+            bvh.update_item(i, b);
+        }
+        // and one directly in front of the camera
+        boxes[0] = axis_aligned_bounding_box(vec3(0.0f, 0.0f, -3.0f), make_vec3(0.5f));
+        bvh.update_item(0, boxes[0]);
+
+        std::vector<uint32> result = sorted_query(bvh);
+        ASSERT_EQ(result, brute_force(boxes));
+        ASSERT_EQ(result.front(), 0);
+    }
+
+    TEST_F(bounding_volume_hierarchy_test, multi_frustum_query_matches_single_queries)
+    {
+        std::vector<axis_aligned_bounding_box> boxes = random_boxes(5000, 60.0f);
+        bounding_volume_hierarchy bvh;
+        bvh.build(boxes);
+
+        // overlapping frusta like shadow cascades, the last one contains whole subtrees
+        bounding_frustum frusta[4] = {
+            frustum,
+            bounding_frustum(mango::lookAt(make_vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f)), mango::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 0.0f, 30.0f)),
+            bounding_frustum(mango::lookAt(make_vec3(0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f)), mango::ortho(-20.0f, 20.0f, -20.0f, 20.0f, 0.0f, 60.0f)),
+            bounding_frustum(mango::lookAt(vec3(0.0f, 0.0f, 100.0f), make_vec3(0.0f), vec3(0.0f, 1.0f, 0.0f)), mango::ortho(-100.0f, 100.0f, -100.0f, 100.0f, 0.0f, 200.0f)),
+        };
+
+        std::vector<uint32> items;
+        std::vector<uint32> masks;
+        bvh.query(frusta, 4, items, masks);
+        ASSERT_EQ(items.size(), masks.size());
+
+        std::vector<uint32> expected_masks(boxes.size(), 0u);
+        for (uint32 f = 0; f < 4; ++f)
+        {
+            std::vector<uint32> single;
+            bvh.query(frusta[f], single);
+            for (uint32 i : single)
+                expected_masks[i] |= 1u << f;
+        }
+
+        std::vector<uint32> result_masks(boxes.size(), 0u);
+        for (uint32 i = 0; i < static_cast<uint32>(items.size()); ++i)
+        {
+            // every item is only added once
+            ASSERT_EQ(result_masks[items[i]], 0u);
+            ASSERT_NE(masks[i], 0u);
+            result_masks[items[i]] = masks[i];
+        }
+        ASSERT_EQ(result_masks, expected_masks);
+
+        // masks only contain the frusta queried
+        items.clear();
+        masks.clear();
+        bvh.query(frusta, 2, items, masks);
+        for (uint32 m : masks)
+            ASSERT_EQ(m & ~3u, 0u);
+    }
+
+    TEST_F(bounding_volume_hierarchy_test, benchmark_hierarchical_culling)
+    {
+        // a large scene with only a small part inside the frustum
+        const uint32 count                           = 100000;
+        std::vector<axis_aligned_bounding_box> boxes = random_boxes(count, 500.0f);
+
+        bounding_box_batch batch;
+        for (auto& b : boxes)
+            batch.push_back(b);
+
+        bounding_volume_hierarchy bvh;
+        auto start = std::chrono::high_resolution_clock::now();
+        bvh.build(boxes);
+        auto end     = std::chrono::high_resolution_clock::now();
+        double build = std::chrono::duration<double, std::milli>(end - start).count();
+
+        const int32 iterations = 20;
+        std::vector<uint32> visibility;
+        start = std::chrono::high_resolution_clock::now();
+        for (int32 i = 0; i < iterations; ++i)
+            frustum.intersects(batch, visibility);
+        end           = std::chrono::high_resolution_clock::now();
+        double linear = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+
+        std::vector<uint32> items;
+        start = std::chrono::high_resolution_clock::now();
+        for (int32 i = 0; i < iterations; ++i)
+        {
+            items.clear();
+            bvh.query(frustum, items);
+        }
+        end                 = std::chrono::high_resolution_clock::now();
+        double hierarchical = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+
+        uint32 visible = 0;
+        for (uint32 i = 0; i < count; ++i)
+            visible += bounding_box_batch::visible(visibility, i) ? 1 : 0;
+        ASSERT_EQ(items.size(), visible);
+
+        std::cout << "[ BENCHMARK] frustum culling (" << count << " boxes, " << visible << " visible): batch " << linear << " ms, hierarchy " << hierarchical << " ms (build " << build << " ms)"
+                  << std::endl;
+    }
+} // namespace mango
+
+//! \endcond
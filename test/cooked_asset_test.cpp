@@ -0,0 +1,219 @@
+//! \file      cooked_asset_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <resources/cooked_asset.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class cooked_asset_test : public ::testing::Test
+    {
+      protected:
+        cooked_asset_test() {}
+
+        ~cooked_asset_test() override {}
+
+        void SetUp() override {}
+
+        void TearDown() override
+        {
+            std::remove(cooked_path.c_str());
+            std::remove(buffer_path.c_str());
+        }
+
+        void write_buffer_file(int32 size)
+        {
+            std::ofstream output(buffer_path, std::ios::out | std::ios::binary | std::ios::trunc);
+            std::vector<char> data(size, 7);
+            output.write(data.data(), size);
+        }
+
+        image_resource rgba8_image(std::vector<uint8>& data, int32 width, int32 height)
+        {
+            image_resource img;
+            img.data                                = data.data();
+            img.width                               = width;
+            img.height                              = height;
+            img.number_components                   = 4;
+            img.bits                                = 8;
+            img.description.is_standard_color_space = false;
+            img.description.is_hdr                  = false;
+            return img;
+        }
+
+        const string cooked_path = "cooked_asset_test.cooked";
+        const string buffer_path = "cooked_asset_test.bin";
+    };
+
+    TEST_F(cooked_asset_test, generates_full_mip_chain)
+    {
+        // 4x2 pixels, left half black, right half white.
+        std::vector<uint8> data(4 * 2 * 4, 0);
+        for (int32 y = 0; y < 2; ++y)
+            for (int32 x = 2; x < 4; ++x)
+                for (int32 c = 0; c < 4; ++c)
+                    data[(y * 4 + x) * 4 + c] = 255;
+        image_resource img = rgba8_image(data, 4, 2);
+
+        std::vector<uint8> chain;
+        int32 levels = generate_mip_chain(img, false, chain);
+        ASSERT_EQ(levels, 3);
+        ASSERT_EQ(static_cast<int64>(chain.size()), get_image_level_size(img, 0) + get_image_level_size(img, 1) + get_image_level_size(img, 2));
+
+        // level 1 is 2x1 and keeps both halves, level 2 is 1x1 and averages them.
+        const uint8* level_1 = chain.data() + get_image_level_size(img, 0);
+        ASSERT_EQ(level_1[0], 0);
+        ASSERT_EQ(level_1[4], 255);
+        const uint8* level_2 = level_1 + get_image_level_size(img, 1);
+        ASSERT_EQ(level_2[0], 128);
+        ASSERT_EQ(level_2[3], 128);
+    }
+
+    TEST_F(cooked_asset_test, cooked_image_round_trip)
+    {
+        std::vector<uint8> data(8 * 8 * 4, 42);
+        image_resource img = rgba8_image(data, 8, 8);
+
+        std::vector<uint8> chain;
+        img.mip_levels = generate_mip_chain(img, false, chain);
+        img.data       = chain.data();
+
+        cooked_source_stamp stamp = { 1234, 5678, 1 };
+        ASSERT_TRUE(write_cooked_image(cooked_path, stamp, img));
+
+        mapped_file file;
+        ASSERT_TRUE(file.open(cooked_path));
+        image_resource cooked;
+        cooked.description.is_hdr = false;
+        ASSERT_TRUE(read_cooked_image(file, stamp, cooked));
+        ASSERT_EQ(cooked.width, 8);
+        ASSERT_EQ(cooked.height, 8);
+        ASSERT_EQ(cooked.number_components, 4);
+        ASSERT_EQ(cooked.bits, 8);
+        ASSERT_EQ(cooked.mip_levels, 4);
+        ASSERT_TRUE(std::equal(chain.begin(), chain.end(), static_cast<const uint8*>(cooked.data)));
+
+        cooked_source_stamp changed = { 1234, 5679, 1 };
+        ASSERT_FALSE(read_cooked_image(file, changed, cooked));
+    }
+
+    TEST_F(cooked_asset_test, cooked_model_round_trip)
+    {
+        tinygltf::Model m;
+        m.defaultScene = 0;
+        m.scenes.resize(1);
+        m.scenes[0].nodes = { 0 };
+        m.nodes.resize(2);
+        m.nodes[0].name        = "root";
+        m.nodes[0].children    = { 1 };
+        m.nodes[0].translation = { 1.0, 2.0, 3.0 };
+        m.nodes[1].mesh        = 0;
+
+        float positions[] = { -1.0f, 0.0f, 2.0f, 3.0f, -4.0f, 0.5f, 0.0f, 1.0f, -2.0f };
+        m.buffers.resize(1);
+        m.buffers[0].data.assign(reinterpret_cast<uint8*>(positions), reinterpret_cast<uint8*>(positions) + sizeof(positions));
+        m.bufferViews.resize(1);
+        m.bufferViews[0].buffer     = 0;
+        m.bufferViews[0].byteLength = sizeof(positions);
+        m.accessors.resize(1);
+        m.accessors[0].bufferView    = 0;
+        m.accessors[0].componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+        m.accessors[0].type          = TINYGLTF_TYPE_VEC3;
+        m.accessors[0].count         = 3;
+        m.meshes.resize(1);
+        m.meshes[0].primitives.resize(1);
+        m.meshes[0].primitives[0].attributes["POSITION"] = 0;
+        m.meshes[0].primitives[0].material               = 0;
+        m.materials.resize(1);
+        m.materials[0].name                                        = "material";
+        m.materials[0].alphaMode                                   = "MASK";
+        m.materials[0].pbrMetallicRoughness.baseColorTexture.index = 0;
+        m.textures.resize(1);
+        m.textures[0].source = 0;
+        m.images.resize(1);
+        m.images[0].uri       = "base_color.png";
+        m.images[0].width     = 2;
+        m.images[0].height    = 2;
+        m.images[0].component = 4;
+        m.images[0].bits      = 8;
+        m.images[0].image.assign(2 * 2 * 4, 255);
+
+        calculate_missing_bounds(m);
+        ASSERT_EQ(m.accessors[0].minValues.size(), 3u);
+        ASSERT_EQ(m.accessors[0].minValues[1], -4.0);
+        ASSERT_EQ(m.accessors[0].maxValues[2], 2.0);
+
+        cooked_source_stamp stamp = { 1, 2, 0 };
+        ASSERT_TRUE(write_cooked_model(cooked_path, stamp, {}, m));
+
+        mapped_file file;
+        ASSERT_TRUE(file.open(cooked_path));
+        model_resource cooked;
+        ASSERT_TRUE(read_cooked_model(file, stamp, cooked));
+
+        const tinygltf::Model& c = cooked.gltf_model;
+        ASSERT_EQ(c.defaultScene, 0);
+        ASSERT_EQ(c.nodes.size(), 2u);
+        ASSERT_EQ(c.nodes[0].name, "root");
+        ASSERT_EQ(c.nodes[0].children.size(), 1u);
+        ASSERT_EQ(c.nodes[0].translation[2], 3.0);
+        ASSERT_EQ(c.nodes[1].mesh, 0);
+        ASSERT_EQ(c.meshes[0].primitives[0].attributes.at("POSITION"), 0);
+        ASSERT_EQ(c.accessors[0].maxValues[0], 3.0);
+        ASSERT_EQ(c.materials[0].alphaMode, "MASK");
+        ASSERT_EQ(c.materials[0].pbrMetallicRoughness.baseColorTexture.index, 0);
+
+        ASSERT_EQ(cooked.buffer_view_data.size(), 1u);
+        ASSERT_EQ(c.bufferViews[0].byteLength, sizeof(positions));
+        ASSERT_TRUE(std::equal(m.buffers[0].data.begin(), m.buffers[0].data.end(), cooked.buffer_view_data[0]));
+
+        ASSERT_EQ(cooked.images.size(), 1u);
+        ASSERT_EQ(cooked.images[0].mip_levels, 2);
+        ASSERT_EQ(string(cooked.images[0].description.path), "base_color.png");
+        ASSERT_EQ(static_cast<const uint8*>(cooked.images[0].data)[0], 255);
+    }
+
+    TEST_F(cooked_asset_test, changed_external_buffer_makes_cooked_model_stale)
+    {
+        write_buffer_file(12);
+
+        tinygltf::Model m;
+        m.buffers.resize(2);
+        m.buffers[0].uri = buffer_path;
+        m.buffers[0].data.assign(12, 7);
+        m.buffers[1].uri = "data:application/octet-stream;base64,AAAA";
+        m.buffers[1].data.assign(3, 0);
+
+        // the source file itself is never touched, only the buffer next to it.
+        std::vector<cooked_dependency> dependencies = get_cooked_model_dependencies("cooked_asset_test.gltf", m);
+        ASSERT_EQ(dependencies.size(), 1u);
+        ASSERT_EQ(dependencies[0].path, buffer_path);
+        ASSERT_EQ(dependencies[0].size, 12u);
+
+        cooked_source_stamp stamp = { 1, 2, 0 };
+        ASSERT_TRUE(write_cooked_model(cooked_path, stamp, dependencies, m));
+
+        {
+            mapped_file file;
+            ASSERT_TRUE(file.open(cooked_path));
+            model_resource cooked;
+            ASSERT_TRUE(read_cooked_model(file, stamp, cooked));
+        }
+
+        write_buffer_file(16);
+
+        mapped_file file;
+        ASSERT_TRUE(file.open(cooked_path));
+        model_resource cooked;
+        ASSERT_FALSE(read_cooked_model(file, stamp, cooked));
+    }
+} // namespace mango
+
+//! \endcond
@@ -0,0 +1,219 @@
+//! \file      deferred_graphics_device_context_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <graphics/deferred_graphics_device_context.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class replayed_pipeline : public gfx_pipeline
+    {
+      public:
+        void* native_handle() const override
+        {
+            return nullptr;
+        }
+        gfx_handle<shader_resource_mapping> get_resource_mapping() const override
+        {
+            return nullptr;
+        }
+
+      protected:
+        void submit_pipeline_resources(gfx_handle<gfx_graphics_state>) const override {}
+    };
+
+    class replayed_buffer : public gfx_buffer
+    {
+      public:
+        void* native_handle() const override
+        {
+            return nullptr;
+        }
+    };
+
+    // Logs the calls replayed by a deferred context, without keeping any of the handles.
+    class logging_context : public graphics_device_context
+    {
+      public:
+        void begin() override
+        {
+            calls.push_back("begin");
+        }
+        void make_current() override {}
+        void set_swap_interval(int32) override {}
+        void set_buffer_data(gfx_handle<const gfx_buffer> buffer_handle, int32 offset, int32 size, void* data) override
+        {
+            calls.push_back("set_buffer_data");
+            last_buffer = buffer_handle.get();
+            last_offset = offset;
+            last_data.assign(static_cast<uint8*>(data), static_cast<uint8*>(data) + size);
+        }
+        void* map_buffer_data(gfx_handle<const gfx_buffer>, int32, int32) override
+        {
+            return nullptr;
+        }
+        void set_texture_data(gfx_handle<const gfx_texture>, const texture_set_description&, void*) override {}
+        void set_viewport(int32, int32 count, const gfx_viewport* viewports) override
+        {
+            calls.push_back("set_viewport");
+            last_viewport = viewports[count - 1];
+        }
+        void set_scissor(int32, int32, const gfx_scissor_rectangle*) override {}
+        void set_line_width(float) override {}
+        void set_depth_bias(float, float, float) override {}
+        void set_blend_constants(const float[4]) override {}
+        void set_stencil_compare_mask_and_reference(gfx_stencil_face_flag_bits, uint32, uint32) override {}
+        void set_stencil_write_mask(gfx_stencil_face_flag_bits, uint32) override {}
+        void set_render_targets(int32, gfx_handle<const gfx_texture>*, gfx_handle<const gfx_texture>) override {}
+        void calculate_mipmaps(gfx_handle<const gfx_texture>) override {}
+        void copy_texture(gfx_handle<const gfx_texture>, int32, gfx_handle<const gfx_texture>, int32, int32) override {}
+        void clear_render_target(gfx_clear_attachment_flag_bits, float[4]) override {}
+        void clear_depth_stencil(gfx_clear_attachment_flag_bits, float, int32) override {}
+        void set_vertex_buffers(int32 count, gfx_handle<const gfx_buffer>* buffers, int32*, int32* offsets) override
+        {
+            calls.push_back("set_vertex_buffers");
+            last_buffer = buffers[count - 1].get();
+            last_offset = offsets[count - 1];
+        }
+        void set_index_buffer(gfx_handle<const gfx_buffer>, gfx_format) override {}
+        void bind_pipeline(gfx_handle<const gfx_pipeline> pipeline_handle) override
+        {
+            calls.push_back("bind_pipeline");
+            last_pipeline = pipeline_handle.get();
+        }
+        void set_shader_resource(const shader_resource_mapping::resource_slot&, gfx_handle<const gfx_device_object>) override {}
+        void set_shader_resource_buffer_range(const shader_resource_mapping::resource_slot&, gfx_handle<const gfx_buffer>, int32, int32) override {}
+        void submit_pipeline_state_resources() override
+        {
+            calls.push_back("submit_pipeline_state_resources");
+        }
+        void draw(int32 vertex_count, int32, int32, int32, int32, int32) override
+        {
+            calls.push_back("draw");
+            last_vertex_count = vertex_count;
+        }
+        void draw_indexed_indirect(gfx_handle<const gfx_buffer>, int32, int32, int32) override {}
+        void dispatch(int32, int32, int32) override {}
+        void barrier(const barrier_description&) override {}
+        gfx_handle<const gfx_semaphore> fence(const semaphore_create_info&) override
+        {
+            return nullptr;
+        }
+        void client_wait(gfx_handle<const gfx_semaphore>) override {}
+        bool is_signaled(gfx_handle<const gfx_semaphore>) override
+        {
+            return false;
+        }
+        void wait(gfx_handle<const gfx_semaphore>) override {}
+        void present() override {}
+        void end() override
+        {
+            calls.push_back("end");
+        }
+        void submit() override
+        {
+            calls.push_back("submit");
+        }
+
+        std::vector<string> calls;
+        const gfx_pipeline* last_pipeline = nullptr;
+        const gfx_buffer* last_buffer     = nullptr;
+        int32 last_offset                 = 0;
+        std::vector<uint8> last_data;
+        gfx_viewport last_viewport = {};
+        int32 last_vertex_count    = 0;
+    };
+
+    class deferred_graphics_device_context_test : public ::testing::Test
+    {
+      protected:
+        deferred_graphics_device_context_test()
+            : executor(new logging_context())
+            , deferred(graphics_device_context_handle(executor))
+            , pipeline(std::make_shared<replayed_pipeline>())
+            , buffer(std::make_shared<replayed_buffer>())
+        {
+        }
+
+        ~deferred_graphics_device_context_test() override {}
+
+        // Records a small pass the way a render pass would do it.
+        void record()
+        {
+            deferred.begin();
+            deferred.bind_pipeline(pipeline);
+            gfx_viewport viewport{ 0.0f, 0.0f, 512.0f, 256.0f };
+            deferred.set_viewport(0, 1, &viewport);
+            {
+                // the data only has to be valid while recording.
+                std::vector<uint8> data = { 1, 2, 3, 4, 5 };
+                deferred.set_buffer_data(buffer, 16, static_cast<int32>(data.size()), data.data());
+            }
+            gfx_handle<const gfx_buffer> vertex_buffers[] = { buffer };
+            int32 bindings[]                              = { 0 };
+            int32 offsets[]                               = { 32 };
+            deferred.set_vertex_buffers(1, vertex_buffers, bindings, offsets);
+            deferred.submit_pipeline_state_resources();
+            deferred.draw(3, 0, 1, 0, 0, 0);
+            deferred.end();
+        }
+
+        // owned by the deferred context.
+        logging_context* executor;
+        deferred_graphics_device_context deferred;
+        gfx_handle<const gfx_pipeline> pipeline;
+        gfx_handle<const gfx_buffer> buffer;
+    };
+
+    TEST_F(deferred_graphics_device_context_test, records_on_worker_and_replays_on_submit)
+    {
+        std::thread worker([this]() { record(); });
+        worker.join();
+
+        // nothing reaches the executor while recording.
+        EXPECT_TRUE(executor->calls.empty());
+        EXPECT_EQ(deferred.command_count(), 6);
+
+        deferred.submit();
+
+        std::vector<string> expected = { "begin", "bind_pipeline", "set_viewport", "set_buffer_data", "set_vertex_buffers", "submit_pipeline_state_resources", "draw", "end", "submit" };
+        EXPECT_EQ(executor->calls, expected);
+        EXPECT_EQ(executor->last_pipeline, pipeline.get());
+        EXPECT_EQ(executor->last_buffer, buffer.get());
+        EXPECT_EQ(executor->last_offset, 32);
+        EXPECT_EQ(executor->last_data, std::vector<uint8>({ 1, 2, 3, 4, 5 }));
+        EXPECT_FLOAT_EQ(executor->last_viewport.width, 512.0f);
+        EXPECT_FLOAT_EQ(executor->last_viewport.height, 256.0f);
+        EXPECT_EQ(executor->last_vertex_count, 3);
+    }
+
+    TEST_F(deferred_graphics_device_context_test, submit_hands_references_to_executor)
+    {
+        record();
+
+        // the recorded commands keep the objects alive.
+        EXPECT_EQ(pipeline.use_count(), 2);
+        EXPECT_EQ(buffer.use_count(), 3);
+
+        deferred.submit();
+
+        // the executor got the references and released them, the commands are consumed.
+        EXPECT_EQ(pipeline.use_count(), 1);
+        EXPECT_EQ(buffer.use_count(), 1);
+        EXPECT_EQ(deferred.command_count(), 0);
+        EXPECT_EQ(deferred.command_buffer_size(), 0);
+
+        executor->calls.clear();
+        deferred.submit();
+        std::vector<string> expected = { "begin", "end", "submit" };
+        EXPECT_EQ(executor->calls, expected);
+    }
+} // namespace mango
+
+//! \endcond
@@ -0,0 +1,174 @@
+//! \file      frame_arena_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <core/job_system.hpp>
+#include <gtest/gtest.h>
+#include <heap_allocation_counter.hpp>
+#include <memory/frame_arena.hpp>
+#include <random>
+#include <rendering/render_graph.hpp>
+#include <scene/bounding_volume_hierarchy.hpp>
+#include <scene/transform_hierarchy.hpp>
+#include <util/radix_sort.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class frame_arena_test : public ::testing::Test
+    {
+      protected:
+        frame_arena_test()
+            : arena(4096)
+            , jobs(3)
+        {
+        }
+
+        ~frame_arena_test() override {}
+
+        //! \brief Builds a scene hierarchy with bounds for \a simulate_frame().
+        void create_scene(uint32 node_count)
+        {
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+            bounds.resize(node_count);
+            for (uint32 i = 0; i < node_count; ++i)
+            {
+                hierarchy.add(key(i), key(i), i == 0 ? NONE : optional<key>(key((i - 1) / 16)));
+                bounds[i].center  = vec3(position(rng), position(rng), position(rng));
+                bounds[i].extents = make_vec3(0.5f);
+            }
+            bvh.build(bounds);
+            hierarchy.update(&jobs);
+
+            camera_frustum = bounding_frustum(mango::lookAt(make_vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f)), mango::perspective(mango::deg_to_rad(60.0f), 16.0f / 9.0f, 0.1f, 60.0f));
+            for (int32 c = 0; c < 4; ++c)
+                cascade_frusta[c] = bounding_frustum(mango::lookAt(make_vec3(0.0f), vec3(0.0f, -1.0f, -0.1f * c), vec3(0.0f, 0.0f, -1.0f)), mango::ortho(-20.0f, 20.0f, -20.0f, 20.0f, -50.0f, 50.0f));
+
+            target_info.texture_type   = gfx_texture_type::texture_type_2d;
+            target_info.texture_format = gfx_format::rgba8;
+            target_info.width          = 64;
+            target_info.height         = 32;
+            target_info.miplevels      = 1;
+            target_info.array_layers   = 1;
+        }
+
+        //! \brief Does the same kind of work the scene update and the renderer do each frame, without a graphics device.
+        void simulate_frame(uint32 frame)
+        {
+            arena.begin_frame();
+
+            // scene update: some nodes move back and forth, the hierarchy is updated in parallel and the moved bounds are refitted
+            const vec3 offset = vec3(0.1f * (frame % 2), 0.0f, 0.0f);
+            for (uint32 i = frame % 7; i < hierarchy.size(); i += 7)
+                hierarchy.set_local(i, offset, quat::Identity(), make_vec3(1.0f));
+            hierarchy.update(&jobs);
+            for (uint32 i = frame % 7; i < bvh.item_count(); i += 97)
+                bvh.update_item(i, axis_aligned_bounding_box(bounds[i].center + offset, bounds[i].extents));
+
+            // culling
+            visible.clear();
+            bvh.query(camera_frustum, visible);
+            cascade_instances.clear();
+            cascade_masks.clear();
+            bvh.query(cascade_frusta, 4, cascade_instances, cascade_masks);
+
+            // draw keys are generated in parallel chunks and sorted
+            const uint32 chunk_size = 256;
+            const uint32 count      = static_cast<uint32>(visible.size());
+            frame_vector<frame_vector<sort_pair>> chunks(job_system::chunk_count(count, chunk_size), frame_vector<sort_pair>(arena), arena);
+            jobs.parallel_for(count, chunk_size, [this, &chunks, chunk_size](uint32 begin, uint32 end) {
+                frame_vector<sort_pair>& chunk = chunks[begin / chunk_size];
+                chunk.reserve(end - begin);
+                for (uint32 i = begin; i < end; ++i)
+                    chunk.push_back(sort_pair{ static_cast<uint64>((visible[i] * 2654435761u) % 1000), visible[i] });
+            });
+
+            frame_vector<sort_pair> pairs(arena);
+            pairs.reserve(count);
+            for (auto& c : chunks)
+                pairs.insert(pairs.end(), c.begin(), c.end());
+            radix_sort(pairs.data(), static_cast<uint32>(pairs.size()), arena, &jobs);
+
+            for (size_t i = 1; i < pairs.size(); ++i)
+                ASSERT_LE(pairs[i - 1].sort_key, pairs[i].sort_key);
+
+            // the frame graph is declared again
+            graph.reset();
+            render_graph_resource color  = graph.create_texture("color", target_info);
+            render_graph_resource output = graph.import_texture("output", nullptr);
+            graph.add_pass(
+                "draw", [&](render_graph_builder& builder) { builder.clear_color(color, vec4::Zero()); },
+                [&pairs](const render_graph&, graphics_device_context_handle&) { MANGO_UNUSED(pairs); });
+            graph.add_pass(
+                "composite",
+                [&](render_graph_builder& builder) {
+                    builder.read(color, render_graph_access::sampled);
+                    builder.write(output, render_graph_access::render_target);
+                },
+                [](const render_graph&, graphics_device_context_handle&) {});
+            ASSERT_TRUE(graph.compile());
+        }
+
+        frame_arena arena;
+        job_system jobs;
+        transform_hierarchy hierarchy;
+        bounding_volume_hierarchy bvh;
+        std::vector<axis_aligned_bounding_box> bounds;
+        bounding_frustum camera_frustum;
+        bounding_frustum cascade_frusta[4];
+        std::vector<uint32> visible;
+        std::vector<uint32> cascade_instances;
+        std::vector<uint32> cascade_masks;
+        texture_create_info target_info;
+        render_graph graph;
+    };
+
+    TEST_F(frame_arena_test, no_heap_allocations_in_steady_state)
+    {
+        create_scene(8192);
+
+        // the first frames overflow and make the arena and all reused storage grow.
+        for (uint32 i = 0; i < 8; ++i)
+            simulate_frame(i);
+        ASSERT_GE(arena.get_frame_size(), arena.get_frame_usage());
+        ASSERT_FALSE(visible.empty());
+        ASSERT_FALSE(cascade_instances.empty());
+
+        int64_t before = g_heap_allocations.load();
+        for (uint32 i = 8; i < 24; ++i)
+            simulate_frame(i);
+        ASSERT_EQ(g_heap_allocations.load(), before);
+    }
+
+    TEST_F(frame_arena_test, allocations_are_aligned)
+    {
+        arena.begin_frame();
+        for (int64 alignment = 1; alignment <= 256; alignment *= 2)
+        {
+            void* mem = arena.allocate(3, alignment);
+            ASSERT_NE(mem, nullptr);
+            ASSERT_EQ(reinterpret_cast<uintptr>(mem) % alignment, 0u);
+        }
+    }
+
+    TEST_F(frame_arena_test, memory_stays_valid_for_one_more_frame)
+    {
+        arena.begin_frame();
+        uint32* last = static_cast<uint32*>(arena.allocate(sizeof(uint32) * 64, alignof(uint32)));
+        for (uint32 i = 0; i < 64; ++i)
+            last[i] = i;
+
+        arena.begin_frame();
+        uint32* current = static_cast<uint32*>(arena.allocate(sizeof(uint32) * 64, alignof(uint32)));
+        for (uint32 i = 0; i < 64; ++i)
+            current[i] = 0;
+        for (uint32 i = 0; i < 64; ++i)
+            ASSERT_EQ(last[i], i);
+    }
+} // namespace mango
+
+//! \endcond
@@ -0,0 +1,34 @@
+//! \file      heap_allocation_counter.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <cstdlib>
+#include <heap_allocation_counter.hpp>
+#include <new>
+
+//! \cond NO_DOC
+
+std::atomic<int64_t> g_heap_allocations(0);
+
+void* operator new(std::size_t size)
+{
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* mem = malloc(size ? size : 1);
+    if (!mem)
+        throw std::bad_alloc();
+    return mem;
+}
+
+void operator delete(void* mem) noexcept
+{
+    free(mem);
+}
+
+void operator delete(void* mem, std::size_t) noexcept
+{
+    free(mem);
+}
+
+//! \endcond
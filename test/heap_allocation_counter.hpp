@@ -0,0 +1,21 @@
+//! \file      heap_allocation_counter.hpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+//! \details   The test executable replaces the global operator new, so tests can check code for heap allocations.
+
+#ifndef MANGO_HEAP_ALLOCATION_COUNTER_HPP
+#define MANGO_HEAP_ALLOCATION_COUNTER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+//! \cond NO_DOC
+
+//! \brief The number of calls to the global operator new since the start of the tests.
+extern std::atomic<int64_t> g_heap_allocations;
+
+//! \endcond
+
+#endif // MANGO_HEAP_ALLOCATION_COUNTER_HPP
@@ -5,13 +5,46 @@
 //! \copyright Apache License 2.0
 
 #include "mock_classes.hpp"
+#include <chrono>
 #include <gtest/gtest.h>
+#include <iostream>
 #include <mango/intersect.hpp>
+#include <random>
 
 //! \cond NO_DOC
 
 namespace mango
 {
+    //! \brief The frustum box test as it was done before, testing all 8 corners against every plane.
+    static bool corner_frustum_aabb_reference(const bounding_frustum& f, const axis_aligned_bounding_box& a)
+    {
+        auto corners = a.get_corners();
+        for (int32 i = 0; i < 6; ++i)
+        {
+            bool inside = false;
+            for (int j = 0; j < 8 && !inside; ++j)
+                inside = f.planes[i].dot(vec4(corners[j].x(), corners[j].y(), corners[j].z(), 1.0f)) >= 0.0f;
+            if (!inside)
+                return false;
+        }
+        return true;
+    }
+
+    //! \brief Creates random boxes around the origin, some inside and some outside of the test frustum.
+    static std::vector<axis_aligned_bounding_box> random_boxes(int32 count)
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+        std::uniform_real_distribution<float> size(0.01f, 2.0f);
+        std::vector<axis_aligned_bounding_box> boxes(count);
+        for (auto& b : boxes)
+        {
+            b.center  = vec3(position(rng), position(rng), position(rng));
+            b.extents = vec3(size(rng), size(rng), size(rng));
+        }
+        return boxes;
+    }
+
     TEST(intersect_test, sphere_sphere_intersection_works)
     {
         bounding_sphere s1, s2;
@@ -165,6 +198,94 @@ namespace mango
         ASSERT_FALSE(f.intersects(a));
         ASSERT_FALSE(a.intersects(f));
     }
+
+    TEST(intersect_test, frustum_aabb_containment_works)
+    {
+        bounding_frustum f(mango::lookAt(make_vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f)), mango::perspective(mango::deg_to_rad(45.0f), 16.0f / 9.0f, 0.1f, 10.0f));
+
+        axis_aligned_bounding_box a;
+        a.center  = vec3(0.0f, 0.0f, -5.0f);
+        a.extents = make_vec3(0.5f);
+        ASSERT_EQ(f.contains(a), containment_result::contain);
+
+        a.center  = vec3(0.0f, 0.0f, -10.0f);
+        a.extents = make_vec3(0.5f);
+        ASSERT_EQ(f.contains(a), containment_result::intersect);
+
+        a.center  = vec3(0.0f, 0.0f, 5.0f);
+        a.extents = make_vec3(0.5f);
+        ASSERT_EQ(f.contains(a), containment_result::disjoint);
+
+        // containment has to agree with the intersection test
+        for (auto& b : random_boxes(1000))
+            ASSERT_EQ(f.contains(b) != containment_result::disjoint, f.intersects(b));
+    }
+
+    TEST(intersect_test, frustum_aabb_batch_matches_single_tests)
+    {
+        bounding_frustum f(mango::lookAt(make_vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f)), mango::perspective(mango::deg_to_rad(45.0f), 16.0f / 9.0f, 0.1f, 10.0f));
+
+        // not a multiple of 8, so the remainder is tested as well
+        std::vector<axis_aligned_bounding_box> boxes = random_boxes(1003);
+        bounding_box_batch batch;
+        for (auto& b : boxes)
+            batch.push_back(b);
+
+        std::vector<uint32> visibility;
+        f.intersects(batch, visibility);
+        ASSERT_EQ(visibility.size(), (boxes.size() + 31) / 32);
+
+        int32 visible = 0;
+        for (uint32 i = 0; i < batch.size(); ++i)
+        {
+            ASSERT_EQ(bounding_box_batch::visible(visibility, i), corner_frustum_aabb_reference(f, boxes[i]));
+            ASSERT_EQ(f.intersects(boxes[i]), corner_frustum_aabb_reference(f, boxes[i]));
+            visible += bounding_box_batch::visible(visibility, i) ? 1 : 0;
+        }
+        ASSERT_GT(visible, 0);
+        ASSERT_LT(visible, static_cast<int32>(boxes.size()));
+    }
+
+    TEST(intersect_test, benchmark_frustum_aabb_culling)
+    {
+        bounding_frustum f(mango::lookAt(make_vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f)), mango::perspective(mango::deg_to_rad(45.0f), 16.0f / 9.0f, 0.1f, 10.0f));
+
+        const int32 count                            = 100000;
+        const int32 iterations                       = 10;
+        std::vector<axis_aligned_bounding_box> boxes = random_boxes(count);
+        bounding_box_batch batch;
+        batch.reserve(count);
+        for (auto& b : boxes)
+            batch.push_back(b);
+
+        int32 corner_visible = 0;
+        auto start           = std::chrono::high_resolution_clock::now();
+        for (int32 it = 0; it < iterations; ++it)
+        {
+            for (auto& b : boxes)
+                corner_visible += corner_frustum_aabb_reference(f, b) ? 1 : 0;
+        }
+        auto corners = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+        int32 single_visible = 0;
+        start                = std::chrono::high_resolution_clock::now();
+        for (int32 it = 0; it < iterations; ++it)
+        {
+            for (auto& b : boxes)
+                single_visible += f.intersects(b) ? 1 : 0;
+        }
+        auto single = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+        std::vector<uint32> visibility;
+        start = std::chrono::high_resolution_clock::now();
+        for (int32 it = 0; it < iterations; ++it)
+            f.intersects(batch, visibility);
+        auto batched = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+        std::cout << "[ BENCHMARK] frustum culling (" << count << " boxes): corners " << corners << " ms, center/extent " << single << " ms, batch " << batched << " ms"
+                  << std::endl;
+        ASSERT_EQ(corner_visible, single_visible);
+    }
 } // namespace mango
 
 //! \endcond
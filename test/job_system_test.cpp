@@ -0,0 +1,172 @@
+//! \file      job_system_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <core/job_system.hpp>
+#include <gtest/gtest.h>
+#include <heap_allocation_counter.hpp>
+#include <numeric>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class job_system_test : public ::testing::Test
+    {
+      protected:
+        job_system_test() {}
+
+        ~job_system_test() override {}
+
+        void SetUp() override {}
+
+        void TearDown() override {}
+    };
+
+    TEST_F(job_system_test, parallel_for_visits_every_index_once)
+    {
+        job_system jobs(4);
+        ASSERT_EQ(jobs.get_worker_count(), 4u);
+
+        std::vector<uint32> visited(10007, 0);
+        jobs.parallel_for(static_cast<uint32>(visited.size()), 64, [&visited](uint32 begin, uint32 end) {
+            for (uint32 i = begin; i < end; ++i)
+                visited[i]++;
+        });
+
+        for (uint32 v : visited)
+            ASSERT_EQ(v, 1u);
+    }
+
+    TEST_F(job_system_test, chunks_match_chunk_count)
+    {
+        job_system jobs(3);
+
+        std::atomic<uint32> chunks(0);
+        jobs.parallel_for(1000, 100, [&chunks](uint32 begin, uint32 end) {
+            ASSERT_EQ(begin % 100, 0u);
+            ASSERT_LE(end - begin, 100u);
+            chunks++;
+        });
+
+        ASSERT_EQ(chunks.load(), job_system::chunk_count(1000, 100));
+        ASSERT_EQ(job_system::chunk_count(1001, 100), 11u);
+        ASSERT_EQ(job_system::chunk_count(0, 100), 0u);
+    }
+
+    TEST_F(job_system_test, nested_parallel_for_does_not_deadlock)
+    {
+        job_system jobs(2);
+
+        std::atomic<uint32> sum(0);
+        jobs.parallel_for(8, 1, [&jobs, &sum](uint32, uint32) {
+            jobs.parallel_for(100, 10, [&sum](uint32 begin, uint32 end) { sum += end - begin; });
+        });
+
+        ASSERT_EQ(sum.load(), 800u);
+    }
+
+    TEST_F(job_system_test, queues_grow_past_their_initial_capacity)
+    {
+        job_system jobs(2);
+
+        // one job per index, the queues wrap around and grow while workers take jobs from both ends.
+        for (uint32 round = 0; round < 3; ++round)
+        {
+            std::vector<uint32> visited(5000, 0);
+            jobs.parallel_for(static_cast<uint32>(visited.size()), 1, [&visited](uint32 begin, uint32 end) {
+                for (uint32 i = begin; i < end; ++i)
+                    visited[i]++;
+            });
+
+            for (uint32 v : visited)
+                ASSERT_EQ(v, 1u);
+        }
+    }
+
+    TEST_F(job_system_test, parallel_for_does_not_allocate_once_warm)
+    {
+        job_system jobs(3);
+
+        std::atomic<uint32> sum(0);
+        auto sum_range = [&sum](uint32 begin, uint32 end) { sum += end - begin; };
+        // 128 chunks fit into the initial capacity of the three queues, so none of them has to grow.
+        jobs.parallel_for(4096, 32, sum_range);
+
+        int64_t before = g_heap_allocations.load();
+        for (uint32 i = 0; i < 16; ++i)
+            jobs.parallel_for(4096, 32, sum_range);
+        ASSERT_EQ(g_heap_allocations.load(), before);
+        ASSERT_EQ(sum.load(), 17u * 4096u);
+    }
+
+    TEST_F(job_system_test, runs_inline_without_workers)
+    {
+        job_system jobs(0);
+        std::vector<uint32> values(100);
+        jobs.parallel_for(100, 10, [&values](uint32 begin, uint32 end) {
+            for (uint32 i = begin; i < end; ++i)
+                values[i] = i;
+        });
+
+        ASSERT_EQ(std::accumulate(values.begin(), values.end(), 0u), 4950u);
+    }
+
+    TEST_F(job_system_test, execute_runs_background_jobs_on_workers)
+    {
+        job_system jobs(2);
+
+        std::atomic<uint32> executed(0);
+        std::atomic<bool> on_caller(false);
+        std::thread::id caller = std::this_thread::get_id();
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            jobs.execute([&executed, &on_caller, caller]() {
+                if (std::this_thread::get_id() == caller)
+                    on_caller = true;
+                executed++;
+            });
+        }
+
+        // helping in parallel_for does not pick up background jobs.
+        jobs.parallel_for(100, 10, [](uint32, uint32) {});
+
+        while (executed.load() < 16)
+            std::this_thread::yield();
+
+        ASSERT_FALSE(on_caller.load());
+    }
+
+    TEST_F(job_system_test, destruction_finishes_queued_background_jobs)
+    {
+        std::atomic<uint32> executed(0);
+        std::atomic<bool> release(false);
+        {
+            job_system jobs(1);
+            // the only worker is blocked, so the other jobs are still queued when the job system is destroyed.
+            jobs.execute([&release]() {
+                while (!release.load())
+                    std::this_thread::yield();
+            });
+            for (uint32 i = 0; i < 8; ++i)
+                jobs.execute([&executed]() { executed++; });
+            release = true;
+        }
+
+        ASSERT_EQ(executed.load(), 8u);
+    }
+
+    TEST_F(job_system_test, execute_runs_inline_without_workers)
+    {
+        job_system jobs(0);
+
+        bool executed = false;
+        jobs.execute([&executed]() { executed = true; });
+
+        ASSERT_TRUE(executed);
+    }
+} // namespace mango
+
+//! \endcond
@@ -0,0 +1,157 @@
+//! \file      light_clusters_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <gtest/gtest.h>
+#include <rendering/light_clusters.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class light_clusters_test : public ::testing::Test
+    {
+      protected:
+        light_clusters_test()
+            : view(mat4::Identity())
+            , projection(perspective(deg_to_rad(60.0f), 16.0f / 9.0f, 0.1f, 100.0f))
+        {
+        }
+
+        ~light_clusters_test() override {}
+
+        //! \brief Returns the cluster containing a view space position.
+        int32 cluster_of(const light_clusters& clusters, const vec3& view_position)
+        {
+            vec4 clip = projection * vec4(view_position.x(), view_position.y(), view_position.z(), 1.0f);
+            vec2 uv   = (clip.head<2>() / clip.w()) * 0.5f + vec2(0.5f, 0.5f);
+            int32 x   = static_cast<int32>(uv.x() * light_clusters::grid_x);
+            int32 y   = static_cast<int32>(uv.y() * light_clusters::grid_y);
+            int32 z   = static_cast<int32>(std::floor(std::log(-view_position.z()) * clusters.get_z_scale() + clusters.get_z_bias()));
+            return light_clusters::cluster_index(x, y, z);
+        }
+
+        //! \brief Returns true if the cluster references the light.
+        bool contains(const light_clusters& clusters, int32 cluster, uint32 light)
+        {
+            const light_cluster& c = clusters.get_clusters()[cluster];
+            for (uint32 i = 0; i < c.count; ++i)
+            {
+                if (clusters.get_light_indices()[c.offset + i] == light)
+                    return true;
+            }
+            return false;
+        }
+
+        mat4 view;
+        mat4 projection;
+    };
+
+    TEST_F(light_clusters_test, assigns_lights_only_to_nearby_clusters)
+    {
+        point_light light;
+        light.range = 1.0f;
+
+        light_clusters clusters;
+        clusters.add(light, vec3(0.0f, 0.0f, -10.0f));
+        clusters.build(view, projection, 0.1f, 100.0f);
+
+        ASSERT_TRUE(contains(clusters, cluster_of(clusters, vec3(0.0f, 0.0f, -10.0f)), 0));
+        ASSERT_TRUE(contains(clusters, cluster_of(clusters, vec3(0.0f, 0.9f, -10.0f)), 0));
+        ASSERT_FALSE(contains(clusters, cluster_of(clusters, vec3(0.0f, 0.0f, -20.0f)), 0));
+        ASSERT_FALSE(contains(clusters, cluster_of(clusters, vec3(0.0f, 0.0f, -2.0f)), 0));
+        ASSERT_FALSE(contains(clusters, cluster_of(clusters, vec3(5.0f, 0.0f, -10.0f)), 0));
+
+        ASSERT_GT(clusters.get_light_indices().size(), 0u);
+        ASSERT_LT(clusters.get_light_indices().size(), 64u);
+    }
+
+    TEST_F(light_clusters_test, skips_lights_outside_of_the_frustum)
+    {
+        point_light light;
+        light.range = 2.0f;
+
+        light_clusters clusters;
+        clusters.add(light, vec3(0.0f, 0.0f, 10.0f));
+        clusters.add(light, vec3(0.0f, 0.0f, -200.0f));
+        clusters.add(light, vec3(100.0f, 0.0f, -10.0f));
+        clusters.build(view, projection, 0.1f, 100.0f);
+
+        ASSERT_TRUE(clusters.get_light_indices().empty());
+        for (const light_cluster& c : clusters.get_clusters())
+            ASSERT_EQ(c.count, 0u);
+    }
+
+    TEST_F(light_clusters_test, lights_around_the_camera_cover_all_tiles)
+    {
+        point_light light;
+        light.range = 1.0f;
+
+        light_clusters clusters;
+        clusters.add(light, vec3(0.0f, 0.0f, 0.0f));
+        clusters.build(view, projection, 0.1f, 100.0f);
+
+        for (int32 y = 0; y < light_clusters::grid_y; ++y)
+        {
+            for (int32 x = 0; x < light_clusters::grid_x; ++x)
+                ASSERT_TRUE(contains(clusters, light_clusters::cluster_index(x, y, 0), 0));
+        }
+    }
+
+    TEST_F(light_clusters_test, builds_contiguous_light_lists)
+    {
+        point_light light;
+        light.range = 3.0f;
+
+        light_clusters clusters;
+        for (int32 i = 0; i < 16; ++i)
+            clusters.add(light, vec3(static_cast<float>(i % 4) - 1.5f, static_cast<float>(i / 4) - 1.5f, -8.0f));
+        clusters.build(view, projection, 0.1f, 100.0f);
+
+        // the lists are stored one after another with the lights in the order they were added.
+        uint32 expected_offset = 0;
+        for (const light_cluster& c : clusters.get_clusters())
+        {
+            ASSERT_EQ(c.offset, expected_offset);
+            for (uint32 i = 1; i < c.count; ++i)
+                ASSERT_LT(clusters.get_light_indices()[c.offset + i - 1], clusters.get_light_indices()[c.offset + i]);
+            expected_offset += c.count;
+        }
+        ASSERT_EQ(expected_offset, clusters.get_light_indices().size());
+
+        int32 center = cluster_of(clusters, vec3(0.0f, 0.0f, -8.0f));
+        ASSERT_EQ(clusters.get_clusters()[center].count, 16u);
+
+        // rebuilding after a clear starts from scratch.
+        clusters.clear();
+        clusters.build(view, projection, 0.1f, 100.0f);
+        ASSERT_TRUE(clusters.get_light_indices().empty());
+        ASSERT_TRUE(clusters.get_lights().empty());
+    }
+
+    TEST_F(light_clusters_test, encodes_spot_cones)
+    {
+        spot_light spot;
+        spot.inner_cone_angle = deg_to_rad(20.0f);
+        spot.outer_cone_angle = deg_to_rad(40.0f);
+        point_light point;
+
+        light_clusters clusters;
+        clusters.add(spot, vec3(0.0f, 0.0f, -5.0f), vec3(0.0f, 0.0f, -2.0f));
+        clusters.add(point, vec3(0.0f, 0.0f, -5.0f));
+
+        const punctual_light_data& s = clusters.get_lights()[0];
+        const punctual_light_data& p = clusters.get_lights()[1];
+        ASSERT_FLOAT_EQ(s.direction_spot_scale.z(), -1.0f);
+
+        // full intensity inside the inner cone, none outside of the outer cone.
+        auto cone = [](const punctual_light_data& l, float angle) { return std::cos(angle) * l.direction_spot_scale.w() + l.spot_offset.x(); };
+        ASSERT_NEAR(cone(s, deg_to_rad(20.0f)), 1.0f, 1e-4f);
+        ASSERT_NEAR(cone(s, deg_to_rad(40.0f)), 0.0f, 1e-4f);
+        ASSERT_FLOAT_EQ(cone(p, deg_to_rad(90.0f)), 1.0f);
+    }
+} // namespace mango
+
+//! \endcond
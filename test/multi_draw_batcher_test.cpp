@@ -0,0 +1,160 @@
+//! \file      multi_draw_batcher_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <gtest/gtest.h>
+#include <rendering/multi_draw_batcher.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class fake_pipeline : public gfx_pipeline
+    {
+      public:
+        void* native_handle() const override
+        {
+            return nullptr;
+        }
+        gfx_handle<shader_resource_mapping> get_resource_mapping() const override
+        {
+            return nullptr;
+        }
+
+      protected:
+        void submit_pipeline_resources(gfx_handle<gfx_graphics_state>) const override {}
+    };
+
+    class fake_buffer : public gfx_buffer
+    {
+      public:
+        void* native_handle() const override
+        {
+            return nullptr;
+        }
+    };
+
+    class multi_draw_batcher_test : public ::testing::Test
+    {
+      protected:
+        multi_draw_batcher_test()
+            : pipeline_a(std::make_shared<fake_pipeline>())
+            , pipeline_b(std::make_shared<fake_pipeline>())
+            , vertices(std::make_shared<fake_buffer>())
+            , indices(std::make_shared<fake_buffer>())
+        {
+        }
+
+        ~multi_draw_batcher_test() override {}
+
+        primitive_gpu_data indexed_primitive(int32 base_vertex, int32 first_index, int32 index_count)
+        {
+            primitive_gpu_data result;
+            buffer_view vbv;
+            vbv.offset          = 0;
+            vbv.graphics_buffer = vertices;
+            result.vertex_buffer_views.push_back(vbv);
+            result.index_buffer_view.graphics_buffer = indices;
+            result.index_type                        = gfx_format::t_unsigned_int;
+            result.draw_call_desc.vertex_count       = 0;
+            result.draw_call_desc.index_count        = index_count;
+            result.draw_call_desc.instance_count     = 1;
+            result.draw_call_desc.base_vertex        = base_vertex;
+            result.draw_call_desc.base_instance      = 0;
+            result.draw_call_desc.index_offset       = first_index * static_cast<int32>(sizeof(uint32));
+            return result;
+        }
+
+        gfx_handle<const gfx_pipeline> pipeline_a;
+        gfx_handle<const gfx_pipeline> pipeline_b;
+        gfx_handle<const gfx_buffer> vertices;
+        gfx_handle<const gfx_buffer> indices;
+        model_data model;
+        material material_a;
+        material material_b;
+        material_gpu_data material_gpu;
+    };
+
+    TEST_F(multi_draw_batcher_test, merges_draws_with_shared_state)
+    {
+        primitive_gpu_data first  = indexed_primitive(0, 0, 36);
+        primitive_gpu_data second = indexed_primitive(24, 36, 12);
+        primitive_gpu_data third  = indexed_primitive(32, 48, 6);
+
+        multi_draw_batcher batcher;
+        batcher.add(0, pipeline_a, first, model, material_a, material_gpu, true);
+        batcher.add(0, pipeline_b, second, model, material_a, material_gpu, true);
+        batcher.add(0, pipeline_a, third, model, material_a, material_gpu, true);
+        batcher.build();
+
+        const std::vector<multi_draw_batcher::batch>& batches = batcher.get_batches();
+        ASSERT_EQ(batches.size(), 2u);
+        int32 merged = batches[0].pipeline == pipeline_a ? 0 : 1;
+        ASSERT_EQ(batches[merged].draw_count, 2);
+        ASSERT_EQ(batches[merged].vertex_count, 42);
+        ASSERT_EQ(batches[1 - merged].draw_count, 1);
+
+        // draws keep their order within a batch and reference their own model data entry.
+        const std::vector<draw_indexed_indirect_command>& commands = batcher.get_commands();
+        ASSERT_EQ(commands.size(), 3u);
+        const draw_indexed_indirect_command& c0 = commands[batches[merged].first_command];
+        const draw_indexed_indirect_command& c1 = commands[batches[merged].first_command + 1];
+        ASSERT_EQ(c0.first_index, 0u);
+        ASSERT_EQ(c0.index_count, 36u);
+        ASSERT_EQ(c1.first_index, 48u);
+        ASSERT_EQ(c1.base_vertex, 32);
+        ASSERT_EQ(c0.base_instance, static_cast<uint32>(batches[merged].first_entry));
+        ASSERT_EQ(c1.base_instance, static_cast<uint32>(batches[merged].first_entry + 1));
+    }
+
+    TEST_F(multi_draw_batcher_test, splits_groups_and_materials)
+    {
+        primitive_gpu_data geometry = indexed_primitive(0, 0, 3);
+
+        multi_draw_batcher batcher;
+        batcher.add(1, pipeline_a, geometry, model, material_a, material_gpu, true);
+        batcher.add(0, pipeline_a, geometry, model, material_a, material_gpu, true);
+        batcher.add(0, pipeline_a, geometry, model, material_b, material_gpu, true);
+        batcher.add(1, pipeline_a, geometry, model, material_b, material_gpu, false);
+        batcher.add(1, pipeline_a, geometry, model, material_a, material_gpu, false);
+        batcher.build();
+
+        const std::vector<multi_draw_batcher::batch>& batches = batcher.get_batches();
+        ASSERT_EQ(batches.size(), 4u);
+        ASSERT_EQ(batches[0].group, 0);
+        ASSERT_EQ(batches[1].group, 0);
+        ASSERT_EQ(batches[2].group, 1);
+        ASSERT_EQ(batches[3].group, 1);
+        ASSERT_NE(batches[0].mat, batches[1].mat);
+
+        // draws independent of the material are merged, the first added provides the material.
+        int32 independent = batches[2].draw_count == 2 ? 2 : 3;
+        ASSERT_EQ(batches[independent].draw_count, 2);
+        ASSERT_EQ(batches[independent].mat, &material_b);
+    }
+
+    TEST_F(multi_draw_batcher_test, keeps_draws_without_indices_single)
+    {
+        primitive_gpu_data geometry                = indexed_primitive(0, 0, 0);
+        geometry.index_buffer_view.graphics_buffer = nullptr;
+        geometry.index_type                        = gfx_format::invalid;
+        geometry.draw_call_desc.vertex_count       = 3;
+
+        multi_draw_batcher batcher;
+        batcher.add(0, pipeline_a, geometry, model, material_a, material_gpu, true);
+        batcher.add(0, pipeline_a, geometry, model, material_a, material_gpu, true);
+        batcher.build();
+
+        const std::vector<multi_draw_batcher::batch>& batches = batcher.get_batches();
+        ASSERT_EQ(batches.size(), 2u);
+        ASSERT_EQ(batches[0].first_command, -1);
+        ASSERT_EQ(batches[1].first_command, -1);
+        ASSERT_EQ(batches[0].first_entry, 0);
+        ASSERT_EQ(batches[1].first_entry, 1);
+        ASSERT_TRUE(batcher.get_commands().empty());
+    }
+} // namespace mango
+
+//! \endcond
@@ -0,0 +1,122 @@
+//! \file      occlusion_culler_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <gtest/gtest.h>
+#include <rendering/occlusion_culler.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class occlusion_culler_test : public ::testing::Test
+    {
+      protected:
+        occlusion_culler_test()
+            : width(30)
+            , height(17)
+            , depth(width * height, 1.0f)
+        {
+            view_projection = perspective(deg_to_rad(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+        }
+
+        ~occlusion_culler_test() override {}
+
+        //! \brief Returns the window space depth of a view space distance.
+        float depth_at(float distance)
+        {
+            vec4 clip = view_projection * vec4(0.0f, 0.0f, -distance, 1.0f);
+            return clip.z() / clip.w() * 0.5f + 0.5f;
+        }
+
+        //! \brief Fills a rectangle of texels with a depth.
+        void fill(int32 x_begin, int32 y_begin, int32 x_end, int32 y_end, float value)
+        {
+            for (int32 y = y_begin; y < y_end; ++y)
+            {
+                for (int32 x = x_begin; x < x_end; ++x)
+                    depth[y * width + x] = value;
+            }
+        }
+
+        hi_z_readback readback()
+        {
+            hi_z_readback result;
+            result.depth           = depth.data();
+            result.width           = width;
+            result.height          = height;
+            result.texel_size      = 16;
+            result.viewport_width  = 480;
+            result.viewport_height = 270;
+            result.view_projection = view_projection;
+            return result;
+        }
+
+        int32 width;
+        int32 height;
+        std::vector<float> depth;
+        mat4 view_projection;
+    };
+
+    TEST_F(occlusion_culler_test, nothing_is_occluded_without_depth)
+    {
+        occlusion_culler culler;
+        ASSERT_FALSE(culler.has_depth());
+        ASSERT_FALSE(culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -50.0f), make_vec3(1.0f))));
+    }
+
+    TEST_F(occlusion_culler_test, culls_boxes_behind_an_occluder)
+    {
+        // a wall at distance 5 covering the whole screen.
+        fill(0, 0, width, height, depth_at(5.0f));
+
+        occlusion_culler culler;
+        culler.set_depth(readback());
+        ASSERT_TRUE(culler.has_depth());
+
+        ASSERT_TRUE(culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -20.0f), make_vec3(1.0f))));
+        ASSERT_TRUE(culler.is_occluded(axis_aligned_bounding_box(vec3(10.0f, 5.0f, -40.0f), make_vec3(3.0f))));
+        ASSERT_FALSE(culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -3.0f), make_vec3(1.0f))));
+        // intersecting the wall.
+        ASSERT_FALSE(culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -5.5f), make_vec3(1.0f))));
+
+        culler.reset();
+        ASSERT_FALSE(culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -20.0f), make_vec3(1.0f))));
+    }
+
+    TEST_F(occlusion_culler_test, keeps_boxes_visible_through_holes)
+    {
+        fill(0, 0, width, height, depth_at(5.0f));
+        // a hole in the center of the wall, the last column of texels is open as well.
+        fill(14, 7, 16, 9, 1.0f);
+        fill(width - 1, 0, width, height, 1.0f);
+
+        occlusion_culler culler;
+        culler.set_depth(readback());
+
+        ASSERT_FALSE(culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -20.0f), make_vec3(0.5f))));
+        ASSERT_FALSE(culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, -20.0f), make_vec3(8.0f))));
+        ASSERT_TRUE(culler.is_occluded(axis_aligned_bounding_box(vec3(-8.0f, -4.0f, -20.0f), make_vec3(0.5f))));
+
+        // large boxes are tested on coarse levels, the open column is folded into the last texel of each of them.
+        ASSERT_FALSE(culler.is_occluded(axis_aligned_bounding_box(vec3(22.94f, 0.0f, -30.0f), vec3(7.39f, 0.1f, 0.1f))));
+    }
+
+    TEST_F(occlusion_culler_test, keeps_boxes_outside_of_the_old_view)
+    {
+        fill(0, 0, width, height, depth_at(5.0f));
+
+        occlusion_culler culler;
+        culler.set_depth(readback());
+
+        // partially outside of the screen.
+        ASSERT_FALSE(culler.is_occluded(axis_aligned_bounding_box(vec3(30.0f, 0.0f, -40.0f), make_vec3(10.0f))));
+        // behind the camera and crossing the near plane.
+        ASSERT_FALSE(culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, 10.0f), make_vec3(1.0f))));
+        ASSERT_FALSE(culler.is_occluded(axis_aligned_bounding_box(vec3(0.0f, 0.0f, 0.0f), make_vec3(1.0f))));
+    }
+} // namespace mango
+
+//! \endcond
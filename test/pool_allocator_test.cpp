@@ -0,0 +1,187 @@
+//! \file      pool_allocator_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory/pool_allocator.hpp>
+#include <random>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class pool_allocator_test : public ::testing::Test
+    {
+      protected:
+        pool_allocator_test()
+            : pool_alloc(1048576) // 1 MiB
+        {
+        }
+
+        ~pool_allocator_test() override {}
+
+        void SetUp() override
+        {
+            pool_alloc.init();
+        }
+
+        void TearDown() override
+        {
+            pool_alloc.reset();
+        }
+
+        //! \brief Random allocation sizes, mostly small with some large ones like the resource cache sees them.
+        std::vector<int64> random_sizes(int32 count)
+        {
+            std::mt19937 rng(42);
+            std::uniform_int_distribution<int32> small(1, 512);
+            std::uniform_int_distribution<int32> large(4096, 262144);
+            std::vector<int64> sizes(count);
+            for (int32 i = 0; i < count; ++i)
+                sizes[i] = (i % 16 == 0) ? large(rng) : small(rng);
+            return sizes;
+        }
+
+        pool_allocator pool_alloc;
+    };
+
+    TEST_F(pool_allocator_test, reserves_memory_on_demand)
+    {
+        ASSERT_EQ(pool_alloc.get_statistics().reserved_bytes, 0);
+
+        void* mem = pool_alloc.allocate(64);
+        ASSERT_NE(mem, nullptr);
+        pool_allocator_statistics stats = pool_alloc.get_statistics();
+        ASSERT_EQ(stats.reserved_bytes, 1048576);
+        ASSERT_EQ(stats.allocation_count, 1);
+        ASSERT_EQ(stats.allocated_bytes, 64);
+        ASSERT_EQ(stats.slab_count, 1);
+
+        pool_alloc.free_memory(mem);
+        stats = pool_alloc.get_statistics();
+        ASSERT_EQ(stats.allocation_count, 0);
+        ASSERT_EQ(stats.allocated_bytes, 0);
+    }
+
+    TEST_F(pool_allocator_test, blocks_are_aligned_and_do_not_overlap)
+    {
+        std::vector<int64> sizes = random_sizes(512);
+        std::vector<uint8*> blocks(sizes.size());
+        for (size_t i = 0; i < sizes.size(); ++i)
+        {
+            blocks[i] = static_cast<uint8*>(pool_alloc.allocate(sizes[i]));
+            ASSERT_NE(blocks[i], nullptr);
+            ASSERT_EQ(reinterpret_cast<uintptr>(blocks[i]) % 16, 0u);
+            std::fill(blocks[i], blocks[i] + sizes[i], static_cast<uint8>(i));
+        }
+        for (size_t i = 0; i < sizes.size(); ++i)
+        {
+            for (int64 b = 0; b < sizes[i]; ++b)
+                ASSERT_EQ(blocks[i][b], static_cast<uint8>(i));
+        }
+
+        // free every second block and refill the gaps.
+        for (size_t i = 0; i < sizes.size(); i += 2)
+            pool_alloc.free_memory(blocks[i]);
+        for (size_t i = 0; i < sizes.size(); i += 2)
+        {
+            blocks[i] = static_cast<uint8*>(pool_alloc.allocate(sizes[i]));
+            ASSERT_NE(blocks[i], nullptr);
+            std::fill(blocks[i], blocks[i] + sizes[i], static_cast<uint8>(i));
+        }
+        for (size_t i = 1; i < sizes.size(); i += 2)
+        {
+            for (int64 b = 0; b < sizes[i]; ++b)
+                ASSERT_EQ(blocks[i][b], static_cast<uint8>(i));
+        }
+
+        for (uint8* block : blocks)
+            pool_alloc.free_memory(block);
+        pool_allocator_statistics stats = pool_alloc.get_statistics();
+        ASSERT_EQ(stats.allocation_count, 0);
+        ASSERT_EQ(stats.allocated_bytes, 0);
+    }
+
+    TEST_F(pool_allocator_test, gives_free_regions_back)
+    {
+        // larger than a region, gets a region of its own.
+        void* small = pool_alloc.allocate(32);
+        void* large = pool_alloc.allocate(4 * 1048576);
+        ASSERT_NE(large, nullptr);
+        pool_allocator_statistics stats = pool_alloc.get_statistics();
+        ASSERT_EQ(stats.region_count, 2);
+        ASSERT_LE(static_cast<int64>(4 * 1048576 + 1048576), stats.reserved_bytes);
+
+        pool_alloc.free_memory(large);
+        stats = pool_alloc.get_statistics();
+        ASSERT_EQ(stats.region_count, 1);
+        ASSERT_EQ(stats.reserved_bytes, 1048576);
+
+        // the last region is kept and everything merges back into one block.
+        pool_alloc.free_memory(small);
+        stats = pool_alloc.get_statistics();
+        ASSERT_EQ(stats.region_count, 1);
+        ASSERT_EQ(stats.fragmentation, 0.0f);
+    }
+
+    TEST_F(pool_allocator_test, benchmark_against_malloc)
+    {
+        const int32 count        = 20000;
+        const int32 iterations   = 5;
+        std::vector<int64> sizes = random_sizes(count);
+        std::vector<void*> blocks(count);
+
+        // allocate everything, free in random order and allocate again, as resources are loaded and released.
+        std::vector<int32> order(count);
+        for (int32 i = 0; i < count; ++i)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+        double pool_time = 0.0, malloc_time = 0.0;
+        for (int32 it = 0; it < iterations; ++it)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int32 i = 0; i < count; ++i)
+                blocks[i] = pool_alloc.allocate(sizes[i]);
+            for (int32 i = 0; i < count / 2; ++i)
+                pool_alloc.free_memory(blocks[order[i]]);
+            for (int32 i = 0; i < count / 2; ++i)
+                blocks[order[i]] = pool_alloc.allocate(sizes[order[i]]);
+            for (int32 i = 0; i < count; ++i)
+                pool_alloc.free_memory(blocks[order[i]]);
+            pool_time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+            start = std::chrono::high_resolution_clock::now();
+            for (int32 i = 0; i < count; ++i)
+                blocks[i] = malloc(sizes[i]);
+            for (int32 i = 0; i < count / 2; ++i)
+                free(blocks[order[i]]);
+            for (int32 i = 0; i < count / 2; ++i)
+                blocks[order[i]] = malloc(sizes[order[i]]);
+            for (int32 i = 0; i < count; ++i)
+                free(blocks[order[i]]);
+            malloc_time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+        }
+
+        // fragmentation with half of the blocks freed.
+        for (int32 i = 0; i < count; ++i)
+            blocks[i] = pool_alloc.allocate(sizes[i]);
+        for (int32 i = 0; i < count / 2; ++i)
+            pool_alloc.free_memory(blocks[order[i]]);
+        pool_allocator_statistics stats = pool_alloc.get_statistics();
+
+        std::cout << "[ BENCHMARK] allocator (" << count << " blocks): malloc " << malloc_time << " ms, pool_allocator " << pool_time << " ms" << std::endl;
+        std::cout << "[ BENCHMARK] pool_allocator half freed: reserved " << stats.reserved_bytes << " bytes, allocated " << stats.allocated_bytes << " bytes, free " << stats.free_bytes
+                  << " bytes, largest free block " << stats.largest_free_block << " bytes, fragmentation " << stats.fragmentation << std::endl;
+
+        for (int32 i = count / 2; i < count; ++i)
+            pool_alloc.free_memory(blocks[order[i]]);
+        ASSERT_EQ(pool_alloc.get_statistics().allocation_count, 0);
+    }
+} // namespace mango
+
+//! \endcond
@@ -0,0 +1,111 @@
+//! \file      radix_sort_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <chrono>
+#include <core/job_system.hpp>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <util/radix_sort.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class radix_sort_test : public ::testing::Test
+    {
+      protected:
+        radix_sort_test() {}
+
+        ~radix_sort_test() override {}
+
+        void SetUp() override {}
+
+        void TearDown() override {}
+
+        std::vector<sort_pair> random_pairs(uint32 count, uint64 mask)
+        {
+            std::mt19937_64 rng(42);
+            std::vector<sort_pair> pairs(count);
+            for (uint32 i = 0; i < count; ++i)
+                pairs[i] = { rng() & mask, i };
+            return pairs;
+        }
+
+        void expect_stable_sorted(const std::vector<sort_pair>& pairs, std::vector<sort_pair> unsorted)
+        {
+            std::stable_sort(unsorted.begin(), unsorted.end(), [](const sort_pair& a, const sort_pair& b) { return a.sort_key < b.sort_key; });
+            ASSERT_EQ(pairs.size(), unsorted.size());
+            for (size_t i = 0; i < pairs.size(); ++i)
+                ASSERT_EQ(pairs[i].index, unsorted[i].index);
+        }
+    };
+
+    TEST_F(radix_sort_test, sorts_small_inputs)
+    {
+        std::vector<sort_pair> empty;
+        radix_sort(empty);
+        ASSERT_TRUE(empty.empty());
+
+        std::vector<sort_pair> pairs = { { 5, 0 }, { 1, 1 }, { 0xffffffffffffffffull, 2 }, { 1, 3 }, { 0, 4 } };
+        radix_sort(pairs);
+        ASSERT_EQ(pairs[0].index, 4u);
+        ASSERT_EQ(pairs[1].index, 1u);
+        ASSERT_EQ(pairs[2].index, 3u);
+        ASSERT_EQ(pairs[3].index, 0u);
+        ASSERT_EQ(pairs[4].index, 2u);
+    }
+
+    TEST_F(radix_sort_test, is_stable_with_equal_digits)
+    {
+        // most digits are equal, so most passes are skipped
+        std::vector<sort_pair> pairs    = random_pairs(50000, 0x00ff000000000f00ull);
+        std::vector<sort_pair> unsorted = pairs;
+        radix_sort(pairs);
+        expect_stable_sorted(pairs, unsorted);
+    }
+
+    TEST_F(radix_sort_test, parallel_sort_matches_serial_sort)
+    {
+        job_system jobs(4);
+        std::vector<sort_pair> serial   = random_pairs(100000, 0xffffffffffffffffull);
+        std::vector<sort_pair> unsorted = serial;
+        std::vector<sort_pair> parallel = serial;
+
+        radix_sort(serial);
+        radix_sort(parallel, &jobs);
+
+        expect_stable_sorted(serial, unsorted);
+        expect_stable_sorted(parallel, unsorted);
+    }
+
+    TEST_F(radix_sort_test, benchmark_draw_keys)
+    {
+        job_system jobs;
+        const uint32 count          = 100000;
+        const int32 iterations      = 10;
+        std::vector<sort_pair> keys = random_pairs(count, 0xffffffffffffffffull);
+
+        double comparison = 0.0;
+        double radix      = 0.0;
+        for (int32 it = 0; it < iterations; ++it)
+        {
+            std::vector<sort_pair> pairs = keys;
+            auto start                   = std::chrono::high_resolution_clock::now();
+            std::sort(pairs.begin(), pairs.end(), [](const sort_pair& a, const sort_pair& b) { return a.sort_key < b.sort_key; });
+            comparison += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+            pairs = keys;
+            start = std::chrono::high_resolution_clock::now();
+            radix_sort(pairs, &jobs);
+            radix += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+        }
+
+        std::cout << "[ BENCHMARK] sort (" << count << " keys): std::sort " << comparison << " ms, radix_sort " << radix << " ms" << std::endl;
+    }
+} // namespace mango
+
+//! \endcond
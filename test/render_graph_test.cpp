@@ -0,0 +1,288 @@
+//! \file      render_graph_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <gtest/gtest.h>
+#include <heap_allocation_counter.hpp>
+#include <rendering/render_graph.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class render_graph_test : public ::testing::Test
+    {
+      protected:
+        render_graph_test()
+        {
+            info.texture_type   = gfx_texture_type::texture_type_2d;
+            info.texture_format = gfx_format::rgba8;
+            info.width          = 64;
+            info.height         = 32;
+            info.miplevels      = 1;
+            info.array_layers   = 1;
+        }
+
+        ~render_graph_test() override {}
+
+        //! \brief Adds a pass with an empty execute function.
+        template <typename Setup>
+        void add_pass(const Setup& setup)
+        {
+            graph.add_pass("pass", setup, [](const render_graph&, graphics_device_context_handle&) {});
+        }
+
+        texture_create_info info;
+        render_graph graph;
+    };
+
+    TEST_F(render_graph_test, culls_passes_nothing_depends_on)
+    {
+        render_graph_resource color  = graph.create_texture("color", info);
+        render_graph_resource unused = graph.create_texture("unused", info);
+        render_graph_resource output = graph.import_texture("output", nullptr);
+
+        add_pass([&](render_graph_builder& builder) { builder.clear_color(color, vec4::Zero()); });
+        add_pass([&](render_graph_builder& builder) { builder.clear_color(unused, vec4::Zero()); });
+        add_pass([&](render_graph_builder& builder) {
+            builder.read(color, render_graph_access::sampled);
+            builder.write(output, render_graph_access::render_target);
+        });
+        add_pass([&](render_graph_builder& builder) { builder.side_effects(); });
+        add_pass([&](render_graph_builder& builder) { builder.read(unused, render_graph_access::sampled); });
+
+        ASSERT_TRUE(graph.compile());
+        ASSERT_FALSE(graph.is_culled(0));
+        ASSERT_TRUE(graph.is_culled(1));
+        ASSERT_FALSE(graph.is_culled(2));
+        ASSERT_FALSE(graph.is_culled(3));
+        ASSERT_TRUE(graph.is_culled(4));
+
+        // culled passes do not keep their resources alive.
+        ASSERT_EQ(graph.get_physical_index(unused), -1);
+        ASSERT_EQ(graph.get_physical_index(output), -1);
+        ASSERT_EQ(graph.get_physical_texture_count(), 1);
+    }
+
+    TEST_F(render_graph_test, aliases_textures_with_disjoint_lifetimes)
+    {
+        texture_create_info hdr_info = info;
+        hdr_info.texture_format      = gfx_format::rgba32f;
+
+        render_graph_resource gbuffer = graph.create_texture("gbuffer", info);
+        render_graph_resource normals = graph.create_texture("normals", info);
+        render_graph_resource hdr     = graph.create_texture("hdr", hdr_info);
+        render_graph_resource ldr     = graph.create_texture("ldr", info);
+        render_graph_resource output  = graph.import_texture("output", nullptr);
+
+        add_pass([&](render_graph_builder& builder) {
+            builder.clear_color(gbuffer, vec4::Zero());
+            builder.clear_color(normals, vec4::Zero());
+        });
+        add_pass([&](render_graph_builder& builder) {
+            builder.read(gbuffer, render_graph_access::sampled);
+            builder.read(normals, render_graph_access::sampled);
+            builder.clear_color(hdr, vec4::Zero());
+        });
+        add_pass([&](render_graph_builder& builder) {
+            builder.read(hdr, render_graph_access::sampled);
+            builder.write(ldr, render_graph_access::render_target);
+        });
+        add_pass([&](render_graph_builder& builder) {
+            builder.read(ldr, render_graph_access::sampled);
+            builder.write(output, render_graph_access::render_target);
+        });
+
+        ASSERT_TRUE(graph.compile());
+        ASSERT_EQ(graph.get_physical_texture_count(), 3);
+        // overlapping lifetimes never share.
+        ASSERT_NE(graph.get_physical_index(gbuffer), graph.get_physical_index(normals));
+        // different descriptions never share.
+        ASSERT_NE(graph.get_physical_index(hdr), graph.get_physical_index(gbuffer));
+        ASSERT_NE(graph.get_physical_index(hdr), graph.get_physical_index(normals));
+        // the first matching texture free again is reused.
+        ASSERT_EQ(graph.get_physical_index(ldr), graph.get_physical_index(gbuffer));
+    }
+
+    TEST_F(render_graph_test, keeps_only_the_first_clear_of_a_target)
+    {
+        texture_create_info depth_info = info;
+        depth_info.texture_format      = gfx_format::depth_component32f;
+
+        render_graph_resource color  = graph.create_texture("color", info);
+        render_graph_resource depth  = graph.create_texture("depth", depth_info);
+        render_graph_resource output = graph.import_texture("output", nullptr);
+
+        add_pass([&](render_graph_builder& builder) {
+            builder.clear_color(color, vec4(1.0f, 0.0f, 0.0f, 1.0f));
+            builder.clear_depth(depth, 0.0f);
+        });
+        // the targets are already written, so the clears are dropped.
+        add_pass([&](render_graph_builder& builder) {
+            builder.read(depth, render_graph_access::render_target);
+            builder.clear_color(color, vec4::Zero());
+            builder.clear_depth(depth, 1.0f);
+        });
+        add_pass([&](render_graph_builder& builder) {
+            builder.read(color, render_graph_access::sampled);
+            builder.write(output, render_graph_access::render_target);
+        });
+
+        ASSERT_TRUE(graph.compile());
+
+        const std::vector<render_graph::clear>& first = graph.get_clears(0);
+        ASSERT_EQ(first.size(), 2u);
+        ASSERT_EQ(first[0].resource, color);
+        ASSERT_FALSE(first[0].depth);
+        ASSERT_FLOAT_EQ(first[0].color.x(), 1.0f);
+        ASSERT_EQ(first[1].resource, depth);
+        ASSERT_TRUE(first[1].depth);
+        ASSERT_FLOAT_EQ(first[1].depth_value, 0.0f);
+
+        ASSERT_TRUE(graph.get_clears(1).empty());
+        ASSERT_TRUE(graph.get_clears(2).empty());
+    }
+
+    TEST_F(render_graph_test, derives_barriers_from_incoherent_writes)
+    {
+        render_graph_resource image     = graph.create_texture("image", info);
+        render_graph_resource target    = graph.create_texture("target", info);
+        render_graph_resource arguments = graph.import_buffer("arguments", nullptr);
+        render_graph_resource readback  = graph.import_buffer("readback", nullptr, render_graph_access::host);
+
+        add_pass([&](render_graph_builder& builder) {
+            builder.write(image, render_graph_access::storage_image);
+            builder.write(arguments, render_graph_access::storage_buffer);
+            builder.clear_color(target, vec4::Zero());
+        });
+        add_pass([&](render_graph_builder& builder) {
+            builder.read(image, render_graph_access::sampled);
+            builder.read(target, render_graph_access::sampled);
+            builder.read(arguments, render_graph_access::indirect);
+            builder.write(readback, render_graph_access::storage_buffer);
+        });
+        add_pass([&](render_graph_builder& builder) {
+            builder.read(image, render_graph_access::sampled);
+            builder.read(image, render_graph_access::storage_image);
+            builder.read(readback, render_graph_access::storage_buffer);
+            builder.side_effects();
+        });
+
+        ASSERT_TRUE(graph.compile());
+        ASSERT_EQ(graph.get_barrier(0), gfx_barrier_bit::unknown_barrier_bit);
+        // render target writes need no barrier.
+        ASSERT_EQ(graph.get_barrier(1), gfx_barrier_bit::texture_fetch_barrier_bit | gfx_barrier_bit::command_barrier_bit);
+        // barriers already issued are not repeated.
+        ASSERT_EQ(graph.get_barrier(2), gfx_barrier_bit::shader_image_access_barrier_bit | gfx_barrier_bit::shader_storage_barrier_bit);
+        ASSERT_EQ(graph.get_final_barrier(), gfx_barrier_bit::buffer_update_barrier_bit);
+    }
+
+    TEST_F(render_graph_test, fails_to_compile_reads_of_unwritten_textures)
+    {
+        render_graph_resource color  = graph.create_texture("color", info);
+        render_graph_resource output = graph.import_texture("output", nullptr);
+
+        add_pass([&](render_graph_builder& builder) {
+            builder.read(color, render_graph_access::sampled);
+            builder.write(output, render_graph_access::render_target);
+        });
+
+        ASSERT_FALSE(graph.compile());
+
+        graph.reset();
+        color  = graph.create_texture("color", info);
+        output = graph.import_texture("output", nullptr);
+        add_pass([&](render_graph_builder& builder) { builder.clear_color(color, vec4::Zero()); });
+        add_pass([&](render_graph_builder& builder) {
+            builder.read(color, render_graph_access::sampled);
+            builder.write(output, render_graph_access::render_target);
+        });
+
+        ASSERT_TRUE(graph.compile());
+    }
+
+    TEST_F(render_graph_test, redeclaring_the_same_graph_does_not_allocate)
+    {
+        texture_create_info hdr_info = info;
+        hdr_info.texture_format      = gfx_format::rgba32f;
+
+        auto declare = [&]() {
+            graph.reset();
+            render_graph_resource gbuffer = graph.create_texture("gbuffer", info);
+            render_graph_resource hdr     = graph.create_texture("hdr", hdr_info);
+            render_graph_resource ldr     = graph.create_texture("ldr", info);
+            render_graph_resource output  = graph.import_texture("output", nullptr);
+            render_graph_resource data    = graph.import_buffer("data", nullptr, render_graph_access::host);
+
+            add_pass([&](render_graph_builder& builder) { builder.clear_color(gbuffer, vec4::Zero()); });
+            add_pass([&](render_graph_builder& builder) {
+                builder.read(gbuffer, render_graph_access::sampled);
+                builder.clear_color(hdr, vec4::Zero());
+            });
+            add_pass([&](render_graph_builder& builder) {
+                builder.read(hdr, render_graph_access::storage_image);
+                builder.write(data, render_graph_access::storage_buffer);
+            });
+            add_pass([&](render_graph_builder& builder) {
+                builder.read(hdr, render_graph_access::sampled);
+                builder.write(ldr, render_graph_access::render_target);
+            });
+            add_pass([&](render_graph_builder& builder) {
+                builder.read(ldr, render_graph_access::sampled);
+                builder.write(output, render_graph_access::render_target);
+            });
+            return graph.compile();
+        };
+
+        // the first declarations grow the storage.
+        for (int32 i = 0; i < 3; ++i)
+            ASSERT_TRUE(declare());
+
+        int64_t before = g_heap_allocations.load();
+        for (int32 i = 0; i < 16; ++i)
+            ASSERT_TRUE(declare());
+        ASSERT_EQ(g_heap_allocations.load(), before);
+        ASSERT_EQ(graph.get_physical_texture_count(), 2);
+    }
+
+    TEST_F(render_graph_test, executes_and_destroys_stored_functions)
+    {
+        // only imported resources, so realizing and executing need no device.
+        shared_ptr<int32> executed = std::make_shared<int32>(0);
+        for (int32 frame = 0; frame < 2; ++frame)
+        {
+            graph.reset();
+            render_graph_resource output = graph.import_texture("output", nullptr);
+            render_graph_resource data   = graph.import_buffer("data", nullptr);
+
+            graph.add_pass(
+                "draw", [&](render_graph_builder& builder) { builder.write(output, render_graph_access::render_target); },
+                [executed](const render_graph&, graphics_device_context_handle&) { *executed += 1; });
+            graph.add_pass(
+                "copy",
+                [&](render_graph_builder& builder) {
+                    builder.read(output, render_graph_access::sampled);
+                    builder.write(data, render_graph_access::transfer);
+                },
+                [executed](const render_graph&, graphics_device_context_handle&) { *executed += 10; });
+            ASSERT_EQ(graph.get_pass_count(), 2);
+
+            // each stored function keeps its own copy of the captures until the next reset.
+            ASSERT_EQ(executed.use_count(), 3);
+
+            graphics_device_context_handle device_context;
+            ASSERT_TRUE(graph.compile());
+            ASSERT_TRUE(graph.realize(graphics_device_handle()));
+            graph.execute(device_context);
+            ASSERT_EQ(*executed, 11 * (frame + 1));
+        }
+
+        graph.reset();
+        ASSERT_EQ(graph.get_pass_count(), 0);
+        ASSERT_EQ(executed.use_count(), 1);
+    }
+} // namespace mango
+
+//! \endcond
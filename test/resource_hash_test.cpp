@@ -0,0 +1,51 @@
+//! \file      resource_hash_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <gtest/gtest.h>
+#include <resources/resources_impl.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    TEST(resource_hash_test, equally_named_files_do_not_collide)
+    {
+        image_resource_description a;
+        a.path                    = "res/textures/a/albedo.png";
+        a.is_standard_color_space = true;
+        a.is_hdr                  = false;
+        image_resource_description b = a;
+        b.path                       = "res/textures/b/albedo.png";
+        ASSERT_NE(resource_hash::get_id(a), resource_hash::get_id(b));
+
+        image_resource_description a_linear = a;
+        a_linear.is_standard_color_space    = false;
+        ASSERT_NE(resource_hash::get_id(a), resource_hash::get_id(a_linear));
+
+        image_resource_description a_windows = a;
+        a_windows.path                       = "res\\textures\\a\\albedo.png";
+        ASSERT_EQ(resource_hash::get_id(a), resource_hash::get_id(a_windows));
+    }
+
+    TEST(resource_hash_test, shader_defines_are_hashed_in_order)
+    {
+        shader_resource_resource_description a;
+        a.path    = "res/shader/forward.glsl";
+        a.defines = { { "A", "1" }, { "B", "2" } };
+        shader_resource_resource_description b = a;
+        b.defines                              = { { "B", "2" }, { "A", "1" } };
+        shader_resource_resource_description c = a;
+        c.defines                              = { { "A", "12" } };
+        shader_resource_resource_description d = a;
+        d.defines                              = { { "A1", "2" } };
+
+        ASSERT_NE(resource_hash::get_id(a), resource_hash::get_id(b));
+        ASSERT_NE(resource_hash::get_id(c), resource_hash::get_id(d));
+        ASSERT_EQ(resource_hash::get_id(a), resource_hash::get_id(shader_resource_resource_description(a)));
+    }
+} // namespace mango
+
+//! \endcond
@@ -0,0 +1,65 @@
+//! \file      scene_texture_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <gtest/gtest.h>
+#include <scene/scene_impl.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class scene_texture_test : public ::testing::Test
+    {
+      protected:
+        //! \brief A texture without a graphics device.
+        class fake_texture : public gfx_texture
+        {
+          public:
+            void* native_handle() const override
+            {
+                return nullptr;
+            }
+            const vec2 get_size() const override
+            {
+                return vec2(1.0f, 1.0f);
+            }
+            const gfx_texture_type& get_type() const override
+            {
+                return type;
+            }
+
+            gfx_texture_type type = gfx_texture_type::texture_type_2d;
+        };
+
+        //! \brief A sampler without a graphics device.
+        class fake_sampler : public gfx_sampler
+        {
+          public:
+            void* native_handle() const override
+            {
+                return nullptr;
+            }
+        };
+    };
+
+    TEST_F(scene_texture_test, completed_pending_texture_changes_static_revision)
+    {
+        // a pending texture starts with the placeholder.
+        texture_gpu_data data;
+        data.graphics_texture = std::make_shared<fake_texture>();
+        data.graphics_sampler = std::make_shared<fake_sampler>();
+        uint32 revision       = 7;
+
+        std::pair<gfx_handle<const gfx_texture>, gfx_handle<const gfx_sampler>> loaded(std::make_shared<fake_texture>(), std::make_shared<fake_sampler>());
+        scene_impl::replace_texture_gpu_data(data, loaded, revision);
+
+        ASSERT_EQ(data.graphics_texture, loaded.first);
+        ASSERT_EQ(data.graphics_sampler, loaded.second);
+        ASSERT_NE(revision, 7u);
+    }
+} // namespace mango
+
+//! \endcond
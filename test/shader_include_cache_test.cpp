@@ -0,0 +1,88 @@
+//! \file      shader_include_cache_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <resources/resources_impl.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    class shader_include_cache_test : public ::testing::Test
+    {
+      protected:
+        shader_include_cache_test() {}
+
+        ~shader_include_cache_test() override {}
+
+        void SetUp() override
+        {
+            write_file(include_path, "float shared_value() { return 1.0; }\n");
+            write_file(shader_path, "#include <shader_include_cache_test_common.glsl>\r\nvoid main() { }\r\n");
+        }
+
+        void TearDown() override
+        {
+            std::remove(include_path);
+            std::remove(shader_path);
+        }
+
+        void write_file(const string& path, const string& content)
+        {
+            std::ofstream output_stream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+            output_stream << content;
+        }
+
+        shader_resource_resource_description variant(const char* value)
+        {
+            shader_resource_resource_description description;
+            description.path    = shader_path;
+            description.defines = { { "VARIANT", value } };
+            return description;
+        }
+
+        const char* include_path = "shader_include_cache_test_common.glsl";
+        const char* shader_path  = "shader_include_cache_test_main.glsl";
+    };
+
+    TEST_F(shader_include_cache_test, expands_includes_of_all_variants)
+    {
+        resources_impl resources;
+
+        const shader_resource* a = resources.acquire(variant("1"));
+        const shader_resource* b = resources.acquire(variant("2"));
+        ASSERT_NE(a, nullptr);
+        ASSERT_NE(b, nullptr);
+        ASSERT_NE(a->source.find("#define VARIANT 1"), string::npos);
+        ASSERT_NE(b->source.find("#define VARIANT 2"), string::npos);
+        ASSERT_NE(a->source.find("float shared_value() { return 1.0; }\n"), string::npos);
+        ASSERT_NE(b->source.find("float shared_value() { return 1.0; }\n"), string::npos);
+        ASSERT_NE(a->source.find("void main() { }\n"), string::npos);
+        ASSERT_EQ(a->source.find('\r'), string::npos);
+
+        resources.release(a);
+        resources.release(b);
+    }
+
+    TEST_F(shader_include_cache_test, rereads_changed_includes)
+    {
+        resources_impl resources;
+
+        const shader_resource* before = resources.acquire(variant("1"));
+        ASSERT_NE(before->source.find("return 1.0;"), string::npos);
+        resources.release(before);
+
+        // a different size marks the file as changed, even within the resolution of the modification time.
+        write_file(include_path, "float shared_value() { return 42.0; }\n");
+        const shader_resource* after = resources.acquire(variant("1"));
+        ASSERT_NE(after->source.find("return 42.0;"), string::npos);
+        resources.release(after);
+    }
+} // namespace mango
+
+//! \endcond
@@ -0,0 +1,297 @@
+//! \file      transform_hierarchy_test.cpp
+//! \author    Paul Himmler
+//! \version   1.0
+//! \date      2022
+//! \copyright Apache License 2.0
+
+#include <chrono>
+#include <core/job_system.hpp>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <mango/scene_structures.hpp>
+#include <mango/slotmap.hpp>
+#include <scene/transform_hierarchy.hpp>
+
+//! \cond NO_DOC
+
+namespace mango
+{
+    //! \brief The node structure used by the recursive reference implementation.
+    struct reference_node
+    {
+        std::vector<key> children;
+        key transform_id;
+        key global_matrix_id;
+    };
+
+    //! \brief The recursive scene graph update as it was done before the transform_hierarchy existed.
+    struct recursive_reference
+    {
+        slotmap<reference_node> nodes;
+        slotmap<transform> transforms;
+        slotmap<mat4> global_matrices;
+
+        key add(optional<key> parent, const transform& tr)
+        {
+            reference_node nd;
+            nd.transform_id     = transforms.insert(tr);
+            nd.global_matrix_id = global_matrices.insert(mat4::Identity());
+            key id              = nodes.insert(nd);
+            if (parent.has_value())
+                nodes[parent.value()].children.push_back(id);
+            return id;
+        }
+
+        void update(key node_id, optional<key> parent_id, bool force_update)
+        {
+            reference_node& nd = nodes[node_id];
+            transform& tr      = transforms[nd.transform_id];
+
+            if (tr.changed || force_update)
+            {
+                mat4 local_transformation_matrix = mat4::Identity() * translate(tr.position);
+                local_transformation_matrix      = local_transformation_matrix * quaternion_to_mat4(tr.rotation);
+                local_transformation_matrix      = local_transformation_matrix * scale(tr.scale);
+
+                mat4 parent_transformation_matrix = mat4::Identity();
+                if (parent_id.has_value() && nodes.valid(parent_id.value()))
+                    parent_transformation_matrix = global_matrices[nodes[parent_id.value()].global_matrix_id];
+
+                global_matrices[nd.global_matrix_id] = parent_transformation_matrix * local_transformation_matrix;
+
+                tr.changed   = false;
+                force_update = true;
+            }
+
+            for (key c : nd.children)
+                update(c, node_id, force_update);
+        }
+    };
+
+    class transform_hierarchy_test : public ::testing::Test
+    {
+      protected:
+        transform_hierarchy_test() {}
+
+        ~transform_hierarchy_test() override {}
+
+        void SetUp() override {}
+
+        void TearDown() override {}
+
+        transform random_transform(int32 seed)
+        {
+            transform tr;
+            tr.position = vec3(static_cast<float>(seed % 7), static_cast<float>(seed % 3) * 0.5f, -static_cast<float>(seed % 5));
+            tr.rotation = quat(Eigen::AngleAxisf(static_cast<float>(seed % 11) * 0.1f, vec3(0.0f, 1.0f, 0.0f).normalized()));
+            tr.scale    = make_vec3(1.0f + static_cast<float>(seed % 2) * 0.01f);
+            return tr;
+        }
+
+        mat4 compose(const transform& tr)
+        {
+            return translate(tr.position) * quaternion_to_mat4(tr.rotation) * scale(tr.scale);
+        }
+
+        //! \brief Builds the same hierarchy for both implementations. parent_of(i) returns the index of the parent of node i (i > 0).
+        template <typename F>
+        void build(int32 count, F parent_of, transform_hierarchy& hierarchy, recursive_reference& reference, std::vector<key>& reference_ids)
+        {
+            reference_ids.clear();
+            for (int32 i = 0; i < count; ++i)
+            {
+                transform tr         = random_transform(i);
+                optional<key> parent = i > 0 ? optional<key>(reference_ids[parent_of(i)]) : NONE;
+                key id               = reference.add(parent, tr);
+                reference_ids.push_back(id);
+
+                hierarchy.add(id, reference.nodes[id].transform_id, parent);
+                hierarchy.set_local(hierarchy.index_of(id), tr.position, tr.rotation, tr.scale);
+            }
+        }
+
+        template <typename F>
+        void benchmark(const string& name, int32 count, F parent_of)
+        {
+            transform_hierarchy hierarchy;
+            recursive_reference reference;
+            std::vector<key> ids;
+            build(count, parent_of, hierarchy, reference, ids);
+
+            const int32 iterations = 10;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int32 it = 0; it < iterations; ++it)
+            {
+                transforms_changed(reference);
+                reference.update(ids[0], NONE, false);
+            }
+            auto recursive = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+            start = std::chrono::high_resolution_clock::now();
+            for (int32 it = 0; it < iterations; ++it)
+            {
+                for (uint32 i = 0; i < hierarchy.size(); ++i)
+                {
+                    transform& tr = reference.transforms[hierarchy.transform_id(i)];
+                    hierarchy.set_local(i, tr.position, tr.rotation, tr.scale);
+                }
+                hierarchy.update();
+            }
+            auto flat = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+            std::cout << "[ BENCHMARK] " << name << " (" << count << " nodes): recursive " << recursive << " ms, flat " << flat << " ms" << std::endl;
+
+            for (uint32 i = 0; i < hierarchy.size(); ++i)
+            {
+                const mat4& expected = reference.global_matrices[reference.nodes[hierarchy.node_id(i)].global_matrix_id];
+                ASSERT_TRUE(hierarchy.global_matrix(i).isApprox(expected, 1e-3f));
+            }
+        }
+
+        void transforms_changed(recursive_reference& reference)
+        {
+            for (auto& tr : reference.transforms)
+                tr.changed = true;
+        }
+    };
+
+    TEST_F(transform_hierarchy_test, global_matrices_match_recursive_update)
+    {
+        transform_hierarchy hierarchy;
+        recursive_reference reference;
+        std::vector<key> ids;
+        build(
+            64, [](int32 i) { return (i - 1) / 3; }, hierarchy, reference, ids);
+
+        hierarchy.update();
+        reference.update(ids[0], NONE, false);
+
+        ASSERT_EQ(hierarchy.size(), 64u);
+        for (uint32 i = 0; i < hierarchy.size(); ++i)
+        {
+            ASSERT_TRUE(hierarchy.updated(i));
+            const mat4& expected = reference.global_matrices[reference.nodes[hierarchy.node_id(i)].global_matrix_id];
+            ASSERT_TRUE(hierarchy.global_matrix(i).isApprox(expected, 1e-4f));
+        }
+
+        hierarchy.update();
+        for (uint32 i = 0; i < hierarchy.size(); ++i)
+            ASSERT_FALSE(hierarchy.updated(i));
+    }
+
+    TEST_F(transform_hierarchy_test, changes_propagate_to_children_only)
+    {
+        transform_hierarchy hierarchy;
+        hierarchy.add(0, 0, NONE);
+        hierarchy.add(1, 1, key(0));
+        hierarchy.add(2, 2, key(1));
+        hierarchy.add(3, 3, key(0));
+        hierarchy.update();
+
+        transform tr = random_transform(5);
+        hierarchy.set_local(hierarchy.index_of(1), tr.position, tr.rotation, tr.scale);
+        hierarchy.update();
+
+        ASSERT_FALSE(hierarchy.updated(hierarchy.index_of(0)));
+        ASSERT_TRUE(hierarchy.updated(hierarchy.index_of(1)));
+        ASSERT_TRUE(hierarchy.updated(hierarchy.index_of(2)));
+        ASSERT_FALSE(hierarchy.updated(hierarchy.index_of(3)));
+        ASSERT_TRUE(hierarchy.global_matrix(hierarchy.index_of(2)).isApprox(compose(tr), 1e-5f));
+    }
+
+    TEST_F(transform_hierarchy_test, reparenting_keeps_topological_order)
+    {
+        transform_hierarchy hierarchy;
+        hierarchy.add(0, 0, NONE);
+        hierarchy.add(1, 1, key(0));
+        hierarchy.add(2, 2, key(0));
+        hierarchy.add(3, 3, key(2));
+
+        transform tr = random_transform(3);
+        hierarchy.set_local(hierarchy.index_of(3), tr.position, tr.rotation, tr.scale);
+
+        // move 1 below 3, which is stored behind it
+        hierarchy.set_parent(1, key(3));
+        ASSERT_TRUE(hierarchy.is_ancestor(0, 1));
+        ASSERT_TRUE(hierarchy.is_ancestor(2, 1));
+        ASSERT_FALSE(hierarchy.is_ancestor(1, 2));
+        hierarchy.update();
+
+        for (uint32 i = 0; i < hierarchy.size(); ++i)
+        {
+            uint32 parent = hierarchy.parent_index(i);
+            ASSERT_TRUE(parent == transform_hierarchy::invalid_index || parent < i);
+        }
+        ASSERT_EQ(hierarchy.get_parent(1).value(), key(3));
+        ASSERT_TRUE(hierarchy.global_matrix(hierarchy.index_of(1)).isApprox(compose(tr), 1e-5f));
+    }
+
+    TEST_F(transform_hierarchy_test, removal_compacts_entries)
+    {
+        transform_hierarchy hierarchy;
+        hierarchy.add(0, 0, NONE);
+        hierarchy.add(1, 1, key(0));
+        hierarchy.add(2, 2, key(1));
+        hierarchy.add(3, 3, key(0));
+
+        hierarchy.remove(2);
+        hierarchy.remove(1);
+        ASSERT_FALSE(hierarchy.contains(1));
+        hierarchy.update();
+
+        ASSERT_EQ(hierarchy.size(), 2u);
+        ASSERT_EQ(hierarchy.index_of(0), 0u);
+        ASSERT_EQ(hierarchy.index_of(3), 1u);
+        ASSERT_EQ(hierarchy.parent_index(1), 0u);
+    }
+
+    TEST_F(transform_hierarchy_test, parallel_update_matches_serial_update)
+    {
+        job_system jobs(4);
+        transform_hierarchy serial;
+        recursive_reference reference;
+        std::vector<key> ids;
+        // a wide and deep tree, big enough to be split into several chunks per level
+        build(
+            20001, [](int32 i) { return (i - 1) / 4; }, serial, reference, ids);
+        transform_hierarchy parallel = serial;
+
+        serial.update();
+        parallel.update(&jobs);
+
+        ASSERT_EQ(serial.size(), parallel.size());
+        for (uint32 i = 0; i < serial.size(); ++i)
+        {
+            ASSERT_EQ(serial.node_id(i), parallel.node_id(i));
+            ASSERT_EQ(serial.updated(i), parallel.updated(i));
+            ASSERT_TRUE(serial.global_matrix(i).isApprox(parallel.global_matrix(i), 1e-5f));
+        }
+
+        // reparent a subtree and check again
+        serial.set_parent(ids[7], ids[20000]);
+        parallel.set_parent(ids[7], ids[20000]);
+        serial.update();
+        parallel.update(&jobs);
+
+        for (uint32 i = 0; i < serial.size(); ++i)
+        {
+            ASSERT_EQ(serial.node_id(i), parallel.node_id(i));
+            ASSERT_EQ(serial.updated(i), parallel.updated(i));
+            ASSERT_TRUE(serial.global_matrix(i).isApprox(parallel.global_matrix(i), 1e-5f));
+        }
+    }
+
+    TEST_F(transform_hierarchy_test, benchmark_deep_hierarchy)
+    {
+        // 250 chains with a depth of 200
+        benchmark("deep hierarchy", 50001, [](int32 i) { return ((i - 1) % 200 == 0) ? 0 : i - 1; });
+    }
+
+    TEST_F(transform_hierarchy_test, benchmark_wide_hierarchy)
+    {
+        benchmark("wide hierarchy", 50001, [](int32) { return 0; });
+    }
+} // namespace mango
+
+//! \endcond